@@ -0,0 +1,270 @@
+#include "av1_cdef.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cdef_Pri_Taps / Cdef_Sec_Taps (spec 7.15.3; both rows of Cdef_Sec_Taps are equal).
+static const int32_t kCdefPriTaps[2][2] = {{4, 2}, {3, 3}};
+static const int32_t kCdefSecTaps[2] = {2, 1};
+
+// Cdef_Directions[ dir ][ k ] as offsets into a tile row stride.
+#define CDEF_OFF(dy, dx) ((dy) * AV1_CDEF_TILE_STRIDE + (dx))
+static const int32_t kCdefOffsets[8][2] = {
+    {CDEF_OFF(-1, 1), CDEF_OFF(-2, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(-1, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(0, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(1, 2)},
+    {CDEF_OFF(1, 1), CDEF_OFF(2, 2)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, 1)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, 0)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, -1)},
+};
+#undef CDEF_OFF
+
+static uint32_t cdef_floor_log2(uint32_t n) {
+    uint32_t s = 0;
+    while (n > 1u) {
+        n >>= 1;
+        s++;
+    }
+    return s;
+}
+
+static int32_t cdef_constrain(int32_t diff, int32_t threshold, uint32_t damping) {
+    if (!threshold) {
+        return 0;
+    }
+    const uint32_t lg = cdef_floor_log2((uint32_t)threshold);
+    const uint32_t adj = damping > lg ? damping - lg : 0u;
+    const int32_t a = diff < 0 ? -diff : diff;
+    int32_t v = threshold - (a >> adj);
+    v = v < 0 ? 0 : (v > a ? a : v);
+    return diff < 0 ? -v : v;
+}
+
+// Spec 7.15.2.
+static uint32_t cdef_find_dir_c(const uint16_t *img, uint32_t coeff_shift, uint32_t *var) {
+    static const int32_t kDivTable[9] = {0, 840, 420, 280, 210, 168, 140, 120, 105};
+    int32_t cost[8] = {0};
+    int32_t partial[8][15] = {{0}};
+    for (int32_t i = 0; i < 8; i++) {
+        for (int32_t j = 0; j < 8; j++) {
+            const int32_t x = (img[i * AV1_CDEF_TILE_STRIDE + j] >> coeff_shift) - 128;
+            partial[0][i + j] += x;
+            partial[1][i + j / 2] += x;
+            partial[2][i] += x;
+            partial[3][3 + i - j / 2] += x;
+            partial[4][7 + i - j] += x;
+            partial[5][3 - i / 2 + j] += x;
+            partial[6][j] += x;
+            partial[7][i / 2 + j] += x;
+        }
+    }
+    for (int32_t i = 0; i < 8; i++) {
+        cost[2] += partial[2][i] * partial[2][i];
+        cost[6] += partial[6][i] * partial[6][i];
+    }
+    cost[2] *= kDivTable[8];
+    cost[6] *= kDivTable[8];
+    for (int32_t i = 0; i < 7; i++) {
+        cost[0] += (partial[0][i] * partial[0][i] + partial[0][14 - i] * partial[0][14 - i]) * kDivTable[i + 1];
+        cost[4] += (partial[4][i] * partial[4][i] + partial[4][14 - i] * partial[4][14 - i]) * kDivTable[i + 1];
+    }
+    cost[0] += partial[0][7] * partial[0][7] * kDivTable[8];
+    cost[4] += partial[4][7] * partial[4][7] * kDivTable[8];
+    for (int32_t i = 1; i < 8; i += 2) {
+        for (int32_t j = 0; j < 4 + 1; j++) {
+            cost[i] += partial[i][3 + j] * partial[i][3 + j];
+        }
+        cost[i] *= kDivTable[8];
+        for (int32_t j = 0; j < 4 - 1; j++) {
+            cost[i] += (partial[i][j] * partial[i][j] + partial[i][10 - j] * partial[i][10 - j]) * kDivTable[2 * j + 2];
+        }
+    }
+    int32_t best_cost = 0;
+    uint32_t dir = 0;
+    for (uint32_t i = 0; i < 8; i++) {
+        if (cost[i] > best_cost) {
+            best_cost = cost[i];
+            dir = i;
+        }
+    }
+    *var = (uint32_t)(best_cost - cost[(dir + 4u) & 7u]) >> 10;
+    return dir;
+}
+
+// ---- Pixel-type instantiations ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#include "av1_cdef_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#include "av1_cdef_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+void av1_cdef_dsp_init(Av1CdefDsp *dsp) {
+    av1_cdef_dsp_init_c(dsp);
+#if defined(AV1_CDEF_HAVE_X86)
+    (void)av1_cdef_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_cdef_dsp_init_16(Av1CdefDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_cdef_dsp_init_c_16(dsp, bit_depth);
+}
+
+void av1_cdef_params_default(Av1CdefParams *p) {
+    memset(p, 0, sizeof(*p));
+    p->damping = 3;
+}
+
+// ---- Frame binding ----
+
+bool av1_cdef_init(Av1Cdef *cdef,
+                   Av1FrameBuf *fb,
+                   const uint8_t *skip,
+                   ptrdiff_t skip_stride,
+                   const int8_t *idx,
+                   ptrdiff_t idx_stride,
+                   uint32_t mi_rows,
+                   uint32_t mi_cols,
+                   const Av1CdefParams *params,
+                   char *err,
+                   size_t err_cap) {
+    memset(cdef, 0, sizeof(*cdef));
+    if (!fb || !skip || !idx || !params || skip_stride < (ptrdiff_t)mi_cols || idx_stride < (ptrdiff_t)((mi_cols + 15u) >> 4)) {
+        snprintf(err, err_cap, "cdef: invalid args");
+        return false;
+    }
+    if (mi_rows * 4u < fb->height || mi_cols * 4u < fb->width || mi_rows * 4u > fb->height + 7u ||
+        mi_cols * 4u > fb->width + 7u || (mi_rows & 1u) || (mi_cols & 1u)) {
+        snprintf(err, err_cap, "cdef: MI grid %ux%u does not match a %ux%u frame", mi_cols, mi_rows, fb->width, fb->height);
+        return false;
+    }
+    const uint32_t sub_x = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    const uint32_t sub_y = fb->layout == AV1_LAYOUT_I420;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t min_x = AV1_CDEF_MIN_BORDER >> (p ? sub_x : 0u);
+        const uint32_t min_y = AV1_CDEF_MIN_BORDER >> (p ? sub_y : 0u);
+        if (fb->border_x[p] < min_x || fb->border_y[p] < min_y) {
+            snprintf(err, err_cap, "cdef: plane %u border %ux%u is below %ux%u", p, fb->border_x[p], fb->border_y[p], min_x, min_y);
+            return false;
+        }
+    }
+    if (params->damping < 3u || params->damping > 6u) {
+        snprintf(err, err_cap, "cdef: damping %u out of range", params->damping);
+        return false;
+    }
+    cdef->fb = fb;
+    cdef->skip = skip;
+    cdef->skip_stride = skip_stride;
+    cdef->idx = idx;
+    cdef->idx_stride = idx_stride;
+    cdef->mi_rows = mi_rows;
+    cdef->mi_cols = mi_cols;
+    cdef->sub_x = sub_x;
+    cdef->sub_y = sub_y;
+    cdef->params = *params;
+    cdef->num_rows = (mi_rows + 15u) >> 4;
+    cdef->line_slots = cdef->num_rows;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t sx = p ? cdef->sub_x : 0u;
+        cdef->line_stride[p] = (ptrdiff_t)(((mi_cols * 4u) >> sx) + 2u * AV1_CDEF_BORDER);
+        cdef->lines[p] = malloc((size_t)cdef->num_rows * 4u * (size_t)cdef->line_stride[p] * sizeof(uint16_t));
+        if (!cdef->lines[p]) {
+            av1_cdef_free(cdef);
+            snprintf(err, err_cap, "cdef: out of memory");
+            return false;
+        }
+    }
+    if (fb->bit_depth > 8u) {
+        av1_cdef_dsp_init_16(&cdef->dsp16, fb->bit_depth);
+    } else {
+        av1_cdef_dsp_init(&cdef->dsp);
+    }
+    return true;
+}
+
+void av1_cdef_free(Av1Cdef *cdef) {
+    for (uint32_t p = 0; p < 3; p++) {
+        free(cdef->lines[p]);
+        cdef->lines[p] = NULL;
+    }
+}
+
+bool av1_cdef_set_line_ring(Av1Cdef *cdef, uint32_t slots, char *err, size_t err_cap) {
+    if (slots == 0u) {
+        snprintf(err, err_cap, "cdef: empty line ring");
+        return false;
+    }
+    if (slots >= cdef->line_slots) {
+        return true;
+    }
+    for (uint32_t p = 0; p < cdef->fb->num_planes; p++) {
+        uint16_t *lines = realloc(cdef->lines[p], (size_t)slots * 4u * (size_t)cdef->line_stride[p] * sizeof(uint16_t));
+        if (!lines) {
+            snprintf(err, err_cap, "cdef: out of memory");
+            return false;
+        }
+        cdef->lines[p] = lines;
+    }
+    cdef->line_slots = slots;
+    return true;
+}
+
+void av1_cdef_save_lines(Av1Cdef *cdef, uint32_t boundary) {
+    if (boundary == 0u || boundary >= cdef->num_rows) {
+        return;
+    }
+    for (uint32_t p = 0; p < cdef->fb->num_planes; p++) {
+        if (cdef->fb->bytes_per_sample == 1u) {
+            cdef_save_lines_plane(cdef, p, boundary);
+        } else {
+            cdef_save_lines_plane_16(cdef, p, boundary);
+        }
+    }
+}
+
+void av1_cdef_filter_row(const Av1Cdef *cdef, uint32_t row) {
+    if (cdef->fb->bytes_per_sample == 1u) {
+        cdef_row(cdef, &cdef->dsp, row);
+    } else {
+        cdef_row_16(cdef, &cdef->dsp16, row);
+    }
+}
+
+void av1_cdef_filter_frame(Av1Cdef *cdef) {
+    for (uint32_t b = 1; b < cdef->num_rows; b++) {
+        av1_cdef_save_lines(cdef, b);
+    }
+    for (uint32_t row = 0; row < cdef->num_rows; row++) {
+        av1_cdef_filter_row(cdef, row);
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+
+// Constrained directional enhancement filter (spec 7.15 "CDEF process").
+//
+// Every 64x64 luma block is filtered from a 16-bit tile holding its unfiltered samples plus a
+// two-sample margin, where positions outside the MI grid (is_inside_filter_region()) hold
+// AV1_CDEF_VERY_LARGE. The marker makes constrain() return 0 and never raises the clipping
+// maximum, so kernels need no availability tests. Tiles are built from:
+// - the frame itself for the block and the blocks right of / below it, which are not filtered
+//   yet,
+// - the unfiltered left margin kept from the previous tile of the row,
+// - line buffers of the unfiltered rows on both sides of every 64-row boundary, saved by
+//   av1_cdef_save_lines() before either neighbouring row is filtered.
+// With the line buffers in place, 64-row stripes may be filtered in any order.
+//
+// 8x8 luma blocks whose four MI units are all skip are left untouched, as the spec does. Kernels
+// read the tile for every bit depth; they write uint8_t (Av1CdefDsp) or uint16_t (Av1CdefDsp16)
+// samples. The direction search and the 8-bit filter have AVX2 versions (av1_cdef_x86.c).
+
+#define AV1_CDEF_VERY_LARGE 30000u
+
+// Tile: a 64x64 block plus two samples on every side.
+#define AV1_CDEF_BORDER 2
+#define AV1_CDEF_TILE_STRIDE 72
+
+// Luma samples read past the plane edges within the MI grid (MiCols * 4 may exceed FrameWidth
+// by 7); halved for subsampled chroma.
+#define AV1_CDEF_MIN_BORDER 8u
+
+// cdef_params(): strengths per cdef_idx, secondary strengths already mapped 3 -> 4.
+typedef struct {
+    uint8_t damping; // CdefDamping, 3..6
+    uint8_t bits;    // cdef_bits
+    uint8_t y_pri[8];
+    uint8_t y_sec[8];
+    uint8_t uv_pri[8];
+    uint8_t uv_sec[8];
+} Av1CdefParams;
+
+// Spec 7.15.2: returns yDir, sets *var. img points at the 8x8 block inside a tile.
+typedef uint32_t (*Av1CdefDirFn)(const uint16_t *img, uint32_t coeff_shift, uint32_t *var);
+
+// Spec 7.15.3 for one 8x8 (w8) or 4-wide block of h rows: dst from the tile block at in.
+typedef void (*Av1CdefFilterFn)(uint8_t *dst,
+                                ptrdiff_t stride,
+                                const uint16_t *in,
+                                int32_t pri,
+                                int32_t sec,
+                                uint32_t dir,
+                                uint32_t damping,
+                                uint32_t h);
+typedef void (*Av1CdefFilterFn16)(uint16_t *dst,
+                                  ptrdiff_t stride,
+                                  const uint16_t *in,
+                                  int32_t pri,
+                                  int32_t sec,
+                                  uint32_t dir,
+                                  uint32_t damping,
+                                  uint32_t h,
+                                  uint32_t bit_depth);
+
+// filter[ 0 ]: 8 samples wide, filter[ 1 ]: 4 samples wide (subsampled chroma).
+typedef struct {
+    Av1CdefDirFn find_dir;
+    Av1CdefFilterFn filter[2];
+} Av1CdefDsp;
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1CdefDirFn find_dir;
+    Av1CdefFilterFn16 filter[2];
+} Av1CdefDsp16;
+
+// Scalar reference tables.
+void av1_cdef_dsp_init_c(Av1CdefDsp *dsp);
+void av1_cdef_dsp_init_c_16(Av1CdefDsp16 *dsp, uint32_t bit_depth);
+
+// Best tables for the running CPU.
+void av1_cdef_dsp_init(Av1CdefDsp *dsp);
+void av1_cdef_dsp_init_16(Av1CdefDsp16 *dsp, uint32_t bit_depth);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_CDEF_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_cdef_dsp_init_avx2(Av1CdefDsp *dsp);
+#endif
+
+// cdef_params() defaults (CodedLossless, allow_intrabc or !enable_cdef): damping 3, strengths 0.
+void av1_cdef_params_default(Av1CdefParams *p);
+
+typedef struct {
+    Av1FrameBuf *fb;
+    const uint8_t *skip; // Skips[ row ][ col ] per 4x4 luma unit
+    ptrdiff_t skip_stride;
+    const int8_t *idx; // cdef_idx per 64x64 luma block, -1: not filtered
+    ptrdiff_t idx_stride;
+    uint32_t mi_rows;
+    uint32_t mi_cols;
+    uint32_t sub_x;
+    uint32_t sub_y;
+    Av1CdefParams params;
+    Av1CdefDsp dsp;
+    Av1CdefDsp16 dsp16;
+
+    // Unfiltered rows around each 64-row boundary b: per plane, rows y - 2 .. y + 1 of plane row
+    // y = b * 64 >> sub_y, AV1_CDEF_BORDER samples of margin on each side.
+    uint16_t *lines[3];
+    ptrdiff_t line_stride[3];
+    uint32_t num_rows;   // 64-row stripes
+    uint32_t line_slots; // boundaries held in lines; boundary b lives in slot b % line_slots
+} Av1Cdef;
+
+// Binds a deblocked frame, its skip flags (mi_rows x mi_cols) and cdef_idx grid. Allocates the
+// line buffers.
+bool av1_cdef_init(Av1Cdef *cdef,
+                   Av1FrameBuf *fb,
+                   const uint8_t *skip,
+                   ptrdiff_t skip_stride,
+                   const int8_t *idx,
+                   ptrdiff_t idx_stride,
+                   uint32_t mi_rows,
+                   uint32_t mi_cols,
+                   const Av1CdefParams *params,
+                   char *err,
+                   size_t err_cap);
+
+void av1_cdef_free(Av1Cdef *cdef);
+
+// Shrinks the line buffers to a ring of slots boundaries (av1_cdef_init() keeps one per boundary).
+// Boundary b then reuses the slot of boundary b - slots, so it must not be saved before stripes
+// b - slots - 1 and b - slots are filtered.
+bool av1_cdef_set_line_ring(Av1Cdef *cdef, uint32_t slots, char *err, size_t err_cap);
+
+// Saves the unfiltered rows around boundary b (1 .. num_rows - 1). Must run after the rows are
+// final (deblocked) and before stripe b - 1 or b is filtered.
+void av1_cdef_save_lines(Av1Cdef *cdef, uint32_t boundary);
+
+// Filters stripe row (64 luma rows) in place; both of its boundaries must be saved.
+void av1_cdef_filter_row(const Av1Cdef *cdef, uint32_t row);
+
+// Saves every boundary, then filters every stripe.
+void av1_cdef_filter_frame(Av1Cdef *cdef);
@@ -0,0 +1,270 @@
+#include "av1_cdef.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 CDEF kernels for 8-bit frames, bit-exact with the scalar kernels in av1_cdef.c /
+// av1_cdef_tmpl.inc.
+//
+// Direction search: every partial sum of spec 7.15.2 is a row (or pair of rows / pair of
+// columns) added into a 16-bin accumulator at a per-row offset, done with byte shuffles on
+// 8 x int16 vectors. The eight weighted costs are squared and reduced on 32-bit lanes.
+//
+// Filter: 16 samples per vector (two rows of an 8-wide block, four rows of a 4-wide block). The
+// 12 taps are loaded from the tile at their direction offsets; AV1_CDEF_VERY_LARGE taps are
+// masked out of the maximum and make constrain() return 0 by construction, so availability needs
+// no further handling. Functions carry a target attribute so the file builds with the default
+// CFLAGS; av1_cdef_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_CDEF_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+#define CDEF_OFF(dy, dx) ((dy) * AV1_CDEF_TILE_STRIDE + (dx))
+static const int32_t kOffsets[8][2] = {
+    {CDEF_OFF(-1, 1), CDEF_OFF(-2, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(-1, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(0, 2)},
+    {CDEF_OFF(0, 1), CDEF_OFF(1, 2)},
+    {CDEF_OFF(1, 1), CDEF_OFF(2, 2)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, 1)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, 0)},
+    {CDEF_OFF(1, 0), CDEF_OFF(2, -1)},
+};
+#undef CDEF_OFF
+
+// ---- Direction search ----
+
+// Cost weights per partial bin: 15-bin diagonals (0, 4), 8-bin straight lines (2, 6) and
+// 11-bin odd directions.
+static const int32_t kWeightDiag[16] = {840, 420, 280, 210, 168, 140, 120, 105, 120, 140, 168, 210, 280, 420, 840, 0};
+static const int32_t kWeightLine[16] = {105, 105, 105, 105, 105, 105, 105, 105, 0, 0, 0, 0, 0, 0, 0, 0};
+static const int32_t kWeightOdd[16] = {420, 210, 140, 105, 105, 105, 105, 105, 140, 210, 420, 0, 0, 0, 0, 0};
+
+// Byte shuffle window: 16 bytes at kSlide + 16 - 2 * n move 8 x int16 lanes up by n lanes into
+// bins 0..7, 16 bytes at kSlide + 32 - 2 * n move the lanes pushed out into bins 8..15.
+static const uint8_t kSlide[48] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,    10,   11,   12,   13,   14,   15,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+typedef struct {
+    __m128i lo;
+    __m128i hi;
+} Partial;
+
+static inline AVX2_ATTR void acc(Partial *p, __m128i v, const __m128i *lo, const __m128i *hi, uint32_t n) {
+    p->lo = _mm_add_epi16(p->lo, _mm_shuffle_epi8(v, lo[n]));
+    p->hi = _mm_add_epi16(p->hi, _mm_shuffle_epi8(v, hi[n]));
+}
+
+// Weighted sum of squares of the 16 bins, left on 8 x int32 lanes.
+static inline AVX2_ATTR __m256i cost_lanes(const Partial *p, const int32_t *w) {
+    const __m256i lo = _mm256_cvtepi16_epi32(p->lo);
+    const __m256i hi = _mm256_cvtepi16_epi32(p->hi);
+    const __m256i wl = _mm256_loadu_si256((const __m256i *)(const void *)w);
+    const __m256i wh = _mm256_loadu_si256((const __m256i *)(const void *)(w + 8));
+    return _mm256_add_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(lo, lo), wl),
+                            _mm256_mullo_epi32(_mm256_mullo_epi32(hi, hi), wh));
+}
+
+static AVX2_ATTR uint32_t cdef_find_dir_avx2(const uint16_t *img, uint32_t coeff_shift, uint32_t *var) {
+    __m128i lo[8], hi[8];
+    for (uint32_t n = 0; n < 8; n++) {
+        lo[n] = _mm_loadu_si128((const __m128i *)(const void *)(kSlide + 16 - 2 * n));
+        hi[n] = _mm_loadu_si128((const __m128i *)(const void *)(kSlide + 32 - 2 * n));
+    }
+    const __m128i rev = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i shift = _mm_cvtsi32_si128((int)coeff_shift);
+
+    __m128i x[8];
+    for (uint32_t i = 0; i < 8; i++) {
+        const __m128i r = _mm_loadu_si128((const __m128i *)(const void *)(img + i * AV1_CDEF_TILE_STRIDE));
+        x[i] = _mm_sub_epi16(_mm_srl_epi16(r, shift), bias);
+    }
+
+    Partial p[8];
+    memset(p, 0, sizeof(p));
+    __m128i col = zero;
+    for (uint32_t i = 0; i < 8; i++) {
+        const __m128i r = _mm_shuffle_epi8(x[i], rev);
+        acc(&p[0], x[i], lo, hi, i);                       // bin i + j
+        acc(&p[1], _mm_hadd_epi16(x[i], zero), lo, hi, i); // bin i + j / 2
+        acc(&p[3], _mm_hadd_epi16(r, zero), lo, hi, i);    // bin 3 + i - j / 2
+        acc(&p[4], r, lo, hi, i);                          // bin 7 + i - j
+        col = _mm_add_epi16(col, x[i]);
+    }
+    for (uint32_t m = 0; m < 4; m++) {
+        const __m128i q = _mm_add_epi16(x[2 * m], x[2 * m + 1]);
+        acc(&p[5], q, lo, hi, 3u - m); // bin 3 - i / 2 + j
+        acc(&p[7], q, lo, hi, m);      // bin i / 2 + j
+    }
+    const __m128i h01 = _mm_hadd_epi16(x[0], x[1]);
+    const __m128i h23 = _mm_hadd_epi16(x[2], x[3]);
+    const __m128i h45 = _mm_hadd_epi16(x[4], x[5]);
+    const __m128i h67 = _mm_hadd_epi16(x[6], x[7]);
+    p[2].lo = _mm_hadd_epi16(_mm_hadd_epi16(h01, h23), _mm_hadd_epi16(h45, h67)); // bin i
+    p[2].hi = zero;
+    p[6].lo = col; // bin j
+    p[6].hi = zero;
+
+    const __m256i c0 = cost_lanes(&p[0], kWeightDiag);
+    const __m256i c1 = cost_lanes(&p[1], kWeightOdd);
+    const __m256i c2 = cost_lanes(&p[2], kWeightLine);
+    const __m256i c3 = cost_lanes(&p[3], kWeightOdd);
+    const __m256i c4 = cost_lanes(&p[4], kWeightDiag);
+    const __m256i c5 = cost_lanes(&p[5], kWeightOdd);
+    const __m256i c6 = cost_lanes(&p[6], kWeightLine);
+    const __m256i c7 = cost_lanes(&p[7], kWeightOdd);
+    const __m256i u0 = _mm256_hadd_epi32(_mm256_hadd_epi32(c0, c1), _mm256_hadd_epi32(c2, c3));
+    const __m256i u1 = _mm256_hadd_epi32(_mm256_hadd_epi32(c4, c5), _mm256_hadd_epi32(c6, c7));
+    int32_t cost[8];
+    _mm_storeu_si128((__m128i *)(void *)cost, _mm_add_epi32(_mm256_castsi256_si128(u0), _mm256_extracti128_si256(u0, 1)));
+    _mm_storeu_si128((__m128i *)(void *)(cost + 4), _mm_add_epi32(_mm256_castsi256_si128(u1), _mm256_extracti128_si256(u1, 1)));
+
+    int32_t best_cost = 0;
+    uint32_t dir = 0;
+    for (uint32_t i = 0; i < 8; i++) {
+        if (cost[i] > best_cost) {
+            best_cost = cost[i];
+            dir = i;
+        }
+    }
+    *var = (uint32_t)(best_cost - cost[(dir + 4u) & 7u]) >> 10;
+    return dir;
+}
+
+// ---- Filter ----
+
+// 16 tile samples at p: rows 0..1 of an 8-wide block or rows 0..3 of a 4-wide block.
+static inline AVX2_ATTR __m256i load_taps(const uint16_t *p, uint32_t w) {
+    if (w == 8u) {
+        const __m128i a = _mm_loadu_si128((const __m128i *)(const void *)p);
+        const __m128i b = _mm_loadu_si128((const __m128i *)(const void *)(p + AV1_CDEF_TILE_STRIDE));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+    }
+    const __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(const void *)p),
+                                         _mm_loadl_epi64((const __m128i *)(const void *)(p + AV1_CDEF_TILE_STRIDE)));
+    const __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(const void *)(p + 2 * AV1_CDEF_TILE_STRIDE)),
+                                         _mm_loadl_epi64((const __m128i *)(const void *)(p + 3 * AV1_CDEF_TILE_STRIDE)));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+static inline AVX2_ATTR __m256i constrain(__m256i diff, __m256i threshold, __m128i adj) {
+    const __m256i a = _mm256_abs_epi16(diff);
+    __m256i v = _mm256_sub_epi16(threshold, _mm256_srl_epi16(a, adj));
+    v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_setzero_si256()), a);
+    return _mm256_sign_epi16(v, diff);
+}
+
+static inline uint32_t floor_log2(uint32_t n) {
+    uint32_t s = 0;
+    while (n > 1u) {
+        n >>= 1;
+        s++;
+    }
+    return s;
+}
+
+static inline AVX2_ATTR void cdef_filter_avx2(uint8_t *dst,
+                                              ptrdiff_t stride,
+                                              const uint16_t *in,
+                                              int32_t pri,
+                                              int32_t sec,
+                                              uint32_t dir,
+                                              uint32_t damping,
+                                              uint32_t w,
+                                              uint32_t h) {
+    const uint32_t rows = 16u / w;
+    const __m256i large = _mm256_set1_epi16((int16_t)AV1_CDEF_VERY_LARGE);
+    const __m256i pri_v = _mm256_set1_epi16((int16_t)pri);
+    const __m256i sec_v = _mm256_set1_epi16((int16_t)sec);
+    const uint32_t pri_lg = floor_log2((uint32_t)pri);
+    const uint32_t sec_lg = floor_log2((uint32_t)sec);
+    const __m128i pri_adj = _mm_cvtsi32_si128((int)(damping > pri_lg ? damping - pri_lg : 0u));
+    const __m128i sec_adj = _mm_cvtsi32_si128((int)(damping > sec_lg ? damping - sec_lg : 0u));
+    const __m256i pri_tap[2] = {_mm256_set1_epi16((pri & 1) ? 3 : 4), _mm256_set1_epi16((pri & 1) ? 3 : 2)};
+    const __m256i sec_tap[2] = {_mm256_set1_epi16(2), _mm256_set1_epi16(1)};
+    const int32_t pri_off[2] = {kOffsets[dir][0], kOffsets[dir][1]};
+    const int32_t sec_off[2][2] = {{kOffsets[(dir + 2u) & 7u][0], kOffsets[(dir + 2u) & 7u][1]},
+                                   {kOffsets[(dir - 2u) & 7u][0], kOffsets[(dir - 2u) & 7u][1]}};
+    for (uint32_t i = 0; i < h; i += rows) {
+        const uint16_t *s = in + (ptrdiff_t)i * AV1_CDEF_TILE_STRIDE;
+        const __m256i x = load_taps(s, w);
+        __m256i sum = _mm256_setzero_si256();
+        __m256i max = x;
+        __m256i min = x;
+        for (uint32_t k = 0; k < 2; k++) {
+            for (int32_t sign = -1; sign <= 1; sign += 2) {
+                const __m256i p = load_taps(s + sign * pri_off[k], w);
+                if (pri) {
+                    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(pri_tap[k], constrain(_mm256_sub_epi16(p, x), pri_v, pri_adj)));
+                }
+                max = _mm256_max_epi16(max, _mm256_andnot_si256(_mm256_cmpeq_epi16(p, large), p));
+                min = _mm256_min_epi16(min, p);
+                for (uint32_t d = 0; d < 2; d++) {
+                    const __m256i q = load_taps(s + sign * sec_off[d][k], w);
+                    if (sec) {
+                        sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(sec_tap[k], constrain(_mm256_sub_epi16(q, x), sec_v, sec_adj)));
+                    }
+                    max = _mm256_max_epi16(max, _mm256_andnot_si256(_mm256_cmpeq_epi16(q, large), q));
+                    min = _mm256_min_epi16(min, q);
+                }
+            }
+        }
+        // x + ( ( 8 + sum - ( sum < 0 ) ) >> 4 ), clipped to [ min, max ].
+        const __m256i neg = _mm256_cmpgt_epi16(_mm256_setzero_si256(), sum);
+        const __m256i off = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(8)), neg), 4);
+        const __m256i y = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(x, off), min), max);
+        const __m128i b = _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(y, y), 0x08));
+        uint8_t out[16];
+        _mm_storeu_si128((__m128i *)(void *)out, b);
+        for (uint32_t r = 0; r < rows; r++) {
+            memcpy(dst + (ptrdiff_t)(i + r) * stride, out + r * w, w);
+        }
+    }
+}
+
+static AVX2_ATTR void cdef_filter_8_avx2(uint8_t *dst,
+                                         ptrdiff_t stride,
+                                         const uint16_t *in,
+                                         int32_t pri,
+                                         int32_t sec,
+                                         uint32_t dir,
+                                         uint32_t damping,
+                                         uint32_t h) {
+    cdef_filter_avx2(dst, stride, in, pri, sec, dir, damping, 8, h);
+}
+
+static AVX2_ATTR void cdef_filter_4_avx2(uint8_t *dst,
+                                         ptrdiff_t stride,
+                                         const uint16_t *in,
+                                         int32_t pri,
+                                         int32_t sec,
+                                         uint32_t dir,
+                                         uint32_t damping,
+                                         uint32_t h) {
+    cdef_filter_avx2(dst, stride, in, pri, sec, dir, damping, 4, h);
+}
+
+bool av1_cdef_dsp_init_avx2(Av1CdefDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->find_dir = cdef_find_dir_avx2;
+    dsp->filter[0] = cdef_filter_8_avx2;
+    dsp->filter[1] = cdef_filter_4_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_cdef.c uses the scalar reference.
+typedef int av1_cdef_x86_unused;
+
+#endif
@@ -0,0 +1,69 @@
+#include "av1_cfl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ---- Scalar reference kernels ----
+
+static void subtract_average_c(int16_t *ac, uint32_t log2w, uint32_t log2h) {
+    const uint32_t n = 1u << (log2w + log2h);
+    int32_t sum = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        sum += ac[k];
+    }
+    const int32_t avg = (sum + (1 << (log2w + log2h - 1u))) >> (log2w + log2h);
+    for (uint32_t k = 0; k < n; k++) {
+        ac[k] = (int16_t)(ac[k] - avg);
+    }
+}
+
+static bool cfl_size_ok(uint32_t log2w, uint32_t log2h) {
+    // 4x4 .. 32x32 with at most 4:1 aspect (the transform sizes of blocks where CFL is allowed).
+    return log2w >= 2 && log2w <= 5 && log2h >= 2 && log2h <= 5 && log2w <= log2h + 2u && log2h <= log2w + 2u;
+}
+
+// ---- Pixel-type instantiations ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#include "av1_cfl_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#include "av1_cfl_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+void av1_cfl_dsp_init(Av1CflDsp *dsp) {
+    av1_cfl_dsp_init_c(dsp);
+#if defined(AV1_CFL_HAVE_X86)
+    (void)av1_cfl_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_cfl_dsp_init_16(Av1CflDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_cfl_dsp_init_c_16(dsp, bit_depth);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Chroma-from-luma prediction (spec 7.11.5 "Predict chroma from luma process", see local
+// av1bitstream.html).
+//
+// The process is split so that the luma work is shared by both chroma planes:
+// - av1_cfl_build_ac() subsamples the reconstructed luma under the chroma transform block into
+//   L[][] (3 fractional bits) and subtracts lumaAvg, leaving the AC part.
+// - av1_cfl_predict() scales the AC part by CflAlphaU / CflAlphaV and adds it to the DC
+//   prediction already in the chroma block.
+//
+// Each step is an Av1CflDsp kernel with a scalar reference; av1_cfl_x86.c provides bit-exact AVX2
+// variants. The scalar kernels (av1_cfl_tmpl.inc) are instantiated for uint8_t and uint16_t
+// pixels; the _16 / 16 variants below serve BitDepth 10 / 12. L[][] fits int16 at every bit depth
+// (8 * 4095 = 32760), so the AC buffer and the subtract-average kernel are shared.
+
+// CFL is allowed for blocks up to 32x32 (spec is_cfl_allowed), so chroma transform blocks are at
+// most 32x32 and the AC buffer holds at most this many entries (stride = block width).
+#define AV1_CFL_MAX_DIM 32u
+#define AV1_CFL_AC_LEN (AV1_CFL_MAX_DIM * AV1_CFL_MAX_DIM)
+
+// Subsampling layouts, indexed by subsampling_x + subsampling_y.
+enum {
+    AV1_CFL_444 = 0,
+    AV1_CFL_422 = 1,
+    AV1_CFL_420 = 2,
+    AV1_CFL_LAYOUTS,
+};
+
+// L[ i ][ j ] for a (1 << log2w) x (1 << log2h) chroma block from the luma samples at luma, reading
+// exactly (w << subX) x (h << subY) of them.
+typedef void (*Av1CflSubsampleFn)(int16_t *ac, const uint8_t *luma, ptrdiff_t luma_stride, uint32_t log2w, uint32_t log2h);
+
+// ac[ k ] -= Round2( sum( ac ), log2w + log2h ).
+typedef void (*Av1CflSubtractAverageFn)(int16_t *ac, uint32_t log2w, uint32_t log2h);
+
+// dst = Clip1( dst + Round2Signed( alpha * ac, 6 ) ).
+typedef void (*Av1CflPredictFn)(uint8_t *dst, ptrdiff_t stride, const int16_t *ac, int32_t alpha, uint32_t log2w, uint32_t log2h);
+
+typedef struct {
+    Av1CflSubsampleFn subsample[AV1_CFL_LAYOUTS];
+    Av1CflSubtractAverageFn subtract_average;
+    Av1CflPredictFn predict;
+} Av1CflDsp;
+
+// Scalar reference table.
+void av1_cfl_dsp_init_c(Av1CflDsp *dsp);
+
+// Best table for the running CPU.
+void av1_cfl_dsp_init(Av1CflDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_CFL_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_cfl_dsp_init_avx2(Av1CflDsp *dsp);
+#endif
+
+// Builds the AC part of L[][] for one chroma transform block.
+//
+// luma points at CurrFrame[ 0 ][ startY << subY ][ startX << subX ]. luma_avail_w / luma_avail_h
+// are the luma samples available from there (MaxLumaW - ( startX << subX ) etc.); positions past
+// them use the spec's clamped lumaX / lumaY.
+bool av1_cfl_build_ac(const Av1CflDsp *dsp,
+                      int16_t ac[AV1_CFL_AC_LEN],
+                      const uint8_t *luma,
+                      ptrdiff_t luma_stride,
+                      uint32_t sub_x,
+                      uint32_t sub_y,
+                      uint32_t log2w,
+                      uint32_t log2h,
+                      uint32_t luma_avail_w,
+                      uint32_t luma_avail_h,
+                      char *err,
+                      size_t err_cap);
+
+// Applies CFL to dst, which holds the DC_PRED prediction of the block. alpha is CflAlphaU or
+// CflAlphaV (-16..16).
+bool av1_cfl_predict(const Av1CflDsp *dsp,
+                     uint8_t *dst,
+                     ptrdiff_t stride,
+                     const int16_t ac[AV1_CFL_AC_LEN],
+                     int32_t alpha,
+                     uint32_t log2w,
+                     uint32_t log2h,
+                     char *err,
+                     size_t err_cap);
+
+// ---- 16-bit pixels (BitDepth 10 / 12) ----
+
+typedef void (*Av1CflSubsampleFn16)(int16_t *ac, const uint16_t *luma, ptrdiff_t luma_stride, uint32_t log2w, uint32_t log2h);
+typedef void (*Av1CflPredictFn16)(uint16_t *dst,
+                                  ptrdiff_t stride,
+                                  const int16_t *ac,
+                                  int32_t alpha,
+                                  uint32_t log2w,
+                                  uint32_t log2h,
+                                  uint32_t bit_depth);
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1CflSubsampleFn16 subsample[AV1_CFL_LAYOUTS];
+    Av1CflSubtractAverageFn subtract_average;
+    Av1CflPredictFn16 predict;
+} Av1CflDsp16;
+
+void av1_cfl_dsp_init_c_16(Av1CflDsp16 *dsp, uint32_t bit_depth);
+void av1_cfl_dsp_init_16(Av1CflDsp16 *dsp, uint32_t bit_depth);
+
+bool av1_cfl_build_ac_16(const Av1CflDsp16 *dsp,
+                         int16_t ac[AV1_CFL_AC_LEN],
+                         const uint16_t *luma,
+                         ptrdiff_t luma_stride,
+                         uint32_t sub_x,
+                         uint32_t sub_y,
+                         uint32_t log2w,
+                         uint32_t log2h,
+                         uint32_t luma_avail_w,
+                         uint32_t luma_avail_h,
+                         char *err,
+                         size_t err_cap);
+
+bool av1_cfl_predict_16(const Av1CflDsp16 *dsp,
+                        uint16_t *dst,
+                        ptrdiff_t stride,
+                        const int16_t ac[AV1_CFL_AC_LEN],
+                        int32_t alpha,
+                        uint32_t log2w,
+                        uint32_t log2h,
+                        char *err,
+                        size_t err_cap);
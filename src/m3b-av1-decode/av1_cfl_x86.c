@@ -0,0 +1,176 @@
+#include "av1_cfl.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 chroma-from-luma kernels, bit-exact with the scalar reference in av1_cfl.c.
+//
+// Everything runs on 16-bit lanes: L[][] is at most 8 * 255 = 2040 and |alpha| <= 16, so
+// alpha * ( L - lumaAvg ) and the Round2Signed() bias stay within int16. Functions carry a target
+// attribute so the file builds with the default CFLAGS; av1_cfl_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_CFL_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+static inline AVX2_ATTR __m128i load_u8x4(const uint8_t *p) {
+    int32_t v;
+    memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+// Sums of adjacent luma pairs for w = 4 / 8 chroma samples (128-bit) ...
+static inline AVX2_ATTR __m128i pair_sums_128(const uint8_t *p, uint32_t w) {
+    const __m128i v = w == 8 ? _mm_loadu_si128((const __m128i *)(const void *)p)
+                             : _mm_loadl_epi64((const __m128i *)(const void *)p);
+    return _mm_maddubs_epi16(v, _mm_set1_epi8(1));
+}
+
+// ... and for 16 chroma samples (256-bit; maddubs keeps the pairs in order).
+static inline AVX2_ATTR __m256i pair_sums_256(const uint8_t *p) {
+    return _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(const void *)p), _mm256_set1_epi8(1));
+}
+
+static inline AVX2_ATTR void store_s16_128(int16_t *p, __m128i v, uint32_t w) {
+    if (w == 8) {
+        _mm_storeu_si128((__m128i *)(void *)p, v);
+    } else {
+        _mm_storel_epi64((__m128i *)(void *)p, v);
+    }
+}
+
+static AVX2_ATTR void subsample_444_avx2(int16_t *ac, const uint8_t *luma, ptrdiff_t luma_stride, uint32_t log2w, uint32_t log2h) {
+    const uint32_t w = 1u << log2w;
+    for (uint32_t i = 0; i < (1u << log2h); i++, ac += w) {
+        const uint8_t *row = luma + (ptrdiff_t)i * luma_stride;
+        if (w < 16) {
+            const __m128i v = w == 8 ? _mm_loadl_epi64((const __m128i *)(const void *)row) : load_u8x4(row);
+            store_s16_128(ac, _mm_slli_epi16(_mm_cvtepu8_epi16(v), 3), w);
+            continue;
+        }
+        for (uint32_t j = 0; j < w; j += 16) {
+            const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(row + j)));
+            _mm256_storeu_si256((__m256i *)(void *)(ac + j), _mm256_slli_epi16(v, 3));
+        }
+    }
+}
+
+static AVX2_ATTR void subsample_422_avx2(int16_t *ac, const uint8_t *luma, ptrdiff_t luma_stride, uint32_t log2w, uint32_t log2h) {
+    const uint32_t w = 1u << log2w;
+    for (uint32_t i = 0; i < (1u << log2h); i++, ac += w) {
+        const uint8_t *row = luma + (ptrdiff_t)i * luma_stride;
+        if (w < 16) {
+            store_s16_128(ac, _mm_slli_epi16(pair_sums_128(row, w), 2), w);
+            continue;
+        }
+        for (uint32_t j = 0; j < w; j += 16) {
+            _mm256_storeu_si256((__m256i *)(void *)(ac + j), _mm256_slli_epi16(pair_sums_256(row + 2 * j), 2));
+        }
+    }
+}
+
+static AVX2_ATTR void subsample_420_avx2(int16_t *ac, const uint8_t *luma, ptrdiff_t luma_stride, uint32_t log2w, uint32_t log2h) {
+    const uint32_t w = 1u << log2w;
+    for (uint32_t i = 0; i < (1u << log2h); i++, ac += w) {
+        const uint8_t *r0 = luma + (ptrdiff_t)(2 * i) * luma_stride;
+        const uint8_t *r1 = r0 + luma_stride;
+        if (w < 16) {
+            const __m128i s = _mm_add_epi16(pair_sums_128(r0, w), pair_sums_128(r1, w));
+            store_s16_128(ac, _mm_slli_epi16(s, 1), w);
+            continue;
+        }
+        for (uint32_t j = 0; j < w; j += 16) {
+            const __m256i s = _mm256_add_epi16(pair_sums_256(r0 + 2 * j), pair_sums_256(r1 + 2 * j));
+            _mm256_storeu_si256((__m256i *)(void *)(ac + j), _mm256_slli_epi16(s, 1));
+        }
+    }
+}
+
+static AVX2_ATTR void subtract_average_avx2(int16_t *ac, uint32_t log2w, uint32_t log2h) {
+    // w * h >= 16, so the block is a whole number of 16-lane vectors.
+    const uint32_t n = 1u << (log2w + log2h);
+    __m256i acc = _mm256_setzero_si256();
+    for (uint32_t k = 0; k < n; k += 16) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)(ac + k));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(v, _mm256_set1_epi16(1)));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    const int32_t sum = _mm_cvtsi128_si32(s);
+    const __m256i avg = _mm256_set1_epi16((int16_t)((sum + (1 << (log2w + log2h - 1u))) >> (log2w + log2h)));
+    for (uint32_t k = 0; k < n; k += 16) {
+        __m256i *p = (__m256i *)(void *)(ac + k);
+        _mm256_storeu_si256(p, _mm256_sub_epi16(_mm256_loadu_si256(p), avg));
+    }
+}
+
+// dc + Round2Signed( alpha * ac, 6 ) on 8 lanes, before clipping.
+static inline AVX2_ATTR __m128i cfl_apply_128(__m128i dc, __m128i ac, __m128i alpha) {
+    const __m128i x = _mm_mullo_epi16(ac, alpha);
+    const __m128i mag = _mm_srli_epi16(_mm_add_epi16(_mm_abs_epi16(x), _mm_set1_epi16(32)), 6);
+    return _mm_add_epi16(dc, _mm_sign_epi16(mag, x));
+}
+
+static AVX2_ATTR void predict_avx2(uint8_t *dst, ptrdiff_t stride, const int16_t *ac, int32_t alpha, uint32_t log2w, uint32_t log2h) {
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    if (w == 4) {
+        // Two 4-sample rows per vector.
+        const __m128i a = _mm_set1_epi16((int16_t)alpha);
+        for (uint32_t i = 0; i < h; i += 2, ac += 8) {
+            uint8_t *r0 = dst + (ptrdiff_t)i * stride;
+            uint8_t *r1 = r0 + stride;
+            const __m128i dc = _mm_cvtepu8_epi16(_mm_unpacklo_epi32(load_u8x4(r0), load_u8x4(r1)));
+            const __m128i v = _mm_packus_epi16(cfl_apply_128(dc, _mm_loadu_si128((const __m128i *)(const void *)ac), a), _mm_setzero_si128());
+            const int32_t lo = _mm_cvtsi128_si32(v);
+            const int32_t hi = _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+            memcpy(r0, &lo, 4);
+            memcpy(r1, &hi, 4);
+        }
+        return;
+    }
+    if (w == 8) {
+        const __m128i a = _mm_set1_epi16((int16_t)alpha);
+        for (uint32_t i = 0; i < h; i++, ac += 8) {
+            uint8_t *row = dst + (ptrdiff_t)i * stride;
+            const __m128i dc = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(const void *)row));
+            const __m128i v = cfl_apply_128(dc, _mm_loadu_si128((const __m128i *)(const void *)ac), a);
+            _mm_storel_epi64((__m128i *)(void *)row, _mm_packus_epi16(v, v));
+        }
+        return;
+    }
+    const __m256i a = _mm256_set1_epi16((int16_t)alpha);
+    for (uint32_t i = 0; i < h; i++, ac += w) {
+        uint8_t *row = dst + (ptrdiff_t)i * stride;
+        for (uint32_t j = 0; j < w; j += 16) {
+            const __m256i dc = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(row + j)));
+            const __m256i x = _mm256_mullo_epi16(_mm256_loadu_si256((const __m256i *)(const void *)(ac + j)), a);
+            const __m256i mag = _mm256_srli_epi16(_mm256_add_epi16(_mm256_abs_epi16(x), _mm256_set1_epi16(32)), 6);
+            const __m256i v = _mm256_add_epi16(dc, _mm256_sign_epi16(mag, x));
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+            _mm_storeu_si128((__m128i *)(void *)(row + j), _mm256_castsi256_si128(packed));
+        }
+    }
+}
+
+bool av1_cfl_dsp_init_avx2(Av1CflDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->subsample[AV1_CFL_444] = subsample_444_avx2;
+    dsp->subsample[AV1_CFL_422] = subsample_422_avx2;
+    dsp->subsample[AV1_CFL_420] = subsample_420_avx2;
+    dsp->subtract_average = subtract_average_avx2;
+    dsp->predict = predict_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_cfl.c uses the scalar reference.
+typedef int av1_cfl_x86_unused;
+
+#endif
@@ -0,0 +1,107 @@
+#include "av1_cpu.h"
+
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Resolved flags plus AV1_CPU_RESOLVED. Resolving is idempotent, so threads that race on the
+// first call store the same value.
+#define AV1_CPU_RESOLVED (1u << 31)
+
+static _Atomic uint32_t g_flags;
+
+static const struct {
+    const char *name;
+    uint32_t mask;
+} kLevels[] = {
+    {"c", 0u},
+    {"sse2", AV1_CPU_SSE2},
+    {"ssse3", AV1_CPU_SSE2 | AV1_CPU_SSSE3},
+    {"sse4.1", AV1_CPU_SSE2 | AV1_CPU_SSSE3 | AV1_CPU_SSE41},
+    {"avx2", AV1_CPU_SSE2 | AV1_CPU_SSSE3 | AV1_CPU_SSE41 | AV1_CPU_AVX2},
+    {"avx512", AV1_CPU_ALL},
+};
+
+static bool name_equal(const char *a, const char *b) {
+    for (; *a && *b; a++, b++) {
+        if (tolower((unsigned char)*a) != *b) {
+            return false;
+        }
+    }
+    return *a == *b;
+}
+
+uint32_t av1_cpu_detect(void) {
+    uint32_t f = 0;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        f |= AV1_CPU_SSE2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        f |= AV1_CPU_SSSE3;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        f |= AV1_CPU_SSE41;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        f |= AV1_CPU_AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl")) {
+        f |= AV1_CPU_AVX512;
+    }
+#endif
+    return f;
+}
+
+uint32_t av1_cpu_flags(void) {
+    uint32_t f = atomic_load_explicit(&g_flags, memory_order_relaxed);
+    if (f & AV1_CPU_RESOLVED) {
+        return f & AV1_CPU_ALL;
+    }
+    uint32_t mask = AV1_CPU_ALL;
+    const char *env = getenv("AV1_CPU_MASK");
+    if (env && !av1_cpu_parse_mask(env, &mask)) {
+        mask = AV1_CPU_ALL;
+    }
+    f = av1_cpu_detect() & mask;
+    atomic_store_explicit(&g_flags, f | AV1_CPU_RESOLVED, memory_order_relaxed);
+    return f;
+}
+
+void av1_cpu_set_mask(uint32_t mask) {
+    atomic_store_explicit(&g_flags, (av1_cpu_detect() & mask & AV1_CPU_ALL) | AV1_CPU_RESOLVED, memory_order_relaxed);
+}
+
+bool av1_cpu_parse_mask(const char *s, uint32_t *mask) {
+    if (!s || !mask || !*s) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(kLevels) / sizeof(kLevels[0]); i++) {
+        if (name_equal(s, kLevels[i].name)) {
+            *mask = kLevels[i].mask;
+            return true;
+        }
+    }
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+    char *end = NULL;
+    const unsigned long v = strtoul(s, &end, 0);
+    if (!end || *end != 0 || v > AV1_CPU_ALL) {
+        return false;
+    }
+    *mask = (uint32_t)v;
+    return true;
+}
+
+const char *av1_cpu_name(uint32_t flags) {
+    const char *name = kLevels[0].name;
+    for (size_t i = 1; i < sizeof(kLevels) / sizeof(kLevels[0]); i++) {
+        if (flags & kLevels[i].mask & ~kLevels[i - 1].mask) {
+            name = kLevels[i].name;
+        }
+    }
+    return name;
+}
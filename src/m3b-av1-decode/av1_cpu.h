@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Run-time CPU features for kernel dispatch.
+//
+// Every *_dsp_init() (and the inverse transform kernel choice) asks av1_cpu_flags() which
+// instruction sets it may use. The answer is the set the CPU reports, narrowed by a mask: set it
+// with av1_cpu_set_mask() (the av1_framehdr --cpu-mask flag) or the AV1_CPU_MASK environment
+// variable, so benchmarks and bit-exactness checks can force the scalar or any lower SIMD path
+// in the same binary. Levels are cumulative: masking to SSE4.1 also drops AVX2 and AVX-512.
+
+#define AV1_CPU_SSE2 (1u << 0)
+#define AV1_CPU_SSSE3 (1u << 1)
+#define AV1_CPU_SSE41 (1u << 2)
+#define AV1_CPU_AVX2 (1u << 3)
+#define AV1_CPU_AVX512 (1u << 4) // AVX-512 F, BW, DQ and VL
+#define AV1_CPU_ALL 0x1fu
+
+// Features the CPU reports (no mask applied).
+uint32_t av1_cpu_detect(void);
+
+// av1_cpu_detect() & mask. The mask is AV1_CPU_MASK when set and valid, else AV1_CPU_ALL, unless
+// av1_cpu_set_mask() was called. Resolved once; safe to call from any thread.
+uint32_t av1_cpu_flags(void);
+
+// Replaces the mask. Tables that are already initialized keep their kernels, so call this before
+// creating decoder contexts.
+void av1_cpu_set_mask(uint32_t mask);
+
+// Parses a mask: a level name ("c", "sse2", "ssse3", "sse4.1", "avx2", "avx512": that level and
+// every level below it) or a number of AV1_CPU_* bits ("0x8"). Case-insensitive.
+bool av1_cpu_parse_mask(const char *s, uint32_t *mask);
+
+// Level name of the highest bit of flags ("c" for none).
+const char *av1_cpu_name(uint32_t flags);
@@ -6,6 +6,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "av1_dequant.h"
+#include "av1_intrabc.h"
+#include "av1_inv_txfm.h"
+#include "av1_palette.h"
+#include "av1_segmap.h"
 #include "av1_symbol.h"
 
 // Spec default CDF initializers extracted from the local av1bitstream.html.
@@ -79,11 +84,25 @@ static bool mi_size_index_from_wlog2_hlog2(uint32_t wlog2, uint32_t hlog2, uint3
 
 #define AV1_INTRA_TX_TYPE_SET1_SYMBOLS 7u
 #define AV1_INTRA_TX_TYPE_SET2_SYMBOLS 5u
+#define AV1_INTER_TX_TYPE_SET1_SYMBOLS 16u
+#define AV1_INTER_TX_TYPE_SET2_SYMBOLS 12u
+#define AV1_INTER_TX_TYPE_SET3_SYMBOLS 2u
 
 // Minimal transform-set identifiers (spec names).
 #define AV1_TX_SET_DCTONLY 0u
 #define AV1_TX_SET_INTRA_1 1u
 #define AV1_TX_SET_INTRA_2 2u
+#define AV1_TX_SET_INTER_1 1u
+#define AV1_TX_SET_INTER_2 2u
+#define AV1_TX_SET_INTER_3 3u
+
+// Intra block copy: read_mv() with MvCtx == MV_INTRABC_CONTEXT and find_mv_stack( 0 ).
+#define AV1_MV_JOINTS 4u
+#define AV1_MV_CLASSES 11u
+#define AV1_MV_OFFSET_BITS 10u
+#define AV1_MAX_REF_MV_STACK_SIZE 8u
+#define AV1_REF_CAT_LEVEL 640u
+#define AV1_MV_BORDER 128
 
 // Minimal transform-type identifiers (internal values; only used for tx_class and stats).
 #define AV1_TX_TYPE_IDTX 0u
@@ -93,6 +112,16 @@ static bool mi_size_index_from_wlog2_hlog2(uint32_t wlog2, uint32_t hlog2, uint3
 #define AV1_TX_TYPE_ADST_ADST 4u
 #define AV1_TX_TYPE_ADST_DCT 5u
 #define AV1_TX_TYPE_DCT_ADST 6u
+// The remaining types only occur in the inter sets (intra block copy).
+#define AV1_TX_TYPE_V_ADST 7u
+#define AV1_TX_TYPE_H_ADST 8u
+#define AV1_TX_TYPE_V_FLIPADST 9u
+#define AV1_TX_TYPE_H_FLIPADST 10u
+#define AV1_TX_TYPE_FLIPADST_DCT 11u
+#define AV1_TX_TYPE_DCT_FLIPADST 12u
+#define AV1_TX_TYPE_FLIPADST_FLIPADST 13u
+#define AV1_TX_TYPE_ADST_FLIPADST 14u
+#define AV1_TX_TYPE_FLIPADST_ADST 15u
 
 // TX class identifiers aligned with Sig_Ref_Diff_Offset ordering in the spec.
 #define AV1_TX_CLASS_2D 0u
@@ -249,7 +278,6 @@ static const uint8_t kAdjustedTxSize[AV1_TX_SIZES_ALL] = {
 #define AV1_DELTA_Q_ABS_SYMBOLS (AV1_DELTA_Q_SMALL + 1u)  // symbols 0..DELTA_Q_SMALL
 #define AV1_DELTA_LF_ABS_SYMBOLS (AV1_DELTA_LF_SMALL + 1u) // symbols 0..DELTA_LF_SMALL
 #define AV1_FRAME_LF_COUNT 4u
-#define AV1_MAX_LOOP_FILTER 63
 
 // Segmentation (tile-coded) constants.
 #define AV1_MAX_SEGMENTS 8u
@@ -284,6 +312,12 @@ typedef struct {
 
    // Per-MI segment_id (0..7). Default 0.
    uint8_t segment_id;
+
+   // Per-MI use_intrabc (IsInters; intra frames have no other inter blocks) and its DV (Mvs[][][ 0 ],
+   // row then column, 1/8 luma samples). Only intra block copy blocks are candidates of
+   // find_mv_stack(), and a never-decoded MI reads as not inter. Default 0.
+   uint8_t is_inter;
+   int16_t mv[2];
 } Av1MiSize;
 
 typedef struct {
@@ -331,6 +365,11 @@ typedef struct {
    uint16_t palette_y_size[AV1_PALETTE_BLOCK_SIZE_CONTEXTS][AV1_PALETTE_SIZES + 1u];
    uint16_t palette_uv_size[AV1_PALETTE_BLOCK_SIZE_CONTEXTS][AV1_PALETTE_SIZES + 1u];
 
+   // Mutable per-tile CDF copies: palette_color_idx_y / _uv, indexed by PaletteSize - 2 (the
+   // entries past PaletteSize + 1 are unused).
+   uint16_t palette_y_color[AV1_PALETTE_SIZES][AV1_PALETTE_COLOR_CONTEXTS][AV1_PALETTE_MAX_COLORS + 1u];
+   uint16_t palette_uv_color[AV1_PALETTE_SIZES][AV1_PALETTE_COLOR_CONTEXTS][AV1_PALETTE_MAX_COLORS + 1u];
+
    // Mutable per-tile CDF copies: segment_id.
    uint16_t segment_id[AV1_SEGMENT_ID_CONTEXTS][AV1_MAX_SEGMENTS + 1u];
 
@@ -347,6 +386,23 @@ typedef struct {
    uint16_t intra_tx_type_set1[2][AV1_INTRA_MODES][8];
    uint16_t intra_tx_type_set2[3][AV1_INTRA_MODES][6];
 
+   // Mutable per-tile CDF copies: intra block copy. Intra frames only use MvCtx ==
+   // MV_INTRABC_CONTEXT, so the MV CDFs keep that context only ([comp] below). force_integer_mv is
+   // 1, so the fractional and high-precision bits are never coded.
+   uint16_t intrabc[3];
+   uint16_t mv_joint[AV1_MV_JOINTS + 1u];
+   uint16_t mv_sign[2][3];
+   uint16_t mv_class[2][AV1_MV_CLASSES + 1u];
+   uint16_t mv_class0_bit[2][3];
+   uint16_t mv_bit[2][AV1_MV_OFFSET_BITS][3];
+
+   // Mutable per-tile CDF copies: inter_tx_type (intra block copy blocks are inter blocks).
+   // Spec: TileInterTxTypeSet1Cdf[ Tx_Size_Sqr[ txSz ] ], TileInterTxTypeSet2Cdf,
+   // TileInterTxTypeSet3Cdf[ Tx_Size_Sqr[ txSz ] ].
+   uint16_t inter_tx_type_set1[2][AV1_INTER_TX_TYPE_SET1_SYMBOLS + 1u];
+   uint16_t inter_tx_type_set2[AV1_INTER_TX_TYPE_SET2_SYMBOLS + 1u];
+   uint16_t inter_tx_type_set3[4][AV1_INTER_TX_TYPE_SET3_SYMBOLS + 1u];
+
    // Mutable per-tile CDF copies: delta_q_abs and delta_lf_abs.
    // Spec: TileDeltaQCdf, TileDeltaLFCdf, TileDeltaLFMultiCdf[i].
    uint16_t delta_q_abs[AV1_DELTA_Q_ABS_SYMBOLS + 1u];
@@ -402,6 +458,23 @@ typedef struct {
    uint8_t *left_dc[AV1_MAX_PLANES];
    uint32_t cols[AV1_MAX_PLANES];
    uint32_t rows[AV1_MAX_PLANES];
+
+   // Fused dequantization: per-segment quantizers and the inverse transform input of the
+   // current transform block (Dequant[][], row stride = transform width, 64x64 max). The buffer
+   // is all zero between blocks; coeffs() writes the non-zero entries and the consumer clears
+   // them again (dequant_buf_clear).
+   Av1DequantLut dequant;
+   Av1DequantDsp dequant_dsp;
+   int32_t *dequant_buf;
+
+   // palette_mode_info() / palette_tokens(): PaletteColors[ 0 / 1 ] of the last block covering each
+   // MI column (above, [col][plane][]) and MI row (left, [row][plane][]) of the tile; the sizes
+   // live in the MI grid. V colors are never cached. color_map[ 0 / 1 ] hold ColorMapY / ColorMapUV
+   // of the current block (row stride AV1_PALETTE_MAX_DIM).
+   uint16_t *palette_above;
+   uint16_t *palette_left;
+   uint8_t *color_map[2];
+   uint16_t palette_colors[AV1_MAX_PLANES][AV1_PALETTE_MAX_COLORS];
 } Av1TileCoeffCtx;
 
 static void tile_coeff_ctx_free(Av1TileCoeffCtx *ctx);
@@ -458,6 +531,16 @@ static bool tile_coeff_ctx_init(Av1TileCoeffCtx *ctx,
          }
       }
    }
+
+   ctx->palette_above = (uint16_t *)calloc((size_t)tile_mi_cols * 2u * AV1_PALETTE_MAX_COLORS, sizeof(uint16_t));
+   ctx->palette_left = (uint16_t *)calloc((size_t)tile_mi_rows * 2u * AV1_PALETTE_MAX_COLORS, sizeof(uint16_t));
+   ctx->color_map[0] = (uint8_t *)malloc(AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM);
+   ctx->color_map[1] = (uint8_t *)malloc(AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM);
+   if (!ctx->palette_above || !ctx->palette_left || !ctx->color_map[0] || !ctx->color_map[1]) {
+      snprintf(err, err_cap, "out of memory allocating palette ctx (tile_mi=%ux%u)", tile_mi_cols, tile_mi_rows);
+      tile_coeff_ctx_free(ctx);
+      return false;
+   }
    return true;
 }
 
@@ -469,9 +552,59 @@ static void tile_coeff_ctx_free(Av1TileCoeffCtx *ctx) {
       free(ctx->above_dc[plane]);
       free(ctx->left_dc[plane]);
    }
+   free(ctx->dequant_buf);
+   free(ctx->palette_above);
+   free(ctx->palette_left);
+   free(ctx->color_map[0]);
+   free(ctx->color_map[1]);
    memset(ctx, 0, sizeof(*ctx));
 }
 
+static uint32_t qindex_for_segment(const Av1TileDecodeParams *params, uint32_t segment_id);
+static bool lossless_for_segment(const Av1TileDecodeParams *params, uint32_t segment_id);
+
+// Builds the per-segment quantizer lookups (get_qindex( 1, segmentId ) for every segment, with
+// SegQMLevel), the dequant kernels and the zeroed transform input buffer.
+static bool tile_coeff_ctx_init_dequant(Av1TileCoeffCtx *ctx, const Av1TileDecodeParams *params, char *err, size_t err_cap) {
+   uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS];
+   for (uint32_t s = 0; s < AV1_DEQUANT_SEGMENTS; s++) {
+      seg_qindex[s] = qindex_for_segment(params, s);
+   }
+   av1_dequant_lut_init(&ctx->dequant,
+                        params->bit_depth ? params->bit_depth : 8u,
+                        seg_qindex,
+                        params->delta_q_y_dc,
+                        params->delta_q_u_dc,
+                        params->delta_q_u_ac,
+                        params->delta_q_v_dc,
+                        params->delta_q_v_ac);
+   bool seg_lossless[AV1_DEQUANT_SEGMENTS];
+   for (uint32_t s = 0; s < AV1_DEQUANT_SEGMENTS; s++) {
+      seg_lossless[s] = lossless_for_segment(params, s);
+   }
+   av1_dequant_lut_set_qm(&ctx->dequant, params->using_qmatrix, params->qm_y, params->qm_u, params->qm_v, seg_lossless);
+   av1_dequant_dsp_init(&ctx->dequant_dsp);
+   ctx->dequant_buf = (int32_t *)aligned_alloc(64, AV1_TXFM_MAX_DIM * AV1_TXFM_MAX_DIM * sizeof(int32_t));
+   if (!ctx->dequant_buf) {
+      snprintf(err, err_cap, "out of memory allocating dequant buffer");
+      return false;
+   }
+   memset(ctx->dequant_buf, 0, AV1_TXFM_MAX_DIM * AV1_TXFM_MAX_DIM * sizeof(int32_t));
+   return true;
+}
+
+// Restores the all-zero invariant of the transform input buffer after a block was consumed:
+// only the extent's bounding box can hold non-zero entries.
+static void dequant_buf_clear(int32_t *buf, uint32_t tx_size, const Av1TxCoeffExtent *e) {
+   if (e->eob == 0u) {
+      return;
+   }
+   const uint32_t stride = 1u << kTxWidthLog2[tx_size];
+   for (uint32_t i = 0; i <= e->max_row; i++) {
+      memset(buf + (size_t)i * stride, 0, (e->max_col + 1u) * sizeof(int32_t));
+   }
+}
+
 static uint32_t dc_sign_ctx(const Av1TileCoeffCtx *ctx, uint32_t plane, uint32_t x4, uint32_t y4, uint32_t w4, uint32_t h4) {
    if (!ctx || plane >= AV1_MAX_PLANES) {
       return 0u;
@@ -1235,17 +1368,40 @@ static uint32_t get_tx_set_intra(uint32_t tx_size, uint32_t reduced_tx_set) {
    return AV1_TX_SET_INTRA_1;
 }
 
+static uint32_t get_tx_set_inter(uint32_t tx_size, uint32_t reduced_tx_set) {
+   // Spec get_tx_set(txSz) for is_inter==1.
+   if (tx_size >= AV1_TX_SIZES_ALL) {
+      return AV1_TX_SET_DCTONLY;
+   }
+   const uint32_t txSzSqr = (uint32_t)kTxSizeSqr[tx_size];
+   const uint32_t txSzSqrUp = (uint32_t)kTxSizeSqrUp[tx_size];
+   if (txSzSqrUp > 3u) {
+      return AV1_TX_SET_DCTONLY;
+   }
+   if (reduced_tx_set || txSzSqrUp == 3u) {
+      return AV1_TX_SET_INTER_3;
+   }
+   if (txSzSqr == 2u /* TX_16X16 */) {
+      return AV1_TX_SET_INTER_2;
+   }
+   return AV1_TX_SET_INTER_1;
+}
+
 static uint32_t get_tx_class_from_tx_type(uint32_t tx_type) {
    // Spec get_tx_class(txType).
-   if (tx_type == AV1_TX_TYPE_V_DCT /* || V_ADST || V_FLIPADST (not present yet) */) {
+   if (tx_type == AV1_TX_TYPE_V_DCT || tx_type == AV1_TX_TYPE_V_ADST || tx_type == AV1_TX_TYPE_V_FLIPADST) {
       return AV1_TX_CLASS_VERT;
    }
-   if (tx_type == AV1_TX_TYPE_H_DCT /* || H_ADST || H_FLIPADST (not present yet) */) {
+   if (tx_type == AV1_TX_TYPE_H_DCT || tx_type == AV1_TX_TYPE_H_ADST || tx_type == AV1_TX_TYPE_H_FLIPADST) {
       return AV1_TX_CLASS_HORIZ;
    }
    return AV1_TX_CLASS_2D;
 }
 
+// Default_Scan_4x4: the scan of every lossless block (TX_4X4, DCT_DCT), kept as a table so those
+// blocks skip build_scan().
+static const uint16_t kDefaultScan4x4[16] = {0, 1, 4, 8, 5, 2, 3, 6, 9, 12, 13, 10, 7, 11, 14, 15};
+
 static void build_scan(uint32_t tx_class, uint32_t width, uint32_t height, uint16_t *out_scan) {
    // Builds a scan[] array mapping coefficient index c -> raster pos.
    // - 2D: diagonal zigzag (Default_Scan_*).
@@ -1550,6 +1706,87 @@ static const uint16_t kDefaultPaletteUVSizeCdf[AV1_PALETTE_BLOCK_SIZE_CONTEXTS][
    {1269, 5435, 10433, 18963, 21700, 25865, 32768, 0},
 };
 
+// Default_Palette_Size_{2..8}_{Y,Uv}_Color_Cdf, padded to 8 symbols.
+static const uint16_t kDefaultPaletteYColorCdf[AV1_PALETTE_SIZES][AV1_PALETTE_COLOR_CONTEXTS][AV1_PALETTE_MAX_COLORS + 1u] = {
+   {{28710, 32768, 0}, {16384, 32768, 0}, {10553, 32768, 0}, {27036, 32768, 0}, {31603, 32768, 0}},
+   {{27877, 30490, 32768, 0}, {11532, 25697, 32768, 0}, {6544, 30234, 32768, 0}, {23018, 28072, 32768, 0}, {31915, 32385, 32768, 0}},
+   {
+      {25572, 28046, 30045, 32768, 0},
+      {9478, 21590, 27256, 32768, 0},
+      {7248, 26837, 29824, 32768, 0},
+      {19167, 24486, 28349, 32768, 0},
+      {31400, 31825, 32250, 32768, 0},
+   },
+   {
+      {24779, 26955, 28576, 30282, 32768, 0},
+      {8669, 20364, 24073, 28093, 32768, 0},
+      {4255, 27565, 29377, 31067, 32768, 0},
+      {19864, 23674, 26716, 29530, 32768, 0},
+      {31646, 31893, 32147, 32426, 32768, 0},
+   },
+   {
+      {23132, 25407, 26970, 28435, 30073, 32768, 0},
+      {7443, 17242, 20717, 24762, 27982, 32768, 0},
+      {6300, 24862, 26944, 28784, 30671, 32768, 0},
+      {18916, 22895, 25267, 27435, 29652, 32768, 0},
+      {31270, 31550, 31808, 32059, 32353, 32768, 0},
+   },
+   {
+      {23105, 25199, 26464, 27684, 28931, 30318, 32768, 0},
+      {6950, 15447, 18952, 22681, 25567, 28563, 32768, 0},
+      {7560, 23474, 25490, 27203, 28921, 30708, 32768, 0},
+      {18544, 22373, 24457, 26195, 28119, 30045, 32768, 0},
+      {31198, 31451, 31670, 31882, 32123, 32391, 32768, 0},
+   },
+   {
+      {21689, 23883, 25163, 26352, 27506, 28827, 30195, 32768, 0},
+      {6892, 15385, 17840, 21606, 24287, 26753, 29204, 32768, 0},
+      {5651, 23182, 25042, 26518, 27982, 29392, 30900, 32768, 0},
+      {19349, 22578, 24418, 25994, 27524, 29031, 30448, 32768, 0},
+      {31028, 31270, 31504, 31705, 31927, 32153, 32392, 32768, 0},
+   },
+};
+
+static const uint16_t kDefaultPaletteUVColorCdf[AV1_PALETTE_SIZES][AV1_PALETTE_COLOR_CONTEXTS][AV1_PALETTE_MAX_COLORS + 1u] = {
+   {{29089, 32768, 0}, {16384, 32768, 0}, {8713, 32768, 0}, {29257, 32768, 0}, {31610, 32768, 0}},
+   {{25257, 29145, 32768, 0}, {12287, 27293, 32768, 0}, {7033, 27960, 32768, 0}, {20145, 25405, 32768, 0}, {30608, 31639, 32768, 0}},
+   {
+      {24210, 27175, 29903, 32768, 0},
+      {9888, 22386, 27214, 32768, 0},
+      {5901, 26053, 29293, 32768, 0},
+      {18318, 22152, 28333, 32768, 0},
+      {30459, 31136, 31926, 32768, 0},
+   },
+   {
+      {22980, 25479, 27781, 29986, 32768, 0},
+      {8413, 21408, 24859, 28874, 32768, 0},
+      {2257, 29449, 30594, 31598, 32768, 0},
+      {19189, 21202, 25915, 28620, 32768, 0},
+      {31844, 32044, 32281, 32518, 32768, 0},
+   },
+   {
+      {22217, 24567, 26637, 28683, 30548, 32768, 0},
+      {7307, 16406, 19636, 24632, 28424, 32768, 0},
+      {4441, 25064, 26879, 28942, 30919, 32768, 0},
+      {17210, 20528, 23319, 26750, 29582, 32768, 0},
+      {30674, 30953, 31396, 31735, 32207, 32768, 0},
+   },
+   {
+      {21239, 23168, 25044, 26962, 28705, 30506, 32768, 0},
+      {6545, 15012, 18004, 21817, 25503, 28701, 32768, 0},
+      {3448, 26295, 27437, 28704, 30126, 31442, 32768, 0},
+      {15889, 18323, 21704, 24698, 26976, 29690, 32768, 0},
+      {30988, 31204, 31479, 31734, 31983, 32325, 32768, 0},
+   },
+   {
+      {21442, 23288, 24758, 26246, 27649, 28980, 30563, 32768, 0},
+      {5863, 14933, 17552, 20668, 23683, 26411, 29273, 32768, 0},
+      {3415, 25810, 26877, 27990, 29223, 30394, 31618, 32768, 0},
+      {17965, 20084, 22232, 23974, 26274, 28402, 30390, 32768, 0},
+      {31190, 31329, 31516, 31679, 31825, 32026, 32322, 32768, 0},
+   },
+};
+
 // Default segment_id CDF tables from the AV1 spec (see local av1bitstream.html).
 static const uint16_t kDefaultSegmentIdCdf[AV1_SEGMENT_ID_CONTEXTS][AV1_MAX_SEGMENTS + 1u] = {
    {5622, 7893, 16093, 18233, 27809, 28373, 32533, 32768, 0},
@@ -1582,6 +1819,38 @@ static const uint16_t kDefaultTx64x64Cdf[AV1_TX_SIZE_CONTEXTS][4] = {
    {16803, 22759, 32768, 0},
 };
 
+// Intra block copy (use_intrabc, read_mv() and inter_tx_type).
+static const uint16_t kDefaultIntrabcCdf[3] = {30531, 32768, 0};
+static const uint16_t kDefaultMvJointCdf[AV1_MV_JOINTS + 1u] = {4096, 11264, 19328, 32768, 0};
+static const uint16_t kDefaultMvClassCdf[AV1_MV_CLASSES + 1u] = {28672, 30976, 31858, 32320, 32551, 32656, 32740, 32757, 32762, 32767, 32768, 0};
+static const uint16_t kDefaultMvSignCdf[3] = {128 * 128, 32768, 0};
+static const uint16_t kDefaultMvClass0BitCdf[3] = {216 * 128, 32768, 0};
+static const uint16_t kDefaultMvBitCdf[AV1_MV_OFFSET_BITS][3] = {
+   {136 * 128, 32768, 0},
+   {140 * 128, 32768, 0},
+   {148 * 128, 32768, 0},
+   {160 * 128, 32768, 0},
+   {176 * 128, 32768, 0},
+   {192 * 128, 32768, 0},
+   {224 * 128, 32768, 0},
+   {234 * 128, 32768, 0},
+   {234 * 128, 32768, 0},
+   {240 * 128, 32768, 0},
+};
+
+static const uint16_t kDefaultInterTxTypeSet1Cdf[2][AV1_INTER_TX_TYPE_SET1_SYMBOLS + 1u] = {
+   {4458, 5560, 7695, 9709, 13330, 14789, 17537, 20266, 21504, 22848, 23934, 25474, 27727, 28915, 30631, 32768, 0},
+   {1645, 2573, 4778, 5711, 7807, 8622, 10522, 15357, 17674, 20408, 22517, 25010, 27116, 28856, 30749, 32768, 0},
+};
+static const uint16_t kDefaultInterTxTypeSet2Cdf[AV1_INTER_TX_TYPE_SET2_SYMBOLS + 1u] = {
+   770, 2421, 5225, 12907, 15819, 18927, 21561, 24089, 26595, 28526, 30529, 32768, 0};
+static const uint16_t kDefaultInterTxTypeSet3Cdf[4][AV1_INTER_TX_TYPE_SET3_SYMBOLS + 1u] = {
+   {16384, 32768, 0},
+   {4167, 32768, 0},
+   {1998, 32768, 0},
+   {748, 32768, 0},
+};
+
 static bool max_tx_size_rect_from_mi_size(uint32_t mi_size, uint32_t *out_tx_size) {
    // From AV1 spec Max_Tx_Size_Rect[BLOCK_SIZES] table.
    static const uint8_t kMaxTxSizeRect[AV1_BLOCK_SIZES] = {
@@ -1675,6 +1944,22 @@ static bool is_tx_type_in_set_intra(uint32_t tx_set, uint32_t tx_type) {
    return true;
 }
 
+static bool is_tx_type_in_set_inter(uint32_t tx_set, uint32_t tx_type) {
+   // Tx_Type_In_Set_Inter: INTER_1 has all 16 types, INTER_2 all but the 1D ADST / FLIPADST ones,
+   // INTER_3 only IDTX and DCT_DCT.
+   if (tx_set == AV1_TX_SET_DCTONLY) {
+      return tx_type == AV1_TX_TYPE_DCT_DCT;
+   }
+   if (tx_set == AV1_TX_SET_INTER_2) {
+      return tx_type != AV1_TX_TYPE_V_ADST && tx_type != AV1_TX_TYPE_H_ADST && tx_type != AV1_TX_TYPE_V_FLIPADST &&
+             tx_type != AV1_TX_TYPE_H_FLIPADST;
+   }
+   if (tx_set == AV1_TX_SET_INTER_3) {
+      return tx_type == AV1_TX_TYPE_IDTX || tx_type == AV1_TX_TYPE_DCT_DCT;
+   }
+   return true;
+}
+
 static void tile_coeff_cdfs_init(Av1TileCoeffCdfs *out, uint32_t base_q_idx) {
    if (!out) return;
    const uint32_t qctx = coeff_cdf_q_ctx_from_base_q_idx(base_q_idx);
@@ -1801,6 +2086,12 @@ static void tile_skip_cdfs_init(Av1TileSkipCdfs *t) {
    cdf_copy_u16(&t->palette_uv_mode[0][0], &kDefaultPaletteUVModeCdf[0][0], AV1_PALETTE_UV_MODE_CONTEXTS * 3u);
    cdf_copy_u16(&t->palette_y_size[0][0], &kDefaultPaletteYSizeCdf[0][0], AV1_PALETTE_BLOCK_SIZE_CONTEXTS * (AV1_PALETTE_SIZES + 1u));
    cdf_copy_u16(&t->palette_uv_size[0][0], &kDefaultPaletteUVSizeCdf[0][0], AV1_PALETTE_BLOCK_SIZE_CONTEXTS * (AV1_PALETTE_SIZES + 1u));
+   cdf_copy_u16(&t->palette_y_color[0][0][0],
+                &kDefaultPaletteYColorCdf[0][0][0],
+                AV1_PALETTE_SIZES * AV1_PALETTE_COLOR_CONTEXTS * (AV1_PALETTE_MAX_COLORS + 1u));
+   cdf_copy_u16(&t->palette_uv_color[0][0][0],
+                &kDefaultPaletteUVColorCdf[0][0][0],
+                AV1_PALETTE_SIZES * AV1_PALETTE_COLOR_CONTEXTS * (AV1_PALETTE_MAX_COLORS + 1u));
 
    cdf_copy_u16(&t->segment_id[0][0], &kDefaultSegmentIdCdf[0][0], AV1_SEGMENT_ID_CONTEXTS * (AV1_MAX_SEGMENTS + 1u));
 
@@ -1812,6 +2103,18 @@ static void tile_skip_cdfs_init(Av1TileSkipCdfs *t) {
    cdf_copy_u16(&t->intra_tx_type_set1[0][0][0], &kDefaultIntraTxTypeSet1Cdf[0][0][0], 2u * AV1_INTRA_MODES * 8u);
    cdf_copy_u16(&t->intra_tx_type_set2[0][0][0], &kDefaultIntraTxTypeSet2Cdf[0][0][0], 3u * AV1_INTRA_MODES * 6u);
 
+   cdf_copy_u16(&t->intrabc[0], &kDefaultIntrabcCdf[0], 3u);
+   cdf_copy_u16(&t->mv_joint[0], &kDefaultMvJointCdf[0], AV1_MV_JOINTS + 1u);
+   for (uint32_t comp = 0; comp < 2u; comp++) {
+      cdf_copy_u16(&t->mv_sign[comp][0], &kDefaultMvSignCdf[0], 3u);
+      cdf_copy_u16(&t->mv_class[comp][0], &kDefaultMvClassCdf[0], AV1_MV_CLASSES + 1u);
+      cdf_copy_u16(&t->mv_class0_bit[comp][0], &kDefaultMvClass0BitCdf[0], 3u);
+      cdf_copy_u16(&t->mv_bit[comp][0][0], &kDefaultMvBitCdf[0][0], AV1_MV_OFFSET_BITS * 3u);
+   }
+   cdf_copy_u16(&t->inter_tx_type_set1[0][0], &kDefaultInterTxTypeSet1Cdf[0][0], 2u * (AV1_INTER_TX_TYPE_SET1_SYMBOLS + 1u));
+   cdf_copy_u16(&t->inter_tx_type_set2[0], &kDefaultInterTxTypeSet2Cdf[0], AV1_INTER_TX_TYPE_SET2_SYMBOLS + 1u);
+   cdf_copy_u16(&t->inter_tx_type_set3[0][0], &kDefaultInterTxTypeSet3Cdf[0][0], 4u * (AV1_INTER_TX_TYPE_SET3_SYMBOLS + 1u));
+
    cdf_copy_u16(&t->delta_q_abs[0], &kDefaultDeltaQCdf[0], AV1_DELTA_Q_ABS_SYMBOLS + 1u);
    cdf_copy_u16(&t->delta_lf_abs[0], &kDefaultDeltaLFCdf[0], AV1_DELTA_LF_ABS_SYMBOLS + 1u);
    cdf_copy_u16(&t->delta_lf_multi[0][0], &kDefaultDeltaLFCdf[0], AV1_FRAME_LF_COUNT * (AV1_DELTA_LF_ABS_SYMBOLS + 1u));
@@ -2255,6 +2558,7 @@ static void mi_set_palette_sizes_block(Av1MiSize *mi_grid,
    }
 }
 
+// SegmentIds[][] of a decoded block, clipped to the tile.
 static void mi_set_segment_id_block(Av1MiSize *mi_grid,
                                    uint32_t mi_rows,
                                    uint32_t mi_cols,
@@ -2263,74 +2567,72 @@ static void mi_set_segment_id_block(Av1MiSize *mi_grid,
                                    uint32_t wlog2,
                                    uint32_t hlog2,
                                    uint32_t segment_id) {
-   const uint32_t w = 1u << wlog2;
-   const uint32_t h = 1u << hlog2;
-   for (uint32_t rr = 0; rr < h; rr++) {
-      for (uint32_t cc = 0; cc < w; cc++) {
-         const uint32_t y = r + rr;
-         const uint32_t x = c + cc;
-         if (y < mi_rows && x < mi_cols) {
-            mi_grid[mi_index(y, x, mi_cols)].segment_id = (uint8_t)segment_id;
-         }
+   if (r >= mi_rows || c >= mi_cols) {
+      return;
+   }
+   const uint32_t w = (1u << wlog2) < mi_cols - c ? (1u << wlog2) : mi_cols - c;
+   const uint32_t h = (1u << hlog2) < mi_rows - r ? (1u << hlog2) : mi_rows - r;
+   for (uint32_t y = 0; y < h; y++) {
+      Av1MiSize *row = &mi_grid[mi_index(r + y, c, mi_cols)];
+      for (uint32_t x = 0; x < w; x++) {
+         row[x].segment_id = (uint8_t)segment_id;
       }
    }
 }
 
-static uint32_t segment_id_ctx_from_mi_grid(const Av1MiSize *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c) {
-   if (!mi_grid || r >= mi_rows || c >= mi_cols) {
-      return 0u;
-   }
-
-   const bool availU = (r > 0u);
-   const bool availL = (c > 0u);
-   const bool availUL = availU && availL;
-
-   const int32_t prevUL = availUL ? (int32_t)mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id : -1;
-   const int32_t prevU = availU ? (int32_t)mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id : -1;
-   const int32_t prevL = availL ? (int32_t)mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : -1;
-
-   uint32_t ctx = 0u;
-   if (prevUL < 0) {
-      ctx = 0u;
-   } else if ((prevUL == prevU) && (prevUL == prevL)) {
-      ctx = 2u;
-   } else if ((prevUL == prevU) || (prevUL == prevL) || (prevU == prevL)) {
-      ctx = 1u;
-   } else {
-      ctx = 0u;
+// Copies the segment_ids of a decoded superblock from the MI grid into the frame-wide packed map
+// (Av1TileDecodeParams.segmap). Superblock columns start on whole bytes of the packed rows, so
+// this is a plain store per MI row.
+static void segmap_store_sb(const Av1TileDecodeParams *params,
+                            const Av1MiSize *mi_grid,
+                            uint32_t mi_rows,
+                            uint32_t mi_cols,
+                            uint32_t r0,
+                            uint32_t c0,
+                            uint32_t sb_mi_size) {
+   const uint32_t n = sb_mi_size < mi_cols - c0 ? sb_mi_size : mi_cols - c0;
+   for (uint32_t y = r0; y < r0 + sb_mi_size && y < mi_rows; y++) {
+      av1_segmap_store_row(params->segmap,
+                           params->mi_row_start + y,
+                           params->mi_col_start + c0,
+                           &mi_grid[mi_index(y, c0, mi_cols)].segment_id,
+                           sizeof(Av1MiSize),
+                           n);
    }
-
-   if (ctx >= AV1_SEGMENT_ID_CONTEXTS) {
-      ctx = AV1_SEGMENT_ID_CONTEXTS - 1u;
-   }
-   return ctx;
 }
 
-static uint32_t segment_id_pred_from_mi_grid(const Av1MiSize *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c) {
-   if (!mi_grid || r >= mi_rows || c >= mi_cols) {
-      return 0u;
+// The spatial prediction of intra_segment_id() for the block at ( r, c ) from the MI grid: *pred
+// is the predicted segment_id and *ctx the segment_id CDF context. Neighbors outside the tile are
+// unavailable.
+static void segment_id_predict(const Av1MiSize *mi_grid,
+                               uint32_t mi_rows,
+                               uint32_t mi_cols,
+                               uint32_t r,
+                               uint32_t c,
+                               uint32_t *pred,
+                               uint32_t *ctx) {
+   *pred = 0u;
+   *ctx = 0u;
+   if (r >= mi_rows || c >= mi_cols) {
+      return;
    }
-
-   const bool availU = (r > 0u);
-   const bool availL = (c > 0u);
-   const bool availUL = availU && availL;
-
-   const int32_t prevUL = availUL ? (int32_t)mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id : -1;
-   const int32_t prevU = availU ? (int32_t)mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id : -1;
-   const int32_t prevL = availL ? (int32_t)mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : -1;
-
-   uint32_t pred = 0u;
-   if (prevU == -1) {
-      pred = (prevL == -1) ? 0u : (uint32_t)prevL;
-   } else if (prevL == -1) {
-      pred = (uint32_t)prevU;
-   } else {
-      pred = (prevUL == prevU) ? (uint32_t)prevU : (uint32_t)prevL;
+   if (r == 0u) {
+      *pred = c > 0u ? mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : 0u;
+      return;
    }
-   if (pred >= AV1_MAX_SEGMENTS) {
-      pred = 0u;
+   const uint32_t prev_u = mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id;
+   if (c == 0u) {
+      *pred = prev_u;
+      return;
+   }
+   const uint32_t prev_l = mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id;
+   const uint32_t prev_ul = mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id;
+   *pred = prev_ul == prev_u ? prev_u : prev_l;
+   if (prev_ul == prev_u && prev_ul == prev_l) {
+      *ctx = 2u;
+   } else if (prev_ul == prev_u || prev_ul == prev_l || prev_u == prev_l) {
+      *ctx = 1u;
    }
-   return pred;
 }
 
 static uint32_t neg_deinterleave(uint32_t diff, uint32_t ref, uint32_t max) {
@@ -2384,11 +2686,12 @@ static bool tile_read_intra_segment_id(Av1SymbolDecoder *sd,
 
    uint32_t segment_id = 0u;
    if (params->segmentation_enabled) {
-      const uint32_t pred = segment_id_pred_from_mi_grid(mi_grid, mi_rows, mi_cols, r, c);
+      uint32_t pred = 0u;
+      uint32_t ctx = 0u;
+      segment_id_predict(mi_grid, mi_rows, mi_cols, r, c, &pred, &ctx);
       if (skip) {
          segment_id = pred;
       } else {
-         const uint32_t ctx = segment_id_ctx_from_mi_grid(mi_grid, mi_rows, mi_cols, r, c);
          uint32_t max = params->last_active_seg_id + 1u;
          if (max == 0u) {
             max = 1u;
@@ -2434,6 +2737,690 @@ static uint32_t palette_y_ctx_from_mi_grid(const Av1MiSize *mi_grid,
    return ctx;
 }
 
+// ns( n ) (spec 4.10.10), read from the symbol decoder as L() bits.
+static bool tile_read_ns(Av1SymbolDecoder *sd, uint32_t n, uint32_t *out, char *err, size_t err_cap) {
+   uint32_t w = 0;
+   for (uint32_t x = n; x != 0u; x >>= 1) {
+      w++;
+   }
+   const uint32_t m = (1u << w) - n;
+   uint32_t v = 0;
+   if (!av1_symbol_read_literal(sd, w - 1u, &v, err, err_cap)) {
+      return false;
+   }
+   if (v < m) {
+      *out = v;
+      return true;
+   }
+   uint32_t extra_bit = 0;
+   if (!av1_symbol_read_literal(sd, 1u, &extra_bit, err, err_cap)) {
+      return false;
+   }
+   *out = (v << 1) - m + extra_bit;
+   return true;
+}
+
+static uint32_t ceil_log2_u32(uint32_t x) {
+   uint32_t i = 0;
+   while (x > (1u << i) && i < 31u) {
+      i++;
+   }
+   return x < 2u ? 0u : i;
+}
+
+static uint16_t *palette_above_colors(const Av1TileCoeffCtx *ctx, uint32_t c, uint32_t plane) {
+   return ctx->palette_above + ((size_t)c * 2u + plane) * AV1_PALETTE_MAX_COLORS;
+}
+
+static uint16_t *palette_left_colors(const Av1TileCoeffCtx *ctx, uint32_t r, uint32_t plane) {
+   return ctx->palette_left + ((size_t)r * 2u + plane) * AV1_PALETTE_MAX_COLORS;
+}
+
+// get_palette_cache( plane ) (spec). The tile starts on a 64-pixel row, so the tile-relative r
+// gives the same ( MiRow * MI_SIZE ) % 64 test.
+static uint32_t palette_cache_from_neighbors(const Av1TileCoeffCtx *ctx,
+                                             const Av1MiSize *mi_grid,
+                                             uint32_t mi_cols,
+                                             uint32_t r,
+                                             uint32_t c,
+                                             uint32_t plane,
+                                             uint16_t cache[2 * AV1_PALETTE_MAX_COLORS]) {
+   uint32_t above_n = 0;
+   uint32_t left_n = 0;
+   if (((r * 4u) % 64u) != 0u) {
+      const Av1MiSize *a = &mi_grid[mi_index(r - 1u, c, mi_cols)];
+      above_n = plane ? a->palette_uv_size : a->palette_y_size;
+   }
+   if (c > 0u) {
+      const Av1MiSize *l = &mi_grid[mi_index(r, c - 1u, mi_cols)];
+      left_n = plane ? l->palette_uv_size : l->palette_y_size;
+   }
+   return av1_palette_cache(palette_above_colors(ctx, c, plane), above_n, palette_left_colors(ctx, r, plane), left_n, cache);
+}
+
+// palette_colors_y / palette_colors_u of palette_mode_info(): cache reuse flags, one literal,
+// then ascending deltas (delta_min is 1 for Y, 0 for U), sorted.
+static bool tile_read_palette_colors(Av1SymbolDecoder *sd,
+                                     uint32_t bit_depth,
+                                     const uint16_t *cache,
+                                     uint32_t cache_n,
+                                     uint32_t n,
+                                     uint32_t delta_min,
+                                     uint16_t *colors,
+                                     char *err,
+                                     size_t err_cap) {
+   const uint32_t max_val = (1u << bit_depth) - 1u;
+   uint32_t idx = 0;
+   for (uint32_t i = 0; i < cache_n && idx < n; i++) {
+      uint32_t use_cache = 0;
+      if (!av1_symbol_read_literal(sd, 1u, &use_cache, err, err_cap)) {
+         return false;
+      }
+      if (use_cache) {
+         colors[idx++] = cache[i];
+      }
+   }
+   if (idx < n) {
+      uint32_t v = 0;
+      if (!av1_symbol_read_literal(sd, bit_depth, &v, err, err_cap)) {
+         return false;
+      }
+      colors[idx++] = (uint16_t)v;
+   }
+   uint32_t palette_bits = 0;
+   if (idx < n) {
+      uint32_t extra_bits = 0;
+      if (!av1_symbol_read_literal(sd, 2u, &extra_bits, err, err_cap)) {
+         return false;
+      }
+      palette_bits = bit_depth - 3u + extra_bits;
+   }
+   for (; idx < n; idx++) {
+      uint32_t delta = 0;
+      if (!av1_symbol_read_literal(sd, palette_bits, &delta, err, err_cap)) {
+         return false;
+      }
+      uint32_t v = (uint32_t)colors[idx - 1u] + delta + delta_min;
+      if (v > max_val) {
+         v = max_val;
+      }
+      colors[idx] = (uint16_t)v;
+      const uint32_t range = max_val + 1u - v - delta_min;
+      const uint32_t range_bits = ceil_log2_u32(range);
+      if (range_bits < palette_bits) {
+         palette_bits = range_bits;
+      }
+   }
+   av1_palette_sort(colors, n);
+   return true;
+}
+
+// palette_colors_v of palette_mode_info(): literals, or signed deltas wrapping around
+// 1 << BitDepth.
+static bool tile_read_palette_colors_v(Av1SymbolDecoder *sd, uint32_t bit_depth, uint32_t n, uint16_t *colors, char *err, size_t err_cap) {
+   uint32_t delta_encode = 0;
+   if (!av1_symbol_read_literal(sd, 1u, &delta_encode, err, err_cap)) {
+      return false;
+   }
+   if (!delta_encode) {
+      for (uint32_t idx = 0; idx < n; idx++) {
+         uint32_t v = 0;
+         if (!av1_symbol_read_literal(sd, bit_depth, &v, err, err_cap)) {
+            return false;
+         }
+         colors[idx] = (uint16_t)v;
+      }
+      return true;
+   }
+
+   const int32_t max_val = 1 << bit_depth;
+   uint32_t extra_bits = 0;
+   uint32_t v0 = 0;
+   if (!av1_symbol_read_literal(sd, 2u, &extra_bits, err, err_cap) || !av1_symbol_read_literal(sd, bit_depth, &v0, err, err_cap)) {
+      return false;
+   }
+   const uint32_t palette_bits = bit_depth - 4u + extra_bits;
+   colors[0] = (uint16_t)v0;
+   for (uint32_t idx = 1; idx < n; idx++) {
+      uint32_t delta = 0;
+      if (!av1_symbol_read_literal(sd, palette_bits, &delta, err, err_cap)) {
+         return false;
+      }
+      int32_t val = (int32_t)colors[idx - 1u];
+      if (delta) {
+         uint32_t sign = 0;
+         if (!av1_symbol_read_literal(sd, 1u, &sign, err, err_cap)) {
+            return false;
+         }
+         val += sign ? -(int32_t)delta : (int32_t)delta;
+      }
+      if (val < 0) {
+         val += max_val;
+      }
+      if (val >= max_val) {
+         val -= max_val;
+      }
+      colors[idx] = (uint16_t)clip3_i32(0, max_val - 1, val);
+   }
+   return true;
+}
+
+// Records PaletteColors[ plane ] of a block (plane 0 / 1) for get_palette_cache() of the blocks
+// below and to the right.
+static void palette_store_colors(Av1TileCoeffCtx *ctx,
+                                 uint32_t mi_rows,
+                                 uint32_t mi_cols,
+                                 uint32_t r,
+                                 uint32_t c,
+                                 uint32_t wlog2,
+                                 uint32_t hlog2,
+                                 uint32_t plane,
+                                 const uint16_t *colors) {
+   for (uint32_t x = c; x < c + (1u << wlog2) && x < mi_cols; x++) {
+      memcpy(palette_above_colors(ctx, x, plane), colors, AV1_PALETTE_MAX_COLORS * sizeof(uint16_t));
+   }
+   for (uint32_t y = r; y < r + (1u << hlog2) && y < mi_rows; y++) {
+      memcpy(palette_left_colors(ctx, y, plane), colors, AV1_PALETTE_MAX_COLORS * sizeof(uint16_t));
+   }
+}
+
+// One color index map of palette_tokens(): color_index_map_y / _uv, then the anti-diagonal
+// wavefront of palette_color_idx_y / _uv symbols (contexts and ColorOrder for a whole diagonal
+// come from av1_palette_diag_contexts()), then the offscreen extension.
+static bool tile_read_color_index_map(Av1SymbolDecoder *sd,
+                                      uint16_t (*cdfs)[AV1_PALETTE_MAX_COLORS + 1u],
+                                      uint32_t n,
+                                      uint8_t *map,
+                                      uint32_t block_w,
+                                      uint32_t block_h,
+                                      uint32_t onscreen_w,
+                                      uint32_t onscreen_h,
+                                      char *err,
+                                      size_t err_cap) {
+   const ptrdiff_t stride = AV1_PALETTE_MAX_DIM;
+   uint32_t first = 0;
+   if (!tile_read_ns(sd, n, &first, err, err_cap)) {
+      return false;
+   }
+   map[0] = (uint8_t)first;
+
+   Av1PaletteDiag d;
+   for (uint32_t i = 1; i < onscreen_w + onscreen_h - 1u; i++) {
+      av1_palette_diag_contexts(map, stride, i, onscreen_w, onscreen_h, n, &d);
+      for (uint32_t k = 0; k < d.count; k++) {
+         uint32_t sym = 0;
+         if (!av1_symbol_read_symbol(sd, cdfs[d.ctx[k]], n, &sym, err, err_cap)) {
+            return false;
+         }
+         map[(ptrdiff_t)d.row[k] * stride + d.col[k]] = d.order[k][sym];
+      }
+   }
+   av1_palette_extend_map(map, stride, onscreen_w, onscreen_h, block_w, block_h);
+   return true;
+}
+
+// Intra block copy (use_intrabc): the DV lands in the MI grid for find_mv_stack() of later blocks.
+static void mi_set_intrabc_block(Av1MiSize *mi_grid,
+                                 uint32_t mi_rows,
+                                 uint32_t mi_cols,
+                                 uint32_t r,
+                                 uint32_t c,
+                                 uint32_t wlog2,
+                                 uint32_t hlog2,
+                                 const int32_t dv[2]) {
+   const uint32_t w = 1u << wlog2;
+   const uint32_t h = 1u << hlog2;
+   for (uint32_t rr = 0; rr < h; rr++) {
+      for (uint32_t cc = 0; cc < w; cc++) {
+         const uint32_t y = r + rr;
+         const uint32_t x = c + cc;
+         if (y < mi_rows && x < mi_cols) {
+            Av1MiSize *m = &mi_grid[mi_index(y, x, mi_cols)];
+            m->is_inter = 1u;
+            m->mv[0] = (int16_t)dv[0];
+            m->mv[1] = (int16_t)dv[1];
+         }
+      }
+   }
+}
+
+// Deblocking record of a decoded block (Av1TileDecodeParams.lf_mi), clipped to the tile.
+static void lf_mi_set_block(const Av1TileDecodeParams *params,
+                            uint32_t mi_rows,
+                            uint32_t mi_cols,
+                            uint32_t r,
+                            uint32_t c,
+                            uint32_t wlog2,
+                            uint32_t hlog2,
+                            Av1LfMi *v) {
+   av1_lf_mi_set_levels(params->lf_levels, v);
+   const uint32_t w = 1u << wlog2;
+   const uint32_t h = 1u << hlog2;
+   for (uint32_t y = r; y < r + h && y < mi_rows; y++) {
+      Av1LfMi *row = params->lf_mi + (ptrdiff_t)y * params->lf_mi_stride;
+      for (uint32_t x = c; x < c + w && x < mi_cols; x++) {
+         row[x] = *v;
+      }
+   }
+}
+
+// RefStackMv[ idx ][ 0 ] / WeightStack of find_mv_stack( 0 ).
+typedef struct {
+   uint32_t num; // NumMvFound
+   bool found_match;
+   int32_t mv[AV1_MAX_REF_MV_STACK_SIZE][2];
+   uint32_t weight[AV1_MAX_REF_MV_STACK_SIZE];
+} Av1IntrabcMvStack;
+
+// add_ref_mv_candidate() for RefFrame[ 0 ] == INTRA_FRAME: in an intra frame the only inter blocks
+// are intra block copy blocks, which all match. Their DVs are whole samples, so lower_mv_precision()
+// leaves them unchanged, and their YMode (DC_PRED) never counts towards NewMvCount.
+static void intrabc_add_ref_mv_candidate(Av1IntrabcMvStack *s, const Av1MiSize *cand, uint32_t weight) {
+   if (!cand->is_inter) {
+      return;
+   }
+   s->found_match = true;
+   for (uint32_t idx = 0; idx < s->num; idx++) {
+      if (s->mv[idx][0] == cand->mv[0] && s->mv[idx][1] == cand->mv[1]) {
+         s->weight[idx] += weight;
+         return;
+      }
+   }
+   if (s->num < AV1_MAX_REF_MV_STACK_SIZE) {
+      s->mv[s->num][0] = cand->mv[0];
+      s->mv[s->num][1] = cand->mv[1];
+      s->weight[s->num] = weight;
+      s->num++;
+   }
+}
+
+// Scan row process (delta_row < 0); r / c / mi_rows / mi_cols are tile-relative, so is_inside() is
+// a bounds check on the MI grid. Tiles start on superblock boundaries, so MiRow & 1 == r & 1.
+static void intrabc_scan_row(Av1IntrabcMvStack *s,
+                             const Av1MiSize *mi_grid,
+                             uint32_t mi_cols,
+                             uint32_t r,
+                             uint32_t c,
+                             uint32_t bw4,
+                             int32_t delta_row) {
+   uint32_t end4 = bw4 < mi_cols - c ? bw4 : mi_cols - c;
+   if (end4 > 16u) {
+      end4 = 16u;
+   }
+   const bool far = delta_row < -1;
+   int32_t delta_col = 0;
+   if (far) {
+      delta_row += (int32_t)(r & 1u);
+      delta_col = 1 - (int32_t)(c & 1u);
+   }
+   const int32_t mv_row = (int32_t)r + delta_row;
+   if (mv_row < 0) {
+      return;
+   }
+   for (uint32_t i = 0; i < end4;) {
+      const uint32_t mv_col = c + (uint32_t)delta_col + i;
+      if (mv_col >= mi_cols) {
+         break;
+      }
+      const Av1MiSize *cand = &mi_grid[mi_index((uint32_t)mv_row, mv_col, mi_cols)];
+      uint32_t len = (1u << cand->wlog2) < bw4 ? (1u << cand->wlog2) : bw4;
+      if (far && len < 2u) {
+         len = 2u;
+      }
+      if (bw4 >= 16u && len < 4u) {
+         len = 4u;
+      }
+      intrabc_add_ref_mv_candidate(s, cand, len * 2u);
+      i += len;
+   }
+}
+
+// Scan col process (delta_col < 0).
+static void intrabc_scan_col(Av1IntrabcMvStack *s,
+                             const Av1MiSize *mi_grid,
+                             uint32_t mi_rows,
+                             uint32_t mi_cols,
+                             uint32_t r,
+                             uint32_t c,
+                             uint32_t bh4,
+                             int32_t delta_col) {
+   uint32_t end4 = bh4 < mi_rows - r ? bh4 : mi_rows - r;
+   if (end4 > 16u) {
+      end4 = 16u;
+   }
+   const bool far = delta_col < -1;
+   int32_t delta_row = 0;
+   if (far) {
+      delta_row = 1 - (int32_t)(r & 1u);
+      delta_col += (int32_t)(c & 1u);
+   }
+   const int32_t mv_col = (int32_t)c + delta_col;
+   if (mv_col < 0) {
+      return;
+   }
+   for (uint32_t i = 0; i < end4;) {
+      const uint32_t mv_row = r + (uint32_t)delta_row + i;
+      if (mv_row >= mi_rows) {
+         break;
+      }
+      const Av1MiSize *cand = &mi_grid[mi_index(mv_row, (uint32_t)mv_col, mi_cols)];
+      uint32_t len = (1u << cand->hlog2) < bh4 ? (1u << cand->hlog2) : bh4;
+      if (far && len < 2u) {
+         len = 2u;
+      }
+      if (bh4 >= 16u && len < 4u) {
+         len = 4u;
+      }
+      intrabc_add_ref_mv_candidate(s, cand, len * 2u);
+      i += len;
+   }
+}
+
+// Scan point process. Not yet decoded positions (top-right) still have is_inter == 0.
+static void intrabc_scan_point(Av1IntrabcMvStack *s,
+                               const Av1MiSize *mi_grid,
+                               uint32_t mi_rows,
+                               uint32_t mi_cols,
+                               uint32_t r,
+                               uint32_t c,
+                               int32_t delta_row,
+                               int32_t delta_col) {
+   const int32_t mv_row = (int32_t)r + delta_row;
+   const int32_t mv_col = (int32_t)c + delta_col;
+   if (mv_row < 0 || mv_col < 0 || (uint32_t)mv_row >= mi_rows || (uint32_t)mv_col >= mi_cols) {
+      return;
+   }
+   intrabc_add_ref_mv_candidate(s, &mi_grid[mi_index((uint32_t)mv_row, (uint32_t)mv_col, mi_cols)], 4u);
+}
+
+// Sorting process: stable bubble sort of [start, end) by descending weight.
+static void intrabc_sort(Av1IntrabcMvStack *s, uint32_t start, uint32_t end) {
+   while (end > start) {
+      uint32_t new_end = start;
+      for (uint32_t idx = start + 1u; idx < end; idx++) {
+         if (s->weight[idx - 1u] < s->weight[idx]) {
+            const uint32_t w = s->weight[idx - 1u];
+            const int32_t mv0 = s->mv[idx - 1u][0], mv1 = s->mv[idx - 1u][1];
+            s->weight[idx - 1u] = s->weight[idx];
+            s->mv[idx - 1u][0] = s->mv[idx][0];
+            s->mv[idx - 1u][1] = s->mv[idx][1];
+            s->weight[idx] = w;
+            s->mv[idx][0] = mv0;
+            s->mv[idx][1] = mv1;
+            new_end = idx;
+         }
+      }
+      end = new_end;
+   }
+}
+
+// find_mv_stack( 0 ) for a use_intrabc block, reduced to what assign_mv() reads: RefStackMv[ 0 ]
+// and [ 1 ] after the context and clamping process. The extra search process finds no candidates
+// in an intra frame (no RefFrames > INTRA_FRAME) and pads with GlobalMvs[ 0 ], which is zero for
+// INTRA_FRAME; the temporal scan never runs (use_ref_frame_mvs is 0).
+static void intrabc_find_mv_stack(const Av1TileDecodeParams *params,
+                                  const Av1MiSize *mi_grid,
+                                  uint32_t mi_rows,
+                                  uint32_t mi_cols,
+                                  uint32_t r,
+                                  uint32_t c,
+                                  uint32_t wlog2,
+                                  uint32_t hlog2,
+                                  int32_t out[2][2]) {
+   const uint32_t bw4 = 1u << wlog2;
+   const uint32_t bh4 = 1u << hlog2;
+   Av1IntrabcMvStack s;
+   memset(&s, 0, sizeof(s));
+
+   intrabc_scan_row(&s, mi_grid, mi_cols, r, c, bw4, -1);
+   intrabc_scan_col(&s, mi_grid, mi_rows, mi_cols, r, c, bh4, -1);
+   if ((bw4 > bh4 ? bw4 : bh4) <= 16u) {
+      intrabc_scan_point(&s, mi_grid, mi_rows, mi_cols, r, c, -1, (int32_t)bw4);
+   }
+   const uint32_t num_nearest = s.num;
+   for (uint32_t idx = 0; idx < num_nearest; idx++) {
+      s.weight[idx] += AV1_REF_CAT_LEVEL;
+   }
+   intrabc_scan_point(&s, mi_grid, mi_rows, mi_cols, r, c, -1, -1);
+   intrabc_scan_row(&s, mi_grid, mi_cols, r, c, bw4, -3);
+   intrabc_scan_col(&s, mi_grid, mi_rows, mi_cols, r, c, bh4, -3);
+   if (bh4 > 1u) {
+      intrabc_scan_row(&s, mi_grid, mi_cols, r, c, bw4, -5);
+   }
+   if (bw4 > 1u) {
+      intrabc_scan_col(&s, mi_grid, mi_rows, mi_cols, r, c, bh4, -5);
+   }
+   intrabc_sort(&s, 0u, num_nearest);
+   intrabc_sort(&s, num_nearest, s.num);
+
+   // clamp_mv_row() / clamp_mv_col() against the frame (MiRows / MiCols).
+   const int32_t mi_row = (int32_t)(params->mi_row_start + r);
+   const int32_t mi_col = (int32_t)(params->mi_col_start + c);
+   const int32_t frame_mi_rows = (int32_t)(params->mi_rows ? params->mi_rows : params->mi_row_end);
+   const int32_t frame_mi_cols = (int32_t)(params->mi_cols ? params->mi_cols : params->mi_col_end);
+   const int32_t border_row = AV1_MV_BORDER + (int32_t)bh4 * 4 * 8;
+   const int32_t border_col = AV1_MV_BORDER + (int32_t)bw4 * 4 * 8;
+   const int32_t to_top = -(mi_row * 4 * 8);
+   const int32_t to_bottom = (frame_mi_rows - (int32_t)bh4 - mi_row) * 4 * 8;
+   const int32_t to_left = -(mi_col * 4 * 8);
+   const int32_t to_right = (frame_mi_cols - (int32_t)bw4 - mi_col) * 4 * 8;
+   for (uint32_t idx = 0; idx < 2u; idx++) {
+      if (idx < s.num) {
+         out[idx][0] = clip3_i32(to_top - border_row, to_bottom + border_row, s.mv[idx][0]);
+         out[idx][1] = clip3_i32(to_left - border_col, to_right + border_col, s.mv[idx][1]);
+      } else {
+         out[idx][0] = 0;
+         out[idx][1] = 0;
+      }
+   }
+}
+
+// read_mv_component() with force_integer_mv == 1 (always the case in intra frames): mv_class0_fr
+// and mv_fr are 3 and the hp bits 1, none of them coded.
+static bool tile_read_mv_component(Av1SymbolDecoder *sd, Av1TileSkipCdfs *cdfs, uint32_t comp, int32_t *out, char *err, size_t err_cap) {
+   uint32_t sign = 0;
+   uint32_t mv_class = 0;
+   if (!av1_symbol_read_symbol(sd, cdfs->mv_sign[comp], 2, &sign, err, err_cap) ||
+       !av1_symbol_read_symbol(sd, cdfs->mv_class[comp], AV1_MV_CLASSES, &mv_class, err, err_cap)) {
+      return false;
+   }
+   uint32_t mag = 0;
+   if (mv_class == 0u) {
+      uint32_t class0_bit = 0;
+      if (!av1_symbol_read_symbol(sd, cdfs->mv_class0_bit[comp], 2, &class0_bit, err, err_cap)) {
+         return false;
+      }
+      mag = ((class0_bit << 3) | (3u << 1) | 1u) + 1u;
+   } else {
+      uint32_t d = 0;
+      for (uint32_t i = 0; i < mv_class; i++) {
+         uint32_t bit = 0;
+         if (!av1_symbol_read_symbol(sd, cdfs->mv_bit[comp][i], 2, &bit, err, err_cap)) {
+            return false;
+         }
+         d |= bit << i;
+      }
+      mag = (2u << (mv_class + 2u)) + ((d << 3) | (3u << 1) | 1u) + 1u;
+   }
+   *out = sign ? -(int32_t)mag : (int32_t)mag;
+   return true;
+}
+
+// find_mv_stack( 0 ) and assign_mv( 0 ) of a use_intrabc block: PredMv[ 0 ] is the first non-zero
+// stack entry (or the default DV), then read_mv( 0 ) with MvCtx == MV_INTRABC_CONTEXT adds diffMv.
+// A DV failing is_mv_valid() is a conformance error.
+static bool tile_read_intrabc_dv(Av1SymbolDecoder *sd,
+                                 const Av1TileDecodeParams *params,
+                                 Av1TileSkipCdfs *cdfs,
+                                 const Av1MiSize *mi_grid,
+                                 uint32_t mi_rows,
+                                 uint32_t mi_cols,
+                                 uint32_t r,
+                                 uint32_t c,
+                                 uint32_t wlog2,
+                                 uint32_t hlog2,
+                                 bool has_chroma,
+                                 int32_t dv[2],
+                                 char *err,
+                                 size_t err_cap) {
+   int32_t stack[2][2];
+   intrabc_find_mv_stack(params, mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, stack);
+
+   Av1IntrabcBlock b;
+   memset(&b, 0, sizeof(b));
+   b.mi_row = params->mi_row_start + r;
+   b.mi_col = params->mi_col_start + c;
+   b.bw = (1u << wlog2) * 4u;
+   b.bh = (1u << hlog2) * 4u;
+   b.mi_row_start = params->mi_row_start;
+   b.mi_row_end = params->mi_row_end;
+   b.mi_col_start = params->mi_col_start;
+   b.mi_col_end = params->mi_col_end;
+   b.use_128x128_superblock = params->use_128x128_superblock;
+   b.has_chroma = has_chroma;
+   b.subsampling_x = params->subsampling_x;
+   b.subsampling_y = params->subsampling_y;
+
+   int32_t pred[2] = {stack[0][0], stack[0][1]};
+   if (pred[0] == 0 && pred[1] == 0) {
+      pred[0] = stack[1][0];
+      pred[1] = stack[1][1];
+   }
+   if (pred[0] == 0 && pred[1] == 0) {
+      av1_intrabc_default_dv(&b, pred);
+   }
+
+   uint32_t mv_joint = 0;
+   if (!av1_symbol_read_symbol(sd, cdfs->mv_joint, AV1_MV_JOINTS, &mv_joint, err, err_cap)) {
+      return false;
+   }
+   int32_t diff[2] = {0, 0};
+   // MV_JOINT_HZVNZ (2) / MV_JOINT_HNZVNZ (3) code the row, MV_JOINT_HNZVZ (1) / HNZVNZ the column.
+   if ((mv_joint == 2u || mv_joint == 3u) && !tile_read_mv_component(sd, cdfs, 0u, &diff[0], err, err_cap)) {
+      return false;
+   }
+   if ((mv_joint == 1u || mv_joint == 3u) && !tile_read_mv_component(sd, cdfs, 1u, &diff[1], err, err_cap)) {
+      return false;
+   }
+   dv[0] = pred[0] + diff[0];
+   dv[1] = pred[1] + diff[1];
+   if (!av1_intrabc_dv_valid(&b, dv)) {
+      snprintf(err, err_cap, "invalid intrabc dv=(%d,%d) at mi (%u,%u)", (int)dv[0], (int)dv[1], b.mi_row, b.mi_col);
+      return false;
+   }
+   return true;
+}
+
+// transform_type() for an inter (intra block copy) block: inter_tx_type when the set has more than
+// DCT_DCT and qindex > 0.
+static bool tile_read_inter_tx_type(Av1SymbolDecoder *sd,
+                                    Av1TileSkipCdfs *cdfs,
+                                    uint32_t tx_size,
+                                    uint32_t reduced_tx_set,
+                                    uint32_t *out_tx_type,
+                                    char *err,
+                                    size_t err_cap) {
+   static const uint8_t kInvSet1[AV1_INTER_TX_TYPE_SET1_SYMBOLS] = {
+      AV1_TX_TYPE_IDTX,
+      AV1_TX_TYPE_V_DCT,
+      AV1_TX_TYPE_H_DCT,
+      AV1_TX_TYPE_V_ADST,
+      AV1_TX_TYPE_H_ADST,
+      AV1_TX_TYPE_V_FLIPADST,
+      AV1_TX_TYPE_H_FLIPADST,
+      AV1_TX_TYPE_DCT_DCT,
+      AV1_TX_TYPE_ADST_DCT,
+      AV1_TX_TYPE_DCT_ADST,
+      AV1_TX_TYPE_FLIPADST_DCT,
+      AV1_TX_TYPE_DCT_FLIPADST,
+      AV1_TX_TYPE_ADST_ADST,
+      AV1_TX_TYPE_FLIPADST_FLIPADST,
+      AV1_TX_TYPE_ADST_FLIPADST,
+      AV1_TX_TYPE_FLIPADST_ADST,
+   };
+   static const uint8_t kInvSet2[AV1_INTER_TX_TYPE_SET2_SYMBOLS] = {
+      AV1_TX_TYPE_IDTX,
+      AV1_TX_TYPE_V_DCT,
+      AV1_TX_TYPE_H_DCT,
+      AV1_TX_TYPE_DCT_DCT,
+      AV1_TX_TYPE_ADST_DCT,
+      AV1_TX_TYPE_DCT_ADST,
+      AV1_TX_TYPE_FLIPADST_DCT,
+      AV1_TX_TYPE_DCT_FLIPADST,
+      AV1_TX_TYPE_ADST_ADST,
+      AV1_TX_TYPE_FLIPADST_FLIPADST,
+      AV1_TX_TYPE_ADST_FLIPADST,
+      AV1_TX_TYPE_FLIPADST_ADST,
+   };
+   static const uint8_t kInvSet3[AV1_INTER_TX_TYPE_SET3_SYMBOLS] = {AV1_TX_TYPE_IDTX, AV1_TX_TYPE_DCT_DCT};
+
+   const uint32_t set = get_tx_set_inter(tx_size, reduced_tx_set);
+   const uint32_t txSzSqr = (tx_size < AV1_TX_SIZES_ALL) ? (uint32_t)kTxSizeSqr[tx_size] : 0u;
+   uint32_t sym = 0;
+   if (set == AV1_TX_SET_INTER_1) {
+      if (txSzSqr >= 2u) {
+         snprintf(err, err_cap, "invalid Tx_Size_Sqr=%u for TX_SET_INTER_1", txSzSqr);
+         return false;
+      }
+      if (!av1_symbol_read_symbol(sd, cdfs->inter_tx_type_set1[txSzSqr], AV1_INTER_TX_TYPE_SET1_SYMBOLS, &sym, err, err_cap)) {
+         return false;
+      }
+      *out_tx_type = (uint32_t)kInvSet1[sym];
+   } else if (set == AV1_TX_SET_INTER_2) {
+      if (!av1_symbol_read_symbol(sd, cdfs->inter_tx_type_set2, AV1_INTER_TX_TYPE_SET2_SYMBOLS, &sym, err, err_cap)) {
+         return false;
+      }
+      *out_tx_type = (uint32_t)kInvSet2[sym];
+   } else if (set == AV1_TX_SET_INTER_3) {
+      if (txSzSqr >= 4u) {
+         snprintf(err, err_cap, "invalid Tx_Size_Sqr=%u for TX_SET_INTER_3", txSzSqr);
+         return false;
+      }
+      if (!av1_symbol_read_symbol(sd, cdfs->inter_tx_type_set3[txSzSqr], AV1_INTER_TX_TYPE_SET3_SYMBOLS, &sym, err, err_cap)) {
+         return false;
+      }
+      *out_tx_type = (uint32_t)kInvSet3[sym];
+   } else {
+      *out_tx_type = AV1_TX_TYPE_DCT_DCT;
+   }
+   return true;
+}
+
+// Position (in tx units) of the tx_index-th luma transform block of an inter block with a uniform
+// tx size: residual() visits 64x64 chunks in raster order, and transform_tree() halves a chunk along
+// its longer side (or into quadrants when square) down to the tx size.
+static void inter_tx_block_position(uint32_t bw4, uint32_t bh4, uint32_t tx_w4, uint32_t tx_h4, uint32_t tx_index, uint32_t *out_tx, uint32_t *out_ty) {
+   const uint32_t chunk_w4 = bw4 < 16u ? bw4 : 16u;
+   const uint32_t chunk_h4 = bh4 < 16u ? bh4 : 16u;
+   const uint32_t per_chunk = (chunk_w4 / tx_w4) * (chunk_h4 / tx_h4);
+   const uint32_t chunk = tx_index / per_chunk;
+   uint32_t idx = tx_index % per_chunk;
+   uint32_t x4 = (chunk % (bw4 / chunk_w4)) * chunk_w4;
+   uint32_t y4 = (chunk / (bw4 / chunk_w4)) * chunk_h4;
+   uint32_t w4 = chunk_w4;
+   uint32_t h4 = chunk_h4;
+   while (w4 > tx_w4 || h4 > tx_h4) {
+      const uint32_t parts = (w4 == h4) ? 4u : 2u;
+      const uint32_t n = (w4 / tx_w4) * (h4 / tx_h4) / parts;
+      const uint32_t part = idx / n;
+      idx %= n;
+      if (w4 > h4) {
+         w4 >>= 1;
+         x4 += part * w4;
+      } else if (w4 < h4) {
+         h4 >>= 1;
+         y4 += part * h4;
+      } else {
+         w4 >>= 1;
+         h4 >>= 1;
+         x4 += (part & 1u) * w4;
+         y4 += (part >> 1) * h4;
+      }
+   }
+   *out_tx = x4 / tx_w4;
+   *out_ty = y4 / tx_h4;
+}
+
 static uint32_t size_group_from_wlog2_hlog2(uint32_t wlog2, uint32_t hlog2) {
    // Equivalent to spec Size_Group[BLOCK_SIZES] for the block sizes we can produce.
    // wlog2/hlog2 are in MI units (4x4 luma blocks).
@@ -2522,13 +3509,24 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
                                            uint32_t tx_size,
                                            uint32_t tx_type,
                                            bool probe_try_exit_symbol,
+                                           const Av1PlaneQuant *quant_q,
+                                           int32_t *out_dequant,
                                            Av1TileSyntaxProbeStats *st,
                                            bool *out_stop_now,
+                                           Av1TxCoeffExtent *out_extent,
+                                           bool *out_extent_valid,
                                            char *err,
                                            size_t err_cap) {
    if (out_stop_now) {
       *out_stop_now = false;
    }
+   // The extent is only valid once coeffs() ran to completion (all_zero, or the sign loop).
+   if (out_extent) {
+      av1_txfm_extent_reset(out_extent);
+   }
+   if (out_extent_valid) {
+      *out_extent_valid = false;
+   }
 
    const uint32_t ptype = (plane == 0u) ? 0u : 1u;
 
@@ -2572,6 +3570,10 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
       st->block1_txb_skip = all_zero;
    }
 
+   if (all_zero != 0u && out_extent_valid) {
+      *out_extent_valid = true;
+   }
+
    if (all_zero == 0u) {
       // eob_pt_* (spec): depends on transform size via eobMultisize.
       if (tx_size >= AV1_TX_SIZES_ALL) {
@@ -2750,11 +3752,18 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
       const uint32_t segEobAdj = (coeffs < 1024u) ? coeffs : 1024u;
 
       if (eob <= segEobAdj) {
-         uint16_t scan[1024];
-         int32_t quant[1024] = {0};
+         uint16_t scan_buf[1024];
+         // Context derivation and dequantization only read the width x height positions, so
+         // small blocks clear just those instead of the whole 4 KB.
+         int32_t quant[1024];
+         memset(quant, 0, coeffs * sizeof(quant[0]));
 
          const uint32_t tx_class = get_tx_class_from_tx_type(tx_type);
-         build_scan(tx_class, width, height, scan);
+         const uint16_t *scan = kDefaultScan4x4;
+         if (coeffs != 16u || tx_class != AV1_TX_CLASS_2D) {
+            build_scan(tx_class, width, height, scan_buf);
+            scan = scan_buf;
+         }
 
          // Seed + extend the eob coefficient.
          {
@@ -2864,9 +3873,26 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
             }
          }
 
-         // Sign coding (dc_sign / sign_bit) + optional Exp-Golomb extension.
+         // Sign coding (dc_sign / sign_bit) + optional Exp-Golomb extension. Each coefficient is
+         // final after this loop iteration, so it is dequantized here (spec 7.12.3 a-f) straight
+         // into the transform input: Dequant[ i ][ j ] at row stride 1 << Tx_Width_Log2[ txSz ].
          uint32_t culLevel = 0u;
          uint32_t dcCategory = 0u;
+         const uint32_t dq_stride_log2 = kTxWidthLog2[tx_size];
+         const uint32_t dq_shift = av1_dequant_denom_shift(kTxWidthLog2[tx_size], kTxHeightLog2[tx_size]);
+         const uint32_t dq_bit_depth = coeff_ctx ? coeff_ctx->dequant.bit_depth : 8u;
+         const int32_t dq_dc = quant_q ? quant_q->dc[plane] : 0;
+         const int32_t dq_ac = quant_q ? quant_q->ac[plane] : 0;
+         // Lossless blocks store Quant[] itself for the WHT (av1_dequant_lossless_coeff()).
+         const bool dq_lossless = quant_q && quant_q->lossless && tx_size == AV1_TX_4X4;
+         // Quantizer-matrix blocks (q2 != q) are dequantized below, after the loop.
+         const uint8_t *dq_wt =
+            coeff_ctx && quant_q && !dq_lossless ? av1_dequant_qm_weights(&coeff_ctx->dequant,
+                                                          quant_q,
+                                                          plane,
+                                                          tx_size,
+                                                          tx_class == AV1_TX_CLASS_2D && tx_type != AV1_TX_TYPE_IDTX)
+                                 : NULL;
 
          for (uint32_t coef_idx = 0u; coef_idx < eob; coef_idx++) {
             const uint32_t pos = scan[coef_idx];
@@ -2931,6 +3957,33 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
             if (sign) {
                quant[pos] = -quant[pos];
             }
+
+            // Sparse record for the inverse transform: Quant[] is row-major with stride `width`.
+            if (quant[pos] != 0) {
+               const uint32_t row = pos >> bwl;
+               const uint32_t col = pos & (width - 1u);
+               if (out_extent) {
+                  av1_txfm_extent_add(out_extent, row, col);
+               }
+               if (out_dequant && dq_lossless) {
+                  out_dequant[(row << dq_stride_log2) + col] = av1_dequant_lossless_coeff(quant[pos], dq_bit_depth);
+               } else if (out_dequant && !dq_wt) {
+                  out_dequant[(row << dq_stride_log2) + col] =
+                     av1_dequant_coeff(quant[pos], pos == 0u ? dq_dc : dq_ac, dq_shift, dq_bit_depth);
+               }
+            }
+         }
+         if (out_dequant && dq_wt) {
+            const uint32_t rows = out_extent ? out_extent->max_row + 1u : height;
+            const uint32_t cols = out_extent ? out_extent->max_col + 1u : width;
+            coeff_ctx->dequant_dsp.qm_block(
+               out_dequant, dq_stride_log2, quant, dq_wt, bwl, rows, cols, dq_dc, dq_ac, dq_shift, dq_bit_depth);
+         }
+         if (out_extent) {
+            out_extent->eob = eob;
+         }
+         if (out_extent_valid) {
+            *out_extent_valid = true;
          }
 
          // Update spec-style contexts for future blocks / tx blocks.
@@ -2956,6 +4009,31 @@ static bool decode_coeffs_luma_one_tx_block(Av1SymbolDecoder *sd,
    return true;
 }
 
+// Accumulates the sparse-coefficient summary reported in Av1TileSyntaxProbeStats.
+static void tally_coeff_extent(Av1TileSyntaxProbeStats *st, const Av1TxCoeffExtent *e, const int32_t *dequant, uint32_t tx_size) {
+   if (!st) {
+      return;
+   }
+   st->coeff_txb_total++;
+   if (e->eob == 0u) {
+      st->coeff_txb_all_zero++;
+      return;
+   }
+   const uint32_t stride = 1u << kTxWidthLog2[tx_size];
+   for (uint32_t i = 0; i <= e->max_row; i++) {
+      for (uint32_t j = 0; j <= e->max_col; j++) {
+         const int32_t v = dequant[(size_t)i * stride + j];
+         st->coeff_dequant_abs_sum += (uint64_t)(v < 0 ? -(int64_t)v : v);
+      }
+   }
+   if (av1_txfm_extent_is_dc_only(e)) {
+      st->coeff_txb_dc_only++;
+   }
+   if (e->eob <= 16u) {
+      st->coeff_txb_eob_le16++;
+   }
+}
+
 typedef struct Av1TileSbProbeState {
    uint32_t sb_origin_r;
    uint32_t sb_origin_c;
@@ -3085,7 +4163,7 @@ static bool tile_read_delta_lf(Av1SymbolDecoder *sd,
          const int32_t reduced = sign ? -(int32_t)delta_lf_abs : (int32_t)delta_lf_abs;
          const int32_t scale = (params->delta_lf_res < 31u) ? (1 << (int32_t)params->delta_lf_res) : 1;
          const int32_t delta = reduced * scale;
-         mode_cdfs->delta_lf_state[i] = clip3_i32(-AV1_MAX_LOOP_FILTER, AV1_MAX_LOOP_FILTER, mode_cdfs->delta_lf_state[i] + delta);
+         mode_cdfs->delta_lf_state[i] = clip3_i32(-(int32_t)AV1_MAX_LOOP_FILTER, (int32_t)AV1_MAX_LOOP_FILTER, mode_cdfs->delta_lf_state[i] + delta);
       }
    }
 
@@ -3154,15 +4232,6 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
          }
       }
 
-      // We do not implement intrabc tile syntax yet.
-      if (params->allow_intrabc) {
-         if (out_stop) {
-            *out_stop = true;
-         }
-         snprintf(err, err_cap, "unsupported: allow_intrabc=1 (use_intrabc not implemented)");
-         return true;
-      }
-
       // For try-EOT, derive per-block segment_id/qindex/Lossless.
       // Note: Frame-level coded_lossless is insufficient when segmentation is enabled.
    }
@@ -3170,9 +4239,6 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
    uint32_t segment_id = 0u;
    if (params->probe_try_exit_symbol && params->segmentation_enabled && r < mi_rows && c < mi_cols) {
       segment_id = (uint32_t)mi_grid[mi_index(r, c, mi_cols)].segment_id;
-      if (segment_id >= 8u) {
-         segment_id = 0u;
-      }
    }
    const uint32_t block_qindex = params->probe_try_exit_symbol ? qindex_for_segment(params, segment_id) : params->base_q_idx;
    const bool block_lossless = params->probe_try_exit_symbol ? lossless_for_segment(params, segment_id) : (params->coded_lossless != 0u);
@@ -3229,28 +4295,45 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
+   const bool has_chroma = !params->mono_chrome && !(params->subsampling_x && wlog2 == 0u && (c & 1u) == 0u) &&
+                           !(params->subsampling_y && hlog2 == 0u && (r & 1u) == 0u);
+
+   // intra_frame_mode_info(): use_intrabc, then for an intra block copy block assign_mv( 0 ) instead
+   // of the intra modes. YMode / UVMode are DC_PRED, there is no palette or filter intra, and the
+   // block is inter for the tx size and type syntax below.
+   uint32_t use_intrabc = 0;
+   if (params->probe_try_exit_symbol && params->allow_intrabc) {
+      if (!av1_symbol_read_symbol(sd, mode_cdfs->intrabc, 2, &use_intrabc, err, err_cap)) {
+         return false;
+      }
+      if (use_intrabc) {
+         int32_t dv[2];
+         if (!tile_read_intrabc_dv(sd, params, mode_cdfs, mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, has_chroma, dv, err, err_cap)) {
+            return false;
+         }
+         mi_set_intrabc_block(mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, dv);
+         if (st) {
+            st->intrabc_blocks++;
+         }
+      }
+   }
+
    uint32_t y_mode_ctx = size_group_from_wlog2_hlog2(wlog2, hlog2);
    if (y_mode_ctx >= AV1_Y_MODE_CONTEXTS) {
       y_mode_ctx = AV1_Y_MODE_CONTEXTS - 1u;
    }
    uint16_t *y_cdf = mode_cdfs->y_mode[y_mode_ctx];
    uint32_t y_mode = 0;
-   if (!av1_symbol_read_symbol(sd, y_cdf, AV1_INTRA_MODES, &y_mode, err, err_cap)) {
+   if (!use_intrabc && !av1_symbol_read_symbol(sd, y_cdf, AV1_INTRA_MODES, &y_mode, err, err_cap)) {
       return false;
    }
    mi_set_y_mode_block(mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, y_mode);
-   if (st && !st->block0_y_mode_decoded) {
+   if (st && !use_intrabc && !st->block0_y_mode_decoded) {
       st->block0_y_mode_decoded = true;
       st->block0_y_mode_ctx = y_mode_ctx;
       st->block0_y_mode = y_mode;
    }
 
-   // Spec: when skip==1, there are no residual coefficients for the block.
-   // Our probe still decodes mode info for milestones, but must not consume coeffs().
-   if (skip) {
-      goto block_done;
-   }
-
    // Optional intra angle deltas for luma (only for directional intra modes).
    {
       uint32_t dir_idx = 0u;
@@ -3267,9 +4350,12 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
+   // uv_mode and everything under it (CFL alphas, angle_delta_uv, palette_uv) is read only when
+   // HasChroma: a 4xN / Nx4 block at an even MI column / row of a subsampled frame leaves its
+   // chroma to the next block.
    uint32_t uv_mode = 0;
    bool cfl_allowed = false;
-   if (!params->mono_chrome) {
+   if (has_chroma && !use_intrabc) {
       // uv_mode cdf selection per spec (see av1bitstream.html): depends on Lossless and block size.
       if (y_mode >= AV1_INTRA_MODES) {
          snprintf(err, err_cap, "invalid y_mode=%u", y_mode);
@@ -3318,7 +4404,7 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
 
    {
       uint32_t dir_idx = 0u;
-      if (!params->mono_chrome && intra_directional_index(uv_mode, &dir_idx)) {
+      if (has_chroma && !use_intrabc && intra_directional_index(uv_mode, &dir_idx)) {
          uint16_t *angle_cdf = mode_cdfs->angle_delta[dir_idx];
          uint32_t angle_sym = 0;
          if (!av1_symbol_read_symbol(sd, angle_cdf, AV1_ANGLE_DELTA_SYMBOLS, &angle_sym, err, err_cap)) {
@@ -3331,24 +4417,21 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
-   // palette_mode_info() (spec): only possible with screen content tools and certain block sizes.
-   // We only consume the initial entropy-coded presence flag(s) and palette size, then stop early
-   // if palette is actually used (palette color payload not implemented yet).
+   // palette_mode_info() (spec): only for MiSize >= BLOCK_8X8 up to 64x64 with screen content tools.
+   // Both sizes land in the MI grid once (a zero size never overwrites a decoded one), and the Y / U
+   // colors are kept for get_palette_cache() of later blocks.
    uint32_t palette_size_y = 0;
    uint32_t palette_size_uv = 0;
    {
       const uint32_t luma_w_px = (1u << wlog2) * 4u;
       const uint32_t luma_h_px = (1u << hlog2) * 4u;
-      const bool mi_ge_8x8 = (wlog2 >= 1u) && (hlog2 >= 1u);
+      uint32_t pal_mi_size = 0;
+      const bool ge_8x8 = mi_size_index_from_wlog2_hlog2(wlog2, hlog2, &pal_mi_size) && pal_mi_size >= 3u /* BLOCK_8X8 */;
       const bool le_64 = (luma_w_px <= 64u) && (luma_h_px <= 64u);
+      const uint32_t bit_depth = coeff_ctx->dequant.bit_depth;
 
-      if (params->allow_screen_content_tools && mi_ge_8x8 && le_64) {
-         uint32_t bsize_ctx = wlog2 + hlog2;
-         if (bsize_ctx < 2u) {
-            bsize_ctx = 0u;
-         } else {
-            bsize_ctx -= 2u;
-         }
+      if (params->allow_screen_content_tools && !use_intrabc && ge_8x8 && le_64) {
+         uint32_t bsize_ctx = wlog2 + hlog2 - 2u;
          if (bsize_ctx >= AV1_PALETTE_BLOCK_SIZE_CONTEXTS) {
             bsize_ctx = AV1_PALETTE_BLOCK_SIZE_CONTEXTS - 1u;
          }
@@ -3370,22 +4453,21 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
                   return false;
                }
                palette_size_y = palette_size_y_minus_2 + 2u;
-               mi_set_palette_sizes_block(mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, palette_size_y, 0u);
                if (st && !st->block0_palette_size_y_decoded) {
                   st->block0_palette_size_y_decoded = true;
                   st->block0_palette_size_y = palette_size_y;
                }
-               if (st) {
-                  st->blocks_decoded++;
-               }
-               if (out_stop) {
-                  *out_stop = true;
+
+               uint16_t cache[2 * AV1_PALETTE_MAX_COLORS];
+               const uint32_t cache_n = palette_cache_from_neighbors(coeff_ctx, mi_grid, mi_cols, r, c, 0u, cache);
+               if (!tile_read_palette_colors(sd, bit_depth, cache, cache_n, palette_size_y, 1u, coeff_ctx->palette_colors[0], err, err_cap)) {
+                  return false;
                }
-               return true;
+               palette_store_colors(coeff_ctx, mi_rows, mi_cols, r, c, wlog2, hlog2, 0u, coeff_ctx->palette_colors[0]);
             }
          }
 
-         if (!params->mono_chrome && uv_mode == 0u /* DC_PRED */) {
+         if (has_chroma && uv_mode == 0u /* DC_PRED */) {
             uint32_t has_palette_uv = 0;
             const uint32_t ctx = (palette_size_y > 0u) ? 1u : 0u;
             if (!av1_symbol_read_symbol(sd, mode_cdfs->palette_uv_mode[ctx], 2, &has_palette_uv, err, err_cap)) {
@@ -3402,20 +4484,21 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
                   return false;
                }
                palette_size_uv = palette_size_uv_minus_2 + 2u;
-               mi_set_palette_sizes_block(mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, 0u, palette_size_uv);
                if (st && !st->block0_palette_size_uv_decoded) {
                   st->block0_palette_size_uv_decoded = true;
                   st->block0_palette_size_uv = palette_size_uv;
                }
-               if (st) {
-                  st->blocks_decoded++;
-               }
-               if (out_stop) {
-                  *out_stop = true;
+
+               uint16_t cache[2 * AV1_PALETTE_MAX_COLORS];
+               const uint32_t cache_n = palette_cache_from_neighbors(coeff_ctx, mi_grid, mi_cols, r, c, 1u, cache);
+               if (!tile_read_palette_colors(sd, bit_depth, cache, cache_n, palette_size_uv, 0u, coeff_ctx->palette_colors[1], err, err_cap) ||
+                   !tile_read_palette_colors_v(sd, bit_depth, palette_size_uv, coeff_ctx->palette_colors[2], err, err_cap)) {
+                  return false;
                }
-               return true;
+               palette_store_colors(coeff_ctx, mi_rows, mi_cols, r, c, wlog2, hlog2, 1u, coeff_ctx->palette_colors[1]);
             }
          }
+         mi_set_palette_sizes_block(mi_grid, mi_rows, mi_cols, r, c, wlog2, hlog2, palette_size_y, palette_size_uv);
       }
    }
 
@@ -3430,7 +4513,7 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       const uint32_t luma_h_px = (1u << hlog2) * 4u;
       const uint32_t max_wh = (luma_w_px > luma_h_px) ? luma_w_px : luma_h_px;
 
-      if (params->enable_filter_intra && y_mode == 0u /* DC_PRED */ && max_wh <= 32u && palette_size_y == 0u) {
+      if (params->enable_filter_intra && !use_intrabc && y_mode == 0u /* DC_PRED */ && max_wh <= 32u && palette_size_y == 0u) {
          uint32_t mi_size = 0;
          if (!mi_size_index_from_wlog2_hlog2(wlog2, hlog2, &mi_size) || mi_size >= AV1_BLOCK_SIZES) {
             snprintf(err, err_cap, "unsupported MiSize mapping for %ux%u px", luma_w_px, luma_h_px);
@@ -3461,9 +4544,45 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
+   // palette_tokens() (spec): the color index maps follow the mode info, skip or not.
+   if (palette_size_y || palette_size_uv) {
+      const uint32_t block_w = (1u << wlog2) * 4u;
+      const uint32_t block_h = (1u << hlog2) * 4u;
+      const uint32_t onscreen_w = ((mi_cols - c) * 4u < block_w) ? (mi_cols - c) * 4u : block_w;
+      const uint32_t onscreen_h = ((mi_rows - r) * 4u < block_h) ? (mi_rows - r) * 4u : block_h;
+      if (palette_size_y &&
+          !tile_read_color_index_map(
+             sd, mode_cdfs->palette_y_color[palette_size_y - 2u], palette_size_y, coeff_ctx->color_map[0], block_w, block_h, onscreen_w, onscreen_h, err, err_cap)) {
+         return false;
+      }
+      if (palette_size_uv) {
+         uint32_t uv_w = block_w >> params->subsampling_x;
+         uint32_t uv_h = block_h >> params->subsampling_y;
+         uint32_t uv_onscreen_w = onscreen_w >> params->subsampling_x;
+         uint32_t uv_onscreen_h = onscreen_h >> params->subsampling_y;
+         if (uv_w < 4u) {
+            uv_w += 2u;
+            uv_onscreen_w += 2u;
+         }
+         if (uv_h < 4u) {
+            uv_h += 2u;
+            uv_onscreen_h += 2u;
+         }
+         if (!tile_read_color_index_map(
+                sd, mode_cdfs->palette_uv_color[palette_size_uv - 2u], palette_size_uv, coeff_ctx->color_map[1], uv_w, uv_h, uv_onscreen_w, uv_onscreen_h, err, err_cap)) {
+            return false;
+         }
+      }
+      if (st) {
+         st->palette_blocks++;
+      }
+   }
+
    // read_tx_size(allowSelect) (spec): for intra blocks, allowSelect is always true
    // because allowSelect = (!skip || !is_inter) and is_inter==0.
    // We only consume tx_depth when TxMode == TX_MODE_SELECT and !Lossless, but TxSize is always derivable.
+   // An intra block copy block is inter: with TX_MODE_SELECT it codes read_var_tx_size() unless
+   // skipped, otherwise TxSize is Max_Tx_Size_Rect (or TX_4X4 when Lossless).
    uint32_t mi_size = 0;
    if (!mi_size_index_from_wlog2_hlog2(wlog2, hlog2, &mi_size)) {
       snprintf(err, err_cap, "unsupported MiSize for tx_size (%ux%u px)", (1u << wlog2) * 4u, (1u << hlog2) * 4u);
@@ -3482,7 +4601,15 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
-   if (!block_lossless && params->tx_mode == 2u /* TX_MODE_SELECT */ && mi_size > 0u /* MiSize > BLOCK_4X4 */) {
+   if (use_intrabc && !skip && !block_lossless && params->tx_mode == 2u /* TX_MODE_SELECT */ && mi_size > 0u) {
+      if (out_stop) {
+         *out_stop = true;
+      }
+      snprintf(err, err_cap, "unsupported: intrabc with TX_MODE_SELECT (read_var_tx_size not implemented)");
+      return true;
+   }
+
+   if (!block_lossless && !use_intrabc && params->tx_mode == 2u /* TX_MODE_SELECT */ && mi_size > 0u /* MiSize > BLOCK_4X4 */) {
       const uint32_t ctx = 0u; // Correct for the first block; full ctx derivation comes later.
       const uint32_t max_tx_depth = max_tx_depth_from_mi_size(mi_size);
       uint16_t *cdf = NULL;
@@ -3527,10 +4654,27 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       st->block0_tx_size = tx_size;
    }
 
+   // Spec: when skip==1, there are no residual coefficients for the block. Mode info, palette
+   // tokens and tx_depth above are still coded.
+   if (skip) {
+      goto block_done;
+   }
+
    // transform_type() (spec): for our intra stub, decode intra_tx_type when the
    // tx set allows it and qindex>0. Otherwise TxType is forced to DCT_DCT.
    uint32_t tx_type = AV1_TX_TYPE_DCT_DCT;
-   {
+   if (use_intrabc) {
+      const uint32_t set = get_tx_set_inter(tx_size, params->reduced_tx_set);
+      if (!block_lossless && set != AV1_TX_SET_DCTONLY && block_qindex > 0u) {
+         if (!tile_read_inter_tx_type(sd, mode_cdfs, tx_size, params->reduced_tx_set, &tx_type, err, err_cap)) {
+            return false;
+         }
+         if (st && !st->block0_tx_type_decoded) {
+            st->block0_tx_type_decoded = true;
+            st->block0_tx_type = tx_type;
+         }
+      }
+   } else {
       const uint32_t set = get_tx_set_intra(tx_size, params->reduced_tx_set);
       const uint32_t txSzSqrUp = (tx_size < AV1_TX_SIZES_ALL) ? (uint32_t)kTxSizeSqrUp[tx_size] : 0u;
 
@@ -3606,6 +4750,19 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
    }
 
+   // Quantizers for this block: get_qindex( 0, segment_id ). The per-segment table covers the
+   // common case; a delta_q-adjusted CurrentQIndex is looked up on the fly.
+   Av1PlaneQuant block_quant_delta;
+   const Av1PlaneQuant *block_quant = &coeff_ctx->dequant.seg[segment_id];
+   if (params->delta_q_present && mode_cdfs->current_qindex != params->base_q_idx) {
+      int32_t q = (int32_t)mode_cdfs->current_qindex;
+      if (params->segmentation_enabled && params->seg_feature_enabled_alt_q[segment_id]) {
+         q += params->seg_feature_data_alt_q[segment_id];
+      }
+      av1_dequant_plane_quant(&coeff_ctx->dequant, segment_id, (uint32_t)clip3_i32(0, 255, q), &block_quant_delta);
+      block_quant = &block_quant_delta;
+   }
+
    // coeffs() (spec): iterate luma transform blocks in raster order.
    {
       if (tx_size >= AV1_TX_SIZES_ALL) {
@@ -3640,12 +4797,17 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
       }
 
       for (uint32_t tx_index = 0u; tx_index < max_tx; tx_index++) {
-         const uint32_t tx = (tx_cols == 0u) ? 0u : (tx_index % tx_cols);
-         const uint32_t ty = (tx_cols == 0u) ? 0u : (tx_index / tx_cols);
+         uint32_t tx = (tx_cols == 0u) ? 0u : (tx_index % tx_cols);
+         uint32_t ty = (tx_cols == 0u) ? 0u : (tx_index / tx_cols);
+         if (use_intrabc) {
+            inter_tx_block_position(bw4, bh4, tx_w4, tx_h4, tx_index, &tx, &ty);
+         }
          const uint32_t x4 = c + tx * tx_w4;
          const uint32_t y4 = r + ty * tx_h4;
 
          bool stop_now = false;
+         Av1TxCoeffExtent extent;
+         bool extent_valid = false;
          if (!decode_coeffs_luma_one_tx_block(sd,
                                               coeff_cdfs,
                                               coeff_ctx,
@@ -3661,12 +4823,20 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
                                               tx_size,
                                               tx_type,
                                               params->probe_try_exit_symbol,
+                                              block_quant,
+                                              coeff_ctx->dequant_buf,
                                               st,
                                               &stop_now,
+                                              &extent,
+                                              &extent_valid,
                                               err,
                                               err_cap)) {
             return false;
          }
+         if (extent_valid) {
+            tally_coeff_extent(st, &extent, coeff_ctx->dequant_buf, tx_size);
+         }
+         dequant_buf_clear(coeff_ctx->dequant_buf, tx_size, &extent);
 
          if (st && block_index == 0u) {
             st->block0_tx_blocks_decoded = tx_index + 1u;
@@ -3679,8 +4849,9 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
    }
 
    // coeffs() (spec): for chroma planes, use get_tx_size(plane,txSz) and compute_tx_type().
-   // We only decode a lightweight, stable prefix for one tx block per chroma plane.
-   if (!params->mono_chrome) {
+   // We only decode a lightweight, stable prefix for one tx block per chroma plane. residual()
+   // codes the chroma planes only when HasChroma.
+   if (has_chroma) {
       static const uint8_t kModeToTxfmUv[AV1_UV_INTRA_MODES_CFL_ALLOWED] = {
           AV1_TX_TYPE_DCT_DCT,   // DC_PRED
           AV1_TX_TYPE_ADST_DCT,  // V_PRED
@@ -3719,7 +4890,12 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
          }
 
          uint32_t plane_tx_type = AV1_TX_TYPE_DCT_DCT;
-         if (!block_lossless) {
+         if (!block_lossless && use_intrabc) {
+            // compute_tx_type() for an inter block: the luma TxType, if the chroma set allows it.
+            if (is_tx_type_in_set_inter(get_tx_set_inter(plane_tx_size, params->reduced_tx_set), tx_type)) {
+               plane_tx_type = tx_type;
+            }
+         } else if (!block_lossless) {
             if (uv_mode < AV1_UV_INTRA_MODES_CFL_ALLOWED) {
                plane_tx_type = (uint32_t)kModeToTxfmUv[uv_mode];
             }
@@ -3767,6 +4943,8 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
             const uint32_t y4 = base_y4 + ty * tx_h4;
 
             bool stop_now = false;
+            Av1TxCoeffExtent extent;
+            bool extent_valid = false;
             if (!decode_coeffs_luma_one_tx_block(sd,
                                                  coeff_cdfs,
                                                  coeff_ctx,
@@ -3782,12 +4960,20 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
                                                  plane_tx_size,
                                                  plane_tx_type,
                                                  params->probe_try_exit_symbol,
+                                                 block_quant,
+                                                 coeff_ctx->dequant_buf,
                                                  st,
                                                  &stop_now,
+                                                 &extent,
+                                                 &extent_valid,
                                                  err,
                                                  err_cap)) {
                return false;
             }
+            if (extent_valid) {
+               tally_coeff_extent(st, &extent, coeff_ctx->dequant_buf, plane_tx_size);
+            }
+            dequant_buf_clear(coeff_ctx->dequant_buf, plane_tx_size, &extent);
 
             if (stop_now) {
                break;
@@ -3803,6 +4989,28 @@ static bool decode_block_stub(Av1SymbolDecoder *sd,
 
 block_done:
 
+   // The block's deblocking inputs: LoopfilterTxSizes is TX_4X4 for every plane of a lossless
+   // block. Intra block copy blocks still have RefFrame[ 0 ] == INTRA_FRAME.
+   if (params->lf_mi && params->lf_levels) {
+      Av1LfMi lf;
+      memset(&lf, 0, sizeof(lf));
+      lf.bw4_log2 = (uint8_t)wlog2;
+      lf.bh4_log2 = (uint8_t)hlog2;
+      lf.tx_size[0] = (uint8_t)tx_size;
+      uint32_t uv_tx_size = AV1_TX_4X4;
+      if (!block_lossless && !params->mono_chrome &&
+          !get_tx_size_for_plane(1u, tx_size, wlog2, hlog2, params->subsampling_x, params->subsampling_y, &uv_tx_size)) {
+         uv_tx_size = AV1_TX_4X4;
+      }
+      lf.tx_size[1] = (uint8_t)uv_tx_size;
+      lf.skip = (uint8_t)skip;
+      lf.segment_id = (uint8_t)segment_id;
+      for (uint32_t i = 0; i < AV1_FRAME_LF_COUNT; i++) {
+         lf.delta_lf[i] = (int8_t)mode_cdfs->delta_lf_state[i];
+      }
+      lf_mi_set_block(params, mi_rows, mi_cols, r, c, wlog2, hlog2, &lf);
+   }
+
    if (st) {
       st->blocks_decoded++;
    }
@@ -4396,7 +5604,9 @@ Av1TileSyntaxProbeStatus av1_tile_syntax_probe(const uint8_t *tile_data,
                             params->subsampling_x,
                             params->subsampling_y,
                             err,
-                            err_cap)) {
+                            err_cap) ||
+       !tile_coeff_ctx_init_dequant(&coeff_ctx, params, err, err_cap)) {
+      tile_coeff_ctx_free(&coeff_ctx);
       free(mi_grid);
       return AV1_TILE_SYNTAX_PROBE_ERROR;
    }
@@ -4463,6 +5673,9 @@ Av1TileSyntaxProbeStatus av1_tile_syntax_probe(const uint8_t *tile_data,
                   free(mi_grid);
                   return AV1_TILE_SYNTAX_PROBE_ERROR;
                }
+               if (params->segmap && params->segmentation_enabled) {
+                  segmap_store_sb(params, mi_grid, tile_mi_rows, tile_mi_cols, r0, c0, sb_mi_size);
+               }
                if (stop) {
                   break;
                }
@@ -4482,7 +5695,7 @@ Av1TileSyntaxProbeStatus av1_tile_syntax_probe(const uint8_t *tile_data,
       // running exit_symbol(). This will typically fail until full tile syntax decode exists,
       // but is still useful as a correctness check.
       if (stop) {
-         // stop==true is only used for early-exit cases like palette (unsupported) at the moment.
+         // stop==true is only used for early-exit cases like intrabc (unsupported) at the moment.
          if (err && err_cap > 0 && err[0] == 0) {
             snprintf(err, err_cap, "unsupported: probe stopped before end-of-tile");
          }
@@ -4516,25 +5729,9 @@ Av1TileSyntaxProbeStatus av1_tile_syntax_probe(const uint8_t *tile_data,
       return AV1_TILE_SYNTAX_PROBE_OK;
    }
 
-   if (out_stats && ((out_stats->block0_has_palette_y_decoded && out_stats->block0_has_palette_y) ||
-                     (out_stats->block0_has_palette_uv_decoded && out_stats->block0_has_palette_uv))) {
-      snprintf(err,
-               err_cap,
-               "unsupported: palette used (Y=%s%u size=%s%u, UV=%s%u size=%s%u); stopped=%s",
-               out_stats->block0_has_palette_y_decoded ? "" : "n/a ",
-               out_stats->block0_has_palette_y_decoded ? out_stats->block0_has_palette_y : 0u,
-               out_stats->block0_palette_size_y_decoded ? "" : "n/a ",
-               out_stats->block0_palette_size_y_decoded ? out_stats->block0_palette_size_y : 0u,
-               out_stats->block0_has_palette_uv_decoded ? "" : "n/a ",
-               out_stats->block0_has_palette_uv_decoded ? out_stats->block0_has_palette_uv : 0u,
-               out_stats->block0_palette_size_uv_decoded ? "" : "n/a ",
-               out_stats->block0_palette_size_uv_decoded ? out_stats->block0_palette_size_uv : 0u,
-               stop ? "yes" : "no");
-   } else {
-      snprintf(err,
-               err_cap,
-               "unsupported: decode_block() stub decoded skip+y_mode+uv_mode (+ optional angle_delta/filter_intra/palette prelude) + tx_depth when applicable + coeffs() prefix (txb_skip,eob_pt,eob,coeff_base_eob[,coeff_base]); stopped=%s",
-               stop ? "yes" : "no");
-   }
+   snprintf(err,
+            err_cap,
+            "unsupported: decode_block() stub decoded skip+y_mode+uv_mode (+ optional angle_delta/palette/filter_intra) + tx_depth when applicable + coeffs() prefix (txb_skip,eob_pt,eob,coeff_base_eob[,coeff_base]); stopped=%s",
+            stop ? "yes" : "no");
    return AV1_TILE_SYNTAX_PROBE_UNSUPPORTED;
 }
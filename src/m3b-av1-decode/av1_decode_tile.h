@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "av1_loopfilter.h"
+#include "av1_segmap.h"
+
 // m3b.D scaffolding: tile syntax traversal entrypoint.
 //
 // This intentionally starts life as a probe that can run on real tile payloads without
@@ -22,10 +25,16 @@ typedef struct {
     uint32_t mi_row_start;
     uint32_t mi_row_end;
 
+    // From the frame header: MiRows / MiCols (clamps intra block copy DV predictions). 0 means
+    // the tile is the whole frame.
+    uint32_t mi_rows;
+    uint32_t mi_cols;
+
     // From the sequence header.
     uint32_t use_128x128_superblock;
 
     // From the sequence header color_config().
+    uint32_t bit_depth; // BitDepth (0 is treated as 8); selects the quantizer tables
     uint32_t mono_chrome;
     uint32_t subsampling_x;
     uint32_t subsampling_y;
@@ -59,13 +68,20 @@ typedef struct {
     // From the frame header quantizer_params(). Used to initialize coeff CDFs.
     uint32_t base_q_idx;
 
-    // From the frame header quantizer_params(). Used for Lossless derivation.
+    // From the frame header quantizer_params(). Used for Lossless derivation and dequantization.
     int32_t delta_q_y_dc;
     int32_t delta_q_u_dc;
     int32_t delta_q_u_ac;
     int32_t delta_q_v_dc;
     int32_t delta_q_v_ac;
 
+    // From the frame header quantizer_params(): using_qmatrix and qm_y / qm_u / qm_v (15 = flat).
+    // Select the quantizer matrix weights of dequantization.
+    uint32_t using_qmatrix;
+    uint32_t qm_y;
+    uint32_t qm_u;
+    uint32_t qm_v;
+
     // From read_tx_mode() in the frame header.
     // Values match the AV1 spec names:
     // 0 = ONLY_4X4, 1 = TX_MODE_LARGEST, 2 = TX_MODE_SELECT.
@@ -90,12 +106,40 @@ typedef struct {
     // 0 (default): keep the lightweight "stop early" probe behavior (expected UNSUPPORTED).
     // 1: attempt full tile traversal and call exit_symbol() at the true end-of-tile.
     uint32_t probe_try_exit_symbol;
+
+    // Optional deblocking output. When lf_mi and lf_levels are set, every decoded block writes its
+    // Av1LfMi over its units, filter levels included (segment, DeltaLF and mode deltas resolved
+    // through the frame's level table). lf_mi points at the tile's first MI in a grid with row
+    // stride lf_mi_stride, so a frame-wide grid can be shared by all tiles.
+    const Av1LfLevels *lf_levels;
+    Av1LfMi *lf_mi;
+    ptrdiff_t lf_mi_stride;
+
+    // Optional segmentation map output. When set, every block that reads intra_segment_id() stores
+    // its segment_id at its frame MI position (tile offset mi_row_start / mi_col_start), so one
+    // frame-wide map is shared by all tiles.
+    Av1SegMap *segmap;
 } Av1TileDecodeParams;
 
 typedef struct {
     uint32_t bools_requested;
     uint32_t bools_read;
 
+    // Sparse-coefficient summary over transform blocks whose coeffs() ran to completion
+    // (see Av1TxCoeffExtent in av1_inv_txfm.h).
+    uint32_t coeff_txb_total;
+    uint32_t coeff_txb_all_zero;
+    uint32_t coeff_txb_dc_only;
+    uint32_t coeff_txb_eob_le16;
+    // Sum of |Dequant[][]| over those blocks (a cheap fingerprint of the dequantized output;
+    // lossless blocks contribute their transform input, Dequant / 4).
+    uint64_t coeff_dequant_abs_sum;
+    // Blocks that decoded a palette (PaletteSizeY or PaletteSizeUV non-zero) with its color index
+    // maps.
+    uint32_t palette_blocks;
+    // Blocks with use_intrabc set (DV read and validated; see av1_intrabc.h).
+    uint32_t intrabc_blocks;
+
     // Derived grid dimensions.
     uint32_t tile_mi_cols;
     uint32_t tile_mi_rows;
@@ -0,0 +1,156 @@
+#include "av1_dequant.h"
+
+#include <string.h>
+
+#include "av1_qm_tables.inc"
+#include "av1_quant_tables.inc"
+
+static uint32_t bit_depth_index(uint32_t bit_depth) {
+    return bit_depth >= 12u ? 2u : (bit_depth >= 10u ? 1u : 0u);
+}
+
+static uint32_t clip_qindex(int32_t b) {
+    return b < 0 ? 0u : (b > 255 ? 255u : (uint32_t)b);
+}
+
+int32_t av1_dc_q(uint32_t bit_depth, int32_t b) {
+    return kDcQLookup[bit_depth_index(bit_depth)][clip_qindex(b)];
+}
+
+int32_t av1_ac_q(uint32_t bit_depth, int32_t b) {
+    return kAcQLookup[bit_depth_index(bit_depth)][clip_qindex(b)];
+}
+
+// Qm_Offset[] and log2 of Min( 32, Tx_Width ) / Min( 32, Tx_Height ), in TX_SIZES_ALL order.
+static const uint16_t kQmOffset[19] = {0,    16,   80,   336,  336,  1360, 1392, 1424, 1552, 1680,
+                                       2192, 336,  336,  2704, 2768, 2832, 3088, 1680, 2192};
+static const uint8_t kQmWidthLog2[19] = {2, 3, 4, 5, 5, 2, 3, 3, 4, 4, 5, 5, 5, 2, 4, 3, 5, 4, 5};
+static const uint8_t kQmHeightLog2[19] = {2, 3, 4, 5, 5, 3, 2, 4, 3, 5, 4, 5, 5, 4, 2, 5, 3, 5, 4};
+
+uint32_t av1_qm_offset(uint32_t tx_size) {
+    return tx_size < 19u ? kQmOffset[tx_size] : 0u;
+}
+
+// Fundamental matrix entry ( r, c ) of size ( 1 << log2fw ) x ( 1 << log2fh ), from the compact tables.
+static uint8_t qm_fundamental(uint32_t level, uint32_t chroma, uint32_t log2fw, uint32_t log2fh, uint32_t r, uint32_t c) {
+    if (log2fw == log2fh) {
+        return r >= c ? kQmTri32[level][chroma][r * (r + 1u) / 2u + c] : kQmTri32[level][chroma][c * (c + 1u) / 2u + r];
+    }
+    return log2fw > log2fh ? kQm32x16[level][chroma][r * 32u + c] : kQm32x16[level][chroma][c * 32u + r];
+}
+
+void av1_qm_expand(uint32_t level, uint32_t chroma, uint8_t out[AV1_QM_TOTAL_SIZE]) {
+    // Spec 9.5.2: derivedMatrix[ i * w + j ] = fundamentalMatrix[ ( ratioH * i + phaseH ) * fW +
+    // ratioW * j + phaseW ]. TX_64X64 etc. share the tables of their 32-point counterparts.
+    for (uint32_t tx = 0; tx < 19u; tx++) {
+        const uint32_t lw = kQmWidthLog2[tx];
+        const uint32_t lh = kQmHeightLog2[tx];
+        const uint32_t lfw = lw == lh ? 5u : (lw > lh ? 5u : 4u);
+        const uint32_t lfh = lw == lh ? 5u : (lw > lh ? 4u : 5u);
+        const uint32_t ratio_w = 1u << (lfw - lw);
+        const uint32_t ratio_h = 1u << (lfh - lh);
+        const uint32_t phase_w = (ratio_w + 1u) / 2u - 1u;
+        const uint32_t phase_h = (ratio_h + 1u) / 2u - 1u;
+        uint8_t *m = out + kQmOffset[tx];
+        for (uint32_t i = 0; i < (1u << lh); i++) {
+            for (uint32_t j = 0; j < (1u << lw); j++) {
+                m[(i << lw) + j] = qm_fundamental(level, chroma, lfw, lfh, ratio_h * i + phase_h, ratio_w * j + phase_w);
+            }
+        }
+    }
+}
+
+void av1_dequant_plane_quant(const Av1DequantLut *lut, uint32_t segment_id, uint32_t qindex, Av1PlaneQuant *out) {
+    for (uint32_t p = 0; p < 3; p++) {
+        out->dc[p] = av1_dc_q(lut->bit_depth, (int32_t)qindex + lut->delta_q[p][0]);
+        out->ac[p] = av1_ac_q(lut->bit_depth, (int32_t)qindex + lut->delta_q[p][1]);
+        out->qm_level[p] = segment_id < AV1_DEQUANT_SEGMENTS ? lut->seg[segment_id].qm_level[p] : (uint8_t)AV1_QM_FLAT;
+    }
+    out->lossless = (uint8_t)(segment_id < AV1_DEQUANT_SEGMENTS && lut->seg[segment_id].lossless && qindex == 0u);
+}
+
+void av1_dequant_lut_init(Av1DequantLut *lut,
+                          uint32_t bit_depth,
+                          const uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS],
+                          int32_t delta_q_y_dc,
+                          int32_t delta_q_u_dc,
+                          int32_t delta_q_u_ac,
+                          int32_t delta_q_v_dc,
+                          int32_t delta_q_v_ac) {
+    memset(lut, 0, sizeof(*lut));
+    lut->bit_depth = bit_depth;
+    lut->delta_q[0][0] = delta_q_y_dc;
+    lut->delta_q[1][0] = delta_q_u_dc;
+    lut->delta_q[1][1] = delta_q_u_ac;
+    lut->delta_q[2][0] = delta_q_v_dc;
+    lut->delta_q[2][1] = delta_q_v_ac;
+    for (uint32_t p = 0; p < 3; p++) {
+        lut->qm_level[p] = AV1_QM_FLAT;
+    }
+    for (uint32_t s = 0; s < AV1_DEQUANT_SEGMENTS; s++) {
+        lut->seg_qindex[s] = seg_qindex[s];
+        for (uint32_t p = 0; p < 3; p++) {
+            lut->seg[s].qm_level[p] = (uint8_t)AV1_QM_FLAT;
+        }
+        av1_dequant_plane_quant(lut, s, seg_qindex[s], &lut->seg[s]);
+    }
+}
+
+void av1_dequant_lut_set_qm(Av1DequantLut *lut,
+                            uint32_t using_qmatrix,
+                            uint32_t qm_y,
+                            uint32_t qm_u,
+                            uint32_t qm_v,
+                            const bool seg_lossless[AV1_DEQUANT_SEGMENTS]) {
+    const uint32_t levels[3] = {qm_y, qm_u, qm_v};
+    for (uint32_t p = 0; p < 3; p++) {
+        lut->qm_level[p] = using_qmatrix && levels[p] < AV1_QM_FLAT ? levels[p] : AV1_QM_FLAT;
+        if (lut->qm_level[p] == AV1_QM_FLAT) {
+            continue;
+        }
+        // qm_v usually repeats qm_u (separate_uv_delta_q = 0): share the expansion.
+        if (p == 2u && lut->qm_level[2] == lut->qm_level[1]) {
+            memcpy(lut->qm[2], lut->qm[1], AV1_QM_TOTAL_SIZE);
+        } else {
+            av1_qm_expand(lut->qm_level[p], p > 0u, lut->qm[p]);
+        }
+    }
+    for (uint32_t s = 0; s < AV1_DEQUANT_SEGMENTS; s++) {
+        for (uint32_t p = 0; p < 3; p++) {
+            lut->seg[s].qm_level[p] = (uint8_t)(seg_lossless[s] ? AV1_QM_FLAT : lut->qm_level[p]);
+        }
+        lut->seg[s].lossless = (uint8_t)seg_lossless[s];
+    }
+}
+
+static void qm_block_c(int32_t *dst,
+                       uint32_t dst_stride_log2,
+                       const int32_t *quant,
+                       const uint8_t *wt,
+                       uint32_t log2tw,
+                       uint32_t rows,
+                       uint32_t cols,
+                       int32_t dc_q,
+                       int32_t ac_q,
+                       uint32_t denom_shift,
+                       uint32_t bit_depth) {
+    for (uint32_t i = 0; i < rows; i++) {
+        for (uint32_t j = 0; j < cols; j++) {
+            const uint32_t k = (i << log2tw) + j;
+            const int32_t q = k == 0u ? dc_q : ac_q;
+            const int32_t q2 = (q * wt[k] + 16) >> 5;
+            dst[(i << dst_stride_log2) + j] = av1_dequant_coeff(quant[k], q2, denom_shift, bit_depth);
+        }
+    }
+}
+
+void av1_dequant_dsp_init_c(Av1DequantDsp *dsp) {
+    dsp->qm_block = qm_block_c;
+}
+
+void av1_dequant_dsp_init(Av1DequantDsp *dsp) {
+    av1_dequant_dsp_init_c(dsp);
+#if defined(AV1_DEQUANT_HAVE_X86)
+    (void)av1_dequant_dsp_init_avx2(dsp);
+#endif
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Dequantization (spec 7.12.2 "Dequantization functions" and step a-f of 7.12.3).
+//
+// The coefficient decoder dequantizes each coefficient as soon as its sign and Golomb tail are
+// known and writes it straight into the inverse transform input, so there is no separate pass over
+// Quant[]. The per-coefficient work is one multiply: the quantizers of every segment and plane are
+// looked up once per tile (Av1DequantLut).
+//
+// Quantizer matrices (using_qmatrix) weight each quantizer by Quantizer_Matrix[][][]. The spec
+// table is ~100 KB; av1_qm_tables.inc keeps only the fundamental matrices and the tables a frame
+// needs are expanded when its Av1DequantLut is built. Weighted blocks are dequantized after
+// coeffs() with an Av1DequantDsp kernel over the non-zero bounding box (AVX2 in av1_dequant_x86.c).
+
+#define AV1_DEQUANT_SEGMENTS 8u
+
+// qmLevel 15 means "no matrix" (flat weights).
+#define AV1_QM_FLAT 15u
+#define AV1_QM_TOTAL_SIZE 3344u
+
+// dc_q( b ) / ac_q( b ) for BitDepth 8, 10 or 12; b is clipped to 0..255.
+int32_t av1_dc_q(uint32_t bit_depth, int32_t b);
+int32_t av1_ac_q(uint32_t bit_depth, int32_t b);
+
+// Qm_Offset[ txSz ] (TX_SIZES_ALL order).
+uint32_t av1_qm_offset(uint32_t tx_size);
+
+// Quantizer_Matrix[ level ][ chroma ] in the spec layout, for level < AV1_QM_FLAT.
+void av1_qm_expand(uint32_t level, uint32_t chroma, uint8_t out[AV1_QM_TOTAL_SIZE]);
+
+// get_dc_quant( plane ) / get_ac_quant( plane ) for one qindex, and SegQMLevel[ plane ][ segment ].
+// lossless: LosslessArray[ segment ] at qindex 0 (every quantizer 4); such blocks take
+// av1_dequant_lossless_coeff() instead of av1_dequant_coeff().
+typedef struct {
+    int32_t dc[3];
+    int32_t ac[3];
+    uint8_t qm_level[3];
+    uint8_t lossless;
+} Av1PlaneQuant;
+
+typedef struct {
+    uint32_t bit_depth;
+    // DeltaQYDc, DeltaQUDc, DeltaQUAc, DeltaQVDc, DeltaQVAc as [ plane ][ 0 = dc, 1 = ac ]
+    // (DeltaQYAc is always 0).
+    int32_t delta_q[3][2];
+    // Quantizers for get_qindex( 1, segmentId ), i.e. without the block-level delta_q.
+    uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS];
+    Av1PlaneQuant seg[AV1_DEQUANT_SEGMENTS];
+    // Expanded Quantizer_Matrix for qm_y / qm_u / qm_v (only valid where the level is not flat).
+    uint32_t qm_level[3];
+    uint8_t qm[3][AV1_QM_TOTAL_SIZE];
+} Av1DequantLut;
+
+// seg_qindex[ s ] is get_qindex( 1, s ) (base_q_idx plus the segment's alt_q, clipped). Every
+// SegQMLevel starts flat; see av1_dequant_lut_set_qm().
+void av1_dequant_lut_init(Av1DequantLut *lut,
+                          uint32_t bit_depth,
+                          const uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS],
+                          int32_t delta_q_y_dc,
+                          int32_t delta_q_u_dc,
+                          int32_t delta_q_u_ac,
+                          int32_t delta_q_v_dc,
+                          int32_t delta_q_v_ac);
+
+// using_qmatrix / qm_y / qm_u / qm_v of quantization_params(): sets SegQMLevel (flat for the
+// segments in seg_lossless, which are also marked lossless) and expands the matrices.
+void av1_dequant_lut_set_qm(Av1DequantLut *lut,
+                            uint32_t using_qmatrix,
+                            uint32_t qm_y,
+                            uint32_t qm_u,
+                            uint32_t qm_v,
+                            const bool seg_lossless[AV1_DEQUANT_SEGMENTS]);
+
+// Quantizers of a segment for an arbitrary qindex (blocks whose CurrentQIndex differs from
+// base_q_idx).
+void av1_dequant_plane_quant(const Av1DequantLut *lut, uint32_t segment_id, uint32_t qindex, Av1PlaneQuant *out);
+
+// Quantizer_Matrix weights of a transform block (row stride Min( 32, w )), or NULL when q2 = q:
+// flat SegQMLevel or PlaneTxType >= IDTX (pass two_d = false for IDTX and 1D types).
+static inline const uint8_t *av1_dequant_qm_weights(const Av1DequantLut *lut,
+                                                    const Av1PlaneQuant *pq,
+                                                    uint32_t plane,
+                                                    uint32_t tx_size,
+                                                    bool two_d) {
+    if (!two_d || pq->qm_level[plane] >= AV1_QM_FLAT) {
+        return NULL;
+    }
+    return lut->qm[plane] + av1_qm_offset(tx_size);
+}
+
+// log2( dqDenom ) for a transform of (1 << log2w) x (1 << log2h): 2 for 64x64 / 32x64 / 64x32,
+// 1 for 32x32 / 16x32 / 32x16 / 16x64 / 64x16, otherwise 0.
+static inline uint32_t av1_dequant_denom_shift(uint32_t log2w, uint32_t log2h) {
+    return log2w + log2h >= 11u ? 2u : (log2w + log2h >= 9u ? 1u : 0u);
+}
+
+// Dequant[ i ][ j ] from Quant[ i * tw + j ] and its quantizer q (q2 when a quantizer matrix
+// applies): Clip3( -( 1 << ( 7 + BitDepth ) ), ( 1 << ( 7 + BitDepth ) ) - 1,
+// sign * ( Abs( Quant * q ) & 0xFFFFFF ) / dqDenom ).
+static inline int32_t av1_dequant_coeff(int32_t quant, int32_t q, uint32_t denom_shift, uint32_t bit_depth) {
+    const uint64_t mag = ((uint64_t)(quant < 0 ? -(int64_t)quant : quant) * (uint32_t)q) & 0xFFFFFFu;
+    const int32_t v = (int32_t)(mag >> denom_shift);
+    const int32_t lim = 1 << (7u + bit_depth);
+    if (quant < 0) {
+        return -v < -lim ? -lim : -v;
+    }
+    return v > lim - 1 ? lim - 1 : v;
+}
+
+// Transform input of a lossless block: Dequant[ i ][ j ] / 4. With q = 4 (dc_q( 0 ) = ac_q( 0 ) for
+// every BitDepth) and dqDenom 1 (TX_4X4), Dequant is Clip3( -( 1 << ( 7 + BitDepth ) ),
+// ( 1 << ( 7 + BitDepth ) ) - 1, 4 * Quant ), and the row WHT starts with >> 2 (spec 7.13.2.10,
+// shift 2), so av1_inv_wht4x4() takes Quant itself, clipped, and skips that shift. The 24-bit mask
+// never applies: Quant stays below 1 << 21.
+static inline int32_t av1_dequant_lossless_coeff(int32_t quant, uint32_t bit_depth) {
+    const int32_t lim = 1 << (5u + bit_depth);
+    return quant < -lim ? -lim : (quant > lim - 1 ? lim - 1 : quant);
+}
+
+// Dequant[ i ][ j ] for i < rows, j < cols of a block with quantizer-matrix weights:
+// q2 = Round2( q * wt[ i * tw + j ], 5 ), then as av1_dequant_coeff(). quant is Quant[] with row
+// stride tw = 1 << log2tw; dst has row stride 1 << dst_stride_log2. Kernels may also store the
+// (zero) entries of columns cols..tw-1.
+typedef void (*Av1DequantQmFn)(int32_t *dst,
+                               uint32_t dst_stride_log2,
+                               const int32_t *quant,
+                               const uint8_t *wt,
+                               uint32_t log2tw,
+                               uint32_t rows,
+                               uint32_t cols,
+                               int32_t dc_q,
+                               int32_t ac_q,
+                               uint32_t denom_shift,
+                               uint32_t bit_depth);
+
+typedef struct {
+    Av1DequantQmFn qm_block;
+} Av1DequantDsp;
+
+// Scalar reference table.
+void av1_dequant_dsp_init_c(Av1DequantDsp *dsp);
+
+// Best table for the running CPU.
+void av1_dequant_dsp_init(Av1DequantDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_DEQUANT_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_dequant_dsp_init_avx2(Av1DequantDsp *dsp);
+#endif
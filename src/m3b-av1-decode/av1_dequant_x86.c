@@ -0,0 +1,91 @@
+#include "av1_dequant.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 quantizer-matrix dequantization, bit-exact with qm_block_c() in av1_dequant.c.
+//
+// Eight coefficients per vector on 32-bit lanes: q2 = ( q * wt + 16 ) >> 5 stays below 2^23, and
+// only the low 24 bits of Abs( Quant ) * q2 are kept, so the low half of a 32x32 multiply is
+// exact. Functions carry a target attribute so the file builds with the default CFLAGS;
+// av1_dequant_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_DEQUANT_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+// Abs( x ) * q2 & 0xFFFFFF, >> denom_shift, with the sign of x, clipped to [ lo, hi ].
+static inline AVX2_ATTR __m256i dequant_8(__m256i x, __m256i q2, __m128i shift, __m256i lo, __m256i hi) {
+    const __m256i mag = _mm256_and_si256(_mm256_mullo_epi32(_mm256_abs_epi32(x), q2), _mm256_set1_epi32(0xFFFFFF));
+    const __m256i v = _mm256_sign_epi32(_mm256_srl_epi32(mag, shift), x);
+    return _mm256_min_epi32(_mm256_max_epi32(v, lo), hi);
+}
+
+static inline AVX2_ATTR __m128i dequant_4(__m128i x, __m128i q2, __m128i shift, __m128i lo, __m128i hi) {
+    const __m128i mag = _mm_and_si128(_mm_mullo_epi32(_mm_abs_epi32(x), q2), _mm_set1_epi32(0xFFFFFF));
+    const __m128i v = _mm_sign_epi32(_mm_srl_epi32(mag, shift), x);
+    return _mm_min_epi32(_mm_max_epi32(v, lo), hi);
+}
+
+static AVX2_ATTR void qm_block_avx2(int32_t *dst,
+                                    uint32_t dst_stride_log2,
+                                    const int32_t *quant,
+                                    const uint8_t *wt,
+                                    uint32_t log2tw,
+                                    uint32_t rows,
+                                    uint32_t cols,
+                                    int32_t dc_q,
+                                    int32_t ac_q,
+                                    uint32_t denom_shift,
+                                    uint32_t bit_depth) {
+    const int32_t lim = 1 << (7u + bit_depth);
+    const __m128i shift = _mm_cvtsi32_si128((int)denom_shift);
+    if (log2tw == 2u) {
+        // 4-wide transforms: one row per 128-bit vector.
+        const __m128i lo = _mm_set1_epi32(-lim);
+        const __m128i hi = _mm_set1_epi32(lim - 1);
+        for (uint32_t i = 0; i < rows; i++) {
+            int32_t w4;
+            memcpy(&w4, wt + 4u * i, 4);
+            const __m128i q = i == 0u ? _mm_setr_epi32(dc_q, ac_q, ac_q, ac_q) : _mm_set1_epi32(ac_q);
+            const __m128i w = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(w4));
+            const __m128i q2 = _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(q, w), _mm_set1_epi32(16)), 5);
+            const __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(quant + 4u * i));
+            _mm_storeu_si128((__m128i *)(void *)(dst + (i << dst_stride_log2)), dequant_4(x, q2, shift, lo, hi));
+        }
+        return;
+    }
+    const __m256i lo = _mm256_set1_epi32(-lim);
+    const __m256i hi = _mm256_set1_epi32(lim - 1);
+    const __m256i ac = _mm256_set1_epi32(ac_q);
+    const __m256i dc_first = _mm256_blend_epi32(ac, _mm256_set1_epi32(dc_q), 1);
+    for (uint32_t i = 0; i < rows; i++) {
+        const int32_t *qrow = quant + (i << log2tw);
+        const uint8_t *wrow = wt + (i << log2tw);
+        int32_t *drow = dst + (i << dst_stride_log2);
+        for (uint32_t j = 0; j < cols; j += 8) {
+            const __m256i q = (i | j) == 0u ? dc_first : ac;
+            const __m256i w = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)(wrow + j)));
+            const __m256i q2 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(q, w), _mm256_set1_epi32(16)), 5);
+            const __m256i x = _mm256_loadu_si256((const __m256i *)(const void *)(qrow + j));
+            _mm256_storeu_si256((__m256i *)(void *)(drow + j), dequant_8(x, q2, shift, lo, hi));
+        }
+    }
+}
+
+bool av1_dequant_dsp_init_avx2(Av1DequantDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->qm_block = qm_block_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_dequant.c uses the scalar reference.
+typedef int av1_dequant_x86_unused;
+
+#endif
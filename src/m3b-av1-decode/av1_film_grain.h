@@ -0,0 +1,192 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+#include "av1_thread_pool.h"
+
+// Film grain synthesis (spec 7.18.3).
+//
+// Grain is added to the output picture only; the frame that later frames predict from stays
+// clean, so synthesis reads the filtered frame and writes a separate output frame. Binding a frame
+// generates the 82x73 luma grain template and the chroma templates from the 16-bit LFSR and the
+// Gaussian sequence, runs the auto-regressive filter over them and builds the scaling LUTs.
+// Blending walks 32x32 luma blocks: a block takes its noise from the templates at a random offset,
+// blends its first two columns (one for horizontally subsampled chroma) with the block to the left
+// and its first two rows with the block above when overlap_flag is set, and adds the noise scaled
+// by the LUT entry of each pixel. Every block row reseeds the generator, so block rows are
+// independent jobs. The 8-bit blend kernels have AVX2 versions (av1_film_grain_x86.c).
+
+#define AV1_FG_MAX_Y_POINTS 14u
+#define AV1_FG_MAX_UV_POINTS 10u
+#define AV1_FG_MAX_AR_COEFFS 25u // 2 * lag * ( lag + 1 ) + 1 for ar_coeff_lag 3
+#define AV1_FG_GRAIN_W 82u
+#define AV1_FG_GRAIN_H 73u
+#define AV1_FG_BLOCK 32u // luma block size; noise blocks are AV1_FG_BLOCK int16 apart per row
+
+// ScalingLut entries plus padding: the AVX2 kernels gather 32 bits at byte index 255.
+#define AV1_FG_SCALING_SIZE 260u
+
+// film_grain_params(), with the _plus_128 / _minus_N / offset biases removed.
+typedef struct {
+    uint8_t apply_grain;
+    uint8_t update_grain;              // 0: load_grain_params( film_grain_params_ref_idx ), then grain_seed
+    uint8_t film_grain_params_ref_idx;
+    uint16_t grain_seed;
+    uint8_t num_y_points;
+    uint8_t point_y_value[AV1_FG_MAX_Y_POINTS];
+    uint8_t point_y_scaling[AV1_FG_MAX_Y_POINTS];
+    uint8_t chroma_scaling_from_luma;
+    uint8_t num_cb_points;
+    uint8_t point_cb_value[AV1_FG_MAX_UV_POINTS];
+    uint8_t point_cb_scaling[AV1_FG_MAX_UV_POINTS];
+    uint8_t num_cr_points;
+    uint8_t point_cr_value[AV1_FG_MAX_UV_POINTS];
+    uint8_t point_cr_scaling[AV1_FG_MAX_UV_POINTS];
+    uint8_t grain_scaling; // grain_scaling_minus_8 + 8: ScalingShift
+    uint8_t ar_coeff_lag;
+    int8_t ar_coeffs_y[AV1_FG_MAX_AR_COEFFS - 1u];
+    int8_t ar_coeffs_cb[AV1_FG_MAX_AR_COEFFS];
+    int8_t ar_coeffs_cr[AV1_FG_MAX_AR_COEFFS];
+    uint8_t ar_coeff_shift; // ar_coeff_shift_minus_6 + 6
+    uint8_t grain_scale_shift;
+    int16_t cb_mult;      // cb_mult - 128
+    int16_t cb_luma_mult; // cb_luma_mult - 128
+    int16_t cb_offset;    // cb_offset - 256
+    int16_t cr_mult;
+    int16_t cr_luma_mult;
+    int16_t cr_offset;
+    uint8_t overlap_flag;
+    uint8_t clip_to_restricted_range;
+} Av1FilmGrainParams;
+
+// Blending constants of one plane.
+typedef struct {
+    const uint8_t *scaling; // ScalingLut[ plane ], AV1_FG_SCALING_SIZE entries
+    int32_t shift;          // ScalingShift
+    int32_t lo;             // minValue
+    int32_t hi;             // maxLuma / maxChroma
+    // Chroma only.
+    uint32_t sub_x;
+    uint32_t from_luma; // chroma_scaling_from_luma: the scaling index is the average luma
+    int32_t mult;       // cb_mult - 128 / cr_mult - 128
+    int32_t luma_mult;  // cb_luma_mult - 128 / cr_luma_mult - 128
+    int32_t offset;     // ( cb_offset - 256 ) << ( BitDepth - 8 )
+} Av1FgPlane;
+
+// Luma: dst = Clip3( lo, hi, src + Round2( scale_lut( src ) * noise, shift ) ) over a w x h block
+// (w, h <= AV1_FG_BLOCK); noise rows are noise_stride int16 apart.
+typedef void (*Av1FgBlendYFn)(uint8_t *dst,
+                              ptrdiff_t dst_stride,
+                              const uint8_t *src,
+                              ptrdiff_t src_stride,
+                              const int16_t *noise,
+                              ptrdiff_t noise_stride,
+                              uint32_t w,
+                              uint32_t h,
+                              const Av1FgPlane *pl);
+typedef void (*Av1FgBlendYFn16)(uint16_t *dst,
+                                ptrdiff_t dst_stride,
+                                const uint16_t *src,
+                                ptrdiff_t src_stride,
+                                const int16_t *noise,
+                                ptrdiff_t noise_stride,
+                                uint32_t w,
+                                uint32_t h,
+                                const Av1FgPlane *pl,
+                                uint32_t bit_depth);
+
+// Chroma: the scaling index is the average of luma[ x << sub_x ] and luma[ ( x << sub_x ) + 1 ]
+// (the first alone without sub_x), merged with src unless from_luma. Both luma samples are read
+// for every x < w; the caller replicates the last column of odd-width frames.
+typedef void (*Av1FgBlendUvFn)(uint8_t *dst,
+                               ptrdiff_t dst_stride,
+                               const uint8_t *src,
+                               ptrdiff_t src_stride,
+                               const uint8_t *luma,
+                               ptrdiff_t luma_stride,
+                               const int16_t *noise,
+                               ptrdiff_t noise_stride,
+                               uint32_t w,
+                               uint32_t h,
+                               const Av1FgPlane *pl);
+typedef void (*Av1FgBlendUvFn16)(uint16_t *dst,
+                                 ptrdiff_t dst_stride,
+                                 const uint16_t *src,
+                                 ptrdiff_t src_stride,
+                                 const uint16_t *luma,
+                                 ptrdiff_t luma_stride,
+                                 const int16_t *noise,
+                                 ptrdiff_t noise_stride,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 const Av1FgPlane *pl,
+                                 uint32_t bit_depth);
+
+typedef struct {
+    Av1FgBlendYFn blend_y;
+    Av1FgBlendUvFn blend_uv;
+} Av1FgDsp;
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1FgBlendYFn16 blend_y;
+    Av1FgBlendUvFn16 blend_uv;
+} Av1FgDsp16;
+
+// Scalar reference tables.
+void av1_fg_dsp_init_c(Av1FgDsp *dsp);
+void av1_fg_dsp_init_c_16(Av1FgDsp16 *dsp, uint32_t bit_depth);
+
+// Best tables for the running CPU.
+void av1_fg_dsp_init(Av1FgDsp *dsp);
+void av1_fg_dsp_init_16(Av1FgDsp16 *dsp, uint32_t bit_depth);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_FG_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_fg_dsp_init_avx2(Av1FgDsp *dsp);
+#endif
+
+// Gaussian_Sequence.
+extern const int16_t av1_fg_gaussian_sequence[2048];
+
+typedef struct {
+    const Av1FrameBuf *src; // filtered frame
+    Av1FrameBuf *dst;       // output frame, same size and format
+    uint32_t num_rows;      // rows of 32x32 luma blocks
+    uint32_t sub_x;
+    uint32_t sub_y;
+    uint16_t grain_seed;
+    uint8_t overlap;
+    uint8_t blend[3];                                      // plane gets grain (else it is copied)
+    int32_t grain_min;                                     // GrainMin
+    int32_t grain_max;                                     // GrainMax
+    int16_t grain[3][AV1_FG_GRAIN_H][AV1_FG_GRAIN_W];      // LumaGrain, CbGrain, CrGrain
+    uint8_t scaling[3][AV1_FG_SCALING_SIZE];               // ScalingLut
+    Av1FgPlane planes[3];
+    Av1FgDsp dsp;
+    Av1FgDsp16 dsp16;
+} Av1FilmGrain;
+
+// Generates the grain templates and scaling LUTs of params for src and binds the output frame.
+// mc_identity: matrix_coefficients is MC_IDENTITY (restricted-range chroma then clips like luma).
+// params must be complete (update_grain set, or already loaded from the reference frame).
+bool av1_film_grain_init(Av1FilmGrain *fg,
+                         Av1FrameBuf *dst,
+                         const Av1FrameBuf *src,
+                         const Av1FilmGrainParams *params,
+                         bool mc_identity,
+                         char *err,
+                         size_t err_cap);
+
+// Writes the 32 luma rows (and their chroma rows) of block row row to the output frame.
+void av1_film_grain_apply_row(const Av1FilmGrain *fg, uint32_t row);
+
+void av1_film_grain_apply_frame(const Av1FilmGrain *fg);
+
+// Row-parallel av1_film_grain_apply_frame(): block rows share no state, one pool job each.
+void av1_film_grain_apply_frame_mt(const Av1FilmGrain *fg, Av1ThreadPool *pool);
@@ -0,0 +1,143 @@
+#include "av1_film_grain.h"
+#include "av1_cpu.h"
+
+// AVX2 film grain blend kernels for 8-bit frames, bit-exact with the scalar kernels in
+// av1_film_grain_tmpl.inc.
+//
+// Sixteen samples per step: the scaling LUT entries are fetched with two 32-bit gathers (the LUT
+// is padded so the gather at index 255 stays inside it) and packed to 16 bits. With
+// ScalingShift 8 .. 11 and 8-bit noise the product scale * noise fits 16 bits, so
+// Round2( scale * noise, shift ) is one mulhrs of noise with scale << ( 15 - shift ). Chroma
+// averages horizontal luma pairs with maddubs and forms the merged index with one madd of
+// interleaved ( luma, chroma ) pairs. Functions carry a target attribute so the file builds with
+// the default CFLAGS; av1_fg_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_FG_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+static inline int32_t fg_clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// ScalingLut[ idx ] for sixteen int16 indices in 0 .. 255.
+static inline AVX2_ATTR __m256i fg_gather(const uint8_t *lut, __m256i idx) {
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256i i0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(idx));
+    const __m256i i1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(idx, 1));
+    const __m256i g0 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)lut, i0, 1), mask);
+    const __m256i g1 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)lut, i1, 1), mask);
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(g0, g1), 0xD8);
+}
+
+// Clip3( lo, hi, orig + Round2( scale * noise, shift ) ) stored as 16 bytes.
+static inline AVX2_ATTR void fg_store(uint8_t *dst, __m256i orig, __m256i scale, const int16_t *noise, __m128i shift, __m256i lo, __m256i hi) {
+    const __m256i n = _mm256_mulhrs_epi16(_mm256_sll_epi16(scale, shift), _mm256_loadu_si256((const __m256i *)noise));
+    const __m256i v = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(orig, n), lo), hi);
+    const __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(p));
+}
+
+static AVX2_ATTR void fg_blend_y_avx2(uint8_t *dst,
+                                      ptrdiff_t dst_stride,
+                                      const uint8_t *src,
+                                      ptrdiff_t src_stride,
+                                      const int16_t *noise,
+                                      ptrdiff_t noise_stride,
+                                      uint32_t w,
+                                      uint32_t h,
+                                      const Av1FgPlane *pl) {
+    const __m128i shift = _mm_cvtsi32_si128(15 - pl->shift);
+    const __m256i lo = _mm256_set1_epi16((int16_t)pl->lo);
+    const __m256i hi = _mm256_set1_epi16((int16_t)pl->hi);
+    const int32_t round = 1 << (pl->shift - 1);
+    for (uint32_t y = 0; y < h; y++) {
+        uint32_t x = 0;
+        for (; x + 16u <= w; x += 16u) {
+            const __m256i s = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + x)));
+            fg_store(dst + x, s, fg_gather(pl->scaling, s), noise + x, shift, lo, hi);
+        }
+        for (; x < w; x++) {
+            const int32_t n = (pl->scaling[src[x]] * noise[x] + round) >> pl->shift;
+            dst[x] = (uint8_t)fg_clip3(pl->lo, pl->hi, src[x] + n);
+        }
+        dst += dst_stride;
+        src += src_stride;
+        noise += noise_stride;
+    }
+}
+
+static AVX2_ATTR void fg_blend_uv_avx2(uint8_t *dst,
+                                       ptrdiff_t dst_stride,
+                                       const uint8_t *src,
+                                       ptrdiff_t src_stride,
+                                       const uint8_t *luma,
+                                       ptrdiff_t luma_stride,
+                                       const int16_t *noise,
+                                       ptrdiff_t noise_stride,
+                                       uint32_t w,
+                                       uint32_t h,
+                                       const Av1FgPlane *pl) {
+    const __m128i shift = _mm_cvtsi32_si128(15 - pl->shift);
+    const __m256i lo = _mm256_set1_epi16((int16_t)pl->lo);
+    const __m256i hi = _mm256_set1_epi16((int16_t)pl->hi);
+    const __m256i ones8 = _mm256_set1_epi8(1);
+    const __m256i one16 = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i mults = _mm256_set1_epi32((int32_t)(((uint32_t)pl->mult << 16) | ((uint32_t)pl->luma_mult & 0xffffu)));
+    const __m256i offset = _mm256_set1_epi32(pl->offset);
+    const int32_t round = 1 << (pl->shift - 1);
+    for (uint32_t y = 0; y < h; y++) {
+        uint32_t x = 0;
+        for (; x + 16u <= w; x += 16u) {
+            __m256i avg;
+            if (pl->sub_x) {
+                const __m256i l = _mm256_loadu_si256((const __m256i *)(luma + 2u * x));
+                avg = _mm256_srli_epi16(_mm256_add_epi16(_mm256_maddubs_epi16(l, ones8), one16), 1);
+            } else {
+                avg = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(luma + x)));
+            }
+            const __m256i s = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + x)));
+            __m256i merged = avg;
+            if (!pl->from_luma) {
+                const __m256i c0 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(avg, s), mults), 6);
+                const __m256i c1 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(avg, s), mults), 6);
+                merged = _mm256_packs_epi32(_mm256_add_epi32(c0, offset), _mm256_add_epi32(c1, offset));
+                merged = _mm256_min_epi16(_mm256_max_epi16(merged, zero), max);
+            }
+            fg_store(dst + x, s, fg_gather(pl->scaling, merged), noise + x, shift, lo, hi);
+        }
+        for (; x < w; x++) {
+            const int32_t avg = pl->sub_x ? (luma[2u * x] + luma[2u * x + 1u] + 1) >> 1 : luma[x];
+            int32_t merged = avg;
+            if (!pl->from_luma) {
+                merged = fg_clip3(0, 255, ((avg * pl->luma_mult + src[x] * pl->mult) >> 6) + pl->offset);
+            }
+            const int32_t n = (pl->scaling[merged] * noise[x] + round) >> pl->shift;
+            dst[x] = (uint8_t)fg_clip3(pl->lo, pl->hi, src[x] + n);
+        }
+        dst += dst_stride;
+        src += src_stride;
+        luma += luma_stride;
+        noise += noise_stride;
+    }
+}
+
+bool av1_fg_dsp_init_avx2(Av1FgDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->blend_y = fg_blend_y_avx2;
+    dsp->blend_uv = fg_blend_uv_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_film_grain.c uses the scalar reference.
+typedef int av1_film_grain_x86_unused;
+
+#endif
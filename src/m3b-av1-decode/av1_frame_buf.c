@@ -0,0 +1,217 @@
+#include "av1_frame_buf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t round_up_u32(uint32_t v, uint32_t a) {
+    return (v + a - 1u) / a * a;
+}
+
+static size_t round_up_size(size_t v, size_t a) {
+    return (v + a - 1u) / a * a;
+}
+
+void av1_frame_pool_init(Av1FramePool *pool, uint32_t border, uint32_t max_idle_per_class) {
+    memset(pool, 0, sizeof(*pool));
+    pool->border = border;
+    pool->max_idle_per_class = max_idle_per_class;
+}
+
+// Fills the shape fields and plane geometry of fb; returns the pixel bytes needed.
+static size_t frame_layout(Av1FrameBuf *fb, uint32_t border) {
+    const uint32_t sub_x = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    const uint32_t sub_y = fb->layout == AV1_LAYOUT_I420;
+    const uint32_t bps = fb->bytes_per_sample;
+    size_t total = 0;
+    fb->num_planes = fb->layout == AV1_LAYOUT_I400 ? 1u : 3u;
+    for (uint32_t p = 0; p < 3; p++) {
+        if (p >= fb->num_planes) {
+            fb->plane_w[p] = fb->plane_h[p] = fb->border_x[p] = fb->border_y[p] = 0;
+            fb->stride[p] = 0;
+            continue;
+        }
+        const uint32_t sx = p ? sub_x : 0u;
+        const uint32_t sy = p ? sub_y : 0u;
+        fb->plane_w[p] = (fb->width + sx) >> sx;
+        fb->plane_h[p] = (fb->height + sy) >> sy;
+        // Widen the left / right border to whole 64-byte lines so the first visible sample is aligned.
+        fb->border_x[p] = round_up_u32((border >> sx) * bps, AV1_FRAME_ALIGN) / bps;
+        fb->border_y[p] = border >> sy;
+        size_t row_bytes = round_up_size(((size_t)fb->plane_w[p] + 2u * fb->border_x[p]) * bps, AV1_FRAME_ALIGN);
+        if (row_bytes % 4096u == 0) {
+            row_bytes += AV1_FRAME_ALIGN;
+        }
+        fb->stride[p] = (ptrdiff_t)(row_bytes / bps);
+        total += row_bytes * ((size_t)fb->plane_h[p] + 2u * fb->border_y[p]);
+    }
+    return total;
+}
+
+static void frame_bind_planes(Av1FrameBuf *fb) {
+    uint8_t *base = (uint8_t *)fb->mem;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const size_t row_bytes = (size_t)fb->stride[p] * fb->bytes_per_sample;
+        fb->plane[p] = base + row_bytes * fb->border_y[p] + (size_t)fb->border_x[p] * fb->bytes_per_sample;
+        base += row_bytes * ((size_t)fb->plane_h[p] + 2u * fb->border_y[p]);
+    }
+    for (uint32_t p = fb->num_planes; p < 3; p++) {
+        fb->plane[p] = NULL;
+    }
+}
+
+static Av1FramePoolClass *pool_find_class(Av1FramePool *pool, uint32_t width, uint32_t height, uint32_t layout, uint32_t bit_depth) {
+    for (Av1FramePoolClass *c = pool->classes; c; c = c->next) {
+        if (c->width == width && c->height == height && c->layout == layout && c->bit_depth == bit_depth) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+bool av1_frame_pool_get(Av1FramePool *pool,
+                        uint32_t width,
+                        uint32_t height,
+                        uint32_t layout,
+                        uint32_t bit_depth,
+                        Av1FrameBuf **out,
+                        char *err,
+                        size_t err_cap) {
+    if (!pool || !out || width == 0 || height == 0 || width > AV1_FRAME_MAX_DIM || height > AV1_FRAME_MAX_DIM ||
+        layout >= AV1_LAYOUTS) {
+        snprintf(err, err_cap, "frame_buf: invalid args");
+        return false;
+    }
+    if (bit_depth != 8u && bit_depth != 10u && bit_depth != 12u) {
+        snprintf(err, err_cap, "frame_buf: unsupported BitDepth %u", bit_depth);
+        return false;
+    }
+    *out = NULL;
+
+    Av1FramePoolClass *cls = pool_find_class(pool, width, height, layout, bit_depth);
+    if (cls && cls->idle) {
+        Av1FrameBuf *fb = cls->idle;
+        cls->idle = fb->next;
+        cls->idle_count--;
+        pool->idle_bytes -= fb->mem_size;
+        fb->next = NULL;
+        pool->reuses++;
+        pool->in_use++;
+        *out = fb;
+        return true;
+    }
+    if (!cls) {
+        cls = (Av1FramePoolClass *)calloc(1, sizeof(*cls));
+        if (!cls) {
+            snprintf(err, err_cap, "frame_buf: out of memory");
+            return false;
+        }
+        cls->width = width;
+        cls->height = height;
+        cls->layout = layout;
+        cls->bit_depth = bit_depth;
+        cls->next = pool->classes;
+        pool->classes = cls;
+    }
+
+    Av1FrameBuf *fb = (Av1FrameBuf *)calloc(1, sizeof(*fb));
+    if (!fb) {
+        snprintf(err, err_cap, "frame_buf: out of memory");
+        return false;
+    }
+    fb->width = width;
+    fb->height = height;
+    fb->layout = layout;
+    fb->bit_depth = bit_depth;
+    fb->bytes_per_sample = bit_depth > 8u ? 2u : 1u;
+    fb->mem_size = round_up_size(frame_layout(fb, pool->border), AV1_FRAME_ALIGN);
+    fb->mem = aligned_alloc(AV1_FRAME_ALIGN, fb->mem_size);
+    if (!fb->mem) {
+        snprintf(err, err_cap, "frame_buf: out of memory (%zu bytes)", fb->mem_size);
+        free(fb);
+        return false;
+    }
+    frame_bind_planes(fb);
+    pool->allocs++;
+    pool->in_use++;
+    *out = fb;
+    return true;
+}
+
+static void frame_buf_destroy(Av1FrameBuf *fb) {
+    free(fb->mem);
+    free(fb);
+}
+
+void av1_frame_pool_put(Av1FramePool *pool, Av1FrameBuf *fb) {
+    if (!pool || !fb) {
+        return;
+    }
+    pool->in_use--;
+    Av1FramePoolClass *cls = pool_find_class(pool, fb->width, fb->height, fb->layout, fb->bit_depth);
+    if (!cls || (pool->max_idle_per_class != 0 && cls->idle_count >= pool->max_idle_per_class)) {
+        frame_buf_destroy(fb);
+        return;
+    }
+    fb->next = cls->idle;
+    cls->idle = fb;
+    cls->idle_count++;
+    pool->idle_bytes += fb->mem_size;
+}
+
+void av1_frame_pool_trim(Av1FramePool *pool) {
+    for (Av1FramePoolClass *c = pool->classes; c; c = c->next) {
+        while (c->idle) {
+            Av1FrameBuf *fb = c->idle;
+            c->idle = fb->next;
+            frame_buf_destroy(fb);
+        }
+        c->idle_count = 0;
+    }
+    pool->idle_bytes = 0;
+}
+
+void av1_frame_pool_free(Av1FramePool *pool) {
+    av1_frame_pool_trim(pool);
+    while (pool->classes) {
+        Av1FramePoolClass *c = pool->classes;
+        pool->classes = c->next;
+        free(c);
+    }
+}
+
+// Border extension, written once per sample type.
+#define EXTEND_PLANE(T)                                                                          \
+    do {                                                                                         \
+        T *org = (T *)fb->plane[plane];                                                          \
+        for (uint32_t y = 0; y < h; y++) {                                                       \
+            T *row = org + (ptrdiff_t)y * stride;                                                \
+            for (uint32_t x = 1; x <= bx; x++) {                                                 \
+                row[-(ptrdiff_t)x] = row[0];                                                     \
+                row[w - 1u + x] = row[w - 1u];                                                   \
+            }                                                                                    \
+        }                                                                                        \
+        const T *first = org - bx;                                                               \
+        const T *last = org + (ptrdiff_t)(h - 1u) * stride - bx;                                 \
+        const size_t row_bytes = ((size_t)w + 2u * bx) * sizeof(T);                              \
+        for (uint32_t y = 1; y <= by; y++) {                                                     \
+            memcpy(org - (ptrdiff_t)y * stride - bx, first, row_bytes);                          \
+            memcpy(org + (ptrdiff_t)(h - 1u + y) * stride - bx, last, row_bytes);                \
+        }                                                                                        \
+    } while (0)
+
+void av1_frame_extend_plane(Av1FrameBuf *fb, uint32_t plane) {
+    if (!fb || plane >= fb->num_planes) {
+        return;
+    }
+    const uint32_t w = fb->plane_w[plane];
+    const uint32_t h = fb->plane_h[plane];
+    const uint32_t bx = fb->border_x[plane];
+    const uint32_t by = fb->border_y[plane];
+    const ptrdiff_t stride = fb->stride[plane];
+    if (fb->bytes_per_sample == 1) {
+        EXTEND_PLANE(uint8_t);
+    } else {
+        EXTEND_PLANE(uint16_t);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Reconstruction frame buffers and a recycling pool.
+//
+// A frame holds up to three planes (Y, U, V). Every plane has a border of replicated / scratch
+// samples on all four sides so intra edges and the loop filters may read past the visible area
+// without bounds checks. Layout guarantees:
+// - The first visible sample of every plane is 64-byte aligned.
+// - Strides (in samples) are a multiple of 64 bytes and never a multiple of 4096 bytes, so
+//   vertically adjacent rows do not alias in the same cache sets.
+// - Samples are uint8_t for BitDepth 8 and uint16_t for BitDepth 10 / 12 (see av1_recon.h).
+//
+// Buffers returned to the pool are kept per size class, keyed on (width, height, layout,
+// BitDepth), and handed out again for the next frame of the same shape. Pixel memory is only
+// allocated while a class has no idle buffer.
+
+#define AV1_FRAME_ALIGN 64u
+#define AV1_FRAME_MAX_DIM 65536u
+
+// Chroma layouts.
+enum {
+    AV1_LAYOUT_I400 = 0, // monochrome: luma only
+    AV1_LAYOUT_I420,
+    AV1_LAYOUT_I422,
+    AV1_LAYOUT_I444,
+    AV1_LAYOUTS,
+};
+
+typedef struct Av1FrameBuf {
+    uint32_t width; // luma size in samples
+    uint32_t height;
+    uint32_t layout; // AV1_LAYOUT_*
+    uint32_t bit_depth;
+    uint32_t num_planes;
+    uint32_t bytes_per_sample; // 1 or 2
+    uint32_t plane_w[3];
+    uint32_t plane_h[3];
+    uint32_t border_x[3]; // samples available left and right of a plane
+    uint32_t border_y[3]; // rows available above and below a plane
+    ptrdiff_t stride[3];  // in samples
+    void *plane[3];       // first visible sample (uint8_t * or uint16_t *)
+
+    // Owned by the pool.
+    void *mem;
+    size_t mem_size;
+    struct Av1FrameBuf *next;
+} Av1FrameBuf;
+
+static inline uint8_t *av1_frame_plane_8(const Av1FrameBuf *fb, uint32_t plane) {
+    return (uint8_t *)fb->plane[plane];
+}
+
+static inline uint16_t *av1_frame_plane_16(const Av1FrameBuf *fb, uint32_t plane) {
+    return (uint16_t *)fb->plane[plane];
+}
+
+typedef struct Av1FramePoolClass {
+    uint32_t width;
+    uint32_t height;
+    uint32_t layout;
+    uint32_t bit_depth;
+    Av1FrameBuf *idle;
+    uint32_t idle_count;
+    struct Av1FramePoolClass *next;
+} Av1FramePoolClass;
+
+typedef struct {
+    uint32_t border; // luma border in samples (chroma borders are subsampled)
+    uint32_t max_idle_per_class; // 0: keep every returned buffer
+    Av1FramePoolClass *classes;
+
+    // Statistics.
+    uint64_t allocs;   // pixel allocations
+    uint64_t reuses;   // requests served from an idle buffer
+    uint32_t in_use;   // buffers handed out and not yet returned
+    size_t idle_bytes; // pixel memory held by idle buffers
+} Av1FramePool;
+
+// border is the minimum luma border; planes may get more so their first sample is aligned.
+void av1_frame_pool_init(Av1FramePool *pool, uint32_t border, uint32_t max_idle_per_class);
+
+// Hands out a frame with the given shape. Contents (visible area and border) are undefined.
+bool av1_frame_pool_get(Av1FramePool *pool,
+                        uint32_t width,
+                        uint32_t height,
+                        uint32_t layout,
+                        uint32_t bit_depth,
+                        Av1FrameBuf **out,
+                        char *err,
+                        size_t err_cap);
+
+// Returns a frame obtained from av1_frame_pool_get() to its size class.
+void av1_frame_pool_put(Av1FramePool *pool, Av1FrameBuf *fb);
+
+// Frees every idle buffer (the pool stays usable).
+void av1_frame_pool_trim(Av1FramePool *pool);
+
+// Frees every idle buffer and the class list. Frames still in use must be returned first.
+void av1_frame_pool_free(Av1FramePool *pool);
+
+// Replicates the outermost visible samples of a plane into its border.
+void av1_frame_extend_plane(Av1FrameBuf *fb, uint32_t plane);
@@ -7,7 +7,15 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include "av1_cdef.h"
+#include "av1_cpu.h"
+#include "av1_restoration.h"
+#include "av1_superres.h"
 #include "av1_decode_tile.h"
+#include "av1_film_grain.h"
+#include "av1_loopfilter.h"
+#include "av1_roi.h"
+#include "av1_segmap.h"
 #include "av1_symbol.h"
 
 // m3b (step 1): parse AV1 Sequence Header + enough of the uncompressed frame header
@@ -17,7 +25,7 @@
 
 static void usage(FILE *out) {
     fprintf(out,
-            "Usage: av1_framehdr [--dump-tiles DIR] [--check-tile-trailing] [--check-tile-trailing-strict] [--tile-consume-bools N] [--check-tile-trailingbits] [--check-tile-trailingbits-strict] [--decode-tile-syntax] [--decode-tile-syntax-strict] [--decode-tile-syntax-try-eot] <in.av1>\n"
+            "Usage: av1_framehdr [--dump-tiles DIR] [--check-tile-trailing] [--check-tile-trailing-strict] [--tile-consume-bools N] [--check-tile-trailingbits] [--check-tile-trailingbits-strict] [--decode-tile-syntax] [--decode-tile-syntax-strict] [--decode-tile-syntax-try-eot] [--crop x,y,w,h] [--cpu-mask MASK] <in.av1>\n"
             "\n"
             "Parses a size-delimited AV1 OBU stream and prints basic frame header info.\n"
             "Current scope: still_picture=1 (reduced-still or non-reduced keyframe).\n"
@@ -33,7 +41,10 @@ static void usage(FILE *out) {
             "  --check-tile-trailingbits-strict   Same as above, but fails on first violation\n"
             "  --decode-tile-syntax    Call the m3b tile syntax probe (currently expected to report UNSUPPORTED)\n"
             "  --decode-tile-syntax-strict   Same as above, but fails on first UNSUPPORTED/ERROR\n"
-            "  --decode-tile-syntax-try-eot  Attempt to traverse more of the tile and run exit_symbol() at the end (experimental)\n");
+            "  --decode-tile-syntax-try-eot  Attempt to traverse more of the tile and run exit_symbol() at the end (experimental)\n"
+            "  --crop x,y,w,h          Only decode tiles intersecting this luma rectangle (plus filter-context margin)\n"
+            "  --cpu-mask MASK         Limit SIMD kernels: c, sse2, ssse3, sse4.1, avx2, avx512 or a bit mask\n"
+            "                          (default: AV1_CPU_MASK from the environment, else everything the CPU has)\n");
 
 }
 static const char *tx_size_name(uint32_t tx_size) {
@@ -349,11 +360,13 @@ typedef struct {
     uint32_t enable_restoration;
 
     // color_config() essentials
+    uint32_t bit_depth; // BitDepth: selects the 8-bit or 16-bit pixel kernels (av1_recon_dsp_init)
     uint32_t mono_chrome;
     uint32_t num_planes;
     uint32_t subsampling_x;
     uint32_t subsampling_y;
     uint32_t separate_uv_delta_q;
+    uint32_t matrix_coefficients; // film grain clips restricted-range chroma like luma for MC_IDENTITY
 
     // Sequence header tail
     uint32_t film_grain_params_present;
@@ -415,6 +428,7 @@ static bool parse_color_config_min(BitReader *br,
         snprintf(err, err_cap, "unsupported seq_profile");
         return false;
     }
+    out->bit_depth = BitDepth;
 
     uint32_t mono_chrome = 0;
     if (seq_profile == 1) {
@@ -444,6 +458,7 @@ static bool parse_color_config_min(BitReader *br,
             return false;
         }
     }
+    out->matrix_coefficients = matrix_coefficients;
 
     if (mono_chrome) {
         uint32_t color_range;
@@ -833,6 +848,7 @@ typedef struct {
     uint32_t coded_width;
     uint32_t coded_height;
     uint32_t upscaled_width;
+    uint32_t superres_denom; // SuperresDenom; SUPERRES_NUM (8) without superres
 
     uint32_t mi_cols;
     uint32_t mi_rows;
@@ -854,6 +870,12 @@ typedef struct {
     int32_t DeltaQVDc;
     int32_t DeltaQVAc;
 
+    // Quantizer matrix levels (qm_y / qm_u / qm_v; 15 = flat when using_qmatrix is 0).
+    uint32_t using_qmatrix;
+    uint32_t qm_y;
+    uint32_t qm_u;
+    uint32_t qm_v;
+
     // read_tx_mode() derived state:
     // 0 = ONLY_4X4, 1 = TX_MODE_LARGEST, 2 = TX_MODE_SELECT.
     uint32_t tx_mode;
@@ -868,8 +890,18 @@ typedef struct {
     uint32_t delta_lf_res;
     uint32_t delta_lf_multi;
 
+    // From loop_filter_params() (plus delta_lf_multi and the SEG_LVL_ALT_LF_* features).
+    Av1LoopFilterParams lf;
+
     // From cdef_params() in the uncompressed header.
     uint32_t cdef_bits;
+    Av1CdefParams cdef;
+
+    // From lr_params() in the uncompressed header.
+    Av1LrParams lr;
+
+    // From film_grain_params() in the uncompressed header (all zero without apply_grain).
+    Av1FilmGrainParams film_grain;
 
     // From segmentation_params() in the uncompressed header.
     uint32_t segmentation_enabled;
@@ -885,6 +917,7 @@ enum {
     MAX_SEGMENTS = 8,
     SEG_LVL_MAX = 8,
     SEG_LVL_ALT_Q = 0,
+    SEG_LVL_ALT_LF_Y_V = 1,
     SEG_LVL_REF_FRAME = 5,
 };
 
@@ -896,6 +929,11 @@ typedef struct {
     int32_t DeltaQVDc;
     int32_t DeltaQVAc;
 
+    uint32_t using_qmatrix;
+    uint32_t qm_y;
+    uint32_t qm_u;
+    uint32_t qm_v;
+
     uint32_t delta_q_present;
 
     uint32_t delta_q_res;
@@ -906,6 +944,10 @@ typedef struct {
     int32_t feature_data_alt_q[MAX_SEGMENTS];
     uint8_t feature_enabled_alt_q[MAX_SEGMENTS];
 
+    // SEG_LVL_ALT_LF_Y_V .. SEG_LVL_ALT_LF_V.
+    int8_t feature_data_alt_lf[MAX_SEGMENTS][4];
+    uint8_t feature_enabled_alt_lf[MAX_SEGMENTS][4];
+
     // Derived during segmentation_update_data parsing.
     uint32_t seg_id_pre_skip;
     uint32_t last_active_seg_id;
@@ -992,17 +1034,20 @@ static bool parse_quantization_params_skip(BitReader *br,
         snprintf(err, err_cap, "truncated using_qmatrix");
         return false;
     }
+    qs->using_qmatrix = using_qmatrix;
+    qs->qm_y = 15;
+    qs->qm_u = 15;
+    qs->qm_v = 15;
     if (using_qmatrix) {
-        uint32_t tmp;
-        if (!br_read_bits(br, 4, &tmp) || !br_read_bits(br, 4, &tmp)) {
+        if (!br_read_bits(br, 4, &qs->qm_y) || !br_read_bits(br, 4, &qs->qm_u)) {
             snprintf(err, err_cap, "truncated qmatrix");
             return false;
         }
-        if (seq->separate_uv_delta_q) {
-            if (!br_read_bits(br, 4, &tmp)) {
-                snprintf(err, err_cap, "truncated qm_v");
-                return false;
-            }
+        if (!seq->separate_uv_delta_q) {
+            qs->qm_v = qs->qm_u;
+        } else if (!br_read_bits(br, 4, &qs->qm_v)) {
+            snprintf(err, err_cap, "truncated qm_v");
+            return false;
         }
     }
 
@@ -1086,6 +1131,9 @@ static bool parse_segmentation_params_skip(BitReader *br,
                 if (j == SEG_LVL_ALT_Q) {
                     ss->feature_enabled_alt_q[i] = 1;
                     ss->feature_data_alt_q[i] = clippedValue;
+                } else if (j < (uint32_t)SEG_LVL_REF_FRAME) {
+                    ss->feature_enabled_alt_lf[i][j - SEG_LVL_ALT_LF_Y_V] = 1;
+                    ss->feature_data_alt_lf[i][j - SEG_LVL_ALT_LF_Y_V] = (int8_t)clippedValue;
                 }
             }
             (void)any_feature_enabled;
@@ -1185,12 +1233,16 @@ static uint32_t compute_coded_lossless(const QuantizationState *qs, const Segmen
     return 1;
 }
 
+// Fills lf with loop_filter_params(); deltas start from the setup_past_independence() defaults
+// (primary_ref_frame is PRIMARY_REF_NONE for our still-picture subset).
 static bool parse_loop_filter_params_skip(BitReader *br,
                                           uint32_t CodedLossless,
                                           uint32_t allow_intrabc,
                                           uint32_t NumPlanes,
+                                          Av1LoopFilterParams *lf,
                                           char *err,
                                           size_t err_cap) {
+    av1_lf_params_default(lf);
     if (CodedLossless || allow_intrabc) {
         return true;
     }
@@ -1201,19 +1253,28 @@ static bool parse_loop_filter_params_skip(BitReader *br,
         snprintf(err, err_cap, "truncated loop_filter_level[0/1]");
         return false;
     }
+    lf->level[0] = (uint8_t)level0;
+    lf->level[1] = (uint8_t)level1;
     if (NumPlanes > 1) {
         if (level0 || level1) {
-            if (!br_read_bits(br, 6, &tmp) || !br_read_bits(br, 6, &tmp)) {
+            uint32_t level2;
+            uint32_t level3;
+            if (!br_read_bits(br, 6, &level2) || !br_read_bits(br, 6, &level3)) {
                 snprintf(err, err_cap, "truncated loop_filter_level[2/3]");
                 return false;
             }
+            lf->level[2] = (uint8_t)level2;
+            lf->level[3] = (uint8_t)level3;
         }
     }
-    if (!br_read_bits(br, 3, &tmp) || !br_read_bit(br, &tmp)) {
+    uint32_t sharpness;
+    if (!br_read_bits(br, 3, &sharpness) || !br_read_bit(br, &tmp)) {
         snprintf(err, err_cap, "truncated loop_filter_sharpness/delta_enabled");
         return false;
     }
+    lf->sharpness = (uint8_t)sharpness;
     uint32_t loop_filter_delta_enabled = tmp;
+    lf->delta_enabled = (uint8_t)loop_filter_delta_enabled;
     if (loop_filter_delta_enabled) {
         uint32_t loop_filter_delta_update;
         if (!br_read_bit(br, &loop_filter_delta_update)) {
@@ -1234,6 +1295,7 @@ static bool parse_loop_filter_params_skip(BitReader *br,
                         snprintf(err, err_cap, "truncated loop_filter_ref_deltas");
                         return false;
                     }
+                    lf->ref_deltas[i] = (int8_t)v;
                 }
             }
             for (uint32_t i = 0; i < 2; i++) {
@@ -1248,6 +1310,7 @@ static bool parse_loop_filter_params_skip(BitReader *br,
                         snprintf(err, err_cap, "truncated loop_filter_mode_deltas");
                         return false;
                     }
+                    lf->mode_deltas[i] = (int8_t)v;
                 }
             }
         }
@@ -1260,35 +1323,40 @@ static bool parse_cdef_params_skip(BitReader *br,
                                    uint32_t allow_intrabc,
                                    uint32_t enable_cdef,
                                    uint32_t NumPlanes,
-                                   uint32_t *out_cdef_bits,
+                                   Av1CdefParams *out,
                                    char *err,
                                    size_t err_cap) {
+    av1_cdef_params_default(out);
     if (CodedLossless || allow_intrabc || !enable_cdef) {
-        if (out_cdef_bits) {
-            *out_cdef_bits = 0;
-        }
         return true;
     }
     uint32_t tmp;
-    if (!br_read_bits(br, 2, &tmp) || !br_read_bits(br, 2, &tmp)) {
+    if (!br_read_bits(br, 2, &tmp)) {
         snprintf(err, err_cap, "truncated cdef_damping_minus_3/cdef_bits");
         return false;
     }
-    uint32_t cdef_bits = tmp;
-    if (out_cdef_bits) {
-        *out_cdef_bits = cdef_bits;
+    out->damping = (uint8_t)(tmp + 3u);
+    if (!br_read_bits(br, 2, &tmp)) {
+        snprintf(err, err_cap, "truncated cdef_damping_minus_3/cdef_bits");
+        return false;
     }
-    uint32_t n = 1u << cdef_bits;
+    out->bits = (uint8_t)tmp;
+    uint32_t n = 1u << out->bits;
     for (uint32_t i = 0; i < n; i++) {
-        if (!br_read_bits(br, 4, &tmp) || !br_read_bits(br, 2, &tmp)) {
+        uint32_t pri, sec;
+        if (!br_read_bits(br, 4, &pri) || !br_read_bits(br, 2, &sec)) {
             snprintf(err, err_cap, "truncated cdef y strengths");
             return false;
         }
+        out->y_pri[i] = (uint8_t)pri;
+        out->y_sec[i] = (uint8_t)(sec == 3u ? 4u : sec);
         if (NumPlanes > 1) {
-            if (!br_read_bits(br, 4, &tmp) || !br_read_bits(br, 2, &tmp)) {
+            if (!br_read_bits(br, 4, &pri) || !br_read_bits(br, 2, &sec)) {
                 snprintf(err, err_cap, "truncated cdef uv strengths");
                 return false;
             }
+            out->uv_pri[i] = (uint8_t)pri;
+            out->uv_sec[i] = (uint8_t)(sec == 3u ? 4u : sec);
         }
     }
     return true;
@@ -1302,8 +1370,12 @@ static bool parse_lr_params_skip(BitReader *br,
                                  uint32_t use_128x128_superblock,
                                  uint32_t subsampling_x,
                                  uint32_t subsampling_y,
+                                 Av1LrParams *out,
                                  char *err,
                                  size_t err_cap) {
+    // Remap_Lr_Type.
+    static const uint8_t kRemapLrType[4] = {AV1_RESTORE_NONE, AV1_RESTORE_SWITCHABLE, AV1_RESTORE_WIENER, AV1_RESTORE_SGRPROJ};
+    av1_lr_params_default(out);
     if (AllLossless || allow_intrabc || !enable_restoration) {
         return true;
     }
@@ -1315,6 +1387,7 @@ static bool parse_lr_params_skip(BitReader *br,
             snprintf(err, err_cap, "truncated lr_type");
             return false;
         }
+        out->frame_type[i] = kRemapLrType[lr_type];
         if (lr_type != 0) {
             UsesLr = 1;
             if (i > 0) {
@@ -1330,6 +1403,7 @@ static bool parse_lr_params_skip(BitReader *br,
         }
         if (use_128x128_superblock) {
             // lr_unit_shift++ in spec; no extra bits.
+            lr_unit_shift++;
         } else {
             if (lr_unit_shift) {
                 uint32_t lr_unit_extra_shift;
@@ -1337,15 +1411,20 @@ static bool parse_lr_params_skip(BitReader *br,
                     snprintf(err, err_cap, "truncated lr_unit_extra_shift");
                     return false;
                 }
+                lr_unit_shift += lr_unit_extra_shift;
             }
         }
+        // RESTORATION_TILESIZE_MAX >> (2 - lr_unit_shift).
+        out->unit_size[0] = (uint16_t)(256u >> (2u - lr_unit_shift));
+        uint32_t lr_uv_shift = 0;
         if (subsampling_x && subsampling_y && usesChromaLr) {
-            uint32_t lr_uv_shift;
             if (!br_read_bit(br, &lr_uv_shift)) {
                 snprintf(err, err_cap, "truncated lr_uv_shift");
                 return false;
             }
         }
+        out->unit_size[1] = (uint16_t)(out->unit_size[0] >> lr_uv_shift);
+        out->unit_size[2] = (uint16_t)(out->unit_size[0] >> lr_uv_shift);
     }
     return true;
 }
@@ -1370,12 +1449,52 @@ static bool parse_read_tx_mode(BitReader *br, uint32_t CodedLossless, uint32_t *
     return true;
 }
 
-static bool parse_film_grain_params_skip(BitReader *br,
-                                         const SeqHdr *seq,
-                                         uint32_t frame_type,
-                                         uint32_t show_frame,
-                                         char *err,
-                                         size_t err_cap) {
+// Reads num_points ( value, scaling ) pairs; values must increase.
+static bool parse_film_grain_points(BitReader *br,
+                                    uint32_t num_points,
+                                    uint8_t *value,
+                                    uint8_t *scaling,
+                                    const char *name,
+                                    char *err,
+                                    size_t err_cap) {
+    for (uint32_t i = 0; i < num_points; i++) {
+        uint32_t v, sc;
+        if (!br_read_bits(br, 8, &v) || !br_read_bits(br, 8, &sc)) {
+            snprintf(err, err_cap, "truncated point_%s", name);
+            return false;
+        }
+        if (i > 0 && v <= value[i - 1u]) {
+            snprintf(err, err_cap, "point_%s_value not increasing", name);
+            return false;
+        }
+        value[i] = (uint8_t)v;
+        scaling[i] = (uint8_t)sc;
+    }
+    return true;
+}
+
+static bool parse_film_grain_ar_coeffs(BitReader *br, uint32_t num_pos, int8_t *coeffs, const char *name, char *err, size_t err_cap) {
+    for (uint32_t i = 0; i < num_pos; i++) {
+        uint32_t v;
+        if (!br_read_bits(br, 8, &v)) {
+            snprintf(err, err_cap, "truncated ar_coeffs_%s_plus_128", name);
+            return false;
+        }
+        coeffs[i] = (int8_t)((int32_t)v - 128);
+    }
+    return true;
+}
+
+// film_grain_params(). With update_grain 0 the parameters belong to reference frame
+// film_grain_params_ref_idx (load_grain_params()); only grain_seed and the index are kept here.
+static bool parse_film_grain_params(BitReader *br,
+                                    const SeqHdr *seq,
+                                    uint32_t frame_type,
+                                    uint32_t show_frame,
+                                    Av1FilmGrainParams *out,
+                                    char *err,
+                                    size_t err_cap) {
+    memset(out, 0, sizeof(*out));
     if (!seq->film_grain_params_present || (!show_frame /* && !showable_frame */)) {
         return true;
     }
@@ -1387,13 +1506,14 @@ static bool parse_film_grain_params_skip(BitReader *br,
     if (!apply_grain) {
         return true;
     }
+    out->apply_grain = 1;
 
-    // film_grain_params() (AV1 spec): we only need to skip it safely.
     uint32_t tmp;
     if (!br_read_bits(br, 16, &tmp)) {
         snprintf(err, err_cap, "truncated grain_seed");
         return false;
     }
+    out->grain_seed = (uint16_t)tmp;
 
     uint32_t update_grain = 1;
     if (frame_type == 2 /* INTER_FRAME */) {
@@ -1402,12 +1522,14 @@ static bool parse_film_grain_params_skip(BitReader *br,
             return false;
         }
     }
+    out->update_grain = (uint8_t)update_grain;
 
     if (!update_grain) {
         if (!br_read_bits(br, 3, &tmp)) {
             snprintf(err, err_cap, "truncated film_grain_params_ref_idx");
             return false;
         }
+        out->film_grain_params_ref_idx = (uint8_t)tmp;
         return true;
     }
 
@@ -1416,15 +1538,13 @@ static bool parse_film_grain_params_skip(BitReader *br,
         snprintf(err, err_cap, "truncated num_y_points");
         return false;
     }
-    for (uint32_t i = 0; i < num_y_points; i++) {
-        if (!br_read_bits(br, 8, &tmp)) {
-            snprintf(err, err_cap, "truncated point_y_value");
-            return false;
-        }
-        if (!br_read_bits(br, 8, &tmp)) {
-            snprintf(err, err_cap, "truncated point_y_scaling");
-            return false;
-        }
+    if (num_y_points > AV1_FG_MAX_Y_POINTS) {
+        snprintf(err, err_cap, "num_y_points=%u out of range", num_y_points);
+        return false;
+    }
+    out->num_y_points = (uint8_t)num_y_points;
+    if (!parse_film_grain_points(br, num_y_points, out->point_y_value, out->point_y_scaling, "y", err, err_cap)) {
+        return false;
     }
 
     uint32_t chroma_scaling_from_luma = 0;
@@ -1436,6 +1556,7 @@ static bool parse_film_grain_params_skip(BitReader *br,
             return false;
         }
     }
+    out->chroma_scaling_from_luma = (uint8_t)chroma_scaling_from_luma;
 
     uint32_t num_cb_points = 0;
     uint32_t num_cr_points = 0;
@@ -1448,129 +1569,121 @@ static bool parse_film_grain_params_skip(BitReader *br,
             snprintf(err, err_cap, "truncated num_cb_points");
             return false;
         }
-        for (uint32_t i = 0; i < num_cb_points; i++) {
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated point_cb_value");
-                return false;
-            }
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated point_cb_scaling");
-                return false;
-            }
+        if (num_cb_points > AV1_FG_MAX_UV_POINTS) {
+            snprintf(err, err_cap, "num_cb_points=%u out of range", num_cb_points);
+            return false;
+        }
+        if (!parse_film_grain_points(br, num_cb_points, out->point_cb_value, out->point_cb_scaling, "cb", err, err_cap)) {
+            return false;
         }
         if (!br_read_bits(br, 4, &num_cr_points)) {
             snprintf(err, err_cap, "truncated num_cr_points");
             return false;
         }
-        for (uint32_t i = 0; i < num_cr_points; i++) {
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated point_cr_value");
-                return false;
-            }
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated point_cr_scaling");
-                return false;
-            }
+        if (num_cr_points > AV1_FG_MAX_UV_POINTS) {
+            snprintf(err, err_cap, "num_cr_points=%u out of range", num_cr_points);
+            return false;
+        }
+        if (!parse_film_grain_points(br, num_cr_points, out->point_cr_value, out->point_cr_scaling, "cr", err, err_cap)) {
+            return false;
         }
     }
+    out->num_cb_points = (uint8_t)num_cb_points;
+    out->num_cr_points = (uint8_t)num_cr_points;
 
-    // grain_scaling_minus_8
     if (!br_read_bits(br, 2, &tmp)) {
         snprintf(err, err_cap, "truncated grain_scaling_minus_8");
         return false;
     }
+    out->grain_scaling = (uint8_t)(tmp + 8u);
 
-    // ar_coeff_lag
     uint32_t ar_coeff_lag;
     if (!br_read_bits(br, 2, &ar_coeff_lag)) {
         snprintf(err, err_cap, "truncated ar_coeff_lag");
         return false;
     }
+    out->ar_coeff_lag = (uint8_t)ar_coeff_lag;
     uint32_t num_pos_luma = 2u * ar_coeff_lag * (ar_coeff_lag + 1u);
     uint32_t num_pos_chroma;
     if (num_y_points) {
         num_pos_chroma = num_pos_luma + 1u;
-        for (uint32_t i = 0; i < num_pos_luma; i++) {
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated ar_coeffs_y_plus_128");
-                return false;
-            }
+        if (!parse_film_grain_ar_coeffs(br, num_pos_luma, out->ar_coeffs_y, "y", err, err_cap)) {
+            return false;
         }
     } else {
         num_pos_chroma = num_pos_luma;
     }
 
     if (chroma_scaling_from_luma || num_cb_points) {
-        for (uint32_t i = 0; i < num_pos_chroma; i++) {
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated ar_coeffs_cb_plus_128");
-                return false;
-            }
+        if (!parse_film_grain_ar_coeffs(br, num_pos_chroma, out->ar_coeffs_cb, "cb", err, err_cap)) {
+            return false;
         }
     }
     if (chroma_scaling_from_luma || num_cr_points) {
-        for (uint32_t i = 0; i < num_pos_chroma; i++) {
-            if (!br_read_bits(br, 8, &tmp)) {
-                snprintf(err, err_cap, "truncated ar_coeffs_cr_plus_128");
-                return false;
-            }
+        if (!parse_film_grain_ar_coeffs(br, num_pos_chroma, out->ar_coeffs_cr, "cr", err, err_cap)) {
+            return false;
         }
     }
 
-    // ar_coeff_shift_minus_6
     if (!br_read_bits(br, 2, &tmp)) {
         snprintf(err, err_cap, "truncated ar_coeff_shift_minus_6");
         return false;
     }
+    out->ar_coeff_shift = (uint8_t)(tmp + 6u);
 
-    // grain_scale_shift
     if (!br_read_bits(br, 2, &tmp)) {
         snprintf(err, err_cap, "truncated grain_scale_shift");
         return false;
     }
+    out->grain_scale_shift = (uint8_t)tmp;
 
-    // overlap_flag, clip_to_restricted_range
-    if (!br_read_bit(br, &tmp)) {
-        snprintf(err, err_cap, "truncated overlap_flag");
-        return false;
-    }
-    if (!br_read_bit(br, &tmp)) {
-        snprintf(err, err_cap, "truncated clip_to_restricted_range");
-        return false;
-    }
-
+    uint32_t cb_mult = 128, cb_luma_mult = 128, cb_offset = 256;
+    uint32_t cr_mult = 128, cr_luma_mult = 128, cr_offset = 256;
     if (num_cb_points) {
-        if (!br_read_bits(br, 8, &tmp)) {
+        if (!br_read_bits(br, 8, &cb_mult)) {
             snprintf(err, err_cap, "truncated cb_mult");
             return false;
         }
-        if (!br_read_bits(br, 8, &tmp)) {
+        if (!br_read_bits(br, 8, &cb_luma_mult)) {
             snprintf(err, err_cap, "truncated cb_luma_mult");
             return false;
         }
-        if (!br_read_bits(br, 9, &tmp)) {
+        if (!br_read_bits(br, 9, &cb_offset)) {
             snprintf(err, err_cap, "truncated cb_offset");
             return false;
         }
     }
     if (num_cr_points) {
-        if (!br_read_bits(br, 8, &tmp)) {
+        if (!br_read_bits(br, 8, &cr_mult)) {
             snprintf(err, err_cap, "truncated cr_mult");
             return false;
         }
-        if (!br_read_bits(br, 8, &tmp)) {
+        if (!br_read_bits(br, 8, &cr_luma_mult)) {
             snprintf(err, err_cap, "truncated cr_luma_mult");
             return false;
         }
-        if (!br_read_bits(br, 9, &tmp)) {
+        if (!br_read_bits(br, 9, &cr_offset)) {
             snprintf(err, err_cap, "truncated cr_offset");
             return false;
         }
     }
+    out->cb_mult = (int16_t)((int32_t)cb_mult - 128);
+    out->cb_luma_mult = (int16_t)((int32_t)cb_luma_mult - 128);
+    out->cb_offset = (int16_t)((int32_t)cb_offset - 256);
+    out->cr_mult = (int16_t)((int32_t)cr_mult - 128);
+    out->cr_luma_mult = (int16_t)((int32_t)cr_luma_mult - 128);
+    out->cr_offset = (int16_t)((int32_t)cr_offset - 256);
 
-    (void)chroma_scaling_from_luma;
-    (void)num_cb_points;
-    (void)num_cr_points;
+    if (!br_read_bit(br, &tmp)) {
+        snprintf(err, err_cap, "truncated overlap_flag");
+        return false;
+    }
+    out->overlap_flag = (uint8_t)tmp;
+    if (!br_read_bit(br, &tmp)) {
+        snprintf(err, err_cap, "truncated clip_to_restricted_range");
+        return false;
+    }
+    out->clip_to_restricted_range = (uint8_t)tmp;
     return true;
 }
 
@@ -1615,21 +1728,25 @@ static bool skip_uncompressed_header_after_tile_info(BitReader *br,
     fh->delta_lf_res = delta_lf_res;
     fh->delta_lf_multi = delta_lf_multi;
 
-    if (!parse_loop_filter_params_skip(br, CodedLossless, fh->allow_intrabc, seq->num_planes, err, err_cap)) {
+    if (!parse_loop_filter_params_skip(br, CodedLossless, fh->allow_intrabc, seq->num_planes, &fh->lf, err, err_cap)) {
         return false;
     }
-    uint32_t cdef_bits = 0;
+    fh->lf.delta_lf_multi = (uint8_t)delta_lf_multi;
+    if (ss.segmentation_enabled) {
+        memcpy(fh->lf.seg_enabled, ss.feature_enabled_alt_lf, sizeof(fh->lf.seg_enabled));
+        memcpy(fh->lf.seg_data, ss.feature_data_alt_lf, sizeof(fh->lf.seg_data));
+    }
     if (!parse_cdef_params_skip(br,
                                 CodedLossless,
                                 fh->allow_intrabc,
                                 seq->enable_cdef,
                                 seq->num_planes,
-                                &cdef_bits,
+                                &fh->cdef,
                                 err,
                                 err_cap)) {
         return false;
     }
-    fh->cdef_bits = cdef_bits;
+    fh->cdef_bits = fh->cdef.bits;
     if (!parse_lr_params_skip(br,
                               AllLossless,
                               fh->allow_intrabc,
@@ -1638,6 +1755,7 @@ static bool skip_uncompressed_header_after_tile_info(BitReader *br,
                               seq->use_128x128_superblock,
                               seq->subsampling_x,
                               seq->subsampling_y,
+                              &fh->lr,
                               err,
                               err_cap)) {
         return false;
@@ -1661,7 +1779,7 @@ static bool skip_uncompressed_header_after_tile_info(BitReader *br,
 
     // global_motion_params(): FrameIsIntra => no bits.
 
-    if (!parse_film_grain_params_skip(br, seq, fh->frame_type, fh->show_frame, err, err_cap)) {
+    if (!parse_film_grain_params(br, seq, fh->frame_type, fh->show_frame, &fh->film_grain, err, err_cap)) {
         return false;
     }
 
@@ -1963,6 +2081,8 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                                            bool decode_tile_syntax,
                                            bool decode_tile_syntax_strict,
                                            bool decode_tile_syntax_try_eot,
+                                           const Av1RoiTileSet *roi,
+                                           Av1SegMap *segmap,
                                            char *err,
                                            size_t err_cap) {
     uint32_t NumTiles = ti->tile_cols * ti->tile_rows;
@@ -2028,6 +2148,8 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
         uint32_t tileRow = TileNum / ti->tile_cols;
         uint32_t tileCol = TileNum % ti->tile_cols;
         bool lastTile = TileNum == tg_end;
+        // With --crop, tiles outside the (margin-expanded) region are located but not decoded.
+        bool in_roi = !roi || av1_roi_tile_selected(roi, tileRow, tileCol);
 
         uint64_t tile_data_off_abs = abs_payload_off + (uint64_t)cur;
         uint64_t tileSize = 0;
@@ -2055,7 +2177,7 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 dump->tiles_written++;
             }
 
-            if (check_trailing) {
+            if (in_roi && check_trailing) {
                 Av1SymbolDecoder sd;
                 if (!av1_symbol_init(&sd, payload + cur, (size_t)tileSize, true, err, err_cap)) {
                     return false;
@@ -2092,7 +2214,7 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 }
             }
 
-            if (check_trailingbits) {
+            if (in_roi && check_trailingbits) {
                 if (!av1_symbol_check_trailing_bits(payload + cur, (size_t)tileSize, err, err_cap)) {
                     if (check_trailingbits_strict) {
                         return false;
@@ -2106,14 +2228,17 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 }
             }
 
-            if (decode_tile_syntax) {
+            if (in_roi && decode_tile_syntax) {
                 Av1TileDecodeParams p;
                 memset(&p, 0, sizeof(p));
                 p.mi_col_start = ti->mi_col_starts[tileCol];
                 p.mi_col_end = ti->mi_col_starts[tileCol + 1];
                 p.mi_row_start = ti->mi_row_starts[tileRow];
                 p.mi_row_end = ti->mi_row_starts[tileRow + 1];
+                p.mi_rows = fh->mi_rows;
+                p.mi_cols = fh->mi_cols;
                 p.use_128x128_superblock = seq->use_128x128_superblock;
+                p.bit_depth = seq->bit_depth;
                 p.mono_chrome = seq->mono_chrome;
                 p.subsampling_x = seq->subsampling_x;
                 p.subsampling_y = seq->subsampling_y;
@@ -2135,6 +2260,10 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 p.delta_q_u_ac = fh->DeltaQUAc;
                 p.delta_q_v_dc = fh->DeltaQVDc;
                 p.delta_q_v_ac = fh->DeltaQVAc;
+                p.using_qmatrix = fh->using_qmatrix;
+                p.qm_y = fh->qm_y;
+                p.qm_u = fh->qm_u;
+                p.qm_v = fh->qm_v;
                 p.tx_mode = fh->tx_mode;
                 p.reduced_tx_set = fh->reduced_tx_set;
                 p.enable_cdef = seq->enable_cdef;
@@ -2145,6 +2274,14 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 p.delta_lf_res = fh->delta_lf_res;
                 p.delta_lf_multi = fh->delta_lf_multi;
                 p.probe_try_exit_symbol = decode_tile_syntax_try_eot ? 1u : 0u;
+                // Deblocking inputs and filter levels per MI, as the reconstruction will hand them
+                // to the loop filter.
+                Av1LfLevels lf_levels;
+                av1_lf_levels_init(&lf_levels, &fh->lf);
+                p.lf_levels = &lf_levels;
+                p.lf_mi_stride = (ptrdiff_t)(p.mi_col_end - p.mi_col_start);
+                p.lf_mi = calloc((size_t)(p.mi_row_end - p.mi_row_start) * (size_t)p.lf_mi_stride + 1u, sizeof(Av1LfMi));
+                p.segmap = segmap;
                 Av1TileSyntaxProbeStats st;
                 Av1TileSyntaxProbeStatus s = av1_tile_syntax_probe(payload + cur,
                                                                    (size_t)tileSize,
@@ -2153,12 +2290,20 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                                                                    &st,
                                                                    err,
                                                                    err_cap);
+                free(p.lf_mi);
                 if (s == AV1_TILE_SYNTAX_PROBE_OK) {
-                    printf("    tile[%u] r%u c%u: decode-tile-syntax OK (bools=%u)\n",
+                    printf("    tile[%u] r%u c%u: decode-tile-syntax OK (bools=%u, txb=%u all_zero=%u dc_only=%u eob<=16=%u dq_abs=%llu palette=%u intrabc=%u)\n",
                            TileNum,
                            tileRow,
                            tileCol,
-                           st.bools_read);
+                           st.bools_read,
+                           st.coeff_txb_total,
+                           st.coeff_txb_all_zero,
+                           st.coeff_txb_dc_only,
+                           st.coeff_txb_eob_le16,
+                           (unsigned long long)st.coeff_dequant_abs_sum,
+                           st.palette_blocks,
+                           st.intrabc_blocks);
                 } else {
                     const char *label = s == AV1_TILE_SYNTAX_PROBE_ERROR ? "ERROR" : "UNSUPPORTED";
                     if (decode_tile_syntax_strict) {
@@ -2279,12 +2424,13 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                     err[0] = 0;
                 }
             }
-            printf("    tile[%u] r%u c%u: off=%" PRIu64 " size=%" PRIu64 "\n",
+            printf("    tile[%u] r%u c%u: off=%" PRIu64 " size=%" PRIu64 "%s\n",
                    TileNum,
                    tileRow,
                    tileCol,
                    tile_data_off_abs,
-                   tileSize);
+                   tileSize,
+                   in_roi ? "" : " (outside crop, skipped)");
             cur += (size_t)tileSize;
             remaining = 0;
         } else {
@@ -2326,7 +2472,7 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 dump->tiles_written++;
             }
 
-            if (check_trailing) {
+            if (in_roi && check_trailing) {
                 Av1SymbolDecoder sd;
                 if (!av1_symbol_init(&sd, payload + cur, (size_t)tileSize, true, err, err_cap)) {
                     return false;
@@ -2363,7 +2509,7 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 }
             }
 
-            if (check_trailingbits) {
+            if (in_roi && check_trailingbits) {
                 if (!av1_symbol_check_trailing_bits(payload + cur, (size_t)tileSize, err, err_cap)) {
                     if (check_trailingbits_strict) {
                         return false;
@@ -2377,14 +2523,17 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 }
             }
 
-            if (decode_tile_syntax) {
+            if (in_roi && decode_tile_syntax) {
                 Av1TileDecodeParams p;
                 memset(&p, 0, sizeof(p));
                 p.mi_col_start = ti->mi_col_starts[tileCol];
                 p.mi_col_end = ti->mi_col_starts[tileCol + 1];
                 p.mi_row_start = ti->mi_row_starts[tileRow];
                 p.mi_row_end = ti->mi_row_starts[tileRow + 1];
+                p.mi_rows = fh->mi_rows;
+                p.mi_cols = fh->mi_cols;
                 p.use_128x128_superblock = seq->use_128x128_superblock;
+                p.bit_depth = seq->bit_depth;
                 p.mono_chrome = seq->mono_chrome;
                 p.subsampling_x = seq->subsampling_x;
                 p.subsampling_y = seq->subsampling_y;
@@ -2406,6 +2555,10 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 p.delta_q_u_ac = fh->DeltaQUAc;
                 p.delta_q_v_dc = fh->DeltaQVDc;
                 p.delta_q_v_ac = fh->DeltaQVAc;
+                p.using_qmatrix = fh->using_qmatrix;
+                p.qm_y = fh->qm_y;
+                p.qm_u = fh->qm_u;
+                p.qm_v = fh->qm_v;
                 p.tx_mode = fh->tx_mode;
                 p.reduced_tx_set = fh->reduced_tx_set;
                 p.enable_cdef = seq->enable_cdef;
@@ -2415,6 +2568,12 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 p.delta_lf_present = fh->delta_lf_present;
                 p.delta_lf_res = fh->delta_lf_res;
                 p.delta_lf_multi = fh->delta_lf_multi;
+                Av1LfLevels lf_levels;
+                av1_lf_levels_init(&lf_levels, &fh->lf);
+                p.lf_levels = &lf_levels;
+                p.lf_mi_stride = (ptrdiff_t)(p.mi_col_end - p.mi_col_start);
+                p.lf_mi = calloc((size_t)(p.mi_row_end - p.mi_row_start) * (size_t)p.lf_mi_stride + 1u, sizeof(Av1LfMi));
+                p.segmap = segmap;
                 Av1TileSyntaxProbeStats st;
                 Av1TileSyntaxProbeStatus s = av1_tile_syntax_probe(payload + cur,
                                                                    (size_t)tileSize,
@@ -2423,12 +2582,20 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                                                                    &st,
                                                                    err,
                                                                    err_cap);
+                free(p.lf_mi);
                 if (s == AV1_TILE_SYNTAX_PROBE_OK) {
-                    printf("    tile[%u] r%u c%u: decode-tile-syntax OK (bools=%u)\n",
+                    printf("    tile[%u] r%u c%u: decode-tile-syntax OK (bools=%u, txb=%u all_zero=%u dc_only=%u eob<=16=%u dq_abs=%llu palette=%u intrabc=%u)\n",
                            TileNum,
                            tileRow,
                            tileCol,
-                           st.bools_read);
+                           st.bools_read,
+                           st.coeff_txb_total,
+                           st.coeff_txb_all_zero,
+                           st.coeff_txb_dc_only,
+                           st.coeff_txb_eob_le16,
+                           (unsigned long long)st.coeff_dequant_abs_sum,
+                           st.palette_blocks,
+                           st.intrabc_blocks);
                 } else {
                     const char *label = s == AV1_TILE_SYNTAX_PROBE_ERROR ? "ERROR" : "UNSUPPORTED";
                     if (decode_tile_syntax_strict) {
@@ -2550,12 +2717,13 @@ static bool parse_tile_group_obu_and_print(const uint8_t *payload,
                 }
             }
 
-            printf("    tile[%u] r%u c%u: off=%" PRIu64 " size=%" PRIu64 "\n",
+            printf("    tile[%u] r%u c%u: off=%" PRIu64 " size=%" PRIu64 "%s\n",
                    TileNum,
                    tileRow,
                    tileCol,
                    tile_data_off_abs,
-                   tileSize);
+                   tileSize,
+                   in_roi ? "" : " (outside crop, skipped)");
 
             cur += (size_t)tileSize;
             if (remaining < (size_t)(tileSize + TileSizeBytes)) {
@@ -2616,21 +2784,22 @@ static bool parse_frame_size_render_and_superres(BitReader *br,
 
     uint32_t upscaled_width = frame_width;
     uint32_t coded_width = frame_width;
-    uint32_t superres_denom = 8; // SUPERRES_NUM
+    uint32_t superres_denom = AV1_SUPERRES_NUM;
     if (use_superres) {
         uint32_t coded_denom;
         if (!br_read_bits(br, 3, &coded_denom)) {
             snprintf(err, err_cap, "truncated coded_denom");
             return false;
         }
-        superres_denom = coded_denom + 9; // SUPERRES_DENOM_MIN
-        coded_width = (upscaled_width * 8u + (superres_denom / 2u)) / superres_denom;
+        superres_denom = coded_denom + AV1_SUPERRES_DENOM_MIN;
+        coded_width = av1_superres_coded_width(upscaled_width, superres_denom);
     }
 
     // compute_image_size()
     out->coded_width = coded_width;
     out->coded_height = frame_height;
     out->upscaled_width = upscaled_width;
+    out->superres_denom = superres_denom;
     out->mi_cols = 2u * ((coded_width + 7u) >> 3);
     out->mi_rows = 2u * ((frame_height + 7u) >> 3);
 
@@ -2653,7 +2822,6 @@ static bool parse_frame_size_render_and_superres(BitReader *br,
         out->frame_height = frame_height;
     }
 
-    (void)superres_denom;
     return true;
 }
 
@@ -2770,6 +2938,10 @@ static bool parse_uncompressed_header_reduced_still(const uint8_t *payload,
     out->DeltaQUAc = 0;
     out->DeltaQVDc = 0;
     out->DeltaQVAc = 0;
+    out->using_qmatrix = 0;
+    out->qm_y = 15;
+    out->qm_u = 15;
+    out->qm_v = 15;
     out->tx_mode = 1; // TX_MODE_LARGEST default when unknown.
     out->segmentation_enabled = 0;
     out->seg_id_pre_skip = 0;
@@ -2778,6 +2950,10 @@ static bool parse_uncompressed_header_reduced_still(const uint8_t *payload,
         out->seg_feature_enabled_alt_q[i] = 0;
         out->seg_feature_data_alt_q[i] = 0;
     }
+    av1_lf_params_default(&out->lf);
+    av1_cdef_params_default(&out->cdef);
+    av1_lr_params_default(&out->lr);
+    memset(&out->film_grain, 0, sizeof(out->film_grain));
     {
         BitReader br2 = br;
         QuantizationState qs;
@@ -2792,6 +2968,10 @@ static bool parse_uncompressed_header_reduced_still(const uint8_t *payload,
             out->DeltaQUAc = qs.DeltaQUAc;
             out->DeltaQVDc = qs.DeltaQVDc;
             out->DeltaQVAc = qs.DeltaQVAc;
+            out->using_qmatrix = qs.using_qmatrix;
+            out->qm_y = qs.qm_y;
+            out->qm_u = qs.qm_u;
+            out->qm_v = qs.qm_v;
 
             out->segmentation_enabled = ss.segmentation_enabled;
             out->seg_id_pre_skip = ss.seg_id_pre_skip;
@@ -2966,6 +3146,10 @@ static bool parse_uncompressed_header_nonreduced_still(const uint8_t *payload,
     out->DeltaQUAc = 0;
     out->DeltaQVDc = 0;
     out->DeltaQVAc = 0;
+    out->using_qmatrix = 0;
+    out->qm_y = 15;
+    out->qm_u = 15;
+    out->qm_v = 15;
     out->segmentation_enabled = 0;
     out->seg_id_pre_skip = 0;
     out->last_active_seg_id = 0;
@@ -2973,6 +3157,10 @@ static bool parse_uncompressed_header_nonreduced_still(const uint8_t *payload,
         out->seg_feature_enabled_alt_q[i] = 0;
         out->seg_feature_data_alt_q[i] = 0;
     }
+    av1_lf_params_default(&out->lf);
+    av1_cdef_params_default(&out->cdef);
+    av1_lr_params_default(&out->lr);
+    memset(&out->film_grain, 0, sizeof(out->film_grain));
     {
         BitReader br2 = br;
         QuantizationState qs;
@@ -2987,6 +3175,10 @@ static bool parse_uncompressed_header_nonreduced_still(const uint8_t *payload,
             out->DeltaQUAc = qs.DeltaQUAc;
             out->DeltaQVDc = qs.DeltaQVDc;
             out->DeltaQVAc = qs.DeltaQVAc;
+            out->using_qmatrix = qs.using_qmatrix;
+            out->qm_y = qs.qm_y;
+            out->qm_u = qs.qm_u;
+            out->qm_v = qs.qm_v;
 
             out->segmentation_enabled = ss.segmentation_enabled;
             out->seg_id_pre_skip = ss.seg_id_pre_skip;
@@ -3105,6 +3297,9 @@ int main(int argc, char **argv) {
     bool decode_tile_syntax = false;
     bool decode_tile_syntax_strict = false;
     bool decode_tile_syntax_try_eot = false;
+    bool crop_requested = false;
+    Av1RoiRect crop;
+    memset(&crop, 0, sizeof(crop));
 
     for (int i = 1; i < argc; i++) {
         if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
@@ -3165,6 +3360,31 @@ int main(int argc, char **argv) {
             decode_tile_syntax_try_eot = true;
             continue;
         }
+        if (!strcmp(argv[i], "--cpu-mask")) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--cpu-mask requires MASK\n");
+                return 2;
+            }
+            uint32_t mask;
+            if (!av1_cpu_parse_mask(argv[++i], &mask)) {
+                fprintf(stderr, "invalid --cpu-mask value (expected c, sse2, ssse3, sse4.1, avx2, avx512 or a bit mask)\n");
+                return 2;
+            }
+            av1_cpu_set_mask(mask);
+            continue;
+        }
+        if (!strcmp(argv[i], "--crop")) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--crop requires x,y,w,h\n");
+                return 2;
+            }
+            if (!av1_roi_parse_rect(argv[++i], &crop)) {
+                fprintf(stderr, "invalid --crop value (expected x,y,w,h with w,h > 0)\n");
+                return 2;
+            }
+            crop_requested = true;
+            continue;
+        }
         if (!path) {
             path = argv[i];
         } else {
@@ -3299,6 +3519,7 @@ int main(int argc, char **argv) {
     printf("  coded_width=%u\n", fh.coded_width);
     printf("  coded_height=%u\n", fh.coded_height);
     printf("  upscaled_width=%u\n", fh.upscaled_width);
+    printf("  superres_denom=%u\n", fh.superres_denom);
         printf("  segmentation_enabled=%u seg_id_pre_skip=%u last_active_seg_id=%u\n",
             fh.segmentation_enabled,
             fh.seg_id_pre_skip,
@@ -3317,7 +3538,38 @@ int main(int argc, char **argv) {
                 fh.delta_lf_present,
                 fh.delta_lf_res,
                 fh.delta_lf_multi);
+            printf("  loop_filter_level=%u,%u,%u,%u sharpness=%u delta_enabled=%u\n",
+                fh.lf.level[0],
+                fh.lf.level[1],
+                fh.lf.level[2],
+                fh.lf.level[3],
+                fh.lf.sharpness,
+                fh.lf.delta_enabled);
             printf("  cdef_bits=%u\n", fh.cdef_bits);
+            printf("  cdef_damping=%u cdef_y_strengths=", fh.cdef.damping);
+            for (uint32_t i = 0; i < (1u << fh.cdef.bits); i++) {
+                printf("%s%u/%u", i ? "," : "", fh.cdef.y_pri[i], fh.cdef.y_sec[i]);
+            }
+            printf(" cdef_uv_strengths=");
+            for (uint32_t i = 0; i < (1u << fh.cdef.bits); i++) {
+                printf("%s%u/%u", i ? "," : "", fh.cdef.uv_pri[i], fh.cdef.uv_sec[i]);
+            }
+            printf("\n");
+            printf("  lr_type=%u,%u,%u lr_unit_size=%u,%u,%u\n",
+                   fh.lr.frame_type[0],
+                   fh.lr.frame_type[1],
+                   fh.lr.frame_type[2],
+                   fh.lr.unit_size[0],
+                   fh.lr.unit_size[1],
+                   fh.lr.unit_size[2]);
+            printf("  apply_grain=%u grain_seed=%u grain_points=%u,%u,%u ar_coeff_lag=%u overlap_flag=%u\n",
+                   fh.film_grain.apply_grain,
+                   fh.film_grain.grain_seed,
+                   fh.film_grain.num_y_points,
+                   fh.film_grain.num_cb_points,
+                   fh.film_grain.num_cr_points,
+                   fh.film_grain.ar_coeff_lag,
+                   fh.film_grain.overlap_flag);
 
     printf("Tile info (from frame header):\n");
     printf("  tile_cols=%u tile_rows=%u\n", ti.tile_cols, ti.tile_rows);
@@ -3325,15 +3577,59 @@ int main(int argc, char **argv) {
     printf("  tile_size_bytes=%u\n", ti.tile_size_bytes);
     printf("  context_update_tile_id=%u\n", ti.context_update_tile_id);
 
+    Av1RoiTileSet roi;
+    bool crop_set = false;
+    if (crop_requested) {
+        if (!av1_roi_select_tiles(&crop,
+                                  fh.coded_width,
+                                  fh.coded_height,
+                                  fh.upscaled_width,
+                                  AV1_ROI_FILTER_MARGIN_PX,
+                                  ti.mi_col_starts,
+                                  ti.tile_cols,
+                                  ti.mi_row_starts,
+                                  ti.tile_rows,
+                                  &roi,
+                                  err,
+                                  sizeof(err))) {
+            fprintf(stderr, "Crop failed: %s\n", err);
+            free(bytes);
+            return 1;
+        }
+        crop_set = true;
+        printf("Crop (ROI):\n");
+        printf("  rect=%u,%u,%u,%u margin_px=%u\n", crop.x, crop.y, crop.w, crop.h, AV1_ROI_FILTER_MARGIN_PX);
+        printf("  mi_cols=[%u,%u) mi_rows=[%u,%u)\n", roi.mi_col_start, roi.mi_col_end, roi.mi_row_start, roi.mi_row_end);
+        printf("  tile_cols=[%u,%u) tile_rows=[%u,%u) (%u of %u tiles)\n",
+               roi.tile_col_start,
+               roi.tile_col_end,
+               roi.tile_row_start,
+               roi.tile_row_end,
+               (roi.tile_col_end - roi.tile_col_start) * (roi.tile_row_end - roi.tile_row_start),
+               ti.tile_cols * ti.tile_rows);
+    }
+
     TileDumpCtx dump;
     memset(&dump, 0, sizeof(dump));
     dump.dir = dump_tiles_dir;
     dump.tg_index = 0;
 
+    // SegmentIds[][] of the frame, shared by the tiles of every tile group.
+    Av1SegMap segmap;
+    memset(&segmap, 0, sizeof(segmap));
+    if (decode_tile_syntax && fh.segmentation_enabled) {
+        if (!av1_segmap_init(&segmap, fh.mi_rows, fh.mi_cols, err, sizeof(err))) {
+            fprintf(stderr, "Segment map allocation failed: %s\n", err);
+            free(bytes);
+            return 1;
+        }
+    }
+
     if (frame_obu.obu_type == 6) {
         printf("Tile group scan (embedded in OBU_FRAME):\n");
         if (frame_header_bytes >= frame_obu.payload_size) {
             fprintf(stderr, "Embedded tile group start exceeds OBU_FRAME payload\n");
+            av1_segmap_free(&segmap);
             free(bytes);
             return 1;
         }
@@ -3355,9 +3651,12 @@ int main(int argc, char **argv) {
                                             decode_tile_syntax,
                                             decode_tile_syntax_strict,
                                             decode_tile_syntax_try_eot,
+                                            crop_set ? &roi : NULL,
+                                            segmap.map ? &segmap : NULL,
                                             err,
                                             sizeof(err))) {
             fprintf(stderr, "Embedded tile group parse failed: %s\n", err);
+            av1_segmap_free(&segmap);
             free(bytes);
             return 1;
         }
@@ -3430,9 +3729,12 @@ int main(int argc, char **argv) {
                                                     decode_tile_syntax,
                                                     decode_tile_syntax_strict,
                                                     decode_tile_syntax_try_eot,
+                                                    crop_set ? &roi : NULL,
+                                                    segmap.map ? &segmap : NULL,
                                                     err,
                                                     sizeof(err))) {
                     fprintf(stderr, "Tile group parse failed: %s\n", err);
+                    av1_segmap_free(&segmap);
                     free(bytes);
                     return 1;
                 }
@@ -3447,6 +3749,7 @@ int main(int argc, char **argv) {
     if (dump_tiles_dir) {
         if (!write_text_file_frame_info(dump_tiles_dir, &seq, &fh, &ti, err, sizeof(err))) {
             fprintf(stderr, "Tile dump frame_info write failed: %s\n", err);
+            av1_segmap_free(&segmap);
             free(bytes);
             return 1;
         }
@@ -3455,6 +3758,7 @@ int main(int argc, char **argv) {
 
     printf("Note: AVIF container properties (e.g. ispe/colr) remain authoritative for presentation metadata.\n");
 
+    av1_segmap_free(&segmap);
     free(bytes);
     return 0;
 }
@@ -0,0 +1,194 @@
+#include "av1_intra_pred.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mode_To_Angle (spec).
+static const int32_t kModeToAngle[AV1_UV_CFL_PRED] = {0, 90, 180, 45, 135, 113, 157, 203, 67, 0, 0, 0, 0};
+
+// Dr_Intra_Derivative (spec), indexed by angle 0..89.
+const int32_t av1_dr_intra_derivative[90] = {
+    0,  0, 0, 1023, 0,  0, 547, 0,  0, 372, 0,  0,  0,  0, 273, 0,  0, 215, 0, 0, 178, 0, 0, 151, 0, 0, 132, 0, 0, 116,
+    0,  0, 102, 0,  0, 0,  90, 0,  0, 80,  0,  0, 71, 0,  0,   64, 0, 0,   57, 0, 0,  51, 0, 0, 45,  0, 0, 0,   40, 0,
+    0, 35, 0,  0,    31, 0, 0,   27, 0,  0,   23, 0, 0,  19, 0,   0,  15, 0, 0, 0, 0, 11, 0, 0, 7, 0, 0, 3,  0, 0,
+};
+
+int32_t av1_intra_mode_to_angle(uint32_t mode) {
+    return mode < AV1_UV_CFL_PRED ? kModeToAngle[mode] : 0;
+}
+
+// Sm_Weights_Tx_4x4 .. Sm_Weights_Tx_64x64 (spec), stored so that the table for size n starts
+// at index n.
+const uint8_t av1_sm_weights[128] = {
+    0,   0,   0,   0,
+    // 4
+    255, 149, 85,  64,
+    // 8
+    255, 197, 146, 105, 73,  50,  37,  32,
+    // 16
+    255, 225, 196, 170, 145, 123, 102, 84,  68,  54,  43,  33,  26,  20,  17,  16,
+    // 32
+    255, 240, 225, 210, 196, 182, 169, 157, 145, 133, 122, 111, 101, 92,  83,  74,
+    66,  59,  52,  45,  39,  34,  29,  25,  21,  17,  14,  12,  10,  9,   8,   8,
+    // 64
+    255, 248, 240, 233, 225, 218, 210, 203, 196, 189, 182, 176, 169, 163, 156, 150,
+    144, 138, 133, 127, 121, 116, 111, 106, 101, 96,  91,  86,  82,  77,  73,  69,
+    65,  61,  57,  54,  50,  47,  44,  41,  38,  35,  32,  29,  27,  25,  22,  20,
+    18,  16,  15,  13,  12,  10,  9,   8,   7,   6,   6,   5,   5,   4,   4,   4,
+};
+
+// Intra_Filter_Taps (spec).
+const int8_t av1_filter_intra_taps[AV1_FILTER_INTRA_MODES][8][7] = {
+    {
+        {-6, 10, 0, 0, 0, 12, 0},
+        {-5, 2, 10, 0, 0, 9, 0},
+        {-3, 1, 1, 10, 0, 7, 0},
+        {-3, 1, 1, 2, 10, 5, 0},
+        {-4, 6, 0, 0, 0, 2, 12},
+        {-3, 2, 6, 0, 0, 2, 9},
+        {-3, 2, 2, 6, 0, 2, 7},
+        {-3, 1, 2, 2, 6, 3, 5},
+    },
+    {
+        {-10, 16, 0, 0, 0, 10, 0},
+        {-6, 0, 16, 0, 0, 6, 0},
+        {-4, 0, 0, 16, 0, 4, 0},
+        {-2, 0, 0, 0, 16, 2, 0},
+        {-10, 16, 0, 0, 0, 0, 10},
+        {-6, 0, 16, 0, 0, 0, 6},
+        {-4, 0, 0, 16, 0, 0, 4},
+        {-2, 0, 0, 0, 16, 0, 2},
+    },
+    {
+        {-8, 8, 0, 0, 0, 16, 0},
+        {-8, 0, 8, 0, 0, 16, 0},
+        {-8, 0, 0, 8, 0, 16, 0},
+        {-8, 0, 0, 0, 8, 16, 0},
+        {-4, 4, 0, 0, 0, 0, 16},
+        {-4, 0, 4, 0, 0, 0, 16},
+        {-4, 0, 0, 4, 0, 0, 16},
+        {-4, 0, 0, 0, 4, 0, 16},
+    },
+    {
+        {-2, 8, 0, 0, 0, 10, 0},
+        {-1, 3, 8, 0, 0, 6, 0},
+        {-1, 2, 3, 8, 0, 4, 0},
+        {0, 1, 2, 3, 8, 2, 0},
+        {-1, 4, 0, 0, 0, 3, 10},
+        {-1, 3, 4, 0, 0, 4, 6},
+        {-1, 2, 3, 4, 0, 4, 4},
+        {-1, 2, 2, 3, 4, 3, 3},
+    },
+    {
+        {-12, 14, 0, 0, 0, 14, 0},
+        {-10, 0, 14, 0, 0, 12, 0},
+        {-9, 0, 0, 14, 0, 11, 0},
+        {-8, 0, 0, 0, 14, 10, 0},
+        {-10, 12, 0, 0, 0, 0, 14},
+        {-9, 1, 12, 0, 0, 0, 12},
+        {-8, 0, 0, 12, 0, 1, 11},
+        {-7, 0, 0, 1, 12, 1, 9},
+    },
+};
+
+// Intra_Edge_Kernel (spec).
+static const int32_t kIntraEdgeKernel[3][5] = {
+    {0, 4, 8, 4, 0},
+    {0, 5, 6, 5, 0},
+    {2, 4, 4, 4, 2},
+};
+
+uint32_t av1_intra_edge_filter_strength(uint32_t w, uint32_t h, bool filter_type, int32_t delta) {
+    const int32_t d = delta < 0 ? -delta : delta;
+    const uint32_t blk_wh = w + h;
+    uint32_t strength = 0;
+    if (!filter_type) {
+        if (blk_wh <= 8) {
+            if (d >= 56) strength = 1;
+        } else if (blk_wh <= 16) {
+            if (d >= 40) strength = 1;
+        } else if (blk_wh <= 24) {
+            if (d >= 8) strength = 1;
+            if (d >= 16) strength = 2;
+            if (d >= 32) strength = 3;
+        } else if (blk_wh <= 32) {
+            strength = 1;
+            if (d >= 4) strength = 2;
+            if (d >= 32) strength = 3;
+        } else {
+            strength = 3;
+        }
+    } else {
+        if (blk_wh <= 8) {
+            if (d >= 40) strength = 1;
+            if (d >= 64) strength = 2;
+        } else if (blk_wh <= 16) {
+            if (d >= 20) strength = 1;
+            if (d >= 48) strength = 2;
+        } else if (blk_wh <= 24) {
+            if (d >= 4) strength = 3;
+        } else {
+            strength = 3;
+        }
+    }
+    return strength;
+}
+
+bool av1_intra_edge_use_upsample(uint32_t w, uint32_t h, bool filter_type, int32_t delta) {
+    const int32_t d = delta < 0 ? -delta : delta;
+    if (d <= 0 || d >= 40) {
+        return false;
+    }
+    return filter_type ? w + h <= 8 : w + h <= 16;
+}
+
+// ---- Scalar kernels, one instantiation per pixel type ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#define PX_BD_UNUSED (void)0
+#include "av1_intra_pred_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+#undef PX_BD_UNUSED
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#define PX_BD_UNUSED (void)bit_depth
+#include "av1_intra_pred_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+#undef PX_BD_UNUSED
+
+void av1_intra_pred_dsp_init(Av1IntraPredDsp *dsp) {
+    av1_intra_pred_dsp_init_c(dsp);
+#if defined(AV1_IPRED_HAVE_X86)
+    (void)av1_intra_pred_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_intra_pred_dsp_init_16(Av1IntraPredDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_intra_pred_dsp_init_c_16(dsp, bit_depth);
+}
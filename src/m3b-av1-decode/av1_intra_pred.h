@@ -0,0 +1,318 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Intra prediction (spec 7.11.2 "Intra prediction process", see local av1bitstream.html).
+//
+// Prediction is split into two steps:
+// - av1_intra_edges_build() gathers AboveRow[] / LeftCol[] from the reconstructed plane, exactly
+//   as the spec derives them (availability, aboveLimit / leftLimit replication, corner).
+// - A kernel from an Av1IntraPredDsp table fills the w x h block from those edges.
+//
+// Directional modes may first filter / upsample those edges (av1_intra_dir_prepare_edges()).
+//
+// Every kernel has a scalar reference; av1_intra_pred_x86.c provides AVX2 variants that are
+// bit-exact with it.
+//
+// The scalar code is written once (av1_intra_pred_tmpl.inc) and instantiated for uint8_t pixels
+// (BitDepth 8) and uint16_t pixels (BitDepth 10 / 12). The 16-bit API mirrors the 8-bit one with a
+// _16 / 16 suffix; its table carries the bit depth.
+
+// Intra modes in spec numbering (y_mode / uv_mode values).
+enum {
+    AV1_DC_PRED = 0,
+    AV1_V_PRED = 1,
+    AV1_H_PRED = 2,
+    AV1_D45_PRED = 3,
+    AV1_D135_PRED = 4,
+    AV1_D113_PRED = 5,
+    AV1_D157_PRED = 6,
+    AV1_D203_PRED = 7,
+    AV1_D67_PRED = 8,
+    AV1_SMOOTH_PRED = 9,
+    AV1_SMOOTH_V_PRED = 10,
+    AV1_SMOOTH_H_PRED = 11,
+    AV1_PAETH_PRED = 12,
+    AV1_UV_CFL_PRED = 13,
+};
+
+#define AV1_ANGLE_STEP 3
+
+// Kernel table slots. DC has one slot per edge-availability variant; all directional angles
+// other than 90 / 180 share AV1_IPRED_DIR.
+enum {
+    AV1_IPRED_DC = 0,
+    AV1_IPRED_DC_LEFT,
+    AV1_IPRED_DC_TOP,
+    AV1_IPRED_DC_128,
+    AV1_IPRED_V,
+    AV1_IPRED_H,
+    AV1_IPRED_PAETH,
+    AV1_IPRED_SMOOTH,
+    AV1_IPRED_SMOOTH_V,
+    AV1_IPRED_SMOOTH_H,
+    AV1_IPRED_DIR,
+    AV1_IPRED_KINDS,
+};
+
+// Edge arrays. AboveRow[] / LeftCol[] are addressed from index -AV1_INTRA_EDGE_PAD; the spec uses
+// -1 (corner) and, after upsampling, -2. Entries past the last derived one replicate it so that
+// vector loads may over-read.
+#define AV1_INTRA_EDGE_PAD 16u
+#define AV1_INTRA_EDGE_LEN (2u * 128u + 32u)
+
+typedef struct {
+    uint8_t above_buf[AV1_INTRA_EDGE_PAD + AV1_INTRA_EDGE_LEN];
+    uint8_t left_buf[AV1_INTRA_EDGE_PAD + AV1_INTRA_EDGE_LEN];
+} Av1IntraEdges;
+
+static inline uint8_t *av1_intra_edges_above(Av1IntraEdges *e) {
+    return e->above_buf + AV1_INTRA_EDGE_PAD;
+}
+
+static inline uint8_t *av1_intra_edges_left(Av1IntraEdges *e) {
+    return e->left_buf + AV1_INTRA_EDGE_PAD;
+}
+
+// Sm_Weights_Tx_NxN (spec): the table for block dimension n starts at av1_sm_weights[n].
+extern const uint8_t av1_sm_weights[128];
+
+// Dr_Intra_Derivative (spec), indexed by angle.
+extern const int32_t av1_dr_intra_derivative[90];
+
+#define AV1_FILTER_INTRA_MODES 5
+
+// Intra_Filter_Taps (spec).
+extern const int8_t av1_filter_intra_taps[AV1_FILTER_INTRA_MODES][8][7];
+
+// Directional prediction parameters (spec 7.11.2.4).
+typedef struct {
+    int32_t p_angle; // Mode_To_Angle[ mode ] + angleDelta * ANGLE_STEP
+    uint8_t upsample_above;
+    uint8_t upsample_left;
+} Av1IntraDir;
+
+// Fills dst (stride bytes per row) with a (1 << log2w) x (1 << log2h) prediction.
+// above / left point at AboveRow[0] / LeftCol[0]. dir is only read by AV1_IPRED_DIR.
+typedef void (*Av1IntraPredFn)(uint8_t *dst,
+                               ptrdiff_t stride,
+                               const uint8_t *above,
+                               const uint8_t *left,
+                               uint32_t log2w,
+                               uint32_t log2h,
+                               const Av1IntraDir *dir);
+
+// Recursive filter-intra prediction (spec 7.11.2.3) of a (1 << log2w) x (1 << log2h) block,
+// w, h <= 32, for filter_intra_mode 0..4. Reads AboveRow[ -1 .. w - 1 ] and LeftCol[ 0 .. h - 1 ].
+typedef void (*Av1FilterIntraFn)(uint8_t *dst,
+                                 ptrdiff_t stride,
+                                 const uint8_t *above,
+                                 const uint8_t *left,
+                                 uint32_t log2w,
+                                 uint32_t log2h,
+                                 uint32_t filter_mode);
+
+// Intra edge filter (spec 7.11.2.12) with strength 1..3: edge[ i ] is AboveRow[ i - 1 ] or
+// LeftCol[ i - 1 ], so edge points at index -1 of the array; entries 1..sz-1 are filtered in place.
+typedef void (*Av1IntraEdgeFilterFn)(uint8_t *edge, uint32_t sz, uint32_t strength);
+
+// Intra edge upsample (spec 7.11.2.11) in place: buf points at AboveRow[ 0 ] / LeftCol[ 0 ], with
+// entries -1..num_px-1 valid on entry and -2..2*num_px-2 on return. num_px <= 16. Kernels may
+// read buf[ -2 .. 30 ] (and write back bytes past 2 * num_px - 2 unchanged).
+typedef void (*Av1IntraEdgeUpsampleFn)(uint8_t *buf, uint32_t num_px);
+
+typedef struct {
+    Av1IntraPredFn pred[AV1_IPRED_KINDS];
+    Av1FilterIntraFn filter_intra;
+    Av1IntraEdgeFilterFn edge_filter;
+    Av1IntraEdgeUpsampleFn edge_upsample;
+} Av1IntraPredDsp;
+
+// Scalar reference table.
+void av1_intra_pred_dsp_init_c(Av1IntraPredDsp *dsp);
+
+// Best table for the running CPU.
+void av1_intra_pred_dsp_init(Av1IntraPredDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_IPRED_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_intra_pred_dsp_init_avx2(Av1IntraPredDsp *dsp);
+#endif
+
+// AboveRow / LeftCol derivation (spec 7.11.2). plane points at CurrFrame[ plane ][ 0 ][ 0 ];
+// (x, y) is the top-left sample of the transform block; max_x / max_y are the last valid
+// coordinates of the plane (( MiCols * MI_SIZE ) >> subsampling_x ) - 1 etc.
+void av1_intra_edges_build(Av1IntraEdges *e,
+                           const uint8_t *plane,
+                           ptrdiff_t stride,
+                           uint32_t x,
+                           uint32_t y,
+                           uint32_t log2w,
+                           uint32_t log2h,
+                           bool have_left,
+                           bool have_above,
+                           bool have_above_right,
+                           bool have_below_left,
+                           uint32_t max_x,
+                           uint32_t max_y);
+
+// Mode_To_Angle[ mode ] (0 for non-directional modes).
+int32_t av1_intra_mode_to_angle(uint32_t mode);
+
+// Intra edge filter strength selection (spec 7.11.2.9) and upsample selection (7.11.2.10).
+uint32_t av1_intra_edge_filter_strength(uint32_t w, uint32_t h, bool filter_type, int32_t delta);
+bool av1_intra_edge_use_upsample(uint32_t w, uint32_t h, bool filter_type, int32_t delta);
+
+// Inputs of the directional edge preparation when enable_intra_edge_filter is 1.
+typedef struct {
+    bool filter_type;     // intra filter type process (spec 7.11.2.8): a smooth neighbour
+    uint32_t above_avail; // maxX - x + 1
+    uint32_t left_avail;  // maxY - y + 1
+} Av1IntraEdgeFilterCtx;
+
+// Directional edge preparation of spec 7.11.2.4 for pAngle != 90 / 180: corner filter, edge
+// filters and upsampling applied in place to AboveRow / LeftCol. Sets dir (p_angle and the
+// upsample flags) for the AV1_IPRED_DIR kernel.
+void av1_intra_dir_prepare_edges(const Av1IntraPredDsp *dsp,
+                                 uint8_t *above,
+                                 uint8_t *left,
+                                 uint32_t log2w,
+                                 uint32_t log2h,
+                                 int32_t p_angle,
+                                 bool have_left,
+                                 bool have_above,
+                                 const Av1IntraEdgeFilterCtx *ctx,
+                                 Av1IntraDir *dir);
+
+// Predicts one transform block: maps (mode, angleDelta, edge availability) to a kernel slot and
+// runs it. edge_filter is NULL when enable_intra_edge_filter is 0; otherwise directional modes
+// first run av1_intra_dir_prepare_edges(), which modifies above / left. CFL is a separate process
+// and is rejected here.
+bool av1_intra_predict(const Av1IntraPredDsp *dsp,
+                       uint32_t mode,
+                       int32_t angle_delta,
+                       bool have_left,
+                       bool have_above,
+                       const Av1IntraEdgeFilterCtx *edge_filter,
+                       uint8_t *above,
+                       uint8_t *left,
+                       uint8_t *dst,
+                       ptrdiff_t stride,
+                       uint32_t log2w,
+                       uint32_t log2h,
+                       char *err,
+                       size_t err_cap);
+
+// Filter-intra prediction of one transform block (use_filter_intra = 1).
+bool av1_intra_predict_filter(const Av1IntraPredDsp *dsp,
+                              uint32_t filter_mode,
+                              const uint8_t *above,
+                              const uint8_t *left,
+                              uint8_t *dst,
+                              ptrdiff_t stride,
+                              uint32_t log2w,
+                              uint32_t log2h,
+                              char *err,
+                              size_t err_cap);
+
+// ---- 16-bit pixels (BitDepth 10 / 12) ----
+
+typedef struct {
+    uint16_t above_buf[AV1_INTRA_EDGE_PAD + AV1_INTRA_EDGE_LEN];
+    uint16_t left_buf[AV1_INTRA_EDGE_PAD + AV1_INTRA_EDGE_LEN];
+} Av1IntraEdges16;
+
+static inline uint16_t *av1_intra_edges_above_16(Av1IntraEdges16 *e) {
+    return e->above_buf + AV1_INTRA_EDGE_PAD;
+}
+
+static inline uint16_t *av1_intra_edges_left_16(Av1IntraEdges16 *e) {
+    return e->left_buf + AV1_INTRA_EDGE_PAD;
+}
+
+// As the 8-bit kernels, with stride in pixels and the bit depth for defaults and Clip1().
+typedef void (*Av1IntraPredFn16)(uint16_t *dst,
+                                 ptrdiff_t stride,
+                                 const uint16_t *above,
+                                 const uint16_t *left,
+                                 uint32_t log2w,
+                                 uint32_t log2h,
+                                 const Av1IntraDir *dir,
+                                 uint32_t bit_depth);
+typedef void (*Av1FilterIntraFn16)(uint16_t *dst,
+                                   ptrdiff_t stride,
+                                   const uint16_t *above,
+                                   const uint16_t *left,
+                                   uint32_t log2w,
+                                   uint32_t log2h,
+                                   uint32_t filter_mode,
+                                   uint32_t bit_depth);
+typedef void (*Av1IntraEdgeFilterFn16)(uint16_t *edge, uint32_t sz, uint32_t strength);
+typedef void (*Av1IntraEdgeUpsampleFn16)(uint16_t *buf, uint32_t num_px, uint32_t bit_depth);
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1IntraPredFn16 pred[AV1_IPRED_KINDS];
+    Av1FilterIntraFn16 filter_intra;
+    Av1IntraEdgeFilterFn16 edge_filter;
+    Av1IntraEdgeUpsampleFn16 edge_upsample;
+} Av1IntraPredDsp16;
+
+void av1_intra_pred_dsp_init_c_16(Av1IntraPredDsp16 *dsp, uint32_t bit_depth);
+void av1_intra_pred_dsp_init_16(Av1IntraPredDsp16 *dsp, uint32_t bit_depth);
+
+void av1_intra_edges_build_16(Av1IntraEdges16 *e,
+                              const uint16_t *plane,
+                              ptrdiff_t stride,
+                              uint32_t x,
+                              uint32_t y,
+                              uint32_t log2w,
+                              uint32_t log2h,
+                              bool have_left,
+                              bool have_above,
+                              bool have_above_right,
+                              bool have_below_left,
+                              uint32_t max_x,
+                              uint32_t max_y,
+                              uint32_t bit_depth);
+
+void av1_intra_dir_prepare_edges_16(const Av1IntraPredDsp16 *dsp,
+                                    uint16_t *above,
+                                    uint16_t *left,
+                                    uint32_t log2w,
+                                    uint32_t log2h,
+                                    int32_t p_angle,
+                                    bool have_left,
+                                    bool have_above,
+                                    const Av1IntraEdgeFilterCtx *ctx,
+                                    Av1IntraDir *dir);
+
+bool av1_intra_predict_16(const Av1IntraPredDsp16 *dsp,
+                          uint32_t mode,
+                          int32_t angle_delta,
+                          bool have_left,
+                          bool have_above,
+                          const Av1IntraEdgeFilterCtx *edge_filter,
+                          uint16_t *above,
+                          uint16_t *left,
+                          uint16_t *dst,
+                          ptrdiff_t stride,
+                          uint32_t log2w,
+                          uint32_t log2h,
+                          char *err,
+                          size_t err_cap);
+
+bool av1_intra_predict_filter_16(const Av1IntraPredDsp16 *dsp,
+                                 uint32_t filter_mode,
+                                 const uint16_t *above,
+                                 const uint16_t *left,
+                                 uint16_t *dst,
+                                 ptrdiff_t stride,
+                                 uint32_t log2w,
+                                 uint32_t log2h,
+                                 char *err,
+                                 size_t err_cap);
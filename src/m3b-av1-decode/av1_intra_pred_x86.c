@@ -0,0 +1,681 @@
+#include "av1_intra_pred.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 intra prediction kernels, bit-exact with the scalar reference in av1_intra_pred.c.
+//
+// Functions carry a target attribute so the file builds with the default CFLAGS;
+// av1_intra_pred_dsp_init_avx2() checks the CPU before installing them.
+//
+// All kernels may read up to 32 bytes past AboveRow[w - 1] / LeftCol[h - 1] and a few bytes
+// before index 0, which Av1IntraEdges guarantees.
+
+#if defined(AV1_IPRED_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+// Stores the low w bytes of v (w = 4, 8, 16 or 32).
+static inline AVX2_ATTR void store_row(uint8_t *dst, __m256i v, uint32_t w) {
+    if (w >= 32) {
+        _mm256_storeu_si256((__m256i *)(void *)dst, v);
+    } else if (w == 16) {
+        _mm_storeu_si128((__m128i *)(void *)dst, _mm256_castsi256_si128(v));
+    } else if (w == 8) {
+        _mm_storel_epi64((__m128i *)(void *)dst, _mm256_castsi256_si128(v));
+    } else {
+        int32_t v32 = _mm_cvtsi128_si32(_mm256_castsi256_si128(v));
+        memcpy(dst, &v32, 4);
+    }
+}
+
+static inline AVX2_ATTR void fill_rows(uint8_t *dst, ptrdiff_t stride, uint32_t w, uint32_t h, __m256i v) {
+    for (uint32_t i = 0; i < h; i++) {
+        uint8_t *row = dst + (ptrdiff_t)i * stride;
+        for (uint32_t j = 0; j < w; j += 32) {
+            store_row(row + j, v, w - j < 32 ? w - j : 32);
+        }
+    }
+}
+
+static inline AVX2_ATTR uint32_t sum_u8(const uint8_t *p, uint32_t n) {
+    if (n >= 32) {
+        __m256i acc = _mm256_setzero_si256();
+        for (uint32_t k = 0; k < n; k += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)(p + k));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+        }
+        __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+        return (uint32_t)_mm_cvtsi128_si32(s);
+    }
+    __m128i v;
+    if (n == 16) {
+        v = _mm_loadu_si128((const __m128i *)(const void *)p);
+    } else if (n == 8) {
+        v = _mm_loadl_epi64((const __m128i *)(const void *)p);
+    } else {
+        int32_t v32;
+        memcpy(&v32, p, 4);
+        v = _mm_cvtsi32_si128(v32);
+    }
+    __m128i s = _mm_sad_epu8(v, _mm_setzero_si128());
+    s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+    return (uint32_t)_mm_cvtsi128_si32(s);
+}
+
+static AVX2_ATTR void pred_dc_avx2(uint8_t *dst,
+                                   ptrdiff_t stride,
+                                   const uint8_t *above,
+                                   const uint8_t *left,
+                                   uint32_t log2w,
+                                   uint32_t log2h,
+                                   const Av1IntraDir *dir) {
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint32_t sum = sum_u8(left, h) + sum_u8(above, w) + ((w + h) >> 1);
+    fill_rows(dst, stride, w, h, _mm256_set1_epi8((char)(sum / (w + h))));
+}
+
+static AVX2_ATTR void pred_dc_left_avx2(uint8_t *dst,
+                                        ptrdiff_t stride,
+                                        const uint8_t *above,
+                                        const uint8_t *left,
+                                        uint32_t log2w,
+                                        uint32_t log2h,
+                                        const Av1IntraDir *dir) {
+    (void)above;
+    (void)dir;
+    const uint32_t h = 1u << log2h;
+    const uint32_t v = (sum_u8(left, h) + (h >> 1)) >> log2h;
+    fill_rows(dst, stride, 1u << log2w, h, _mm256_set1_epi8((char)v));
+}
+
+static AVX2_ATTR void pred_dc_top_avx2(uint8_t *dst,
+                                       ptrdiff_t stride,
+                                       const uint8_t *above,
+                                       const uint8_t *left,
+                                       uint32_t log2w,
+                                       uint32_t log2h,
+                                       const Av1IntraDir *dir) {
+    (void)left;
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const uint32_t v = (sum_u8(above, w) + (w >> 1)) >> log2w;
+    fill_rows(dst, stride, w, 1u << log2h, _mm256_set1_epi8((char)v));
+}
+
+static AVX2_ATTR void pred_dc_128_avx2(uint8_t *dst,
+                                       ptrdiff_t stride,
+                                       const uint8_t *above,
+                                       const uint8_t *left,
+                                       uint32_t log2w,
+                                       uint32_t log2h,
+                                       const Av1IntraDir *dir) {
+    (void)above;
+    (void)left;
+    (void)dir;
+    fill_rows(dst, stride, 1u << log2w, 1u << log2h, _mm256_set1_epi8((char)128));
+}
+
+static AVX2_ATTR void pred_v_avx2(uint8_t *dst,
+                                  ptrdiff_t stride,
+                                  const uint8_t *above,
+                                  const uint8_t *left,
+                                  uint32_t log2w,
+                                  uint32_t log2h,
+                                  const Av1IntraDir *dir) {
+    (void)left;
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const __m256i a0 = _mm256_loadu_si256((const __m256i *)(const void *)above);
+    const __m256i a1 = _mm256_loadu_si256((const __m256i *)(const void *)(above + 32));
+    for (uint32_t i = 0; i < (1u << log2h); i++) {
+        uint8_t *row = dst + (ptrdiff_t)i * stride;
+        store_row(row, a0, w);
+        if (w == 64) {
+            store_row(row + 32, a1, 32);
+        }
+    }
+}
+
+static AVX2_ATTR void pred_h_avx2(uint8_t *dst,
+                                  ptrdiff_t stride,
+                                  const uint8_t *above,
+                                  const uint8_t *left,
+                                  uint32_t log2w,
+                                  uint32_t log2h,
+                                  const Av1IntraDir *dir) {
+    (void)above;
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    for (uint32_t i = 0; i < (1u << log2h); i++) {
+        fill_rows(dst + (ptrdiff_t)i * stride, stride, w, 1, _mm256_set1_epi8((char)left[i]));
+    }
+}
+
+// 16 x uint16 -> 16 bytes in order, in the low 128 bits.
+static inline AVX2_ATTR __m256i pack16_u8(__m256i v) {
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+}
+
+// 8 x int32 (0..255) -> 8 bytes in order, in the low 64 bits.
+static inline AVX2_ATTR __m256i pack8_u8(__m256i v) {
+    v = _mm256_packus_epi32(v, v);
+    v = _mm256_packus_epi16(v, v);
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4));
+}
+
+static AVX2_ATTR void pred_paeth_avx2(uint8_t *dst,
+                                      ptrdiff_t stride,
+                                      const uint8_t *above,
+                                      const uint8_t *left,
+                                      uint32_t log2w,
+                                      uint32_t log2h,
+                                      const Av1IntraDir *dir) {
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const __m256i tl = _mm256_set1_epi16(above[-1]);
+    for (uint32_t j0 = 0; j0 < w; j0 += 16) {
+        const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(above + j0)));
+        // base - LeftCol[i] = AboveRow[j] - AboveRow[-1] does not depend on the row.
+        const __m256i p_left = _mm256_abs_epi16(_mm256_sub_epi16(a, tl));
+        for (uint32_t i = 0; i < (1u << log2h); i++) {
+            const __m256i l = _mm256_set1_epi16(left[i]);
+            const __m256i p_top = _mm256_abs_epi16(_mm256_sub_epi16(l, tl));
+            const __m256i p_top_left = _mm256_abs_epi16(_mm256_sub_epi16(_mm256_add_epi16(a, l), _mm256_add_epi16(tl, tl)));
+            // pLeft <= pTop && pLeft <= pTopLeft -> LeftCol; else pTop <= pTopLeft -> AboveRow.
+            const __m256i use_left =
+                _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpgt_epi16(p_left, p_top), _mm256_cmpgt_epi16(p_left, p_top_left)),
+                                    _mm256_set1_epi16(-1));
+            const __m256i use_top = _mm256_cmpgt_epi16(p_top, p_top_left);
+            __m256i v = _mm256_blendv_epi8(a, tl, use_top);
+            v = _mm256_blendv_epi8(v, l, use_left);
+            store_row(dst + (ptrdiff_t)i * stride + j0, pack16_u8(v), w - j0 < 16 ? w - j0 : 16);
+        }
+    }
+}
+
+static AVX2_ATTR void pred_smooth_avx2(uint8_t *dst,
+                                       ptrdiff_t stride,
+                                       const uint8_t *above,
+                                       const uint8_t *left,
+                                       uint32_t log2w,
+                                       uint32_t log2h,
+                                       const Av1IntraDir *dir) {
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint8_t *wx = av1_sm_weights + w;
+    const uint8_t *wy = av1_sm_weights + h;
+    const __m256i bottom = _mm256_set1_epi32(left[h - 1u]);
+    const __m256i right = _mm256_set1_epi32(above[w - 1u]);
+    const __m256i w256 = _mm256_set1_epi32(256);
+    for (uint32_t j0 = 0; j0 < w; j0 += 8) {
+        const __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)(above + j0)));
+        const __m256i wxv = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)(wx + j0)));
+        // Row-invariant part: ( 256 - wx[j] ) * AboveRow[w-1] + 256 (rounding).
+        const __m256i rterm = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(w256, wxv), right), w256);
+        for (uint32_t i = 0; i < h; i++) {
+            const __m256i wyv = _mm256_set1_epi32(wy[i]);
+            __m256i s = _mm256_mullo_epi32(wyv, a);
+            s = _mm256_add_epi32(s, _mm256_mullo_epi32(_mm256_sub_epi32(w256, wyv), bottom));
+            s = _mm256_add_epi32(s, _mm256_mullo_epi32(wxv, _mm256_set1_epi32(left[i])));
+            s = _mm256_srli_epi32(_mm256_add_epi32(s, rterm), 9);
+            store_row(dst + (ptrdiff_t)i * stride + j0, pack8_u8(s), w - j0 < 8 ? w - j0 : 8);
+        }
+    }
+}
+
+// SMOOTH_V / SMOOTH_H sums stay below 65536, so they run on 16 unsigned 16-bit lanes.
+static AVX2_ATTR void pred_smooth_v_avx2(uint8_t *dst,
+                                         ptrdiff_t stride,
+                                         const uint8_t *above,
+                                         const uint8_t *left,
+                                         uint32_t log2w,
+                                         uint32_t log2h,
+                                         const Av1IntraDir *dir) {
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint8_t *wy = av1_sm_weights + h;
+    const __m256i bottom = _mm256_set1_epi16(left[h - 1u]);
+    for (uint32_t j0 = 0; j0 < w; j0 += 16) {
+        const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(above + j0)));
+        for (uint32_t i = 0; i < h; i++) {
+            const __m256i wyv = _mm256_set1_epi16(wy[i]);
+            __m256i s = _mm256_mullo_epi16(wyv, a);
+            s = _mm256_add_epi16(s, _mm256_mullo_epi16(_mm256_sub_epi16(_mm256_set1_epi16(256), wyv), bottom));
+            s = _mm256_srli_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(128)), 8);
+            store_row(dst + (ptrdiff_t)i * stride + j0, pack16_u8(s), w - j0 < 16 ? w - j0 : 16);
+        }
+    }
+}
+
+static AVX2_ATTR void pred_smooth_h_avx2(uint8_t *dst,
+                                         ptrdiff_t stride,
+                                         const uint8_t *above,
+                                         const uint8_t *left,
+                                         uint32_t log2w,
+                                         uint32_t log2h,
+                                         const Av1IntraDir *dir) {
+    (void)dir;
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint8_t *wx = av1_sm_weights + w;
+    const __m256i right = _mm256_set1_epi16(above[w - 1u]);
+    for (uint32_t j0 = 0; j0 < w; j0 += 16) {
+        const __m256i wxv = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(wx + j0)));
+        const __m256i rterm = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(_mm256_set1_epi16(256), wxv), right),
+                                               _mm256_set1_epi16(128));
+        for (uint32_t i = 0; i < h; i++) {
+            __m256i s = _mm256_add_epi16(_mm256_mullo_epi16(wxv, _mm256_set1_epi16(left[i])), rterm);
+            s = _mm256_srli_epi16(s, 8);
+            store_row(dst + (ptrdiff_t)i * stride + j0, pack16_u8(s), w - j0 < 16 ? w - j0 : 16);
+        }
+    }
+}
+
+// Round2( E[ base ] * ( 32 - shift ) + E[ base + 1 ] * shift, 5 ) for 8 lanes. Gathers 4 bytes
+// at each base and uses the low two.
+static inline AVX2_ATTR __m256i dir_interp(const uint8_t *edge, __m256i base, __m256i shift) {
+    const __m256i g = _mm256_i32gather_epi32((const int *)(const void *)edge, base, 1);
+    const __m256i e0 = _mm256_and_si256(g, _mm256_set1_epi32(0xFF));
+    const __m256i e1 = _mm256_and_si256(_mm256_srli_epi32(g, 8), _mm256_set1_epi32(0xFF));
+    __m256i v = _mm256_mullo_epi32(e0, _mm256_sub_epi32(_mm256_set1_epi32(32), shift));
+    v = _mm256_add_epi32(v, _mm256_mullo_epi32(e1, shift));
+    return _mm256_srli_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(16)), 5);
+}
+
+// ( ( idx << upsample ) >> 1 ) & 0x1F per lane.
+static inline AVX2_ATTR __m256i dir_shift(__m256i idx, int32_t upsample) {
+    return _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(idx, upsample), 1), _mm256_set1_epi32(0x1F));
+}
+
+// Round2( E[ k ] * ( 32 - shift ) + E[ k + 1 ] * shift, 5 ) for k = 0..15 (products fit 16 bits).
+static inline AVX2_ATTR __m256i dir_interp16(const uint8_t *edge, __m256i shift) {
+    const __m256i e0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)edge));
+    const __m256i e1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(edge + 1)));
+    __m256i v = _mm256_mullo_epi16(e0, _mm256_sub_epi16(_mm256_set1_epi16(32), shift));
+    v = _mm256_add_epi16(v, _mm256_mullo_epi16(e1, shift));
+    return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(16)), 5);
+}
+
+static inline AVX2_ATTR void transpose16x16_u8(const __m128i *in, __m128i *out) {
+    __m128i b[16];
+    __m128i c[16];
+    for (int k = 0; k < 8; k++) {
+        b[k] = _mm_unpacklo_epi8(in[2 * k], in[2 * k + 1]);
+        b[k + 8] = _mm_unpackhi_epi8(in[2 * k], in[2 * k + 1]);
+    }
+    // c[4q + k]: columns 4q..4q+3, rows 4k..4k+3.
+    for (int g = 0; g < 2; g++) {
+        for (int k = 0; k < 4; k++) {
+            c[g * 8 + k] = _mm_unpacklo_epi16(b[g * 8 + 2 * k], b[g * 8 + 2 * k + 1]);
+            c[g * 8 + 4 + k] = _mm_unpackhi_epi16(b[g * 8 + 2 * k], b[g * 8 + 2 * k + 1]);
+        }
+    }
+    for (int q = 0; q < 4; q++) {
+        const __m128i d0 = _mm_unpacklo_epi32(c[4 * q], c[4 * q + 1]);
+        const __m128i d1 = _mm_unpackhi_epi32(c[4 * q], c[4 * q + 1]);
+        const __m128i d2 = _mm_unpacklo_epi32(c[4 * q + 2], c[4 * q + 3]);
+        const __m128i d3 = _mm_unpackhi_epi32(c[4 * q + 2], c[4 * q + 3]);
+        out[4 * q] = _mm_unpacklo_epi64(d0, d2);
+        out[4 * q + 1] = _mm_unpackhi_epi64(d0, d2);
+        out[4 * q + 2] = _mm_unpacklo_epi64(d1, d3);
+        out[4 * q + 3] = _mm_unpackhi_epi64(d1, d3);
+    }
+}
+
+// Gather offsets stay inside the edge buffers even for lanes whose result is discarded.
+static inline AVX2_ATTR __m256i clamp_edge_index(__m256i base) {
+    return _mm256_max_epi32(_mm256_min_epi32(base, _mm256_set1_epi32((int32_t)AV1_INTRA_EDGE_LEN - 4)),
+                            _mm256_set1_epi32(-2));
+}
+
+// Same three zones as pred_dir_c; 8 output pixels of one row per iteration.
+static AVX2_ATTR void pred_dir_avx2(uint8_t *dst,
+                                    ptrdiff_t stride,
+                                    const uint8_t *above,
+                                    const uint8_t *left,
+                                    uint32_t log2w,
+                                    uint32_t log2h,
+                                    const Av1IntraDir *dir) {
+    const int32_t w = 1 << log2w;
+    const int32_t h = 1 << log2h;
+    const int32_t p_angle = dir->p_angle;
+    const int32_t ua = dir->upsample_above;
+    const int32_t ul = dir->upsample_left;
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const uint32_t n = w < 8 ? (uint32_t)w : 8u;
+
+    if (p_angle < 90) {
+        const int32_t dx = av1_dr_intra_derivative[p_angle];
+        const int32_t max_base_x = (w + h - 1) << ua;
+        const __m256i max_base = _mm256_set1_epi32(max_base_x);
+        const __m256i fill = _mm256_set1_epi32(above[max_base_x]);
+        for (int32_t i = 0; i < h; i++) {
+            const int32_t idx = (i + 1) * dx;
+            if (ua == 0) {
+                // Consecutive j read consecutive AboveRow entries: plain loads, 16 pixels at a time.
+                const int32_t base0 = idx >> 6;
+                const __m256i shift16 = _mm256_set1_epi16((int16_t)((idx >> 1) & 0x1F));
+                const __m256i lane16 = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                for (int32_t j0 = 0; j0 < w; j0 += 16) {
+                    const uint32_t n16 = w - j0 < 16 ? (uint32_t)(w - j0) : 16u;
+                    uint8_t *out = dst + (ptrdiff_t)i * stride + j0;
+                    if (base0 + j0 >= max_base_x) {
+                        store_row(out, _mm256_set1_epi8((char)above[max_base_x]), n16);
+                        continue;
+                    }
+                    const __m256i in_range = _mm256_cmpgt_epi16(_mm256_set1_epi16((int16_t)(max_base_x - base0 - j0)), lane16);
+                    const __m256i v = dir_interp16(above + base0 + j0, shift16);
+                    const __m256i fill16 = _mm256_set1_epi16(above[max_base_x]);
+                    store_row(out, pack16_u8(_mm256_blendv_epi8(fill16, v, in_range)), n16);
+                }
+                continue;
+            }
+            const __m256i shift = _mm256_set1_epi32(((idx << ua) >> 1) & 0x1F);
+            for (int32_t j0 = 0; j0 < w; j0 += 8) {
+                const __m256i j = _mm256_add_epi32(lane, _mm256_set1_epi32(j0));
+                const __m256i base = _mm256_add_epi32(_mm256_set1_epi32(idx >> (6 - ua)), _mm256_slli_epi32(j, ua));
+                const __m256i in_range = _mm256_cmpgt_epi32(max_base, base);
+                const __m256i v = dir_interp(above, _mm256_min_epi32(base, max_base), shift);
+                store_row(dst + (ptrdiff_t)i * stride + j0, pack8_u8(_mm256_blendv_epi8(fill, v, in_range)), n);
+            }
+        }
+    } else if (p_angle < 180) {
+        const int32_t dx = av1_dr_intra_derivative[180 - p_angle];
+        const int32_t dy = av1_dr_intra_derivative[p_angle - 90];
+        if (ua == 0 && ul == 0) {
+            // 16x16 tiles: the LeftCol path is column-contiguous (transposed like zone 3), the
+            // AboveRow path row-contiguous; a byte blend picks per pixel. Lanes whose base lies
+            // below -AV1_INTRA_EDGE_PAD are never selected, so load offsets are clamped there.
+            const __m128i lane8 = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            const int32_t pad = -(int32_t)AV1_INTRA_EDGE_PAD;
+            for (int32_t j0 = 0; j0 < w; j0 += 16) {
+                const int32_t nc = w - j0 < 16 ? w - j0 : 16;
+                for (int32_t i0 = 0; i0 < h; i0 += 16) {
+                    const int32_t nr = h - i0 < 16 ? h - i0 : 16;
+                    __m128i rows[16];
+                    const bool all_above = j0 + ((-(i0 + nr) * dx) >> 6) >= -1;
+                    if (!all_above) {
+                        __m128i cols[16];
+                        for (int32_t jj = 0; jj < 16; jj++) {
+                            if (jj >= nc) {
+                                cols[jj] = _mm_setzero_si128();
+                                continue;
+                            }
+                            const int32_t off = -(j0 + jj + 1) * dy;
+                            const int32_t start = i0 + (off >> 6) < pad ? pad : i0 + (off >> 6);
+                            const __m256i v =
+                                dir_interp16(left + start, _mm256_set1_epi16((int16_t)((off >> 1) & 0x1F)));
+                            cols[jj] = _mm256_castsi256_si128(pack16_u8(v));
+                        }
+                        transpose16x16_u8(cols, rows);
+                    }
+                    for (int32_t r = 0; r < nr; r++) {
+                        const int32_t off = -(i0 + r + 1) * dx;
+                        const int32_t start = j0 + (off >> 6);
+                        const __m256i va = dir_interp16(above + (start < pad ? pad : start),
+                                                        _mm256_set1_epi16((int16_t)((off >> 1) & 0x1F)));
+                        __m128i out = _mm256_castsi256_si128(pack16_u8(va));
+                        if (!all_above) {
+                            const int32_t s8 = start < -32 ? -32 : (start > 0 ? 0 : start);
+                            const __m128i use_above =
+                                _mm_cmpgt_epi8(_mm_add_epi8(lane8, _mm_set1_epi8((char)s8)), _mm_set1_epi8(-2));
+                            out = _mm_blendv_epi8(rows[r], out, use_above);
+                        }
+                        store_row(dst + (ptrdiff_t)(i0 + r) * stride + j0, _mm256_castsi128_si256(out), (uint32_t)nc);
+                    }
+                }
+            }
+            return;
+        }
+        const __m256i min_base = _mm256_set1_epi32(-(1 << ua) - 1);
+        for (int32_t i = 0; i < h; i++) {
+            for (int32_t j0 = 0; j0 < w; j0 += 8) {
+                if (ua == 0 && j0 + ((-(i + 1) * dx) >> 6) >= -1) {
+                    // Every lane reads AboveRow, at consecutive positions: as in zone 1.
+                    const int32_t idx = (j0 << 6) - (i + 1) * dx;
+                    const __m256i v = dir_interp16(above + (idx >> 6), _mm256_set1_epi16((int16_t)((idx >> 1) & 0x1F)));
+                    store_row(dst + (ptrdiff_t)i * stride + j0, pack16_u8(v), n);
+                    continue;
+                }
+                const __m256i j = _mm256_add_epi32(lane, _mm256_set1_epi32(j0));
+                const __m256i idx_a = _mm256_sub_epi32(_mm256_slli_epi32(j, 6), _mm256_set1_epi32((i + 1) * dx));
+                const __m256i base_a = _mm256_srai_epi32(idx_a, 6 - ua);
+                const __m256i use_above = _mm256_cmpgt_epi32(base_a, min_base);
+                const __m256i idx_l = _mm256_sub_epi32(_mm256_set1_epi32(i << 6),
+                                                       _mm256_mullo_epi32(_mm256_add_epi32(j, _mm256_set1_epi32(1)),
+                                                                          _mm256_set1_epi32(dy)));
+                const __m256i base_l = _mm256_srai_epi32(idx_l, 6 - ul);
+                const __m256i va = dir_interp(above, clamp_edge_index(base_a), dir_shift(idx_a, ua));
+                const __m256i vl = dir_interp(left, clamp_edge_index(base_l), dir_shift(idx_l, ul));
+                store_row(dst + (ptrdiff_t)i * stride + j0, pack8_u8(_mm256_blendv_epi8(vl, va, use_above)), n);
+            }
+        }
+    } else {
+        const int32_t dy = av1_dr_intra_derivative[270 - p_angle];
+        if (ul == 0) {
+            // Each column reads consecutive LeftCol entries: predict 16x16 tiles column-wise with
+            // plain loads, then transpose them into place.
+            for (int32_t j0 = 0; j0 < w; j0 += 16) {
+                const int32_t nc = w - j0 < 16 ? w - j0 : 16;
+                for (int32_t i0 = 0; i0 < h; i0 += 16) {
+                    const int32_t nr = h - i0 < 16 ? h - i0 : 16;
+                    __m128i cols[16];
+                    __m128i rows[16];
+                    for (int32_t jj = 0; jj < 16; jj++) {
+                        if (jj >= nc) {
+                            cols[jj] = _mm_setzero_si128();
+                            continue;
+                        }
+                        const int32_t idx = (j0 + jj + 1) * dy;
+                        const __m256i v =
+                            dir_interp16(left + (idx >> 6) + i0, _mm256_set1_epi16((int16_t)((idx >> 1) & 0x1F)));
+                        cols[jj] = _mm256_castsi256_si128(pack16_u8(v));
+                    }
+                    transpose16x16_u8(cols, rows);
+                    for (int32_t r = 0; r < nr; r++) {
+                        store_row(dst + (ptrdiff_t)(i0 + r) * stride + j0, _mm256_castsi128_si256(rows[r]), (uint32_t)nc);
+                    }
+                }
+            }
+            return;
+        }
+        for (int32_t j0 = 0; j0 < w; j0 += 8) {
+            const __m256i j = _mm256_add_epi32(lane, _mm256_set1_epi32(j0));
+            const __m256i idx = _mm256_mullo_epi32(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(dy));
+            const __m256i shift = dir_shift(idx, ul);
+            const __m256i base0 = _mm256_srai_epi32(idx, 6 - ul);
+            for (int32_t i = 0; i < h; i++) {
+                const __m256i base = _mm256_add_epi32(base0, _mm256_set1_epi32(i << ul));
+                const __m256i v = dir_interp(left, clamp_edge_index(base), shift);
+                store_row(dst + (ptrdiff_t)i * stride + j0, pack8_u8(v), n);
+            }
+        }
+    }
+}
+
+// ---- Filter-intra ----
+
+// Round2Signed( v, 4 ) then Clip1 of the packed result (both 128-bit lanes).
+static inline AVX2_ATTR __m256i filter_intra_round(__m256i v) {
+    const __m256i mag = _mm256_srli_epi16(_mm256_add_epi16(_mm256_abs_epi16(v), _mm256_set1_epi16(8)), 4);
+    return _mm256_packus_epi16(_mm256_sign_epi16(mag, v), _mm256_setzero_si256());
+}
+
+// The seven neighbours p[ 0..6 ] of the 4x2 unit (i2, j4), with p[ 7 ] = 0, from the work buffer
+// (see filter_intra_avx2), duplicated into both 64-bit halves.
+static inline AVX2_ATTR __m128i filter_intra_p(const uint8_t *b, size_t bstride, uint32_t i2, uint32_t j4) {
+    // Row 2 * i2 - 1 and column 4 * j4 - 1 of the block live at b[ 2 * i2 ][ 4 * j4 ].
+    const uint8_t *top = b + (size_t)(2u * i2) * bstride + 4u * j4;
+    __m128i p = _mm_loadl_epi64((const __m128i *)(const void *)top);
+    p = _mm_insert_epi8(p, top[bstride], 5);
+    p = _mm_insert_epi8(p, top[2u * bstride], 6);
+    p = _mm_insert_epi8(p, 0, 7);
+    return _mm_unpacklo_epi64(p, p);
+}
+
+static inline AVX2_ATTR void filter_intra_store(uint8_t *b, size_t bstride, uint32_t i2, uint32_t j4, __m128i v) {
+    uint8_t *out = b + (size_t)(2u * i2 + 1u) * bstride + 4u * j4 + 1u;
+    const int32_t r0 = _mm_cvtsi128_si32(v);
+    const int32_t r1 = _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+    memcpy(out, &r0, 4);
+    memcpy(out + bstride, &r1, 4);
+}
+
+// Units on one anti-diagonal i2 + j4 only depend on the two previous diagonals, so the block is
+// walked in wavefront order with two units per 256-bit register (one per 128-bit lane). Each
+// unit is 8 outputs x 8 taps: maddubs (pixels x signed taps) plus two horizontal adds.
+static AVX2_ATTR void filter_intra_avx2(uint8_t *dst,
+                                        ptrdiff_t stride,
+                                        const uint8_t *above,
+                                        const uint8_t *left,
+                                        uint32_t log2w,
+                                        uint32_t log2h,
+                                        uint32_t filter_mode) {
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint32_t w4 = w >> 2;
+    const uint32_t h2 = h >> 1;
+
+    // Work buffer: b[ r + 1 ][ c + 1 ] holds pred[ r ][ c ], with AboveRow in row 0 and LeftCol in
+    // column 0 (the spec's p[] sources in one array).
+    enum { BSTRIDE = 48 };
+    uint8_t b[(32 + 1) * BSTRIDE];
+    memcpy(b, above - 1, w + 1u);
+    for (uint32_t i = 0; i < h; i++) {
+        b[(i + 1u) * BSTRIDE] = left[i];
+    }
+
+    int8_t taps[8][8];
+    for (uint32_t k = 0; k < 8; k++) {
+        memcpy(taps[k], av1_filter_intra_taps[filter_mode][k], 7);
+        taps[k][7] = 0;
+    }
+    __m256i t[4];
+    for (uint32_t k = 0; k < 4; k++) {
+        t[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)taps[2 * k]));
+    }
+
+    for (uint32_t d = 0; d + 1u < h2 + w4; d++) {
+        const uint32_t i2_lo = d >= w4 ? d - w4 + 1u : 0;
+        const uint32_t i2_hi = d < h2 - 1u ? d : h2 - 1u;
+        for (uint32_t i2 = i2_lo; i2 <= i2_hi; i2 += 2) {
+            const bool pair = i2 + 1u <= i2_hi;
+            const __m128i pa = filter_intra_p(b, BSTRIDE, i2, d - i2);
+            const __m128i pb = pair ? filter_intra_p(b, BSTRIDE, i2 + 1u, d - i2 - 1u) : pa;
+            const __m256i p = _mm256_inserti128_si256(_mm256_castsi128_si256(pa), pb, 1);
+            const __m256i h0 = _mm256_hadd_epi16(_mm256_maddubs_epi16(p, t[0]), _mm256_maddubs_epi16(p, t[1]));
+            const __m256i h1 = _mm256_hadd_epi16(_mm256_maddubs_epi16(p, t[2]), _mm256_maddubs_epi16(p, t[3]));
+            const __m256i v = filter_intra_round(_mm256_hadd_epi16(h0, h1));
+            filter_intra_store(b, BSTRIDE, i2, d - i2, _mm256_castsi256_si128(v));
+            if (pair) {
+                filter_intra_store(b, BSTRIDE, i2 + 1u, d - i2 - 1u, _mm256_extracti128_si256(v, 1));
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < h; i++) {
+        memcpy(dst + (ptrdiff_t)i * stride, b + (i + 1u) * BSTRIDE + 1u, w);
+    }
+}
+
+// ---- Intra edge filter / upsample ----
+
+static AVX2_ATTR void edge_filter_avx2(uint8_t *edge, uint32_t sz, uint32_t strength) {
+    // ext[ k + 2 ] = edge[ Clip3( 0, sz - 1, k ) ], padded for whole 16-sample loads.
+    uint8_t ext[AV1_INTRA_EDGE_LEN + 2u + 32u];
+    ext[0] = edge[0];
+    ext[1] = edge[0];
+    memcpy(ext + 2, edge, sz);
+    memset(ext + 2 + sz, edge[sz - 1u], sizeof(ext) - 2u - sz);
+
+    static const int16_t kTaps[3][3] = {{0, 4, 8}, {0, 5, 6}, {2, 4, 4}}; // symmetric 5-tap halves
+    const __m256i k0 = _mm256_set1_epi16(kTaps[strength - 1u][0]);
+    const __m256i k1 = _mm256_set1_epi16(kTaps[strength - 1u][1]);
+    const __m256i k2 = _mm256_set1_epi16(kTaps[strength - 1u][2]);
+    for (uint32_t i0 = 1; i0 < sz; i0 += 16) {
+        __m256i e[5];
+        for (int j = 0; j < 5; j++) {
+            e[j] = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(ext + i0 + j)));
+        }
+        __m256i s = _mm256_mullo_epi16(k0, _mm256_add_epi16(e[0], e[4]));
+        s = _mm256_add_epi16(s, _mm256_mullo_epi16(k1, _mm256_add_epi16(e[1], e[3])));
+        s = _mm256_add_epi16(s, _mm256_mullo_epi16(k2, e[2]));
+        s = _mm256_srli_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(8)), 4);
+        const __m128i out = _mm256_castsi256_si128(pack16_u8(s));
+        if (sz - i0 >= 16) {
+            _mm_storeu_si128((__m128i *)(void *)(edge + i0), out);
+        } else {
+            uint8_t tmp[16];
+            _mm_storeu_si128((__m128i *)(void *)tmp, out);
+            memcpy(edge + i0, tmp, sz - i0);
+        }
+    }
+}
+
+static AVX2_ATTR void edge_upsample_avx2(uint8_t *buf, uint32_t num_px) {
+    // dup[ k ] for k = 0..31 straight from buf[ k - 2 ]: dup[ 0 ] is buf[ -1 ] and entries past
+    // dup[ num_px + 1 ] repeat buf[ num_px - 1 ].
+    const __m256i k = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
+                                       23, 24, 25, 26, 27, 28, 29, 30, 31);
+    __m256i dup = _mm256_loadu_si256((const __m256i *)(const void *)(buf - 2));
+    dup = _mm256_blendv_epi8(dup, _mm256_set1_epi8((char)buf[num_px - 1u]), _mm256_cmpgt_epi8(k, _mm256_set1_epi8((char)(num_px + 1u))));
+    dup = _mm256_blendv_epi8(dup, _mm256_set1_epi8((char)buf[-1]), _mm256_cmpeq_epi8(k, _mm256_setzero_si256()));
+    const __m128i lo = _mm256_castsi256_si128(dup);
+    const __m128i hi = _mm256_extracti128_si256(dup, 1);
+
+    // -dup[ i ] + 9 * dup[ i + 1 ] + 9 * dup[ i + 2 ] - dup[ i + 3 ], Round2( , 4 ), Clip1.
+    const __m256i d0 = _mm256_cvtepu8_epi16(lo);
+    const __m256i d1 = _mm256_cvtepu8_epi16(_mm_alignr_epi8(hi, lo, 1));
+    const __m256i d2 = _mm256_cvtepu8_epi16(_mm_alignr_epi8(hi, lo, 2));
+    const __m256i d3 = _mm256_cvtepu8_epi16(_mm_alignr_epi8(hi, lo, 3));
+    __m256i s = _mm256_mullo_epi16(_mm256_add_epi16(d1, d2), _mm256_set1_epi16(9));
+    s = _mm256_sub_epi16(s, _mm256_add_epi16(d0, d3));
+    s = _mm256_srai_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(8)), 4);
+    const __m128i filtered = _mm256_castsi256_si128(pack16_u8(s));
+    const __m128i orig = _mm_alignr_epi8(hi, lo, 2);
+
+    // buf[ 2i - 1 ] = filtered[ i ], buf[ 2i ] = dup[ i + 2 ]; bytes past buf[ 2 * num_px - 2 ]
+    // are written back unchanged.
+    const __m256i out = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(filtered, orig)),
+                                                _mm_unpackhi_epi8(filtered, orig), 1);
+    const __m256i keep = _mm256_loadu_si256((const __m256i *)(const void *)(buf - 1));
+    const __m256i in_range = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(2u * num_px)), k);
+    buf[-2] = (uint8_t)_mm_extract_epi8(lo, 0);
+    _mm256_storeu_si256((__m256i *)(void *)(buf - 1), _mm256_blendv_epi8(keep, out, in_range));
+}
+
+bool av1_intra_pred_dsp_init_avx2(Av1IntraPredDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->pred[AV1_IPRED_DC] = pred_dc_avx2;
+    dsp->pred[AV1_IPRED_DC_LEFT] = pred_dc_left_avx2;
+    dsp->pred[AV1_IPRED_DC_TOP] = pred_dc_top_avx2;
+    dsp->pred[AV1_IPRED_DC_128] = pred_dc_128_avx2;
+    dsp->pred[AV1_IPRED_V] = pred_v_avx2;
+    dsp->pred[AV1_IPRED_H] = pred_h_avx2;
+    dsp->pred[AV1_IPRED_PAETH] = pred_paeth_avx2;
+    dsp->pred[AV1_IPRED_SMOOTH] = pred_smooth_avx2;
+    dsp->pred[AV1_IPRED_SMOOTH_V] = pred_smooth_v_avx2;
+    dsp->pred[AV1_IPRED_SMOOTH_H] = pred_smooth_h_avx2;
+    dsp->pred[AV1_IPRED_DIR] = pred_dir_avx2;
+    dsp->filter_intra = filter_intra_avx2;
+    dsp->edge_filter = edge_filter_avx2;
+    dsp->edge_upsample = edge_upsample_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_intra_pred.c uses the scalar reference.
+typedef int av1_intra_pred_x86_unused;
+
+#endif
@@ -0,0 +1,128 @@
+#include "av1_intrabc.h"
+
+#include <string.h>
+
+void av1_intrabc_default_dv(const Av1IntrabcBlock *b, int32_t dv[2]) {
+    const int32_t sb_size4 = b->use_128x128_superblock ? 32 : 16;
+    if ((int32_t)b->mi_row - sb_size4 < (int32_t)b->mi_row_start) {
+        dv[0] = 0;
+        dv[1] = -(sb_size4 * 4 + AV1_INTRABC_DELAY_PIXELS) * 8;
+    } else {
+        dv[0] = -(sb_size4 * 4 * 8);
+        dv[1] = 0;
+    }
+}
+
+bool av1_intrabc_dv_valid(const Av1IntrabcBlock *b, const int32_t dv[2]) {
+    for (uint32_t comp = 0; comp < 2u; comp++) {
+        if (dv[comp] >= (1 << 14) || dv[comp] <= -(1 << 14) || (dv[comp] & 7)) {
+            return false;
+        }
+    }
+    const int32_t src_top = (int32_t)(b->mi_row * 4u) + (dv[0] >> 3);
+    const int32_t src_left = (int32_t)(b->mi_col * 4u) + (dv[1] >> 3);
+    const int32_t src_bottom = src_top + (int32_t)b->bh;
+    const int32_t src_right = src_left + (int32_t)b->bw;
+    // A sub-8x8 block with chroma also predicts the chroma of the block to its left / above.
+    const int32_t src_top_c = src_top - ((b->has_chroma && b->bh < 8u && b->subsampling_y) ? 4 : 0);
+    const int32_t src_left_c = src_left - ((b->has_chroma && b->bw < 8u && b->subsampling_x) ? 4 : 0);
+    if (src_top_c < (int32_t)(b->mi_row_start * 4u) || src_left_c < (int32_t)(b->mi_col_start * 4u) ||
+        src_bottom > (int32_t)(b->mi_row_end * 4u) || src_right > (int32_t)(b->mi_col_end * 4u)) {
+        return false;
+    }
+
+    const int32_t sb_h = b->use_128x128_superblock ? 128 : 64;
+    const int32_t active_sb_row = (int32_t)(b->mi_row * 4u) / sb_h;
+    const int32_t active_sb64_col = (int32_t)(b->mi_col * 4u) >> 6;
+    const int32_t src_sb_row = (src_bottom - 1) / sb_h;
+    const int32_t src_sb64_col = (src_right - 1) >> 6;
+    const int32_t total_sb64_per_row = (int32_t)((b->mi_col_end - b->mi_col_start - 1u) >> 4) + 1;
+    const int32_t active_sb64 = active_sb_row * total_sb64_per_row + active_sb64_col;
+    const int32_t src_sb64 = src_sb_row * total_sb64_per_row + src_sb64_col;
+    if (src_sb64 >= active_sb64 - (int32_t)AV1_INTRABC_DELAY_SB64) {
+        return false;
+    }
+    const int32_t gradient = 1 + (int32_t)AV1_INTRABC_DELAY_SB64 + (int32_t)b->use_128x128_superblock;
+    const int32_t wf_offset = gradient * (active_sb_row - src_sb_row);
+    return src_sb_row <= active_sb_row && src_sb64_col < active_sb64_col - (int32_t)AV1_INTRABC_DELAY_SB64 + wf_offset;
+}
+
+static void copy_c(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        memcpy(dst, src, w);
+    }
+}
+
+static void copy_h_c(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint8_t)((src[x] + src[x + 1u] + 1u) >> 1);
+        }
+    }
+}
+
+static void copy_v_c(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint8_t)((src[x] + src[x + src_stride] + 1u) >> 1);
+        }
+    }
+}
+
+static void copy_hv_c(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        const uint8_t *s1 = src + src_stride;
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint8_t)((src[x] + src[x + 1u] + s1[x] + s1[x + 1u] + 2u) >> 2);
+        }
+    }
+}
+
+static void copy16_c(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        memcpy(dst, src, (size_t)w * sizeof(uint16_t));
+    }
+}
+
+static void copy16_h_c(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint16_t)((src[x] + src[x + 1u] + 1u) >> 1);
+        }
+    }
+}
+
+static void copy16_v_c(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint16_t)((src[x] + src[x + src_stride] + 1u) >> 1);
+        }
+    }
+}
+
+static void copy16_hv_c(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        const uint16_t *s1 = src + src_stride;
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint16_t)((src[x] + src[x + 1u] + s1[x] + s1[x + 1u] + 2u) >> 2);
+        }
+    }
+}
+
+void av1_intrabc_dsp_init_c(Av1IntrabcDsp *dsp) {
+    dsp->copy[AV1_INTRABC_PHASE(0, 0)] = copy_c;
+    dsp->copy[AV1_INTRABC_PHASE(0, 1)] = copy_h_c;
+    dsp->copy[AV1_INTRABC_PHASE(1, 0)] = copy_v_c;
+    dsp->copy[AV1_INTRABC_PHASE(1, 1)] = copy_hv_c;
+    dsp->copy16[AV1_INTRABC_PHASE(0, 0)] = copy16_c;
+    dsp->copy16[AV1_INTRABC_PHASE(0, 1)] = copy16_h_c;
+    dsp->copy16[AV1_INTRABC_PHASE(1, 0)] = copy16_v_c;
+    dsp->copy16[AV1_INTRABC_PHASE(1, 1)] = copy16_hv_c;
+}
+
+void av1_intrabc_dsp_init(Av1IntrabcDsp *dsp) {
+    av1_intrabc_dsp_init_c(dsp);
+#if defined(AV1_INTRABC_HAVE_X86)
+    (void)av1_intrabc_dsp_init_avx2(dsp);
+#endif
+}
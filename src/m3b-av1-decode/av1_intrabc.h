@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Intra block copy (spec 5.11.26 assign_mv() with use_intrabc, is_mv_valid() in the read mv
+// semantics, and 7.11.3 "Inter prediction process" with refIdx == -1, see local
+// av1bitstream.html).
+//
+// av1_decode_tile.c reads use_intrabc and the displacement vector (DV); this module holds the
+// parts that do not touch the symbol decoder:
+// - av1_intrabc_default_dv() is the PredMv fallback of assign_mv() when the ref MV stack is empty.
+// - av1_intrabc_dv_valid() is is_mv_valid() for use_intrabc == 1: the source block must lie in
+//   the tile, in an already decoded superblock at least INTRABC_DELAY_SB64 64x64 units behind
+//   the current one, and inside the wavefront a pipelined decoder allows for earlier SB rows.
+// - Av1IntrabcDsp copies the prediction out of the frame being decoded. Luma DVs are whole
+//   samples, so luma is a plain copy; a subsampled chroma plane can land half-way between
+//   samples, where the BILINEAR filter with InterRound0 / InterRound1 reduces exactly to
+//   rounded averages of 2 or 4 neighbors for every BitDepth. The kernels are indexed by
+//   AV1_INTRABC_PHASE( half_y, half_x ) and the AVX2 ones in av1_intrabc_x86.c copy up to 32
+//   bytes per load / store.
+
+#define AV1_INTRABC_DELAY_SB64 4u    // INTRABC_DELAY_SB64
+#define AV1_INTRABC_DELAY_PIXELS 256 // INTRABC_DELAY_PIXELS
+#define AV1_INTRABC_MAX_DIM 128u
+
+// The block a DV belongs to, in frame coordinates.
+typedef struct {
+    uint32_t mi_row; // MiRow
+    uint32_t mi_col; // MiCol
+    uint32_t bw;     // Block_Width[ MiSize ] (luma samples)
+    uint32_t bh;     // Block_Height[ MiSize ]
+
+    // Tile bounds (MiRowStart, MiRowEnd, MiColStart, MiColEnd).
+    uint32_t mi_row_start;
+    uint32_t mi_row_end;
+    uint32_t mi_col_start;
+    uint32_t mi_col_end;
+
+    uint32_t use_128x128_superblock;
+    bool has_chroma; // HasChroma
+    uint32_t subsampling_x;
+    uint32_t subsampling_y;
+} Av1IntrabcBlock;
+
+// The PredMv[ 0 ] of assign_mv() when RefStackMv[ 0 ] and [ 1 ] are both zero: one superblock
+// up, or (in the first SB row of the tile) one superblock plus INTRABC_DELAY_PIXELS to the left.
+// dv[ 0 ] is the row, dv[ 1 ] the column, in 1/8 luma samples.
+void av1_intrabc_default_dv(const Av1IntrabcBlock *b, int32_t dv[2]);
+
+// is_mv_valid( 0 ) with use_intrabc == 1.
+bool av1_intrabc_dv_valid(const Av1IntrabcBlock *b, const int32_t dv[2]);
+
+#define AV1_INTRABC_PHASE(half_y, half_x) ((uint32_t)(half_y) << 1 | (uint32_t)(half_x))
+
+// Splits one DV component (1/8 luma samples, a multiple of 8) for a plane subsampled by sub:
+// returns the whole-sample offset and sets *half when the position is half-way to the next
+// sample. This is ( 2 * mv ) >> sub of the motion vector scaling process at 1/16 precision.
+static inline int32_t av1_intrabc_plane_offset(int32_t mv, uint32_t sub, uint32_t *half) {
+    const int32_t pos16 = (2 * mv) >> sub;
+    *half = (pos16 & 15) != 0;
+    return pos16 >> 4;
+}
+
+// dst[ i ][ j ] for a w x h block (w a power of two in 4..128, h in 1..128) from src at the
+// block's top-left source sample:
+//   phase 0: src[ i ][ j ]
+//   phase 1: ( src[ i ][ j ] + src[ i ][ j + 1 ] + 1 ) >> 1
+//   phase 2: ( src[ i ][ j ] + src[ i + 1 ][ j ] + 1 ) >> 1
+//   phase 3: ( src[ i ][ j ] + src[ i ][ j + 1 ] + src[ i + 1 ][ j ] + src[ i + 1 ][ j + 1 ] + 2 ) >> 2
+// Half-sample phases read one column / row past the block; the caller clamps the source to the
+// plane (the spec's Clip3( 0, lastX / lastY ) edge replication). dst and src must not overlap,
+// which a valid DV guarantees.
+typedef void (*Av1IntrabcCopyFn)(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h);
+typedef void (*Av1IntrabcCopyFn16)(uint16_t *dst,
+                                   ptrdiff_t dst_stride,
+                                   const uint16_t *src,
+                                   ptrdiff_t src_stride,
+                                   uint32_t w,
+                                   uint32_t h);
+
+typedef struct {
+    Av1IntrabcCopyFn copy[4];     // BitDepth 8, by AV1_INTRABC_PHASE
+    Av1IntrabcCopyFn16 copy16[4]; // BitDepth 10 / 12
+} Av1IntrabcDsp;
+
+// Scalar reference table.
+void av1_intrabc_dsp_init_c(Av1IntrabcDsp *dsp);
+
+// Best table for the running CPU.
+void av1_intrabc_dsp_init(Av1IntrabcDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_INTRABC_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_intrabc_dsp_init_avx2(Av1IntrabcDsp *dsp);
+#endif
@@ -0,0 +1,195 @@
+#include "av1_intrabc.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 intra block copy, bit-exact with the scalar reference in av1_intrabc.c.
+//
+// Rows are moved with the widest load / store the block width allows (4, 8, 16 or 32 bytes), so a
+// 64-wide 8-bit row is two loads and two stores. The 2-tap half-sample phases use pavgb / pavgw,
+// which compute ( a + b + 1 ) >> 1 exactly; the 4-tap phase widens to 16 bits (at most
+// 4 * 4095 + 2 for BitDepth 12, so words never overflow). Functions carry a target attribute so
+// the file builds with the default CFLAGS; av1_intrabc_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_INTRABC_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+static AVX2_ATTR inline __m128i load4(const void *p) {
+    int32_t v;
+    memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+static AVX2_ATTR inline void store4(void *p, __m128i v) {
+    const int32_t x = _mm_cvtsi128_si32(v);
+    memcpy(p, &x, 4);
+}
+
+static AVX2_ATTR inline __m128i loadu128(const void *p) {
+    return _mm_loadu_si128((const __m128i *)p);
+}
+
+static AVX2_ATTR inline __m256i loadu256(const void *p) {
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+// phase 0 / 1 / 2: dst = src, or the rounded average of src and src + off (off = 1 for the
+// horizontal half sample, the row stride for the vertical one).
+static AVX2_ATTR void copy_avg2_8(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, ptrdiff_t off, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        if (w == 4u) {
+            const __m128i a = load4(src);
+            store4(dst, off ? _mm_avg_epu8(a, load4(src + off)) : a);
+        } else if (w == 8u) {
+            const __m128i a = _mm_loadl_epi64((const __m128i *)(const void *)src);
+            const __m128i v = off ? _mm_avg_epu8(a, _mm_loadl_epi64((const __m128i *)(const void *)(src + off))) : a;
+            _mm_storel_epi64((__m128i *)(void *)dst, v);
+        } else if (w == 16u) {
+            const __m128i a = loadu128(src);
+            _mm_storeu_si128((__m128i *)(void *)dst, off ? _mm_avg_epu8(a, loadu128(src + off)) : a);
+        } else {
+            for (uint32_t x = 0; x < w; x += 32) {
+                const __m256i a = loadu256(src + x);
+                _mm256_storeu_si256((__m256i *)(void *)(dst + x), off ? _mm256_avg_epu8(a, loadu256(src + x + off)) : a);
+            }
+        }
+    }
+}
+
+static AVX2_ATTR void copy_avx2(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    copy_avg2_8(dst, dst_stride, src, src_stride, 0, w, h);
+}
+
+static AVX2_ATTR void copy_h_avx2(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    copy_avg2_8(dst, dst_stride, src, src_stride, 1, w, h);
+}
+
+static AVX2_ATTR void copy_v_avx2(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    copy_avg2_8(dst, dst_stride, src, src_stride, src_stride, w, h);
+}
+
+static AVX2_ATTR void copy_hv_avx2(uint8_t *dst, ptrdiff_t dst_stride, const uint8_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    const __m128i two = _mm_set1_epi16(2);
+    const __m256i two256 = _mm256_set1_epi16(2);
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        const uint8_t *s1 = src + src_stride;
+        if (w <= 8u) {
+            __m128i a, b, c, d;
+            if (w == 4u) {
+                a = load4(src);
+                b = load4(src + 1);
+                c = load4(s1);
+                d = load4(s1 + 1);
+            } else {
+                a = _mm_loadl_epi64((const __m128i *)(const void *)src);
+                b = _mm_loadl_epi64((const __m128i *)(const void *)(src + 1));
+                c = _mm_loadl_epi64((const __m128i *)(const void *)s1);
+                d = _mm_loadl_epi64((const __m128i *)(const void *)(s1 + 1));
+            }
+            __m128i sum = _mm_add_epi16(_mm_cvtepu8_epi16(a), _mm_cvtepu8_epi16(b));
+            sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_cvtepu8_epi16(c), _mm_cvtepu8_epi16(d)));
+            const __m128i px = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(sum, two), 2), _mm_setzero_si128());
+            if (w == 4u) {
+                store4(dst, px);
+            } else {
+                _mm_storel_epi64((__m128i *)(void *)dst, px);
+            }
+            continue;
+        }
+        for (uint32_t x = 0; x < w; x += 16) {
+            __m256i sum = _mm256_add_epi16(_mm256_cvtepu8_epi16(loadu128(src + x)), _mm256_cvtepu8_epi16(loadu128(src + x + 1)));
+            sum = _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_cvtepu8_epi16(loadu128(s1 + x)), _mm256_cvtepu8_epi16(loadu128(s1 + x + 1))));
+            sum = _mm256_srli_epi16(_mm256_add_epi16(sum, two256), 2);
+            const __m128i px = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            _mm_storeu_si128((__m128i *)(void *)(dst + x), px);
+        }
+    }
+}
+
+static AVX2_ATTR void copy_avg2_16(uint16_t *dst,
+                                   ptrdiff_t dst_stride,
+                                   const uint16_t *src,
+                                   ptrdiff_t src_stride,
+                                   ptrdiff_t off,
+                                   uint32_t w,
+                                   uint32_t h) {
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        if (w == 4u) {
+            const __m128i a = _mm_loadl_epi64((const __m128i *)(const void *)src);
+            const __m128i v = off ? _mm_avg_epu16(a, _mm_loadl_epi64((const __m128i *)(const void *)(src + off))) : a;
+            _mm_storel_epi64((__m128i *)(void *)dst, v);
+        } else if (w == 8u) {
+            const __m128i a = loadu128(src);
+            _mm_storeu_si128((__m128i *)(void *)dst, off ? _mm_avg_epu16(a, loadu128(src + off)) : a);
+        } else {
+            for (uint32_t x = 0; x < w; x += 16) {
+                const __m256i a = loadu256(src + x);
+                _mm256_storeu_si256((__m256i *)(void *)(dst + x), off ? _mm256_avg_epu16(a, loadu256(src + x + off)) : a);
+            }
+        }
+    }
+}
+
+static AVX2_ATTR void copy16_avx2(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    if (w < 16u) {
+        copy_avg2_16(dst, dst_stride, src, src_stride, 0, w, h);
+        return;
+    }
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        for (uint32_t x = 0; x < w; x += 16) {
+            _mm256_storeu_si256((__m256i *)(void *)(dst + x), loadu256(src + x));
+        }
+    }
+}
+
+static AVX2_ATTR void copy16_h_avx2(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    copy_avg2_16(dst, dst_stride, src, src_stride, 1, w, h);
+}
+
+static AVX2_ATTR void copy16_v_avx2(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    copy_avg2_16(dst, dst_stride, src, src_stride, src_stride, w, h);
+}
+
+static AVX2_ATTR void copy16_hv_avx2(uint16_t *dst, ptrdiff_t dst_stride, const uint16_t *src, ptrdiff_t src_stride, uint32_t w, uint32_t h) {
+    const __m128i two = _mm_set1_epi16(2);
+    const __m256i two256 = _mm256_set1_epi16(2);
+    for (uint32_t y = 0; y < h; y++, dst += dst_stride, src += src_stride) {
+        const uint16_t *s1 = src + src_stride;
+        if (w == 4u) {
+            __m128i sum = _mm_add_epi16(_mm_loadl_epi64((const __m128i *)(const void *)src), _mm_loadl_epi64((const __m128i *)(const void *)(src + 1)));
+            sum = _mm_add_epi16(sum, _mm_loadl_epi64((const __m128i *)(const void *)s1));
+            sum = _mm_add_epi16(sum, _mm_loadl_epi64((const __m128i *)(const void *)(s1 + 1)));
+            _mm_storel_epi64((__m128i *)(void *)dst, _mm_srli_epi16(_mm_add_epi16(sum, two), 2));
+        } else if (w == 8u) {
+            __m128i sum = _mm_add_epi16(loadu128(src), loadu128(src + 1));
+            sum = _mm_add_epi16(sum, _mm_add_epi16(loadu128(s1), loadu128(s1 + 1)));
+            _mm_storeu_si128((__m128i *)(void *)dst, _mm_srli_epi16(_mm_add_epi16(sum, two), 2));
+        } else {
+            for (uint32_t x = 0; x < w; x += 16) {
+                __m256i sum = _mm256_add_epi16(loadu256(src + x), loadu256(src + x + 1));
+                sum = _mm256_add_epi16(sum, _mm256_add_epi16(loadu256(s1 + x), loadu256(s1 + x + 1)));
+                _mm256_storeu_si256((__m256i *)(void *)(dst + x), _mm256_srli_epi16(_mm256_add_epi16(sum, two256), 2));
+            }
+        }
+    }
+}
+
+bool av1_intrabc_dsp_init_avx2(Av1IntrabcDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->copy[AV1_INTRABC_PHASE(0, 0)] = copy_avx2;
+    dsp->copy[AV1_INTRABC_PHASE(0, 1)] = copy_h_avx2;
+    dsp->copy[AV1_INTRABC_PHASE(1, 0)] = copy_v_avx2;
+    dsp->copy[AV1_INTRABC_PHASE(1, 1)] = copy_hv_avx2;
+    dsp->copy16[AV1_INTRABC_PHASE(0, 0)] = copy16_avx2;
+    dsp->copy16[AV1_INTRABC_PHASE(0, 1)] = copy16_h_avx2;
+    dsp->copy16[AV1_INTRABC_PHASE(1, 0)] = copy16_v_avx2;
+    dsp->copy16[AV1_INTRABC_PHASE(1, 1)] = copy16_hv_avx2;
+    return true;
+}
+
+#endif
@@ -0,0 +1,536 @@
+#include "av1_inv_txfm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Tx_Width_Log2 / Tx_Height_Log2 (spec tables), TxSize order as in av1_decode_tile.c.
+static const uint8_t kTxfmWidthLog2[AV1_TXFM_TX_SIZES_ALL] = {
+    2, 3, 4, 5, 6, 2, 3, 3, 4, 4, 5, 5, 6, 2, 4, 3, 5, 4, 6,
+};
+
+static const uint8_t kTxfmHeightLog2[AV1_TXFM_TX_SIZES_ALL] = {
+    2, 3, 4, 5, 6, 3, 2, 4, 3, 5, 4, 6, 5, 4, 2, 5, 3, 6, 4,
+};
+
+// Transform_Row_Shift (spec table).
+static const uint8_t kTransformRowShift[AV1_TXFM_TX_SIZES_ALL] = {
+    0, 1, 2, 2, 2, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2,
+};
+
+uint32_t av1_txfm_width_log2(uint32_t tx_size) {
+    return tx_size < AV1_TXFM_TX_SIZES_ALL ? kTxfmWidthLog2[tx_size] : 0u;
+}
+
+uint32_t av1_txfm_height_log2(uint32_t tx_size) {
+    return tx_size < AV1_TXFM_TX_SIZES_ALL ? kTxfmHeightLog2[tx_size] : 0u;
+}
+
+static int32_t round2_i64(int64_t x, uint32_t n) {
+    if (n == 0) {
+        return (int32_t)x;
+    }
+    return (int32_t)((x + ((int64_t)1 << (n - 1))) >> n);
+}
+
+static int32_t clamp_bits(int64_t x, uint32_t r) {
+    const int64_t lo = -((int64_t)1 << (r - 1));
+    const int64_t hi = ((int64_t)1 << (r - 1)) - 1;
+    return (int32_t)(x < lo ? lo : (x > hi ? hi : x));
+}
+
+// Scalar reference instantiation of the 1D transforms. Products and sums of B() and the ADST4
+// are computed in int64, so this build is exact for any input.
+#define TX_FN(name) name##_c
+#define TX_ATTR
+#define TX_T int32_t
+#define TX_W int64_t
+#define TX_MUL(v, c) ((int64_t)(v) * (c))
+#define TX_WADD(a, b) ((a) + (b))
+#define TX_WSUB(a, b) ((a) - (b))
+#define TX_ROUND12(x) round2_i64((x), 12)
+#define TX_ADD(a, b) ((int64_t)(a) + (b))
+#define TX_SUB(a, b) ((int64_t)(a) - (b))
+#define TX_CLAMP(v, r) clamp_bits((v), (r))
+#define TX_SRA(v, k) ((v) >> (k))
+#define TX_SHL(v, k) ((v) * (1 << (k)))
+#define TX_NEG(v) (-(v))
+#include "av1_inv_txfm_1d.inc"
+
+void av1_inv_dct1d(int32_t *t, uint32_t n, uint32_t r) {
+    dct_c(t, n, r);
+}
+
+void av1_inv_adst1d(int32_t *t, uint32_t n, uint32_t r) {
+    inv_1d_c(t, AV1_TXFM_1D_ADST, n, r, 0);
+}
+
+void av1_inv_wht1d(int32_t *t, uint32_t shift) {
+    wht_c(t, shift);
+}
+
+// Inverse identity transform 4/8/16/32 scaling (spec 7.13.2.11-14) for one value.
+static int32_t identity_scale(int32_t v, uint32_t n) {
+    switch (n) {
+    case 2:
+        return round2_i64((int64_t)v * 5793, 12);
+    case 3:
+        return v * 2;
+    case 4:
+        return round2_i64((int64_t)v * 11586, 12);
+    default:
+        return v * 4;
+    }
+}
+
+void av1_inv_identity1d(int32_t *t, uint32_t n) {
+    identity_c(t, n);
+}
+
+// Column (vertical) and row (horizontal) 1D kernel classes per TxType (spec 7.13.3).
+static void txfm_1d_classes(uint32_t tx_type, uint32_t *col, uint32_t *row) {
+    switch (tx_type) {
+    case AV1_TXFM_DCT_DCT:
+        *col = AV1_TXFM_1D_DCT;
+        *row = AV1_TXFM_1D_DCT;
+        break;
+    case AV1_TXFM_ADST_DCT:
+    case AV1_TXFM_FLIPADST_DCT:
+        *col = AV1_TXFM_1D_ADST;
+        *row = AV1_TXFM_1D_DCT;
+        break;
+    case AV1_TXFM_DCT_ADST:
+    case AV1_TXFM_DCT_FLIPADST:
+        *col = AV1_TXFM_1D_DCT;
+        *row = AV1_TXFM_1D_ADST;
+        break;
+    case AV1_TXFM_IDTX:
+        *col = AV1_TXFM_1D_IDENTITY;
+        *row = AV1_TXFM_1D_IDENTITY;
+        break;
+    case AV1_TXFM_V_DCT:
+        *col = AV1_TXFM_1D_DCT;
+        *row = AV1_TXFM_1D_IDENTITY;
+        break;
+    case AV1_TXFM_H_DCT:
+        *col = AV1_TXFM_1D_IDENTITY;
+        *row = AV1_TXFM_1D_DCT;
+        break;
+    case AV1_TXFM_V_ADST:
+    case AV1_TXFM_V_FLIPADST:
+        *col = AV1_TXFM_1D_ADST;
+        *row = AV1_TXFM_1D_IDENTITY;
+        break;
+    case AV1_TXFM_H_ADST:
+    case AV1_TXFM_H_FLIPADST:
+        *col = AV1_TXFM_1D_IDENTITY;
+        *row = AV1_TXFM_1D_ADST;
+        break;
+    default:
+        *col = AV1_TXFM_1D_ADST;
+        *row = AV1_TXFM_1D_ADST;
+        break;
+    }
+}
+
+// Runs one reduced 1D pass over in[0..(1<<n)-1] and writes (1<<(n-s)) outputs (at least 1).
+static void inv_1d_reduced(int32_t *t, uint32_t cls, uint32_t n, uint32_t s, uint32_t r) {
+    const uint32_t m = n > s ? n - s : 0u;
+    if (cls == AV1_TXFM_1D_IDENTITY) {
+        if (s != 0) {
+            const uint32_t group = 1u << (n - m);
+            const uint32_t out_n = 1u << m;
+            for (uint32_t k = 0; k < out_n; k++) {
+                int64_t sum = 0;
+                for (uint32_t g = 0; g < group; g++) {
+                    sum += t[k * group + g];
+                }
+                t[k] = round2_i64(sum, n - m);
+            }
+        }
+        // Amplitude follows the full-size identity scaling.
+        for (uint32_t k = 0; k < (1u << m); k++) {
+            t[k] = identity_scale(t[k], n);
+        }
+        return;
+    }
+    // DCT (and, at reduced resolution, the ADST approximation): truncated inverse DCT.
+    av1_inv_dct1d(t, m, r);
+}
+
+// flipUD / flipLR (spec 7.13.3).
+static bool txfm_flip_ud(uint32_t tx_type) {
+    return tx_type == AV1_TXFM_FLIPADST_DCT || tx_type == AV1_TXFM_FLIPADST_ADST || tx_type == AV1_TXFM_V_FLIPADST ||
+           tx_type == AV1_TXFM_FLIPADST_FLIPADST;
+}
+
+static bool txfm_flip_lr(uint32_t tx_type) {
+    return tx_type == AV1_TXFM_DCT_FLIPADST || tx_type == AV1_TXFM_ADST_FLIPADST || tx_type == AV1_TXFM_H_FLIPADST ||
+           tx_type == AV1_TXFM_FLIPADST_FLIPADST;
+}
+
+void av1_inv_txfm2d_c(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *p) {
+    const uint32_t w = 1u << p->log2w;
+    const uint32_t h = 1u << p->log2h;
+    int32_t t[AV1_TXFM_MAX_DIM];
+    uint64_t col_nonzero = 0;
+
+    // Row transforms. Rows past p->rows have all-zero input and therefore all-zero output.
+    for (uint32_t i = 0; i < p->rows; i++) {
+        for (uint32_t j = 0; j < p->cols; j++) {
+            t[j] = coeffs[(size_t)i * w + j];
+            if (p->rect2) {
+                t[j] = round2_i64((int64_t)t[j] * 2896, 12);
+            }
+        }
+        for (uint32_t j = p->cols; j < w; j++) {
+            t[j] = 0;
+        }
+        inv_1d_c(t, p->row_kind, p->log2w, p->row_clamp, 2);
+        for (uint32_t j = 0; j < w; j++) {
+            int32_t v = clamp_bits(round2_i64(t[j], p->row_shift), p->col_clamp);
+            residual[(size_t)i * w + j] = v;
+            if (v != 0) {
+                col_nonzero |= (uint64_t)1 << j;
+            }
+        }
+    }
+    if (p->rows < h) {
+        memset(residual + (size_t)p->rows * w, 0, (size_t)(h - p->rows) * w * sizeof(int32_t));
+    }
+
+    // Column transforms; all-zero columns stay zero.
+    for (uint32_t j = 0; j < w; j++) {
+        if (!(col_nonzero & ((uint64_t)1 << j))) {
+            continue;
+        }
+        for (uint32_t i = 0; i < h; i++) {
+            t[i] = residual[(size_t)i * w + j];
+        }
+        inv_1d_c(t, p->col_kind, p->log2h, p->col_clamp, 0);
+        for (uint32_t i = 0; i < h; i++) {
+            residual[(size_t)i * w + j] = round2_i64(t[i], p->col_shift);
+        }
+    }
+}
+
+bool av1_txfm_plan_init(Av1TxfmPlan *plan,
+                        uint32_t tx_size,
+                        uint32_t tx_type,
+                        uint32_t bit_depth,
+                        bool lossless,
+                        char *err,
+                        size_t err_cap) {
+    if (!plan || tx_size >= AV1_TXFM_TX_SIZES_ALL || tx_type >= AV1_TXFM_TYPES) {
+        snprintf(err, err_cap, "inv_txfm: invalid args");
+        return false;
+    }
+    if (bit_depth != 8 && bit_depth != 10 && bit_depth != 12) {
+        snprintf(err, err_cap, "inv_txfm: unsupported BitDepth %u", bit_depth);
+        return false;
+    }
+
+    Av1TxfmPlan p;
+    p.log2w = kTxfmWidthLog2[tx_size];
+    p.log2h = kTxfmHeightLog2[tx_size];
+    uint32_t col_kind, row_kind;
+    if (lossless) {
+        // Lossless blocks are always TX_4X4 and use the WHT in both directions.
+        if (tx_size != 0) {
+            snprintf(err, err_cap, "inv_txfm: lossless requires TX_4X4 (tx_size=%u)", tx_size);
+            return false;
+        }
+        col_kind = AV1_TXFM_1D_WHT;
+        row_kind = AV1_TXFM_1D_WHT;
+    } else {
+        txfm_1d_classes(tx_type, &col_kind, &row_kind);
+        if ((row_kind == AV1_TXFM_1D_ADST && p.log2w > 4) || (col_kind == AV1_TXFM_1D_ADST && p.log2h > 4) ||
+            (row_kind == AV1_TXFM_1D_IDENTITY && p.log2w > 5) || (col_kind == AV1_TXFM_1D_IDENTITY && p.log2h > 5)) {
+            snprintf(err, err_cap, "inv_txfm: tx_type %u not allowed for tx_size %u", tx_type, tx_size);
+            return false;
+        }
+    }
+    p.row_kind = (uint8_t)row_kind;
+    p.col_kind = (uint8_t)col_kind;
+    p.rect2 = (p.log2w > p.log2h ? p.log2w - p.log2h : p.log2h - p.log2w) == 1u;
+    p.row_shift = lossless ? 0u : kTransformRowShift[tx_size];
+    p.col_shift = lossless ? 0u : 4u;
+    p.row_clamp = (uint8_t)(bit_depth + 8u);
+    p.col_clamp = (uint8_t)(bit_depth + 6u > 16u ? bit_depth + 6u : 16u);
+
+    // Only the top-left 32x32 coefficients are ever read.
+    p.rows = (uint8_t)(p.log2h < 5u ? 1u << p.log2h : 32u);
+    p.cols = (uint8_t)(p.log2w < 5u ? 1u << p.log2w : 32u);
+    *plan = p;
+    return true;
+}
+
+// Picks the fastest kernel that is bit-exact for this bit depth. 4x4 blocks would leave half of
+// the AVX2 lanes empty, so they stay on SSE2.
+static Av1InvTxfm2dKernel select_kernel(uint32_t bit_depth, const Av1TxfmPlan *p) {
+#if defined(AV1_TXFM_HAVE_X86)
+    if (bit_depth <= 10) {
+        const bool small = p->log2w == 2 && p->log2h == 2;
+        if (!small && av1_txfm_cpu_has_avx2()) {
+            return av1_inv_txfm2d_avx2;
+        }
+        if (av1_txfm_cpu_has_sse2()) {
+            return av1_inv_txfm2d_sse2;
+        }
+    }
+#else
+    (void)bit_depth;
+    (void)p;
+#endif
+    return av1_inv_txfm2d_c;
+}
+
+void av1_inv_wht4x4_c(const int32_t *coeffs, int32_t *residual, uint32_t bit_depth) {
+    const uint32_t col_clamp = bit_depth + 6u > 16u ? bit_depth + 6u : 16u;
+    int32_t t[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        memcpy(t, coeffs + 4u * i, sizeof(t));
+        wht_c(t, 0);
+        for (uint32_t j = 0; j < 4; j++) {
+            residual[4u * i + j] = clamp_bits(t[j], col_clamp);
+        }
+    }
+    for (uint32_t j = 0; j < 4; j++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            t[i] = residual[4u * i + j];
+        }
+        wht_c(t, 0);
+        for (uint32_t i = 0; i < 4; i++) {
+            residual[4u * i + j] = t[i];
+        }
+    }
+}
+
+Av1InvWht4x4Fn av1_inv_wht4x4_kernel(void) {
+#if defined(AV1_TXFM_HAVE_X86)
+    if (av1_txfm_cpu_has_sse2()) {
+        return av1_inv_wht4x4_sse2;
+    }
+#endif
+    return av1_inv_wht4x4_c;
+}
+
+bool av1_inv_txfm2d(const int32_t *coeffs,
+                    uint32_t tx_size,
+                    uint32_t tx_type,
+                    uint32_t bit_depth,
+                    bool lossless,
+                    const Av1TxCoeffExtent *extent,
+                    int32_t *residual,
+                    char *err,
+                    size_t err_cap) {
+    if (!coeffs || !residual) {
+        snprintf(err, err_cap, "inv_txfm: invalid args");
+        return false;
+    }
+
+    Av1TxfmPlan p;
+    if (!av1_txfm_plan_init(&p, tx_size, tx_type, bit_depth, lossless, err, err_cap)) {
+        return false;
+    }
+    const uint32_t w = 1u << p.log2w;
+    const uint32_t h = 1u << p.log2h;
+
+    uint32_t rows = p.rows;
+    uint32_t cols = p.cols;
+    if (extent) {
+        if (extent->eob == 0) {
+            memset(residual, 0, (size_t)w * h * sizeof(int32_t));
+            return true;
+        }
+        if (extent->max_row + 1u < rows) {
+            rows = extent->max_row + 1u;
+        }
+        if (extent->max_col + 1u < cols) {
+            cols = extent->max_col + 1u;
+        }
+
+        // DC-only DCT_DCT: with a single non-zero input every DCT butterfly degenerates to
+        // Round2( T[0] * cos128(32), 12 ) propagated to all outputs (then clamped by H()).
+        if (!lossless && tx_type == AV1_TXFM_DCT_DCT && av1_txfm_extent_is_dc_only(extent)) {
+            int64_t v = coeffs[0];
+            if (p.rect2) {
+                v = round2_i64(v * 2896, 12);
+            }
+            v = clamp_bits(round2_i64(v * 2896, 12), p.row_clamp);
+            v = clamp_bits(round2_i64(v, p.row_shift), p.col_clamp);
+            v = clamp_bits(round2_i64(v * 2896, 12), p.col_clamp);
+            const int32_t dc = round2_i64(v, p.col_shift);
+            for (uint32_t k = 0; k < w * h; k++) {
+                residual[k] = dc;
+            }
+            return true;
+        }
+    }
+    p.rows = (uint8_t)rows;
+    p.cols = (uint8_t)cols;
+
+    select_kernel(bit_depth, &p)(coeffs, residual, &p);
+
+    // Apply the flips of the reconstruction step so the residual is in frame orientation.
+    if (!lossless && txfm_flip_ud(tx_type)) {
+        for (uint32_t i = 0; i < h / 2; i++) {
+            int32_t *top = residual + (size_t)i * w;
+            int32_t *bot = residual + (size_t)(h - 1 - i) * w;
+            for (uint32_t j = 0; j < w; j++) {
+                int32_t tmp = top[j];
+                top[j] = bot[j];
+                bot[j] = tmp;
+            }
+        }
+    }
+    if (!lossless && txfm_flip_lr(tx_type)) {
+        for (uint32_t i = 0; i < h; i++) {
+            int32_t *row = residual + (size_t)i * w;
+            for (uint32_t j = 0; j < w / 2; j++) {
+                int32_t tmp = row[j];
+                row[j] = row[w - 1 - j];
+                row[w - 1 - j] = tmp;
+            }
+        }
+    }
+    return true;
+}
+
+// Shared argument checks of the reduced-size entry points.
+static bool reduced_args_ok(const int32_t *coeffs,
+                            uint32_t tx_size,
+                            uint32_t tx_type,
+                            uint32_t bit_depth,
+                            uint32_t scale_log2,
+                            int32_t *residual,
+                            char *err,
+                            size_t err_cap) {
+    if (!coeffs || !residual || tx_size >= AV1_TXFM_TX_SIZES_ALL || tx_type >= AV1_TXFM_TYPES) {
+        snprintf(err, err_cap, "inv_txfm: invalid args");
+        return false;
+    }
+    if (bit_depth != 8 && bit_depth != 10 && bit_depth != 12) {
+        snprintf(err, err_cap, "inv_txfm: unsupported BitDepth %u", bit_depth);
+        return false;
+    }
+    if (scale_log2 > 3) {
+        snprintf(err, err_cap, "inv_txfm: scale_log2 %u out of range (0..3)", scale_log2);
+        return false;
+    }
+    return true;
+}
+
+bool av1_inv_txfm2d_reduced_c(const int32_t *coeffs,
+                              uint32_t tx_size,
+                              uint32_t tx_type,
+                              uint32_t bit_depth,
+                              uint32_t scale_log2,
+                              int32_t *residual,
+                              char *err,
+                              size_t err_cap) {
+    if (!reduced_args_ok(coeffs, tx_size, tx_type, bit_depth, scale_log2, residual, err, err_cap)) {
+        return false;
+    }
+    if (scale_log2 == 0) {
+        return av1_inv_txfm2d(coeffs, tx_size, tx_type, bit_depth, false, NULL, residual, err, err_cap);
+    }
+
+    uint32_t col_cls, row_cls;
+    txfm_1d_classes(tx_type, &col_cls, &row_cls);
+
+    const uint32_t log2w = kTxfmWidthLog2[tx_size];
+    const uint32_t log2h = kTxfmHeightLog2[tx_size];
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    const uint32_t out_log2w = log2w > scale_log2 ? log2w - scale_log2 : 0u;
+    const uint32_t out_log2h = log2h > scale_log2 ? log2h - scale_log2 : 0u;
+    const uint32_t out_w = 1u << out_log2w;
+    const uint32_t out_h = 1u << out_log2h;
+
+    const uint32_t row_shift = kTransformRowShift[tx_size];
+    const uint32_t col_shift = 4u;
+    const uint32_t row_clamp = bit_depth + 8u;
+    const uint32_t col_clamp = bit_depth + 6u > 16u ? bit_depth + 6u : 16u;
+    const bool rect2 = (log2w > log2h ? log2w - log2h : log2h - log2w) == 1u;
+
+    // A truncated DCT column pass only needs the lowest out_h rows; an identity column pass
+    // averages row outputs, so every row is needed.
+    const uint32_t rows_needed = col_cls == AV1_TXFM_1D_IDENTITY ? h : out_h;
+
+    // Row-pass output, row-major with stride out_w.
+    int32_t tmp[AV1_TXFM_MAX_DIM * AV1_TXFM_MAX_DIM];
+    int32_t t[AV1_TXFM_MAX_DIM];
+
+    for (uint32_t i = 0; i < rows_needed; i++) {
+        // Truncated DCT consumes only the lowest out_w coefficients of the row.
+        const uint32_t in_w = row_cls == AV1_TXFM_1D_IDENTITY ? w : out_w;
+        for (uint32_t j = 0; j < in_w; j++) {
+            t[j] = (i < 32 && j < 32) ? coeffs[(size_t)i * w + j] : 0;
+            if (rect2) {
+                t[j] = round2_i64((int64_t)t[j] * 2896, 12);
+            }
+        }
+        inv_1d_reduced(t, row_cls, log2w, scale_log2, row_clamp);
+        for (uint32_t j = 0; j < out_w; j++) {
+            tmp[(size_t)i * out_w + j] = clamp_bits(round2_i64(t[j], row_shift), col_clamp);
+        }
+    }
+
+    for (uint32_t j = 0; j < out_w; j++) {
+        for (uint32_t i = 0; i < rows_needed; i++) {
+            t[i] = tmp[(size_t)i * out_w + j];
+        }
+        inv_1d_reduced(t, col_cls, log2h, scale_log2, col_clamp);
+        for (uint32_t i = 0; i < out_h; i++) {
+            residual[(size_t)i * out_w + j] = round2_i64(t[i], col_shift);
+        }
+    }
+    return true;
+}
+
+bool av1_inv_txfm2d_reduced(const int32_t *coeffs,
+                            uint32_t tx_size,
+                            uint32_t tx_type,
+                            uint32_t bit_depth,
+                            uint32_t scale_log2,
+                            int32_t *residual,
+                            char *err,
+                            size_t err_cap) {
+    if (!reduced_args_ok(coeffs, tx_size, tx_type, bit_depth, scale_log2, residual, err, err_cap)) {
+        return false;
+    }
+    uint32_t col_cls, row_cls;
+    txfm_1d_classes(tx_type, &col_cls, &row_cls);
+    const uint32_t log2w = kTxfmWidthLog2[tx_size];
+    const uint32_t log2h = kTxfmHeightLog2[tx_size];
+    // Outputs narrower than 4 leave most SIMD lanes empty; the scalar path is faster there.
+    if (scale_log2 == 0 || col_cls == AV1_TXFM_1D_IDENTITY || row_cls == AV1_TXFM_1D_IDENTITY ||
+        log2w < scale_log2 + 2u || log2h < scale_log2 + 2u) {
+        return av1_inv_txfm2d_reduced_c(coeffs, tx_size, tx_type, bit_depth, scale_log2, residual, err, err_cap);
+    }
+
+    // Both directions are truncated DCTs: the reduced block is an out_w x out_h DCT_DCT over the
+    // lowest coefficients, with the rect2 pre-scale, row shift and clamps of the full size. That
+    // is a plan for the 2D kernels once the coefficients are repacked at the reduced stride.
+    Av1TxfmPlan p;
+    p.log2w = (uint8_t)(log2w - scale_log2);
+    p.log2h = (uint8_t)(log2h - scale_log2);
+    p.row_kind = AV1_TXFM_1D_DCT;
+    p.col_kind = AV1_TXFM_1D_DCT;
+    p.rect2 = (log2w > log2h ? log2w - log2h : log2h - log2w) == 1u;
+    p.row_shift = kTransformRowShift[tx_size];
+    p.col_shift = 4u;
+    p.row_clamp = (uint8_t)(bit_depth + 8u);
+    p.col_clamp = (uint8_t)(bit_depth + 6u > 16u ? bit_depth + 6u : 16u);
+    // The reduced sizes are 4..32 per side, all inside the coded region.
+    p.rows = (uint8_t)(1u << p.log2h);
+    p.cols = (uint8_t)(1u << p.log2w);
+
+    const uint32_t w = 1u << log2w;
+    int32_t packed[32 * 32];
+    for (uint32_t i = 0; i < p.rows; i++) {
+        memcpy(packed + (size_t)i * p.cols, coeffs + (size_t)i * w, p.cols * sizeof(int32_t));
+    }
+    select_kernel(bit_depth, &p)(packed, residual, &p);
+    return true;
+}
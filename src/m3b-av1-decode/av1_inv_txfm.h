@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Inverse transforms (spec 7.13.2 "Inverse transform process", see local av1bitstream.html).
+//
+// The scalar code follows the spec pseudo-code step by step (butterflies B()/H(), permutations,
+// intermediate clamping) so it can serve as the bit-exact reference for faster kernels. The 1D
+// transforms live in av1_inv_txfm_1d.inc and are instantiated for the scalar reference here and
+// for SSE2/AVX2 lanes in av1_inv_txfm_x86.c.
+//
+// Coefficient layout: row-major Dequant[i][j] with a row stride of the full transform width
+// (1 << Tx_Width_Log2). Only the top-left 32x32 region is read, as in the spec.
+
+#define AV1_TXFM_MAX_LOG2 6u
+#define AV1_TXFM_MAX_DIM (1u << AV1_TXFM_MAX_LOG2)
+#define AV1_TXFM_TX_SIZES_ALL 19u
+
+// TxType values in spec numbering. Note: av1_decode_tile.c uses compact internal ids for the
+// subset it parses; convert before calling into this module.
+enum {
+    AV1_TXFM_DCT_DCT = 0,
+    AV1_TXFM_ADST_DCT = 1,
+    AV1_TXFM_DCT_ADST = 2,
+    AV1_TXFM_ADST_ADST = 3,
+    AV1_TXFM_FLIPADST_DCT = 4,
+    AV1_TXFM_DCT_FLIPADST = 5,
+    AV1_TXFM_FLIPADST_FLIPADST = 6,
+    AV1_TXFM_ADST_FLIPADST = 7,
+    AV1_TXFM_FLIPADST_ADST = 8,
+    AV1_TXFM_IDTX = 9,
+    AV1_TXFM_V_DCT = 10,
+    AV1_TXFM_H_DCT = 11,
+    AV1_TXFM_V_ADST = 12,
+    AV1_TXFM_H_ADST = 13,
+    AV1_TXFM_V_FLIPADST = 14,
+    AV1_TXFM_H_FLIPADST = 15,
+    AV1_TXFM_TYPES = 16,
+};
+
+// 1D transform kinds (one per direction of a TxType, or WHT for lossless blocks).
+enum {
+    AV1_TXFM_1D_DCT = 0,
+    AV1_TXFM_1D_ADST = 1,
+    AV1_TXFM_1D_IDENTITY = 2,
+    AV1_TXFM_1D_WHT = 3,
+};
+
+// Sparse coefficient record for one transform block, produced by the coefficient decoder
+// alongside Quant[]. The inverse transform uses it to skip work on all-zero regions.
+typedef struct {
+    // Decoded eob (number of coded positions in scan order); 0 means all_zero.
+    uint32_t eob;
+    // Largest row / column index holding a non-zero coefficient (valid when eob > 0).
+    uint32_t max_row;
+    uint32_t max_col;
+} Av1TxCoeffExtent;
+
+static inline void av1_txfm_extent_reset(Av1TxCoeffExtent *e) {
+    e->eob = 0;
+    e->max_row = 0;
+    e->max_col = 0;
+}
+
+static inline void av1_txfm_extent_add(Av1TxCoeffExtent *e, uint32_t row, uint32_t col) {
+    if (row > e->max_row) {
+        e->max_row = row;
+    }
+    if (col > e->max_col) {
+        e->max_col = col;
+    }
+}
+
+static inline bool av1_txfm_extent_is_dc_only(const Av1TxCoeffExtent *e) {
+    return e->eob > 0 && e->max_row == 0 && e->max_col == 0;
+}
+
+// Tx_Width_Log2 / Tx_Height_Log2 for TxSize (same TxSize numbering as av1_decode_tile.c).
+uint32_t av1_txfm_width_log2(uint32_t tx_size);
+uint32_t av1_txfm_height_log2(uint32_t tx_size);
+
+// 1D inverse DCT on T[0..(1<<n_log2)-1], in place, with intermediate clamping range r.
+// n_log2 2..6 is the spec process. n_log2 0 and 1 are the 1- and 2-point analogues (same
+// Cos128 scaling), used only by av1_inv_txfm2d_reduced().
+void av1_inv_dct1d(int32_t *t, uint32_t n_log2, uint32_t r);
+
+// 1D inverse ADST (n_log2 2..4), in place, with intermediate clamping range r.
+void av1_inv_adst1d(int32_t *t, uint32_t n_log2, uint32_t r);
+
+// 1D inverse identity transform (n_log2 2..5), in place.
+void av1_inv_identity1d(int32_t *t, uint32_t n_log2);
+
+// 4-point inverse Walsh-Hadamard transform with the given pre-scaling shift, in place.
+void av1_inv_wht1d(int32_t *t, uint32_t shift);
+
+// 2D inverse transform process (spec 7.13.3), producing the h x w Residual block (row-major,
+// stride w). All 16 TxTypes are supported, within the spec limits (ADST up to 16 points,
+// identity up to 32). lossless selects the WHT path and requires TX_4X4.
+//
+// The residual is returned in frame orientation: the flipUD / flipLR reversal that the spec
+// applies when adding Residual to CurrFrame is already done for the FLIPADST types.
+//
+// extent may be NULL (dense block). When given, it must cover every non-zero coefficient and
+// enables the sparse paths, all bit-exact with the dense transform:
+// - DC-only DCT_DCT blocks collapse to a constant fill.
+// - Row transforms run only for rows 0..max_row; the rest of the row-pass output is zero.
+// - Row inputs past max_col are not read.
+// - With an identity row transform, columns past max_col stay zero and skip the column pass.
+//
+// For BitDepth 8 and 10 the work runs on the widest SIMD kernel the CPU supports; 12-bit
+// blocks (whose products need more than 32 bits) always use the scalar reference.
+bool av1_inv_txfm2d(const int32_t *coeffs,
+                    uint32_t tx_size,
+                    uint32_t tx_type,
+                    uint32_t bit_depth,
+                    bool lossless,
+                    const Av1TxCoeffExtent *extent,
+                    int32_t *residual,
+                    char *err,
+                    size_t err_cap);
+
+// Resolved parameters of one 2D inverse transform, shared by the scalar and SIMD kernels.
+typedef struct {
+    uint8_t log2w;
+    uint8_t log2h;
+    uint8_t row_kind; // AV1_TXFM_1D_*
+    uint8_t col_kind;
+    uint8_t rect2;    // Abs( log2W - log2H ) == 1: pre-scale row inputs by 2896/4096
+    uint8_t row_shift;
+    uint8_t col_shift;
+    uint8_t row_clamp;
+    uint8_t col_clamp;
+    // Coefficient rows / columns that may be non-zero (at most 32 each).
+    uint8_t rows;
+    uint8_t cols;
+} Av1TxfmPlan;
+
+// Resolves tx_size / tx_type / BitDepth / Lossless into a dense plan (rows/cols cover the
+// whole coded 32x32 region). Rejects TxTypes the spec does not allow for the size.
+bool av1_txfm_plan_init(Av1TxfmPlan *plan,
+                        uint32_t tx_size,
+                        uint32_t tx_type,
+                        uint32_t bit_depth,
+                        bool lossless,
+                        char *err,
+                        size_t err_cap);
+
+// 2D kernel: runs the row and column passes of a plan (no flips, no DC shortcut).
+typedef void (*Av1InvTxfm2dKernel)(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan);
+
+// Scalar reference kernel.
+void av1_inv_txfm2d_c(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan);
+
+// Lossless 4x4 block (spec 7.13.3 with Lossless = 1) from Dequant / 4, as the coefficient
+// decoder stores it for lossless blocks (av1_dequant_lossless_coeff()): the row WHT skips its
+// >> 2, then the clamp to colClampRange and the column WHT. No plan, extent or flips; the adds
+// and shifts stay within 32 bits at every BitDepth.
+typedef void (*Av1InvWht4x4Fn)(const int32_t *coeffs, int32_t *residual, uint32_t bit_depth);
+
+void av1_inv_wht4x4_c(const int32_t *coeffs, int32_t *residual, uint32_t bit_depth);
+
+// av1_inv_wht4x4_c() or its SSE2 version, whichever the CPU allows.
+Av1InvWht4x4Fn av1_inv_wht4x4_kernel(void);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_TXFM_HAVE_X86 1
+
+// SSE2 (4 lanes) and AVX2 (8 lanes) kernels: bit-exact with av1_inv_txfm2d_c for BitDepth 8
+// and 10, where every intermediate product of a conforming stream fits 32 bits. Callers must
+// check CPU support (av1_txfm_cpu_has_sse2/avx2, which follow av1_cpu_flags()) before calling
+// them.
+void av1_inv_txfm2d_sse2(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan);
+void av1_inv_txfm2d_avx2(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan);
+void av1_inv_wht4x4_sse2(const int32_t *coeffs, int32_t *residual, uint32_t bit_depth);
+bool av1_txfm_cpu_has_sse2(void);
+bool av1_txfm_cpu_has_avx2(void);
+#endif
+
+// Reduced-size 2D inverse transform (a primitive; no decode path calls it).
+//
+// Produces a (h >> scale_log2) x (w >> scale_log2) residual block (at least 1x1) that
+// approximates the 2^scale_log2 box-downsampled full-resolution residual, without computing the
+// full-resolution block:
+// - DCT dimensions run a truncated inverse DCT over the lowest-frequency coefficients.
+// - Identity dimensions average groups of 2^scale_log2 coefficients.
+// - ADST dimensions are approximated with the truncated DCT (scale_log2 > 0 only).
+//
+// scale_log2 == 0 is the exact spec transform (av1_inv_txfm2d on the dense block).
+//
+// residual is row-major with stride (w >> scale_log2).
+//
+// When neither direction is identity and both output sides are at least 4, the reduced block is
+// a smaller DCT_DCT plan and runs on the same SSE2 / AVX2 kernels as av1_inv_txfm2d(); the other
+// cases use the scalar path.
+// Both are bit-exact with av1_inv_txfm2d_reduced_c().
+bool av1_inv_txfm2d_reduced(const int32_t *coeffs,
+                            uint32_t tx_size,
+                            uint32_t tx_type,
+                            uint32_t bit_depth,
+                            uint32_t scale_log2,
+                            int32_t *residual,
+                            char *err,
+                            size_t err_cap);
+
+// Scalar reference of av1_inv_txfm2d_reduced().
+bool av1_inv_txfm2d_reduced_c(const int32_t *coeffs,
+                              uint32_t tx_size,
+                              uint32_t tx_type,
+                              uint32_t bit_depth,
+                              uint32_t scale_log2,
+                              int32_t *residual,
+                              char *err,
+                              size_t err_cap);
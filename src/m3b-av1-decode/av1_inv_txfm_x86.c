@@ -0,0 +1,215 @@
+#include "av1_inv_txfm.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// SSE2 / AVX2 inverse transform kernels.
+//
+// Both are instantiations of av1_inv_txfm_1d.inc (the same step sequence as the scalar
+// reference) on 4 / 8 int32 lanes, plus the 2D driver in av1_inv_txfm_2d_simd.inc. Functions
+// carry a target attribute instead of relying on -msse2/-mavx2, so the file builds with the
+// default CFLAGS and the kernels are selected at run time.
+//
+// Products are 32-bit. The scalar reference multiplies in int64, so the kernels are only used
+// where a conforming stream keeps every product and sum of B() and the ADST4 within 32 bits
+// (BitDepth 8 and 10: at most r + 12 <= 30 bits, spec 7.13.2.2 and 7.13.2.6).
+
+#if defined(AV1_TXFM_HAVE_X86)
+
+#include <immintrin.h>
+
+bool av1_txfm_cpu_has_sse2(void) {
+    return (av1_cpu_flags() & AV1_CPU_SSE2) != 0;
+}
+
+bool av1_txfm_cpu_has_avx2(void) {
+    return (av1_cpu_flags() & AV1_CPU_AVX2) != 0;
+}
+
+// ---- SSE2: 4 x int32 ----
+
+#define SSE2_ATTR __attribute__((target("sse2")))
+
+// SSE2 has no 32-bit mullo; the low halves of the unsigned 32x32->64 products are the same bits.
+static inline SSE2_ATTR __m128i sse2_mullo_epi32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline SSE2_ATTR __m128i sse2_clamp_bits(__m128i v, uint32_t r) {
+    const __m128i lo = _mm_set1_epi32(-(1 << (r - 1)));
+    const __m128i hi = _mm_set1_epi32((1 << (r - 1)) - 1);
+    __m128i m = _mm_cmpgt_epi32(v, hi);
+    v = _mm_or_si128(_mm_and_si128(m, hi), _mm_andnot_si128(m, v));
+    m = _mm_cmplt_epi32(v, lo);
+    return _mm_or_si128(_mm_and_si128(m, lo), _mm_andnot_si128(m, v));
+}
+
+static inline SSE2_ATTR __m128i sse2_round_shift(__m128i v, uint32_t k) {
+    if (k == 0) {
+        return v;
+    }
+    v = _mm_add_epi32(v, _mm_set1_epi32(1 << (k - 1)));
+    return _mm_sra_epi32(v, _mm_cvtsi32_si128((int)k));
+}
+
+static inline SSE2_ATTR void sse2_transpose4(__m128i *v) {
+    __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]);
+    __m128i t1 = _mm_unpacklo_epi32(v[2], v[3]);
+    __m128i t2 = _mm_unpackhi_epi32(v[0], v[1]);
+    __m128i t3 = _mm_unpackhi_epi32(v[2], v[3]);
+    v[0] = _mm_unpacklo_epi64(t0, t1);
+    v[1] = _mm_unpackhi_epi64(t0, t1);
+    v[2] = _mm_unpacklo_epi64(t2, t3);
+    v[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+#define TX_FN(name) name##_sse2
+#define TX_ATTR SSE2_ATTR
+#define TX_T __m128i
+#define TX_W __m128i
+#define TX_MUL(v, c) sse2_mullo_epi32((v), _mm_set1_epi32(c))
+#define TX_WADD(a, b) _mm_add_epi32((a), (b))
+#define TX_WSUB(a, b) _mm_sub_epi32((a), (b))
+#define TX_ROUND12(x) _mm_srai_epi32(_mm_add_epi32((x), _mm_set1_epi32(2048)), 12)
+#define TX_ADD(a, b) _mm_add_epi32((a), (b))
+#define TX_SUB(a, b) _mm_sub_epi32((a), (b))
+#define TX_CLAMP(v, r) sse2_clamp_bits((v), (r))
+#define TX_SRA(v, k) _mm_sra_epi32((v), _mm_cvtsi32_si128((int)(k)))
+#define TX_SHL(v, k) _mm_sll_epi32((v), _mm_cvtsi32_si128((int)(k)))
+#define TX_NEG(v) _mm_sub_epi32(_mm_setzero_si128(), (v))
+#define TX_LANES 4u
+#define TX_LOADU(p) _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define TX_STOREU(p, v) _mm_storeu_si128((__m128i *)(void *)(p), (v))
+#define TX_ZERO() _mm_setzero_si128()
+#define TX_TRANSPOSE(v) sse2_transpose4(v)
+#define TX_ROUND_SHIFT(v, k) sse2_round_shift((v), (k))
+#include "av1_inv_txfm_1d.inc"
+#include "av1_inv_txfm_2d_simd.inc"
+#undef TX_FN
+#undef TX_ATTR
+#undef TX_T
+#undef TX_W
+#undef TX_MUL
+#undef TX_WADD
+#undef TX_WSUB
+#undef TX_ROUND12
+#undef TX_ADD
+#undef TX_SUB
+#undef TX_CLAMP
+#undef TX_SRA
+#undef TX_SHL
+#undef TX_NEG
+#undef TX_LANES
+#undef TX_LOADU
+#undef TX_STOREU
+#undef TX_ZERO
+#undef TX_TRANSPOSE
+#undef TX_ROUND_SHIFT
+
+void av1_inv_txfm2d_sse2(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan) {
+    inv_txfm2d_sse2(coeffs, residual, plan);
+}
+
+// One 4x4 block is exactly four SSE2 rows: transpose so each lane runs the row WHT of one row,
+// clamp, transpose back so each lane runs the column WHT of one column.
+SSE2_ATTR void av1_inv_wht4x4_sse2(const int32_t *coeffs, int32_t *residual, uint32_t bit_depth) {
+    const uint32_t col_clamp = bit_depth + 6u > 16u ? bit_depth + 6u : 16u;
+    __m128i v[4];
+    for (uint32_t k = 0; k < 4; k++) {
+        v[k] = _mm_loadu_si128((const __m128i *)(coeffs + 4u * k));
+    }
+    sse2_transpose4(v);
+    wht_sse2(v, 0);
+    for (uint32_t k = 0; k < 4; k++) {
+        v[k] = sse2_clamp_bits(v[k], col_clamp);
+    }
+    sse2_transpose4(v);
+    wht_sse2(v, 0);
+    for (uint32_t k = 0; k < 4; k++) {
+        _mm_storeu_si128((__m128i *)(residual + 4u * k), v[k]);
+    }
+}
+
+// ---- AVX2: 8 x int32 ----
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+static inline AVX2_ATTR __m256i avx2_clamp_bits(__m256i v, uint32_t r) {
+    const __m256i lo = _mm256_set1_epi32(-(1 << (r - 1)));
+    const __m256i hi = _mm256_set1_epi32((1 << (r - 1)) - 1);
+    return _mm256_max_epi32(_mm256_min_epi32(v, hi), lo);
+}
+
+static inline AVX2_ATTR __m256i avx2_round_shift(__m256i v, uint32_t k) {
+    if (k == 0) {
+        return v;
+    }
+    v = _mm256_add_epi32(v, _mm256_set1_epi32(1 << (k - 1)));
+    return _mm256_sra_epi32(v, _mm_cvtsi32_si128((int)k));
+}
+
+// 8x8 transpose: 32-bit and 64-bit interleaves within each 128-bit half, then a cross-half
+// permute.
+static inline AVX2_ATTR void avx2_transpose8(__m256i *v) {
+    __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(v[4], v[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(v[4], v[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(v[6], v[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(v[6], v[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    v[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    v[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    v[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    v[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    v[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    v[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    v[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    v[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+#define TX_FN(name) name##_avx2
+#define TX_ATTR AVX2_ATTR
+#define TX_T __m256i
+#define TX_W __m256i
+#define TX_MUL(v, c) _mm256_mullo_epi32((v), _mm256_set1_epi32(c))
+#define TX_WADD(a, b) _mm256_add_epi32((a), (b))
+#define TX_WSUB(a, b) _mm256_sub_epi32((a), (b))
+#define TX_ROUND12(x) _mm256_srai_epi32(_mm256_add_epi32((x), _mm256_set1_epi32(2048)), 12)
+#define TX_ADD(a, b) _mm256_add_epi32((a), (b))
+#define TX_SUB(a, b) _mm256_sub_epi32((a), (b))
+#define TX_CLAMP(v, r) avx2_clamp_bits((v), (r))
+#define TX_SRA(v, k) _mm256_sra_epi32((v), _mm_cvtsi32_si128((int)(k)))
+#define TX_SHL(v, k) _mm256_sll_epi32((v), _mm_cvtsi32_si128((int)(k)))
+#define TX_NEG(v) _mm256_sub_epi32(_mm256_setzero_si256(), (v))
+#define TX_LANES 8u
+#define TX_LOADU(p) _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define TX_STOREU(p, v) _mm256_storeu_si256((__m256i *)(void *)(p), (v))
+#define TX_ZERO() _mm256_setzero_si256()
+#define TX_TRANSPOSE(v) avx2_transpose8(v)
+#define TX_ROUND_SHIFT(v, k) avx2_round_shift((v), (k))
+#include "av1_inv_txfm_1d.inc"
+#include "av1_inv_txfm_2d_simd.inc"
+
+void av1_inv_txfm2d_avx2(const int32_t *coeffs, int32_t *residual, const Av1TxfmPlan *plan) {
+    inv_txfm2d_avx2(coeffs, residual, plan);
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_inv_txfm.c uses the scalar reference.
+typedef int av1_inv_txfm_x86_unused;
+
+#endif
@@ -0,0 +1,348 @@
+#include "av1_loopfilter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// log2 of Tx_Width / Tx_Height in 4x4 units (TX_SIZES_ALL order).
+static const uint8_t kTxW4Log2[19] = {0, 1, 2, 3, 4, 0, 1, 1, 2, 2, 3, 3, 4, 0, 2, 1, 3, 2, 4};
+static const uint8_t kTxH4Log2[19] = {0, 1, 2, 3, 4, 1, 0, 2, 1, 3, 2, 4, 3, 2, 0, 3, 1, 4, 2};
+
+// ---- Pixel-type instantiations ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#include "av1_loopfilter_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#include "av1_loopfilter_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+void av1_lf_dsp_init(Av1LoopFilterDsp *dsp) {
+    av1_lf_dsp_init_c(dsp);
+#if defined(AV1_LF_HAVE_X86)
+    (void)av1_lf_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_lf_dsp_init_16(Av1LoopFilterDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_lf_dsp_init_c_16(dsp, bit_depth);
+}
+
+// ---- Filter levels ----
+
+void av1_lf_params_default(Av1LoopFilterParams *p) {
+    static const int8_t kRefDeltas[8] = {1, 0, 0, 0, -1, 0, -1, -1};
+    memset(p, 0, sizeof(*p));
+    memcpy(p->ref_deltas, kRefDeltas, sizeof(kRefDeltas));
+}
+
+static int32_t clip_level(int32_t v) {
+    return v < 0 ? 0 : (v > (int32_t)AV1_MAX_LOOP_FILTER ? (int32_t)AV1_MAX_LOOP_FILTER : v);
+}
+
+uint32_t av1_lf_level(const Av1LoopFilterParams *p, const Av1LfMi *mi, uint32_t plane, uint32_t pass) {
+    const uint32_t i = plane == 0u ? pass : plane + 1u;
+    const int32_t delta_lf = mi->delta_lf[p->delta_lf_multi ? i : 0u];
+    int32_t lvl = clip_level(delta_lf + p->level[i]);
+    const uint32_t seg = mi->segment_id & 7u;
+    if (p->seg_enabled[seg][i]) {
+        lvl = clip_level(lvl + p->seg_data[seg][i]);
+    }
+    if (p->delta_enabled) {
+        const int32_t n_shift = lvl >> 5;
+        const uint32_t ref = mi->ref_frame & 7u;
+        lvl += p->ref_deltas[ref] * (1 << n_shift);
+        if (ref != 0u) {
+            lvl += p->mode_deltas[mi->mode_type ? 1 : 0] * (1 << n_shift);
+        }
+        lvl = clip_level(lvl);
+    }
+    return (uint32_t)lvl;
+}
+
+void av1_lf_levels_init(Av1LfLevels *t, const Av1LoopFilterParams *p) {
+    t->params = *p;
+    Av1LfMi mi;
+    memset(&mi, 0, sizeof(mi));
+    for (uint32_t seg = 0; seg < 8u; seg++) {
+        for (uint32_t ref = 0; ref < 8u; ref++) {
+            for (uint32_t mode = 0; mode < 2u; mode++) {
+                mi.segment_id = (uint8_t)seg;
+                mi.ref_frame = (uint8_t)ref;
+                mi.mode_type = (uint8_t)mode;
+                for (uint32_t i = 0; i < 4u; i++) {
+                    t->lvl[seg][ref][mode][i] = (uint8_t)av1_lf_level(p, &mi, i < 2u ? 0u : i - 1u, i & 1u);
+                }
+            }
+        }
+    }
+}
+
+void av1_lf_mi_set_levels(const Av1LfLevels *t, Av1LfMi *mi) {
+    uint32_t delta;
+    memcpy(&delta, mi->delta_lf, sizeof(delta));
+    if (delta == 0u) {
+        memcpy(mi->lvl, t->lvl[mi->segment_id & 7u][mi->ref_frame & 7u][mi->mode_type ? 1 : 0], sizeof(mi->lvl));
+        return;
+    }
+    for (uint32_t i = 0; i < 4u; i++) {
+        mi->lvl[i] = (uint8_t)av1_lf_level(&t->params, mi, i < 2u ? 0u : i - 1u, i & 1u);
+    }
+}
+
+void av1_lf_fill_levels(const Av1LoopFilterParams *p, Av1LfMi *mi, ptrdiff_t mi_stride, uint32_t mi_rows, uint32_t mi_cols) {
+    Av1LfLevels t;
+    av1_lf_levels_init(&t, p);
+    for (uint32_t r = 0; r < mi_rows; r++) {
+        for (uint32_t c = 0; c < mi_cols; c++) {
+            av1_lf_mi_set_levels(&t, &mi[(ptrdiff_t)r * mi_stride + c]);
+        }
+    }
+}
+
+void av1_lf_limits(uint32_t sharpness, uint32_t lvl, Av1LfLimits *out) {
+    const uint32_t shift = sharpness > 4u ? 2u : (sharpness > 0u ? 1u : 0u);
+    uint32_t limit = lvl >> shift;
+    if (sharpness > 0u) {
+        limit = limit < 1u ? 1u : (limit > 9u - sharpness ? 9u - sharpness : limit);
+    } else if (limit < 1u) {
+        limit = 1u;
+    }
+    out->limit = (uint8_t)limit;
+    out->blimit = (uint8_t)(2u * (lvl + 2u) + limit);
+    out->thresh = (uint8_t)(lvl >> 4);
+}
+
+// ---- Frame binding ----
+
+bool av1_lf_init(Av1LoopFilter *lf,
+                 Av1FrameBuf *fb,
+                 const Av1LfMi *mi,
+                 ptrdiff_t mi_stride,
+                 uint32_t mi_rows,
+                 uint32_t mi_cols,
+                 const Av1LoopFilterParams *params,
+                 char *err,
+                 size_t err_cap) {
+    if (!lf || !fb || !mi || !params || mi_stride < (ptrdiff_t)mi_cols) {
+        snprintf(err, err_cap, "loopfilter: invalid args");
+        return false;
+    }
+    if (mi_rows * 4u < fb->height || mi_cols * 4u < fb->width || (mi_rows & 1u) || (mi_cols & 1u)) {
+        snprintf(err, err_cap, "loopfilter: MI grid %ux%u does not cover a %ux%u frame", mi_cols, mi_rows, fb->width, fb->height);
+        return false;
+    }
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        if (fb->border_x[p] < AV1_LF_MIN_BORDER || fb->border_y[p] < AV1_LF_MIN_BORDER) {
+            snprintf(err, err_cap, "loopfilter: plane %u border %ux%u is below %u", p, fb->border_x[p], fb->border_y[p], AV1_LF_MIN_BORDER);
+            return false;
+        }
+    }
+    memset(lf, 0, sizeof(*lf));
+    lf->fb = fb;
+    lf->mi = mi;
+    lf->mi_stride = mi_stride;
+    lf->mi_rows = mi_rows;
+    lf->mi_cols = mi_cols;
+    lf->sub_x = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    lf->sub_y = fb->layout == AV1_LAYOUT_I420;
+    lf->params = *params;
+    for (uint32_t lvl = 0; lvl <= AV1_MAX_LOOP_FILTER; lvl++) {
+        av1_lf_limits(params->sharpness, lvl, &lf->limits[lvl]);
+    }
+    if (fb->bit_depth > 8u) {
+        av1_lf_dsp_init_16(&lf->dsp16, fb->bit_depth);
+    } else {
+        av1_lf_dsp_init(&lf->dsp);
+    }
+    return true;
+}
+
+bool av1_lf_plane_enabled(const Av1LoopFilter *lf, uint32_t plane) {
+    if (plane >= lf->fb->num_planes || (lf->params.level[0] == 0u && lf->params.level[1] == 0u)) {
+        return false;
+    }
+    return plane == 0u || lf->params.level[1u + plane] != 0u;
+}
+
+// ---- Edge masks ----
+
+static const Av1LfMi *lf_mi(const Av1LoopFilter *lf, uint32_t row, uint32_t col) {
+    return lf->mi + (ptrdiff_t)row * lf->mi_stride + col;
+}
+
+void av1_lf_build_mask(const Av1LoopFilter *lf, uint32_t plane, uint32_t dir, uint32_t region_row, uint32_t region_col, Av1LfMask *m) {
+    memset(m->bits, 0, sizeof(m->bits));
+    const uint32_t sx = plane ? lf->sub_x : 0u;
+    const uint32_t sy = plane ? lf->sub_y : 0u;
+    const uint32_t units_x = AV1_LF_REGION_MI >> sx;
+    const uint32_t units_y = AV1_LF_REGION_MI >> sy;
+    const uint32_t pt = plane ? 1u : 0u;
+    const uint32_t li = plane == 0u ? dir : plane + 1u;
+    for (uint32_t v = 0; v < units_y; v++) {
+        for (uint32_t u = 0; u < units_x; u++) {
+            // Spec 7.14.2 for the luma position ( row, col ) of this plane unit.
+            const uint32_t row = region_row * AV1_LF_REGION_MI + (v << sy);
+            const uint32_t col = region_col * AV1_LF_REGION_MI + (u << sx);
+            if (row >= lf->mi_rows || col >= lf->mi_cols || col * 4u >= lf->fb->width || row * 4u >= lf->fb->height ||
+                (dir == AV1_LF_VERT ? col : row) == 0u) {
+                continue;
+            }
+            const uint32_t r = row | sy;
+            const uint32_t c = col | sx;
+            const Av1LfMi *cur = lf_mi(lf, r, c);
+            const Av1LfMi *prev = dir == AV1_LF_VERT ? lf_mi(lf, r, c - (1u << sx)) : lf_mi(lf, r - (1u << sy), c);
+            // Positions in 4x4 units of the plane; block and transform sizes in the same units.
+            const uint32_t pos = dir == AV1_LF_VERT ? col >> sx : row >> sy;
+            const uint32_t blk_log2 = dir == AV1_LF_VERT ? cur->bw4_log2 : cur->bh4_log2;
+            const uint32_t sub = dir == AV1_LF_VERT ? sx : sy;
+            const uint32_t plane_blk_log2 = blk_log2 > sub ? blk_log2 - sub : 0u;
+            const uint8_t *tx_log2 = dir == AV1_LF_VERT ? kTxW4Log2 : kTxH4Log2;
+            const uint32_t tx = tx_log2[cur->tx_size[pt]];
+            const uint32_t prev_tx = tx_log2[prev->tx_size[pt]];
+            if (pos & ((1u << tx) - 1u)) {
+                continue; // not a transform edge
+            }
+            const bool block_edge = (pos & ((1u << plane_blk_log2) - 1u)) == 0u;
+            if (!block_edge && cur->skip && cur->ref_frame != 0u) {
+                continue;
+            }
+            // filterSize = Min( 16 (luma) / 8 (chroma), Tx size on either side ).
+            uint32_t size_log2 = tx < prev_tx ? tx : prev_tx;
+            const uint32_t max_log2 = plane ? 1u : 2u;
+            size_log2 = size_log2 > max_log2 ? max_log2 : size_log2;
+            const uint32_t lvl = cur->lvl[li] ? cur->lvl[li] : prev->lvl[li];
+            if (lvl == 0u) {
+                continue;
+            }
+            const uint32_t size = size_log2 == 0u ? AV1_LF_4 : (size_log2 == 2u ? AV1_LF_14 : (plane ? AV1_LF_6 : AV1_LF_8));
+            const uint32_t line = dir == AV1_LF_VERT ? u : v;
+            const uint32_t k = dir == AV1_LF_VERT ? v : u;
+            m->bits[size][line] |= (uint16_t)(1u << k);
+            m->lvl[line][k] = (uint8_t)lvl;
+        }
+    }
+}
+
+void av1_lf_apply_mask(const Av1LoopFilter *lf, uint32_t plane, uint32_t dir, uint32_t region_row, uint32_t region_col, const Av1LfMask *m) {
+    const Av1FrameBuf *fb = lf->fb;
+    const uint32_t sx = plane ? lf->sub_x : 0u;
+    const uint32_t sy = plane ? lf->sub_y : 0u;
+    const ptrdiff_t stride = fb->stride[plane];
+    // Plane sample position of the region's first unit.
+    const ptrdiff_t x0 = (ptrdiff_t)((region_col * AV1_LF_REGION_MI * 4u) >> sx);
+    const ptrdiff_t y0 = (ptrdiff_t)((region_row * AV1_LF_REGION_MI * 4u) >> sy);
+    const uint32_t lines = AV1_LF_REGION_MI >> (dir == AV1_LF_VERT ? sx : sy);
+    const ptrdiff_t along = dir == AV1_LF_VERT ? stride : 1;
+    for (uint32_t line = 0; line < lines; line++) {
+        const ptrdiff_t off = dir == AV1_LF_VERT ? y0 * stride + x0 + 4 * (ptrdiff_t)line : (y0 + 4 * (ptrdiff_t)line) * stride + x0;
+        if (fb->bytes_per_sample == 1u) {
+            lf_apply_line(lf, &lf->dsp, av1_frame_plane_8(fb, plane) + off, along, stride, dir, m, line);
+        } else {
+            lf_apply_line_16(lf, &lf->dsp16, av1_frame_plane_16(fb, plane) + off, along, stride, dir, m, line);
+        }
+    }
+}
+
+void av1_lf_filter_row(const Av1LoopFilter *lf, uint32_t region_row, uint32_t dir) {
+    Av1LfMask m;
+    const uint32_t cols = av1_lf_region_cols(lf);
+    for (uint32_t plane = 0; plane < lf->fb->num_planes; plane++) {
+        if (!av1_lf_plane_enabled(lf, plane)) {
+            continue;
+        }
+        for (uint32_t rc = 0; rc < cols; rc++) {
+            av1_lf_build_mask(lf, plane, dir, region_row, rc, &m);
+            av1_lf_apply_mask(lf, plane, dir, region_row, rc, &m);
+        }
+    }
+}
+
+void av1_lf_filter_stripe(const Av1LoopFilter *lf, uint32_t region_row) {
+    av1_lf_filter_row(lf, region_row, AV1_LF_VERT);
+    av1_lf_filter_row(lf, region_row, AV1_LF_HORZ);
+}
+
+void av1_lf_filter_frame(const Av1LoopFilter *lf) {
+    const uint32_t rows = av1_lf_region_rows(lf);
+    for (uint32_t rr = 0; rr < rows; rr++) {
+        av1_lf_filter_stripe(lf, rr);
+    }
+}
+
+// ---- Row-parallel deblocking ----
+
+// progress[ r ]: number of passes (0, 1 = vertical, 2 = horizontal) finished on stripe r.
+typedef struct {
+    const Av1LoopFilter *lf;
+    pthread_mutex_t lock;
+    pthread_cond_t advanced;
+    uint8_t progress[AV1_FRAME_MAX_DIM / (4u * AV1_LF_REGION_MI)];
+} LfRowSync;
+
+static void lf_set_progress(LfRowSync *sync, uint32_t row, uint8_t passes) {
+    pthread_mutex_lock(&sync->lock);
+    sync->progress[row] = passes;
+    pthread_cond_broadcast(&sync->advanced);
+    pthread_mutex_unlock(&sync->lock);
+}
+
+static void lf_wait_progress(LfRowSync *sync, uint32_t row, uint8_t passes) {
+    pthread_mutex_lock(&sync->lock);
+    while (sync->progress[row] < passes) {
+        pthread_cond_wait(&sync->advanced, &sync->lock);
+    }
+    pthread_mutex_unlock(&sync->lock);
+}
+
+static void lf_row_job(void *ctx, uint32_t row) {
+    LfRowSync *sync = (LfRowSync *)ctx;
+    av1_lf_filter_row(sync->lf, row, AV1_LF_VERT);
+    lf_set_progress(sync, row, 1);
+    if (row > 0u) {
+        lf_wait_progress(sync, row - 1u, 2);
+    }
+    av1_lf_filter_row(sync->lf, row, AV1_LF_HORZ);
+    lf_set_progress(sync, row, 2);
+}
+
+void av1_lf_filter_frame_mt(const Av1LoopFilter *lf, Av1ThreadPool *pool) {
+    const uint32_t rows = av1_lf_region_rows(lf);
+    if (!pool || pool->num_threads < 2u || rows < 2u) {
+        av1_lf_filter_frame(lf);
+        return;
+    }
+    LfRowSync sync;
+    memset(&sync, 0, sizeof(sync));
+    sync.lf = lf;
+    pthread_mutex_init(&sync.lock, NULL);
+    pthread_cond_init(&sync.advanced, NULL);
+    av1_thread_pool_run(pool, lf_row_job, &sync, rows);
+    pthread_cond_destroy(&sync.advanced);
+    pthread_mutex_destroy(&sync.lock);
+}
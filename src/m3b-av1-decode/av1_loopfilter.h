@@ -0,0 +1,205 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+#include "av1_thread_pool.h"
+
+// Deblocking loop filter (spec 7.14 "Loop filter process").
+//
+// Edge selection is bitmask driven, in the style of libaom's loop filter bitmasks: for every
+// 64x64 luma region, plane and direction, av1_lf_build_mask() walks the MI grid once and records
+// which 4x4 units start an edge of each filter length (4 / 6 / 8 / 14 taps) together with their
+// filter level. av1_lf_apply_mask() then turns each line of set bits into runs of same-length
+// edge segments and hands a whole run to one Av1LoopFilterDsp kernel, which filters the 4
+// samples of every segment. The AVX2 kernels (av1_loopfilter_x86.c) work on four segments (16
+// edge samples) per vector for 8-bit frames.
+//
+// Scalar kernels (av1_loopfilter_tmpl.inc) are instantiated for uint8_t and uint16_t pixels; the
+// _16 / 16 variants serve BitDepth 10 / 12.
+
+#define AV1_MAX_LOOP_FILTER 63u
+
+// Regions are 64x64 luma samples (16x16 MI units) whatever the superblock size.
+#define AV1_LF_REGION_MI 16u
+
+// Samples read past the plane edges: frames handed to the loop filter need at least this border
+// (border_x / border_y of every plane), and blocks overhanging the frame must be reconstructed
+// into it as the spec's CurrFrame is.
+#define AV1_LF_MIN_BORDER 8u
+
+// Filter lengths (spec filterLen: 4, 6 for chroma, 8 and 16 "wide" = 13-tap output for luma).
+enum {
+    AV1_LF_4 = 0,
+    AV1_LF_6,
+    AV1_LF_8,
+    AV1_LF_14,
+    AV1_LF_SIZES,
+};
+
+// Edge direction: pass 0 filters vertical edges (across x), pass 1 horizontal edges (across y).
+enum {
+    AV1_LF_VERT = 0,
+    AV1_LF_HORZ,
+    AV1_LF_DIRS,
+};
+
+// limit / blimit / thresh of one filter level (spec 7.14.4), for BitDepth 8; kernels shift them by
+// BitDepth - 8.
+typedef struct {
+    uint8_t limit;
+    uint8_t blimit;
+    uint8_t thresh;
+} Av1LfLimits;
+
+// Frame-level inputs: loop_filter_params(), delta_lf_multi and the SEG_LVL_ALT_LF_* features.
+typedef struct {
+    uint8_t level[4]; // loop_filter_level[ 0..3 ]
+    uint8_t sharpness;
+    uint8_t delta_enabled; // loop_filter_delta_enabled
+    uint8_t delta_lf_multi;
+    int8_t ref_deltas[8]; // loop_filter_ref_deltas[ INTRA_FRAME..ALTREF_FRAME ]
+    int8_t mode_deltas[2];
+    uint8_t seg_enabled[8][4]; // FeatureEnabled[ segment ][ SEG_LVL_ALT_LF_Y_V + i ]
+    int8_t seg_data[8][4];
+} Av1LoopFilterParams;
+
+// Deblocking inputs of one 4x4 luma unit: the spec's MiSizes, LoopfilterTxSizes, Skips,
+// RefFrames[ 0 ], YModes (as modeType), SegmentIds and DeltaLFs at that position. For chroma the
+// unit at ( row | subY, col | subX ) describes the chroma 4x4 unit.
+//
+// lvl[] holds the unit's filter levels, derived from the other fields once per block while the
+// tile is decoded (av1_lf_mi_set_levels()); edge selection only reads lvl[].
+typedef struct {
+    uint8_t bw4_log2; // block width in 4x4 units, log2
+    uint8_t bh4_log2;
+    uint8_t tx_size[2]; // [ 0 ] luma, [ 1 ] chroma transform size (TX_SIZES_ALL order)
+    uint8_t skip;
+    uint8_t ref_frame; // 0 = INTRA_FRAME
+    uint8_t mode_type; // 1 for inter modes other than GLOBALMV / GLOBAL_GLOBALMV
+    uint8_t segment_id;
+    int8_t delta_lf[4];
+    uint8_t lvl[4]; // av1_lf_level() for i = 0 / 1 (luma vertical / horizontal edges), 2 (U), 3 (V)
+} Av1LfMi;
+
+// Filters n4 consecutive 4-sample segments of one edge. dst is the first q0 sample (the first
+// sample right of / below the edge); lim[ i ] applies to segment i.
+typedef void (*Av1LfFn)(uint8_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4);
+typedef void (*Av1LfFn16)(uint16_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4, uint32_t bit_depth);
+
+typedef struct {
+    Av1LfFn filter[AV1_LF_DIRS][AV1_LF_SIZES];
+} Av1LoopFilterDsp;
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1LfFn16 filter[AV1_LF_DIRS][AV1_LF_SIZES];
+} Av1LoopFilterDsp16;
+
+// Scalar reference tables.
+void av1_lf_dsp_init_c(Av1LoopFilterDsp *dsp);
+void av1_lf_dsp_init_c_16(Av1LoopFilterDsp16 *dsp, uint32_t bit_depth);
+
+// Best tables for the running CPU.
+void av1_lf_dsp_init(Av1LoopFilterDsp *dsp);
+void av1_lf_dsp_init_16(Av1LoopFilterDsp16 *dsp, uint32_t bit_depth);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_LF_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_lf_dsp_init_avx2(Av1LoopFilterDsp *dsp);
+#endif
+
+// Defaults of setup_past_independence() / loop_filter_params() for lossless or intrabc frames:
+// levels 0, ref_deltas { 1, 0, 0, 0, -1, 0, -1, -1 }, mode_deltas 0, no segment features.
+void av1_lf_params_default(Av1LoopFilterParams *p);
+
+// Spec 7.14.4 / 7.14.5: filter level of a unit for plane / pass.
+uint32_t av1_lf_level(const Av1LoopFilterParams *p, const Av1LfMi *mi, uint32_t plane, uint32_t pass);
+
+// Spec 7.14.4: limit, blimit and thresh of a level.
+void av1_lf_limits(uint32_t sharpness, uint32_t lvl, Av1LfLimits *out);
+
+// Filter levels of a frame for every segment, reference frame and mode type with all DeltaLF
+// zero (the delta_lf_present == 0 case, and most blocks otherwise), built once per frame header.
+typedef struct {
+    Av1LoopFilterParams params;
+    uint8_t lvl[8][8][2][4]; // [ segment_id ][ ref_frame ][ mode_type ][ i ]
+} Av1LfLevels;
+
+void av1_lf_levels_init(Av1LfLevels *t, const Av1LoopFilterParams *p);
+
+// Fills mi->lvl from the unit's segment, reference, mode type and DeltaLF: a table lookup unless
+// DeltaLF is non-zero.
+void av1_lf_mi_set_levels(const Av1LfLevels *t, Av1LfMi *mi);
+
+// av1_lf_mi_set_levels() over a whole grid, for producers that fill the inputs in bulk.
+void av1_lf_fill_levels(const Av1LoopFilterParams *p, Av1LfMi *mi, ptrdiff_t mi_stride, uint32_t mi_rows, uint32_t mi_cols);
+
+// Edges of one region, plane and direction. Line l is a column of 4x4 units (AV1_LF_VERT) or a row
+// (AV1_LF_HORZ) of the region; bit k of bits[ size ][ l ] marks the edge segment k units along it.
+typedef struct {
+    uint16_t bits[AV1_LF_SIZES][AV1_LF_REGION_MI];
+    uint8_t lvl[AV1_LF_REGION_MI][AV1_LF_REGION_MI]; // [ line ][ k ]
+} Av1LfMask;
+
+typedef struct {
+    Av1FrameBuf *fb;
+    const Av1LfMi *mi;
+    ptrdiff_t mi_stride;
+    uint32_t mi_rows; // MiRows / MiCols (even, covering the frame)
+    uint32_t mi_cols;
+    uint32_t sub_x;
+    uint32_t sub_y;
+    Av1LoopFilterParams params;
+    Av1LfLimits limits[AV1_MAX_LOOP_FILTER + 1];
+    Av1LoopFilterDsp dsp;
+    Av1LoopFilterDsp16 dsp16;
+} Av1LoopFilter;
+
+// Binds a reconstructed frame and its MI grid (mi_rows x mi_cols units, row stride mi_stride). The
+// grid's lvl[] must already be filled for params.
+bool av1_lf_init(Av1LoopFilter *lf,
+                 Av1FrameBuf *fb,
+                 const Av1LfMi *mi,
+                 ptrdiff_t mi_stride,
+                 uint32_t mi_rows,
+                 uint32_t mi_cols,
+                 const Av1LoopFilterParams *params,
+                 char *err,
+                 size_t err_cap);
+
+// Number of 64x64 region rows / columns.
+static inline uint32_t av1_lf_region_rows(const Av1LoopFilter *lf) {
+    return (lf->mi_rows + AV1_LF_REGION_MI - 1u) / AV1_LF_REGION_MI;
+}
+
+static inline uint32_t av1_lf_region_cols(const Av1LoopFilter *lf) {
+    return (lf->mi_cols + AV1_LF_REGION_MI - 1u) / AV1_LF_REGION_MI;
+}
+
+// True when plane is deblocked at all (loop_filter_level[ 0 ] / [ 1 ] non-zero, and for chroma
+// loop_filter_level[ 1 + plane ]).
+bool av1_lf_plane_enabled(const Av1LoopFilter *lf, uint32_t plane);
+
+void av1_lf_build_mask(const Av1LoopFilter *lf, uint32_t plane, uint32_t dir, uint32_t region_row, uint32_t region_col, Av1LfMask *m);
+void av1_lf_apply_mask(const Av1LoopFilter *lf, uint32_t plane, uint32_t dir, uint32_t region_row, uint32_t region_col, const Av1LfMask *m);
+
+// Edges of one direction in a 64-luma-row stripe, every enabled plane.
+void av1_lf_filter_row(const Av1LoopFilter *lf, uint32_t region_row, uint32_t dir);
+
+// All vertical edges of a 64-luma-row stripe, then all its horizontal edges. Stripes filtered top
+// to bottom give the spec's result (vertical edges of the whole frame first, then horizontal).
+void av1_lf_filter_stripe(const Av1LoopFilter *lf, uint32_t region_row);
+
+// Deblocks the whole frame in place.
+void av1_lf_filter_frame(const Av1LoopFilter *lf);
+
+// Row-parallel av1_lf_filter_frame(): one pool job per stripe. Vertical edges of a stripe only
+// touch its own rows, so they run as soon as the job starts; its horizontal edges read and modify
+// up to seven rows of the stripe above, so they wait until that stripe's horizontal pass is done
+// (per-row progress counters). The result is identical to the single-threaded order.
+void av1_lf_filter_frame_mt(const Av1LoopFilter *lf, Av1ThreadPool *pool);
@@ -0,0 +1,263 @@
+#include "av1_loopfilter.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 deblocking kernels for 8-bit frames, bit-exact with the scalar kernels in
+// av1_loopfilter_tmpl.inc.
+//
+// Four edge segments (16 samples along the edge) are filtered at once on 16-bit lanes: every tap
+// position across the edge is one vector, the mask / flat / hev decisions become lane masks and
+// the narrow, 8-tap and 14-tap outputs are blended per lane. Horizontal edges load the rows
+// directly; vertical edges transpose a 16x16 byte tile around the edge. A trailing group of fewer
+// than four segments goes through the same code on zero-padded vectors and only its own samples
+// are stored. Functions carry a target attribute so the file builds with the default CFLAGS;
+// av1_lf_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_LF_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+// Taps read / written on each side of the edge per filter length.
+static const uint32_t kTapsRead[AV1_LF_SIZES] = {2, 3, 4, 7};
+static const uint32_t kTapsWritten[AV1_LF_SIZES] = {2, 2, 3, 6};
+
+typedef struct {
+    __m256i limit;
+    __m256i blimit;
+    __m256i thresh;
+} LfLimits16;
+
+// Lane i uses lim[ i / 4 ]; lanes past n segments repeat segment 0 (their output is discarded).
+static inline AVX2_ATTR LfLimits16 lf_limits_16(const Av1LfLimits *lim, uint32_t n) {
+    int16_t l[16], b[16], t[16];
+    for (uint32_t i = 0; i < 16; i++) {
+        const Av1LfLimits *x = &lim[(i >> 2) < n ? i >> 2 : 0u];
+        l[i] = x->limit;
+        b[i] = x->blimit;
+        t[i] = x->thresh;
+    }
+    LfLimits16 out;
+    out.limit = _mm256_loadu_si256((const __m256i *)(const void *)l);
+    out.blimit = _mm256_loadu_si256((const __m256i *)(const void *)b);
+    out.thresh = _mm256_loadu_si256((const __m256i *)(const void *)t);
+    return out;
+}
+
+static inline AVX2_ATTR __m256i absdiff(__m256i a, __m256i b) {
+    return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+// Spec 7.14.6.4 on vectors: out[ i + 7 ] for i = -n..n-1.
+static inline AVX2_ATTR void lf_wide_16(const __m256i *v, int32_t n, int32_t n2, int32_t log2size, __m256i *out) {
+    const __m256i round = _mm256_set1_epi16((int16_t)(1 << (log2size - 1)));
+    for (int32_t i = -n; i < n; i++) {
+        __m256i t = round;
+        for (int32_t j = -n; j <= n; j++) {
+            int32_t p = i + j;
+            p = p < -(n + 1) ? -(n + 1) : (p > n ? n : p);
+            const __m256i x = v[p + 7];
+            t = _mm256_add_epi16(t, (j < 0 ? -j : j) <= n2 ? _mm256_slli_epi16(x, 1) : x);
+        }
+        out[i + 7] = _mm256_srli_epi16(t, log2size);
+    }
+}
+
+// v[ k + 7 ] holds tap k across the edge (p( k ) = v[ 6 - k ], q( k ) = v[ 7 + k ]), one lane per
+// sample along the edge. Filters in place.
+static inline AVX2_ATTR void lf_filter_16(__m256i *v, const LfLimits16 *l, uint32_t type) {
+    const __m256i p1 = v[5], p0 = v[6], q0 = v[7], q1 = v[8];
+    const __m256i ap = absdiff(p1, p0);
+    const __m256i aq = absdiff(q1, q0);
+    const __m256i hev = _mm256_or_si256(_mm256_cmpgt_epi16(ap, l->thresh), _mm256_cmpgt_epi16(aq, l->thresh));
+
+    // filterMask (spec 7.14.6.2), inverted: lanes left untouched.
+    __m256i m = _mm256_max_epi16(ap, aq);
+    if (type != AV1_LF_4) {
+        m = _mm256_max_epi16(m, _mm256_max_epi16(absdiff(v[4], p1), absdiff(v[9], q1)));
+        if (type != AV1_LF_6) {
+            m = _mm256_max_epi16(m, _mm256_max_epi16(absdiff(v[3], v[4]), absdiff(v[10], v[9])));
+        }
+    }
+    const __m256i edge = _mm256_add_epi16(_mm256_slli_epi16(absdiff(p0, q0), 1), _mm256_srli_epi16(absdiff(p1, q1), 1));
+    const __m256i keep = _mm256_or_si256(_mm256_cmpgt_epi16(m, l->limit), _mm256_cmpgt_epi16(edge, l->blimit));
+
+    // Narrow filter (spec 7.14.6.3) on signed values.
+    const __m256i off = _mm256_set1_epi16(0x80);
+    const __m256i lo = _mm256_set1_epi16(-128);
+    const __m256i hi = _mm256_set1_epi16(127);
+#define LF_CLAMP(x) _mm256_min_epi16(_mm256_max_epi16((x), lo), hi)
+    const __m256i ps1 = _mm256_sub_epi16(p1, off);
+    const __m256i ps0 = _mm256_sub_epi16(p0, off);
+    const __m256i qs0 = _mm256_sub_epi16(q0, off);
+    const __m256i qs1 = _mm256_sub_epi16(q1, off);
+    __m256i f = _mm256_and_si256(LF_CLAMP(_mm256_sub_epi16(ps1, qs1)), hev);
+    const __m256i d = _mm256_sub_epi16(qs0, ps0);
+    f = LF_CLAMP(_mm256_add_epi16(f, _mm256_add_epi16(d, _mm256_add_epi16(d, d))));
+    const __m256i f1 = _mm256_srai_epi16(LF_CLAMP(_mm256_add_epi16(f, _mm256_set1_epi16(4))), 3);
+    const __m256i f2 = _mm256_srai_epi16(LF_CLAMP(_mm256_add_epi16(f, _mm256_set1_epi16(3))), 3);
+    const __m256i f3 = _mm256_srai_epi16(_mm256_add_epi16(f1, _mm256_set1_epi16(1)), 1);
+    __m256i r[14];
+    memcpy(r, v, sizeof(r));
+    r[6] = _mm256_add_epi16(LF_CLAMP(_mm256_add_epi16(ps0, f2)), off);
+    r[7] = _mm256_add_epi16(LF_CLAMP(_mm256_sub_epi16(qs0, f1)), off);
+    r[5] = _mm256_blendv_epi8(_mm256_add_epi16(LF_CLAMP(_mm256_add_epi16(ps1, f3)), off), p1, hev);
+    r[8] = _mm256_blendv_epi8(_mm256_add_epi16(LF_CLAMP(_mm256_sub_epi16(qs1, f3)), off), q1, hev);
+#undef LF_CLAMP
+
+    if (type != AV1_LF_4) {
+        // flatMask over p1..p2 (6-tap) or p1..p3, and flatMask2 over p4..p6 for the 14-tap filter.
+        const int32_t taps = type == AV1_LF_6 ? 3 : 4;
+        const __m256i one = _mm256_set1_epi16(1);
+        __m256i fm = _mm256_setzero_si256();
+        for (int32_t k = 1; k < taps; k++) {
+            fm = _mm256_max_epi16(fm, _mm256_max_epi16(absdiff(v[6 - k], p0), absdiff(v[7 + k], q0)));
+        }
+        const __m256i flat = _mm256_cmpgt_epi16(one, _mm256_srli_epi16(fm, 1));
+        __m256i w[14];
+        if (type == AV1_LF_6) {
+            lf_wide_16(v, 2, 1, 3, w);
+            for (int32_t k = 5; k <= 8; k++) {
+                r[k] = _mm256_blendv_epi8(r[k], w[k], flat);
+            }
+        } else {
+            lf_wide_16(v, 3, 0, 3, w);
+            for (int32_t k = 4; k <= 9; k++) {
+                r[k] = _mm256_blendv_epi8(r[k], w[k], flat);
+            }
+        }
+        if (type == AV1_LF_14) {
+            __m256i fm2 = _mm256_setzero_si256();
+            for (int32_t k = 4; k <= 6; k++) {
+                fm2 = _mm256_max_epi16(fm2, _mm256_max_epi16(absdiff(v[6 - k], p0), absdiff(v[7 + k], q0)));
+            }
+            const __m256i flat2 = _mm256_and_si256(flat, _mm256_cmpgt_epi16(one, _mm256_srli_epi16(fm2, 1)));
+            lf_wide_16(v, 6, 1, 4, w);
+            for (int32_t k = 1; k <= 12; k++) {
+                r[k] = _mm256_blendv_epi8(r[k], w[k], flat2);
+            }
+        }
+    }
+    const int32_t tw = (int32_t)kTapsWritten[type];
+    for (int32_t k = 7 - tw; k < 7 + tw; k++) {
+        v[k] = _mm256_blendv_epi8(r[k], v[k], keep);
+    }
+}
+
+static inline AVX2_ATTR __m128i pack_16(__m256i x) {
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(x, x), 0xD8));
+}
+
+// Horizontal edges: taps are rows, the 16 samples of four segments are contiguous.
+static inline AVX2_ATTR void lf_h_avx2(uint8_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4, uint32_t type) {
+    const int32_t tr = (int32_t)kTapsRead[type];
+    const int32_t tw = (int32_t)kTapsWritten[type];
+    for (uint32_t g = 0; g < n4; g += 4) {
+        const uint32_t n = n4 - g < 4u ? n4 - g : 4u;
+        uint8_t *s = dst + 16 * (ptrdiff_t)(g >> 2);
+        const LfLimits16 l = lf_limits_16(lim + g, n);
+        __m256i v[14];
+        for (int32_t k = 0; k < 14; k++) {
+            v[k] = _mm256_setzero_si256();
+        }
+        for (int32_t k = -tr; k < tr; k++) {
+            __m128i row;
+            if (n == 4u) {
+                row = _mm_loadu_si128((const __m128i *)(const void *)(s + k * stride));
+            } else {
+                uint8_t tmp[16] = {0};
+                memcpy(tmp, s + k * stride, 4u * n);
+                row = _mm_loadu_si128((const __m128i *)(const void *)tmp);
+            }
+            v[k + 7] = _mm256_cvtepu8_epi16(row);
+        }
+        lf_filter_16(v, &l, type);
+        for (int32_t k = -tw; k < tw; k++) {
+            const __m128i row = pack_16(v[k + 7]);
+            if (n == 4u) {
+                _mm_storeu_si128((__m128i *)(void *)(s + k * stride), row);
+            } else {
+                uint8_t tmp[16];
+                _mm_storeu_si128((__m128i *)(void *)tmp, row);
+                memcpy(s + k * stride, tmp, 4u * n);
+            }
+        }
+    }
+}
+
+// 16x16 byte transpose: four rounds of interleaving register i with i + 8 (each round rotates the
+// 8-bit ( register, byte ) index by one bit).
+static inline AVX2_ATTR void transpose_16x16(__m128i *x) {
+    __m128i t[16];
+    for (int32_t round = 0; round < 4; round++) {
+        for (int32_t i = 0; i < 8; i++) {
+            t[2 * i] = _mm_unpacklo_epi8(x[i], x[i + 8]);
+            t[2 * i + 1] = _mm_unpackhi_epi8(x[i], x[i + 8]);
+        }
+        memcpy(x, t, sizeof(t));
+    }
+}
+
+// Vertical edges: rows along the edge, taps x - 8 .. x + 7 transposed into vectors.
+static inline AVX2_ATTR void lf_v_avx2(uint8_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4, uint32_t type) {
+    for (uint32_t g = 0; g < n4; g += 4) {
+        const uint32_t n = n4 - g < 4u ? n4 - g : 4u;
+        uint8_t *s = dst + 16 * stride * (ptrdiff_t)(g >> 2) - 8;
+        const LfLimits16 l = lf_limits_16(lim + g, n);
+        __m128i x[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            x[i] = i < 4u * n ? _mm_loadu_si128((const __m128i *)(const void *)(s + (ptrdiff_t)i * stride)) : _mm_setzero_si128();
+        }
+        transpose_16x16(x);
+        __m256i v[14];
+        for (int32_t k = 0; k < 14; k++) {
+            v[k] = _mm256_cvtepu8_epi16(x[k + 1]);
+        }
+        lf_filter_16(v, &l, type);
+        for (int32_t k = 0; k < 14; k++) {
+            x[k + 1] = pack_16(v[k]);
+        }
+        transpose_16x16(x);
+        for (uint32_t i = 0; i < 4u * n; i++) {
+            _mm_storeu_si128((__m128i *)(void *)(s + (ptrdiff_t)i * stride), x[i]);
+        }
+    }
+}
+
+#define LF_KERNELS_AVX2(name, type)                                                                                  \
+    static AVX2_ATTR void lf_v_##name##_avx2(uint8_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4) { \
+        lf_v_avx2(dst, stride, lim, n4, type);                                                                       \
+    }                                                                                                                \
+    static AVX2_ATTR void lf_h_##name##_avx2(uint8_t *dst, ptrdiff_t stride, const Av1LfLimits *lim, uint32_t n4) { \
+        lf_h_avx2(dst, stride, lim, n4, type);                                                                       \
+    }
+
+LF_KERNELS_AVX2(4, AV1_LF_4)
+LF_KERNELS_AVX2(6, AV1_LF_6)
+LF_KERNELS_AVX2(8, AV1_LF_8)
+LF_KERNELS_AVX2(14, AV1_LF_14)
+#undef LF_KERNELS_AVX2
+
+bool av1_lf_dsp_init_avx2(Av1LoopFilterDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->filter[AV1_LF_VERT][AV1_LF_4] = lf_v_4_avx2;
+    dsp->filter[AV1_LF_VERT][AV1_LF_6] = lf_v_6_avx2;
+    dsp->filter[AV1_LF_VERT][AV1_LF_8] = lf_v_8_avx2;
+    dsp->filter[AV1_LF_VERT][AV1_LF_14] = lf_v_14_avx2;
+    dsp->filter[AV1_LF_HORZ][AV1_LF_4] = lf_h_4_avx2;
+    dsp->filter[AV1_LF_HORZ][AV1_LF_6] = lf_h_6_avx2;
+    dsp->filter[AV1_LF_HORZ][AV1_LF_8] = lf_h_8_avx2;
+    dsp->filter[AV1_LF_HORZ][AV1_LF_14] = lf_h_14_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_loopfilter.c uses the scalar reference.
+typedef int av1_lf_x86_unused;
+
+#endif
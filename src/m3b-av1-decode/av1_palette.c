@@ -0,0 +1,155 @@
+#include "av1_palette.h"
+
+#include <string.h>
+
+uint32_t av1_palette_cache(const uint16_t *above,
+                           uint32_t above_n,
+                           const uint16_t *left,
+                           uint32_t left_n,
+                           uint16_t cache[2 * AV1_PALETTE_MAX_COLORS]) {
+    uint32_t a = 0, l = 0, n = 0;
+    while (a < above_n || l < left_n) {
+        uint16_t v;
+        if (l == left_n || (a < above_n && above[a] <= left[l])) {
+            v = above[a++];
+        } else {
+            v = left[l++];
+        }
+        if (n == 0u || v != cache[n - 1u]) {
+            cache[n++] = v;
+        }
+    }
+    return n;
+}
+
+void av1_palette_sort(uint16_t *colors, uint32_t n) {
+    for (uint32_t i = 1; i < n; i++) {
+        const uint16_t v = colors[i];
+        uint32_t j = i;
+        for (; j > 0u && colors[j - 1u] > v; j--) {
+            colors[j] = colors[j - 1u];
+        }
+        colors[j] = v;
+    }
+}
+
+// get_palette_color_context() with all three neighbors (left, top-left, top) only depends on which
+// of them are equal: scores are 2 / 1 / 2 added per neighbor, so each equality pattern fixes
+// ColorContextHash and the ranking of the neighbor colors in front of ColorOrder (ties go to the
+// lower color index). Index: ( left == top ) << 2 | ( left == top_left ) << 1 | ( top == top_left ).
+enum {
+    RANK_LEFT,
+    RANK_TOP,
+    RANK_TOP_LEFT,
+    RANK_MIN_LT, // Min( left, top )
+    RANK_MAX_LT, // Max( left, top )
+};
+
+static const struct {
+    uint8_t ctx;
+    uint8_t n;
+    uint8_t rank[3];
+} kPatterns[8] = {
+    {1, 3, {RANK_MIN_LT, RANK_MAX_LT, RANK_TOP_LEFT}}, // all differ: scores 2, 2, 1, hash 8
+    {2, 2, {RANK_TOP, RANK_LEFT, 0}},                  // top == top_left: 3, 2, hash 7
+    {2, 2, {RANK_LEFT, RANK_TOP, 0}},                  // left == top_left: 3, 2, hash 7
+    {4, 1, {RANK_LEFT, 0, 0}},                         // (impossible)
+    {3, 2, {RANK_LEFT, RANK_TOP_LEFT, 0}},             // left == top: 4, 1, hash 6
+    {4, 1, {RANK_LEFT, 0, 0}},                         // (impossible)
+    {4, 1, {RANK_LEFT, 0, 0}},                         // (impossible)
+    {4, 1, {RANK_LEFT, 0, 0}},                         // all equal: 5, hash 5
+};
+
+// ColorOrder: the ranked colors, then the others in ascending order.
+static void palette_order(const uint8_t *ranked, uint32_t num_ranked, uint32_t n, uint8_t *order) {
+    uint32_t used = 0;
+    for (uint32_t k = 0; k < num_ranked; k++) {
+        order[k] = ranked[k];
+        used |= 1u << ranked[k];
+    }
+    uint32_t k = num_ranked;
+    for (uint32_t v = 0; v < n; v++) {
+        if (!(used & (1u << v))) {
+            order[k++] = (uint8_t)v;
+        }
+    }
+}
+
+void av1_palette_diag_contexts(const uint8_t *map, ptrdiff_t map_stride, uint32_t i, uint32_t w, uint32_t h, uint32_t n, Av1PaletteDiag *d) {
+    const uint32_t j_hi = i < w - 1u ? i : w - 1u;
+    const uint32_t j_lo = i + 1u > h ? i + 1u - h : 0u;
+    uint32_t k = 0;
+    for (uint32_t j = j_hi + 1u; j-- > j_lo; k++) {
+        const uint32_t r = i - j;
+        const uint8_t *p = map + (ptrdiff_t)r * map_stride + j;
+        d->row[k] = (uint8_t)r;
+        d->col[k] = (uint8_t)j;
+        uint8_t ranked[3];
+        if (r == 0u || j == 0u) {
+            // One neighbor: score 2, hash 2.
+            ranked[0] = r == 0u ? p[-1] : p[-map_stride];
+            d->ctx[k] = 0;
+            palette_order(ranked, 1, n, d->order[k]);
+            continue;
+        }
+        const uint8_t left = p[-1], top = p[-map_stride], top_left = p[-map_stride - 1];
+        const uint8_t nb[5] = {left, top, top_left, left < top ? left : top, left < top ? top : left};
+        const uint32_t pattern = (uint32_t)(left == top) << 2 | (uint32_t)(left == top_left) << 1 | (uint32_t)(top == top_left);
+        for (uint32_t m = 0; m < kPatterns[pattern].n; m++) {
+            ranked[m] = nb[kPatterns[pattern].rank[m]];
+        }
+        d->ctx[k] = kPatterns[pattern].ctx;
+        palette_order(ranked, kPatterns[pattern].n, n, d->order[k]);
+    }
+    d->count = k;
+}
+
+void av1_palette_extend_map(uint8_t *map, ptrdiff_t map_stride, uint32_t onscreen_w, uint32_t onscreen_h, uint32_t w, uint32_t h) {
+    if (onscreen_w < w) {
+        for (uint32_t y = 0; y < onscreen_h; y++) {
+            uint8_t *row = map + (ptrdiff_t)y * map_stride;
+            memset(row + onscreen_w, row[onscreen_w - 1u], w - onscreen_w);
+        }
+    }
+    for (uint32_t y = onscreen_h; y < h; y++) {
+        memcpy(map + (ptrdiff_t)y * map_stride, map + (ptrdiff_t)(onscreen_h - 1u) * map_stride, w);
+    }
+}
+
+static void pal_pred_c(uint8_t *dst, ptrdiff_t stride, const uint16_t *palette, const uint8_t *map, ptrdiff_t map_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = (uint8_t)palette[map[x]];
+        }
+        dst += stride;
+        map += map_stride;
+    }
+}
+
+static void pal_pred16_c(uint16_t *dst,
+                         ptrdiff_t stride,
+                         const uint16_t *palette,
+                         const uint8_t *map,
+                         ptrdiff_t map_stride,
+                         uint32_t w,
+                         uint32_t h) {
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            dst[x] = palette[map[x]];
+        }
+        dst += stride;
+        map += map_stride;
+    }
+}
+
+void av1_palette_dsp_init_c(Av1PaletteDsp *dsp) {
+    dsp->pred = pal_pred_c;
+    dsp->pred16 = pal_pred16_c;
+}
+
+void av1_palette_dsp_init(Av1PaletteDsp *dsp) {
+    av1_palette_dsp_init_c(dsp);
+#if defined(AV1_PALETTE_HAVE_X86)
+    (void)av1_palette_dsp_init_avx2(dsp);
+#endif
+}
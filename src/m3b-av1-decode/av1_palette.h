@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Palette mode (spec 5.11.46 palette_mode_info(), 5.11.49 palette_tokens(), 5.11.50
+// get_palette_color_context() and 7.11.4 "Palette prediction process", see local
+// av1bitstream.html).
+//
+// av1_decode_tile.c reads the syntax; this module holds the parts that do not touch the symbol
+// decoder:
+// - av1_palette_cache() merges the above and left palettes (get_palette_cache()).
+// - av1_palette_diag_contexts() runs get_palette_color_context() for a whole anti-diagonal of the
+//   color index map. Position ( i - j, j ) only reads diagonals i - 1 and i - 2, so the contexts
+//   and ColorOrder of diagonal i are all known before its first symbol is read, and the decoder
+//   loop is left with one symbol read and one table lookup per index.
+// - av1_palette_extend_map() copies the last onscreen column / row over the rest of the block.
+// - Av1PaletteDsp turns a color index map into pixels: palette[ map[ i ][ j ] ]. The AVX2 kernels in
+//   av1_palette_x86.c keep the (at most 8) colors in one register and look them up with a byte
+//   shuffle, 32 (8-bit) or 16 (16-bit) pixels at a time.
+
+#define AV1_PALETTE_MAX_COLORS 8u     // PALETTE_COLORS
+#define AV1_PALETTE_COLOR_CONTEXTS 5u // PALETTE_COLOR_CONTEXTS
+#define AV1_PALETTE_MAX_DIM 64u       // palette blocks are at most 64x64
+
+// get_palette_cache(): the sorted union of the above (above_n colors) and left (left_n colors)
+// palettes without duplicates. Both inputs are ascending. Returns the number of entries.
+uint32_t av1_palette_cache(const uint16_t *above,
+                           uint32_t above_n,
+                           const uint16_t *left,
+                           uint32_t left_n,
+                           uint16_t cache[2 * AV1_PALETTE_MAX_COLORS]);
+
+// sort( colors, 0, n - 1 ).
+void av1_palette_sort(uint16_t *colors, uint32_t n);
+
+// Contexts of one anti-diagonal of the color index map, in the order palette_tokens() reads it.
+typedef struct {
+    uint32_t count;
+    uint8_t row[AV1_PALETTE_MAX_DIM];
+    uint8_t col[AV1_PALETTE_MAX_DIM];
+    uint8_t ctx[AV1_PALETTE_MAX_DIM];                           // Palette_Color_Context[ ColorContextHash ]
+    uint8_t order[AV1_PALETTE_MAX_DIM][AV1_PALETTE_MAX_COLORS]; // ColorOrder[ 0 .. n - 1 ]
+} Av1PaletteDiag;
+
+// Fills d for diagonal i (1 <= i < w + h - 1) of a w x h (onscreen) map of n colors: positions
+// ( i - j, j ) for j from Min( i, w - 1 ) down to Max( 0, i - h + 1 ). map has row stride
+// map_stride and must hold the indices of diagonals i - 2 and i - 1.
+void av1_palette_diag_contexts(const uint8_t *map, ptrdiff_t map_stride, uint32_t i, uint32_t w, uint32_t h, uint32_t n, Av1PaletteDiag *d);
+
+// The tail of palette_tokens(): columns onscreen_w .. w - 1 repeat column onscreen_w - 1, rows
+// onscreen_h .. h - 1 repeat row onscreen_h - 1.
+void av1_palette_extend_map(uint8_t *map, ptrdiff_t map_stride, uint32_t onscreen_w, uint32_t onscreen_h, uint32_t w, uint32_t h);
+
+// dst[ i ][ j ] = palette[ map[ i ][ j ] ] for a w x h transform block (w, h in 4..64). palette
+// holds AV1_PALETTE_MAX_COLORS entries: the SIMD kernels load all of them, whatever the palette
+// size. The 8-bit kernels require entries below 256.
+typedef void (*Av1PalPredFn)(uint8_t *dst, ptrdiff_t stride, const uint16_t *palette, const uint8_t *map, ptrdiff_t map_stride, uint32_t w, uint32_t h);
+typedef void (*Av1PalPredFn16)(uint16_t *dst,
+                               ptrdiff_t stride,
+                               const uint16_t *palette,
+                               const uint8_t *map,
+                               ptrdiff_t map_stride,
+                               uint32_t w,
+                               uint32_t h);
+
+typedef struct {
+    Av1PalPredFn pred;     // BitDepth 8
+    Av1PalPredFn16 pred16; // BitDepth 10 / 12
+} Av1PaletteDsp;
+
+// Scalar reference table.
+void av1_palette_dsp_init_c(Av1PaletteDsp *dsp);
+
+// Best table for the running CPU.
+void av1_palette_dsp_init(Av1PaletteDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_PALETTE_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_palette_dsp_init_avx2(Av1PaletteDsp *dsp);
+#endif
@@ -0,0 +1,99 @@
+#include "av1_palette.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 palette prediction, bit-exact with the scalar reference in av1_palette.c.
+//
+// A palette has at most 8 colors, so the whole palette fits in one 128-bit register (8 bytes for
+// BitDepth 8, 8 words otherwise) and the color index map is expanded with pshufb: 8-bit indices
+// select bytes directly, 16-bit output selects byte pairs 2 * idx and 2 * idx + 1. Functions carry
+// a target attribute so the file builds with the default CFLAGS; av1_palette_dsp_init_avx2()
+// checks the CPU.
+
+#if defined(AV1_PALETTE_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+static AVX2_ATTR void pal_pred_avx2(uint8_t *dst,
+                                    ptrdiff_t stride,
+                                    const uint16_t *palette,
+                                    const uint8_t *map,
+                                    ptrdiff_t map_stride,
+                                    uint32_t w,
+                                    uint32_t h) {
+    const __m128i words = _mm_loadu_si128((const __m128i *)(const void *)palette);
+    const __m128i pal = _mm_packus_epi16(words, words);
+    const __m256i pal256 = _mm256_broadcastsi128_si256(pal);
+    for (uint32_t y = 0; y < h; y++, dst += stride, map += map_stride) {
+        if (w == 4u) {
+            int32_t v;
+            memcpy(&v, map, 4);
+            v = _mm_cvtsi128_si32(_mm_shuffle_epi8(pal, _mm_cvtsi32_si128(v)));
+            memcpy(dst, &v, 4);
+        } else if (w == 8u) {
+            const __m128i idx = _mm_loadl_epi64((const __m128i *)(const void *)map);
+            _mm_storel_epi64((__m128i *)(void *)dst, _mm_shuffle_epi8(pal, idx));
+        } else if (w == 16u) {
+            const __m128i idx = _mm_loadu_si128((const __m128i *)(const void *)map);
+            _mm_storeu_si128((__m128i *)(void *)dst, _mm_shuffle_epi8(pal, idx));
+        } else {
+            for (uint32_t x = 0; x < w; x += 32) {
+                const __m256i idx = _mm256_loadu_si256((const __m256i *)(const void *)(map + x));
+                _mm256_storeu_si256((__m256i *)(void *)(dst + x), _mm256_shuffle_epi8(pal256, idx));
+            }
+        }
+    }
+}
+
+static AVX2_ATTR void pal_pred16_avx2(uint16_t *dst,
+                                      ptrdiff_t stride,
+                                      const uint16_t *palette,
+                                      const uint8_t *map,
+                                      ptrdiff_t map_stride,
+                                      uint32_t w,
+                                      uint32_t h) {
+    const __m128i pal = _mm_loadu_si128((const __m128i *)(const void *)palette);
+    const __m256i pal256 = _mm256_broadcastsi128_si256(pal);
+    // Byte selectors of word idx: idx * 0x0202 + 0x0100.
+    const __m128i mul = _mm_set1_epi16(0x0202), add = _mm_set1_epi16(0x0100);
+    const __m256i mul256 = _mm256_set1_epi16(0x0202), add256 = _mm256_set1_epi16(0x0100);
+    for (uint32_t y = 0; y < h; y++, dst += stride, map += map_stride) {
+        if (w <= 8u) {
+            __m128i idx;
+            if (w == 4u) {
+                int32_t v;
+                memcpy(&v, map, 4);
+                idx = _mm_cvtsi32_si128(v);
+            } else {
+                idx = _mm_loadl_epi64((const __m128i *)(const void *)map);
+            }
+            const __m128i sel = _mm_add_epi16(_mm_mullo_epi16(_mm_cvtepu8_epi16(idx), mul), add);
+            const __m128i px = _mm_shuffle_epi8(pal, sel);
+            if (w == 4u) {
+                _mm_storel_epi64((__m128i *)(void *)dst, px);
+            } else {
+                _mm_storeu_si128((__m128i *)(void *)dst, px);
+            }
+            continue;
+        }
+        for (uint32_t x = 0; x < w; x += 16) {
+            const __m128i idx = _mm_loadu_si128((const __m128i *)(const void *)(map + x));
+            const __m256i sel = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(idx), mul256), add256);
+            _mm256_storeu_si256((__m256i *)(void *)(dst + x), _mm256_shuffle_epi8(pal256, sel));
+        }
+    }
+}
+
+bool av1_palette_dsp_init_avx2(Av1PaletteDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->pred = pal_pred_avx2;
+    dsp->pred16 = pal_pred16_avx2;
+    return true;
+}
+
+#endif
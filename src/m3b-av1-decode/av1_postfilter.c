@@ -0,0 +1,255 @@
+#include "av1_postfilter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Stages whose parameters make them identities: both luma levels 0 (spec 7.14.1 skips every
+// plane), every cdef_idx with zero strengths (the filter adds Round2( 0, 4 )), every plane
+// RESTORE_NONE. Coded lossless frames and intrabc frames have all three.
+static bool pf_lf_noop(const Av1LoopFilter *lf) {
+    return lf->params.level[0] == 0u && lf->params.level[1] == 0u;
+}
+
+static bool pf_cdef_noop(const Av1Cdef *cdef) {
+    const Av1CdefParams *p = &cdef->params;
+    for (uint32_t i = 0; i < (1u << p->bits); i++) {
+        if (p->y_pri[i] || p->y_sec[i] || p->uv_pri[i] || p->uv_sec[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool pf_lr_noop(const Av1Lr *lr) {
+    for (uint32_t p = 0; p < 3; p++) {
+        if (lr->params.frame_type[p] != AV1_RESTORE_NONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool av1_postfilter_init(Av1PostFilter *pf,
+                         Av1FrameBuf *fb,
+                         const Av1LoopFilter *lf,
+                         Av1Cdef *cdef,
+                         const Av1Superres *sr,
+                         Av1Lr *lr,
+                         const Av1FilmGrain *fg,
+                         char *err,
+                         size_t err_cap) {
+    memset(pf, 0, sizeof(*pf));
+    const Av1FrameBuf *out = sr ? sr->dst : fb;
+    if (!fb || (lf && lf->fb != fb) || (cdef && cdef->fb != fb) || (sr && sr->src != fb) || (lr && lr->fb != out) ||
+        (fg && fg->src != out)) {
+        snprintf(err, err_cap, "postfilter: stages not bound to the frame");
+        return false;
+    }
+    pf->fb = fb;
+    pf->lf = lf && !pf_lf_noop(lf) ? lf : NULL;
+    pf->cdef = cdef && !pf_cdef_noop(cdef) ? cdef : NULL;
+    pf->sr = sr;
+    pf->lr = lr && !pf_lr_noop(lr) ? lr : NULL;
+    pf->fg = fg;
+    pf->rows = (fb->height + 63u) / 64u;
+    pf->stripes = pf->lr ? lr->num_stripes : pf->rows;
+    if ((lf && av1_lf_region_rows(lf) != pf->rows) || (cdef && cdef->num_rows != pf->rows)) {
+        snprintf(err, err_cap, "postfilter: stage rows do not match the frame");
+        return false;
+    }
+    if (pf->cdef && !av1_cdef_set_line_ring(cdef, AV1_PF_LINE_SLOTS, err, err_cap)) {
+        return false;
+    }
+    if (pf->lr && !av1_lr_set_line_ring(lr, AV1_PF_LINE_SLOTS, err, err_cap)) {
+        return false;
+    }
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->advanced, NULL);
+    return true;
+}
+
+void av1_postfilter_free(Av1PostFilter *pf) {
+    if (pf->fb) {
+        pthread_cond_destroy(&pf->advanced);
+        pthread_mutex_destroy(&pf->lock);
+        pf->fb = NULL;
+    }
+}
+
+static void pf_set_done(Av1PostFilter *pf, uint32_t stage, uint32_t row) {
+    pthread_mutex_lock(&pf->lock);
+    pf->done[stage][row] = 1;
+    pthread_cond_broadcast(&pf->advanced);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+static void pf_wait_done(Av1PostFilter *pf, uint32_t stage, uint32_t row) {
+    pthread_mutex_lock(&pf->lock);
+    while (!pf->done[stage][row]) {
+        pthread_cond_wait(&pf->advanced, &pf->lock);
+    }
+    pthread_mutex_unlock(&pf->lock);
+}
+
+// Loop restoration reads the upscaled pre-CDEF frame across stripe edges: upscales the rows
+// av1_lr_save_lines() copies at boundary b. Superres of the row holding them overwrites them
+// later with the upscaled CDEF output.
+static void pf_upscale_lr_lines(const Av1PostFilter *pf, uint32_t b) {
+    for (uint32_t p = 0; p < pf->fb->num_planes; p++) {
+        const uint32_t sy = p ? pf->sr->sub_y : 0u;
+        const uint32_t start = (b * AV1_LR_STRIPE_H - AV1_LR_STRIPE_OFF) >> sy;
+        av1_superres_upscale_rows(pf->sr, p, start - 2u, start + 2u);
+    }
+}
+
+// Saves the pre-CDEF rows around boundary b once its ring slot is free: both stripes next to
+// boundary b - AV1_PF_LINE_SLOTS are restored (restoration of a stripe waits for CDEF on the rows
+// it covers, so CDEF is done with that slot as well).
+static void pf_save_lines(Av1PostFilter *pf, uint32_t b) {
+    if (b >= AV1_PF_LINE_SLOTS) {
+        pf_wait_done(pf, AV1_PF_LR, b - AV1_PF_LINE_SLOTS);
+        if (b > AV1_PF_LINE_SLOTS) {
+            pf_wait_done(pf, AV1_PF_LR, b - AV1_PF_LINE_SLOTS - 1u);
+        }
+    }
+    if (pf->cdef) {
+        av1_cdef_save_lines(pf->cdef, b);
+    }
+    if (pf->lr) {
+        if (pf->sr) {
+            pf_upscale_lr_lines(pf, b);
+        }
+        av1_lr_save_lines(pf->lr, b);
+    }
+}
+
+static void pf_recon(Av1PostFilter *pf, uint32_t row) {
+    if (row > 0u) {
+        pf_wait_done(pf, AV1_PF_RECON, row - 1u);
+    }
+    if (pf->recon) {
+        pf->recon(pf->recon_ctx, row);
+    }
+    pf_set_done(pf, AV1_PF_RECON, row);
+}
+
+static void pf_deblock(Av1PostFilter *pf, uint32_t row) {
+    pf_wait_done(pf, AV1_PF_RECON, row + 1u < pf->rows ? row + 1u : row);
+    if (pf->lf) {
+        av1_lf_filter_row(pf->lf, row, AV1_LF_VERT);
+    }
+    // Horizontal edges of this row modify the bottom of the row above.
+    if (row > 0u) {
+        pf_wait_done(pf, AV1_PF_DEBLOCK, row - 1u);
+    }
+    if (pf->lf) {
+        av1_lf_filter_row(pf->lf, row, AV1_LF_HORZ);
+    }
+    // Rows around the top of this row are final now. The last row also owns the loop restoration
+    // boundary below it (stripes are offset 8 rows up).
+    if (row > 0u) {
+        pf_save_lines(pf, row);
+    }
+    if (row + 1u == pf->rows) {
+        for (uint32_t b = row + 1u; b < pf->stripes; b++) {
+            pf_save_lines(pf, b);
+        }
+    }
+    pf_set_done(pf, AV1_PF_DEBLOCK, row);
+}
+
+static void pf_cdef(Av1PostFilter *pf, uint32_t row) {
+    pf_wait_done(pf, AV1_PF_DEBLOCK, row + 1u < pf->rows ? row + 1u : row);
+    if (pf->cdef) {
+        av1_cdef_filter_row(pf->cdef, row);
+    }
+    pf_set_done(pf, AV1_PF_CDEF, row);
+}
+
+static void pf_superres(Av1PostFilter *pf, uint32_t row) {
+    pf_wait_done(pf, AV1_PF_CDEF, row);
+    if (pf->sr) {
+        av1_superres_filter_row(pf->sr, row);
+    }
+    pf_set_done(pf, AV1_PF_SUPERRES, row);
+}
+
+static void pf_lr(Av1PostFilter *pf, uint32_t stripe) {
+    // Stripe s covers the bottom 8 rows of superblock row s - 1 and the rest of row s.
+    pf_wait_done(pf, AV1_PF_SUPERRES, stripe < pf->rows ? stripe : pf->rows - 1u);
+    if (stripe > 0u) {
+        pf_wait_done(pf, AV1_PF_SUPERRES, stripe - 1u);
+    }
+    if (pf->lr) {
+        av1_lr_filter_stripe(pf->lr, stripe);
+    }
+    pf_set_done(pf, AV1_PF_LR, stripe);
+}
+
+// Grain reads rows whose restoration is final; the stripe below still covers the bottom 8 rows.
+static void pf_grain(Av1PostFilter *pf, uint32_t row) {
+    pf_wait_done(pf, AV1_PF_LR, row);
+    if (row + 1u < pf->stripes) {
+        pf_wait_done(pf, AV1_PF_LR, row + 1u);
+    }
+    if (pf->fg) {
+        const uint32_t per_row = 64u / AV1_FG_BLOCK;
+        for (uint32_t r = row * per_row; r < (row + 1u) * per_row && r < pf->fg->num_rows; r++) {
+            av1_film_grain_apply_row(pf->fg, r);
+        }
+    }
+    pf_set_done(pf, AV1_PF_GRAIN, row);
+}
+
+// Rows each stage trails reconstruction by.
+static const uint32_t kStageLag[AV1_PF_STAGES] = {0, 1, 2, 2, 3, 4};
+
+// Job j is stage j % AV1_PF_STAGES of step j / AV1_PF_STAGES, on row step - kStageLag[ stage ].
+static void pf_job(void *ctx, uint32_t job) {
+    Av1PostFilter *pf = (Av1PostFilter *)ctx;
+    const uint32_t stage = job % AV1_PF_STAGES;
+    const uint32_t step = job / AV1_PF_STAGES;
+    if (step < kStageLag[stage]) {
+        return;
+    }
+    const uint32_t row = step - kStageLag[stage];
+    if (row >= (stage == AV1_PF_LR ? pf->stripes : pf->rows)) {
+        return;
+    }
+    switch (stage) {
+    case AV1_PF_RECON:
+        pf_recon(pf, row);
+        break;
+    case AV1_PF_DEBLOCK:
+        pf_deblock(pf, row);
+        break;
+    case AV1_PF_CDEF:
+        pf_cdef(pf, row);
+        break;
+    case AV1_PF_SUPERRES:
+        pf_superres(pf, row);
+        break;
+    case AV1_PF_LR:
+        pf_lr(pf, row);
+        break;
+    default:
+        pf_grain(pf, row);
+        break;
+    }
+}
+
+void av1_postfilter_run(Av1PostFilter *pf, Av1ThreadPool *pool, Av1JobFn recon, void *recon_ctx) {
+    pf->recon = recon;
+    pf->recon_ctx = recon_ctx;
+    memset(pf->done, 0, sizeof(pf->done));
+    // Film grain trails the most; loop restoration has at most one stripe more than there are rows.
+    const uint32_t steps = pf->rows + kStageLag[AV1_PF_GRAIN];
+    const uint32_t num_jobs = steps * AV1_PF_STAGES;
+    if (!pool || pool->num_threads < 2u) {
+        for (uint32_t j = 0; j < num_jobs; j++) {
+            pf_job(pf, j);
+        }
+        return;
+    }
+    av1_thread_pool_run(pool, pf_job, pf, num_jobs);
+}
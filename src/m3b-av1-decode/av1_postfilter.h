@@ -0,0 +1,86 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_cdef.h"
+#include "av1_film_grain.h"
+#include "av1_frame_buf.h"
+#include "av1_loopfilter.h"
+#include "av1_restoration.h"
+#include "av1_superres.h"
+#include "av1_thread_pool.h"
+
+// Row-pipelined reconstruction and post-filter chain.
+//
+// The frame is handled in 64-luma-row superblock rows. Once reconstruction finishes row N, row
+// N - 1 is deblocked (intra prediction of row N reads the unfiltered bottom of row N - 1), CDEF and
+// superres upscaling run on row N - 2 (deblocking row N - 1 still changes the bottom of row N - 2),
+// loop restoration on stripe N - 3 and film grain synthesis on row N - 4. All stages are jobs of
+// one av1_thread_pool_run() batch, in that interleaved order, and each job waits only on jobs
+// before it, so they overlap on the workers. Every filter but superres works in place; the pre-CDEF
+// rows that CDEF and loop restoration read across stripe edges are kept in line-buffer rings of
+// AV1_PF_LINE_SLOTS boundaries instead of per-frame arrays. With superres, loop restoration runs on
+// the upscaled frame and its boundary rows are upscaled before CDEF. Film grain is an output stage:
+// it reads the finished rows and writes a separate output frame, and callers that do not need grain
+// leave it out. The result is identical to running the stages one after the other on the whole
+// frame.
+
+enum {
+    AV1_PF_RECON = 0,
+    AV1_PF_DEBLOCK,
+    AV1_PF_CDEF,
+    AV1_PF_SUPERRES,
+    AV1_PF_LR,
+    AV1_PF_GRAIN,
+    AV1_PF_STAGES,
+};
+
+// Line-buffer ring size. Deblocking row b refills the slot of boundary b - AV1_PF_LINE_SLOTS, so it
+// waits for loop restoration on the stripes next to that boundary; that wait points back to jobs
+// started at least one step earlier as long as the ring is longer than the restoration lag.
+#define AV1_PF_LINE_SLOTS 4u
+
+#define AV1_PF_MAX_ROWS (AV1_FRAME_MAX_DIM / 64u + 1u)
+
+typedef struct {
+    Av1FrameBuf *fb;
+    const Av1LoopFilter *lf; // NULL: no deblocking
+    Av1Cdef *cdef;           // NULL: no CDEF
+    const Av1Superres *sr;   // NULL: no superres
+    Av1Lr *lr;               // NULL: no loop restoration
+    const Av1FilmGrain *fg;  // NULL: no film grain (the filtered frame is the output)
+    uint32_t rows;           // superblock rows of 64 luma rows
+    uint32_t stripes;        // loop restoration stripes (rows or rows + 1)
+
+    Av1JobFn recon;
+    void *recon_ctx;
+
+    pthread_mutex_t lock;
+    pthread_cond_t advanced;
+    uint8_t done[AV1_PF_STAGES][AV1_PF_MAX_ROWS]; // guarded by lock
+} Av1PostFilter;
+
+// Binds the stages of one frame and shrinks the CDEF and loop restoration line buffers to
+// AV1_PF_LINE_SLOTS boundaries. Any stage may be NULL. lf, cdef and sr (as its source) must be bound
+// to fb; lr and fg (as its source) to the upscaled frame when sr is given, else to fb. Deblocking,
+// CDEF and loop restoration are dropped when their parameters leave every sample unchanged, so
+// coded lossless frames run reconstruction (and superres / film grain) only.
+bool av1_postfilter_init(Av1PostFilter *pf,
+                         Av1FrameBuf *fb,
+                         const Av1LoopFilter *lf,
+                         Av1Cdef *cdef,
+                         const Av1Superres *sr,
+                         Av1Lr *lr,
+                         const Av1FilmGrain *fg,
+                         char *err,
+                         size_t err_cap);
+
+// Runs recon( recon_ctx, r ) for every superblock row r in order (NULL: the frame is already
+// reconstructed) with the post-filter chain following it on pool (NULL or one thread: on the
+// caller, in the same order).
+void av1_postfilter_run(Av1PostFilter *pf, Av1ThreadPool *pool, Av1JobFn recon, void *recon_ctx);
+
+void av1_postfilter_free(Av1PostFilter *pf);
@@ -0,0 +1,50 @@
+#include "av1_recon.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PX_BD 8u
+#define PX_BD_PARAM
+#include "av1_recon_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PX_BD
+#undef PX_BD_PARAM
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#include "av1_recon_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PX_BD
+#undef PX_BD_PARAM
+
+bool av1_recon_dsp_init(Av1ReconDsp *dsp, uint32_t bit_depth, char *err, size_t err_cap) {
+    if (!dsp) {
+        snprintf(err, err_cap, "recon: invalid args");
+        return false;
+    }
+    if (bit_depth != 8u && bit_depth != 10u && bit_depth != 12u) {
+        snprintf(err, err_cap, "recon: unsupported BitDepth %u", bit_depth);
+        return false;
+    }
+    memset(dsp, 0, sizeof(*dsp));
+    dsp->bit_depth = bit_depth;
+    dsp->high_bitdepth = bit_depth > 8u;
+    if (dsp->high_bitdepth) {
+        av1_intra_pred_dsp_init_16(&dsp->ipred16, bit_depth);
+        av1_cfl_dsp_init_16(&dsp->cfl16, bit_depth);
+        dsp->add_residual16 = av1_recon_add_residual_c_16;
+    } else {
+        av1_intra_pred_dsp_init(&dsp->ipred);
+        av1_cfl_dsp_init(&dsp->cfl);
+        dsp->add_residual = av1_recon_add_residual_c;
+    }
+    av1_palette_dsp_init(&dsp->pal);
+    av1_intrabc_dsp_init(&dsp->ibc);
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_cfl.h"
+#include "av1_intra_pred.h"
+#include "av1_intrabc.h"
+#include "av1_palette.h"
+
+// Per-bit-depth reconstruction kernels.
+//
+// Pixel kernels exist twice: uint8_t for BitDepth 8 and uint16_t for BitDepth 10 / 12, generated
+// from one source through the *_tmpl.inc files. av1_recon_dsp_init() picks the pixel type once per
+// sequence (BitDepth from color_config) and fills only that half of the table, so 8-bit streams
+// keep 8-bit planes and 8-bit kernels end to end.
+
+// Adds an inverse-transform Residual block (row-major, stride w) to the prediction in dst:
+// CurrFrame = Clip1( CurrFrame + Residual ) (spec 7.13.3 final step).
+typedef void (*Av1ReconAddFn)(uint8_t *dst, ptrdiff_t stride, const int32_t *residual, uint32_t w, uint32_t h);
+typedef void (*Av1ReconAddFn16)(uint16_t *dst,
+                                ptrdiff_t stride,
+                                const int32_t *residual,
+                                uint32_t w,
+                                uint32_t h,
+                                uint32_t bit_depth);
+
+typedef struct {
+    uint32_t bit_depth;
+    bool high_bitdepth; // BitDepth > 8: planes are uint16_t and the *16 tables are valid
+    // BitDepth 8.
+    Av1IntraPredDsp ipred;
+    Av1CflDsp cfl;
+    Av1ReconAddFn add_residual;
+    // BitDepth 10 / 12.
+    Av1IntraPredDsp16 ipred16;
+    Av1CflDsp16 cfl16;
+    Av1ReconAddFn16 add_residual16;
+    // Palette prediction: pal.pred for BitDepth 8, pal.pred16 otherwise.
+    Av1PaletteDsp pal;
+    // Intra block copy prediction: ibc.copy for BitDepth 8, ibc.copy16 otherwise.
+    Av1IntrabcDsp ibc;
+} Av1ReconDsp;
+
+// Bytes per plane sample for a bit depth (1 or 2).
+static inline uint32_t av1_recon_pixel_bytes(uint32_t bit_depth) {
+    return bit_depth > 8u ? 2u : 1u;
+}
+
+// Fills the table for BitDepth 8, 10 or 12 with the best kernels for the running CPU.
+bool av1_recon_dsp_init(Av1ReconDsp *dsp, uint32_t bit_depth, char *err, size_t err_cap);
+
+// Scalar residual add, 8- and 16-bit.
+void av1_recon_add_residual_c(uint8_t *dst, ptrdiff_t stride, const int32_t *residual, uint32_t w, uint32_t h);
+void av1_recon_add_residual_c_16(uint16_t *dst,
+                                 ptrdiff_t stride,
+                                 const int32_t *residual,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 uint32_t bit_depth);
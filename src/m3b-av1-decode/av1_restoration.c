@@ -0,0 +1,343 @@
+#include "av1_restoration.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Spec 7.17.3 Sgr_Params.
+const uint8_t av1_sgr_params[16][4] = {
+    {2, 12, 1, 4},  {2, 15, 1, 6},  {2, 18, 1, 8},  {2, 21, 1, 9},  {2, 24, 1, 10}, {2, 29, 1, 11},
+    {2, 36, 1, 12}, {2, 45, 1, 13}, {2, 56, 1, 14}, {2, 68, 1, 15}, {0, 0, 1, 5},   {0, 0, 1, 8},
+    {0, 0, 1, 11},  {0, 0, 1, 14},  {2, 30, 0, 0},  {2, 75, 0, 0},
+};
+
+// Spec 7.17.3 a2 for z = 0 .. 255: 1 at z == 0, 256 from z == 255 on, else
+// ( ( z << SGRPROJ_SGR_BITS ) + z / 2 ) / ( z + 1 ).
+const int32_t av1_sgr_a2[256] = {
+    1, 128, 171, 192, 205, 213, 219, 224, 228, 230, 233, 235, 236, 238, 239, 240, 241, 242, 243, 243, 244, 244,
+    245, 245, 246, 246, 247, 247, 247, 247, 248, 248, 248, 248, 249, 249, 249, 249, 249, 250, 250, 250, 250, 250,
+    250, 250, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252,
+    252, 252, 252, 252, 252, 252, 252, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253,
+    253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 254, 254, 254, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 256,
+};
+
+static inline int32_t lr_round2(int32_t x, uint32_t n) {
+    return n ? (x + (1 << (n - 1))) >> n : x;
+}
+
+static inline int32_t lr_clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// Wiener intermediate rows: h + 6 rows of at most 64 columns.
+#define LR_INTER_STRIDE 64
+
+// Spec 7.17.4 horizontal pass (bit-depth independent): intermediate[ r ][ c ] for r < h + 6.
+static void lr_wiener_h(int16_t *inter, const uint16_t *src, uint32_t w, uint32_t h, const int16_t *hf, uint32_t bit_depth) {
+    const uint32_t round0 = bit_depth == 12u ? 5u : 3u;
+    const int32_t offset = 1 << (bit_depth + 7u - round0 - 1u);
+    const int32_t limit = (1 << (bit_depth + 1u + 7u - round0)) - 1;
+    for (uint32_t r = 0; r < h + 6u; r++) {
+        const uint16_t *s = src + ((ptrdiff_t)r - AV1_LR_MARGIN) * AV1_LR_BUF_STRIDE - AV1_LR_MARGIN;
+        for (uint32_t c = 0; c < w; c++) {
+            int32_t sum = 0;
+            for (uint32_t t = 0; t < 7; t++) {
+                sum += hf[t] * s[c + t];
+            }
+            inter[r * LR_INTER_STRIDE + c] = (int16_t)lr_clip3(-offset, limit - offset, lr_round2(sum, round0));
+        }
+    }
+}
+
+// Integral images of the chunk buffer rows -3 .. h + 2 and columns -3 .. w + 3:
+// sum[ y * LR_INT_STRIDE + x ] covers buffer rows < y and columns < x (both from -3). Squares wrap
+// modulo 2^32, which box differences undo (a 5x5 box of 12-bit squares fits in 32 bits).
+#define LR_INT_STRIDE (AV1_LR_BUF_STRIDE + 1)
+
+static void lr_integral(const uint16_t *src, uint32_t w, uint32_t h, uint32_t *sum, uint32_t *sq) {
+    const uint32_t cols = w + 7u;
+    memset(sum, 0, (cols + 1u) * sizeof(uint32_t));
+    memset(sq, 0, (cols + 1u) * sizeof(uint32_t));
+    for (uint32_t y = 0; y < h + 6u; y++) {
+        const uint16_t *s = src + ((ptrdiff_t)y - AV1_LR_MARGIN) * AV1_LR_BUF_STRIDE - AV1_LR_MARGIN;
+        const uint32_t *su_up = sum + y * LR_INT_STRIDE;
+        const uint32_t *sq_up = sq + y * LR_INT_STRIDE;
+        uint32_t *su = sum + (y + 1u) * LR_INT_STRIDE;
+        uint32_t *sq_row = sq + (y + 1u) * LR_INT_STRIDE;
+        uint32_t rs = 0, rq = 0;
+        su[0] = sq_row[0] = 0;
+        for (uint32_t x = 0; x < cols; x++) {
+            rs += s[x];
+            rq += (uint32_t)s[x] * s[x];
+            su[x + 1u] = su_up[x + 1u] + rs;
+            sq_row[x + 1u] = sq_up[x + 1u] + rq;
+        }
+    }
+}
+
+// A / B of spec 7.17.3 for i = -1 .. h, j = -1 .. w at ab[ ( i + 1 ) * LR_AB_STRIDE + j + 1 ]; pass 0
+// only needs the odd rows.
+#define LR_AB_STRIDE 72
+
+static void lr_box_ab(const uint32_t *sum,
+                      const uint32_t *sq,
+                      uint32_t w,
+                      uint32_t h,
+                      uint32_t r,
+                      uint32_t eps,
+                      uint32_t pass,
+                      uint32_t bit_depth,
+                      int32_t *A,
+                      int32_t *B) {
+    const uint32_t n = (2u * r + 1u) * (2u * r + 1u);
+    const uint32_t s = ((1u << 20) + n * n * eps / 2u) / (n * n * eps);
+    const uint32_t one_over_n = ((1u << 12) + n / 2u) / n;
+    const uint32_t shift = bit_depth - 8u;
+    for (int32_t i = -1; i <= (int32_t)h; i++) {
+        if (pass == 0 && !(i & 1)) {
+            continue;
+        }
+        // Integral rows bounding buffer rows i - r .. i + r.
+        const uint32_t *s0 = sum + (i + AV1_LR_MARGIN - (int32_t)r) * LR_INT_STRIDE;
+        const uint32_t *s1 = sum + (i + AV1_LR_MARGIN + (int32_t)r + 1) * LR_INT_STRIDE;
+        const uint32_t *q0 = sq + (i + AV1_LR_MARGIN - (int32_t)r) * LR_INT_STRIDE;
+        const uint32_t *q1 = sq + (i + AV1_LR_MARGIN + (int32_t)r + 1) * LR_INT_STRIDE;
+        for (int32_t j = -1; j <= (int32_t)w; j++) {
+            const int32_t x0 = j + AV1_LR_MARGIN - (int32_t)r, x1 = j + AV1_LR_MARGIN + (int32_t)r + 1;
+            const uint32_t b = s1[x1] - s1[x0] - s0[x1] + s0[x0];
+            const uint32_t a = lr_round2((int32_t)(q1[x1] - q1[x0] - q0[x1] + q0[x0]), 2u * shift);
+            const uint32_t d = lr_round2((int32_t)b, shift);
+            const int32_t p = (int32_t)(a * n) - (int32_t)(d * d);
+            const uint32_t z = (uint32_t)(((uint64_t)(p > 0 ? p : 0) * s + (1u << 19)) >> 20);
+            const int32_t a2 = av1_sgr_a2[z > 255u ? 255u : z];
+            const uint32_t b2 = (uint32_t)(256 - a2) * b * one_over_n;
+            A[(i + 1) * LR_AB_STRIDE + j + 1] = a2;
+            B[(i + 1) * LR_AB_STRIDE + j + 1] = (int32_t)((b2 + (1u << 11)) >> 12);
+        }
+    }
+}
+
+// Spec 7.17.3 output F (flt, row stride 64).
+static void lr_box_filter(const uint16_t *src, const int32_t *A, const int32_t *B, uint32_t w, uint32_t h, uint32_t pass, int32_t *flt) {
+    for (uint32_t i = 0; i < h; i++) {
+        const int32_t *a0 = A + i * LR_AB_STRIDE + 1, *a1 = a0 + LR_AB_STRIDE, *a2 = a1 + LR_AB_STRIDE;
+        const int32_t *b0 = B + i * LR_AB_STRIDE + 1, *b1 = b0 + LR_AB_STRIDE, *b2 = b1 + LR_AB_STRIDE;
+        for (int32_t j = 0; j < (int32_t)w; j++) {
+            int32_t a, b;
+            uint32_t shift = 5;
+            if (pass == 0) {
+                if (i & 1u) {
+                    // Row i is odd: only its own A / B count.
+                    a = 6 * a1[j] + 5 * (a1[j - 1] + a1[j + 1]);
+                    b = 6 * b1[j] + 5 * (b1[j - 1] + b1[j + 1]);
+                    shift = 4;
+                } else {
+                    a = 6 * (a0[j] + a2[j]) + 5 * (a0[j - 1] + a0[j + 1] + a2[j - 1] + a2[j + 1]);
+                    b = 6 * (b0[j] + b2[j]) + 5 * (b0[j - 1] + b0[j + 1] + b2[j - 1] + b2[j + 1]);
+                }
+            } else {
+                a = 4 * (a1[j] + a0[j] + a2[j] + a1[j - 1] + a1[j + 1]) + 3 * (a0[j - 1] + a0[j + 1] + a2[j - 1] + a2[j + 1]);
+                b = 4 * (b1[j] + b0[j] + b2[j] + b1[j - 1] + b1[j + 1]) + 3 * (b0[j - 1] + b0[j + 1] + b2[j - 1] + b2[j + 1]);
+            }
+            const int32_t v = a * src[(ptrdiff_t)i * AV1_LR_BUF_STRIDE + j] + b;
+            flt[i * 64u + (uint32_t)j] = lr_round2(v, 8u + shift - 4u);
+        }
+    }
+}
+
+// flt[ pass ] for both passes of set (left untouched for a pass whose radius is 0).
+static void lr_sgr_filters(const uint16_t *src, uint32_t w, uint32_t h, uint32_t set, uint32_t bit_depth, int32_t (*flt)[64 * 64]) {
+    uint32_t sum[(64 + 7) * LR_INT_STRIDE];
+    uint32_t sq[(64 + 7) * LR_INT_STRIDE];
+    int32_t A[(64 + 2) * LR_AB_STRIDE];
+    int32_t B[(64 + 2) * LR_AB_STRIDE];
+    lr_integral(src, w, h, sum, sq);
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        const uint32_t r = av1_sgr_params[set][pass * 2u];
+        if (r == 0) {
+            continue;
+        }
+        lr_box_ab(sum, sq, w, h, r, av1_sgr_params[set][pass * 2u + 1u], pass, bit_depth, A, B);
+        lr_box_filter(src, A, B, w, h, pass, flt[pass]);
+    }
+}
+
+// ---- Pixel-type instantiations ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#include "av1_restoration_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#include "av1_restoration_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+void av1_lr_dsp_init(Av1LrDsp *dsp) {
+    av1_lr_dsp_init_c(dsp);
+#if defined(AV1_LR_HAVE_X86)
+    (void)av1_lr_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_lr_dsp_init_16(Av1LrDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_lr_dsp_init_c_16(dsp, bit_depth);
+}
+
+void av1_lr_params_default(Av1LrParams *p) {
+    memset(p, 0, sizeof(*p));
+    for (uint32_t i = 0; i < 3; i++) {
+        p->unit_size[i] = 64;
+    }
+}
+
+uint32_t av1_lr_unit_count(uint32_t unit_size, uint32_t frame_size) {
+    const uint32_t n = (frame_size + (unit_size >> 1)) / unit_size;
+    return n > 1u ? n : 1u;
+}
+
+// ---- Frame binding ----
+
+bool av1_lr_init(Av1Lr *lr, Av1FrameBuf *fb, const Av1LrParams *params, const Av1LrUnit *const units[3], char *err, size_t err_cap) {
+    memset(lr, 0, sizeof(*lr));
+    if (!fb || !params || !units) {
+        snprintf(err, err_cap, "restoration: invalid args");
+        return false;
+    }
+    lr->fb = fb;
+    lr->params = *params;
+    lr->sub_x = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    lr->sub_y = fb->layout == AV1_LAYOUT_I420;
+    lr->num_stripes = (fb->height + AV1_LR_STRIPE_OFF + AV1_LR_STRIPE_H - 1u) / AV1_LR_STRIPE_H;
+    lr->line_slots = lr->num_stripes;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t type = params->frame_type[p];
+        const uint32_t size = params->unit_size[p];
+        if (type > AV1_RESTORE_SWITCHABLE) {
+            snprintf(err, err_cap, "restoration: plane %u has invalid type %u", p, type);
+            return false;
+        }
+        if (type == AV1_RESTORE_NONE) {
+            continue;
+        }
+        if (size != 32u && size != 64u && size != 128u && size != 256u) {
+            snprintf(err, err_cap, "restoration: plane %u has invalid unit size %u", p, size);
+            return false;
+        }
+        if (!units[p]) {
+            snprintf(err, err_cap, "restoration: plane %u has no units", p);
+            return false;
+        }
+        lr->units[p] = units[p];
+        lr->unit_rows[p] = av1_lr_unit_count(size, fb->plane_h[p]);
+        lr->unit_cols[p] = av1_lr_unit_count(size, fb->plane_w[p]);
+        lr->lines[p] = malloc((size_t)lr->num_stripes * 4u * fb->plane_w[p] * sizeof(uint16_t));
+        if (!lr->lines[p]) {
+            av1_lr_free(lr);
+            snprintf(err, err_cap, "restoration: out of memory");
+            return false;
+        }
+    }
+    if (fb->bit_depth > 8u) {
+        av1_lr_dsp_init_16(&lr->dsp16, fb->bit_depth);
+    } else {
+        av1_lr_dsp_init(&lr->dsp);
+    }
+    return true;
+}
+
+void av1_lr_free(Av1Lr *lr) {
+    for (uint32_t p = 0; p < 3; p++) {
+        free(lr->lines[p]);
+        lr->lines[p] = NULL;
+    }
+}
+
+bool av1_lr_set_line_ring(Av1Lr *lr, uint32_t slots, char *err, size_t err_cap) {
+    if (slots == 0u) {
+        snprintf(err, err_cap, "restoration: empty line ring");
+        return false;
+    }
+    if (slots >= lr->line_slots) {
+        return true;
+    }
+    for (uint32_t p = 0; p < 3; p++) {
+        if (!lr->lines[p]) {
+            continue;
+        }
+        uint16_t *lines = realloc(lr->lines[p], (size_t)slots * 4u * lr->fb->plane_w[p] * sizeof(uint16_t));
+        if (!lines) {
+            snprintf(err, err_cap, "restoration: out of memory");
+            return false;
+        }
+        lr->lines[p] = lines;
+    }
+    lr->line_slots = slots;
+    return true;
+}
+
+void av1_lr_save_lines(Av1Lr *lr, uint32_t boundary) {
+    if (boundary == 0u || boundary >= lr->num_stripes) {
+        return;
+    }
+    for (uint32_t p = 0; p < lr->fb->num_planes; p++) {
+        if (!lr->lines[p]) {
+            continue;
+        }
+        if (lr->fb->bytes_per_sample == 1u) {
+            lr_save_lines_plane(lr, p, boundary);
+        } else {
+            lr_save_lines_plane_16(lr, p, boundary);
+        }
+    }
+}
+
+void av1_lr_filter_stripe(const Av1Lr *lr, uint32_t stripe) {
+    for (uint32_t p = 0; p < lr->fb->num_planes; p++) {
+        if (!lr->lines[p]) {
+            continue;
+        }
+        if (lr->fb->bytes_per_sample == 1u) {
+            lr_stripe_plane(lr, &lr->dsp, p, stripe);
+        } else {
+            lr_stripe_plane_16(lr, &lr->dsp16, p, stripe);
+        }
+    }
+}
+
+void av1_lr_filter_frame(const Av1Lr *lr) {
+    for (uint32_t s = 0; s < lr->num_stripes; s++) {
+        av1_lr_filter_stripe(lr, s);
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+
+// Loop restoration (spec 7.17 "Loop restoration process"): Wiener and self-guided filters.
+//
+// The frame is filtered in place, one 64-row stripe (offset 8 luma rows up, as in the spec) at a
+// time. Inside its stripe a filter reads the CDEF output, and across the stripe edges it reads the
+// two deblocked, pre-CDEF rows on each side. Those rows are kept in line buffers:
+// av1_lr_save_lines() must run on every stripe boundary after deblocking and before CDEF. No full
+// frame copy is made. Each stripe is cut into chunks at most 64 samples wide that stay inside one
+// restoration unit. A chunk's source samples, with a three-sample margin resolved by the spec's
+// get_source_sample() rules, are copied into a small 16-bit buffer, and the kernels filter that
+// buffer straight into the frame. The unfiltered left margin is carried over from the previous
+// chunk. Stripes depend only on the frame and the line buffers, so they may run in any order.
+//
+// Scalar kernels (av1_restoration_tmpl.inc) are the bit-exact reference for uint8_t and uint16_t
+// pixels. The Wiener and self-guided kernels have AVX2 versions for 8-bit frames
+// (av1_restoration_x86.c).
+
+// FrameRestorationType / LrType values.
+enum {
+    AV1_RESTORE_NONE = 0,
+    AV1_RESTORE_WIENER,
+    AV1_RESTORE_SGRPROJ,
+    AV1_RESTORE_SWITCHABLE,
+};
+
+#define AV1_LR_STRIPE_H 64u
+#define AV1_LR_STRIPE_OFF 8u
+
+// Chunk buffer: up to 64 x 64 samples plus a margin of 3 on every side. Columns past the right
+// margin hold copies of its last one so vector kernels may read whole 16-sample groups.
+#define AV1_LR_MARGIN 3
+#define AV1_LR_CHUNK 64u
+#define AV1_LR_BUF_STRIDE 96
+#define AV1_LR_BUF_ROWS (64 + 2 * AV1_LR_MARGIN)
+
+// lr_params(): per-plane FrameRestorationType and LoopRestorationSize.
+typedef struct {
+    uint8_t frame_type[3];
+    uint16_t unit_size[3];
+} Av1LrParams;
+
+// read_lr_unit() output for one restoration unit.
+typedef struct {
+    uint8_t type;         // LrType: AV1_RESTORE_NONE / _WIENER / _SGRPROJ
+    uint8_t sgr_set;      // LrSgrSet
+    int8_t wiener[2][3];  // LrWiener[ pass ][ i ]: pass 0 vertical, 1 horizontal
+    int16_t sgr_xqd[2];   // LrSgrXqd
+} Av1LrUnit;
+
+// Spec 7.17.4: 7-tap filters, [ 0 ] vertical, [ 1 ] horizontal; entry 7 is 0.
+typedef void (*Av1LrWienerFn)(uint8_t *dst,
+                              ptrdiff_t stride,
+                              const uint16_t *src,
+                              uint32_t w,
+                              uint32_t h,
+                              const int16_t filter[2][8]);
+typedef void (*Av1LrWienerFn16)(uint16_t *dst,
+                                ptrdiff_t stride,
+                                const uint16_t *src,
+                                uint32_t w,
+                                uint32_t h,
+                                const int16_t filter[2][8],
+                                uint32_t bit_depth);
+
+// Spec 7.17.2 / 7.17.3 with LrSgrSet set and LrSgrXqd xqd.
+typedef void (*Av1LrSgrFn)(uint8_t *dst,
+                           ptrdiff_t stride,
+                           const uint16_t *src,
+                           uint32_t w,
+                           uint32_t h,
+                           uint32_t set,
+                           const int16_t xqd[2]);
+typedef void (*Av1LrSgrFn16)(uint16_t *dst,
+                             ptrdiff_t stride,
+                             const uint16_t *src,
+                             uint32_t w,
+                             uint32_t h,
+                             uint32_t set,
+                             const int16_t xqd[2],
+                             uint32_t bit_depth);
+
+// Kernels read a chunk buffer (src at the first filtered sample, row stride AV1_LR_BUF_STRIDE) and
+// write w x h samples (w, h <= 64).
+typedef struct {
+    Av1LrWienerFn wiener;
+    Av1LrSgrFn sgr;
+} Av1LrDsp;
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1LrWienerFn16 wiener;
+    Av1LrSgrFn16 sgr;
+} Av1LrDsp16;
+
+// Scalar reference tables.
+void av1_lr_dsp_init_c(Av1LrDsp *dsp);
+void av1_lr_dsp_init_c_16(Av1LrDsp16 *dsp, uint32_t bit_depth);
+
+// Best tables for the running CPU.
+void av1_lr_dsp_init(Av1LrDsp *dsp);
+void av1_lr_dsp_init_16(Av1LrDsp16 *dsp, uint32_t bit_depth);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_LR_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_lr_dsp_init_avx2(Av1LrDsp *dsp);
+#endif
+
+// Sgr_Params[ set ] = { r0, eps0, r1, eps1 }.
+extern const uint8_t av1_sgr_params[16][4];
+
+// Spec 7.17.3 a2 for z = 0 .. 255 (z above 255 gives 256 as well).
+extern const int32_t av1_sgr_a2[256];
+
+// lr_params() defaults: no restoration.
+void av1_lr_params_default(Av1LrParams *p);
+
+// count_units_in_frame().
+uint32_t av1_lr_unit_count(uint32_t unit_size, uint32_t frame_size);
+
+typedef struct {
+    Av1FrameBuf *fb;
+    Av1LrParams params;
+    const Av1LrUnit *units[3]; // unit_rows[ p ] x unit_cols[ p ], row-major
+    uint32_t unit_rows[3];
+    uint32_t unit_cols[3];
+    uint32_t sub_x;
+    uint32_t sub_y;
+    Av1LrDsp dsp;
+    Av1LrDsp16 dsp16;
+
+    // Deblocked rows StripeStartY - 2 .. StripeStartY + 1 of every stripe boundary b, per plane:
+    // 4 rows of plane_w samples at lines[ p ] + ( b % line_slots ) * 4 * plane_w.
+    uint16_t *lines[3];
+    uint32_t num_stripes;
+    uint32_t line_slots; // boundaries held in lines; boundary b lives in slot b % line_slots
+} Av1Lr;
+
+// Binds a frame and its restoration units (units[ p ] may be NULL for planes whose
+// frame_type is AV1_RESTORE_NONE). Allocates the line buffers.
+bool av1_lr_init(Av1Lr *lr, Av1FrameBuf *fb, const Av1LrParams *params, const Av1LrUnit *const units[3], char *err, size_t err_cap);
+
+void av1_lr_free(Av1Lr *lr);
+
+// Shrinks the line buffers to a ring of slots boundaries (av1_lr_init() keeps one per boundary).
+// Boundary b then reuses the slot of boundary b - slots, so it must not be saved before stripes
+// b - slots - 1 and b - slots are filtered.
+bool av1_lr_set_line_ring(Av1Lr *lr, uint32_t slots, char *err, size_t err_cap);
+
+// Saves the deblocked rows around the top of stripe b (1 .. num_stripes - 1). Must run before CDEF
+// touches those rows.
+void av1_lr_save_lines(Av1Lr *lr, uint32_t boundary);
+
+// Filters stripe s in place; it must hold CDEF output and both of its boundaries must be saved.
+void av1_lr_filter_stripe(const Av1Lr *lr, uint32_t stripe);
+
+// Filters every stripe; every boundary must have been saved before CDEF ran.
+void av1_lr_filter_frame(const Av1Lr *lr);
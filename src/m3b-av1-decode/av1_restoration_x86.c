@@ -0,0 +1,268 @@
+#include "av1_restoration.h"
+#include "av1_cpu.h"
+
+#include <string.h>
+
+// AVX2 loop restoration kernels for 8-bit frames, bit-exact with the scalar kernels in
+// av1_restoration.c / av1_restoration_tmpl.inc.
+//
+// Wiener: both 7-tap passes run on 16 columns at a time. Tap pairs are interleaved and summed
+// with madd into 32-bit lanes, so the 8-bit intermediate range never overflows; packs_epi32 puts
+// the lanes back in order.
+//
+// Self-guided: box sums are column sums over 2r + 1 rows followed by 2r + 1 shifted loads
+// across; the squares of 8-bit samples fit 16-bit lanes before widening. A and B are computed on 8 lanes with a gather from av1_sgr_a2, then the
+// 3x3 weighting and the projection run on 8 lanes as well. Functions carry a target attribute so
+// the file builds with the default CFLAGS; av1_lr_dsp_init_avx2() checks the CPU.
+
+#if defined(AV1_LR_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+#define BS AV1_LR_BUF_STRIDE
+
+// Stores the first n (<= 16) bytes of v.
+static AVX2_ATTR inline void store_u8x16(uint8_t *dst, __m128i v, uint32_t n) {
+    if (n >= 16u) {
+        _mm_storeu_si128((__m128i *)dst, v);
+    } else {
+        uint8_t tmp[16];
+        _mm_storeu_si128((__m128i *)tmp, v);
+        memcpy(dst, tmp, n);
+    }
+}
+
+// ---- Wiener ----
+
+static AVX2_ATTR inline __m256i tap_pair(const int16_t *f, uint32_t t) {
+    return _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)f[t + 1u] << 16) | (uint16_t)f[t]));
+}
+
+static AVX2_ATTR void lr_wiener_avx2(uint8_t *dst,
+                                     ptrdiff_t stride,
+                                     const uint16_t *src,
+                                     uint32_t w,
+                                     uint32_t h,
+                                     const int16_t filter[2][8]) {
+    // 8-bit: InterRound0 3, InterRound1 11, intermediate clipped to [-2048, 6143].
+    _Alignas(32) int16_t inter[(64 + 6) * 64];
+    const __m256i hf[4] = {tap_pair(filter[1], 0), tap_pair(filter[1], 2), tap_pair(filter[1], 4), tap_pair(filter[1], 6)};
+    const __m256i vf[4] = {tap_pair(filter[0], 0), tap_pair(filter[0], 2), tap_pair(filter[0], 4), tap_pair(filter[0], 6)};
+    const __m256i round0 = _mm256_set1_epi32(1 << 2);
+    const __m256i round1 = _mm256_set1_epi32(1 << 10);
+    const __m256i lo_clip = _mm256_set1_epi16(-2048);
+    const __m256i hi_clip = _mm256_set1_epi16(6143);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (uint32_t r = 0; r < h + 6u; r++) {
+        const uint16_t *s = src + ((ptrdiff_t)r - AV1_LR_MARGIN) * BS - AV1_LR_MARGIN;
+        for (uint32_t c = 0; c < w; c += 16) {
+            __m256i lo = zero, hi = zero;
+            for (uint32_t t = 0; t < 8; t += 2) {
+                const __m256i a = _mm256_loadu_si256((const __m256i *)(s + c + t));
+                // Tap 7 is 0; its (in-bounds) samples only pad the pair.
+                const __m256i b = _mm256_loadu_si256((const __m256i *)(s + c + t + 1u - (t == 6u)));
+                lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), hf[t >> 1]));
+                hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), hf[t >> 1]));
+            }
+            lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round0), 3);
+            hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round0), 3);
+            __m256i v = _mm256_packs_epi32(lo, hi);
+            v = _mm256_min_epi16(_mm256_max_epi16(v, lo_clip), hi_clip);
+            _mm256_store_si256((__m256i *)(inter + r * 64u + c), v);
+        }
+    }
+
+    for (uint32_t r = 0; r < h; r++) {
+        for (uint32_t c = 0; c < w; c += 16) {
+            __m256i lo = zero, hi = zero;
+            for (uint32_t t = 0; t < 8; t += 2) {
+                const __m256i a = _mm256_load_si256((const __m256i *)(inter + (r + t) * 64u + c));
+                const __m256i b = t == 6u ? zero : _mm256_load_si256((const __m256i *)(inter + (r + t + 1u) * 64u + c));
+                lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), vf[t >> 1]));
+                hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), vf[t >> 1]));
+            }
+            lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round1), 11);
+            hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round1), 11);
+            const __m256i v16 = _mm256_packs_epi32(lo, hi);
+            const __m256i v8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(v16, v16), 0xD8);
+            store_u8x16(dst + (ptrdiff_t)r * stride + c, _mm256_castsi256_si128(v8), w - c);
+        }
+    }
+}
+
+// ---- Self-guided ----
+
+#define AB_STRIDE 72
+#define VS_COLS 80
+
+// A / B of one pass at ab[ ( i + 1 ) * AB_STRIDE + j + 1 ] for i = -1 .. h (odd i only for pass 0)
+// and j = -1 .. 70, from the first VS_COLS buffer columns; F (stride 64) for the w x h chunk.
+static AVX2_ATTR void sgr_box_avx2(const uint16_t *src, uint32_t w, uint32_t h, uint32_t r, uint32_t eps, uint32_t pass, int32_t *flt) {
+    _Alignas(32) int32_t A[(64 + 2) * AB_STRIDE];
+    _Alignas(32) int32_t B[(64 + 2) * AB_STRIDE];
+    _Alignas(32) int32_t vs[VS_COLS + 8];
+    _Alignas(32) int32_t vq[VS_COLS + 8];
+    const uint32_t n = (2u * r + 1u) * (2u * r + 1u);
+    const __m256i vn = _mm256_set1_epi32((int32_t)n);
+    const __m256i vs_mul = _mm256_set1_epi32((int32_t)(((1u << 20) + n * n * eps / 2u) / (n * n * eps)));
+    const __m256i one_over_n = _mm256_set1_epi32((int32_t)(((1u << 12) + n / 2u) / n));
+    const __m256i c255 = _mm256_set1_epi32(255);
+    const __m256i c256 = _mm256_set1_epi32(256);
+    const __m256i rnd19 = _mm256_set1_epi32(1 << 19);
+    const __m256i rnd11 = _mm256_set1_epi32(1 << 11);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int32_t i = -1; i <= (int32_t)h; i++) {
+        if (pass == 0 && !(i & 1)) {
+            continue;
+        }
+        // Column sums over buffer rows i - r .. i + r, 16 columns at a time.
+        for (uint32_t x = 0; x < VS_COLS; x += 16) {
+            __m256i sum = zero, sq_lo = zero, sq_hi = zero;
+            for (int32_t dy = -(int32_t)r; dy <= (int32_t)r; dy++) {
+                const __m256i v = _mm256_loadu_si256((const __m256i *)(src + (ptrdiff_t)(i + dy) * BS - AV1_LR_MARGIN + x));
+                const __m256i sq = _mm256_mullo_epi16(v, v);
+                sum = _mm256_add_epi16(sum, v);
+                sq_lo = _mm256_add_epi32(sq_lo, _mm256_unpacklo_epi16(sq, zero));
+                sq_hi = _mm256_add_epi32(sq_hi, _mm256_unpackhi_epi16(sq, zero));
+            }
+            const __m256i sum_lo = _mm256_unpacklo_epi16(sum, zero);
+            const __m256i sum_hi = _mm256_unpackhi_epi16(sum, zero);
+            // unpacklo / unpackhi interleave the 128-bit halves: columns 0-3, 8-11 and 4-7, 12-15.
+            _mm256_store_si256((__m256i *)(vs + x), _mm256_permute2x128_si256(sum_lo, sum_hi, 0x20));
+            _mm256_store_si256((__m256i *)(vs + x + 8u), _mm256_permute2x128_si256(sum_lo, sum_hi, 0x31));
+            _mm256_store_si256((__m256i *)(vq + x), _mm256_permute2x128_si256(sq_lo, sq_hi, 0x20));
+            _mm256_store_si256((__m256i *)(vq + x + 8u), _mm256_permute2x128_si256(sq_lo, sq_hi, 0x31));
+        }
+        int32_t *a_row = A + (i + 1) * AB_STRIDE;
+        int32_t *b_row = B + (i + 1) * AB_STRIDE;
+        for (uint32_t j1 = 0; j1 < AB_STRIDE; j1 += 8) {
+            // Column j = j1 - 1: box columns j1 + 2 - r .. j1 + 2 + r.
+            __m256i b = zero, a = zero;
+            for (uint32_t dx = 0; dx < 2u * r + 1u; dx++) {
+                b = _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i *)(vs + j1 + 2u - r + dx)));
+                a = _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i *)(vq + j1 + 2u - r + dx)));
+            }
+            __m256i p = _mm256_sub_epi32(_mm256_mullo_epi32(a, vn), _mm256_mullo_epi32(b, b));
+            p = _mm256_max_epi32(p, zero);
+            __m256i z = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(p, vs_mul), rnd19), 20);
+            z = _mm256_min_epu32(z, c255);
+            const __m256i a2 = _mm256_i32gather_epi32((const int *)av1_sgr_a2, z, 4);
+            const __m256i b2 = _mm256_mullo_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(c256, a2), b), one_over_n);
+            _mm256_storeu_si256((__m256i *)(a_row + j1), a2);
+            _mm256_storeu_si256((__m256i *)(b_row + j1), _mm256_srli_epi32(_mm256_add_epi32(b2, rnd11), 12));
+        }
+    }
+
+    const __m256i c3 = _mm256_set1_epi32(3), c4 = _mm256_set1_epi32(4);
+    const __m256i c5 = _mm256_set1_epi32(5), c6 = _mm256_set1_epi32(6);
+    for (uint32_t i = 0; i < h; i++) {
+        const int32_t *a0 = A + i * AB_STRIDE, *a1 = a0 + AB_STRIDE, *a2 = a1 + AB_STRIDE;
+        const int32_t *b0 = B + i * AB_STRIDE, *b1 = b0 + AB_STRIDE, *b2 = b1 + AB_STRIDE;
+        for (uint32_t j = 0; j < w; j += 8) {
+#define LD(p, off) _mm256_loadu_si256((const __m256i *)((p) + j + (off)))
+            __m256i a, b;
+            uint32_t shift = 5;
+            if (pass == 0) {
+                if (i & 1u) {
+                    a = _mm256_add_epi32(_mm256_mullo_epi32(LD(a1, 1), c6), _mm256_mullo_epi32(_mm256_add_epi32(LD(a1, 0), LD(a1, 2)), c5));
+                    b = _mm256_add_epi32(_mm256_mullo_epi32(LD(b1, 1), c6), _mm256_mullo_epi32(_mm256_add_epi32(LD(b1, 0), LD(b1, 2)), c5));
+                    shift = 4;
+                } else {
+                    const __m256i ac = _mm256_add_epi32(LD(a0, 1), LD(a2, 1));
+                    const __m256i ad = _mm256_add_epi32(_mm256_add_epi32(LD(a0, 0), LD(a0, 2)), _mm256_add_epi32(LD(a2, 0), LD(a2, 2)));
+                    const __m256i bc = _mm256_add_epi32(LD(b0, 1), LD(b2, 1));
+                    const __m256i bd = _mm256_add_epi32(_mm256_add_epi32(LD(b0, 0), LD(b0, 2)), _mm256_add_epi32(LD(b2, 0), LD(b2, 2)));
+                    a = _mm256_add_epi32(_mm256_mullo_epi32(ac, c6), _mm256_mullo_epi32(ad, c5));
+                    b = _mm256_add_epi32(_mm256_mullo_epi32(bc, c6), _mm256_mullo_epi32(bd, c5));
+                }
+            } else {
+                const __m256i ac = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(LD(a1, 1), LD(a0, 1)), _mm256_add_epi32(LD(a2, 1), LD(a1, 0))), LD(a1, 2));
+                const __m256i ad = _mm256_add_epi32(_mm256_add_epi32(LD(a0, 0), LD(a0, 2)), _mm256_add_epi32(LD(a2, 0), LD(a2, 2)));
+                const __m256i bc = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(LD(b1, 1), LD(b0, 1)), _mm256_add_epi32(LD(b2, 1), LD(b1, 0))), LD(b1, 2));
+                const __m256i bd = _mm256_add_epi32(_mm256_add_epi32(LD(b0, 0), LD(b0, 2)), _mm256_add_epi32(LD(b2, 0), LD(b2, 2)));
+                a = _mm256_add_epi32(_mm256_mullo_epi32(ac, c4), _mm256_mullo_epi32(ad, c3));
+                b = _mm256_add_epi32(_mm256_mullo_epi32(bc, c4), _mm256_mullo_epi32(bd, c3));
+            }
+#undef LD
+            const __m256i s = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + (ptrdiff_t)i * BS + j)));
+            const __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(a, s), b);
+            const uint32_t sh = 8u + shift - 4u;
+            const __m256i rnd = _mm256_set1_epi32(1 << (sh - 1u));
+            _mm256_store_si256((__m256i *)(flt + i * 64u + j), _mm256_srai_epi32(_mm256_add_epi32(v, rnd), (int)sh));
+        }
+    }
+}
+
+static AVX2_ATTR void lr_sgr_avx2(uint8_t *dst,
+                                  ptrdiff_t stride,
+                                  const uint16_t *src,
+                                  uint32_t w,
+                                  uint32_t h,
+                                  uint32_t set,
+                                  const int16_t xqd[2]) {
+    _Alignas(32) int32_t flt[2][64 * 64];
+    const uint32_t r0 = av1_sgr_params[set][0];
+    const uint32_t r1 = av1_sgr_params[set][2];
+    if (r0) {
+        sgr_box_avx2(src, w, h, r0, av1_sgr_params[set][1], 0, flt[0]);
+    }
+    if (r1) {
+        sgr_box_avx2(src, w, h, r1, av1_sgr_params[set][3], 1, flt[1]);
+    }
+    // A pass with radius 0 contributes its weight times u, which folds into w1.
+    int32_t w0 = xqd[0], w1 = xqd[1], w2 = 128 - w0 - w1;
+    if (!r0) {
+        w1 += w0;
+        w0 = 0;
+    }
+    if (!r1) {
+        w1 += w2;
+        w2 = 0;
+    }
+    const __m256i vw0 = _mm256_set1_epi32(w0), vw1 = _mm256_set1_epi32(w1), vw2 = _mm256_set1_epi32(w2);
+    const __m256i rnd = _mm256_set1_epi32(1 << 10);
+    const __m256i lanes = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+    for (uint32_t i = 0; i < h; i++) {
+        for (uint32_t j = 0; j < w; j += 8) {
+            const __m256i u = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + (ptrdiff_t)i * BS + j))), 4);
+            __m256i v = _mm256_mullo_epi32(u, vw1);
+            if (r0) {
+                v = _mm256_add_epi32(v, _mm256_mullo_epi32(_mm256_load_si256((const __m256i *)(flt[0] + i * 64u + j)), vw0));
+            }
+            if (r1) {
+                v = _mm256_add_epi32(v, _mm256_mullo_epi32(_mm256_load_si256((const __m256i *)(flt[1] + i * 64u + j)), vw2));
+            }
+            v = _mm256_srai_epi32(_mm256_add_epi32(v, rnd), 11);
+            const __m256i v16 = _mm256_packs_epi32(v, v);
+            const __m256i v8 = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(v16, v16), lanes);
+            const uint32_t n = w - j < 8u ? w - j : 8u;
+            if (n == 8u) {
+                _mm_storel_epi64((__m128i *)(dst + (ptrdiff_t)i * stride + j), _mm256_castsi256_si128(v8));
+            } else {
+                uint8_t tmp[16];
+                _mm_storeu_si128((__m128i *)tmp, _mm256_castsi256_si128(v8));
+                memcpy(dst + (ptrdiff_t)i * stride + j, tmp, n);
+            }
+        }
+    }
+}
+
+bool av1_lr_dsp_init_avx2(Av1LrDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->wiener = lr_wiener_avx2;
+    dsp->sgr = lr_sgr_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_restoration.c uses the scalar reference.
+typedef int av1_lr_x86_unused;
+
+#endif
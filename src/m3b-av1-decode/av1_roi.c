@@ -0,0 +1,154 @@
+#include "av1_roi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Superres upscaling is an 8-tap horizontal filter: 4 coded columns of context per side.
+#define AV1_ROI_SUPERRES_MARGIN_PX 4u
+
+static bool parse_u32_field(const char **p, char terminator, uint32_t *out) {
+    const char *s = *p;
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+    char *end = NULL;
+    unsigned long v = strtoul(s, &end, 10);
+    if (!end || *end != terminator || v > 0xFFFFFFFFul) {
+        return false;
+    }
+    *out = (uint32_t)v;
+    *p = terminator ? end + 1 : end;
+    return true;
+}
+
+bool av1_roi_parse_rect(const char *s, Av1RoiRect *out) {
+    if (!s || !out) {
+        return false;
+    }
+    const char *p = s;
+    Av1RoiRect r;
+    if (!parse_u32_field(&p, ',', &r.x) || !parse_u32_field(&p, ',', &r.y) || !parse_u32_field(&p, ',', &r.w) ||
+        !parse_u32_field(&p, 0, &r.h)) {
+        return false;
+    }
+    if (r.w == 0 || r.h == 0) {
+        return false;
+    }
+    *out = r;
+    return true;
+}
+
+static uint32_t sat_sub_u32(uint32_t a, uint32_t b) {
+    return a > b ? a - b : 0u;
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+// Returns [*out_start,*out_end) = the tiles whose [starts[i],starts[i+1]) overlaps [lo,hi).
+static void select_tile_range(const uint32_t *starts,
+                              uint32_t count,
+                              uint32_t lo,
+                              uint32_t hi,
+                              uint32_t *out_start,
+                              uint32_t *out_end) {
+    uint32_t first = count;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (starts[i] < hi && starts[i + 1] > lo) {
+            if (first == count) {
+                first = i;
+            }
+            last = i + 1;
+        }
+    }
+    if (first == count) {
+        first = 0;
+        last = 0;
+    }
+    *out_start = first;
+    *out_end = last;
+}
+
+bool av1_roi_select_tiles(const Av1RoiRect *crop,
+                          uint32_t frame_width,
+                          uint32_t frame_height,
+                          uint32_t upscaled_width,
+                          uint32_t margin_px,
+                          const uint32_t *mi_col_starts,
+                          uint32_t tile_cols,
+                          const uint32_t *mi_row_starts,
+                          uint32_t tile_rows,
+                          Av1RoiTileSet *out,
+                          char *err,
+                          size_t err_cap) {
+    if (!crop || !mi_col_starts || !mi_row_starts || !out) {
+        snprintf(err, err_cap, "roi: invalid args");
+        return false;
+    }
+    if (frame_width == 0 || frame_height == 0 || tile_cols == 0 || tile_rows == 0 ||
+        tile_cols > AV1_ROI_MAX_TILE_COLS || tile_rows > AV1_ROI_MAX_TILE_ROWS) {
+        snprintf(err, err_cap, "roi: invalid frame/tile geometry");
+        return false;
+    }
+    if (upscaled_width == 0) {
+        upscaled_width = frame_width;
+    }
+    if (crop->w == 0 || crop->h == 0 || crop->x >= upscaled_width || crop->y >= frame_height) {
+        snprintf(err, err_cap,
+                 "roi: crop %u,%u,%u,%u does not intersect the %ux%u frame",
+                 crop->x,
+                 crop->y,
+                 crop->w,
+                 crop->h,
+                 upscaled_width,
+                 frame_height);
+        return false;
+    }
+
+    // Clip to the output frame (64-bit to avoid x+w overflow).
+    uint64_t x0 = crop->x;
+    uint64_t y0 = crop->y;
+    uint64_t x1 = (uint64_t)crop->x + crop->w;
+    uint64_t y1 = (uint64_t)crop->y + crop->h;
+    if (x1 > upscaled_width) {
+        x1 = upscaled_width;
+    }
+    if (y1 > frame_height) {
+        y1 = frame_height;
+    }
+
+    // Map output columns back to coded columns (conservative: floor start, ceil end).
+    uint32_t col_margin = margin_px;
+    if (upscaled_width != frame_width) {
+        x0 = (x0 * frame_width) / upscaled_width;
+        x1 = (x1 * frame_width + upscaled_width - 1u) / upscaled_width;
+        col_margin += AV1_ROI_SUPERRES_MARGIN_PX;
+    }
+
+    uint32_t px0 = sat_sub_u32((uint32_t)x0, col_margin);
+    uint32_t py0 = sat_sub_u32((uint32_t)y0, margin_px);
+    uint32_t px1 = min_u32((uint32_t)x1 + col_margin, frame_width);
+    uint32_t py1 = min_u32((uint32_t)y1 + margin_px, frame_height);
+
+    // Spec: MiCols = 2 * ((frame_width + 7) >> 3), likewise MiRows.
+    uint32_t mi_cols = 2u * ((frame_width + 7u) >> 3);
+    uint32_t mi_rows = 2u * ((frame_height + 7u) >> 3);
+
+    Av1RoiTileSet s;
+    s.mi_col_start = px0 >> 2;
+    s.mi_row_start = py0 >> 2;
+    s.mi_col_end = min_u32((px1 + 3u) >> 2, mi_cols);
+    s.mi_row_end = min_u32((py1 + 3u) >> 2, mi_rows);
+
+    select_tile_range(mi_col_starts, tile_cols, s.mi_col_start, s.mi_col_end, &s.tile_col_start, &s.tile_col_end);
+    select_tile_range(mi_row_starts, tile_rows, s.mi_row_start, s.mi_row_end, &s.tile_row_start, &s.tile_row_end);
+    if (s.tile_col_start == s.tile_col_end || s.tile_row_start == s.tile_row_end) {
+        snprintf(err, err_cap, "roi: crop selects no tiles (tile_info/frame size mismatch)");
+        return false;
+    }
+
+    *out = s;
+    return true;
+}
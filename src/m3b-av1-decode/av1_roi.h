@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Region-of-interest (crop) decode support.
+//
+// AV1 tiles are independently entropy-coded, so a crop rectangle only requires decoding the
+// tiles it intersects. The in-loop filters read a few pixels across tile edges, so the crop is
+// first grown by a filter-context margin before it is intersected with the tile grid.
+
+// Luma pixels of filter context needed around an output pixel, following the dependency chain
+// back from the output:
+// - loop restoration: 3 px (7-tap Wiener; the self-guided filter reaches as far).
+// - CDEF: the direction search reads the whole aligned 8x8 block (up to 7 px) and the filter
+//   taps add 2 px.
+// - deblock: the 14-tap luma filter writes p5 from samples up to q6, 12 px away.
+// The sum (24 px) is rounded up to 8 px, the CDEF block size.
+#define AV1_ROI_LR_MARGIN_PX 3u
+#define AV1_ROI_CDEF_MARGIN_PX (7u + 2u)
+#define AV1_ROI_DEBLOCK_MARGIN_PX 12u
+#define AV1_ROI_FILTER_MARGIN_PX \
+    ((AV1_ROI_LR_MARGIN_PX + AV1_ROI_CDEF_MARGIN_PX + AV1_ROI_DEBLOCK_MARGIN_PX + 7u) & ~7u)
+
+#define AV1_ROI_MAX_TILE_COLS 64u
+#define AV1_ROI_MAX_TILE_ROWS 64u
+
+typedef struct {
+    // Crop rectangle in output (upscaled) luma pixels.
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+} Av1RoiRect;
+
+typedef struct {
+    // Selected tiles, half-open [start,end) in tile-grid units.
+    uint32_t tile_col_start;
+    uint32_t tile_col_end;
+    uint32_t tile_row_start;
+    uint32_t tile_row_end;
+
+    // The margin-expanded crop in MI units (4x4 luma), half-open, clipped to the frame.
+    uint32_t mi_col_start;
+    uint32_t mi_col_end;
+    uint32_t mi_row_start;
+    uint32_t mi_row_end;
+} Av1RoiTileSet;
+
+// Parses "x,y,w,h" (decimal, w and h > 0).
+bool av1_roi_parse_rect(const char *s, Av1RoiRect *out);
+
+// Maps a crop rectangle onto the tile grid.
+//
+// frame_width/frame_height are the coded (pre-superres) frame size; upscaled_width is the
+// post-superres width (equal to frame_width when superres is off). The crop is expressed in
+// upscaled pixels and is scaled back to coded columns before tile selection.
+//
+// mi_col_starts/mi_row_starts are the tile_info() MiColStarts/MiRowStarts arrays
+// (tile_cols+1 / tile_rows+1 entries).
+//
+// Fails if the rectangle does not intersect the frame.
+bool av1_roi_select_tiles(const Av1RoiRect *crop,
+                          uint32_t frame_width,
+                          uint32_t frame_height,
+                          uint32_t upscaled_width,
+                          uint32_t margin_px,
+                          const uint32_t *mi_col_starts,
+                          uint32_t tile_cols,
+                          const uint32_t *mi_row_starts,
+                          uint32_t tile_rows,
+                          Av1RoiTileSet *out,
+                          char *err,
+                          size_t err_cap);
+
+static inline bool av1_roi_tile_selected(const Av1RoiTileSet *set, uint32_t tile_row, uint32_t tile_col) {
+    return tile_row >= set->tile_row_start && tile_row < set->tile_row_end && tile_col >= set->tile_col_start &&
+           tile_col < set->tile_col_end;
+}
@@ -0,0 +1,95 @@
+#include "av1_segmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool av1_segmap_init(Av1SegMap *m, uint32_t mi_rows, uint32_t mi_cols, char *err, size_t err_cap) {
+    memset(m, 0, sizeof(*m));
+    m->mi_rows = mi_rows;
+    m->mi_cols = mi_cols;
+    m->stride = ((size_t)mi_cols * 3u + 7u) / 8u + 1u;
+    m->map = (uint8_t *)calloc((size_t)(mi_rows ? mi_rows : 1u) * m->stride, 1);
+    if (!m->map) {
+        snprintf(err, err_cap, "out of memory allocating segment map (mi=%ux%u)", mi_cols, mi_rows);
+        av1_segmap_free(m);
+        return false;
+    }
+    return true;
+}
+
+void av1_segmap_free(Av1SegMap *m) {
+    if (!m) {
+        return;
+    }
+    free(m->map);
+    memset(m, 0, sizeof(*m));
+}
+
+void av1_segmap_set_block(Av1SegMap *m, uint32_t r, uint32_t c, uint32_t w4, uint32_t h4, uint32_t segment_id) {
+    if (r >= m->mi_rows || c >= m->mi_cols) {
+        return;
+    }
+    const uint32_t w = w4 < m->mi_cols - c ? w4 : m->mi_cols - c;
+    const uint32_t h = h4 < m->mi_rows - r ? h4 : m->mi_rows - r;
+    segment_id &= 7u;
+
+    // Up to eight entries (24 bits) per read-modify-write of the bytes that hold them; the mask
+    // and the shifted pattern are the same for every row of the block.
+    const uint32_t pattern = segment_id * 0x249249u;
+    for (uint32_t x = c; x < c + w; x += 8) {
+        const uint32_t n = c + w - x < 8u ? c + w - x : 8u;
+        const size_t bit = (size_t)x * 3u;
+        const uint32_t shift = (uint32_t)(bit & 7u);
+        const uint32_t nbytes = (shift + n * 3u + 7u) >> 3;
+        const uint32_t mask = ((1u << (n * 3u)) - 1u) << shift;
+        const uint32_t val = pattern << shift & mask;
+        uint8_t *p = m->map + (size_t)r * m->stride + (bit >> 3);
+        for (uint32_t y = 0; y < h; y++, p += m->stride) {
+            uint32_t v = 0;
+            for (uint32_t k = 0; k < nbytes; k++) {
+                v |= (uint32_t)p[k] << (8u * k);
+            }
+            v = (v & ~mask) | val;
+            for (uint32_t k = 0; k < nbytes; k++) {
+                p[k] = (uint8_t)(v >> (8u * k));
+            }
+        }
+    }
+}
+
+void av1_segmap_store_row(Av1SegMap *m, uint32_t r, uint32_t c, const uint8_t *ids, size_t ids_stride, uint32_t n) {
+    if (r >= m->mi_rows || c >= m->mi_cols) {
+        return;
+    }
+    if (n > m->mi_cols - c) {
+        n = m->mi_cols - c;
+    }
+    // Eight entries fill three bytes; a short last group only reaches the row's pad bits.
+    uint8_t *p = m->map + (size_t)r * m->stride + (size_t)c * 3u / 8u;
+    uint32_t x = 0;
+    for (; x + 8u <= n; x += 8, p += 3, ids += 8u * ids_stride) {
+        // Two independent halves of four entries each.
+        const uint32_t lo = (uint32_t)ids[0] | (uint32_t)ids[ids_stride] << 3 | (uint32_t)ids[2u * ids_stride] << 6 |
+                            (uint32_t)ids[3u * ids_stride] << 9;
+        const uint32_t hi = (uint32_t)ids[4u * ids_stride] | (uint32_t)ids[5u * ids_stride] << 3 |
+                            (uint32_t)ids[6u * ids_stride] << 6 | (uint32_t)ids[7u * ids_stride] << 9;
+        const uint32_t v = lo | hi << 12;
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+    }
+    if (x < n) {
+        uint32_t v = 0;
+        for (uint32_t j = 0; j < n - x; j++) {
+            v |= (uint32_t)ids[j * ids_stride] << (3u * j);
+        }
+        p[0] = (uint8_t)v;
+        if (n - x > 2u) {
+            p[1] = (uint8_t)(v >> 8);
+        }
+        if (n - x > 5u) {
+            p[2] = (uint8_t)(v >> 16);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Frame-wide segmentation map (the SegmentIds[][] array of spec 5.11.9 / 7.20, see local
+// av1bitstream.html), indexed in frame MI coordinates and shared by all tiles of the frame.
+//
+// segment_id is 3 bits, so the map packs one entry per 3 bits, LSB first, in rows of `stride`
+// bytes: 64 MIs cost 24 bytes instead of one byte each. Writes touch only the bytes holding their
+// entries and tiles start on superblock columns (16 MIs = 6 bytes), so tiles never write the same
+// byte. Reads load two bytes, so every row carries one pad byte.
+//
+// This is the store the per-segment quantizer and filter lookups of later stages read
+// (av1_segmap_get()). The spatial prediction of intra_segment_id() does not: it reads the byte
+// segment_id of the tile decoder's MI records, which fill the map one superblock at a time
+// (av1_segmap_store_row()). Frames that never enable segmentation leave the map all zero.
+
+typedef struct {
+    uint8_t *map;  // 3 bits per MI, `stride` bytes per MI row
+    size_t stride; // ceil( mi_cols * 3 / 8 ) + 1
+    uint32_t mi_rows;
+    uint32_t mi_cols;
+} Av1SegMap;
+
+// Allocates an all-zero map (every MI in segment 0). On failure *m is left freed.
+bool av1_segmap_init(Av1SegMap *m, uint32_t mi_rows, uint32_t mi_cols, char *err, size_t err_cap);
+
+void av1_segmap_free(Av1SegMap *m);
+
+// SegmentIds[ r ][ c ]; r / c must lie inside the map.
+static inline uint32_t av1_segmap_get(const Av1SegMap *m, uint32_t r, uint32_t c) {
+    const size_t bit = (size_t)c * 3u;
+    const uint8_t *p = m->map + (size_t)r * m->stride + (bit >> 3);
+    return ((uint32_t)p[0] | (uint32_t)p[1] << 8) >> (bit & 7u) & 7u;
+}
+
+// Stores segment_id for the w4 x h4 MI block at frame MI ( r, c ), clipped to the map.
+void av1_segmap_set_block(Av1SegMap *m, uint32_t r, uint32_t c, uint32_t w4, uint32_t h4, uint32_t segment_id);
+
+// Packs n byte segment_ids (0..7), read `ids_stride` bytes apart (e.g. a field of a row of MI records),
+// into row r from column c on, clipped to the map. c must be a multiple of 8, and so must n unless
+// the run ends the row (superblocks satisfy both), so the row is written with whole-byte stores
+// and no read-modify-write.
+void av1_segmap_store_row(Av1SegMap *m, uint32_t r, uint32_t c, const uint8_t *ids, size_t ids_stride, uint32_t n);
@@ -0,0 +1,186 @@
+#include "av1_superres.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Spec 7.16 Upscale_Filter.
+const int16_t av1_superres_filter[64][8] = {
+    {0, 0, 0, 128, 0, 0, 0, 0}, {0, 0, -1, 128, 2, -1, 0, 0},
+    {0, 1, -3, 127, 4, -2, 1, 0}, {0, 1, -4, 127, 6, -3, 1, 0},
+    {0, 2, -6, 126, 8, -3, 1, 0}, {0, 2, -7, 125, 11, -4, 1, 0},
+    {-1, 2, -8, 125, 13, -5, 2, 0}, {-1, 3, -9, 124, 15, -6, 2, 0},
+    {-1, 3, -10, 123, 18, -6, 2, -1}, {-1, 3, -11, 122, 20, -7, 3, -1},
+    {-1, 4, -12, 121, 22, -8, 3, -1}, {-1, 4, -13, 120, 25, -9, 3, -1},
+    {-1, 4, -14, 118, 28, -9, 3, -1}, {-1, 4, -15, 117, 30, -10, 4, -1},
+    {-1, 5, -16, 116, 32, -11, 4, -1}, {-1, 5, -16, 114, 35, -12, 4, -1},
+    {-1, 5, -17, 112, 38, -12, 4, -1}, {-1, 5, -18, 111, 40, -13, 5, -1},
+    {-1, 5, -18, 109, 43, -14, 5, -1}, {-1, 6, -19, 107, 45, -14, 5, -1},
+    {-1, 6, -19, 105, 48, -15, 5, -1}, {-1, 6, -19, 103, 51, -16, 5, -1},
+    {-1, 6, -20, 101, 53, -16, 6, -1}, {-1, 6, -20, 99, 56, -17, 6, -1},
+    {-1, 6, -20, 97, 58, -17, 6, -1}, {-1, 6, -20, 95, 61, -18, 6, -1},
+    {-2, 7, -20, 93, 64, -18, 6, -2}, {-2, 7, -20, 91, 66, -19, 6, -1},
+    {-2, 7, -20, 88, 69, -19, 6, -1}, {-2, 7, -20, 86, 71, -19, 6, -1},
+    {-2, 7, -20, 84, 74, -20, 7, -2}, {-2, 7, -20, 81, 76, -20, 7, -1},
+    {-2, 7, -20, 79, 79, -20, 7, -2}, {-1, 7, -20, 76, 81, -20, 7, -2},
+    {-2, 7, -20, 74, 84, -20, 7, -2}, {-1, 6, -19, 71, 86, -20, 7, -2},
+    {-1, 6, -19, 69, 88, -20, 7, -2}, {-1, 6, -19, 66, 91, -20, 7, -2},
+    {-2, 6, -18, 64, 93, -20, 7, -2}, {-1, 6, -18, 61, 95, -20, 6, -1},
+    {-1, 6, -17, 58, 97, -20, 6, -1}, {-1, 6, -17, 56, 99, -20, 6, -1},
+    {-1, 6, -16, 53, 101, -20, 6, -1}, {-1, 5, -16, 51, 103, -19, 6, -1},
+    {-1, 5, -15, 48, 105, -19, 6, -1}, {-1, 5, -14, 45, 107, -19, 6, -1},
+    {-1, 5, -14, 43, 109, -18, 5, -1}, {-1, 5, -13, 40, 111, -18, 5, -1},
+    {-1, 4, -12, 38, 112, -17, 5, -1}, {-1, 4, -12, 35, 114, -16, 5, -1},
+    {-1, 4, -11, 32, 116, -16, 5, -1}, {-1, 4, -10, 30, 117, -15, 4, -1},
+    {-1, 3, -9, 28, 118, -14, 4, -1}, {-1, 3, -9, 25, 120, -13, 4, -1},
+    {-1, 3, -8, 22, 121, -12, 4, -1}, {-1, 3, -7, 20, 122, -11, 3, -1},
+    {-1, 2, -6, 18, 123, -10, 3, -1}, {0, 2, -6, 15, 124, -9, 3, -1},
+    {0, 2, -5, 13, 125, -8, 2, -1}, {0, 1, -4, 11, 125, -7, 2, 0},
+    {0, 1, -3, 8, 126, -6, 2, 0}, {0, 1, -3, 6, 127, -4, 1, 0},
+    {0, 1, -2, 4, 127, -3, 1, 0}, {0, 0, -1, 2, 128, -1, 0, 0},
+};
+
+#define SR_SCALE_MASK ((1 << AV1_SUPERRES_SCALE_BITS) - 1)
+
+static inline int32_t sr_clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// ---- Pixel-type instantiations ----
+
+#define PIXEL uint8_t
+#define PX(name) name
+#define PXT(name) name
+#define PX_IS_8BIT 1
+#define PX_BD 8u
+#define PX_BD_PARAM
+#define PX_BD_ARG(x)
+#include "av1_superres_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+#define PIXEL uint16_t
+#define PX(name) name##_16
+#define PXT(name) name##16
+#define PX_IS_8BIT 0
+#define PX_BD bit_depth
+#define PX_BD_PARAM , uint32_t bit_depth
+#define PX_BD_ARG(x) , x
+#include "av1_superres_tmpl.inc"
+#undef PIXEL
+#undef PX
+#undef PXT
+#undef PX_IS_8BIT
+#undef PX_BD
+#undef PX_BD_PARAM
+#undef PX_BD_ARG
+
+void av1_superres_dsp_init(Av1SuperresDsp *dsp) {
+    av1_superres_dsp_init_c(dsp);
+#if defined(AV1_SUPERRES_HAVE_X86)
+    (void)av1_superres_dsp_init_avx2(dsp);
+#endif
+}
+
+void av1_superres_dsp_init_16(Av1SuperresDsp16 *dsp, uint32_t bit_depth) {
+    // No SIMD kernels for 16-bit pixels yet.
+    av1_superres_dsp_init_c_16(dsp, bit_depth);
+}
+
+uint32_t av1_superres_coded_width(uint32_t upscaled_width, uint32_t denom) {
+    return (upscaled_width * AV1_SUPERRES_NUM + denom / 2u) / denom;
+}
+
+// ---- Frame binding ----
+
+bool av1_superres_init(Av1Superres *sr, Av1FrameBuf *dst, const Av1FrameBuf *src, uint32_t mi_cols, char *err, size_t err_cap) {
+    memset(sr, 0, sizeof(*sr));
+    if (!dst || !src || dst == src) {
+        snprintf(err, err_cap, "superres: invalid args");
+        return false;
+    }
+    if (dst->height != src->height || dst->layout != src->layout || dst->bit_depth != src->bit_depth ||
+        dst->width < src->width) {
+        snprintf(err, err_cap, "superres: cannot upscale a %ux%u frame to %ux%u", src->width, src->height, dst->width, dst->height);
+        return false;
+    }
+    if (mi_cols * 4u < src->width || mi_cols * 4u > src->width + 7u || (mi_cols & 1u)) {
+        snprintf(err, err_cap, "superres: %u MI columns do not match a %u wide frame", mi_cols, src->width);
+        return false;
+    }
+    const uint32_t sub_x = src->layout == AV1_LAYOUT_I420 || src->layout == AV1_LAYOUT_I422;
+    sr->src = src;
+    sr->dst = dst;
+    sr->sub_y = src->layout == AV1_LAYOUT_I420;
+    for (uint32_t p = 0; p < src->num_planes; p++) {
+        const uint32_t sx = p ? sub_x : 0u;
+        Av1SuperresPlane *pl = &sr->planes[p];
+        const int32_t down = (int32_t)src->plane_w[p];
+        const int32_t up = (int32_t)dst->plane_w[p];
+        pl->src_w = (mi_cols >> sx) * 4u;
+        if (pl->src_w > src->plane_w[p] + src->border_x[p]) {
+            snprintf(err, err_cap, "superres: plane %u border is narrower than the MI area", p);
+            return false;
+        }
+        pl->dst_w = (uint32_t)up;
+        pl->step = ((down << AV1_SUPERRES_SCALE_BITS) + up / 2) / up;
+        const int32_t e = up * pl->step - (down << AV1_SUPERRES_SCALE_BITS);
+        int32_t initial = (-((up - down) << (AV1_SUPERRES_SCALE_BITS - 1)) + up / 2) / up + (1 << (AV1_SUPERRES_EXTRA_BITS - 1)) - e / 2;
+        initial &= SR_SCALE_MASK;
+        pl->pos = initial - (1 << AV1_SUPERRES_SCALE_BITS);
+
+        // Outputs whose eight taps all lie inside the MI area.
+        uint32_t x0 = 0;
+        while (x0 < pl->dst_w && ((pl->pos + (int32_t)x0 * pl->step) >> AV1_SUPERRES_SCALE_BITS) < AV1_SUPERRES_FILTER_OFFSET) {
+            x0++;
+        }
+        uint32_t x1 = pl->dst_w;
+        while (x1 > x0 && ((pl->pos + (int32_t)(x1 - 1u) * pl->step) >> AV1_SUPERRES_SCALE_BITS) + AV1_SUPERRES_FILTER_TAPS -
+                                  AV1_SUPERRES_FILTER_OFFSET > (int32_t)pl->src_w) {
+            x1--;
+        }
+        pl->fast_x0 = x1 > x0 ? x0 : 0u;
+        pl->fast_x1 = x1 > x0 ? x1 : 0u;
+    }
+    av1_superres_dsp_init(&sr->dsp);
+    av1_superres_dsp_init_16(&sr->dsp16, src->bit_depth);
+    return true;
+}
+
+void av1_superres_upscale_rows(const Av1Superres *sr, uint32_t plane, uint32_t y0, uint32_t y1) {
+    const uint32_t h = sr->src->plane_h[plane];
+    y1 = y1 < h ? y1 : h;
+    for (uint32_t y = y0; y < y1; y++) {
+        if (sr->src->bytes_per_sample == 1u) {
+            superres_row(sr, &sr->dsp, plane, y);
+        } else {
+            superres_row_16(sr, &sr->dsp16, plane, y);
+        }
+    }
+}
+
+void av1_superres_filter_row(const Av1Superres *sr, uint32_t row) {
+    for (uint32_t p = 0; p < sr->src->num_planes; p++) {
+        const uint32_t sy = p ? sr->sub_y : 0u;
+        av1_superres_upscale_rows(sr, p, (row * 64u) >> sy, ((row + 1u) * 64u) >> sy);
+    }
+}
+
+void av1_superres_filter_frame(const Av1Superres *sr) {
+    for (uint32_t p = 0; p < sr->src->num_planes; p++) {
+        av1_superres_upscale_rows(sr, p, 0, sr->src->plane_h[p]);
+    }
+}
+
+bool av1_superres_check_ispe(const Av1FrameBuf *out, uint32_t ispe_width, uint32_t ispe_height, char *err, size_t err_cap) {
+    if (out->width != ispe_width || out->height != ispe_height) {
+        snprintf(err, err_cap, "superres: ispe %ux%u does not match the %ux%u upscaled frame", ispe_width, ispe_height, out->width,
+                 out->height);
+        return false;
+    }
+    return true;
+}
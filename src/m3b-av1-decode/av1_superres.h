@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+
+// Super-resolution upscaling (spec 7.16 "Upscaling process").
+//
+// A superres frame is decoded, deblocked and CDEF-filtered at FrameWidth columns; every row is
+// then widened to UpscaledWidth with an 8-tap filter whose phase steps by stepX / 2^14 source
+// samples per output sample. Loop restoration runs on the upscaled frame, and its stripe
+// boundary rows must be upscaled from the pre-CDEF frame (UpscaledCurrFrame), so callers upscale
+// those rows before CDEF with av1_superres_upscale_rows().
+//
+// Kernels produce a run of outputs whose taps all fall inside the source row; outputs near the
+// plane edges, where the spec clamps tap positions to 0 .. miW * MI_SIZE - 1, use the scalar
+// clamped loop. The 8-bit kernel has an AVX2 version (av1_superres_x86.c).
+
+#define AV1_SUPERRES_NUM 8u
+#define AV1_SUPERRES_DENOM_MIN 9u
+#define AV1_SUPERRES_SCALE_BITS 14
+#define AV1_SUPERRES_EXTRA_BITS 8
+#define AV1_SUPERRES_FILTER_TAPS 8
+#define AV1_SUPERRES_FILTER_OFFSET 3
+
+// Upscale_Filter[ SUPERRES_FILTER_SHIFTS ][ SUPERRES_FILTER_TAPS ].
+extern const int16_t av1_superres_filter[64][8];
+
+// Writes dst[ i ] for i < w from source position pos + i * step (1/2^14 samples, spec srcX). Every
+// tap, src[ ( pos >> 14 ) - 3 ] .. src[ ( ( pos + ( w - 1 ) * step ) >> 14 ) + 4 ], is readable.
+typedef void (*Av1SuperresFn)(uint8_t *dst, const uint8_t *src, uint32_t w, int32_t pos, int32_t step);
+typedef void (*Av1SuperresFn16)(uint16_t *dst, const uint16_t *src, uint32_t w, int32_t pos, int32_t step, uint32_t bit_depth);
+
+typedef struct {
+    Av1SuperresFn upscale;
+} Av1SuperresDsp;
+
+typedef struct {
+    uint32_t bit_depth;
+    Av1SuperresFn16 upscale;
+} Av1SuperresDsp16;
+
+// Scalar reference tables.
+void av1_superres_dsp_init_c(Av1SuperresDsp *dsp);
+void av1_superres_dsp_init_c_16(Av1SuperresDsp16 *dsp, uint32_t bit_depth);
+
+// Best tables for the running CPU.
+void av1_superres_dsp_init(Av1SuperresDsp *dsp);
+void av1_superres_dsp_init_16(Av1SuperresDsp16 *dsp, uint32_t bit_depth);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_SUPERRES_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_superres_dsp_init_avx2(Av1SuperresDsp *dsp);
+#endif
+
+// superres_params(): FrameWidth of a frame coded with SuperresDenom denom.
+uint32_t av1_superres_coded_width(uint32_t upscaled_width, uint32_t denom);
+
+// Per-plane stepping of spec 7.16.
+typedef struct {
+    int32_t step;     // stepX
+    int32_t pos;      // srcX of output 0: initialSubpelX - ( 1 << SUPERRES_SCALE_BITS )
+    uint32_t src_w;   // miW * MI_SIZE: taps are clamped to 0 .. src_w - 1
+    uint32_t dst_w;   // upscaledPlaneW
+    uint32_t fast_x0; // outputs fast_x0 .. fast_x1 - 1 need no clamping
+    uint32_t fast_x1;
+} Av1SuperresPlane;
+
+typedef struct {
+    const Av1FrameBuf *src; // FrameWidth wide
+    Av1FrameBuf *dst;       // UpscaledWidth wide, same height and format
+    uint32_t sub_y;
+    Av1SuperresPlane planes[3];
+    Av1SuperresDsp dsp;
+    Av1SuperresDsp16 dsp16;
+} Av1Superres;
+
+// Binds a decoded frame of mi_cols MI columns and the frame it is upscaled into.
+bool av1_superres_init(Av1Superres *sr, Av1FrameBuf *dst, const Av1FrameBuf *src, uint32_t mi_cols, char *err, size_t err_cap);
+
+// Upscales rows y0 .. y1 - 1 of one plane (clamped to the plane height).
+void av1_superres_upscale_rows(const Av1Superres *sr, uint32_t plane, uint32_t y0, uint32_t y1);
+
+// Upscales the 64 luma rows of superblock row row, every plane.
+void av1_superres_filter_row(const Av1Superres *sr, uint32_t row);
+
+void av1_superres_filter_frame(const Av1Superres *sr);
+
+// AVIF ispe of an AV1 item is UpscaledWidth x FrameHeight of the output frame.
+bool av1_superres_check_ispe(const Av1FrameBuf *out, uint32_t ispe_width, uint32_t ispe_height, char *err, size_t err_cap);
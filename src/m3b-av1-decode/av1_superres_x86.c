@@ -0,0 +1,75 @@
+#include "av1_superres.h"
+#include "av1_cpu.h"
+
+// AVX2 superres kernel for 8-bit frames, bit-exact with the scalar kernel in
+// av1_superres_tmpl.inc.
+//
+// Every output has its own source position and filter phase, so the kernel works on output
+// pairs: the eight source bytes of two outputs are widened into one 16 x int16 vector and
+// multiplied with their two filter rows by madd. Three rounds of horizontal adds reduce four
+// pairs to eight sums (even outputs in the low lane, odd ones in the high lane), which are
+// rounded, clipped by the saturating packs and interleaved back into order. Functions carry a
+// target attribute so the file builds with the default CFLAGS; av1_superres_dsp_init_avx2()
+// checks the CPU.
+
+#if defined(AV1_SUPERRES_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+#define SR_SCALE_MASK ((1 << AV1_SUPERRES_SCALE_BITS) - 1)
+
+// Partial dot products of outputs at positions pa (low lane) and pb (high lane).
+static inline AVX2_ATTR __m256i sr_pair(const uint8_t *src, int32_t pa, int32_t pb) {
+    const __m128i a = _mm_loadl_epi64((const __m128i *)(src + (pa >> AV1_SUPERRES_SCALE_BITS) - AV1_SUPERRES_FILTER_OFFSET));
+    const __m128i b = _mm_loadl_epi64((const __m128i *)(src + (pb >> AV1_SUPERRES_SCALE_BITS) - AV1_SUPERRES_FILTER_OFFSET));
+    const __m128i fa = _mm_loadu_si128((const __m128i *)av1_superres_filter[(pa & SR_SCALE_MASK) >> AV1_SUPERRES_EXTRA_BITS]);
+    const __m128i fb = _mm_loadu_si128((const __m128i *)av1_superres_filter[(pb & SR_SCALE_MASK) >> AV1_SUPERRES_EXTRA_BITS]);
+    const __m256i s = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(a, b));
+    const __m256i f = _mm256_inserti128_si256(_mm256_castsi128_si256(fa), fb, 1);
+    return _mm256_madd_epi16(s, f);
+}
+
+static AVX2_ATTR void superres_upscale_avx2(uint8_t *dst, const uint8_t *src, uint32_t w, int32_t pos, int32_t step) {
+    const __m256i round = _mm256_set1_epi32(64);
+    uint32_t x = 0;
+    for (; x + 8u <= w; x += 8u) {
+        const __m256i m0 = sr_pair(src, pos, pos + step);
+        const __m256i m1 = sr_pair(src, pos + 2 * step, pos + 3 * step);
+        const __m256i m2 = sr_pair(src, pos + 4 * step, pos + 5 * step);
+        const __m256i m3 = sr_pair(src, pos + 6 * step, pos + 7 * step);
+        __m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(m0, m1), _mm256_hadd_epi32(m2, m3));
+        sum = _mm256_srai_epi32(_mm256_add_epi32(sum, round), 7);
+        const __m256i w16 = _mm256_packus_epi32(sum, sum);
+        const __m128i v = _mm_unpacklo_epi16(_mm256_castsi256_si128(w16), _mm256_extracti128_si256(w16, 1));
+        _mm_storel_epi64((__m128i *)(dst + x), _mm_packus_epi16(v, v));
+        pos += 8 * step;
+    }
+    for (; x < w; x++) {
+        const uint8_t *s = src + (pos >> AV1_SUPERRES_SCALE_BITS) - AV1_SUPERRES_FILTER_OFFSET;
+        const int16_t *f = av1_superres_filter[(pos & SR_SCALE_MASK) >> AV1_SUPERRES_EXTRA_BITS];
+        int32_t sum = 0;
+        for (uint32_t k = 0; k < AV1_SUPERRES_FILTER_TAPS; k++) {
+            sum += s[k] * f[k];
+        }
+        sum = (sum + 64) >> 7;
+        dst[x] = (uint8_t)(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+        pos += step;
+    }
+}
+
+bool av1_superres_dsp_init_avx2(Av1SuperresDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->upscale = superres_upscale_avx2;
+    return true;
+}
+
+#else
+
+// No x86 SIMD kernels on this target; av1_superres.c uses the scalar reference.
+typedef int av1_superres_x86_unused;
+
+#endif
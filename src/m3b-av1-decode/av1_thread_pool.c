@@ -0,0 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "av1_thread_pool.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Claims and runs jobs of the current batch until none is left. Called with pool->lock held;
+// returns with it held.
+static void run_jobs_locked(Av1ThreadPool *pool) {
+    while (pool->next_job < pool->num_jobs) {
+        const uint32_t job = pool->next_job++;
+        const Av1JobFn fn = pool->fn;
+        void *ctx = pool->ctx;
+        pthread_mutex_unlock(&pool->lock);
+        fn(ctx, job);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->jobs_done == pool->num_jobs) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    Av1ThreadPool *pool = (Av1ThreadPool *)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->next_job >= pool->num_jobs) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        run_jobs_locked(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+bool av1_thread_pool_init(Av1ThreadPool *pool, uint32_t num_threads, char *err, size_t err_cap) {
+    memset(pool, 0, sizeof(*pool));
+    if (num_threads == 0u) {
+        const long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = n > 0 ? (uint32_t)n : 1u;
+    }
+    if (num_threads > AV1_THREAD_POOL_MAX) {
+        num_threads = AV1_THREAD_POOL_MAX;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0 || pthread_cond_init(&pool->work, NULL) != 0 ||
+        pthread_cond_init(&pool->done, NULL) != 0) {
+        snprintf(err, err_cap, "thread_pool: cannot create synchronization objects");
+        return false;
+    }
+    pool->num_threads = 1u;
+    for (uint32_t i = 0; i + 1u < num_threads; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            snprintf(err, err_cap, "thread_pool: cannot start worker %u of %u", i + 1u, num_threads - 1u);
+            av1_thread_pool_free(pool);
+            return false;
+        }
+        pool->num_workers++;
+        pool->num_threads++;
+    }
+    return true;
+}
+
+void av1_thread_pool_run(Av1ThreadPool *pool, Av1JobFn fn, void *ctx, uint32_t num_jobs) {
+    if (num_jobs == 0u) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->num_jobs = num_jobs;
+    pool->next_job = 0;
+    pool->jobs_done = 0;
+    if (num_jobs > 1u) {
+        pthread_cond_broadcast(&pool->work);
+    }
+    run_jobs_locked(pool);
+    while (pool->jobs_done < pool->num_jobs) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void av1_thread_pool_free(Av1ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (uint32_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    pool->num_workers = 0;
+    pool->num_threads = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Decoder worker pool.
+//
+// A fixed set of threads runs "parallel for" batches: av1_thread_pool_run() calls fn( ctx, job )
+// for job = 0 .. num_jobs - 1 on the workers and the calling thread, and returns once every job
+// has finished. Jobs are claimed strictly in increasing order, so a job may block until an
+// earlier job of the same batch reports progress (the earlier one is already running and never
+// waits on a later one). Stages with row dependencies (loop filters) rely on this.
+
+#define AV1_THREAD_POOL_MAX 64u
+
+typedef void (*Av1JobFn)(void *ctx, uint32_t job);
+
+typedef struct {
+    uint32_t num_threads; // including the calling thread
+    pthread_t workers[AV1_THREAD_POOL_MAX - 1u];
+    uint32_t num_workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work; // signalled when a batch starts or on shutdown
+    pthread_cond_t done; // signalled when the last job of a batch finishes
+    bool shutdown;
+
+    // Current batch, guarded by lock.
+    Av1JobFn fn;
+    void *ctx;
+    uint32_t num_jobs;
+    uint32_t next_job;
+    uint32_t jobs_done;
+} Av1ThreadPool;
+
+// Starts num_threads - 1 workers (num_threads 0: one thread per online CPU, capped at
+// AV1_THREAD_POOL_MAX). A pool of one thread runs every batch on the caller.
+bool av1_thread_pool_init(Av1ThreadPool *pool, uint32_t num_threads, char *err, size_t err_cap);
+
+void av1_thread_pool_run(Av1ThreadPool *pool, Av1JobFn fn, void *ctx, uint32_t num_jobs);
+
+// Joins the workers. The pool must be idle.
+void av1_thread_pool_free(Av1ThreadPool *pool);
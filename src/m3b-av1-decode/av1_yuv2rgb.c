@@ -0,0 +1,300 @@
+#include "av1_yuv2rgb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline int32_t yuv_clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// Round half away from zero.
+static int32_t round_coeff(double x) {
+    return x < 0.0 ? -(int32_t)(-x + 0.5) : (int32_t)(x + 0.5);
+}
+
+static inline int32_t load_sample(const void *p, ptrdiff_t i, bool in16) {
+    return in16 ? (int32_t)((const uint16_t *)p)[i] : (int32_t)((const uint8_t *)p)[i];
+}
+
+// Upsampled chroma of luma column x from a half-width near / far row pair.
+static inline int32_t chroma_half(const void *c0, const void *c1, uint32_t x, bool in16) {
+    const ptrdiff_t i = (ptrdiff_t)(x >> 1);
+    const ptrdiff_t side = (x & 1u) ? i + 1 : i - 1;
+    const int32_t near = 3 * load_sample(c0, i, in16) + load_sample(c1, i, in16);
+    const int32_t far = 3 * load_sample(c0, side, in16) + load_sample(c1, side, in16);
+    return (3 * near + far + 8) >> 4;
+}
+
+static inline void row_c(void *dst,
+                         const void *y,
+                         const void *u0,
+                         const void *u1,
+                         const void *v0,
+                         const void *v1,
+                         uint32_t w,
+                         const Av1Yuv2Rgb *cv,
+                         bool in16,
+                         bool out16,
+                         bool half) {
+    for (uint32_t x = 0; x < w; x++) {
+        const int32_t yy = load_sample(y, x, in16) - cv->off[0];
+        const int32_t uu = (half ? chroma_half(u0, u1, x, in16) : load_sample(u0, x, in16)) - cv->off[1];
+        const int32_t vv = (half ? chroma_half(v0, v1, x, in16) : load_sample(v0, x, in16)) - cv->off[2];
+        int32_t px[4];
+        for (uint32_t c = 0; c < 3u; c++) {
+            const int32_t s = cv->m[c][0] * yy + cv->m[c][1] * uu + cv->m[c][2] * vv;
+            px[c] = yuv_clip3(0, cv->rgb_max, (s + cv->round) >> cv->shift);
+        }
+        px[3] = cv->rgb_max;
+        for (uint32_t c = 0; c < 4u; c++) {
+            if (out16) {
+                ((uint16_t *)dst)[4u * x + c] = (uint16_t)px[c];
+            } else {
+                ((uint8_t *)dst)[4u * x + c] = (uint8_t)px[c];
+            }
+        }
+    }
+}
+
+#define YUV2RGB_ROW_C(name, in16, out16, half)                                                                   \
+    static void name(void *dst, const void *y, const void *u0, const void *u1, const void *v0, const void *v1, \
+                     uint32_t w, const Av1Yuv2Rgb *cv) {                                                       \
+        row_c(dst, y, u0, u1, v0, v1, w, cv, in16, out16, half);                                               \
+    }
+
+YUV2RGB_ROW_C(row_8_8_c, false, false, false)
+YUV2RGB_ROW_C(row_8_8_half_c, false, false, true)
+YUV2RGB_ROW_C(row_8_16_c, false, true, false)
+YUV2RGB_ROW_C(row_8_16_half_c, false, true, true)
+YUV2RGB_ROW_C(row_16_8_c, true, false, false)
+YUV2RGB_ROW_C(row_16_8_half_c, true, false, true)
+YUV2RGB_ROW_C(row_16_16_c, true, true, false)
+YUV2RGB_ROW_C(row_16_16_half_c, true, true, true)
+
+void av1_yuv2rgb_dsp_init_c(Av1Yuv2RgbDsp *dsp) {
+    dsp->row[0][0][0] = row_8_8_c;
+    dsp->row[0][0][1] = row_8_8_half_c;
+    dsp->row[0][1][0] = row_8_16_c;
+    dsp->row[0][1][1] = row_8_16_half_c;
+    dsp->row[1][0][0] = row_16_8_c;
+    dsp->row[1][0][1] = row_16_8_half_c;
+    dsp->row[1][1][0] = row_16_16_c;
+    dsp->row[1][1][1] = row_16_16_half_c;
+}
+
+void av1_yuv2rgb_dsp_init(Av1Yuv2RgbDsp *dsp) {
+    av1_yuv2rgb_dsp_init_c(dsp);
+#if defined(AV1_YUV2RGB_HAVE_X86)
+    (void)av1_yuv2rgb_dsp_init_avx2(dsp);
+#endif
+}
+
+// The conversion matrix on normalized samples (Y in 0 .. 1, U / V in -0.5 .. 0.5; every channel
+// in 0 .. 1 for identity), rows R, G, B.
+static bool yuv_matrix(uint32_t mc, double k[3][3]) {
+    double kr, kb;
+    switch (mc) {
+    case AV1_MC_IDENTITY: {
+        static const double kGbr[3][3] = {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}};
+        memcpy(k, kGbr, sizeof(kGbr));
+        return true;
+    }
+    case AV1_MC_SMPTE_YCGCO: {
+        static const double kYCgCo[3][3] = {{1, -1, 1}, {1, 1, 0}, {1, -1, -1}};
+        memcpy(k, kYCgCo, sizeof(kYCgCo));
+        return true;
+    }
+    case AV1_MC_BT_709:
+        kr = 0.2126;
+        kb = 0.0722;
+        break;
+    case AV1_MC_UNSPECIFIED:
+    case AV1_MC_BT_470_B_G:
+    case AV1_MC_BT_601:
+        kr = 0.299;
+        kb = 0.114;
+        break;
+    case AV1_MC_FCC:
+        kr = 0.30;
+        kb = 0.11;
+        break;
+    case AV1_MC_SMPTE_240:
+        kr = 0.212;
+        kb = 0.087;
+        break;
+    case AV1_MC_BT_2020_NCL:
+        kr = 0.2627;
+        kb = 0.0593;
+        break;
+    default:
+        return false;
+    }
+    const double kg = 1.0 - kr - kb;
+    k[0][0] = 1.0;
+    k[0][1] = 0.0;
+    k[0][2] = 2.0 * (1.0 - kr);
+    k[1][0] = 1.0;
+    k[1][1] = -2.0 * kb * (1.0 - kb) / kg;
+    k[1][2] = -2.0 * kr * (1.0 - kr) / kg;
+    k[2][0] = 1.0;
+    k[2][1] = 2.0 * (1.0 - kb);
+    k[2][2] = 0.0;
+    return true;
+}
+
+bool av1_yuv2rgb_init(Av1Yuv2Rgb *cv,
+                      uint32_t matrix_coefficients,
+                      bool full_range,
+                      uint32_t bit_depth,
+                      uint32_t rgb_depth,
+                      char *err,
+                      size_t err_cap) {
+    memset(cv, 0, sizeof(*cv));
+    if (bit_depth != 8u && bit_depth != 10u && bit_depth != 12u) {
+        snprintf(err, err_cap, "unsupported BitDepth %u for RGB conversion", bit_depth);
+        return false;
+    }
+    if (rgb_depth != 8u && rgb_depth != 16u) {
+        snprintf(err, err_cap, "unsupported RGB depth %u (8 or 16)", rgb_depth);
+        return false;
+    }
+    double k[3][3];
+    if (!yuv_matrix(matrix_coefficients, k)) {
+        snprintf(err, err_cap, "unsupported matrix_coefficients %u for RGB conversion", matrix_coefficients);
+        return false;
+    }
+    cv->bit_depth = bit_depth;
+    cv->rgb_depth = rgb_depth;
+    cv->matrix_coefficients = matrix_coefficients;
+    cv->full_range = full_range;
+    cv->rgb_max = (uint16_t)((1u << rgb_depth) - 1u);
+
+    // Offsets and the output units per input step of luma-like and chroma samples.
+    const uint32_t sh = bit_depth - 8u;
+    const bool identity = matrix_coefficients == AV1_MC_IDENTITY;
+    const double rgb_max = (double)cv->rgb_max;
+    const double y_range = full_range ? (double)((1u << bit_depth) - 1u) : (double)(219u << sh);
+    const double c_range = full_range ? (double)((1u << bit_depth) - 1u) : (double)(224u << sh);
+    const double y_scale = rgb_max / y_range;
+    const double c_scale = identity ? y_scale : rgb_max / c_range;
+    cv->off[0] = (int16_t)(full_range ? 0u : 16u << sh);
+    cv->off[1] = identity ? cv->off[0] : (int16_t)(1u << (bit_depth - 1u));
+    cv->off[2] = cv->off[1];
+
+    double m[3][3];
+    double m_max = 0.0;
+    for (uint32_t c = 0; c < 3u; c++) {
+        for (uint32_t i = 0; i < 3u; i++) {
+            m[c][i] = k[c][i] * (i == 0u ? y_scale : c_scale);
+            const double a = m[c][i] < 0.0 ? -m[c][i] : m[c][i];
+            m_max = a > m_max ? a : m_max;
+        }
+    }
+    // The largest shift that keeps every coefficient in int16; sums of three products of 13-bit
+    // offset samples then stay below 2^30.
+    uint32_t shift = 0;
+    while (shift < 24u && round_coeff(m_max * (double)(1u << (shift + 1u))) <= 32767) {
+        shift++;
+    }
+    cv->shift = shift;
+    cv->round = shift ? 1 << (shift - 1u) : 0;
+    for (uint32_t c = 0; c < 3u; c++) {
+        for (uint32_t i = 0; i < 3u; i++) {
+            cv->m[c][i] = (int16_t)round_coeff(m[c][i] * (double)(1u << shift));
+        }
+    }
+    av1_yuv2rgb_dsp_init(&cv->dsp);
+    return true;
+}
+
+// A half-width chroma row with the edge samples replicated into index -1 and cw (plus tail
+// padding), as the half-width row kernels read it.
+static void pad_chroma_row(uint8_t *dst, const uint8_t *src, uint32_t cw, uint32_t bps) {
+    memcpy(dst, src, (size_t)cw * bps);
+    memcpy(dst - bps, src, bps);
+    memcpy(dst + (size_t)cw * bps, src + (size_t)(cw - 1u) * bps, bps);
+}
+
+// Row j of plane p.
+static const uint8_t *plane_row(const Av1FrameBuf *fb, uint32_t p, uint32_t j) {
+    return (const uint8_t *)fb->plane[p] + (ptrdiff_t)j * fb->stride[p] * (ptrdiff_t)fb->bytes_per_sample;
+}
+
+bool av1_yuv2rgb_frame(const Av1Yuv2Rgb *cv,
+                       const Av1FrameBuf *fb,
+                       void *rgba,
+                       ptrdiff_t rgba_stride,
+                       char *err,
+                       size_t err_cap) {
+    if (fb->bit_depth != cv->bit_depth) {
+        snprintf(err, err_cap, "frame BitDepth %u does not match the RGB converter (%u)", fb->bit_depth, cv->bit_depth);
+        return false;
+    }
+    const uint32_t w = fb->width;
+    const uint32_t bps = fb->bytes_per_sample;
+    const bool in16 = bps == 2u;
+    const bool out16 = cv->rgb_depth == 16u;
+    const bool half = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    const Av1Yuv2RgbRowFn row = cv->dsp.row[in16][out16][half];
+
+    // Scratch: a neutral chroma row for monochrome, or three padded rows per chroma plane (a
+    // ring over chroma rows j - 1 .. j + 1 for 4:2:0, one row for 4:2:2).
+    const uint32_t cw = half ? (w + 1u) >> 1 : w;
+    const size_t slot = ((size_t)cw + 2u + AV1_YUV2RGB_BLOCK) * bps;
+    uint8_t *scratch = (uint8_t *)malloc(slot * 6u);
+    if (!scratch) {
+        snprintf(err, err_cap, "out of memory allocating RGB conversion rows (width=%u)", w);
+        return false;
+    }
+    uint8_t *ring[2][3];
+    int64_t ring_row[2][3];
+    for (uint32_t p = 0; p < 2u; p++) {
+        for (uint32_t s = 0; s < 3u; s++) {
+            ring[p][s] = scratch + (p * 3u + s) * slot + bps;
+            ring_row[p][s] = -1;
+        }
+    }
+    if (fb->layout == AV1_LAYOUT_I400) {
+        for (uint32_t x = 0; x < w; x++) {
+            if (in16) {
+                ((uint16_t *)(void *)ring[0][0])[x] = (uint16_t)cv->off[1];
+            } else {
+                ring[0][0][x] = (uint8_t)cv->off[1];
+            }
+        }
+    }
+
+    for (uint32_t y = 0; y < fb->height; y++) {
+        const uint8_t *yrow = plane_row(fb, 0, y);
+        const void *c[2][2]; // [ U, V ][ near, far ]
+        if (fb->layout == AV1_LAYOUT_I400) {
+            c[0][0] = c[0][1] = c[1][0] = c[1][1] = ring[0][0];
+        } else if (!half) {
+            for (uint32_t p = 0; p < 2u; p++) {
+                c[p][0] = c[p][1] = plane_row(fb, p + 1u, y);
+            }
+        } else {
+            const uint32_t ch = fb->plane_h[1];
+            uint32_t near = y, far = y;
+            if (fb->layout == AV1_LAYOUT_I420) {
+                near = y >> 1;
+                far = (y & 1u) ? (near + 1u < ch ? near + 1u : near) : (near ? near - 1u : 0u);
+            }
+            for (uint32_t p = 0; p < 2u; p++) {
+                for (uint32_t n = 0; n < 2u; n++) {
+                    const uint32_t j = n ? far : near;
+                    const uint32_t s = j % 3u;
+                    if (ring_row[p][s] != (int64_t)j) {
+                        pad_chroma_row(ring[p][s], plane_row(fb, p + 1u, j), cw, bps);
+                        ring_row[p][s] = j;
+                    }
+                    c[p][n] = ring[p][s];
+                }
+            }
+        }
+        row((uint8_t *)rgba + (ptrdiff_t)y * rgba_stride, yrow, c[0][0], c[0][1], c[1][0], c[1][1], w, cv);
+    }
+    free(scratch);
+    return true;
+}
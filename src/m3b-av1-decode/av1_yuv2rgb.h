@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "av1_frame_buf.h"
+
+// YUV -> RGBA conversion of a decoded frame, driven by the CICP MatrixCoefficients and range of
+// the sequence header color_config() or the container's `colr` box.
+//
+// Every output sample is one fixed-point dot product of the offset input samples:
+//   C = Clip3( 0, RgbMax, ( m[ C ][ 0 ] * ( Y - off[ 0 ] ) + m[ C ][ 1 ] * ( U - off[ 1 ] ) +
+//                           m[ C ][ 2 ] * ( V - off[ 2 ] ) + round ) >> shift )
+// with int16 coefficients and 32-bit sums, so the AVX2 kernels (av1_yuv2rgb_x86.c) compute the
+// same values with madd. The coefficients fold the matrix (Kr / Kb matrices, YCgCo or identity /
+// GBR), the input range (full, or limited 16..235 / 16..240 scaled by BitDepth) and the output
+// depth together; shift is chosen per conversion so the largest coefficient uses the full int16
+// range.
+//
+// Subsampled chroma is upsampled inside the row kernels with the centered 9-3-3-1 bilinear filter
+// (3-1 horizontally for 4:2:2): the kernel mixes two chroma rows ( 3 * near + far ), then two
+// horizontal neighbors ( 3 * c + c[ i -/+ 1 ] + 8 ) >> 4. Frame edges replicate. Monochrome frames
+// convert with neutral chroma. Alpha is opaque.
+
+#define AV1_YUV2RGB_BLOCK 16u // pixels per AVX2 step
+
+// CICP MatrixCoefficients (H.273) the converter accepts.
+enum {
+    AV1_MC_IDENTITY = 0,
+    AV1_MC_BT_709 = 1,
+    AV1_MC_UNSPECIFIED = 2, // converted as BT.601
+    AV1_MC_FCC = 4,
+    AV1_MC_BT_470_B_G = 5,
+    AV1_MC_BT_601 = 6,
+    AV1_MC_SMPTE_240 = 7,
+    AV1_MC_SMPTE_YCGCO = 8,
+    AV1_MC_BT_2020_NCL = 9,
+};
+
+typedef struct Av1Yuv2Rgb Av1Yuv2Rgb;
+
+// One output row of w pixels, RGBA with 8 bits (uint8_t) or 16 bits (uint16_t) per channel.
+// y has w samples; the chroma rows hold BitDepth 8 samples as uint8_t and deeper ones as uint16_t.
+// Full-resolution kernels read u0 / v0 only. Half-width kernels read the chroma rows u0 / v0
+// (near) and u1 / v1 (far, the same row for 4:2:2) at indices -1 .. ( w + 1 ) / 2; the caller
+// replicates the edge samples into index -1 and ( w + 1 ) / 2, and keeps AV1_YUV2RGB_BLOCK
+// readable samples past that (vector loads cover them, the results are unused).
+typedef void (*Av1Yuv2RgbRowFn)(void *dst,
+                                const void *y,
+                                const void *u0,
+                                const void *u1,
+                                const void *v0,
+                                const void *v1,
+                                uint32_t w,
+                                const Av1Yuv2Rgb *cv);
+
+typedef struct {
+    Av1Yuv2RgbRowFn row[2][2][2]; // [ BitDepth > 8 ][ 16-bit RGBA ][ half-width chroma ]
+} Av1Yuv2RgbDsp;
+
+struct Av1Yuv2Rgb {
+    uint32_t bit_depth; // input BitDepth: 8, 10 or 12
+    uint32_t rgb_depth; // 8 or 16
+    uint32_t matrix_coefficients;
+    bool full_range;
+
+    int16_t off[3];  // subtracted from Y, U and V
+    int16_t m[3][3]; // [ R, G, B ][ Y, U, V ]
+    uint32_t shift;
+    int32_t round;   // 1 << ( shift - 1 )
+    uint16_t rgb_max; // ( 1 << rgb_depth ) - 1, also the alpha value
+    Av1Yuv2RgbDsp dsp;
+};
+
+// Scalar reference table.
+void av1_yuv2rgb_dsp_init_c(Av1Yuv2RgbDsp *dsp);
+
+// Best table for the running CPU.
+void av1_yuv2rgb_dsp_init(Av1Yuv2RgbDsp *dsp);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AV1_YUV2RGB_HAVE_X86 1
+// Overrides the table entries with AVX2 kernels; returns false (table untouched) when
+// av1_cpu_flags() has no AV1_CPU_AVX2.
+bool av1_yuv2rgb_dsp_init_avx2(Av1Yuv2RgbDsp *dsp);
+#endif
+
+// Builds the coefficients for matrix_coefficients (AV1_MC_*) and range, and picks the kernels.
+bool av1_yuv2rgb_init(Av1Yuv2Rgb *cv,
+                      uint32_t matrix_coefficients,
+                      bool full_range,
+                      uint32_t bit_depth,
+                      uint32_t rgb_depth,
+                      char *err,
+                      size_t err_cap);
+
+// Converts the visible area of fb (BitDepth must match cv) into rgba: fb->width RGBA pixels per
+// row, rows rgba_stride bytes apart.
+bool av1_yuv2rgb_frame(const Av1Yuv2Rgb *cv,
+                       const Av1FrameBuf *fb,
+                       void *rgba,
+                       ptrdiff_t rgba_stride,
+                       char *err,
+                       size_t err_cap);
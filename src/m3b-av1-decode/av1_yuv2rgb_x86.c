@@ -0,0 +1,210 @@
+#include "av1_yuv2rgb.h"
+#include "av1_cpu.h"
+
+// AVX2 YUV -> RGBA row kernels, bit-exact with the scalar kernels in av1_yuv2rgb.c.
+//
+// Sixteen pixels per step. Offset Y / U / V samples stay int16; each output channel is two madds
+// of interleaved ( Y, U ) and ( V, 0 ) pairs with the int16 coefficient pairs, so the 32-bit sums
+// are the scalar ones. Half-width chroma is upsampled in registers from one 16-sample load of the
+// near / far rows per step ( 3 * near + far fits 14 bits, the horizontal 3:1 mix plus rounding 16
+// unsigned bits). 8-bit output saturates to int16 and clamps to 0 .. 255, then packs R | G << 8 and
+// B | A << 8 words into RGBA dwords; 16-bit output saturates with packus_epi32. Functions carry a
+// target attribute so the file builds with the default CFLAGS; av1_yuv2rgb_dsp_init_avx2() checks
+// the CPU.
+
+#if defined(AV1_YUV2RGB_HAVE_X86)
+
+#include <immintrin.h>
+
+#define AVX2_ATTR __attribute__((target("avx2")))
+#define YUV_INLINE inline __attribute__((always_inline))
+
+// Sixteen samples at p + x as int16.
+static YUV_INLINE AVX2_ATTR __m256i load16(const void *p, ptrdiff_t x, bool in16) {
+    if (in16) {
+        return _mm256_loadu_si256((const __m256i *)(const void *)((const uint16_t *)p + x));
+    }
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(const void *)((const uint8_t *)p + x)));
+}
+
+// Upsampled chroma of luma columns x .. x + 15 (x a multiple of 16). One 16-sample load per row
+// covers chroma i - 1 .. i + 14; the left / center / right neighbors of i .. i + 7 are byte shifts
+// of the mixed rows.
+static YUV_INLINE AVX2_ATTR __m256i chroma_half(const void *c0, const void *c1, uint32_t x, bool in16) {
+    const ptrdiff_t i = (ptrdiff_t)(x >> 1) - 1;
+    const __m256i n = load16(c0, i, in16);
+    const __m256i m = _mm256_add_epi16(_mm256_add_epi16(n, _mm256_add_epi16(n, n)), load16(c1, i, in16));
+    const __m128i m_lo = _mm256_castsi256_si128(m);
+    const __m128i m_hi = _mm256_extracti128_si256(m, 1);
+    const __m128i c = _mm_alignr_epi8(m_hi, m_lo, 2);
+    const __m128i t = _mm_add_epi16(_mm_add_epi16(c, _mm_add_epi16(c, c)), _mm_set1_epi16(8));
+    const __m128i even = _mm_srli_epi16(_mm_add_epi16(t, m_lo), 4);
+    const __m128i odd = _mm_srli_epi16(_mm_add_epi16(t, _mm_alignr_epi8(m_hi, m_lo, 4)), 4);
+    const __m128i lo = _mm_unpacklo_epi16(even, odd);
+    const __m128i hi = _mm_unpackhi_epi16(even, odd);
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+typedef struct {
+    __m256i yu[3]; // ( m[ c ][ 0 ], m[ c ][ 1 ] ) pairs
+    __m256i v[3];  // ( m[ c ][ 2 ], 0 )
+    __m256i off[3];
+    __m256i round;
+    __m128i shift;
+} YuvConsts;
+
+static YUV_INLINE AVX2_ATTR void consts_init(YuvConsts *k, const Av1Yuv2Rgb *cv) {
+    for (uint32_t c = 0; c < 3u; c++) {
+        k->yu[c] = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)cv->m[c][1] << 16) | (uint16_t)cv->m[c][0]));
+        k->v[c] = _mm256_set1_epi32((int32_t)(uint16_t)cv->m[c][2]);
+        k->off[c] = _mm256_set1_epi16(cv->off[c]);
+    }
+    k->round = _mm256_set1_epi32(cv->round);
+    k->shift = _mm_cvtsi32_si128((int32_t)cv->shift);
+}
+
+// One channel as 8 + 8 int32 (pixels 0-3 / 8-11 and 4-7 / 12-15 per lane pair).
+static YUV_INLINE AVX2_ATTR void channel(const YuvConsts *k,
+                                          uint32_t c,
+                                          __m256i yu_lo,
+                                          __m256i yu_hi,
+                                          __m256i v_lo,
+                                          __m256i v_hi,
+                                          __m256i *lo,
+                                          __m256i *hi) {
+    const __m256i s_lo = _mm256_add_epi32(_mm256_madd_epi16(yu_lo, k->yu[c]), _mm256_madd_epi16(v_lo, k->v[c]));
+    const __m256i s_hi = _mm256_add_epi32(_mm256_madd_epi16(yu_hi, k->yu[c]), _mm256_madd_epi16(v_hi, k->v[c]));
+    *lo = _mm256_sra_epi32(_mm256_add_epi32(s_lo, k->round), k->shift);
+    *hi = _mm256_sra_epi32(_mm256_add_epi32(s_hi, k->round), k->shift);
+}
+
+static inline int32_t yuv_clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+static inline int32_t load_sample(const void *p, ptrdiff_t i, bool in16) {
+    return in16 ? (int32_t)((const uint16_t *)p)[i] : (int32_t)((const uint8_t *)p)[i];
+}
+
+static YUV_INLINE AVX2_ATTR void row_avx2(void *dst,
+                                          const void *y,
+                                          const void *u0,
+                                          const void *u1,
+                                          const void *v0,
+                                          const void *v1,
+                                          uint32_t w,
+                                          const Av1Yuv2Rgb *cv,
+                                          bool in16,
+                                          bool out16,
+                                          bool half) {
+    YuvConsts k;
+    consts_init(&k, cv);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max8 = _mm256_set1_epi16(255);
+    const __m256i alpha8 = _mm256_set1_epi16((int16_t)(255 << 8));
+    const __m256i alpha16 = _mm256_set1_epi16(-1);
+    uint32_t x = 0;
+    for (; x + 16u <= w; x += 16u) {
+        const __m256i yy = _mm256_sub_epi16(load16(y, x, in16), k.off[0]);
+        const __m256i uu = _mm256_sub_epi16(half ? chroma_half(u0, u1, x, in16) : load16(u0, x, in16), k.off[1]);
+        const __m256i vv = _mm256_sub_epi16(half ? chroma_half(v0, v1, x, in16) : load16(v0, x, in16), k.off[2]);
+        const __m256i yu_lo = _mm256_unpacklo_epi16(yy, uu);
+        const __m256i yu_hi = _mm256_unpackhi_epi16(yy, uu);
+        const __m256i v_lo = _mm256_unpacklo_epi16(vv, zero);
+        const __m256i v_hi = _mm256_unpackhi_epi16(vv, zero);
+        __m256i ch[3];
+        for (uint32_t c = 0; c < 3u; c++) {
+            __m256i lo, hi;
+            channel(&k, c, yu_lo, yu_hi, v_lo, v_hi, &lo, &hi);
+            // Both packs interleave the lo / hi halves back into pixel order.
+            if (out16) {
+                ch[c] = _mm256_packus_epi32(lo, hi);
+            } else {
+                ch[c] = _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(lo, hi), zero), max8);
+            }
+        }
+        if (!out16) {
+            const __m256i rg = _mm256_or_si256(ch[0], _mm256_slli_epi16(ch[1], 8));
+            const __m256i ba = _mm256_or_si256(ch[2], alpha8);
+            const __m256i lo = _mm256_unpacklo_epi16(rg, ba); // pixels 0-3, 8-11
+            const __m256i hi = _mm256_unpackhi_epi16(rg, ba); // pixels 4-7, 12-15
+            uint8_t *d = (uint8_t *)dst + 4u * x;
+            _mm256_storeu_si256((__m256i *)(void *)d, _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i *)(void *)(d + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+        } else {
+            const __m256i rg_lo = _mm256_unpacklo_epi16(ch[0], ch[1]);
+            const __m256i rg_hi = _mm256_unpackhi_epi16(ch[0], ch[1]);
+            const __m256i ba_lo = _mm256_unpacklo_epi16(ch[2], alpha16);
+            const __m256i ba_hi = _mm256_unpackhi_epi16(ch[2], alpha16);
+            const __m256i p0 = _mm256_unpacklo_epi32(rg_lo, ba_lo); // pixels 0-1, 8-9
+            const __m256i p1 = _mm256_unpackhi_epi32(rg_lo, ba_lo); // 2-3, 10-11
+            const __m256i p2 = _mm256_unpacklo_epi32(rg_hi, ba_hi); // 4-5, 12-13
+            const __m256i p3 = _mm256_unpackhi_epi32(rg_hi, ba_hi); // 6-7, 14-15
+            uint16_t *d = (uint16_t *)dst + 4u * x;
+            _mm256_storeu_si256((__m256i *)(void *)d, _mm256_permute2x128_si256(p0, p1, 0x20));
+            _mm256_storeu_si256((__m256i *)(void *)(d + 16), _mm256_permute2x128_si256(p2, p3, 0x20));
+            _mm256_storeu_si256((__m256i *)(void *)(d + 32), _mm256_permute2x128_si256(p0, p1, 0x31));
+            _mm256_storeu_si256((__m256i *)(void *)(d + 48), _mm256_permute2x128_si256(p2, p3, 0x31));
+        }
+    }
+    for (; x < w; x++) {
+        int32_t uu, vv;
+        if (half) {
+            const ptrdiff_t i = (ptrdiff_t)(x >> 1);
+            const ptrdiff_t side = (x & 1u) ? i + 1 : i - 1;
+            const int32_t u_near = 3 * load_sample(u0, i, in16) + load_sample(u1, i, in16);
+            const int32_t u_far = 3 * load_sample(u0, side, in16) + load_sample(u1, side, in16);
+            const int32_t v_near = 3 * load_sample(v0, i, in16) + load_sample(v1, i, in16);
+            const int32_t v_far = 3 * load_sample(v0, side, in16) + load_sample(v1, side, in16);
+            uu = (3 * u_near + u_far + 8) >> 4;
+            vv = (3 * v_near + v_far + 8) >> 4;
+        } else {
+            uu = load_sample(u0, x, in16);
+            vv = load_sample(v0, x, in16);
+        }
+        const int32_t yy = load_sample(y, x, in16) - cv->off[0];
+        uu -= cv->off[1];
+        vv -= cv->off[2];
+        for (uint32_t c = 0; c < 4u; c++) {
+            const int32_t s = c < 3u ? cv->m[c][0] * yy + cv->m[c][1] * uu + cv->m[c][2] * vv : 0;
+            const int32_t px = c < 3u ? yuv_clip3(0, cv->rgb_max, (s + cv->round) >> cv->shift) : cv->rgb_max;
+            if (out16) {
+                ((uint16_t *)dst)[4u * x + c] = (uint16_t)px;
+            } else {
+                ((uint8_t *)dst)[4u * x + c] = (uint8_t)px;
+            }
+        }
+    }
+}
+
+#define YUV2RGB_ROW_AVX2(name, in16, out16, half)                                                  \
+    static AVX2_ATTR void name(void *dst, const void *y, const void *u0, const void *u1,           \
+                               const void *v0, const void *v1, uint32_t w, const Av1Yuv2Rgb *cv) { \
+        row_avx2(dst, y, u0, u1, v0, v1, w, cv, in16, out16, half);                                \
+    }
+
+YUV2RGB_ROW_AVX2(row_8_8_avx2, false, false, false)
+YUV2RGB_ROW_AVX2(row_8_8_half_avx2, false, false, true)
+YUV2RGB_ROW_AVX2(row_8_16_avx2, false, true, false)
+YUV2RGB_ROW_AVX2(row_8_16_half_avx2, false, true, true)
+YUV2RGB_ROW_AVX2(row_16_8_avx2, true, false, false)
+YUV2RGB_ROW_AVX2(row_16_8_half_avx2, true, false, true)
+YUV2RGB_ROW_AVX2(row_16_16_avx2, true, true, false)
+YUV2RGB_ROW_AVX2(row_16_16_half_avx2, true, true, true)
+
+bool av1_yuv2rgb_dsp_init_avx2(Av1Yuv2RgbDsp *dsp) {
+    if (!(av1_cpu_flags() & AV1_CPU_AVX2)) {
+        return false;
+    }
+    dsp->row[0][0][0] = row_8_8_avx2;
+    dsp->row[0][0][1] = row_8_8_half_avx2;
+    dsp->row[0][1][0] = row_8_16_avx2;
+    dsp->row[0][1][1] = row_8_16_half_avx2;
+    dsp->row[1][0][0] = row_16_8_avx2;
+    dsp->row[1][0][1] = row_16_8_half_avx2;
+    dsp->row[1][1][0] = row_16_16_avx2;
+    dsp->row[1][1][1] = row_16_16_half_avx2;
+    return true;
+}
+
+#endif
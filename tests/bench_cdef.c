@@ -0,0 +1,150 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/m3b-av1-decode/av1_cdef.h"
+
+// CDEF kernel timing: scalar reference vs the tables av1_cdef_dsp_init() picks on this CPU, per
+// kernel on random 8x8 blocks, then a whole 1920x1088 I420 frame with half the 8x8 blocks skipped.
+//
+// Usage: bench_cdef [iterations]
+
+#define NUM_TILES 64
+
+static uint32_t g_rng = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint16_t g_tiles[NUM_TILES][12 * AV1_CDEF_TILE_STRIDE];
+static uint8_t g_dst[8 * 8];
+static volatile uint32_t g_sink;
+
+static double bench_dir(const Av1CdefDsp *dsp, uint32_t iters) {
+    uint32_t acc = 0, var = 0;
+    const double t0 = now_sec();
+    for (uint32_t it = 0; it < iters; it++) {
+        for (uint32_t t = 0; t < NUM_TILES; t++) {
+            acc += dsp->find_dir(g_tiles[t] + 2 * AV1_CDEF_TILE_STRIDE + 2, 0, &var) + var;
+        }
+    }
+    const double dt = now_sec() - t0;
+    g_sink = acc;
+    return dt * 1e9 / ((double)iters * NUM_TILES);
+}
+
+static double bench_filter(const Av1CdefDsp *dsp, uint32_t w, uint32_t iters) {
+    const uint32_t h = w ? 4u : 8u;
+    const double t0 = now_sec();
+    for (uint32_t it = 0; it < iters; it++) {
+        for (uint32_t t = 0; t < NUM_TILES; t++) {
+            dsp->filter[w](g_dst, 8, g_tiles[t] + 2 * AV1_CDEF_TILE_STRIDE + 2, 1 + (int32_t)(t % 15), (int32_t)(t % 3) * 2,
+                           t & 7u, 5, h);
+        }
+    }
+    const double dt = now_sec() - t0;
+    g_sink = g_dst[0];
+    return dt * 1e9 / ((double)iters * NUM_TILES);
+}
+
+static double bench_frame(const Av1CdefDsp *dsp, uint32_t iters, char *err, size_t err_cap) {
+    enum { W = 1920, H = 1088, MI_ROWS = H / 4, MI_COLS = W / 4, ROWS64 = (H + 63) / 64, COLS64 = W / 64 };
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    Av1FrameBuf *fb;
+    if (!av1_frame_pool_get(&pool, W, H, AV1_LAYOUT_I420, 8, &fb, err, err_cap)) {
+        return -1.0;
+    }
+    for (uint32_t p = 0; p < 3; p++) {
+        for (uint32_t y = 0; y < fb->plane_h[p]; y++) {
+            uint8_t *row = av1_frame_plane_8(fb, p) + (ptrdiff_t)y * fb->stride[p];
+            for (uint32_t x = 0; x < fb->plane_w[p]; x++) {
+                row[x] = (uint8_t)(((x + 2u * y) & 63u) + 96u + (rng_next() & 7u));
+            }
+        }
+    }
+    static uint8_t skip[MI_ROWS * MI_COLS];
+    static int8_t idx[ROWS64 * COLS64];
+    for (uint32_t i = 0; i < MI_ROWS * MI_COLS; i++) {
+        skip[i] = (uint8_t)(((i / MI_COLS) / 2 + (i % MI_COLS) / 2) & 1u);
+    }
+    for (uint32_t i = 0; i < ROWS64 * COLS64; i++) {
+        idx[i] = (int8_t)(i & 3u);
+    }
+    Av1CdefParams prm;
+    av1_cdef_params_default(&prm);
+    prm.damping = 5;
+    for (uint32_t i = 0; i < 4; i++) {
+        prm.y_pri[i] = (uint8_t)(4u + 3u * i);
+        prm.y_sec[i] = (uint8_t)(i & 1u ? 2u : 1u);
+        prm.uv_pri[i] = (uint8_t)(2u + i);
+        prm.uv_sec[i] = (uint8_t)(i & 1u);
+    }
+    Av1Cdef cdef;
+    if (!av1_cdef_init(&cdef, fb, skip, MI_COLS, idx, COLS64, MI_ROWS, MI_COLS, &prm, err, err_cap)) {
+        av1_frame_pool_put(&pool, fb);
+        av1_frame_pool_free(&pool);
+        return -1.0;
+    }
+    cdef.dsp = *dsp;
+    const double t0 = now_sec();
+    for (uint32_t it = 0; it < iters; it++) {
+        av1_cdef_filter_frame(&cdef);
+    }
+    const double dt = now_sec() - t0;
+    av1_cdef_free(&cdef);
+    av1_frame_pool_put(&pool, fb);
+    av1_frame_pool_free(&pool);
+    return dt * 1e3 / (double)iters;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 20000;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    for (uint32_t t = 0; t < NUM_TILES; t++) {
+        const uint32_t dx = rng_next() % 4u, dy = rng_next() % 4u;
+        for (uint32_t y = 0; y < 12; y++) {
+            for (uint32_t x = 0; x < 12; x++) {
+                g_tiles[t][y * AV1_CDEF_TILE_STRIDE + x] = (uint16_t)((((x * dx + y * dy) & 3u) * 40u + (rng_next() & 15u)) & 255u);
+            }
+        }
+    }
+    Av1CdefDsp c, best;
+    av1_cdef_dsp_init_c(&c);
+    av1_cdef_dsp_init(&best);
+
+    printf("%-12s %12s %12s %8s\n", "kernel", "c_ns/blk", "best_ns/blk", "speedup");
+    const double dc = bench_dir(&c, iters), db = bench_dir(&best, iters);
+    printf("%-12s %12.1f %12.1f %7.1fx\n", "find_dir", dc, db, dc / db);
+    static const char *const kNames[2] = {"filter_8x8", "filter_4x4"};
+    for (uint32_t w = 0; w < 2; w++) {
+        const double fc = bench_filter(&c, w, iters), fbst = bench_filter(&best, w, iters);
+        printf("%-12s %12.1f %12.1f %7.1fx\n", kNames[w], fc, fbst, fc / fbst);
+    }
+
+    char err[256];
+    const uint32_t frame_iters = iters / 2000u ? iters / 2000u : 1u;
+    const double mc = bench_frame(&c, frame_iters, err, sizeof(err));
+    const double mb = bench_frame(&best, frame_iters, err, sizeof(err));
+    if (mc < 0.0 || mb < 0.0) {
+        fprintf(stderr, "frame setup failed: %s\n", err);
+        return 1;
+    }
+    printf("%-12s %10.2fms %10.2fms %7.1fx\n", "frame_1080p", mc, mb, mc / mb);
+    return 0;
+}
@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/m3b-av1-decode/av1_inv_txfm.h"
+
+// Reduced-size inverse transform: transform-only PSNR-vs-speed report.
+//
+// For each transform size and scale (1/2, 1/4, 1/8), compares the truncated inverse transform
+// against the full-resolution spec transform followed by a 2^s x 2^s box downsample, on
+// synthetic coefficient blocks with a natural-image-like spectrum (magnitude decaying with
+// frequency, most high-frequency coefficients zero).
+//
+// Usage: bench_reduced_res [iterations]
+
+typedef struct {
+    uint32_t tx_size;
+    const char *name;
+} TxCase;
+
+static const TxCase kCases[] = {
+    {1, "8x8"},
+    {2, "16x16"},
+    {3, "32x32"},
+    {4, "64x64"},
+    {8, "16x8"},
+    {10, "32x16"},
+};
+
+static uint32_t g_rng = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void gen_coeffs(int32_t *c, uint32_t w, uint32_t h) {
+    memset(c, 0, (size_t)w * h * sizeof(int32_t));
+    for (uint32_t i = 0; i < h && i < 32; i++) {
+        for (uint32_t j = 0; j < w && j < 32; j++) {
+            uint32_t f = i + j;
+            // Keep ~1/(1+f) of the coefficients, with magnitude ~ 1024/(1+f)^1.5.
+            if (rng_next() % (1u + f) != 0) {
+                continue;
+            }
+            double mag = 1024.0 / pow(1.0 + (double)f, 1.5);
+            int32_t v = (int32_t)(mag * (double)(rng_next() % 1000u) / 1000.0);
+            c[(size_t)i * w + j] = (rng_next() & 1u) ? -v : v;
+        }
+    }
+}
+
+static void box_downsample(const int32_t *in, uint32_t w, uint32_t h, uint32_t s, int32_t *out) {
+    const uint32_t ow = w >> s ? w >> s : 1u;
+    const uint32_t oh = h >> s ? h >> s : 1u;
+    const uint32_t fx = w / ow;
+    const uint32_t fy = h / oh;
+    for (uint32_t i = 0; i < oh; i++) {
+        for (uint32_t j = 0; j < ow; j++) {
+            int64_t sum = 0;
+            for (uint32_t y = 0; y < fy; y++) {
+                for (uint32_t x = 0; x < fx; x++) {
+                    sum += in[(size_t)(i * fy + y) * w + j * fx + x];
+                }
+            }
+            int64_t n = (int64_t)fx * fy;
+            out[(size_t)i * ow + j] = (int32_t)((sum + (sum >= 0 ? n / 2 : -n / 2)) / n);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 2000;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+        if (iters == 0) {
+            iters = 1;
+        }
+    }
+
+    static int32_t coeffs[64 * 64];
+    static int32_t full[64 * 64];
+    static int32_t ref[64 * 64];
+    static int32_t red[64 * 64];
+    char err[256];
+
+    printf("%-6s %-5s %10s %12s %12s %8s\n", "tx", "scale", "psnr_dB", "full_ns/blk", "red_ns/blk", "speedup");
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        const TxCase *tc = &kCases[ci];
+        const uint32_t w = 1u << av1_txfm_width_log2(tc->tx_size);
+        const uint32_t h = 1u << av1_txfm_height_log2(tc->tx_size);
+        for (uint32_t s = 1; s <= 3; s++) {
+            const uint32_t ow = w >> s ? w >> s : 1u;
+            const uint32_t oh = h >> s ? h >> s : 1u;
+            double sse = 0.0;
+            uint64_t samples = 0;
+            double t_full = 0.0;
+            double t_red = 0.0;
+            g_rng = 0x12345678u + (uint32_t)ci * 7919u + s;
+            for (uint32_t it = 0; it < iters; it++) {
+                gen_coeffs(coeffs, w, h);
+
+                double t0 = now_sec();
+                if (!av1_inv_txfm2d_reduced(coeffs, tc->tx_size, AV1_TXFM_DCT_DCT, 8, 0, full, err, sizeof(err))) {
+                    fprintf(stderr, "full transform failed: %s\n", err);
+                    return 1;
+                }
+                box_downsample(full, w, h, s, ref);
+                double t1 = now_sec();
+                if (!av1_inv_txfm2d_reduced(coeffs, tc->tx_size, AV1_TXFM_DCT_DCT, 8, s, red, err, sizeof(err))) {
+                    fprintf(stderr, "reduced transform failed: %s\n", err);
+                    return 1;
+                }
+                double t2 = now_sec();
+                t_full += t1 - t0;
+                t_red += t2 - t1;
+
+                for (uint32_t k = 0; k < ow * oh; k++) {
+                    double d = (double)ref[k] - (double)red[k];
+                    sse += d * d;
+                }
+                samples += (uint64_t)ow * oh;
+            }
+            double mse = sse / (double)samples;
+            double psnr = mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+            printf("%-6s 1/%-3u %10.2f %12.0f %12.0f %7.1fx\n",
+                   tc->name,
+                   1u << s,
+                   psnr,
+                   t_full * 1e9 / iters,
+                   t_red * 1e9 / iters,
+                   t_red > 0.0 ? t_full / t_red : 0.0);
+        }
+    }
+    return 0;
+}
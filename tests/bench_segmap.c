@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/m3b-av1-decode/av1_segmap.h"
+
+// intra_segment_id() bookkeeping per frame: prediction, CDF context and store for every block of a
+// 3840x2160 frame (960x540 MI, 64x64 superblocks, random partition trees down to 4x4), with the
+// tile decoder's code paths copied in:
+//   before     segment_id_pred_from_mi_grid() / segment_id_ctx_from_mi_grid() /
+//              mi_set_segment_id_block() as they were before the frame-wide map existed
+//   after      segment_id_predict() / mi_set_segment_id_block() of the current decoder, without a
+//              map (Av1TileDecodeParams.segmap == NULL)
+//   lines      after, with U / L read from byte above / left lines instead of the MI grid
+//   after+blk  after, storing every block into the packed map (av1_segmap_set_block())
+//   after+sb   after, storing every finished superblock into the packed map
+//              (av1_segmap_store_row(); what the decoder does when segmap is set)
+//
+// Usage: bench_segmap [iterations]
+
+enum { SB4 = 16 };
+
+// Same layout as the tile decoder's Av1MiSize.
+typedef struct {
+    uint8_t wlog2, hlog2, skip, y_mode, palette_y_size, palette_uv_size;
+    uint8_t segment_id;
+    uint8_t is_inter;
+    int16_t mv[2];
+} BenchMi;
+
+typedef struct {
+    uint16_t r, c;
+    uint8_t wlog2, hlog2;
+    uint8_t skip;    // segment_id = prediction, no CDF context needed
+    uint8_t seg;     // coded segment_id; 8: same as the prediction
+    uint8_t sb_last; // last block of its superblock
+} BenchBlock;
+
+// Runtime dimensions, as in the decoder.
+static uint32_t g_mi_rows = 540, g_mi_cols = 960;
+
+static uint32_t g_rng = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static BenchBlock *g_blocks;
+static size_t g_num_blocks;
+
+static void add_block(uint32_t r, uint32_t c, uint32_t wlog2, uint32_t hlog2) {
+    if (r >= g_mi_rows || c >= g_mi_cols) {
+        return;
+    }
+    BenchBlock *b = &g_blocks[g_num_blocks++];
+    b->r = (uint16_t)r;
+    b->c = (uint16_t)c;
+    b->wlog2 = (uint8_t)wlog2;
+    b->hlog2 = (uint8_t)hlog2;
+    b->skip = (uint8_t)(rng_next() % 4u == 0u);
+    b->seg = (uint8_t)(rng_next() % 3u ? 8u : rng_next() % 8u);
+    b->sb_last = 0;
+}
+
+static void add_partition(uint32_t r, uint32_t c, uint32_t bsl) {
+    if (r >= g_mi_rows || c >= g_mi_cols) {
+        return;
+    }
+    const uint32_t half = (1u << bsl) >> 1;
+    // Mostly split, as in detailed intra content.
+    const uint32_t kind = bsl == 0u ? 0u : (rng_next() % 8u < 5u ? 3u : rng_next() % 3u);
+    if (kind == 0u) {
+        add_block(r, c, bsl, bsl);
+    } else if (kind == 1u) {
+        add_block(r, c, bsl, bsl - 1u);
+        add_block(r + half, c, bsl, bsl - 1u);
+    } else if (kind == 2u) {
+        add_block(r, c, bsl - 1u, bsl);
+        add_block(r, c + half, bsl - 1u, bsl);
+    } else {
+        add_partition(r, c, bsl - 1u);
+        add_partition(r, c + half, bsl - 1u);
+        add_partition(r + half, c, bsl - 1u);
+        add_partition(r + half, c + half, bsl - 1u);
+    }
+}
+
+static uint32_t block_segment_id(const BenchBlock *b, uint32_t pred) {
+    return (b->skip || b->seg == 8u) ? pred : b->seg;
+}
+
+static uint32_t mi_index(uint32_t row, uint32_t col, uint32_t stride) {
+    return row * stride + col;
+}
+
+// --- before ---
+
+static uint32_t before_ctx(const BenchMi *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c) {
+    if (!mi_grid || r >= mi_rows || c >= mi_cols) {
+        return 0u;
+    }
+    const bool availU = (r > 0u);
+    const bool availL = (c > 0u);
+    const bool availUL = availU && availL;
+    const int32_t prevUL = availUL ? (int32_t)mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id : -1;
+    const int32_t prevU = availU ? (int32_t)mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id : -1;
+    const int32_t prevL = availL ? (int32_t)mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : -1;
+    uint32_t ctx = 0u;
+    if (prevUL < 0) {
+        ctx = 0u;
+    } else if ((prevUL == prevU) && (prevUL == prevL)) {
+        ctx = 2u;
+    } else if ((prevUL == prevU) || (prevUL == prevL) || (prevU == prevL)) {
+        ctx = 1u;
+    } else {
+        ctx = 0u;
+    }
+    if (ctx >= 3u) {
+        ctx = 2u;
+    }
+    return ctx;
+}
+
+static uint32_t before_pred(const BenchMi *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c) {
+    if (!mi_grid || r >= mi_rows || c >= mi_cols) {
+        return 0u;
+    }
+    const bool availU = (r > 0u);
+    const bool availL = (c > 0u);
+    const bool availUL = availU && availL;
+    const int32_t prevUL = availUL ? (int32_t)mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id : -1;
+    const int32_t prevU = availU ? (int32_t)mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id : -1;
+    const int32_t prevL = availL ? (int32_t)mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : -1;
+    uint32_t pred = 0u;
+    if (prevU == -1) {
+        pred = (prevL == -1) ? 0u : (uint32_t)prevL;
+    } else if (prevL == -1) {
+        pred = (uint32_t)prevU;
+    } else {
+        pred = (prevUL == prevU) ? (uint32_t)prevU : (uint32_t)prevL;
+    }
+    if (pred >= 8u) {
+        pred = 0u;
+    }
+    return pred;
+}
+
+static void before_set(BenchMi *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c, uint32_t wlog2, uint32_t hlog2, uint32_t segment_id) {
+    const uint32_t w = 1u << wlog2;
+    const uint32_t h = 1u << hlog2;
+    for (uint32_t rr = 0; rr < h; rr++) {
+        for (uint32_t cc = 0; cc < w; cc++) {
+            const uint32_t y = r + rr;
+            const uint32_t x = c + cc;
+            if (y < mi_rows && x < mi_cols) {
+                mi_grid[mi_index(y, x, mi_cols)].segment_id = (uint8_t)segment_id;
+            }
+        }
+    }
+}
+
+static uint64_t run_before(BenchMi *grid) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < g_num_blocks; i++) {
+        const BenchBlock *b = &g_blocks[i];
+        const uint32_t pred = before_pred(grid, g_mi_rows, g_mi_cols, b->r, b->c);
+        const uint32_t ctx = b->skip ? 0u : before_ctx(grid, g_mi_rows, g_mi_cols, b->r, b->c);
+        const uint32_t seg = block_segment_id(b, pred);
+        sum += seg + ctx;
+        before_set(grid, g_mi_rows, g_mi_cols, b->r, b->c, b->wlog2, b->hlog2, seg);
+    }
+    return sum;
+}
+
+// --- after ---
+
+static void after_set(BenchMi *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c, uint32_t wlog2, uint32_t hlog2, uint32_t segment_id) {
+    if (r >= mi_rows || c >= mi_cols) {
+        return;
+    }
+    const uint32_t w = (1u << wlog2) < mi_cols - c ? (1u << wlog2) : mi_cols - c;
+    const uint32_t h = (1u << hlog2) < mi_rows - r ? (1u << hlog2) : mi_rows - r;
+    for (uint32_t y = 0; y < h; y++) {
+        BenchMi *row = &mi_grid[mi_index(r + y, c, mi_cols)];
+        for (uint32_t x = 0; x < w; x++) {
+            row[x].segment_id = (uint8_t)segment_id;
+        }
+    }
+}
+
+static void after_predict(const BenchMi *mi_grid, uint32_t mi_rows, uint32_t mi_cols, uint32_t r, uint32_t c, uint32_t *pred, uint32_t *ctx) {
+    *pred = 0u;
+    *ctx = 0u;
+    if (r >= mi_rows || c >= mi_cols) {
+        return;
+    }
+    if (r == 0u) {
+        *pred = c > 0u ? mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id : 0u;
+        return;
+    }
+    const uint32_t prev_u = mi_grid[mi_index(r - 1u, c, mi_cols)].segment_id;
+    if (c == 0u) {
+        *pred = prev_u;
+        return;
+    }
+    const uint32_t prev_l = mi_grid[mi_index(r, c - 1u, mi_cols)].segment_id;
+    const uint32_t prev_ul = mi_grid[mi_index(r - 1u, c - 1u, mi_cols)].segment_id;
+    *pred = prev_ul == prev_u ? prev_u : prev_l;
+    if (prev_ul == prev_u && prev_ul == prev_l) {
+        *ctx = 2u;
+    } else if (prev_ul == prev_u || prev_ul == prev_l || prev_u == prev_l) {
+        *ctx = 1u;
+    }
+}
+
+enum { MAP_NONE, MAP_BLOCK, MAP_SB };
+
+static uint64_t run_after(BenchMi *grid, Av1SegMap *map, int map_mode) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < g_num_blocks; i++) {
+        const BenchBlock *b = &g_blocks[i];
+        uint32_t pred, ctx;
+        after_predict(grid, g_mi_rows, g_mi_cols, b->r, b->c, &pred, &ctx);
+        const uint32_t seg = block_segment_id(b, pred);
+        sum += seg + (b->skip ? 0u : ctx);
+        after_set(grid, g_mi_rows, g_mi_cols, b->r, b->c, b->wlog2, b->hlog2, seg);
+        if (map_mode == MAP_BLOCK) {
+            av1_segmap_set_block(map, b->r, b->c, 1u << b->wlog2, 1u << b->hlog2, seg);
+        } else if (map_mode == MAP_SB && b->sb_last) {
+            const uint32_t r0 = b->r & ~(SB4 - 1u);
+            const uint32_t c0 = b->c & ~(SB4 - 1u);
+            const uint32_t n = SB4 < g_mi_cols - c0 ? SB4 : g_mi_cols - c0;
+            for (uint32_t y = r0; y < r0 + SB4 && y < g_mi_rows; y++) {
+                av1_segmap_store_row(map, y, c0, &grid[mi_index(y, c0, g_mi_cols)].segment_id, sizeof(BenchMi), n);
+            }
+        }
+    }
+    return sum;
+}
+
+// --- lines ---
+
+static uint64_t run_lines(BenchMi *grid, uint8_t *above, uint8_t *left) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < g_num_blocks; i++) {
+        const BenchBlock *b = &g_blocks[i];
+        const uint32_t r = b->r, c = b->c;
+        uint32_t pred = 0u, ctx = 0u;
+        if (r == 0u) {
+            pred = c > 0u ? left[r] : 0u;
+        } else if (c == 0u) {
+            pred = above[c];
+        } else {
+            const uint32_t u = above[c];
+            const uint32_t l = left[r];
+            const uint32_t ul = grid[mi_index(r - 1u, c - 1u, g_mi_cols)].segment_id;
+            pred = ul == u ? u : l;
+            ctx = (ul == u && ul == l) ? 2u : (ul == u || ul == l || u == l) ? 1u : 0u;
+        }
+        const uint32_t seg = block_segment_id(b, pred);
+        sum += seg + (b->skip ? 0u : ctx);
+        after_set(grid, g_mi_rows, g_mi_cols, r, c, b->wlog2, b->hlog2, seg);
+        const uint32_t w = (1u << b->wlog2) < g_mi_cols - c ? (1u << b->wlog2) : g_mi_cols - c;
+        const uint32_t h = (1u << b->hlog2) < g_mi_rows - r ? (1u << b->hlog2) : g_mi_rows - r;
+        for (uint32_t x = 0; x < w; x++) {
+            above[c + x] = (uint8_t)seg;
+        }
+        for (uint32_t y = 0; y < h; y++) {
+            left[r + y] = (uint8_t)seg;
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 50;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    g_blocks = malloc((size_t)g_mi_rows * g_mi_cols * sizeof(*g_blocks));
+    BenchMi *grid = calloc((size_t)g_mi_rows * g_mi_cols, sizeof(*grid));
+    uint8_t *above = calloc(g_mi_cols, 1);
+    uint8_t *left = calloc(g_mi_rows, 1);
+    Av1SegMap map;
+    char err[256];
+    if (!g_blocks || !grid || !above || !left || !av1_segmap_init(&map, g_mi_rows, g_mi_cols, err, sizeof(err))) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    // Raster order of the superblocks.
+    for (uint32_t r = 0; r < g_mi_rows; r += SB4) {
+        for (uint32_t c = 0; c < g_mi_cols; c += SB4) {
+            add_partition(r, c, 4);
+            g_blocks[g_num_blocks - 1u].sb_last = 1;
+        }
+    }
+
+    static const char *const kNames[5] = {"before", "after", "lines", "after+blk", "after+sb"};
+    double ms[5] = {0};
+    uint64_t sums[5] = {0};
+    // Interleaved rounds so that clock and cache drift hit every variant alike.
+    for (uint32_t it = 0; it < iters; it++) {
+        for (uint32_t v = 0; v < 5; v++) {
+            const double t0 = now_sec();
+            if (v == 0u) {
+                sums[v] = run_before(grid);
+            } else if (v == 1u) {
+                sums[v] = run_after(grid, NULL, MAP_NONE);
+            } else if (v == 2u) {
+                sums[v] = run_lines(grid, above, left);
+            } else {
+                sums[v] = run_after(grid, &map, v == 3u ? MAP_BLOCK : MAP_SB);
+            }
+            ms[v] += (now_sec() - t0) * 1e3;
+        }
+    }
+    for (uint32_t v = 1; v < 5; v++) {
+        if (sums[v] != sums[0]) {
+            fprintf(stderr, "%s disagrees with before\n", kNames[v]);
+            return 1;
+        }
+    }
+    // The map left behind by the last round matches the MI grid.
+    for (uint32_t r = 0; r < g_mi_rows; r++) {
+        for (uint32_t c = 0; c < g_mi_cols; c++) {
+            if (av1_segmap_get(&map, r, c) != grid[mi_index(r, c, g_mi_cols)].segment_id) {
+                fprintf(stderr, "map mismatch at mi (%u, %u)\n", r, c);
+                return 1;
+            }
+        }
+    }
+    printf("%zu blocks per frame, %u iterations\n", g_num_blocks, iters);
+    printf("%-10s %10s %10s\n", "variant", "ms/frame", "vs before");
+    for (uint32_t v = 0; v < 5; v++) {
+        printf("%-10s %8.3fms %9.2fx\n", kNames[v], ms[v] / iters, ms[0] / ms[v]);
+    }
+    av1_segmap_free(&map);
+    free(left);
+    free(above);
+    free(grid);
+    free(g_blocks);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/m3b-av1-decode/av1_superres.h"
+
+// Superres timing: scalar reference vs the tables av1_superres_dsp_init() picks on this CPU, on a
+// whole 1920x1080 I420 frame upscaled from each of 960 (denominator 16) and 1707 (denominator 9)
+// columns.
+//
+// Usage: bench_superres [iterations]
+
+static uint32_t g_rng = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double bench_frame(const Av1SuperresDsp *dsp, uint32_t denom, uint32_t iters, char *err, size_t err_cap) {
+    enum { W = 1920, H = 1080 };
+    const uint32_t w = av1_superres_coded_width(W, denom);
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    Av1FrameBuf *src, *dst;
+    if (!av1_frame_pool_get(&pool, w, H, AV1_LAYOUT_I420, 8, &src, err, err_cap) ||
+        !av1_frame_pool_get(&pool, W, H, AV1_LAYOUT_I420, 8, &dst, err, err_cap)) {
+        return -1.0;
+    }
+    for (uint32_t p = 0; p < 3; p++) {
+        for (uint32_t y = 0; y < src->plane_h[p]; y++) {
+            uint8_t *row = av1_frame_plane_8(src, p) + (ptrdiff_t)y * src->stride[p];
+            for (uint32_t x = 0; x < src->plane_w[p] + 8u; x++) {
+                row[x] = (uint8_t)(((x + 2u * y) & 63u) + 96u + (rng_next() & 7u));
+            }
+        }
+    }
+    Av1Superres sr;
+    if (!av1_superres_init(&sr, dst, src, 2u * ((w + 7u) >> 3), err, err_cap)) {
+        return -1.0;
+    }
+    sr.dsp = *dsp;
+    const double t0 = now_sec();
+    for (uint32_t it = 0; it < iters; it++) {
+        av1_superres_filter_frame(&sr);
+    }
+    const double dt = now_sec() - t0;
+    av1_frame_pool_put(&pool, src);
+    av1_frame_pool_put(&pool, dst);
+    av1_frame_pool_free(&pool);
+    return dt * 1e3 / (double)iters;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 20;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    Av1SuperresDsp c, best;
+    av1_superres_dsp_init_c(&c);
+    av1_superres_dsp_init(&best);
+
+    char err[256];
+    printf("%-12s %12s %12s %8s\n", "frame", "c_ms", "best_ms", "speedup");
+    static const uint32_t kDenoms[2] = {16, 9};
+    for (uint32_t i = 0; i < 2; i++) {
+        const double mc = bench_frame(&c, kDenoms[i], iters, err, sizeof(err));
+        const double mb = bench_frame(&best, kDenoms[i], iters, err, sizeof(err));
+        if (mc < 0.0 || mb < 0.0) {
+            fprintf(stderr, "frame setup failed: %s\n", err);
+            return 1;
+        }
+        printf("1080p_d%-5u %10.2fms %10.2fms %7.1fx\n", kDenoms[i], mc, mb, mc / mb);
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/m3b-av1-decode/av1_yuv2rgb.h"
+
+// YUV -> RGBA timing: scalar reference vs the tables av1_yuv2rgb_dsp_init() picks on this CPU,
+// converting whole frames (BT.709 limited range). GB/s counts the bytes read and written.
+//
+// Usage: bench_yuv2rgb [iterations]
+
+static uint32_t g_rng = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t w;
+    uint32_t h;
+    uint32_t layout;
+    uint32_t bit_depth;
+    uint32_t rgb_depth;
+} BenchCase;
+
+static double bench_frame(const BenchCase *bc,
+                          const Av1Yuv2RgbDsp *dsp,
+                          uint32_t iters,
+                          double *bytes,
+                          char *err,
+                          size_t err_cap) {
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    Av1FrameBuf *fb;
+    if (!av1_frame_pool_get(&pool, bc->w, bc->h, bc->layout, bc->bit_depth, &fb, err, err_cap)) {
+        return -1.0;
+    }
+    *bytes = 0.0;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        for (uint32_t y = 0; y < fb->plane_h[p]; y++) {
+            for (uint32_t x = 0; x < fb->plane_w[p]; x++) {
+                const uint32_t v = (((x + 2u * y) & 127u) + 64u + (rng_next() & 15u)) << (bc->bit_depth - 8u);
+                const ptrdiff_t i = (ptrdiff_t)y * fb->stride[p] + x;
+                if (fb->bytes_per_sample == 2u) {
+                    av1_frame_plane_16(fb, p)[i] = (uint16_t)v;
+                } else {
+                    av1_frame_plane_8(fb, p)[i] = (uint8_t)v;
+                }
+            }
+        }
+        *bytes += (double)fb->plane_w[p] * fb->plane_h[p] * fb->bytes_per_sample;
+    }
+    Av1Yuv2Rgb cv;
+    if (!av1_yuv2rgb_init(&cv, AV1_MC_BT_709, false, bc->bit_depth, bc->rgb_depth, err, err_cap)) {
+        return -1.0;
+    }
+    cv.dsp = *dsp;
+    const ptrdiff_t stride = (ptrdiff_t)bc->w * 4 * (bc->rgb_depth / 8u);
+    *bytes += (double)stride * bc->h;
+    void *rgba = malloc((size_t)stride * bc->h);
+    if (rgba == NULL) {
+        snprintf(err, err_cap, "out of memory");
+        return -1.0;
+    }
+    memset(rgba, 0, (size_t)stride * bc->h);
+    const double t0 = now_sec();
+    for (uint32_t it = 0; it < iters; it++) {
+        if (!av1_yuv2rgb_frame(&cv, fb, rgba, stride, err, err_cap)) {
+            free(rgba);
+            return -1.0;
+        }
+    }
+    const double dt = now_sec() - t0;
+    free(rgba);
+    av1_frame_pool_put(&pool, fb);
+    av1_frame_pool_free(&pool);
+    return dt * 1e3 / (double)iters;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 20;
+    if (argc > 1) {
+        iters = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    Av1Yuv2RgbDsp c, best;
+    av1_yuv2rgb_dsp_init_c(&c);
+    av1_yuv2rgb_dsp_init(&best);
+
+    static const BenchCase kCases[] = {
+        {"1080p_420_8", 1920, 1080, AV1_LAYOUT_I420, 8, 8},
+        {"1080p_444_8", 1920, 1080, AV1_LAYOUT_I444, 8, 8},
+        {"1080p_420_10", 1920, 1080, AV1_LAYOUT_I420, 10, 16},
+        {"2160p_420_8", 3840, 2160, AV1_LAYOUT_I420, 8, 8},
+        {"2160p_420_10", 3840, 2160, AV1_LAYOUT_I420, 10, 16},
+    };
+    char err[256];
+    printf("%-14s %12s %12s %8s %10s\n", "frame", "c_ms", "best_ms", "speedup", "best_GB/s");
+    for (uint32_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+        double bytes;
+        const double mc = bench_frame(&kCases[i], &c, iters, &bytes, err, sizeof(err));
+        const double mb = bench_frame(&kCases[i], &best, iters, &bytes, err, sizeof(err));
+        if (mc < 0.0 || mb < 0.0) {
+            fprintf(stderr, "frame setup failed: %s\n", err);
+            return 1;
+        }
+        printf("%-14s %10.2fms %10.2fms %7.1fx %10.2f\n", kCases[i].name, mc, mb, mc / mb, bytes / (mb * 1e6));
+    }
+    return 0;
+}
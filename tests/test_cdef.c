@@ -0,0 +1,456 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_cdef.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+#define LARGE AV1_CDEF_VERY_LARGE
+#define TS AV1_CDEF_TILE_STRIDE
+
+static const int32_t kSecStrengths[4] = {0, 1, 2, 4};
+
+// 8x8 block at tile + 2 * TS + 2 with a two-sample margin; each margin side is unavailable with
+// probability 1/4. Values follow a random direction so the direction search has work to do, or
+// are flat with shallow pits.
+static void fill_tile(uint16_t *tile, uint32_t max) {
+    const int32_t dx = rand() % 5 - 2, dy = rand() % 5 - 2;
+    const int32_t base = rand() % (int32_t)(max + 1u);
+    const int32_t amp = rand() % 3 == 0 ? (int32_t)max : (int32_t)(max >> 3) + 1;
+    const bool flat = rand() % 3 == 0;
+    const bool top = rand() % 4 == 0, bottom = rand() % 4 == 0, left = rand() % 4 == 0, right = rand() % 4 == 0;
+    for (int32_t y = 0; y < 12; y++) {
+        for (int32_t x = 0; x < 12; x++) {
+            int32_t v = base + ((x * dx + y * dy) & 3) * amp / 4 + rand() % (amp / 4 + 1) - amp / 8;
+            if (flat) {
+                // Shallow pits in a flat area: the filter output reaches the clipping maximum.
+                v = base - (rand() % 2 ? rand() % 4 : 0);
+            }
+            v = v < 0 ? 0 : (v > (int32_t)max ? (int32_t)max : v);
+            const bool na = (y < 2 && top) || (y >= 10 && bottom) || (x < 2 && left) || (x >= 10 && right);
+            tile[y * TS + x] = na ? (uint16_t)LARGE : (uint16_t)v;
+        }
+    }
+}
+
+static int test_direction(void) {
+    // Horizontal stripes: yDir 2. Vertical stripes: yDir 6.
+    Av1CdefDsp c, best;
+    av1_cdef_dsp_init_c(&c);
+    av1_cdef_dsp_init(&best);
+    static uint16_t tile[12 * TS];
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            tile[y * TS + x] = (uint16_t)(y & 1 ? 200 : 40);
+            tile[(y + 2) * TS + x + 20] = (uint16_t)(x & 1 ? 200 : 40);
+        }
+    }
+    uint32_t var = 0;
+    CHECK(c.find_dir(tile, 0, &var) == 2 && var > 0);
+    CHECK(best.find_dir(tile, 0, &var) == 2);
+    CHECK(c.find_dir(tile + 2 * TS + 20, 0, &var) == 6);
+    CHECK(best.find_dir(tile + 2 * TS + 20, 0, &var) == 6);
+
+    // Flat block: no preferred direction.
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            tile[y * TS + x] = 128;
+        }
+    }
+    CHECK(c.find_dir(tile, 0, &var) == 0 && var == 0);
+    return 0;
+}
+
+static int test_kernels(void) {
+    static uint16_t tile[12 * TS];
+    uint8_t ref[8 * 8], out[8 * 8];
+    Av1CdefDsp c, best;
+    av1_cdef_dsp_init_c(&c);
+    av1_cdef_dsp_init(&best);
+    for (int iter = 0; iter < 4000; iter++) {
+        // 8-bit tiles through both tables; 10 / 12-bit tiles through the direction search only.
+        const uint32_t shift = iter % 4 == 3 ? (uint32_t)(rand() % 2) * 2u + 2u : 0u;
+        fill_tile(tile, (1u << (8u + shift)) - 1u);
+        const uint16_t *in = tile + 2 * TS + 2;
+        uint32_t var_c = 0, var_b = 0;
+        const uint32_t dir = c.find_dir(in, shift, &var_c);
+        CHECK(best.find_dir(in, shift, &var_b) == dir && var_b == var_c);
+        if (shift) {
+            continue;
+        }
+        const int32_t pri = rand() % 16;
+        const int32_t sec = kSecStrengths[rand() % 4];
+        const uint32_t damping = 3u + (uint32_t)(rand() % 4) - (uint32_t)(iter & 1);
+        for (uint32_t w = 0; w < 2; w++) {
+            const uint32_t h = w ? 4u << (rand() % 2) : 8u;
+            memset(ref, 0, sizeof(ref));
+            memset(out, 0, sizeof(out));
+            c.filter[w](ref, 8, in, pri, sec, dir, damping, h);
+            best.filter[w](out, 8, in, pri, sec, dir, damping, h);
+            CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+        }
+    }
+    return 0;
+}
+
+// ---- Spec 7.15 transcription ----
+
+typedef struct {
+    uint32_t w, h;
+    int32_t *px;
+} RefPlane;
+
+static uint32_t floor_log2(uint32_t n) {
+    uint32_t s = 0;
+    while (n > 1u) {
+        n >>= 1;
+        s++;
+    }
+    return s;
+}
+
+static int32_t constrain(int32_t diff, int32_t threshold, int32_t damping) {
+    if (!threshold) {
+        return 0;
+    }
+    int32_t adj = damping - (int32_t)floor_log2((uint32_t)threshold);
+    adj = adj < 0 ? 0 : adj;
+    const int32_t a = diff < 0 ? -diff : diff;
+    int32_t v = threshold - (a >> adj);
+    v = v < 0 ? 0 : (v > a ? a : v);
+    return diff < 0 ? -v : v;
+}
+
+static void ref_direction(const RefPlane *cur, uint32_t r, uint32_t c, uint32_t bit_depth, uint32_t *y_dir, int32_t *var) {
+    static const int32_t kDiv[9] = {0, 840, 420, 280, 210, 168, 140, 120, 105};
+    int32_t cost[8] = {0}, partial[8][15] = {{0}};
+    const int32_t x0 = (int32_t)c << 2, y0 = (int32_t)r << 2;
+    for (int32_t i = 0; i < 8; i++) {
+        for (int32_t j = 0; j < 8; j++) {
+            const int32_t x = (cur->px[(y0 + i) * (int32_t)cur->w + x0 + j] >> (bit_depth - 8u)) - 128;
+            partial[0][i + j] += x;
+            partial[1][i + j / 2] += x;
+            partial[2][i] += x;
+            partial[3][3 + i - j / 2] += x;
+            partial[4][7 + i - j] += x;
+            partial[5][3 - i / 2 + j] += x;
+            partial[6][j] += x;
+            partial[7][i / 2 + j] += x;
+        }
+    }
+    for (int32_t i = 0; i < 8; i++) {
+        cost[2] += partial[2][i] * partial[2][i];
+        cost[6] += partial[6][i] * partial[6][i];
+    }
+    cost[2] *= kDiv[8];
+    cost[6] *= kDiv[8];
+    for (int32_t i = 0; i < 7; i++) {
+        cost[0] += (partial[0][i] * partial[0][i] + partial[0][14 - i] * partial[0][14 - i]) * kDiv[i + 1];
+        cost[4] += (partial[4][i] * partial[4][i] + partial[4][14 - i] * partial[4][14 - i]) * kDiv[i + 1];
+    }
+    cost[0] += partial[0][7] * partial[0][7] * kDiv[8];
+    cost[4] += partial[4][7] * partial[4][7] * kDiv[8];
+    for (int32_t i = 1; i < 8; i += 2) {
+        for (int32_t j = 0; j < 5; j++) {
+            cost[i] += partial[i][3 + j] * partial[i][3 + j];
+        }
+        cost[i] *= kDiv[8];
+        for (int32_t j = 0; j < 3; j++) {
+            cost[i] += (partial[i][j] * partial[i][j] + partial[i][10 - j] * partial[i][10 - j]) * kDiv[2 * j + 2];
+        }
+    }
+    int32_t best = 0;
+    *y_dir = 0;
+    for (uint32_t d = 0; d < 8; d++) {
+        if (cost[d] > best) {
+            best = cost[d];
+            *y_dir = d;
+        }
+    }
+    *var = (best - cost[(*y_dir + 4u) & 7u]) >> 10;
+}
+
+static void ref_filter(Av1FrameBuf *fb,
+                       const RefPlane *cur,
+                       uint32_t plane,
+                       uint32_t r,
+                       uint32_t c,
+                       int32_t pri,
+                       int32_t sec,
+                       int32_t damping,
+                       uint32_t dir,
+                       uint32_t mi_rows,
+                       uint32_t mi_cols) {
+    static const int32_t kDirs[8][2][2] = {
+        {{-1, 1}, {-2, 2}}, {{0, 1}, {-1, 2}}, {{0, 1}, {0, 2}}, {{0, 1}, {1, 2}},
+        {{1, 1}, {2, 2}},   {{1, 0}, {2, 1}},  {{1, 0}, {2, 0}}, {{1, 0}, {2, -1}},
+    };
+    static const int32_t kPri[2][2] = {{4, 2}, {3, 3}};
+    static const int32_t kSec[2] = {2, 1};
+    const uint32_t sx = plane && (fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422);
+    const uint32_t sy = plane && fb->layout == AV1_LAYOUT_I420;
+    const uint32_t coeff_shift = fb->bit_depth - 8u;
+    const int32_t x0 = (int32_t)((c * 4u) >> sx), y0 = (int32_t)((r * 4u) >> sy);
+    const int32_t w = 8 >> sx, h = 8 >> sy;
+    for (int32_t i = 0; i < h; i++) {
+        for (int32_t j = 0; j < w; j++) {
+            const int32_t x = cur->px[(y0 + i) * (int32_t)cur->w + x0 + j];
+            int32_t sum = 0, max = x, min = x;
+            for (int32_t k = 0; k < 2; k++) {
+                for (int32_t sign = -1; sign <= 1; sign += 2) {
+                    for (int32_t t = 0; t < 3; t++) {
+                        const uint32_t d = t == 0 ? dir : (dir + (t == 1 ? 6u : 2u)) & 7u;
+                        const int32_t yy = y0 + i + sign * kDirs[d][k][0];
+                        const int32_t xx = x0 + j + sign * kDirs[d][k][1];
+                        if (yy < 0 || xx < 0 || ((yy << sy) >> 2) >= (int32_t)mi_rows || ((xx << sx) >> 2) >= (int32_t)mi_cols) {
+                            continue;
+                        }
+                        const int32_t p = cur->px[yy * (int32_t)cur->w + xx];
+                        if (t == 0) {
+                            sum += kPri[(pri >> coeff_shift) & 1][k] * constrain(p - x, pri, damping);
+                        } else {
+                            sum += kSec[k] * constrain(p - x, sec, damping);
+                        }
+                        max = p > max ? p : max;
+                        min = p < min ? p : min;
+                    }
+                }
+            }
+            int32_t y = x + ((8 + sum - (sum < 0)) >> 4);
+            y = y < min ? min : (y > max ? max : y);
+            const ptrdiff_t off = (ptrdiff_t)(y0 + i) * fb->stride[plane] + x0 + j;
+            if (fb->bytes_per_sample == 1) {
+                av1_frame_plane_8(fb, plane)[off] = (uint8_t)y;
+            } else {
+                av1_frame_plane_16(fb, plane)[off] = (uint16_t)y;
+            }
+        }
+    }
+}
+
+static void reference_cdef(Av1FrameBuf *fb,
+                           const uint8_t *skip,
+                           const int8_t *idx,
+                           uint32_t mi_rows,
+                           uint32_t mi_cols,
+                           const Av1CdefParams *prm) {
+    const uint32_t sx = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+    const uint32_t sy = fb->layout == AV1_LAYOUT_I420;
+    RefPlane cur[3];
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        cur[p].w = (mi_cols * 4u) >> (p ? sx : 0u);
+        cur[p].h = (mi_rows * 4u) >> (p ? sy : 0u);
+        cur[p].px = malloc((size_t)cur[p].w * cur[p].h * sizeof(int32_t));
+        for (uint32_t y = 0; y < cur[p].h; y++) {
+            for (uint32_t x = 0; x < cur[p].w; x++) {
+                const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+                cur[p].px[y * cur[p].w + x] =
+                    fb->bytes_per_sample == 1 ? av1_frame_plane_8(fb, p)[off] : av1_frame_plane_16(fb, p)[off];
+            }
+        }
+    }
+    static const uint32_t kUvDir[2][2][8] = {
+        {{0, 1, 2, 3, 4, 5, 6, 7}, {1, 2, 2, 2, 3, 4, 6, 0}},
+        {{7, 0, 2, 4, 5, 6, 6, 6}, {0, 1, 2, 3, 4, 5, 6, 7}},
+    };
+    const uint32_t coeff_shift = fb->bit_depth - 8u;
+    const uint32_t cols64 = (mi_cols + 15u) >> 4;
+    for (uint32_t r = 0; r < mi_rows; r += 2) {
+        for (uint32_t c = 0; c < mi_cols; c += 2) {
+            const int32_t id = idx[(r >> 4) * cols64 + (c >> 4)];
+            if (id < 0) {
+                continue;
+            }
+            if (skip[r * mi_cols + c] && skip[(r + 1) * mi_cols + c] && skip[r * mi_cols + c + 1] &&
+                skip[(r + 1) * mi_cols + c + 1]) {
+                continue;
+            }
+            uint32_t y_dir;
+            int32_t var;
+            ref_direction(&cur[0], r, c, fb->bit_depth, &y_dir, &var);
+            int32_t pri = prm->y_pri[id] << coeff_shift;
+            const int32_t sec = prm->y_sec[id] << coeff_shift;
+            const uint32_t dir = pri == 0 ? 0u : y_dir;
+            const int32_t var_str = (var >> 6) ? (int32_t)(floor_log2((uint32_t)(var >> 6)) > 12u ? 12u : floor_log2((uint32_t)(var >> 6))) : 0;
+            pri = var ? (pri * (4 + var_str) + 8) >> 4 : 0;
+            const int32_t damping = (int32_t)(prm->damping + coeff_shift);
+            ref_filter(fb, &cur[0], 0, r, c, pri, sec, damping, dir, mi_rows, mi_cols);
+            if (fb->num_planes > 1) {
+                const int32_t uv_pri = prm->uv_pri[id] << coeff_shift;
+                const int32_t uv_sec = prm->uv_sec[id] << coeff_shift;
+                const uint32_t uv_dir = uv_pri == 0 ? 0u : kUvDir[sx][sy][y_dir];
+                for (uint32_t p = 1; p < 3; p++) {
+                    ref_filter(fb, &cur[p], p, r, c, uv_pri, uv_sec, damping - 1, uv_dir, mi_rows, mi_cols);
+                }
+            }
+        }
+    }
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        free(cur[p].px);
+    }
+}
+
+static void fill_frame(Av1FrameBuf *fb) {
+    const uint32_t max = (1u << fb->bit_depth) - 1u;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t bh = fb->plane_h[p] + 2u * fb->border_y[p];
+        const uint32_t bw = fb->plane_w[p] + 2u * fb->border_x[p];
+        const uint32_t noise = max >> 4;
+        for (uint32_t y = 0; y < bh; y++) {
+            for (uint32_t x = 0; x < bw; x++) {
+                // Diagonal ramps plus noise.
+                const uint32_t v = ((x + 2u * y) * (max >> 5) + (uint32_t)(rand() % (int)(noise + 1u))) % (max + 1u);
+                const ptrdiff_t off = ((ptrdiff_t)y - (ptrdiff_t)fb->border_y[p]) * fb->stride[p] + (ptrdiff_t)x - (ptrdiff_t)fb->border_x[p];
+                if (fb->bytes_per_sample == 1) {
+                    av1_frame_plane_8(fb, p)[off] = (uint8_t)v;
+                } else {
+                    av1_frame_plane_16(fb, p)[off] = (uint16_t)v;
+                }
+            }
+        }
+    }
+}
+
+// Compares the MI area (which reaches into the right / bottom border).
+static bool planes_equal(const Av1FrameBuf *a, const Av1FrameBuf *b, uint32_t mi_rows, uint32_t mi_cols) {
+    const uint32_t sx = a->layout == AV1_LAYOUT_I420 || a->layout == AV1_LAYOUT_I422;
+    const uint32_t sy = a->layout == AV1_LAYOUT_I420;
+    for (uint32_t p = 0; p < a->num_planes; p++) {
+        const uint32_t w = (mi_cols * 4u) >> (p ? sx : 0u), h = (mi_rows * 4u) >> (p ? sy : 0u);
+        const size_t row = (size_t)w * a->bytes_per_sample;
+        for (uint32_t y = 0; y < h; y++) {
+            const size_t off = (size_t)y * (size_t)a->stride[p] * a->bytes_per_sample;
+            if (memcmp((const uint8_t *)a->plane[p] + off, (const uint8_t *)b->plane[p] + off, row) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void random_params(Av1CdefParams *p) {
+    av1_cdef_params_default(p);
+    p->damping = (uint8_t)(3 + rand() % 4);
+    p->bits = 2;
+    for (uint32_t i = 0; i < 4; i++) {
+        p->y_pri[i] = (uint8_t)(rand() % 16);
+        p->y_sec[i] = (uint8_t)kSecStrengths[rand() % 4];
+        p->uv_pri[i] = (uint8_t)(rand() % 16);
+        p->uv_sec[i] = (uint8_t)kSecStrengths[rand() % 4];
+    }
+    // idx 1: luma only, idx 2: chroma only, idx 3: nothing.
+    p->uv_pri[1] = p->uv_sec[1] = 0;
+    p->y_pri[2] = p->y_sec[2] = 0;
+    p->y_pri[3] = p->y_sec[3] = p->uv_pri[3] = p->uv_sec[3] = 0;
+}
+
+static int test_frame(void) {
+    static const uint32_t kCases[][4] = {
+        // width, height, layout, bit depth
+        {64, 64, AV1_LAYOUT_I420, 8},
+        {150, 140, AV1_LAYOUT_I420, 8},
+        {133, 70, AV1_LAYOUT_I444, 8},
+        {100, 130, AV1_LAYOUT_I422, 8},
+        {90, 75, AV1_LAYOUT_I420, 10},
+        {70, 66, AV1_LAYOUT_I444, 12},
+        {66, 129, AV1_LAYOUT_I400, 8},
+    };
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    char err[256];
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (int iter = 0; iter < 4; iter++) {
+            Av1FrameBuf *a, *b;
+            CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &a, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &b, err, sizeof(err)));
+            srand(2000u + (unsigned)(ci * 16 + (size_t)iter));
+            fill_frame(a);
+            srand(2000u + (unsigned)(ci * 16 + (size_t)iter));
+            fill_frame(b);
+
+            const uint32_t mi_rows = ((kCases[ci][1] + 7u) >> 3) << 1;
+            const uint32_t mi_cols = ((kCases[ci][0] + 7u) >> 3) << 1;
+            const uint32_t rows64 = (mi_rows + 15u) >> 4, cols64 = (mi_cols + 15u) >> 4;
+            uint8_t *skip = malloc((size_t)mi_rows * mi_cols);
+            int8_t *idx = malloc((size_t)rows64 * cols64);
+            CHECK(skip != NULL && idx != NULL);
+            for (uint32_t i = 0; i < mi_rows * mi_cols; i++) {
+                skip[i] = (uint8_t)(rand() % 4 != 0 && iter != 0);
+            }
+            for (uint32_t i = 0; i < rows64 * cols64; i++) {
+                idx[i] = (int8_t)(iter == 0 ? 0 : rand() % 5 - 1);
+            }
+            Av1CdefParams p;
+            random_params(&p);
+            if (iter == 0) {
+                p.y_pri[0] = 15;
+                p.y_sec[0] = 4;
+                p.uv_pri[0] = 7;
+                p.uv_sec[0] = 2;
+            }
+
+            Av1Cdef cdef;
+            CHECK(av1_cdef_init(&cdef, a, skip, mi_cols, idx, cols64, mi_rows, mi_cols, &p, err, sizeof(err)));
+            if (iter & 1) {
+                av1_cdef_filter_frame(&cdef);
+            } else {
+                // Stripes in reverse order: the line buffers keep them independent.
+                for (uint32_t r = 1; r < cdef.num_rows; r++) {
+                    av1_cdef_save_lines(&cdef, r);
+                }
+                for (uint32_t r = cdef.num_rows; r-- > 0;) {
+                    av1_cdef_filter_row(&cdef, r);
+                }
+            }
+            av1_cdef_free(&cdef);
+            reference_cdef(b, skip, idx, mi_rows, mi_cols, &p);
+            CHECK(planes_equal(a, b, mi_rows, mi_cols));
+
+            free(skip);
+            free(idx);
+            av1_frame_pool_put(&pool, a);
+            av1_frame_pool_put(&pool, b);
+        }
+    }
+
+    // Borders narrower than the MI overhang are rejected, as are out-of-range damping values.
+    Av1FramePool narrow;
+    av1_frame_pool_init(&narrow, 4, 0);
+    Av1FrameBuf *fb;
+    CHECK(av1_frame_pool_get(&narrow, 16, 16, AV1_LAYOUT_I420, 8, &fb, err, sizeof(err)));
+    uint8_t skip[16];
+    int8_t idx[1] = {0};
+    memset(skip, 0, sizeof(skip));
+    Av1CdefParams p;
+    av1_cdef_params_default(&p);
+    Av1Cdef cdef;
+    CHECK(!av1_cdef_init(&cdef, fb, skip, 4, idx, 1, 4, 4, &p, err, sizeof(err)));
+    av1_frame_pool_put(&narrow, fb);
+    av1_frame_pool_free(&narrow);
+    CHECK(av1_frame_pool_get(&pool, 16, 16, AV1_LAYOUT_I420, 8, &fb, err, sizeof(err)));
+    CHECK(av1_cdef_init(&cdef, fb, skip, 4, idx, 1, 4, 4, &p, err, sizeof(err)));
+    av1_cdef_free(&cdef);
+    p.damping = 7;
+    CHECK(!av1_cdef_init(&cdef, fb, skip, 4, idx, 1, 4, 4, &p, err, sizeof(err)));
+    av1_frame_pool_put(&pool, fb);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_direction();
+    rc |= test_kernels();
+    rc |= test_frame();
+    if (rc == 0) {
+        printf("cdef tests: ok\n");
+    }
+    return rc;
+}
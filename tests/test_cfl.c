@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_cfl.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t g_rng = 0x2545F491u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+#define LUMA_STRIDE 80
+
+// Spec 7.11.5 written out literally (MaxLumaW / MaxLumaH relative to the block origin).
+static void cfl_spec(uint8_t *dst,
+                     ptrdiff_t stride,
+                     const uint8_t *luma,
+                     uint32_t sub_x,
+                     uint32_t sub_y,
+                     uint32_t log2w,
+                     uint32_t log2h,
+                     uint32_t max_luma_w,
+                     uint32_t max_luma_h,
+                     int32_t alpha) {
+    const uint32_t w = 1u << log2w;
+    const uint32_t h = 1u << log2h;
+    int32_t L[32][32];
+    int32_t luma_avg = 0;
+    for (uint32_t i = 0; i < h; i++) {
+        uint32_t luma_y = i << sub_y;
+        luma_y = luma_y < max_luma_h - (1u << sub_y) ? luma_y : max_luma_h - (1u << sub_y);
+        for (uint32_t j = 0; j < w; j++) {
+            uint32_t luma_x = j << sub_x;
+            luma_x = luma_x < max_luma_w - (1u << sub_x) ? luma_x : max_luma_w - (1u << sub_x);
+            int32_t t = 0;
+            for (uint32_t dy = 0; dy <= sub_y; dy++) {
+                for (uint32_t dx = 0; dx <= sub_x; dx++) {
+                    t += luma[(luma_y + dy) * LUMA_STRIDE + luma_x + dx];
+                }
+            }
+            L[i][j] = t << (3 - sub_x - sub_y);
+            luma_avg += L[i][j];
+        }
+    }
+    luma_avg = (luma_avg + (1 << (log2w + log2h - 1u))) >> (log2w + log2h);
+    for (uint32_t i = 0; i < h; i++) {
+        for (uint32_t j = 0; j < w; j++) {
+            const int32_t x = alpha * (L[i][j] - luma_avg);
+            const int32_t scaled = x >= 0 ? (x + 32) >> 6 : -((-x + 32) >> 6);
+            const int32_t v = dst[i * stride + j] + scaled;
+            dst[i * stride + j] = (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+}
+
+static int test_flat_luma_keeps_dc(void) {
+    Av1CflDsp dsp;
+    av1_cfl_dsp_init(&dsp);
+    static uint8_t luma[64 * LUMA_STRIDE];
+    memset(luma, 100, sizeof(luma));
+    int16_t ac[AV1_CFL_AC_LEN];
+    uint8_t dst[8 * 8];
+    char err[256];
+    memset(dst, 77, sizeof(dst));
+    CHECK(av1_cfl_build_ac(&dsp, ac, luma, LUMA_STRIDE, 1, 1, 3, 3, 16, 16, err, sizeof(err)));
+    for (int k = 0; k < 64; k++) {
+        CHECK(ac[k] == 0);
+    }
+    CHECK(av1_cfl_predict(&dsp, dst, 8, ac, -16, 3, 3, err, sizeof(err)));
+    CHECK(dst[0] == 77 && dst[63] == 77);
+    return 0;
+}
+
+static int test_kat_420(void) {
+    // 4x4 chroma, left luma half 0 and right half 64: L = 0 / 512, lumaAvg = 256, AC = -/+256.
+    // alpha = 3: Round2Signed( 768, 6 ) = 12.
+    Av1CflDsp dsp;
+    av1_cfl_dsp_init_c(&dsp);
+    static uint8_t luma[8 * LUMA_STRIDE];
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            luma[y * LUMA_STRIDE + x] = x < 4 ? 0 : 64;
+        }
+    }
+    int16_t ac[AV1_CFL_AC_LEN];
+    uint8_t dst[4 * 4];
+    char err[256];
+    memset(dst, 128, sizeof(dst));
+    CHECK(av1_cfl_build_ac(&dsp, ac, luma, LUMA_STRIDE, 1, 1, 2, 2, 8, 8, err, sizeof(err)));
+    CHECK(ac[0] == -256 && ac[3] == 256);
+    CHECK(av1_cfl_predict(&dsp, dst, 4, ac, 3, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 116 && dst[1] == 116 && dst[2] == 140 && dst[15] == 140);
+
+    // Out-of-range inputs are rejected.
+    CHECK(!av1_cfl_predict(&dsp, dst, 4, ac, 17, 2, 2, err, sizeof(err)));
+    CHECK(!av1_cfl_build_ac(&dsp, ac, luma, LUMA_STRIDE, 1, 1, 2, 6, 8, 8, err, sizeof(err)));
+    CHECK(!av1_cfl_build_ac(&dsp, ac, luma, LUMA_STRIDE, 0, 1, 2, 2, 8, 8, err, sizeof(err)));
+    return 0;
+}
+
+// Every allowed size and layout, random luma / DC / alpha, with and without MaxLumaW / MaxLumaH
+// clamping, against the literal spec; both the scalar and the AVX2 table.
+static int test_matches_spec(void) {
+    static const uint32_t kSub[AV1_CFL_LAYOUTS][2] = {{0, 0}, {1, 0}, {1, 1}};
+    static uint8_t luma[64 * LUMA_STRIDE];
+    Av1CflDsp tables[2];
+    int ntables = 1;
+    av1_cfl_dsp_init_c(&tables[0]);
+#if defined(AV1_CFL_HAVE_X86)
+    av1_cfl_dsp_init_c(&tables[1]);
+    if (av1_cfl_dsp_init_avx2(&tables[1])) {
+        ntables = 2;
+    } else {
+        printf("cfl: AVX2 not available, checking the reference only\n");
+    }
+#endif
+    char err[256];
+    for (uint32_t log2w = 2; log2w <= 5; log2w++) {
+        for (uint32_t log2h = 2; log2h <= 5; log2h++) {
+            if (log2w > log2h + 2u || log2h > log2w + 2u) {
+                continue;
+            }
+            for (uint32_t layout = 0; layout < AV1_CFL_LAYOUTS; layout++) {
+                const uint32_t sub_x = kSub[layout][0];
+                const uint32_t sub_y = kSub[layout][1];
+                const uint32_t lw = (1u << log2w) << sub_x;
+                const uint32_t lh = (1u << log2h) << sub_y;
+                for (uint32_t iter = 0; iter < 6; iter++) {
+                    for (size_t k = 0; k < sizeof(luma); k++) {
+                        luma[k] = (uint8_t)rng_next();
+                    }
+                    // Half the iterations clamp: MaxLumaW / MaxLumaH in 4-sample luma steps.
+                    uint32_t avail_w = lw;
+                    uint32_t avail_h = lh;
+                    if (iter & 1u) {
+                        avail_w = 4u * (1u + rng_next() % (lw / 4u));
+                        avail_h = 4u * (1u + rng_next() % (lh / 4u));
+                    }
+                    const int32_t alpha = (int32_t)(rng_next() % 33u) - 16;
+                    uint8_t dc[32 * 32];
+                    for (size_t k = 0; k < sizeof(dc); k++) {
+                        dc[k] = (uint8_t)rng_next();
+                    }
+                    uint8_t expect[32 * 32];
+                    memcpy(expect, dc, sizeof(dc));
+                    cfl_spec(expect, 32, luma, sub_x, sub_y, log2w, log2h, avail_w, avail_h, alpha);
+                    for (int t = 0; t < ntables; t++) {
+                        int16_t ac[AV1_CFL_AC_LEN];
+                        uint8_t got[32 * 32];
+                        memcpy(got, dc, sizeof(dc));
+                        CHECK(av1_cfl_build_ac(&tables[t], ac, luma, LUMA_STRIDE, sub_x, sub_y, log2w, log2h, avail_w, avail_h,
+                                               err, sizeof(err)));
+                        CHECK(av1_cfl_predict(&tables[t], got, 32, ac, alpha, log2w, log2h, err, sizeof(err)));
+                        CHECK(memcmp(got, expect, sizeof(got)) == 0);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// The uint16_t instantiation at BitDepth 8 reproduces the uint8_t one, with and without clamping.
+static int test_16bit_matches_8bit(void) {
+    static const uint32_t kSub[AV1_CFL_LAYOUTS][2] = {{0, 0}, {1, 0}, {1, 1}};
+    static uint8_t luma8[64 * LUMA_STRIDE];
+    static uint16_t luma16[64 * LUMA_STRIDE];
+    Av1CflDsp dsp8;
+    Av1CflDsp16 dsp16;
+    av1_cfl_dsp_init_c(&dsp8);
+    av1_cfl_dsp_init_c_16(&dsp16, 8);
+    char err[256];
+    for (uint32_t log2w = 2; log2w <= 5; log2w++) {
+        for (uint32_t log2h = 2; log2h <= 5; log2h++) {
+            if (log2w > log2h + 2u || log2h > log2w + 2u) {
+                continue;
+            }
+            for (uint32_t layout = 0; layout < AV1_CFL_LAYOUTS; layout++) {
+                const uint32_t sub_x = kSub[layout][0];
+                const uint32_t sub_y = kSub[layout][1];
+                for (size_t k = 0; k < sizeof(luma8); k++) {
+                    luma8[k] = (uint8_t)rng_next();
+                    luma16[k] = luma8[k];
+                }
+                const uint32_t avail_w = 4u * (1u + rng_next() % (((1u << log2w) << sub_x) / 4u));
+                const uint32_t avail_h = 4u * (1u + rng_next() % (((1u << log2h) << sub_y) / 4u));
+                const int32_t alpha = (int32_t)(rng_next() % 33u) - 16;
+                int16_t ac8[AV1_CFL_AC_LEN];
+                int16_t ac16[AV1_CFL_AC_LEN];
+                uint8_t dst8[32 * 32];
+                uint16_t dst16[32 * 32];
+                for (size_t k = 0; k < sizeof(dst8); k++) {
+                    dst8[k] = (uint8_t)rng_next();
+                    dst16[k] = dst8[k];
+                }
+                CHECK(av1_cfl_build_ac(&dsp8, ac8, luma8, LUMA_STRIDE, sub_x, sub_y, log2w, log2h, avail_w, avail_h, err, sizeof(err)));
+                CHECK(av1_cfl_build_ac_16(&dsp16, ac16, luma16, LUMA_STRIDE, sub_x, sub_y, log2w, log2h, avail_w, avail_h, err,
+                                          sizeof(err)));
+                CHECK(memcmp(ac8, ac16, sizeof(int16_t) << (log2w + log2h)) == 0);
+                CHECK(av1_cfl_predict(&dsp8, dst8, 32, ac8, alpha, log2w, log2h, err, sizeof(err)));
+                CHECK(av1_cfl_predict_16(&dsp16, dst16, 32, ac16, alpha, log2w, log2h, err, sizeof(err)));
+                for (size_t k = 0; k < sizeof(dst8); k++) {
+                    CHECK(dst16[k] == dst8[k]);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_kat_10bit(void) {
+    // 4:4:4 4x4, left half 0 and right half 1023: L = 0 / 8184, lumaAvg = 4092, AC = -/+4092.
+    // alpha = 1: Round2Signed( 4092, 6 ) = 64; DC 1000 clips to 1023 on the right and gives 936 on the left.
+    Av1CflDsp16 dsp;
+    av1_cfl_dsp_init_16(&dsp, 10);
+    static uint16_t luma[4 * LUMA_STRIDE];
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            luma[y * LUMA_STRIDE + x] = x < 2 ? 0 : 1023;
+        }
+    }
+    int16_t ac[AV1_CFL_AC_LEN];
+    uint16_t dst[4 * 4];
+    char err[256];
+    for (int k = 0; k < 16; k++) {
+        dst[k] = 1000;
+    }
+    CHECK(av1_cfl_build_ac_16(&dsp, ac, luma, LUMA_STRIDE, 0, 0, 2, 2, 4, 4, err, sizeof(err)));
+    CHECK(ac[0] == -4092 && ac[3] == 4092);
+    CHECK(av1_cfl_predict_16(&dsp, dst, 4, ac, 1, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 936 && dst[1] == 936 && dst[2] == 1023 && dst[15] == 1023);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_flat_luma_keeps_dc();
+    rc |= test_kat_420();
+    rc |= test_matches_spec();
+    rc |= test_16bit_matches_8bit();
+    rc |= test_kat_10bit();
+    if (rc == 0) {
+        printf("cfl tests: ok\n");
+    }
+    return rc;
+}
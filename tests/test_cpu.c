@@ -0,0 +1,77 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_cpu.h"
+#include "../src/m3b-av1-decode/av1_superres.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static int test_parse(void) {
+    uint32_t m = 0;
+    CHECK(av1_cpu_parse_mask("c", &m) && m == 0u);
+    CHECK(av1_cpu_parse_mask("SSE2", &m) && m == AV1_CPU_SSE2);
+    CHECK(av1_cpu_parse_mask("ssse3", &m) && m == (AV1_CPU_SSE2 | AV1_CPU_SSSE3));
+    CHECK(av1_cpu_parse_mask("sse4.1", &m) && m == (AV1_CPU_SSE2 | AV1_CPU_SSSE3 | AV1_CPU_SSE41));
+    CHECK(av1_cpu_parse_mask("avx2", &m) && m == (AV1_CPU_ALL & ~AV1_CPU_AVX512));
+    CHECK(av1_cpu_parse_mask("AVX512", &m) && m == AV1_CPU_ALL);
+    CHECK(av1_cpu_parse_mask("0x8", &m) && m == AV1_CPU_AVX2);
+    CHECK(av1_cpu_parse_mask("5", &m) && m == (AV1_CPU_SSE2 | AV1_CPU_SSE41));
+    m = 7;
+    CHECK(!av1_cpu_parse_mask("", &m) && m == 7u);
+    CHECK(!av1_cpu_parse_mask("avx", &m));
+    CHECK(!av1_cpu_parse_mask("avx2x", &m));
+    CHECK(!av1_cpu_parse_mask("0x20", &m));
+    CHECK(!av1_cpu_parse_mask("-1", &m));
+    CHECK(!av1_cpu_parse_mask("3z", &m));
+    CHECK(!strcmp(av1_cpu_name(0u), "c"));
+    CHECK(!strcmp(av1_cpu_name(AV1_CPU_SSE2 | AV1_CPU_SSSE3), "ssse3"));
+    CHECK(!strcmp(av1_cpu_name(AV1_CPU_SSE2 | AV1_CPU_AVX2), "avx2"));
+    CHECK(!strcmp(av1_cpu_name(AV1_CPU_ALL), "avx512"));
+    return 0;
+}
+
+// AV1_CPU_MASK seeds the mask on the first query; av1_cpu_set_mask() replaces it, and dsp tables
+// built afterwards follow it.
+static int test_mask(void) {
+    const uint32_t detected = av1_cpu_detect();
+    CHECK((detected & ~AV1_CPU_ALL) == 0u);
+    CHECK(setenv("AV1_CPU_MASK", "sse2", 1) == 0);
+    CHECK(av1_cpu_flags() == (detected & AV1_CPU_SSE2));
+    CHECK(setenv("AV1_CPU_MASK", "avx2", 1) == 0);
+    CHECK(av1_cpu_flags() == (detected & AV1_CPU_SSE2)); // resolved once
+
+    Av1SuperresDsp c, dsp;
+    av1_superres_dsp_init_c(&c);
+    av1_cpu_set_mask(0u);
+    CHECK(av1_cpu_flags() == 0u);
+    av1_superres_dsp_init(&dsp);
+    CHECK(dsp.upscale == c.upscale);
+    av1_cpu_set_mask(AV1_CPU_ALL & ~AV1_CPU_AVX2);
+    CHECK(av1_cpu_flags() == (detected & ~AV1_CPU_AVX2));
+    av1_superres_dsp_init(&dsp);
+    CHECK(dsp.upscale == c.upscale);
+    av1_cpu_set_mask(AV1_CPU_ALL);
+    CHECK(av1_cpu_flags() == detected);
+    av1_superres_dsp_init(&dsp);
+    CHECK((dsp.upscale != c.upscale) == ((detected & AV1_CPU_AVX2) != 0u));
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_parse();
+    rc |= test_mask();
+    if (rc == 0) {
+        printf("cpu tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_dequant.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static int test_tables(void) {
+    // Spot values of Dc_Qlookup / Ac_Qlookup (spec 7.12.2).
+    CHECK(av1_dc_q(8, 0) == 4 && av1_dc_q(8, 255) == 1336);
+    CHECK(av1_ac_q(8, 0) == 4 && av1_ac_q(8, 255) == 1828);
+    CHECK(av1_dc_q(10, 0) == 4 && av1_dc_q(10, 255) == 5347);
+    CHECK(av1_ac_q(10, 255) == 7312);
+    CHECK(av1_dc_q(12, 255) == 21387 && av1_ac_q(12, 255) == 29247);
+    // The index is clipped to 0..255.
+    CHECK(av1_dc_q(8, -20) == av1_dc_q(8, 0) && av1_ac_q(10, 300) == av1_ac_q(10, 255));
+    for (int32_t b = 1; b < 256; b++) {
+        CHECK(av1_ac_q(8, b) >= av1_ac_q(8, b - 1) && av1_dc_q(12, b) >= av1_dc_q(12, b - 1));
+    }
+    return 0;
+}
+
+static int test_coeff(void) {
+    CHECK(av1_dequant_denom_shift(2, 2) == 0 && av1_dequant_denom_shift(4, 4) == 0);
+    CHECK(av1_dequant_denom_shift(5, 4) == 1 && av1_dequant_denom_shift(5, 5) == 1 && av1_dequant_denom_shift(6, 4) == 1);
+    CHECK(av1_dequant_denom_shift(6, 5) == 2 && av1_dequant_denom_shift(6, 6) == 2);
+
+    CHECK(av1_dequant_coeff(3, 40, 0, 8) == 120 && av1_dequant_coeff(-3, 40, 0, 8) == -120);
+    // The division truncates the magnitude, before the sign is applied.
+    CHECK(av1_dequant_coeff(3, 41, 2, 8) == 30 && av1_dequant_coeff(-3, 41, 2, 8) == -30);
+    // Clip3( -( 1 << ( 7 + BitDepth ) ), ( 1 << ( 7 + BitDepth ) ) - 1, ... ).
+    CHECK(av1_dequant_coeff(1000, 1336, 0, 8) == 32767 && av1_dequant_coeff(-1000, 1336, 0, 8) == -32768);
+    CHECK(av1_dequant_coeff(1000, 1336, 0, 10) == 131071);
+    // Abs( Quant * q ) & 0xFFFFFF: the product wraps at 24 bits.
+    CHECK(av1_dequant_coeff((1 << 20) + 1, 16, 0, 12) == 16);
+    CHECK(av1_dequant_coeff(-((1 << 20) + 1), 16, 0, 12) == -16);
+    return 0;
+}
+
+static int test_lut(void) {
+    const uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS] = {100, 0, 255, 100, 100, 100, 100, 30};
+    Av1DequantLut lut;
+    av1_dequant_lut_init(&lut, 10, seg_qindex, -5, 3, -2, 7, 1);
+    CHECK(lut.seg[0].dc[0] == av1_dc_q(10, 95) && lut.seg[0].ac[0] == av1_ac_q(10, 100));
+    CHECK(lut.seg[0].dc[1] == av1_dc_q(10, 103) && lut.seg[0].ac[1] == av1_ac_q(10, 98));
+    CHECK(lut.seg[0].dc[2] == av1_dc_q(10, 107) && lut.seg[0].ac[2] == av1_ac_q(10, 101));
+    CHECK(lut.seg[1].dc[0] == av1_dc_q(10, 0) && lut.seg[2].dc[2] == av1_dc_q(10, 255));
+    CHECK(lut.seg[7].ac[1] == av1_ac_q(10, 28));
+
+    Av1PlaneQuant pq;
+    av1_dequant_plane_quant(&lut, 0, 100, &pq);
+    CHECK(memcmp(&pq, &lut.seg[0], sizeof(pq)) == 0);
+    CHECK(pq.qm_level[0] == AV1_QM_FLAT && !av1_dequant_qm_weights(&lut, &pq, 0, 0, true));
+    return 0;
+}
+
+static int test_qm(void) {
+    // Spot values and checksums of the full Quantizer_Matrix[ level ][ chroma ] (spec 9.5.3).
+    static const struct {
+        uint32_t level, chroma;
+        uint32_t sum, weighted_sum;
+    } kSums[] = {{0, 0, 328401, 559712067u}, {5, 1, 189572, 321592893u}, {11, 0, 116150, 195649645u}, {14, 1, 103817, 173858798u}};
+    static const uint8_t kL0Chroma4x4[16] = {35, 46, 57, 66, 46, 60, 69, 71, 57, 69, 90, 90, 66, 71, 90, 109};
+    static const uint8_t kL7Chroma4x16[16] = {31, 37, 49, 54, 31, 38, 47, 51, 32, 40, 45, 49, 34, 42, 45, 49};
+    static uint8_t m[AV1_QM_TOTAL_SIZE];
+    av1_qm_expand(0, 1, m);
+    CHECK(memcmp(m, kL0Chroma4x4, 16) == 0);
+    av1_qm_expand(7, 1, m);
+    CHECK(memcmp(m + av1_qm_offset(13), kL7Chroma4x16, 16) == 0); // TX_4X16
+    for (size_t t = 0; t < sizeof(kSums) / sizeof(kSums[0]); t++) {
+        av1_qm_expand(kSums[t].level, kSums[t].chroma, m);
+        uint32_t sum = 0;
+        uint32_t weighted = 0;
+        for (uint32_t k = 0; k < AV1_QM_TOTAL_SIZE; k++) {
+            sum += m[k];
+            weighted += (k + 1u) * m[k];
+        }
+        CHECK(sum == kSums[t].sum && weighted == kSums[t].weighted_sum);
+    }
+    // 64-point transforms use the 32-point matrices.
+    CHECK(av1_qm_offset(4) == av1_qm_offset(3) && av1_qm_offset(17) == av1_qm_offset(9));
+
+    // SegQMLevel: lossless segments stay flat; qm levels only apply with using_qmatrix.
+    const uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS] = {60, 0, 60, 60, 60, 60, 60, 60};
+    const bool lossless[AV1_DEQUANT_SEGMENTS] = {false, true};
+    static Av1DequantLut lut;
+    av1_dequant_lut_init(&lut, 8, seg_qindex, 0, 0, 0, 0, 0);
+    av1_dequant_lut_set_qm(&lut, 0, 3, 4, 5, lossless);
+    CHECK(!av1_dequant_qm_weights(&lut, &lut.seg[0], 0, 0, true));
+    av1_dequant_lut_set_qm(&lut, 1, 3, 4, 15, lossless);
+    CHECK(lut.seg[0].qm_level[0] == 3 && lut.seg[0].qm_level[1] == 4 && lut.seg[0].qm_level[2] == AV1_QM_FLAT);
+    CHECK(lut.seg[1].qm_level[0] == AV1_QM_FLAT && lut.seg[1].qm_level[1] == AV1_QM_FLAT);
+    av1_qm_expand(4, 1, m);
+    CHECK(av1_dequant_qm_weights(&lut, &lut.seg[0], 1, 7, true) == lut.qm[1] + av1_qm_offset(7));
+    CHECK(memcmp(lut.qm[1], m, AV1_QM_TOTAL_SIZE) == 0);
+    CHECK(!av1_dequant_qm_weights(&lut, &lut.seg[0], 1, 7, false));
+    CHECK(!av1_dequant_qm_weights(&lut, &lut.seg[0], 2, 7, true));
+    return 0;
+}
+
+static int32_t rand_quant(void) {
+    const int r = rand() % 16;
+    int32_t v = r < 8 ? 0 : (r < 14 ? rand() % 16 : rand() % (1 << 20));
+    return rand() & 1 ? -v : v;
+}
+
+static int test_qm_kernels(void) {
+    static uint8_t m[AV1_QM_TOTAL_SIZE];
+    av1_qm_expand(2, 0, m);
+    Av1DequantDsp c;
+    Av1DequantDsp best;
+    av1_dequant_dsp_init_c(&c);
+    av1_dequant_dsp_init(&best);
+    static int32_t quant[32 * 32];
+    static int32_t ref[64 * 64];
+    static int32_t out[64 * 64];
+    srand(7);
+    for (uint32_t tx = 0; tx < 19; tx++) {
+        static const uint8_t kLog2W[19] = {2, 3, 4, 5, 6, 2, 3, 3, 4, 4, 5, 5, 6, 2, 4, 3, 5, 4, 6};
+        static const uint8_t kLog2H[19] = {2, 3, 4, 5, 6, 3, 2, 4, 3, 5, 4, 6, 5, 4, 2, 5, 3, 6, 4};
+        const uint32_t log2tw = kLog2W[tx] > 5 ? 5u : kLog2W[tx];
+        const uint32_t th = 1u << (kLog2H[tx] > 5 ? 5u : kLog2H[tx]);
+        const uint32_t shift = av1_dequant_denom_shift(kLog2W[tx], kLog2H[tx]);
+        for (uint32_t bd = 8; bd <= 12; bd += 2) {
+            for (int iter = 0; iter < 20; iter++) {
+                const uint32_t rows = 1u + (uint32_t)rand() % th;
+                const uint32_t cols = 1u + (uint32_t)rand() % (1u << log2tw);
+                memset(quant, 0, sizeof(quant));
+                for (uint32_t i = 0; i < rows; i++) {
+                    for (uint32_t j = 0; j < cols; j++) {
+                        quant[(i << log2tw) + j] = rand_quant();
+                    }
+                }
+                const int32_t dc_q = av1_dc_q(bd, rand() % 256);
+                const int32_t ac_q = av1_ac_q(bd, rand() % 256);
+                memset(ref, 0, sizeof(ref));
+                memset(out, 0, sizeof(out));
+                c.qm_block(ref, kLog2W[tx], quant, m + av1_qm_offset(tx), log2tw, rows, cols, dc_q, ac_q, shift, bd);
+                best.qm_block(out, kLog2W[tx], quant, m + av1_qm_offset(tx), log2tw, rows, cols, dc_q, ac_q, shift, bd);
+                CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+                // Spec 7.12.3 step b: q2 = Round2( q * Quantizer_Matrix[ ... ], 5 ).
+                const int32_t q2 = (ac_q * m[av1_qm_offset(tx) + (rows - 1u) * (1u << log2tw) + cols - 1u] + 16) >> 5;
+                const int32_t last = quant[((rows - 1u) << log2tw) + cols - 1u];
+                if (rows * cols > 1) {
+                    CHECK(ref[((rows - 1u) << kLog2W[tx]) + cols - 1u] == av1_dequant_coeff(last, q2, shift, bd));
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Lossless segments at qindex 0 take Quant, clipped, in place of Dequant / 4.
+static int test_lossless(void) {
+    const uint32_t seg_qindex[AV1_DEQUANT_SEGMENTS] = {0, 0, 60, 0, 0, 0, 0, 0};
+    const bool lossless[AV1_DEQUANT_SEGMENTS] = {true, false, false, true, true, true, true, true};
+    static Av1DequantLut lut;
+    av1_dequant_lut_init(&lut, 8, seg_qindex, 0, 0, 0, 0, 0);
+    av1_dequant_lut_set_qm(&lut, 0, 0, 0, 0, lossless);
+    Av1PlaneQuant pq;
+    av1_dequant_plane_quant(&lut, 0, 0, &pq);
+    CHECK(pq.lossless && pq.dc[0] == 4 && pq.ac[2] == 4);
+    av1_dequant_plane_quant(&lut, 1, 0, &pq);
+    CHECK(!pq.lossless);
+    av1_dequant_plane_quant(&lut, 3, 12, &pq); // delta_q moved the block off qindex 0
+    CHECK(!pq.lossless);
+
+    for (uint32_t bd = 8; bd <= 12; bd += 2) {
+        const int32_t lim = 1 << (5u + bd);
+        CHECK(av1_dequant_lossless_coeff(lim - 1, bd) == lim - 1 && av1_dequant_lossless_coeff(lim, bd) == lim - 1);
+        CHECK(av1_dequant_lossless_coeff(-lim, bd) == -lim && av1_dequant_lossless_coeff(-lim - 1, bd) == -lim);
+        for (int k = 0; k < 4096; k++) {
+            const int32_t quant = rand() % 4 ? rand_quant() : rand() % (4 * lim) - 2 * lim;
+            const int32_t dq = av1_dequant_coeff(quant, 4, 0, bd);
+            CHECK(av1_dequant_lossless_coeff(quant, bd) == (dq >= 0 ? dq >> 2 : -(-dq >> 2)));
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_tables();
+    rc |= test_coeff();
+    rc |= test_lut();
+    rc |= test_qm();
+    rc |= test_qm_kernels();
+    rc |= test_lossless();
+    if (rc == 0) {
+        printf("dequant tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,519 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_film_grain.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+// AVX2 and scalar blend kernels agree on random blocks and parameters.
+static int test_kernels(void) {
+    Av1FgDsp c, best;
+    av1_fg_dsp_init_c(&c);
+    av1_fg_dsp_init(&best);
+    enum { S = 48 };
+    uint8_t src[32 * S], luma[32 * 2 * S], out_c[32 * S], out_b[32 * S];
+    int16_t noise[32 * 40];
+    uint8_t scaling[AV1_FG_SCALING_SIZE];
+    srand(3);
+    for (int iter = 0; iter < 600; iter++) {
+        for (uint32_t i = 0; i < sizeof(src); i++) {
+            src[i] = (uint8_t)(iter % 5 == 0 ? (rand() % 2 ? 255 : 0) : rand() % 256);
+        }
+        for (uint32_t i = 0; i < sizeof(luma); i++) {
+            luma[i] = (uint8_t)rand();
+        }
+        for (uint32_t i = 0; i < sizeof(noise) / sizeof(noise[0]); i++) {
+            noise[i] = (int16_t)(iter % 7 == 0 ? (rand() % 2 ? 127 : -128) : rand() % 256 - 128);
+        }
+        for (uint32_t i = 0; i < AV1_FG_SCALING_SIZE; i++) {
+            scaling[i] = (uint8_t)(i < 256u ? (iter % 3 == 0 ? 255 : rand() % 256) : 0xA5);
+        }
+        Av1FgPlane pl;
+        memset(&pl, 0, sizeof(pl));
+        pl.scaling = scaling;
+        pl.shift = 8 + rand() % 4;
+        pl.lo = rand() % 2 ? 16 : 0;
+        pl.hi = pl.lo ? (rand() % 2 ? 235 : 240) : 255;
+        pl.sub_x = (uint32_t)(rand() % 2);
+        pl.from_luma = (uint32_t)(rand() % 3 == 0);
+        pl.mult = rand() % 256 - 128;
+        pl.luma_mult = rand() % 256 - 128;
+        pl.offset = rand() % 512 - 256;
+        const uint32_t w = 1u + (uint32_t)rand() % 32u;
+        const uint32_t h = 1u + (uint32_t)rand() % 32u;
+        const ptrdiff_t ns = rand() % 2 ? 32 : 40;
+        memset(out_c, 0x11, sizeof(out_c));
+        memset(out_b, 0x77, sizeof(out_b));
+        c.blend_y(out_c, S, src, S, noise, ns, w, h, &pl);
+        best.blend_y(out_b, S, src, S, noise, ns, w, h, &pl);
+        for (uint32_t y = 0; y < h; y++) {
+            CHECK(memcmp(out_c + y * S, out_b + y * S, w) == 0);
+        }
+        c.blend_uv(out_c, S, src, S, luma, 2 * S, noise, ns, w, h, &pl);
+        best.blend_uv(out_b, S, src, S, luma, 2 * S, noise, ns, w, h, &pl);
+        for (uint32_t y = 0; y < h; y++) {
+            CHECK(memcmp(out_c + y * S, out_b + y * S, w) == 0);
+        }
+    }
+    return 0;
+}
+
+// ---- Spec 7.18.3, transcribed ----
+
+static int32_t clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+static int32_t round2(int32_t x, int32_t n) {
+    return n ? (x + (1 << (n - 1))) >> n : x;
+}
+
+static uint32_t RandomRegister;
+
+static int32_t get_random_number(int32_t bits) {
+    uint32_t r = RandomRegister;
+    const uint32_t bit = ((r >> 0) ^ (r >> 1) ^ (r >> 3) ^ (r >> 12)) & 1u;
+    r = (r >> 1) | (bit << 15);
+    RandomRegister = r;
+    return (int32_t)((r >> (16 - bits)) & ((1u << bits) - 1u));
+}
+
+static int32_t LumaGrain[73][82], CbGrain[38 * 2][82], CrGrain[38 * 2][82];
+static int32_t ScalingLut[3][256];
+
+static int32_t get_x(const Av1FilmGrainParams *pa, int plane, int i) {
+    return plane == 0 || pa->chroma_scaling_from_luma ? pa->point_y_value[i] : plane == 1 ? pa->point_cb_value[i] : pa->point_cr_value[i];
+}
+
+static int32_t get_y(const Av1FilmGrainParams *pa, int plane, int i) {
+    return plane == 0 || pa->chroma_scaling_from_luma ? pa->point_y_scaling[i]
+                                                       : plane == 1 ? pa->point_cb_scaling[i] : pa->point_cr_scaling[i];
+}
+
+static int32_t scale_lut(int plane, int32_t index, int32_t BitDepth) {
+    const int32_t shift = BitDepth - 8;
+    const int32_t x = index >> shift;
+    const int32_t rem = index - (x << shift);
+    if (BitDepth == 8 || x == 255) {
+        return ScalingLut[plane][x];
+    }
+    return ScalingLut[plane][x] + round2((ScalingLut[plane][x + 1] - ScalingLut[plane][x]) * rem, shift);
+}
+
+static int32_t get_sample(const Av1FrameBuf *fb, uint32_t p, int32_t x, int32_t y) {
+    const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+    return fb->bytes_per_sample == 1 ? av1_frame_plane_8(fb, p)[off] : av1_frame_plane_16(fb, p)[off];
+}
+
+static void set_sample(Av1FrameBuf *fb, uint32_t p, int32_t x, int32_t y, int32_t v) {
+    const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+    if (fb->bytes_per_sample == 1) {
+        av1_frame_plane_8(fb, p)[off] = (uint8_t)v;
+    } else {
+        av1_frame_plane_16(fb, p)[off] = (uint16_t)v;
+    }
+}
+
+// Writes the grain-synthesized copy of in to out (same shape).
+static void reference_film_grain(const Av1FilmGrainParams *pa, int mc_identity, const Av1FrameBuf *in, Av1FrameBuf *out) {
+    const int32_t BitDepth = (int32_t)in->bit_depth;
+    const int32_t w = (int32_t)in->width;
+    const int32_t h = (int32_t)in->height;
+    const int32_t subX = in->layout == AV1_LAYOUT_I420 || in->layout == AV1_LAYOUT_I422;
+    const int32_t subY = in->layout == AV1_LAYOUT_I420;
+    const int32_t NumPlanes = (int32_t)in->num_planes;
+    const int32_t GrainCenter = 128 << (BitDepth - 8);
+    const int32_t GrainMin = -GrainCenter;
+    const int32_t GrainMax = (256 << (BitDepth - 8)) - 1 - GrainCenter;
+    const int32_t lag = pa->ar_coeff_lag;
+
+    // Generate grain process.
+    int32_t shift = 12 - BitDepth + pa->grain_scale_shift;
+    RandomRegister = pa->grain_seed;
+    for (int y = 0; y < 73; y++) {
+        for (int x = 0; x < 82; x++) {
+            const int32_t g = pa->num_y_points > 0 ? av1_fg_gaussian_sequence[get_random_number(11)] : 0;
+            LumaGrain[y][x] = round2(g, shift);
+        }
+    }
+    shift = pa->ar_coeff_shift;
+    for (int y = 3; y < 73; y++) {
+        for (int x = 3; x < 82 - 3; x++) {
+            int32_t s = 0;
+            int pos = 0;
+            for (int deltaRow = -lag; deltaRow <= 0; deltaRow++) {
+                for (int deltaCol = -lag; deltaCol <= lag; deltaCol++) {
+                    if (deltaRow == 0 && deltaCol == 0) {
+                        break;
+                    }
+                    s += LumaGrain[y + deltaRow][x + deltaCol] * pa->ar_coeffs_y[pos];
+                    pos++;
+                }
+            }
+            LumaGrain[y][x] = clip3(GrainMin, GrainMax, LumaGrain[y][x] + round2(s, shift));
+        }
+    }
+    if (NumPlanes > 1) {
+        const int chromaW = subX ? 44 : 82;
+        const int chromaH = subY ? 38 : 73;
+        shift = 12 - BitDepth + pa->grain_scale_shift;
+        RandomRegister = pa->grain_seed ^ 0xb524u;
+        for (int y = 0; y < chromaH; y++) {
+            for (int x = 0; x < chromaW; x++) {
+                const int32_t g = pa->num_cb_points > 0 || pa->chroma_scaling_from_luma ? av1_fg_gaussian_sequence[get_random_number(11)] : 0;
+                CbGrain[y][x] = round2(g, shift);
+            }
+        }
+        RandomRegister = pa->grain_seed ^ 0x49d8u;
+        for (int y = 0; y < chromaH; y++) {
+            for (int x = 0; x < chromaW; x++) {
+                const int32_t g = pa->num_cr_points > 0 || pa->chroma_scaling_from_luma ? av1_fg_gaussian_sequence[get_random_number(11)] : 0;
+                CrGrain[y][x] = round2(g, shift);
+            }
+        }
+        shift = pa->ar_coeff_shift;
+        for (int y = 3; y < chromaH; y++) {
+            for (int x = 3; x < chromaW - 3; x++) {
+                int32_t s0 = 0, s1 = 0;
+                int pos = 0;
+                for (int deltaRow = -lag; deltaRow <= 0; deltaRow++) {
+                    for (int deltaCol = -lag; deltaCol <= lag; deltaCol++) {
+                        const int32_t c0 = pa->ar_coeffs_cb[pos];
+                        const int32_t c1 = pa->ar_coeffs_cr[pos];
+                        if (deltaRow == 0 && deltaCol == 0) {
+                            if (pa->num_y_points > 0) {
+                                int32_t luma = 0;
+                                const int lumaX = ((x - 3) << subX) + 3;
+                                const int lumaY = ((y - 3) << subY) + 3;
+                                for (int i = 0; i <= subY; i++) {
+                                    for (int j = 0; j <= subX; j++) {
+                                        luma += LumaGrain[lumaY + i][lumaX + j];
+                                    }
+                                }
+                                luma = round2(luma, subX + subY);
+                                s0 += luma * c0;
+                                s1 += luma * c1;
+                            }
+                            break;
+                        }
+                        s0 += CbGrain[y + deltaRow][x + deltaCol] * c0;
+                        s1 += CrGrain[y + deltaRow][x + deltaCol] * c1;
+                        pos++;
+                    }
+                }
+                CbGrain[y][x] = clip3(GrainMin, GrainMax, CbGrain[y][x] + round2(s0, shift));
+                CrGrain[y][x] = clip3(GrainMin, GrainMax, CrGrain[y][x] + round2(s1, shift));
+            }
+        }
+    }
+
+    // Scaling lookup initialization process.
+    for (int plane = 0; plane < NumPlanes; plane++) {
+        const int numPoints = plane == 0 || pa->chroma_scaling_from_luma ? pa->num_y_points : plane == 1 ? pa->num_cb_points : pa->num_cr_points;
+        if (numPoints == 0) {
+            for (int x = 0; x < 256; x++) {
+                ScalingLut[plane][x] = 0;
+            }
+            continue;
+        }
+        for (int x = 0; x < get_x(pa, plane, 0); x++) {
+            ScalingLut[plane][x] = get_y(pa, plane, 0);
+        }
+        for (int i = 0; i < numPoints - 1; i++) {
+            const int32_t deltaY = get_y(pa, plane, i + 1) - get_y(pa, plane, i);
+            const int32_t deltaX = get_x(pa, plane, i + 1) - get_x(pa, plane, i);
+            const int32_t delta = deltaY * ((65536 + (deltaX >> 1)) / deltaX);
+            for (int x = 0; x < deltaX; x++) {
+                ScalingLut[plane][get_x(pa, plane, i) + x] = get_y(pa, plane, i) + ((x * delta + 32768) >> 16);
+            }
+        }
+        for (int x = get_x(pa, plane, numPoints - 1); x < 256; x++) {
+            ScalingLut[plane][x] = get_y(pa, plane, numPoints - 1);
+        }
+    }
+
+    // Add noise synthesis process: noiseStripe[ lumaNum ][ plane ][ 34 ][ sw ].
+    const int stripes = ((h + 1) / 2 + 15) / 16;
+    const int sw = w + 34;
+    int32_t *noiseStripe = calloc((size_t)stripes * 3 * 34 * (size_t)sw, sizeof(int32_t));
+    int32_t *noiseImage = calloc((size_t)3 * (size_t)h * (size_t)w, sizeof(int32_t));
+#define STRIPE(n, p, i, x) noiseStripe[(((size_t)(n) * 3 + (size_t)(p)) * 34 + (size_t)(i)) * (size_t)sw + (size_t)(x)]
+#define IMAGE(p, y, x) noiseImage[((size_t)(p) * (size_t)h + (size_t)(y)) * (size_t)w + (size_t)(x)]
+    int lumaNum = 0;
+    for (int y = 0; y < (h + 1) / 2; y += 16) {
+        RandomRegister = pa->grain_seed;
+        RandomRegister ^= (uint32_t)((lumaNum * 37 + 178) & 255) << 8;
+        RandomRegister ^= (uint32_t)((lumaNum * 173 + 105) & 255);
+        for (int x = 0; x < (w + 1) / 2; x += 16) {
+            const int32_t rand = get_random_number(8);
+            const int32_t offsetX = rand >> 4;
+            const int32_t offsetY = rand & 15;
+            for (int plane = 0; plane < NumPlanes; plane++) {
+                const int planeSubX = plane > 0 ? subX : 0;
+                const int planeSubY = plane > 0 ? subY : 0;
+                const int planeOffsetX = planeSubX ? 6 + offsetX : 9 + offsetX * 2;
+                const int planeOffsetY = planeSubY ? 6 + offsetY : 9 + offsetY * 2;
+                for (int i = 0; i < 34 >> planeSubY; i++) {
+                    for (int j = 0; j < 34 >> planeSubX; j++) {
+                        int32_t g = plane == 0   ? LumaGrain[planeOffsetY + i][planeOffsetX + j]
+                                    : plane == 1 ? CbGrain[planeOffsetY + i][planeOffsetX + j]
+                                                 : CrGrain[planeOffsetY + i][planeOffsetX + j];
+                        if (planeSubX == 0) {
+                            if (j < 2 && pa->overlap_flag && x > 0) {
+                                const int32_t old = STRIPE(lumaNum, plane, i, x * 2 + j);
+                                g = j == 0 ? old * 27 + g * 17 : old * 17 + g * 27;
+                                g = clip3(GrainMin, GrainMax, round2(g, 5));
+                            }
+                            STRIPE(lumaNum, plane, i, x * 2 + j) = g;
+                        } else {
+                            if (j == 0 && pa->overlap_flag && x > 0) {
+                                const int32_t old = STRIPE(lumaNum, plane, i, x + j);
+                                g = old * 23 + g * 22;
+                                g = clip3(GrainMin, GrainMax, round2(g, 5));
+                            }
+                            STRIPE(lumaNum, plane, i, x + j) = g;
+                        }
+                    }
+                }
+            }
+        }
+        lumaNum++;
+    }
+    for (int plane = 0; plane < NumPlanes; plane++) {
+        const int planeSubX = plane > 0 ? subX : 0;
+        const int planeSubY = plane > 0 ? subY : 0;
+        for (int y = 0; y < ((h + planeSubY) >> planeSubY); y++) {
+            lumaNum = y >> (5 - planeSubY);
+            const int i = y - (lumaNum << (5 - planeSubY));
+            for (int x = 0; x < ((w + planeSubX) >> planeSubX); x++) {
+                int32_t g = STRIPE(lumaNum, plane, i, x);
+                if (planeSubY == 0) {
+                    if (i < 2 && lumaNum > 0 && pa->overlap_flag) {
+                        const int32_t old = STRIPE(lumaNum - 1, plane, i + 32, x);
+                        g = i == 0 ? old * 27 + g * 17 : old * 17 + g * 27;
+                        g = clip3(GrainMin, GrainMax, round2(g, 5));
+                    }
+                } else if (i < 1 && lumaNum > 0 && pa->overlap_flag) {
+                    const int32_t old = STRIPE(lumaNum - 1, plane, i + 16, x);
+                    g = old * 23 + g * 22;
+                    g = clip3(GrainMin, GrainMax, round2(g, 5));
+                }
+                IMAGE(plane, y, x) = g;
+            }
+        }
+    }
+
+    int32_t minValue = 0, maxLuma = (256 << (BitDepth - 8)) - 1, maxChroma = maxLuma;
+    if (pa->clip_to_restricted_range) {
+        minValue = 16 << (BitDepth - 8);
+        maxLuma = 235 << (BitDepth - 8);
+        maxChroma = mc_identity ? maxLuma : 240 << (BitDepth - 8);
+    }
+    const int32_t ScalingShift = pa->grain_scaling;
+    for (uint32_t p = 0; p < in->num_planes; p++) {
+        for (uint32_t y = 0; y < in->plane_h[p]; y++) {
+            for (uint32_t x = 0; x < in->plane_w[p]; x++) {
+                set_sample(out, p, (int32_t)x, (int32_t)y, get_sample(in, p, (int32_t)x, (int32_t)y));
+            }
+        }
+    }
+    for (int y = 0; NumPlanes > 1 && y < ((h + subY) >> subY); y++) {
+        for (int x = 0; x < ((w + subX) >> subX); x++) {
+            const int lumaX = x << subX;
+            const int lumaY = y << subY;
+            const int lumaNextX = lumaX + 1 < w - 1 ? lumaX + 1 : w - 1;
+            const int32_t averageLuma = subX ? round2(get_sample(in, 0, lumaX, lumaY) + get_sample(in, 0, lumaNextX, lumaY), 1)
+                                             : get_sample(in, 0, lumaX, lumaY);
+            for (int plane = 1; plane < 3; plane++) {
+                const int points = plane == 1 ? pa->num_cb_points : pa->num_cr_points;
+                if (points == 0 && !pa->chroma_scaling_from_luma) {
+                    continue;
+                }
+                const int32_t orig = get_sample(in, (uint32_t)plane, x, y);
+                int32_t merged = averageLuma;
+                if (!pa->chroma_scaling_from_luma) {
+                    const int32_t luma_mult = plane == 1 ? pa->cb_luma_mult : pa->cr_luma_mult;
+                    const int32_t mult = plane == 1 ? pa->cb_mult : pa->cr_mult;
+                    const int32_t offset = plane == 1 ? pa->cb_offset : pa->cr_offset;
+                    const int32_t combined = averageLuma * luma_mult + orig * mult;
+                    merged = clip3(0, (1 << BitDepth) - 1, (combined >> 6) + offset * (1 << (BitDepth - 8)));
+                }
+                const int32_t noise = round2(scale_lut(plane, merged, BitDepth) * IMAGE(plane, y, x), ScalingShift);
+                set_sample(out, (uint32_t)plane, x, y, clip3(minValue, maxChroma, orig + noise));
+            }
+        }
+    }
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const int32_t orig = get_sample(in, 0, x, y);
+            const int32_t noise = round2(scale_lut(0, orig, BitDepth) * IMAGE(0, y, x), ScalingShift);
+            if (pa->num_y_points > 0) {
+                set_sample(out, 0, x, y, clip3(minValue, maxLuma, orig + noise));
+            }
+        }
+    }
+#undef STRIPE
+#undef IMAGE
+    free(noiseStripe);
+    free(noiseImage);
+}
+
+static void random_points(uint8_t *num, uint32_t max, uint8_t *value, uint8_t *scaling) {
+    uint32_t n = (uint32_t)rand() % (max + 1u);
+    uint32_t x = (uint32_t)rand() % 40u;
+    for (uint32_t i = 0; i < n; i++) {
+        if (x > 255u) {
+            n = i;
+            break;
+        }
+        value[i] = (uint8_t)x;
+        scaling[i] = (uint8_t)rand();
+        x += 1u + (uint32_t)rand() % 24u;
+    }
+    *num = (uint8_t)n;
+}
+
+static void random_params(Av1FilmGrainParams *pa, uint32_t layout) {
+    memset(pa, 0, sizeof(*pa));
+    pa->apply_grain = 1;
+    pa->update_grain = 1;
+    pa->grain_seed = (uint16_t)rand();
+    random_points(&pa->num_y_points, AV1_FG_MAX_Y_POINTS, pa->point_y_value, pa->point_y_scaling);
+    pa->chroma_scaling_from_luma = layout != AV1_LAYOUT_I400 && rand() % 4 == 0;
+    if (layout != AV1_LAYOUT_I400 && !pa->chroma_scaling_from_luma && !(layout == AV1_LAYOUT_I420 && pa->num_y_points == 0)) {
+        random_points(&pa->num_cb_points, AV1_FG_MAX_UV_POINTS, pa->point_cb_value, pa->point_cb_scaling);
+        random_points(&pa->num_cr_points, AV1_FG_MAX_UV_POINTS, pa->point_cr_value, pa->point_cr_scaling);
+    }
+    pa->grain_scaling = (uint8_t)(8 + rand() % 4);
+    pa->ar_coeff_lag = (uint8_t)(rand() % 4);
+    const int div = rand() % 2 ? 1 : 8;
+    for (uint32_t i = 0; i < AV1_FG_MAX_AR_COEFFS; i++) {
+        if (i + 1u < AV1_FG_MAX_AR_COEFFS) {
+            pa->ar_coeffs_y[i] = (int8_t)((rand() % 256 - 128) / div);
+        }
+        pa->ar_coeffs_cb[i] = (int8_t)((rand() % 256 - 128) / div);
+        pa->ar_coeffs_cr[i] = (int8_t)((rand() % 256 - 128) / div);
+    }
+    pa->ar_coeff_shift = (uint8_t)(6 + rand() % 4);
+    pa->grain_scale_shift = (uint8_t)(rand() % 4);
+    pa->cb_mult = (int16_t)(rand() % 256 - 128);
+    pa->cb_luma_mult = (int16_t)(rand() % 256 - 128);
+    pa->cb_offset = (int16_t)(rand() % 512 - 256);
+    pa->cr_mult = (int16_t)(rand() % 256 - 128);
+    pa->cr_luma_mult = (int16_t)(rand() % 256 - 128);
+    pa->cr_offset = (int16_t)(rand() % 512 - 256);
+    pa->overlap_flag = (uint8_t)(rand() % 2);
+    pa->clip_to_restricted_range = (uint8_t)(rand() % 2);
+}
+
+static bool frames_equal(const Av1FrameBuf *a, const Av1FrameBuf *b) {
+    for (uint32_t p = 0; p < a->num_planes; p++) {
+        for (uint32_t y = 0; y < a->plane_h[p]; y++) {
+            for (uint32_t x = 0; x < a->plane_w[p]; x++) {
+                if (get_sample(a, p, (int32_t)x, (int32_t)y) != get_sample(b, p, (int32_t)x, (int32_t)y)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Whole frames, every layout and bit depth, against the spec process; block rows in any order and
+// on a pool give the same frame.
+static int test_frame(void) {
+    static const uint32_t kCases[][4] = {
+        // width, height, layout, bit depth
+        {160, 96, AV1_LAYOUT_I420, 8},  {97, 71, AV1_LAYOUT_I420, 8},   {131, 45, AV1_LAYOUT_I444, 8},
+        {77, 66, AV1_LAYOUT_I422, 8},   {64, 64, AV1_LAYOUT_I400, 8},   {121, 83, AV1_LAYOUT_I420, 10},
+        {90, 40, AV1_LAYOUT_I444, 12},  {33, 33, AV1_LAYOUT_I422, 10},  {1, 1, AV1_LAYOUT_I420, 8},
+        {5, 37, AV1_LAYOUT_I420, 12},
+    };
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    Av1ThreadPool threads;
+    char err[256];
+    CHECK(av1_thread_pool_init(&threads, 4, err, sizeof(err)));
+    Av1FilmGrain *fg = malloc(sizeof(*fg));
+    CHECK(fg != NULL);
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (uint32_t iter = 0; iter < 12u; iter++) {
+            srand(900u + (unsigned)(ci * 16u + iter));
+            const uint32_t w = kCases[ci][0], h = kCases[ci][1], layout = kCases[ci][2], bit_depth = kCases[ci][3];
+            Av1FrameBuf *src, *out, *ref;
+            CHECK(av1_frame_pool_get(&pool, w, h, layout, bit_depth, &src, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, w, h, layout, bit_depth, &out, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, w, h, layout, bit_depth, &ref, err, sizeof(err)));
+            for (uint32_t p = 0; p < src->num_planes; p++) {
+                for (uint32_t y = 0; y < src->plane_h[p]; y++) {
+                    for (uint32_t x = 0; x < src->plane_w[p]; x++) {
+                        set_sample(src, p, (int32_t)x, (int32_t)y, (int32_t)((uint32_t)rand() % (1u << bit_depth)));
+                    }
+                }
+            }
+            Av1FilmGrainParams pa;
+            random_params(&pa, layout);
+            const int mc_identity = rand() % 4 == 0;
+            reference_film_grain(&pa, mc_identity, src, ref);
+
+            CHECK(av1_film_grain_init(fg, out, src, &pa, mc_identity, err, sizeof(err)));
+            if (iter & 1u) {
+                for (uint32_t r = fg->num_rows; r-- > 0;) {
+                    av1_film_grain_apply_row(fg, r);
+                }
+            } else {
+                av1_film_grain_apply_frame(fg);
+            }
+            CHECK(frames_equal(out, ref));
+
+            // Scalar kernels and the pool.
+            av1_fg_dsp_init_c(&fg->dsp);
+            av1_film_grain_apply_frame_mt(fg, &threads);
+            CHECK(frames_equal(out, ref));
+            av1_frame_pool_put(&pool, src);
+            av1_frame_pool_put(&pool, out);
+            av1_frame_pool_put(&pool, ref);
+        }
+    }
+
+    // Bad parameters and frames are rejected.
+    Av1FrameBuf *a, *b;
+    CHECK(av1_frame_pool_get(&pool, 64, 32, AV1_LAYOUT_I420, 8, &a, err, sizeof(err)));
+    CHECK(av1_frame_pool_get(&pool, 64, 30, AV1_LAYOUT_I420, 8, &b, err, sizeof(err)));
+    Av1FilmGrainParams pa;
+    random_params(&pa, AV1_LAYOUT_I420);
+    CHECK(!av1_film_grain_init(fg, b, a, &pa, false, err, sizeof(err)));
+    CHECK(!av1_film_grain_init(fg, a, a, &pa, false, err, sizeof(err)));
+    pa.num_y_points = 2;
+    pa.point_y_value[0] = 40;
+    pa.point_y_value[1] = 40;
+    Av1FrameBuf *c;
+    CHECK(av1_frame_pool_get(&pool, 64, 32, AV1_LAYOUT_I420, 8, &c, err, sizeof(err)));
+    CHECK(!av1_film_grain_init(fg, c, a, &pa, false, err, sizeof(err)));
+    pa.num_y_points = AV1_FG_MAX_Y_POINTS + 1u;
+    CHECK(!av1_film_grain_init(fg, c, a, &pa, false, err, sizeof(err)));
+    av1_frame_pool_put(&pool, a);
+    av1_frame_pool_put(&pool, b);
+    av1_frame_pool_put(&pool, c);
+    free(fg);
+    av1_thread_pool_free(&threads);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_kernels();
+    rc |= test_frame();
+    if (rc == 0) {
+        printf("film grain tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_frame_buf.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static int test_geometry(void) {
+    static const uint32_t kDims[][2] = {{1, 1}, {17, 9}, {1920, 1080}, {2048, 64}, {4095, 3}};
+    static const uint32_t kDepths[] = {8, 10, 12};
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 40, 0);
+    char err[256];
+    for (size_t d = 0; d < sizeof(kDims) / sizeof(kDims[0]); d++) {
+        for (uint32_t layout = 0; layout < AV1_LAYOUTS; layout++) {
+            for (size_t b = 0; b < 3; b++) {
+                Av1FrameBuf *fb;
+                CHECK(av1_frame_pool_get(&pool, kDims[d][0], kDims[d][1], layout, kDepths[b], &fb, err, sizeof(err)));
+                CHECK(fb->num_planes == (layout == AV1_LAYOUT_I400 ? 1u : 3u));
+                CHECK(fb->bytes_per_sample == (kDepths[b] > 8 ? 2u : 1u));
+                for (uint32_t p = 0; p < fb->num_planes; p++) {
+                    const size_t row_bytes = (size_t)fb->stride[p] * fb->bytes_per_sample;
+                    CHECK(((uintptr_t)fb->plane[p] & (AV1_FRAME_ALIGN - 1u)) == 0);
+                    CHECK(row_bytes % AV1_FRAME_ALIGN == 0 && row_bytes % 4096u != 0);
+                    CHECK(fb->plane_w[p] + 2u * fb->border_x[p] <= (uint32_t)fb->stride[p]);
+                    const uint32_t sub_x = p && layout != AV1_LAYOUT_I444;
+                    const uint32_t sub_y = p && layout == AV1_LAYOUT_I420;
+                    CHECK(fb->plane_w[p] == (kDims[d][0] + sub_x) >> sub_x);
+                    CHECK(fb->plane_h[p] == (kDims[d][1] + sub_y) >> sub_y);
+                    CHECK(fb->border_x[p] >= 40u >> sub_x && fb->border_y[p] == 40u >> sub_y);
+                    // The whole bordered plane is writable.
+                    uint8_t *first = (uint8_t *)fb->plane[p] -
+                                     ((size_t)fb->border_y[p] * fb->stride[p] + fb->border_x[p]) * fb->bytes_per_sample;
+                    memset(first, 0x5A, row_bytes * (fb->plane_h[p] + 2u * fb->border_y[p]));
+                }
+                av1_frame_pool_put(&pool, fb);
+            }
+        }
+    }
+    CHECK(pool.in_use == 0);
+
+    Av1FrameBuf *fb;
+    CHECK(!av1_frame_pool_get(&pool, 16, 16, AV1_LAYOUT_I420, 9, &fb, err, sizeof(err)));
+    CHECK(!av1_frame_pool_get(&pool, 0, 16, AV1_LAYOUT_I420, 8, &fb, err, sizeof(err)));
+    CHECK(!av1_frame_pool_get(&pool, 16, 16, AV1_LAYOUTS, 8, &fb, err, sizeof(err)));
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+static int test_recycling(void) {
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 32, 2);
+    char err[256];
+    Av1FrameBuf *a;
+    Av1FrameBuf *b;
+    Av1FrameBuf *c;
+
+    // Steady state: one allocation, then every frame of the same shape reuses it.
+    for (int i = 0; i < 100; i++) {
+        CHECK(av1_frame_pool_get(&pool, 640, 480, AV1_LAYOUT_I420, 8, &a, err, sizeof(err)));
+        av1_frame_pool_put(&pool, a);
+    }
+    CHECK(pool.allocs == 1 && pool.reuses == 99);
+
+    // A different bit depth or layout is a different class.
+    CHECK(av1_frame_pool_get(&pool, 640, 480, AV1_LAYOUT_I420, 10, &b, err, sizeof(err)));
+    CHECK(av1_frame_pool_get(&pool, 640, 480, AV1_LAYOUT_I444, 8, &c, err, sizeof(err)));
+    CHECK(pool.allocs == 3);
+    av1_frame_pool_put(&pool, b);
+    av1_frame_pool_put(&pool, c);
+
+    // At most max_idle_per_class idle buffers per class are kept.
+    Av1FrameBuf *f[3];
+    for (int i = 0; i < 3; i++) {
+        CHECK(av1_frame_pool_get(&pool, 64, 64, AV1_LAYOUT_I400, 12, &f[i], err, sizeof(err)));
+    }
+    for (int i = 0; i < 3; i++) {
+        av1_frame_pool_put(&pool, f[i]);
+    }
+    CHECK(pool.in_use == 0 && pool.idle_bytes == a->mem_size + b->mem_size + c->mem_size + 2u * f[0]->mem_size);
+    av1_frame_pool_trim(&pool);
+    CHECK(pool.idle_bytes == 0);
+    CHECK(av1_frame_pool_get(&pool, 640, 480, AV1_LAYOUT_I420, 8, &a, err, sizeof(err)));
+    CHECK(pool.allocs == 7);
+    av1_frame_pool_put(&pool, a);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+static int test_extend(void) {
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 8, 0);
+    char err[256];
+    Av1FrameBuf *fb;
+    CHECK(av1_frame_pool_get(&pool, 5, 3, AV1_LAYOUT_I420, 10, &fb, err, sizeof(err)));
+    uint16_t *u = av1_frame_plane_16(fb, 1);
+    CHECK(fb->plane_w[1] == 3 && fb->plane_h[1] == 2);
+    for (uint32_t y = 0; y < 2; y++) {
+        for (uint32_t x = 0; x < 3; x++) {
+            u[(ptrdiff_t)y * fb->stride[1] + x] = (uint16_t)(100 * y + x);
+        }
+    }
+    av1_frame_extend_plane(fb, 1);
+    const ptrdiff_t s = fb->stride[1];
+    const int32_t bx = (int32_t)fb->border_x[1];
+    const int32_t by = (int32_t)fb->border_y[1];
+    CHECK(u[-bx] == 0 && u[2 + bx] == 2 && u[s - bx] == 100 && u[s + 2 + bx] == 102);
+    CHECK(u[-by * s - bx] == 0 && u[(1 + by) * s + 2 + bx] == 102 && u[-by * s + 1] == 1);
+    av1_frame_pool_put(&pool, fb);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_geometry();
+    rc |= test_recycling();
+    rc |= test_extend();
+    if (rc == 0) {
+        printf("frame_buf tests: ok\n");
+    }
+    return rc;
+}
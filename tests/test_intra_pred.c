@@ -0,0 +1,415 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_intra_pred.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t g_rng = 0x2545F491u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// Transform block sizes as (log2w, log2h), TX_4X4 .. TX_64X16.
+static const uint8_t kTxLog2[19][2] = {
+    {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6}, {2, 3}, {3, 2}, {3, 4}, {4, 3}, {4, 5},
+    {5, 4}, {5, 6}, {6, 5}, {2, 4}, {4, 2}, {3, 5}, {5, 3}, {4, 6}, {6, 4},
+};
+
+static int test_edges_defaults(void) {
+    // No neighbours: AboveRow = 127, LeftCol = 129, corner = 128.
+    uint8_t plane[16 * 16];
+    memset(plane, 7, sizeof(plane));
+    Av1IntraEdges e;
+    av1_intra_edges_build(&e, plane, 16, 0, 0, 2, 2, false, false, false, false, 15, 15);
+    const uint8_t *above = av1_intra_edges_above(&e);
+    const uint8_t *left = av1_intra_edges_left(&e);
+    for (int i = 0; i < 8; i++) {
+        CHECK(above[i] == 127);
+        CHECK(left[i] == 129);
+    }
+    CHECK(above[-1] == 128 && left[-1] == 128);
+    return 0;
+}
+
+static int test_edges_limits(void) {
+    // Block at (4, 4) in a 16x16 plane with pixel value x + 16 * y. Without above-right /
+    // below-left the edges replicate the last in-block neighbour.
+    uint8_t plane[16 * 16];
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            plane[y * 16 + x] = (uint8_t)(x + 16 * y);
+        }
+    }
+    Av1IntraEdges e;
+    av1_intra_edges_build(&e, plane, 16, 4, 4, 2, 2, true, true, false, false, 15, 15);
+    const uint8_t *above = av1_intra_edges_above(&e);
+    const uint8_t *left = av1_intra_edges_left(&e);
+    for (int i = 0; i < 8; i++) {
+        CHECK(above[i] == 3 * 16 + 4 + (i < 3 ? i : 3));
+        CHECK(left[i] == (4 + (i < 3 ? i : 3)) * 16 + 3);
+    }
+    CHECK(above[-1] == 3 * 16 + 3);
+
+    // With above-right the row extends to x + 2w - 1, clipped to the plane.
+    av1_intra_edges_build(&e, plane, 16, 12, 4, 2, 2, true, true, true, false, 15, 15);
+    above = av1_intra_edges_above(&e);
+    for (int i = 0; i < 8; i++) {
+        CHECK(above[i] == 3 * 16 + 12 + (i < 3 ? i : 3));
+    }
+    return 0;
+}
+
+static int test_kats(void) {
+    Av1IntraPredDsp dsp;
+    av1_intra_pred_dsp_init_c(&dsp);
+    Av1IntraEdges e;
+    memset(&e, 0, sizeof(e));
+    uint8_t *above = av1_intra_edges_above(&e);
+    uint8_t *left = av1_intra_edges_left(&e);
+    for (int i = 0; i < 4; i++) {
+        above[i] = (uint8_t)(10 * (i + 1)); // 10 20 30 40
+        left[i] = (uint8_t)(100 + i);       // 100 101 102 103
+    }
+    above[-1] = 50;
+    uint8_t dst[4 * 4];
+    char err[256];
+
+    // DC: (100 + 406 + 4) / 8 = 63.
+    CHECK(av1_intra_predict(&dsp, AV1_DC_PRED, 0, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 63 && dst[15] == 63);
+    CHECK(av1_intra_predict(&dsp, AV1_DC_PRED, 0, false, false, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[5] == 128);
+    CHECK(av1_intra_predict(&dsp, AV1_DC_PRED, 0, false, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[5] == 25);
+
+    CHECK(av1_intra_predict(&dsp, AV1_V_PRED, 0, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 10 && dst[13] == 20);
+    CHECK(av1_intra_predict(&dsp, AV1_H_PRED, 0, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[3] == 100 && dst[12] == 103);
+
+    // Paeth at (0, 0): base = 10 + 100 - 50 = 60; pLeft = 40, pTop = 50, pTopLeft = 10 -> corner.
+    // At (0, 3): base = 140; pLeft = 0 -> LeftCol.
+    CHECK(av1_intra_predict(&dsp, AV1_PAETH_PRED, 0, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 50);
+    CHECK(dst[3] == 100);
+
+    // CFL and out-of-range deltas are rejected.
+    CHECK(!av1_intra_predict(&dsp, AV1_UV_CFL_PRED, 0, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    CHECK(!av1_intra_predict(&dsp, AV1_D45_PRED, 4, true, true, NULL, above, left, dst, 4, 2, 2, err, sizeof(err)));
+    return 0;
+}
+
+static int test_filter_intra_flat(void) {
+    // Every row of Intra_Filter_Taps sums to 16, so flat edges predict a flat block.
+    Av1IntraPredDsp dsp;
+    av1_intra_pred_dsp_init(&dsp);
+    Av1IntraEdges e;
+    memset(&e, 100, sizeof(e));
+    uint8_t dst[32 * 32];
+    char err[256];
+    for (uint32_t mode = 0; mode < AV1_FILTER_INTRA_MODES; mode++) {
+        CHECK(av1_intra_predict_filter(&dsp, mode, av1_intra_edges_above(&e), av1_intra_edges_left(&e), dst, 32, 5, 4, err,
+                                       sizeof(err)));
+        for (uint32_t i = 0; i < 16; i++) {
+            for (uint32_t j = 0; j < 32; j++) {
+                CHECK(dst[i * 32 + j] == 100);
+            }
+        }
+    }
+    CHECK(!av1_intra_predict_filter(&dsp, 5, av1_intra_edges_above(&e), av1_intra_edges_left(&e), dst, 32, 2, 2, err, sizeof(err)));
+    CHECK(!av1_intra_predict_filter(&dsp, 0, av1_intra_edges_above(&e), av1_intra_edges_left(&e), dst, 32, 6, 2, err, sizeof(err)));
+    return 0;
+}
+
+static int test_edge_selection(void) {
+    CHECK(av1_intra_edge_filter_strength(4, 4, false, 56) == 1);
+    CHECK(av1_intra_edge_filter_strength(4, 4, false, -55) == 0);
+    CHECK(av1_intra_edge_filter_strength(8, 16, false, 16) == 2);
+    CHECK(av1_intra_edge_filter_strength(16, 16, false, 4) == 2);
+    CHECK(av1_intra_edge_filter_strength(32, 16, false, 0) == 3);
+    CHECK(av1_intra_edge_filter_strength(4, 4, true, 64) == 2);
+    CHECK(av1_intra_edge_filter_strength(8, 16, true, -4) == 3);
+    CHECK(av1_intra_edge_use_upsample(8, 8, false, 3));
+    CHECK(!av1_intra_edge_use_upsample(8, 8, false, 0));
+    CHECK(!av1_intra_edge_use_upsample(8, 8, false, 40));
+    CHECK(!av1_intra_edge_use_upsample(8, 16, false, 3));
+    CHECK(!av1_intra_edge_use_upsample(4, 8, true, 3));
+    return 0;
+}
+
+static int test_edge_kats(void) {
+    Av1IntraPredDsp dsp;
+    av1_intra_pred_dsp_init_c(&dsp);
+    // Strength 1 ( 4, 8, 4 ) / 16 on a step 0 0 0 0 | 160 160 160 160.
+    uint8_t edge[8] = {0, 0, 0, 0, 160, 160, 160, 160};
+    dsp.edge_filter(edge, 8, 1);
+    CHECK(edge[0] == 0 && edge[3] == 40 && edge[4] == 120 && edge[7] == 160);
+
+    // Upsampling 10 20 30 40 (LeftCol / AboveRow[ -1 ] = 10): inside the ramp the 4-tap filter
+    // gives the midpoint, next to the flat start it undershoots.
+    uint8_t buf[16] = {0};
+    uint8_t *b = buf + 2;
+    b[-1] = 10;
+    b[0] = 10;
+    b[1] = 20;
+    b[2] = 30;
+    b[3] = 40;
+    dsp.edge_upsample(b, 4);
+    CHECK(b[-2] == 10 && b[-1] == 9 && b[0] == 10 && b[1] == 14 && b[2] == 20 && b[3] == 25 && b[6] == 40);
+    return 0;
+}
+
+static int test_avx2_matches_reference(void) {
+#if defined(AV1_IPRED_HAVE_X86)
+    Av1IntraPredDsp ref;
+    Av1IntraPredDsp simd;
+    av1_intra_pred_dsp_init_c(&ref);
+    av1_intra_pred_dsp_init_c(&simd);
+    if (!av1_intra_pred_dsp_init_avx2(&simd)) {
+        printf("intra_pred: AVX2 not available, skipping kernel comparison\n");
+        return 0;
+    }
+    static uint8_t out_ref[64 * 72];
+    static uint8_t out_simd[64 * 72];
+    Av1IntraEdges e;
+    char err[256];
+    for (uint32_t t = 0; t < 19; t++) {
+        const uint32_t log2w = kTxLog2[t][0];
+        const uint32_t log2h = kTxLog2[t][1];
+        for (uint32_t iter = 0; iter < 8; iter++) {
+            for (size_t k = 0; k < sizeof(e.above_buf); k++) {
+                e.above_buf[k] = (uint8_t)rng_next();
+                e.left_buf[k] = (uint8_t)rng_next();
+            }
+            uint8_t *above = av1_intra_edges_above(&e);
+            uint8_t *left = av1_intra_edges_left(&e);
+            for (uint32_t mode = 0; mode < AV1_UV_CFL_PRED; mode++) {
+                for (int32_t delta = -3; delta <= 3; delta++) {
+                    const int32_t angle = av1_intra_mode_to_angle(mode);
+                    if (angle == 0 && delta != 0) {
+                        continue;
+                    }
+                    for (uint32_t avail = 0; avail < 4; avail++) {
+                        const bool have_left = (avail & 1u) != 0;
+                        const bool have_above = (avail & 2u) != 0;
+                        CHECK(av1_intra_predict(&ref, mode, delta, have_left, have_above, NULL, above, left, out_ref, 64,
+                                                log2w, log2h, err, sizeof(err)));
+                        CHECK(av1_intra_predict(&simd, mode, delta, have_left, have_above, NULL, above, left, out_simd, 64,
+                                                log2w, log2h, err, sizeof(err)));
+                        for (uint32_t i = 0; i < (1u << log2h); i++) {
+                            CHECK(memcmp(out_ref + i * 64, out_simd + i * 64, 1u << log2w) == 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Directional kernel with upsampled edges (only used when w + h <= 16).
+    for (uint32_t m = 0; m < AV1_UV_CFL_PRED * 7u; m++) {
+        const int32_t p_angle = av1_intra_mode_to_angle(m / 7u) + ((int32_t)(m % 7u) - 3) * AV1_ANGLE_STEP;
+        if (av1_intra_mode_to_angle(m / 7u) == 0 || p_angle == 90 || p_angle == 180) {
+            continue;
+        }
+        for (uint32_t t = 0; t < 19; t++) {
+            const uint32_t log2w = kTxLog2[t][0];
+            const uint32_t log2h = kTxLog2[t][1];
+            const bool small = (1u << log2w) + (1u << log2h) <= 16u;
+            for (size_t k = 0; k < sizeof(e.above_buf); k++) {
+                e.above_buf[k] = (uint8_t)rng_next();
+                e.left_buf[k] = (uint8_t)rng_next();
+            }
+            const Av1IntraDir dir = {p_angle, (uint8_t)(small && (rng_next() & 1u)), (uint8_t)(small && (rng_next() & 1u))};
+            ref.pred[AV1_IPRED_DIR](out_ref, 64, av1_intra_edges_above(&e), av1_intra_edges_left(&e), log2w, log2h, &dir);
+            simd.pred[AV1_IPRED_DIR](out_simd, 64, av1_intra_edges_above(&e), av1_intra_edges_left(&e), log2w, log2h, &dir);
+            for (uint32_t i = 0; i < (1u << log2h); i++) {
+                CHECK(memcmp(out_ref + i * 64, out_simd + i * 64, 1u << log2w) == 0);
+            }
+        }
+    }
+
+    // Filter-intra, every size up to 32x32 and every mode.
+    for (uint32_t log2w = 2; log2w <= 5; log2w++) {
+        for (uint32_t log2h = 2; log2h <= 5; log2h++) {
+            for (uint32_t mode = 0; mode < AV1_FILTER_INTRA_MODES; mode++) {
+                for (size_t k = 0; k < sizeof(e.above_buf); k++) {
+                    e.above_buf[k] = (uint8_t)rng_next();
+                    e.left_buf[k] = (uint8_t)rng_next();
+                }
+                ref.filter_intra(out_ref, 64, av1_intra_edges_above(&e), av1_intra_edges_left(&e), log2w, log2h, mode);
+                simd.filter_intra(out_simd, 64, av1_intra_edges_above(&e), av1_intra_edges_left(&e), log2w, log2h, mode);
+                for (uint32_t i = 0; i < (1u << log2h); i++) {
+                    CHECK(memcmp(out_ref + i * 64, out_simd + i * 64, 1u << log2w) == 0);
+                }
+            }
+        }
+    }
+
+    // Edge filter (every size and strength) and upsample (every num_px).
+    for (uint32_t sz = 2; sz <= 129; sz++) {
+        for (uint32_t strength = 1; strength <= 3; strength++) {
+            uint8_t a[AV1_INTRA_EDGE_LEN];
+            uint8_t b[AV1_INTRA_EDGE_LEN];
+            for (size_t k = 0; k < sizeof(a); k++) {
+                a[k] = (uint8_t)rng_next();
+            }
+            memcpy(b, a, sizeof(a));
+            ref.edge_filter(a, sz, strength);
+            simd.edge_filter(b, sz, strength);
+            CHECK(memcmp(a, b, sizeof(a)) == 0);
+        }
+    }
+    for (uint32_t num_px = 1; num_px <= 16; num_px++) {
+        uint8_t a[64];
+        uint8_t b[64];
+        for (size_t k = 0; k < sizeof(a); k++) {
+            a[k] = (uint8_t)rng_next();
+        }
+        memcpy(b, a, sizeof(a));
+        ref.edge_upsample(a + 8, num_px);
+        simd.edge_upsample(b + 8, num_px);
+        CHECK(memcmp(a, b, sizeof(a)) == 0);
+    }
+
+    // Full directional path with the intra edge filter enabled: both tables see the same edges.
+    for (uint32_t t = 0; t < 19; t++) {
+        const uint32_t log2w = kTxLog2[t][0];
+        const uint32_t log2h = kTxLog2[t][1];
+        for (uint32_t mode = AV1_D45_PRED; mode <= AV1_D67_PRED; mode++) {
+            for (int32_t delta = -3; delta <= 3; delta++) {
+                Av1IntraEdges e2;
+                for (size_t k = 0; k < sizeof(e.above_buf); k++) {
+                    e.above_buf[k] = (uint8_t)rng_next();
+                    e.left_buf[k] = (uint8_t)rng_next();
+                }
+                e2 = e;
+                const Av1IntraEdgeFilterCtx ctx = {(rng_next() & 1u) != 0, 1u + rng_next() % 64u, 1u + rng_next() % 64u};
+                CHECK(av1_intra_predict(&ref, mode, delta, true, true, &ctx, av1_intra_edges_above(&e), av1_intra_edges_left(&e),
+                                        out_ref, 64, log2w, log2h, err, sizeof(err)));
+                CHECK(av1_intra_predict(&simd, mode, delta, true, true, &ctx, av1_intra_edges_above(&e2),
+                                        av1_intra_edges_left(&e2), out_simd, 64, log2w, log2h, err, sizeof(err)));
+                for (uint32_t i = 0; i < (1u << log2h); i++) {
+                    CHECK(memcmp(out_ref + i * 64, out_simd + i * 64, 1u << log2w) == 0);
+                }
+            }
+        }
+    }
+#endif
+    return 0;
+}
+
+// The uint16_t instantiation at BitDepth 8 must reproduce the uint8_t one for every mode, size,
+// availability and edge-filter setting (same source, different pixel type).
+static int test_16bit_matches_8bit(void) {
+    Av1IntraPredDsp dsp8;
+    Av1IntraPredDsp16 dsp16;
+    av1_intra_pred_dsp_init_c(&dsp8);
+    av1_intra_pred_dsp_init_c_16(&dsp16, 8);
+    char err[256];
+    for (uint32_t t = 0; t < 19; t++) {
+        const uint32_t log2w = kTxLog2[t][0];
+        const uint32_t log2h = kTxLog2[t][1];
+        for (uint32_t mode = 0; mode < AV1_UV_CFL_PRED; mode++) {
+            const bool directional = av1_intra_mode_to_angle(mode) != 0;
+            for (int32_t delta = directional ? -3 : 0; delta <= (directional ? 3 : 0); delta++) {
+                Av1IntraEdges e8;
+                Av1IntraEdges16 e16;
+                for (size_t k = 0; k < sizeof(e8.above_buf); k++) {
+                    e8.above_buf[k] = (uint8_t)rng_next();
+                    e8.left_buf[k] = (uint8_t)rng_next();
+                    e16.above_buf[k] = e8.above_buf[k];
+                    e16.left_buf[k] = e8.left_buf[k];
+                }
+                const bool have_left = (rng_next() & 1u) != 0;
+                const bool have_above = (rng_next() & 1u) != 0;
+                const Av1IntraEdgeFilterCtx ctx = {(rng_next() & 1u) != 0, 1u + rng_next() % 128u, 1u + rng_next() % 128u};
+                const Av1IntraEdgeFilterCtx *ef = (rng_next() & 1u) ? &ctx : NULL;
+                uint8_t got8[64 * 64];
+                uint16_t got16[64 * 64];
+                CHECK(av1_intra_predict(&dsp8, mode, delta, have_left, have_above, ef, av1_intra_edges_above(&e8),
+                                        av1_intra_edges_left(&e8), got8, 64, log2w, log2h, err, sizeof(err)));
+                CHECK(av1_intra_predict_16(&dsp16, mode, delta, have_left, have_above, ef, av1_intra_edges_above_16(&e16),
+                                           av1_intra_edges_left_16(&e16), got16, 64, log2w, log2h, err, sizeof(err)));
+                for (uint32_t i = 0; i < (1u << log2h); i++) {
+                    for (uint32_t j = 0; j < (1u << log2w); j++) {
+                        CHECK(got16[i * 64 + j] == got8[i * 64 + j]);
+                    }
+                }
+                if (log2w <= 5 && log2h <= 5 && mode < AV1_FILTER_INTRA_MODES) {
+                    CHECK(av1_intra_predict_filter(&dsp8, mode, av1_intra_edges_above(&e8), av1_intra_edges_left(&e8), got8, 64,
+                                                   log2w, log2h, err, sizeof(err)));
+                    CHECK(av1_intra_predict_filter_16(&dsp16, mode, av1_intra_edges_above_16(&e16), av1_intra_edges_left_16(&e16),
+                                                      got16, 64, log2w, log2h, err, sizeof(err)));
+                    for (uint32_t i = 0; i < (1u << log2h); i++) {
+                        for (uint32_t j = 0; j < (1u << log2w); j++) {
+                            CHECK(got16[i * 64 + j] == got8[i * 64 + j]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_high_bitdepth(void) {
+    // 10-bit defaults: AboveRow = 511, LeftCol = 513, corner and DC_128 = 512.
+    uint16_t plane[16 * 16] = {0};
+    Av1IntraEdges16 e;
+    av1_intra_edges_build_16(&e, plane, 16, 0, 0, 2, 2, false, false, false, false, 15, 15, 10);
+    uint16_t *above = av1_intra_edges_above_16(&e);
+    uint16_t *left = av1_intra_edges_left_16(&e);
+    CHECK(above[0] == 511 && above[7] == 511 && left[0] == 513 && left[7] == 513);
+    CHECK(above[-1] == 512 && left[-1] == 512);
+
+    Av1IntraPredDsp16 dsp;
+    av1_intra_pred_dsp_init_16(&dsp, 10);
+    uint16_t dst[16 * 16];
+    char err[256];
+    CHECK(av1_intra_predict_16(&dsp, AV1_DC_PRED, 0, false, false, NULL, above, left, dst, 16, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 512 && dst[3 * 16 + 3] == 512);
+
+    // 12-bit: a saturated edge stays within Clip1() (filter-intra taps overshoot).
+    av1_intra_pred_dsp_init_16(&dsp, 12);
+    for (int i = -1; i < 32; i++) {
+        above[i] = 4095;
+        left[i] = i < 2 ? 4095 : 0;
+    }
+    for (uint32_t m = 0; m < AV1_FILTER_INTRA_MODES; m++) {
+        CHECK(av1_intra_predict_filter_16(&dsp, m, above, left, dst, 16, 3, 3, err, sizeof(err)));
+        for (int k = 0; k < 8; k++) {
+            CHECK(dst[k] <= 4095);
+        }
+    }
+    CHECK(av1_intra_predict_16(&dsp, AV1_PAETH_PRED, 0, true, true, NULL, above, left, dst, 16, 2, 2, err, sizeof(err)));
+    CHECK(dst[0] == 4095);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_edges_defaults();
+    rc |= test_edges_limits();
+    rc |= test_kats();
+    rc |= test_filter_intra_flat();
+    rc |= test_edge_selection();
+    rc |= test_edge_kats();
+    rc |= test_avx2_matches_reference();
+    rc |= test_16bit_matches_8bit();
+    rc |= test_high_bitdepth();
+    if (rc == 0) {
+        printf("intra_pred tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_intrabc.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t rng_state = 0x13579bdfu;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// A 64x64-superblock block of bw x bh luma samples at (x, y) in a single 512x192 tile.
+static Av1IntrabcBlock block_at(uint32_t x, uint32_t y, uint32_t bw, uint32_t bh) {
+    Av1IntrabcBlock b;
+    memset(&b, 0, sizeof(b));
+    b.mi_row = y / 4u;
+    b.mi_col = x / 4u;
+    b.bw = bw;
+    b.bh = bh;
+    b.mi_row_end = 48;
+    b.mi_col_end = 128;
+    b.subsampling_x = 1;
+    b.subsampling_y = 1;
+    b.has_chroma = true;
+    return b;
+}
+
+static int test_default_dv(void) {
+    int32_t dv[2];
+    Av1IntrabcBlock b = block_at(448, 0, 64, 64);
+    av1_intrabc_default_dv(&b, dv);
+    CHECK(dv[0] == 0 && dv[1] == -(64 + AV1_INTRABC_DELAY_PIXELS) * 8);
+    CHECK(av1_intrabc_dv_valid(&b, dv));
+
+    b = block_at(64, 64, 16, 16);
+    av1_intrabc_default_dv(&b, dv);
+    CHECK(dv[0] == -64 * 8 && dv[1] == 0);
+
+    // 128x128 superblocks; the tile starts at MI row 32, so row 32 is its first SB row.
+    b = block_at(0, 128, 32, 32);
+    b.use_128x128_superblock = 1;
+    b.mi_row_start = 32;
+    av1_intrabc_default_dv(&b, dv);
+    CHECK(dv[0] == 0 && dv[1] == -(128 + AV1_INTRABC_DELAY_PIXELS) * 8);
+    return 0;
+}
+
+static int test_dv_valid_cases(void) {
+    // Second SB row, first column: the SB straight above is 8 SB64s back and inside the wavefront.
+    const Av1IntrabcBlock b = block_at(0, 64, 64, 64);
+    CHECK(av1_intrabc_dv_valid(&b, (const int32_t[2]){-64 * 8, 0}));
+    // Sub-sample and out-of-range vectors.
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-64 * 8 + 4, 0}));
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-(1 << 14), 0}));
+    // Source above / left of the tile.
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-65 * 8, 0}));
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-64 * 8, -8}));
+    // One SB64 to the right in the row above is past the wavefront (srcSb64Col >= 0 - 4 + 5).
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-64 * 8, 64 * 8}));
+    // Overlapping the current SB row.
+    CHECK(!av1_intrabc_dv_valid(&b, (const int32_t[2]){-8 * 8, 0}));
+
+    // First SB row: only sources INTRABC_DELAY_SB64 superblocks to the left qualify.
+    const Av1IntrabcBlock f = block_at(320, 0, 32, 32);
+    CHECK(av1_intrabc_dv_valid(&f, (const int32_t[2]){0, -320 * 8}));
+    CHECK(!av1_intrabc_dv_valid(&f, (const int32_t[2]){0, -256 * 8}));
+    CHECK(!av1_intrabc_dv_valid(&f, (const int32_t[2]){0, -321 * 8}));
+
+    // A 4x4 block carrying 4:2:0 chroma also needs the 4 samples above and to the left.
+    Av1IntrabcBlock s = block_at(8, 68, 4, 4);
+    CHECK(!av1_intrabc_dv_valid(&s, (const int32_t[2]){-68 * 8, -8 * 8}));
+    CHECK(av1_intrabc_dv_valid(&s, (const int32_t[2]){-64 * 8, -4 * 8}));
+    s.has_chroma = false;
+    CHECK(av1_intrabc_dv_valid(&s, (const int32_t[2]){-68 * 8, -8 * 8}));
+    return 0;
+}
+
+// Every accepted DV points at samples of superblocks decoded before the current one, far
+// enough back not to touch the current or the previous INTRABC_DELAY_SB64 - 1 superblock columns.
+static int test_dv_valid_sweep(void) {
+    uint32_t accepted = 0;
+    for (uint32_t iter = 0; iter < 200000; iter++) {
+        static const uint32_t kSizes[] = {4, 8, 16, 32, 64};
+        const uint32_t bw = kSizes[rng() % 5u], bh = kSizes[rng() % 5u];
+        const uint32_t x = (rng() % (512u / bw)) * bw, y = (rng() % (192u / bh)) * bh;
+        const Av1IntrabcBlock b = block_at(x, y, bw, bh);
+        const int32_t dv[2] = {((int32_t)(rng() % 512u) - 400) * 8, ((int32_t)(rng() % 1024u) - 600) * 8};
+        if (!av1_intrabc_dv_valid(&b, dv)) {
+            continue;
+        }
+        accepted++;
+        const int32_t sx0 = (int32_t)x + dv[1] / 8, sy0 = (int32_t)y + dv[0] / 8;
+        const int32_t sx1 = sx0 + (int32_t)bw - 1, sy1 = sy0 + (int32_t)bh - 1;
+        CHECK(sx0 >= 0 && sy0 >= 0 && sx1 < 512 && sy1 < 192);
+        const int32_t cur_sb = (int32_t)(y / 64u) * 8 + (int32_t)(x / 64u);
+        const int32_t src_sb = (sy1 / 64) * 8 + sx1 / 64;
+        CHECK(src_sb <= cur_sb - (int32_t)AV1_INTRABC_DELAY_SB64 - 1);
+        CHECK(sy1 / 64 <= (int32_t)(y / 64u));
+    }
+    CHECK(accepted > 1000u);
+    return 0;
+}
+
+static int test_plane_offset(void) {
+    uint32_t half = 9;
+    CHECK(av1_intrabc_plane_offset(-24, 0, &half) == -3 && half == 0u);
+    CHECK(av1_intrabc_plane_offset(8, 1, &half) == 0 && half == 1u);
+    CHECK(av1_intrabc_plane_offset(-8, 1, &half) == -1 && half == 1u);
+    CHECK(av1_intrabc_plane_offset(-16, 1, &half) == -1 && half == 0u);
+    CHECK(av1_intrabc_plane_offset(40, 1, &half) == 2 && half == 1u);
+    return 0;
+}
+
+// The spec's BILINEAR block inter prediction (no scaling, integer or half-sample position) for
+// one sample.
+static uint32_t ref_bilinear(const uint16_t *src, ptrdiff_t stride, uint32_t half_y, uint32_t half_x, uint32_t bit_depth) {
+    const int32_t round0 = bit_depth == 12u ? 5 : 3;
+    const int32_t round1 = bit_depth == 12u ? 9 : 11;
+    int32_t inter[2];
+    for (uint32_t r = 0; r < 2u; r++) {
+        const uint16_t *p = src + (ptrdiff_t)r * stride;
+        const int32_t s = half_x ? 64 * p[0] + 64 * p[1] : 128 * p[0];
+        inter[r] = (s + (1 << (round0 - 1))) >> round0;
+    }
+    const int32_t s = half_y ? 64 * inter[0] + 64 * inter[1] : 128 * inter[0];
+    return (uint32_t)((s + (1 << (round1 - 1))) >> round1);
+}
+
+static int test_copy_matches_bilinear(void) {
+    Av1IntrabcDsp c;
+    av1_intrabc_dsp_init_c(&c);
+    enum { STRIDE = 24 };
+    static const uint32_t kDepths[] = {8, 10, 12};
+    for (uint32_t d = 0; d < 3u; d++) {
+        const uint32_t bd = kDepths[d];
+        uint16_t src[STRIDE * 17], dst[STRIDE * 16];
+        uint8_t src8[STRIDE * 17], dst8[STRIDE * 16];
+        for (uint32_t iter = 0; iter < 200; iter++) {
+            for (uint32_t i = 0; i < STRIDE * 17u; i++) {
+                src[i] = (uint16_t)(iter < 2u ? (iter ? (1u << bd) - 1u : 0u) : rng() & ((1u << bd) - 1u));
+                src8[i] = (uint8_t)src[i];
+            }
+            for (uint32_t phase = 0; phase < 4u; phase++) {
+                c.copy16[phase](dst, STRIDE, src, STRIDE, 16, 16);
+                if (bd == 8u) {
+                    c.copy[phase](dst8, STRIDE, src8, STRIDE, 16, 16);
+                }
+                for (uint32_t y = 0; y < 16u; y++) {
+                    for (uint32_t x = 0; x < 16u; x++) {
+                        const uint32_t want = ref_bilinear(src + y * STRIDE + x, STRIDE, phase >> 1, phase & 1u, bd);
+                        CHECK(dst[y * STRIDE + x] == want);
+                        CHECK(bd != 8u || dst8[y * STRIDE + x] == want);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_copy_dsp(void) {
+    Av1IntrabcDsp c, dsp;
+    av1_intrabc_dsp_init_c(&c);
+    av1_intrabc_dsp_init(&dsp);
+    static const uint32_t kW[] = {4, 8, 16, 32, 64, 128};
+    static const uint32_t kH[] = {1, 2, 4, 7, 16, 64, 128};
+    enum { STRIDE = 144, ROWS = AV1_INTRABC_MAX_DIM + 1 };
+    static uint8_t src8[STRIDE * ROWS], a8[STRIDE * ROWS], b8[STRIDE * ROWS];
+    static uint16_t src16[STRIDE * ROWS], a16[STRIDE * ROWS], b16[STRIDE * ROWS];
+    for (uint32_t i = 0; i < STRIDE * ROWS; i++) {
+        src8[i] = (uint8_t)rng();
+        src16[i] = (uint16_t)(rng() & 4095u);
+    }
+    for (uint32_t wi = 0; wi < 6u; wi++) {
+        for (uint32_t hi = 0; hi < 7u; hi++) {
+            const uint32_t w = kW[wi], h = kH[hi];
+            for (uint32_t phase = 0; phase < 4u; phase++) {
+                // Keep the right neighbor of the last column inside the row.
+                const uint32_t off = (uint32_t)(rng() % (STRIDE - w));
+                memset(a8, 0x5a, sizeof(a8));
+                memset(b8, 0x5a, sizeof(b8));
+                c.copy[phase](a8 + 3, STRIDE, src8 + off, STRIDE, w, h);
+                dsp.copy[phase](b8 + 3, STRIDE, src8 + off, STRIDE, w, h);
+                CHECK(memcmp(a8, b8, sizeof(a8)) == 0);
+                memset(a16, 0x5a, sizeof(a16));
+                memset(b16, 0x5a, sizeof(b16));
+                c.copy16[phase](a16 + 3, STRIDE, src16 + off, STRIDE, w, h);
+                dsp.copy16[phase](b16 + 3, STRIDE, src16 + off, STRIDE, w, h);
+                CHECK(memcmp(a16, b16, sizeof(a16)) == 0);
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_default_dv();
+    rc |= test_dv_valid_cases();
+    rc |= test_dv_valid_sweep();
+    rc |= test_plane_offset();
+    rc |= test_copy_matches_bilinear();
+    rc |= test_copy_dsp();
+    if (rc == 0) {
+        printf("intrabc tests: ok\n");
+    }
+    return rc;
+}
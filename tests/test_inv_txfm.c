@@ -0,0 +1,413 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_dequant.h"
+#include "../src/m3b-av1-decode/av1_inv_txfm.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t g_rng = 0x2545F491u;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// Random coefficient in [-(1 << (bits-1)), (1 << (bits-1)) - 1].
+static int32_t rng_coeff(uint32_t bits) {
+    return (int32_t)(rng_next() & ((1u << bits) - 1u)) - (int32_t)(1u << (bits - 1u));
+}
+
+static bool type_allowed(uint32_t tx_size, uint32_t tx_type) {
+    Av1TxfmPlan p;
+    char err[256];
+    return av1_txfm_plan_init(&p, tx_size, tx_type, 8, false, err, sizeof(err));
+}
+
+// libaom-style forward WHT (av1_fwht4x4_c), used to check that the lossless inverse is exact.
+static void fwht4x4(const int32_t *in, int32_t *out) {
+    int32_t tmp[16];
+    for (int i = 0; i < 4; i++) {
+        int32_t a1 = in[0 * 4 + i];
+        int32_t b1 = in[1 * 4 + i];
+        int32_t c1 = in[2 * 4 + i];
+        int32_t d1 = in[3 * 4 + i];
+        a1 += b1;
+        d1 = d1 - c1;
+        int32_t e1 = (a1 - d1) >> 1;
+        b1 = e1 - b1;
+        c1 = e1 - c1;
+        a1 -= c1;
+        d1 += b1;
+        tmp[0 + i] = a1;
+        tmp[4 + i] = c1;
+        tmp[8 + i] = d1;
+        tmp[12 + i] = b1;
+    }
+    for (int i = 0; i < 4; i++) {
+        int32_t a1 = tmp[i * 4 + 0];
+        int32_t b1 = tmp[i * 4 + 1];
+        int32_t c1 = tmp[i * 4 + 2];
+        int32_t d1 = tmp[i * 4 + 3];
+        a1 += b1;
+        d1 -= c1;
+        int32_t e1 = (a1 - d1) >> 1;
+        b1 = e1 - b1;
+        c1 = e1 - c1;
+        a1 -= c1;
+        d1 += b1;
+        // UNIT_QUANT_FACTOR: lossless dequantization is a multiply by 4.
+        out[i * 4 + 0] = a1 * 4;
+        out[i * 4 + 1] = c1 * 4;
+        out[i * 4 + 2] = d1 * 4;
+        out[i * 4 + 3] = b1 * 4;
+    }
+}
+
+static int test_dc_only_4x4_kat(void) {
+    // DC=64: row DCT -> Round2(64*2896,12)=45, col DCT -> Round2(45*2896,12)=32, colShift 4 -> 2.
+    int32_t coeffs[16] = {64};
+    int32_t res[16];
+    char err[256] = {0};
+    CHECK(av1_inv_txfm2d(coeffs, 0, AV1_TXFM_DCT_DCT, 8, false, NULL, res, err, sizeof(err)));
+    for (int i = 0; i < 16; i++) {
+        CHECK(res[i] == 2);
+    }
+    return 0;
+}
+
+// Sparse paths (extent-driven) must be bit-exact with the dense transform.
+static int test_sparse_matches_dense(void) {
+    static int32_t coeffs[64 * 64];
+    static int32_t dense[64 * 64];
+    static int32_t sparse[64 * 64];
+    char err[256] = {0};
+
+    for (uint32_t tx_size = 0; tx_size < AV1_TXFM_TX_SIZES_ALL; tx_size++) {
+        const uint32_t w = 1u << av1_txfm_width_log2(tx_size);
+        const uint32_t h = 1u << av1_txfm_height_log2(tx_size);
+        for (uint32_t tx_type = 0; tx_type < AV1_TXFM_TYPES; tx_type++) {
+            if (!type_allowed(tx_size, tx_type)) {
+                continue;
+            }
+            for (uint32_t it = 0; it < 64; it++) {
+                memset(coeffs, 0, sizeof(coeffs));
+                Av1TxCoeffExtent e;
+                av1_txfm_extent_reset(&e);
+
+                // Mostly small extents (typical eob <= 16), sometimes DC-only or all-zero.
+                const uint32_t lim_r = (it % 4 == 0) ? 1u : 1u + rng_next() % (h < 32 ? h : 32);
+                const uint32_t lim_c = (it % 4 == 0) ? 1u : 1u + rng_next() % (w < 32 ? w : 32);
+                const uint32_t count = (it % 16 == 15) ? 0u : 1u + rng_next() % 8u;
+                for (uint32_t k = 0; k < count; k++) {
+                    const uint32_t r = rng_next() % lim_r;
+                    const uint32_t c = rng_next() % lim_c;
+                    const int32_t v = rng_coeff(12);
+                    coeffs[(size_t)r * w + c] = v;
+                    if (v != 0) {
+                        e.eob = 1;
+                        av1_txfm_extent_add(&e, r, c);
+                    }
+                }
+
+                CHECK(av1_inv_txfm2d(coeffs, tx_size, tx_type, 8, false, NULL, dense, err, sizeof(err)));
+                CHECK(av1_inv_txfm2d(coeffs, tx_size, tx_type, 8, false, &e, sparse, err, sizeof(err)));
+                if (memcmp(dense, sparse, (size_t)w * h * sizeof(int32_t)) != 0) {
+                    fprintf(stderr, "FAIL: sparse != dense (tx_size=%u tx_type=%u it=%u)\n", tx_size, tx_type, it);
+                    return 1;
+                }
+
+                // The reduced-size entry point at scale 0 is the same transform.
+                CHECK(av1_inv_txfm2d_reduced(coeffs, tx_size, tx_type, 8, 0, sparse, err, sizeof(err)));
+                if (memcmp(dense, sparse, (size_t)w * h * sizeof(int32_t)) != 0) {
+                    fprintf(stderr, "FAIL: reduced(0) != full (tx_size=%u tx_type=%u it=%u)\n", tx_size, tx_type, it);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_adst4_kat(void) {
+    // An impulse at T[0] reads the SINPI constants straight out.
+    int32_t t[4] = {4096, 0, 0, 0};
+    av1_inv_adst1d(t, 2, 16);
+    CHECK(t[0] == 1321 && t[1] == 2482 && t[2] == 3344 && t[3] == 3803);
+    return 0;
+}
+
+// ADST8/16 basis vectors: T[i] ~= X * sin(pi * (2i+1) * (2k+1) / 4N) for an impulse X at k.
+static int test_adst_basis(void) {
+    for (uint32_t n = 3; n <= 4; n++) {
+        const uint32_t n0 = 1u << n;
+        for (uint32_t k = 0; k < n0; k++) {
+            int32_t t[16] = {0};
+            t[k] = 32768;
+            av1_inv_adst1d(t, n, 20);
+            for (uint32_t i = 0; i < n0; i++) {
+                const double ref = 32768.0 * sin(3.14159265358979323846 * (2 * i + 1) * (2 * k + 1) / (4.0 * n0));
+                CHECK(fabs(ref - (double)t[i]) < 16.0);
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_lossless_wht_roundtrip(void) {
+    int32_t src[16];
+    int32_t coeffs[16];
+    int32_t res[16];
+    char err[256] = {0};
+    for (uint32_t it = 0; it < 256; it++) {
+        for (int k = 0; k < 16; k++) {
+            src[k] = (int32_t)(rng_next() % 511u) - 255;
+        }
+        fwht4x4(src, coeffs);
+        CHECK(av1_inv_txfm2d(coeffs, 0, AV1_TXFM_DCT_DCT, 8, true, NULL, res, err, sizeof(err)));
+        CHECK(memcmp(src, res, sizeof(src)) == 0);
+    }
+    // WHT is TX_4X4 only.
+    CHECK(!av1_inv_txfm2d(coeffs, 1, AV1_TXFM_DCT_DCT, 8, true, NULL, res, err, sizeof(err)));
+    return 0;
+}
+
+// The lossless fast path (Quant -> av1_dequant_lossless_coeff() -> av1_inv_wht4x4) matches
+// av1_dequant_coeff() with q = 4 followed by the generic lossless transform, including levels that
+// hit the Dequant clip and row outputs that hit colClampRange.
+static int test_lossless_fast_path(void) {
+    Av1InvWht4x4Fn kernels[2] = {av1_inv_wht4x4_c, av1_inv_wht4x4_kernel()};
+#if defined(AV1_TXFM_HAVE_X86)
+    if (av1_txfm_cpu_has_sse2()) {
+        kernels[1] = av1_inv_wht4x4_sse2;
+    }
+#endif
+    int32_t quant[16], dequant[16], levels[16], ref[16], out[16];
+    char err[256] = {0};
+    static const uint32_t kBitDepths[] = {8, 10, 12};
+    for (size_t bi = 0; bi < 3; bi++) {
+        const uint32_t bd = kBitDepths[bi];
+        for (uint32_t it = 0; it < 2000; it++) {
+            // Mostly in-range levels, some past the clip at 1 << ( 5 + BitDepth ).
+            const uint32_t bits = it % 4u == 3u ? bd + 8u : (it % 4u == 2u ? bd + 6u : 1u + rng_next() % (bd + 5u));
+            for (uint32_t k = 0; k < 16; k++) {
+                quant[k] = rng_next() % 3u ? rng_coeff(bits) : 0;
+                dequant[k] = av1_dequant_coeff(quant[k], 4, 0, bd);
+                levels[k] = av1_dequant_lossless_coeff(quant[k], bd);
+            }
+            CHECK(av1_inv_txfm2d(dequant, 0, AV1_TXFM_DCT_DCT, bd, true, NULL, ref, err, sizeof(err)));
+            for (size_t ki = 0; ki < 2; ki++) {
+                memset(out, 0x55, sizeof(out));
+                kernels[ki](levels, out, bd);
+                CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+            }
+        }
+    }
+    // Round trip through the forward WHT, whose output is Dequant = 4 * Quant.
+    int32_t src[16];
+    for (uint32_t it = 0; it < 256; it++) {
+        for (int k = 0; k < 16; k++) {
+            src[k] = (int32_t)(rng_next() % 511u) - 255;
+        }
+        fwht4x4(src, dequant);
+        for (int k = 0; k < 16; k++) {
+            levels[k] = av1_dequant_lossless_coeff(dequant[k] / 4, 8);
+        }
+        kernels[1](levels, out, 8);
+        CHECK(memcmp(src, out, sizeof(src)) == 0);
+    }
+    return 0;
+}
+
+static int test_flip_types(void) {
+    // FLIPADST_* is ADST with the output reversed in the flipped direction(s).
+    static const struct {
+        uint32_t flipped, plain;
+        bool ud, lr;
+    } kPairs[] = {
+        {AV1_TXFM_FLIPADST_DCT, AV1_TXFM_ADST_DCT, true, false},
+        {AV1_TXFM_DCT_FLIPADST, AV1_TXFM_DCT_ADST, false, true},
+        {AV1_TXFM_FLIPADST_FLIPADST, AV1_TXFM_ADST_ADST, true, true},
+        {AV1_TXFM_ADST_FLIPADST, AV1_TXFM_ADST_ADST, false, true},
+        {AV1_TXFM_FLIPADST_ADST, AV1_TXFM_ADST_ADST, true, false},
+        {AV1_TXFM_V_FLIPADST, AV1_TXFM_V_ADST, true, false},
+        {AV1_TXFM_H_FLIPADST, AV1_TXFM_H_ADST, false, true},
+    };
+    static int32_t coeffs[16 * 16];
+    static int32_t a[16 * 16];
+    static int32_t b[16 * 16];
+    char err[256] = {0};
+    const uint32_t tx_size = 7; // TX_8X16
+    const uint32_t w = 8;
+    const uint32_t h = 16;
+    for (uint32_t k = 0; k < w * h; k++) {
+        coeffs[k] = rng_coeff(10);
+    }
+    for (size_t pi = 0; pi < sizeof(kPairs) / sizeof(kPairs[0]); pi++) {
+        CHECK(av1_inv_txfm2d(coeffs, tx_size, kPairs[pi].flipped, 8, false, NULL, a, err, sizeof(err)));
+        CHECK(av1_inv_txfm2d(coeffs, tx_size, kPairs[pi].plain, 8, false, NULL, b, err, sizeof(err)));
+        for (uint32_t i = 0; i < h; i++) {
+            for (uint32_t j = 0; j < w; j++) {
+                const uint32_t yy = kPairs[pi].ud ? h - 1 - i : i;
+                const uint32_t xx = kPairs[pi].lr ? w - 1 - j : j;
+                CHECK(a[i * w + j] == b[yy * w + xx]);
+            }
+        }
+    }
+    return 0;
+}
+
+// Every kernel against the scalar reference, for every TxSize/TxType (and lossless), on random
+// coefficients over the full Dequant range of the bit depth the kernels serve.
+static int test_kernels_match_reference(void) {
+    static int32_t coeffs[64 * 64];
+    static int32_t ref[64 * 64];
+    static int32_t out[64 * 64];
+    char err[256] = {0};
+
+    typedef struct {
+        const char *name;
+        Av1InvTxfm2dKernel fn;
+    } Kernel;
+    Kernel kernels[2];
+    size_t nk = 0;
+#if defined(AV1_TXFM_HAVE_X86)
+    if (av1_txfm_cpu_has_sse2()) {
+        kernels[nk++] = (Kernel){"sse2", av1_inv_txfm2d_sse2};
+    }
+    if (av1_txfm_cpu_has_avx2()) {
+        kernels[nk++] = (Kernel){"avx2", av1_inv_txfm2d_avx2};
+    }
+#endif
+    if (nk == 0) {
+        return 0;
+    }
+
+    static const uint32_t kBitDepths[] = {8, 10};
+    for (size_t bi = 0; bi < sizeof(kBitDepths) / sizeof(kBitDepths[0]); bi++) {
+        const uint32_t bd = kBitDepths[bi];
+        for (uint32_t tx_size = 0; tx_size < AV1_TXFM_TX_SIZES_ALL; tx_size++) {
+            const uint32_t w = 1u << av1_txfm_width_log2(tx_size);
+            const uint32_t h = 1u << av1_txfm_height_log2(tx_size);
+            for (uint32_t tx_type = 0; tx_type <= AV1_TXFM_TYPES; tx_type++) {
+                // tx_type == AV1_TXFM_TYPES stands for the lossless WHT.
+                const bool lossless = tx_type == AV1_TXFM_TYPES;
+                Av1TxfmPlan plan;
+                if (!av1_txfm_plan_init(&plan, tx_size, lossless ? 0 : tx_type, bd, lossless, err, sizeof(err))) {
+                    continue;
+                }
+                for (uint32_t it = 0; it < 8; it++) {
+                    // Dense blocks with a random fill ratio, sometimes restricted to a sub-rectangle.
+                    Av1TxfmPlan p = plan;
+                    if (it & 1u) {
+                        p.rows = (uint8_t)(1u + rng_next() % p.rows);
+                        p.cols = (uint8_t)(1u + rng_next() % p.cols);
+                    }
+                    const uint32_t fill = 1u + rng_next() % 4u;
+                    memset(coeffs, 0, sizeof(coeffs));
+                    for (uint32_t i = 0; i < p.rows; i++) {
+                        for (uint32_t j = 0; j < p.cols; j++) {
+                            if (rng_next() % fill == 0) {
+                                coeffs[(size_t)i * w + j] = rng_coeff(bd + 8u);
+                            }
+                        }
+                    }
+                    av1_inv_txfm2d_c(coeffs, ref, &p);
+                    for (size_t ki = 0; ki < nk; ki++) {
+                        memset(out, 0x55, sizeof(out));
+                        kernels[ki].fn(coeffs, out, &p);
+                        if (memcmp(ref, out, (size_t)w * h * sizeof(int32_t)) != 0) {
+                            fprintf(stderr,
+                                    "FAIL: %s != reference (bd=%u tx_size=%u tx_type=%u lossless=%d it=%u)\n",
+                                    kernels[ki].name,
+                                    bd,
+                                    tx_size,
+                                    tx_type,
+                                    lossless,
+                                    it);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// The reduced-size dispatcher (plan kernels for DCT-class directions) against the scalar
+// reduced transform, every size, allowed type and scale.
+static int test_reduced_matches_reference(void) {
+    static int32_t coeffs[64 * 64];
+    static int32_t ref[64 * 64];
+    static int32_t out[64 * 64];
+    char err[256] = {0};
+    static const uint32_t kBitDepths[] = {8, 10, 12};
+    for (size_t bi = 0; bi < sizeof(kBitDepths) / sizeof(kBitDepths[0]); bi++) {
+        const uint32_t bd = kBitDepths[bi];
+        for (uint32_t tx_size = 0; tx_size < AV1_TXFM_TX_SIZES_ALL; tx_size++) {
+            const uint32_t w = 1u << av1_txfm_width_log2(tx_size);
+            const uint32_t h = 1u << av1_txfm_height_log2(tx_size);
+            for (uint32_t tx_type = 0; tx_type < AV1_TXFM_TYPES; tx_type++) {
+                if (!type_allowed(tx_size, tx_type)) {
+                    continue;
+                }
+                for (uint32_t s = 1; s <= 3; s++) {
+                    const uint32_t ow = w >> s ? w >> s : 1u;
+                    const uint32_t oh = h >> s ? h >> s : 1u;
+                    for (uint32_t it = 0; it < 4; it++) {
+                        const uint32_t fill = 1u + rng_next() % 4u;
+                        memset(coeffs, 0, sizeof(coeffs));
+                        for (uint32_t i = 0; i < h && i < 32u; i++) {
+                            for (uint32_t j = 0; j < w && j < 32u; j++) {
+                                if (rng_next() % fill == 0) {
+                                    coeffs[(size_t)i * w + j] = rng_coeff(bd + 8u);
+                                }
+                            }
+                        }
+                        CHECK(av1_inv_txfm2d_reduced_c(coeffs, tx_size, tx_type, bd, s, ref, err, sizeof(err)));
+                        memset(out, 0x55, sizeof(out));
+                        CHECK(av1_inv_txfm2d_reduced(coeffs, tx_size, tx_type, bd, s, out, err, sizeof(err)));
+                        if (memcmp(ref, out, (size_t)ow * oh * sizeof(int32_t)) != 0) {
+                            fprintf(stderr,
+                                    "FAIL: reduced != reference (bd=%u tx_size=%u tx_type=%u s=%u it=%u)\n",
+                                    bd,
+                                    tx_size,
+                                    tx_type,
+                                    s,
+                                    it);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_dc_only_4x4_kat();
+    rc |= test_sparse_matches_dense();
+    rc |= test_adst4_kat();
+    rc |= test_adst_basis();
+    rc |= test_lossless_wht_roundtrip();
+    rc |= test_lossless_fast_path();
+    rc |= test_flip_types();
+    rc |= test_kernels_match_reference();
+    rc |= test_reduced_matches_reference();
+    if (rc == 0) {
+        printf("inverse transform tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,412 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_loopfilter.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static const uint32_t kTxW[19] = {4, 8, 16, 32, 64, 4, 8, 8, 16, 16, 32, 32, 64, 4, 16, 8, 32, 16, 64};
+static const uint32_t kTxH[19] = {4, 8, 16, 32, 64, 8, 4, 16, 8, 32, 16, 64, 32, 16, 4, 32, 8, 64, 16};
+
+static int test_levels(void) {
+    // Spec 7.14.4 limits.
+    Av1LfLimits l;
+    av1_lf_limits(0, 0, &l);
+    CHECK(l.limit == 1 && l.blimit == 5 && l.thresh == 0);
+    av1_lf_limits(0, 40, &l);
+    CHECK(l.limit == 40 && l.blimit == 124 && l.thresh == 2);
+    av1_lf_limits(3, 40, &l);
+    CHECK(l.limit == 6 && l.blimit == 90);
+    av1_lf_limits(7, 63, &l);
+    CHECK(l.limit == 2 && l.blimit == 132 && l.thresh == 3);
+
+    // Spec 7.14.4 levels: delta_lf, segment feature, ref / mode deltas.
+    Av1LoopFilterParams p;
+    av1_lf_params_default(&p);
+    p.level[0] = 30;
+    p.level[1] = 20;
+    p.level[2] = 10;
+    p.level[3] = 5;
+    Av1LfMi mi;
+    memset(&mi, 0, sizeof(mi));
+    CHECK(av1_lf_level(&p, &mi, 0, 0) == 30 && av1_lf_level(&p, &mi, 0, 1) == 20);
+    CHECK(av1_lf_level(&p, &mi, 1, 0) == 10 && av1_lf_level(&p, &mi, 2, 1) == 5);
+    mi.delta_lf[0] = -40;
+    mi.delta_lf[2] = 3;
+    CHECK(av1_lf_level(&p, &mi, 1, 0) == 0);
+    p.delta_lf_multi = 1;
+    CHECK(av1_lf_level(&p, &mi, 0, 0) == 0 && av1_lf_level(&p, &mi, 1, 0) == 13);
+    memset(mi.delta_lf, 0, sizeof(mi.delta_lf));
+    mi.segment_id = 5;
+    p.seg_enabled[5][1] = 1;
+    p.seg_data[5][1] = 50;
+    CHECK(av1_lf_level(&p, &mi, 0, 1) == 63 && av1_lf_level(&p, &mi, 0, 0) == 30);
+    p.delta_enabled = 1;
+    // Intra: ref_deltas[ INTRA_FRAME ] = 1, shifted by lvl >> 5.
+    CHECK(av1_lf_level(&p, &mi, 0, 0) == 31);
+    mi.ref_frame = 4; // GOLDEN: -1
+    mi.mode_type = 1;
+    p.mode_deltas[1] = 2;
+    CHECK(av1_lf_level(&p, &mi, 0, 0) == 31);
+    CHECK(av1_lf_level(&p, &mi, 0, 1) == 63); // 63 + ( -1 << 1 ) + ( 2 << 1 ), clipped
+    return 0;
+}
+
+// The per-frame level table and the per-unit levels agree with av1_lf_level(), with and without
+// DeltaLF.
+static int test_level_table(void) {
+    srand(4242u);
+    for (uint32_t iter = 0; iter < 200; iter++) {
+        Av1LoopFilterParams p;
+        av1_lf_params_default(&p);
+        for (uint32_t k = 0; k < 4; k++) {
+            p.level[k] = (uint8_t)(rand() % 64);
+        }
+        p.delta_enabled = (uint8_t)(rand() % 2);
+        p.delta_lf_multi = (uint8_t)(rand() % 2);
+        for (uint32_t k = 0; k < 8; k++) {
+            p.ref_deltas[k] = (int8_t)(rand() % 127 - 63);
+        }
+        p.mode_deltas[0] = (int8_t)(rand() % 127 - 63);
+        p.mode_deltas[1] = (int8_t)(rand() % 127 - 63);
+        for (uint32_t s = 0; s < 8; s++) {
+            for (uint32_t k = 0; k < 4; k++) {
+                p.seg_enabled[s][k] = (uint8_t)(rand() % 2);
+                p.seg_data[s][k] = (int8_t)(rand() % 127 - 63);
+            }
+        }
+        Av1LfLevels t;
+        av1_lf_levels_init(&t, &p);
+        for (uint32_t n = 0; n < 64; n++) {
+            Av1LfMi mi;
+            memset(&mi, 0, sizeof(mi));
+            mi.segment_id = (uint8_t)(rand() % 8);
+            mi.ref_frame = (uint8_t)(rand() % 8);
+            mi.mode_type = (uint8_t)(rand() % 2);
+            if (n & 1u) {
+                for (uint32_t k = 0; k < 4; k++) {
+                    mi.delta_lf[k] = (int8_t)(rand() % 127 - 63);
+                }
+            }
+            av1_lf_mi_set_levels(&t, &mi);
+            CHECK(mi.lvl[0] == av1_lf_level(&p, &mi, 0, 0) && mi.lvl[1] == av1_lf_level(&p, &mi, 0, 1));
+            CHECK(mi.lvl[2] == av1_lf_level(&p, &mi, 1, 0) && mi.lvl[3] == av1_lf_level(&p, &mi, 2, 0));
+        }
+    }
+    return 0;
+}
+
+// Smooth blocks with small noise and occasional steps, so every filter path is taken.
+static uint8_t rand_px(uint32_t base, int32_t noise) {
+    const int32_t v = (int32_t)base + rand() % (2 * noise + 1) - noise;
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static int test_kernels(void) {
+    enum { W = 96, H = 96 };
+    static uint8_t ref[W * H], out[W * H];
+    Av1LoopFilterDsp c, best;
+    av1_lf_dsp_init_c(&c);
+    av1_lf_dsp_init(&best);
+    for (int iter = 0; iter < 400; iter++) {
+        const uint32_t lo = 20u + (uint32_t)(rand() % 200);
+        const uint32_t hi = lo + (uint32_t)(rand() % 24);
+        for (uint32_t i = 0; i < W * H; i++) {
+            ref[i] = rand_px((i % W + i / W) % 16 < 8 ? lo : hi, iter % 3);
+        }
+        memcpy(out, ref, sizeof(ref));
+        Av1LfLimits lim[8];
+        for (uint32_t k = 0; k < 8; k++) {
+            av1_lf_limits((uint32_t)(rand() % 8), (uint32_t)(rand() % 64), &lim[k]);
+        }
+        const uint32_t dir = (uint32_t)iter & 1u;
+        const uint32_t size = ((uint32_t)iter >> 1) % AV1_LF_SIZES;
+        const uint32_t n4 = 1u + (uint32_t)(rand() % 8);
+        const ptrdiff_t at = 40 * W + 40;
+        c.filter[dir][size](ref + at, W, lim, n4);
+        best.filter[dir][size](out + at, W, lim, n4);
+        CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+    }
+
+    // A small step across a horizontal edge is smoothed by the 8-tap filter; rows past p3 / q3 and
+    // columns past the segment stay untouched.
+    static uint8_t s[16 * 16];
+    for (uint32_t i = 0; i < 16 * 16; i++) {
+        s[i] = i / 16 < 8 ? 100 : 106;
+    }
+    Av1LfLimits lim;
+    av1_lf_limits(0, 32, &lim);
+    best.filter[AV1_LF_HORZ][AV1_LF_8](s + 8 * 16, 16, &lim, 1);
+    for (uint32_t x = 0; x < 4; x++) {
+        CHECK(s[7 * 16 + x] > 100 && s[8 * 16 + x] < 106 && s[7 * 16 + x] < s[8 * 16 + x]);
+        CHECK(s[4 * 16 + x] == 100 && s[11 * 16 + x] == 106);
+    }
+    CHECK(s[7 * 16 + 4] == 100 && s[8 * 16 + 4] == 106);
+    return 0;
+}
+
+// Spec 7.14.1 / 7.14.2 edge by edge, with the scalar kernels filtering one segment at a time.
+static void reference_filter(const Av1LoopFilter *lf) {
+    const Av1FrameBuf *fb = lf->fb;
+    Av1LoopFilterDsp c;
+    Av1LoopFilterDsp16 c16;
+    av1_lf_dsp_init_c(&c);
+    av1_lf_dsp_init_c_16(&c16, fb->bit_depth);
+    if (lf->params.level[0] == 0 && lf->params.level[1] == 0) {
+        return;
+    }
+    for (uint32_t plane = 0; plane < fb->num_planes; plane++) {
+        if (plane != 0 && lf->params.level[1 + plane] == 0) {
+            continue;
+        }
+        const uint32_t sx = plane ? lf->sub_x : 0u;
+        const uint32_t sy = plane ? lf->sub_y : 0u;
+        for (uint32_t pass = 0; pass < 2; pass++) {
+            for (uint32_t row0 = 0; row0 < lf->mi_rows; row0 += 1u << sy) {
+                for (uint32_t col0 = 0; col0 < lf->mi_cols; col0 += 1u << sx) {
+                    const uint32_t x = col0 * 4u, y = row0 * 4u;
+                    const uint32_t row = row0 | sy, col = col0 | sx;
+                    if (x >= fb->width || y >= fb->height || (pass == 0 && x == 0) || (pass == 1 && y == 0)) {
+                        continue;
+                    }
+                    const uint32_t xp = x >> sx, yp = y >> sy;
+                    const uint32_t prow = row - (pass << sy), pcol = col - ((1u - pass) << sx);
+                    const Av1LfMi *cur = &lf->mi[row * lf->mi_stride + col];
+                    const Av1LfMi *prev = &lf->mi[prow * lf->mi_stride + pcol];
+                    const uint32_t t = plane ? 1u : 0u;
+                    uint32_t bw = (4u << cur->bw4_log2) >> sx, bh = (4u << cur->bh4_log2) >> sy;
+                    bw = bw < 4u ? 4u : bw;
+                    bh = bh < 4u ? 4u : bh;
+                    const bool block_edge = pass == 0 ? xp % bw == 0 : yp % bh == 0;
+                    const bool tx_edge = pass == 0 ? xp % kTxW[cur->tx_size[t]] == 0 : yp % kTxH[cur->tx_size[t]] == 0;
+                    if (!tx_edge || !(block_edge || !cur->skip || cur->ref_frame == 0)) {
+                        continue;
+                    }
+                    const uint32_t *dim = pass == 0 ? kTxW : kTxH;
+                    uint32_t fs = dim[cur->tx_size[t]] < dim[prev->tx_size[t]] ? dim[cur->tx_size[t]] : dim[prev->tx_size[t]];
+                    fs = fs > (plane ? 8u : 16u) ? (plane ? 8u : 16u) : fs;
+                    uint32_t lvl = av1_lf_level(&lf->params, cur, plane, pass);
+                    if (lvl == 0) {
+                        lvl = av1_lf_level(&lf->params, prev, plane, pass);
+                    }
+                    if (lvl == 0) {
+                        continue;
+                    }
+                    const uint32_t size = fs == 4 ? AV1_LF_4 : (fs == 16 ? AV1_LF_14 : (plane ? AV1_LF_6 : AV1_LF_8));
+                    const ptrdiff_t off = (ptrdiff_t)yp * fb->stride[plane] + xp;
+                    if (fb->bytes_per_sample == 1) {
+                        c.filter[pass][size](av1_frame_plane_8(fb, plane) + off, fb->stride[plane], &lf->limits[lvl], 1);
+                    } else {
+                        c16.filter[pass][size](av1_frame_plane_16(fb, plane) + off, fb->stride[plane], &lf->limits[lvl], 1,
+                                               fb->bit_depth);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void fill_frame(Av1FrameBuf *fb) {
+    const uint32_t max = (1u << fb->bit_depth) - 1u;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t bh = fb->plane_h[p] + 2u * fb->border_y[p];
+        const uint32_t bw = fb->plane_w[p] + 2u * fb->border_x[p];
+        uint32_t block = 0;
+        for (uint32_t y = 0; y < bh; y++) {
+            for (uint32_t x = 0; x < bw; x++) {
+                if (x % 8 == 0) {
+                    block = (uint32_t)(rand() % (int)(max - 40u)) + 20u;
+                }
+                const uint32_t v = block + (uint32_t)(rand() % 5);
+                const ptrdiff_t off = ((ptrdiff_t)y - (ptrdiff_t)fb->border_y[p]) * fb->stride[p] + (ptrdiff_t)x - (ptrdiff_t)fb->border_x[p];
+                if (fb->bytes_per_sample == 1) {
+                    av1_frame_plane_8(fb, p)[off] = (uint8_t)v;
+                } else {
+                    av1_frame_plane_16(fb, p)[off] = (uint16_t)v;
+                }
+            }
+        }
+    }
+}
+
+static Av1LfMi *random_mi(uint32_t mi_rows, uint32_t mi_cols) {
+    Av1LfMi *mi = calloc((size_t)mi_rows * mi_cols, sizeof(*mi));
+    if (!mi) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < mi_rows * mi_cols; i++) {
+        mi[i].bw4_log2 = (uint8_t)(rand() % 5);
+        mi[i].bh4_log2 = (uint8_t)(rand() % 5);
+        mi[i].tx_size[0] = (uint8_t)(rand() % 19);
+        mi[i].tx_size[1] = (uint8_t)(rand() % 19);
+        mi[i].skip = (uint8_t)(rand() % 2);
+        mi[i].ref_frame = (uint8_t)(rand() % 3 == 0 ? 0 : rand() % 8);
+        mi[i].mode_type = (uint8_t)(rand() % 2);
+        mi[i].segment_id = (uint8_t)(rand() % 8);
+        mi[i].delta_lf[0] = (int8_t)(rand() % 9 - 4);
+    }
+    return mi;
+}
+
+static bool planes_equal(const Av1FrameBuf *a, const Av1FrameBuf *b) {
+    for (uint32_t p = 0; p < a->num_planes; p++) {
+        const size_t row = (size_t)a->plane_w[p] * a->bytes_per_sample;
+        for (uint32_t y = 0; y < a->plane_h[p]; y++) {
+            const size_t off = (size_t)y * (size_t)a->stride[p] * a->bytes_per_sample;
+            if (memcmp((const uint8_t *)a->plane[p] + off, (const uint8_t *)b->plane[p] + off, row) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int test_frame(void) {
+    static const uint32_t kCases[][4] = {
+        // width, height, layout, bit depth
+        {72, 40, AV1_LAYOUT_I420, 8},
+        {130, 70, AV1_LAYOUT_I444, 8},
+        {64, 64, AV1_LAYOUT_I422, 8},
+        {50, 66, AV1_LAYOUT_I420, 10},
+        {40, 24, AV1_LAYOUT_I400, 12},
+    };
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    char err[256];
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (int iter = 0; iter < 6; iter++) {
+            Av1FrameBuf *a, *b;
+            CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &a, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &b, err, sizeof(err)));
+            srand(1000u + (unsigned)(ci * 16 + (size_t)iter));
+            fill_frame(a);
+            srand(1000u + (unsigned)(ci * 16 + (size_t)iter));
+            fill_frame(b);
+
+            const uint32_t mi_rows = ((kCases[ci][1] + 7u) >> 3) << 1;
+            const uint32_t mi_cols = ((kCases[ci][0] + 7u) >> 3) << 1;
+            Av1LfMi *mi = random_mi(mi_rows, mi_cols);
+            CHECK(mi != NULL);
+            Av1LoopFilterParams p;
+            av1_lf_params_default(&p);
+            for (uint32_t k = 0; k < 4; k++) {
+                p.level[k] = (uint8_t)(iter == 1 && k == 0 ? 0 : rand() % 64);
+            }
+            p.level[3] = (uint8_t)(iter == 2 ? 0 : p.level[3]);
+            p.sharpness = (uint8_t)(rand() % 8);
+            p.delta_enabled = (uint8_t)(iter & 1);
+            p.mode_deltas[1] = 3;
+            p.seg_enabled[3][0] = 1;
+            p.seg_data[3][0] = -20;
+            av1_lf_fill_levels(&p, mi, mi_cols, mi_rows, mi_cols);
+
+            Av1LoopFilter lf;
+            CHECK(av1_lf_init(&lf, a, mi, mi_cols, mi_rows, mi_cols, &p, err, sizeof(err)));
+            av1_lf_filter_frame(&lf);
+            CHECK(av1_lf_init(&lf, b, mi, mi_cols, mi_rows, mi_cols, &p, err, sizeof(err)));
+            reference_filter(&lf);
+            CHECK(planes_equal(a, b));
+
+            free(mi);
+            av1_frame_pool_put(&pool, a);
+            av1_frame_pool_put(&pool, b);
+        }
+    }
+
+    // Borders narrower than the filter taps are rejected.
+    Av1FramePool narrow;
+    av1_frame_pool_init(&narrow, 4, 0);
+    Av1FrameBuf *fb;
+    CHECK(av1_frame_pool_get(&narrow, 16, 16, AV1_LAYOUT_I420, 8, &fb, err, sizeof(err)));
+    Av1LfMi mi[16];
+    memset(mi, 0, sizeof(mi));
+    Av1LoopFilterParams p;
+    av1_lf_params_default(&p);
+    Av1LoopFilter lf;
+    CHECK(!av1_lf_init(&lf, fb, mi, 4, 4, 4, &p, err, sizeof(err)));
+    av1_frame_pool_put(&narrow, fb);
+    av1_frame_pool_free(&narrow);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+static void mark_job(void *ctx, uint32_t job) {
+    ((uint32_t *)ctx)[job] += job + 1u;
+}
+
+// Row-parallel deblocking gives the single-threaded result.
+static int test_threads(void) {
+    static uint32_t marks[100];
+    char err[256];
+    Av1ThreadPool pool;
+    CHECK(av1_thread_pool_init(&pool, 4, err, sizeof(err)));
+    CHECK(pool.num_threads == 4);
+    for (int rep = 0; rep < 3; rep++) {
+        av1_thread_pool_run(&pool, mark_job, marks, 100);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        CHECK(marks[i] == 3u * (i + 1u));
+    }
+
+    static const uint32_t kCases[][4] = {
+        {700, 600, AV1_LAYOUT_I420, 8},
+        {300, 260, AV1_LAYOUT_I444, 10},
+    };
+    Av1FramePool frames;
+    av1_frame_pool_init(&frames, 16, 0);
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        Av1FrameBuf *a, *b;
+        CHECK(av1_frame_pool_get(&frames, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &a, err, sizeof(err)));
+        CHECK(av1_frame_pool_get(&frames, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &b, err, sizeof(err)));
+        srand(77u + (unsigned)ci);
+        fill_frame(a);
+        srand(77u + (unsigned)ci);
+        fill_frame(b);
+        const uint32_t mi_rows = ((kCases[ci][1] + 7u) >> 3) << 1;
+        const uint32_t mi_cols = ((kCases[ci][0] + 7u) >> 3) << 1;
+        Av1LfMi *mi = random_mi(mi_rows, mi_cols);
+        CHECK(mi != NULL);
+        Av1LoopFilterParams p;
+        av1_lf_params_default(&p);
+        p.level[0] = 40;
+        p.level[1] = 25;
+        p.level[2] = 30;
+        p.level[3] = 12;
+        p.delta_enabled = 1;
+        av1_lf_fill_levels(&p, mi, mi_cols, mi_rows, mi_cols);
+
+        Av1LoopFilter lf;
+        CHECK(av1_lf_init(&lf, a, mi, mi_cols, mi_rows, mi_cols, &p, err, sizeof(err)));
+        av1_lf_filter_frame(&lf);
+        CHECK(av1_lf_init(&lf, b, mi, mi_cols, mi_rows, mi_cols, &p, err, sizeof(err)));
+        av1_lf_filter_frame_mt(&lf, &pool);
+        CHECK(planes_equal(a, b));
+
+        free(mi);
+        av1_frame_pool_put(&frames, a);
+        av1_frame_pool_put(&frames, b);
+    }
+    av1_frame_pool_free(&frames);
+    av1_thread_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_levels();
+    rc |= test_level_table();
+    rc |= test_kernels();
+    rc |= test_frame();
+    rc |= test_threads();
+    if (rc == 0) {
+        printf("loopfilter tests: ok\n");
+    }
+    return rc;
+}
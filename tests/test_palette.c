@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_palette.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t rng_state = 0x2468ace1u;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// get_palette_color_context() as written in the spec.
+static void ref_color_context(const uint8_t *map, ptrdiff_t stride, uint32_t r, uint32_t c, uint32_t n, uint32_t *ctx, uint8_t *order) {
+    static const int kHashMultipliers[3] = {1, 2, 2};
+    static const int kColorContext[9] = {-1, -1, 0, -1, -1, 4, 3, 2, 1};
+    int scores[AV1_PALETTE_MAX_COLORS];
+    uint8_t color_order[AV1_PALETTE_MAX_COLORS];
+    for (uint32_t i = 0; i < AV1_PALETTE_MAX_COLORS; i++) {
+        scores[i] = 0;
+        color_order[i] = (uint8_t)i;
+    }
+    if (c > 0) {
+        scores[map[r * stride + c - 1]] += 2;
+    }
+    if (r > 0 && c > 0) {
+        scores[map[(r - 1) * stride + c - 1]] += 1;
+    }
+    if (r > 0) {
+        scores[map[(r - 1) * stride + c]] += 2;
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        int max_score = scores[i];
+        uint32_t max_idx = i;
+        for (uint32_t j = i + 1; j < AV1_PALETTE_MAX_COLORS; j++) {
+            if (scores[j] > max_score) {
+                max_score = scores[j];
+                max_idx = j;
+            }
+        }
+        if (max_idx != i) {
+            const int s = scores[max_idx];
+            const uint8_t o = color_order[max_idx];
+            for (uint32_t k = max_idx; k > i; k--) {
+                scores[k] = scores[k - 1];
+                color_order[k] = color_order[k - 1];
+            }
+            scores[i] = s;
+            color_order[i] = o;
+        }
+    }
+    int hash = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        hash += scores[i] * kHashMultipliers[i];
+    }
+    *ctx = (uint32_t)kColorContext[hash];
+    memcpy(order, color_order, n);
+}
+
+// Every neighbor triple for every palette size, at interior and edge positions.
+static int test_diag_contexts_exhaustive(void) {
+    uint8_t map[3 * AV1_PALETTE_MAX_DIM];
+    const ptrdiff_t stride = AV1_PALETTE_MAX_DIM;
+    Av1PaletteDiag d;
+    for (uint32_t n = 2; n <= AV1_PALETTE_MAX_COLORS; n++) {
+        for (uint32_t left = 0; left < n; left++) {
+            for (uint32_t top = 0; top < n; top++) {
+                for (uint32_t top_left = 0; top_left < n; top_left++) {
+                    // 2x2 map: diagonal 2 is the single position (1, 1).
+                    memset(map, 0, sizeof(map));
+                    map[0] = (uint8_t)top_left;
+                    map[1] = (uint8_t)top;
+                    map[stride] = (uint8_t)left;
+                    av1_palette_diag_contexts(map, stride, 2, 2, 2, n, &d);
+                    CHECK(d.count == 1u && d.row[0] == 1u && d.col[0] == 1u);
+                    uint32_t ctx = 0;
+                    uint8_t order[AV1_PALETTE_MAX_COLORS];
+                    ref_color_context(map, stride, 1, 1, n, &ctx, order);
+                    CHECK(d.ctx[0] == ctx);
+                    CHECK(memcmp(d.order[0], order, n) == 0);
+                }
+                // Edges: diagonal 1 of a 2x2 map is (0, 1) then (1, 0).
+                memset(map, 0, sizeof(map));
+                map[0] = (uint8_t)left;
+                av1_palette_diag_contexts(map, stride, 1, 2, 2, n, &d);
+                CHECK(d.count == 2u && d.row[0] == 0u && d.col[0] == 1u && d.row[1] == 1u && d.col[1] == 0u);
+                for (uint32_t k = 0; k < 2; k++) {
+                    uint32_t ctx = 0;
+                    uint8_t order[AV1_PALETTE_MAX_COLORS];
+                    ref_color_context(map, stride, d.row[k], d.col[k], n, &ctx, order);
+                    CHECK(d.ctx[k] == ctx);
+                    CHECK(memcmp(d.order[k], order, n) == 0);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Wavefront over random maps: each diagonal is computed before its indices are filled in, the
+// way palette_tokens() uses it, and must visit positions in the spec order.
+static int test_diag_wavefront(void) {
+    static const uint32_t kDims[][2] = {{4, 4}, {8, 4}, {4, 16}, {16, 16}, {12, 20}, {64, 64}, {6, 4}, {64, 8}};
+    uint8_t map[AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM];
+    const ptrdiff_t stride = AV1_PALETTE_MAX_DIM;
+    Av1PaletteDiag d;
+    for (size_t t = 0; t < sizeof(kDims) / sizeof(kDims[0]); t++) {
+        const uint32_t w = kDims[t][0], h = kDims[t][1];
+        for (uint32_t n = 2; n <= AV1_PALETTE_MAX_COLORS; n++) {
+            memset(map, 0xff, sizeof(map));
+            map[0] = (uint8_t)(rng() % n);
+            for (uint32_t i = 1; i < w + h - 1; i++) {
+                av1_palette_diag_contexts(map, stride, i, w, h, n, &d);
+                uint32_t k = 0;
+                for (int32_t j = (int32_t)(i < w - 1 ? i : w - 1); j >= (int32_t)(i + 1 > h ? i + 1 - h : 0); j--, k++) {
+                    CHECK(k < d.count);
+                    CHECK(d.row[k] == i - (uint32_t)j && d.col[k] == (uint32_t)j);
+                    uint32_t ctx = 0;
+                    uint8_t order[AV1_PALETTE_MAX_COLORS];
+                    ref_color_context(map, stride, d.row[k], d.col[k], n, &ctx, order);
+                    CHECK(d.ctx[k] == ctx);
+                    CHECK(memcmp(d.order[k], order, n) == 0);
+                }
+                CHECK(k == d.count);
+                // Runs of equal indices are common in screen content: bias toward the order head.
+                for (k = 0; k < d.count; k++) {
+                    const uint32_t sym = (rng() & 3u) ? 0u : rng() % n;
+                    map[d.row[k] * stride + d.col[k]] = d.order[k][sym];
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// get_palette_cache() merge as written in the spec.
+static uint32_t ref_cache(const uint16_t *above, uint32_t above_n, const uint16_t *left, uint32_t left_n, uint16_t *cache) {
+    uint32_t a = 0, l = 0, n = 0;
+    while (a < above_n && l < left_n) {
+        const uint16_t above_c = above[a], left_c = left[l];
+        if (left_c < above_c) {
+            if (n == 0 || left_c != cache[n - 1]) {
+                cache[n++] = left_c;
+            }
+            l++;
+        } else {
+            if (n == 0 || above_c != cache[n - 1]) {
+                cache[n++] = above_c;
+            }
+            a++;
+            if (left_c == above_c) {
+                l++;
+            }
+        }
+    }
+    for (; a < above_n; a++) {
+        if (n == 0 || above[a] != cache[n - 1]) {
+            cache[n++] = above[a];
+        }
+    }
+    for (; l < left_n; l++) {
+        if (n == 0 || left[l] != cache[n - 1]) {
+            cache[n++] = left[l];
+        }
+    }
+    return n;
+}
+
+static int test_cache_and_sort(void) {
+    for (uint32_t iter = 0; iter < 20000; iter++) {
+        uint16_t above[AV1_PALETTE_MAX_COLORS], left[AV1_PALETTE_MAX_COLORS];
+        const uint32_t above_n = iter % 9u, left_n = (iter / 9u) % 9u;
+        const uint32_t range = 1u + rng() % 16u; // small ranges force duplicates
+        for (uint32_t i = 0; i < above_n; i++) {
+            above[i] = (uint16_t)(rng() % range);
+        }
+        for (uint32_t i = 0; i < left_n; i++) {
+            left[i] = (uint16_t)(rng() % range);
+        }
+        av1_palette_sort(above, above_n);
+        av1_palette_sort(left, left_n);
+        for (uint32_t i = 1; i < above_n; i++) {
+            CHECK(above[i - 1] <= above[i]);
+        }
+        uint16_t got[2 * AV1_PALETTE_MAX_COLORS], want[2 * AV1_PALETTE_MAX_COLORS];
+        const uint32_t got_n = av1_palette_cache(above, above_n, left, left_n, got);
+        const uint32_t want_n = ref_cache(above, above_n, left, left_n, want);
+        CHECK(got_n == want_n);
+        CHECK(memcmp(got, want, got_n * sizeof(uint16_t)) == 0);
+    }
+    return 0;
+}
+
+static int test_extend_map(void) {
+    uint8_t map[AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM];
+    const ptrdiff_t stride = AV1_PALETTE_MAX_DIM;
+    const uint32_t w = 16, h = 8, ow = 5, oh = 3;
+    for (uint32_t i = 0; i < sizeof(map); i++) {
+        map[i] = (uint8_t)(rng() & 7u);
+    }
+    uint8_t orig[AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM];
+    memcpy(orig, map, sizeof(map));
+    av1_palette_extend_map(map, stride, ow, oh, w, h);
+    for (uint32_t i = 0; i < h; i++) {
+        for (uint32_t j = 0; j < w; j++) {
+            const uint32_t si = i < oh ? i : oh - 1, sj = j < ow ? j : ow - 1;
+            CHECK(map[i * stride + j] == orig[si * stride + sj]);
+        }
+        CHECK(map[i * stride + w] == orig[i * stride + w]);
+    }
+    return 0;
+}
+
+// The selected table against the scalar one, both pixel types, every transform width / height.
+static int test_pred_dsp(void) {
+    Av1PaletteDsp c, dsp;
+    av1_palette_dsp_init_c(&c);
+    av1_palette_dsp_init(&dsp);
+    static const uint32_t kDims[] = {4, 8, 16, 32, 64};
+    enum { STRIDE = 80 };
+    uint8_t map[AV1_PALETTE_MAX_DIM * AV1_PALETTE_MAX_DIM];
+    uint8_t a8[STRIDE * 64], b8[STRIDE * 64];
+    uint16_t a16[STRIDE * 64], b16[STRIDE * 64];
+    for (uint32_t wi = 0; wi < 5; wi++) {
+        for (uint32_t hi = 0; hi < 5; hi++) {
+            const uint32_t w = kDims[wi], h = kDims[hi];
+            for (uint32_t n = 2; n <= AV1_PALETTE_MAX_COLORS; n++) {
+                uint16_t pal8[AV1_PALETTE_MAX_COLORS], pal12[AV1_PALETTE_MAX_COLORS];
+                for (uint32_t i = 0; i < AV1_PALETTE_MAX_COLORS; i++) {
+                    pal8[i] = (uint16_t)(rng() & 255u);
+                    pal12[i] = (uint16_t)(rng() & 4095u);
+                }
+                for (uint32_t i = 0; i < sizeof(map); i++) {
+                    map[i] = (uint8_t)(rng() % n);
+                }
+                memset(a8, 0x5a, sizeof(a8));
+                memset(b8, 0x5a, sizeof(b8));
+                c.pred(a8, STRIDE, pal8, map, AV1_PALETTE_MAX_DIM, w, h);
+                dsp.pred(b8, STRIDE, pal8, map, AV1_PALETTE_MAX_DIM, w, h);
+                CHECK(memcmp(a8, b8, sizeof(a8)) == 0);
+                CHECK(a8[0] == pal8[map[0]] && a8[STRIDE + w - 1] == pal8[map[AV1_PALETTE_MAX_DIM + w - 1]]);
+                memset(a16, 0x5a, sizeof(a16));
+                memset(b16, 0x5a, sizeof(b16));
+                c.pred16(a16, STRIDE, pal12, map, AV1_PALETTE_MAX_DIM, w, h);
+                dsp.pred16(b16, STRIDE, pal12, map, AV1_PALETTE_MAX_DIM, w, h);
+                CHECK(memcmp(a16, b16, sizeof(a16)) == 0);
+                CHECK(a16[(h - 1) * STRIDE] == pal12[map[(h - 1) * AV1_PALETTE_MAX_DIM]]);
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_diag_contexts_exhaustive();
+    rc |= test_diag_wavefront();
+    rc |= test_cache_and_sort();
+    rc |= test_extend_map();
+    rc |= test_pred_dsp();
+    if (rc == 0) {
+        printf("palette tests: ok\n");
+    }
+    return rc;
+}
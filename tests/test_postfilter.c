@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_postfilter.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static const int32_t kSecStrengths[4] = {0, 1, 2, 4};
+static const int32_t kWienerMin[3] = {-5, -23, -17};
+static const int32_t kWienerMax[3] = {10, 8, 46};
+static const int32_t kXqdMin[2] = {-96, -32};
+static const int32_t kXqdMax[2] = {31, 95};
+
+static int32_t rand_range(int32_t lo, int32_t hi) {
+    return lo + rand() % (hi - lo + 1);
+}
+
+// Blocks of 8 similar samples, so deblocking and CDEF both have something to do.
+static void fill_frame(Av1FrameBuf *fb) {
+    const uint32_t max = (1u << fb->bit_depth) - 1u;
+    for (uint32_t p = 0; p < fb->num_planes; p++) {
+        const uint32_t bh = fb->plane_h[p] + 2u * fb->border_y[p];
+        const uint32_t bw = fb->plane_w[p] + 2u * fb->border_x[p];
+        uint32_t block = 0;
+        for (uint32_t y = 0; y < bh; y++) {
+            for (uint32_t x = 0; x < bw; x++) {
+                if (x % 8 == 0) {
+                    block = (uint32_t)(rand() % (int)(max - 40u)) + 20u;
+                }
+                const uint32_t v = block + (uint32_t)(rand() % 5);
+                const ptrdiff_t off = ((ptrdiff_t)y - (ptrdiff_t)fb->border_y[p]) * fb->stride[p] + (ptrdiff_t)x - (ptrdiff_t)fb->border_x[p];
+                if (fb->bytes_per_sample == 1) {
+                    av1_frame_plane_8(fb, p)[off] = (uint8_t)v;
+                } else {
+                    av1_frame_plane_16(fb, p)[off] = (uint16_t)v;
+                }
+            }
+        }
+    }
+}
+
+static uint32_t sub_x(const Av1FrameBuf *fb) {
+    return fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+}
+
+static uint32_t sub_y(const Av1FrameBuf *fb) {
+    return fb->layout == AV1_LAYOUT_I420;
+}
+
+// Copies plane rows y0 .. y1 - 1 including the left / right borders (-border_y .. plane_h +
+// border_y - 1 are valid).
+static void copy_rows(Av1FrameBuf *dst, const Av1FrameBuf *src, uint32_t p, int32_t y0, int32_t y1) {
+    const size_t bytes = (size_t)(dst->plane_w[p] + 2u * dst->border_x[p]) * dst->bytes_per_sample;
+    for (int32_t y = y0; y < y1; y++) {
+        const ptrdiff_t off = ((ptrdiff_t)y * src->stride[p] - (ptrdiff_t)src->border_x[p]) * (ptrdiff_t)src->bytes_per_sample;
+        memcpy((uint8_t *)dst->plane[p] + off, (const uint8_t *)src->plane[p] + off, bytes);
+    }
+}
+
+static bool rows_equal(const Av1FrameBuf *a, const Av1FrameBuf *b, uint32_t p, uint32_t y, uint32_t w) {
+    const size_t off = (size_t)y * (size_t)a->stride[p] * a->bytes_per_sample;
+    return memcmp((const uint8_t *)a->plane[p] + off, (const uint8_t *)b->plane[p] + off, (size_t)w * a->bytes_per_sample) == 0;
+}
+
+// Compares the MI area (which reaches into the right / bottom border).
+static bool planes_equal(const Av1FrameBuf *a, const Av1FrameBuf *b, uint32_t mi_rows, uint32_t mi_cols) {
+    for (uint32_t p = 0; p < a->num_planes; p++) {
+        const uint32_t w = (mi_cols * 4u) >> (p ? sub_x(a) : 0u), h = (mi_rows * 4u) >> (p ? sub_y(a) : 0u);
+        for (uint32_t y = 0; y < h; y++) {
+            if (!rows_equal(a, b, p, y, w)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// "Reconstruction": copies superblock row r from src, after checking that the rows above it
+// are still unfiltered (the bottom row of row r - 1 feeds intra prediction).
+typedef struct {
+    Av1FrameBuf *dst;
+    const Av1FrameBuf *src;
+    uint32_t rows;
+    uint8_t bad[AV1_PF_MAX_ROWS];
+} ReconCtx;
+
+static void recon_row(void *ctx, uint32_t r) {
+    ReconCtx *rc = (ReconCtx *)ctx;
+    for (uint32_t p = 0; p < rc->dst->num_planes; p++) {
+        const uint32_t sy = p ? sub_y(rc->dst) : 0u;
+        const int32_t y0 = r ? (int32_t)((r * 64u) >> sy) : -(int32_t)rc->dst->border_y[p];
+        const int32_t y1 = r + 1u < rc->rows ? (int32_t)(((r + 1u) * 64u) >> sy) : (int32_t)(rc->dst->plane_h[p] + rc->dst->border_y[p]);
+        if (r && !rows_equal(rc->dst, rc->src, p, (uint32_t)y0 - 1u, rc->dst->plane_w[p])) {
+            rc->bad[r] = 1;
+        }
+        copy_rows(rc->dst, rc->src, p, y0, y1);
+    }
+}
+
+static void random_cdef_params(Av1CdefParams *p) {
+    av1_cdef_params_default(p);
+    p->damping = (uint8_t)(3 + rand() % 4);
+    p->bits = 2;
+    for (uint32_t i = 0; i < 4; i++) {
+        p->y_pri[i] = (uint8_t)(rand() % 16);
+        p->y_sec[i] = (uint8_t)kSecStrengths[rand() % 4];
+        p->uv_pri[i] = (uint8_t)(rand() % 16);
+        p->uv_sec[i] = (uint8_t)kSecStrengths[rand() % 4];
+    }
+}
+
+static void random_lr_unit(Av1LrUnit *u, bool chroma) {
+    u->type = (uint8_t)(rand() % 3 == 0 ? AV1_RESTORE_NONE : rand() % 2 ? AV1_RESTORE_WIENER : AV1_RESTORE_SGRPROJ);
+    u->sgr_set = (uint8_t)(rand() % 16);
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t k = 0; k < 3; k++) {
+            u->wiener[pass][k] = (int8_t)(chroma && k == 0 ? 0 : rand_range(kWienerMin[k], kWienerMax[k]));
+        }
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        u->sgr_xqd[i] = (int16_t)rand_range(kXqdMin[i], kXqdMax[i]);
+    }
+}
+
+static void random_grain_params(Av1FilmGrainParams *pa, bool mono) {
+    memset(pa, 0, sizeof(*pa));
+    pa->apply_grain = 1;
+    pa->update_grain = 1;
+    pa->grain_seed = (uint16_t)rand();
+    pa->num_y_points = 3;
+    pa->num_cb_points = mono ? 0 : 2;
+    pa->num_cr_points = mono ? 0 : 1;
+    for (uint32_t i = 0; i < 3; i++) {
+        pa->point_y_value[i] = (uint8_t)(40u + 80u * i);
+        pa->point_y_scaling[i] = (uint8_t)rand_range(20, 200);
+        pa->point_cb_value[i] = (uint8_t)(60u * i);
+        pa->point_cb_scaling[i] = (uint8_t)rand_range(20, 200);
+        pa->point_cr_value[i] = (uint8_t)(100u + i);
+        pa->point_cr_scaling[i] = (uint8_t)rand_range(20, 200);
+    }
+    pa->grain_scaling = 9;
+    pa->ar_coeff_lag = 2;
+    for (uint32_t i = 0; i < AV1_FG_MAX_AR_COEFFS; i++) {
+        pa->ar_coeffs_y[i % (AV1_FG_MAX_AR_COEFFS - 1u)] = (int8_t)rand_range(-20, 20);
+        pa->ar_coeffs_cb[i] = (int8_t)rand_range(-20, 20);
+        pa->ar_coeffs_cr[i] = (int8_t)rand_range(-20, 20);
+    }
+    pa->ar_coeff_shift = 7;
+    pa->cb_mult = (int16_t)rand_range(-128, 127);
+    pa->cb_luma_mult = (int16_t)rand_range(-128, 127);
+    pa->cb_offset = (int16_t)rand_range(-256, 255);
+    pa->cr_mult = (int16_t)rand_range(-128, 127);
+    pa->cr_luma_mult = (int16_t)rand_range(-128, 127);
+    pa->cr_offset = (int16_t)rand_range(-256, 255);
+    pa->overlap_flag = 1;
+    pa->clip_to_restricted_range = (uint8_t)(rand() % 2);
+}
+
+// Reconstruction interleaved with the pipelined chain (ring line buffers, 1 or 4 threads) gives
+// deblocking, CDEF, superres, loop restoration and film grain run one after the other on the
+// whole frame.
+static int test_pipeline(void) {
+    static const uint32_t kCases[][5] = {
+        // (upscaled) width, height, layout, bit depth, superres denominator (0: none)
+        {200, 300, AV1_LAYOUT_I420, 8, 0},
+        {180, 600, AV1_LAYOUT_I420, 8, 0},
+        {130, 512, AV1_LAYOUT_I444, 10, 0},
+        {96, 200, AV1_LAYOUT_I422, 8, 0},
+        {150, 330, AV1_LAYOUT_I400, 12, 0},
+        {70, 40, AV1_LAYOUT_I420, 8, 0},
+        {300, 400, AV1_LAYOUT_I420, 8, 16},
+        {170, 270, AV1_LAYOUT_I444, 10, 11},
+    };
+    char err[256];
+    Av1ThreadPool threads;
+    CHECK(av1_thread_pool_init(&threads, 4, err, sizeof(err)));
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    Av1FilmGrain *fg = malloc(sizeof(*fg));
+    CHECK(fg != NULL);
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (int iter = 0; iter < 4; iter++) {
+            srand(4000u + (unsigned)(ci * 16 + (size_t)iter));
+            const uint32_t denom = kCases[ci][4];
+            const uint32_t width = denom ? av1_superres_coded_width(kCases[ci][0], denom) : kCases[ci][0];
+            Av1FrameBuf *src, *ref, *dut, *ref_up = NULL, *dut_up = NULL;
+            CHECK(av1_frame_pool_get(&pool, width, kCases[ci][1], kCases[ci][2], kCases[ci][3], &src, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, width, kCases[ci][1], kCases[ci][2], kCases[ci][3], &ref, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, width, kCases[ci][1], kCases[ci][2], kCases[ci][3], &dut, err, sizeof(err)));
+            if (denom) {
+                CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &ref_up, err, sizeof(err)));
+                CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], kCases[ci][3], &dut_up, err, sizeof(err)));
+            }
+            // Loop restoration runs on the upscaled frame.
+            Av1FrameBuf *ref_lr = denom ? ref_up : ref, *dut_lr = denom ? dut_up : dut;
+            fill_frame(src);
+            fill_frame(dut); // overwritten row by row
+            const uint32_t rows = (src->height + 63u) / 64u;
+            for (uint32_t p = 0; p < src->num_planes; p++) {
+                copy_rows(ref, src, p, -(int32_t)src->border_y[p], (int32_t)(src->plane_h[p] + src->border_y[p]));
+            }
+
+            const uint32_t mi_rows = ((kCases[ci][1] + 7u) >> 3) << 1;
+            const uint32_t mi_cols = ((width + 7u) >> 3) << 1;
+            Av1LfMi *mi = calloc((size_t)mi_rows * mi_cols, sizeof(*mi));
+            uint8_t *skip = malloc((size_t)mi_rows * mi_cols);
+            const uint32_t rows64 = (mi_rows + 15u) >> 4, cols64 = (mi_cols + 15u) >> 4;
+            int8_t *idx = malloc((size_t)rows64 * cols64);
+            CHECK(mi != NULL && skip != NULL && idx != NULL);
+            for (uint32_t i = 0; i < mi_rows * mi_cols; i++) {
+                mi[i].bw4_log2 = (uint8_t)(rand() % 5);
+                mi[i].bh4_log2 = (uint8_t)(rand() % 5);
+                mi[i].tx_size[0] = (uint8_t)(rand() % 19);
+                mi[i].tx_size[1] = (uint8_t)(rand() % 19);
+                mi[i].skip = (uint8_t)(rand() % 2);
+                mi[i].ref_frame = (uint8_t)(rand() % 3 == 0 ? 0 : rand() % 8);
+                skip[i] = mi[i].skip;
+            }
+            for (uint32_t i = 0; i < rows64 * cols64; i++) {
+                idx[i] = (int8_t)(rand() % 5 - 1);
+            }
+            Av1LoopFilterParams lfp;
+            av1_lf_params_default(&lfp);
+            for (uint32_t k = 0; k < 4; k++) {
+                lfp.level[k] = (uint8_t)(10 + rand() % 40);
+            }
+            av1_lf_fill_levels(&lfp, mi, mi_cols, mi_rows, mi_cols);
+            Av1CdefParams cp;
+            random_cdef_params(&cp);
+            Av1LrParams lrp;
+            av1_lr_params_default(&lrp);
+            Av1LrUnit *units[3] = {NULL, NULL, NULL};
+            for (uint32_t p = 0; p < src->num_planes; p++) {
+                lrp.frame_type[p] = AV1_RESTORE_SWITCHABLE;
+                lrp.unit_size[p] = (uint16_t)(64u << (rand() % 2));
+                const uint32_t n = av1_lr_unit_count(lrp.unit_size[p], ref_lr->plane_h[p]) * av1_lr_unit_count(lrp.unit_size[p], ref_lr->plane_w[p]);
+                units[p] = malloc(n * sizeof(Av1LrUnit));
+                CHECK(units[p] != NULL);
+                for (uint32_t i = 0; i < n; i++) {
+                    random_lr_unit(&units[p][i], p != 0);
+                }
+            }
+            const Av1LrUnit *const cunits[3] = {units[0], units[1], units[2]};
+            // iter 2 runs without CDEF, iter 3 without loop restoration; iters 0 and 3 add grain.
+            const bool use_cdef = iter != 2, use_lr = iter != 3, use_grain = iter == 0 || iter == 3;
+            Av1FilmGrainParams fgp;
+            random_grain_params(&fgp, src->num_planes == 1u);
+            Av1FrameBuf *ref_out = NULL, *dut_out = NULL;
+            if (use_grain) {
+                CHECK(av1_frame_pool_get(&pool, ref_lr->width, ref_lr->height, ref_lr->layout, ref_lr->bit_depth, &ref_out, err, sizeof(err)));
+                CHECK(av1_frame_pool_get(&pool, ref_lr->width, ref_lr->height, ref_lr->layout, ref_lr->bit_depth, &dut_out, err, sizeof(err)));
+            }
+
+            Av1LoopFilter lf;
+            Av1Cdef cdef;
+            Av1Superres sr;
+            Av1Lr lr;
+            CHECK(av1_lf_init(&lf, ref, mi, mi_cols, mi_rows, mi_cols, &lfp, err, sizeof(err)));
+            av1_lf_filter_frame(&lf);
+            CHECK(av1_cdef_init(&cdef, ref, skip, mi_cols, idx, cols64, mi_rows, mi_cols, &cp, err, sizeof(err)));
+            CHECK(!denom || av1_superres_init(&sr, ref_up, ref, mi_cols, err, sizeof(err)));
+            CHECK(av1_lr_init(&lr, ref_lr, &lrp, cunits, err, sizeof(err)));
+            if (use_lr) {
+                // Boundary rows come from the upscaled pre-CDEF frame.
+                if (denom) {
+                    av1_superres_filter_frame(&sr);
+                }
+                for (uint32_t b = 1; b < lr.num_stripes; b++) {
+                    av1_lr_save_lines(&lr, b);
+                }
+            }
+            if (use_cdef) {
+                av1_cdef_filter_frame(&cdef);
+            }
+            if (denom) {
+                av1_superres_filter_frame(&sr);
+            }
+            if (use_lr) {
+                av1_lr_filter_frame(&lr);
+            }
+            if (use_grain) {
+                CHECK(av1_film_grain_init(fg, ref_out, ref_lr, &fgp, false, err, sizeof(err)));
+                av1_film_grain_apply_frame(fg);
+            }
+            av1_cdef_free(&cdef);
+            av1_lr_free(&lr);
+
+            // Odd iterations run on the caller, even ones on four threads.
+            ReconCtx rc;
+            memset(&rc, 0, sizeof(rc));
+            rc.dst = dut;
+            rc.src = src;
+            rc.rows = rows;
+            CHECK(av1_lf_init(&lf, dut, mi, mi_cols, mi_rows, mi_cols, &lfp, err, sizeof(err)));
+            CHECK(av1_cdef_init(&cdef, dut, skip, mi_cols, idx, cols64, mi_rows, mi_cols, &cp, err, sizeof(err)));
+            CHECK(!denom || av1_superres_init(&sr, dut_up, dut, mi_cols, err, sizeof(err)));
+            CHECK(av1_lr_init(&lr, dut_lr, &lrp, cunits, err, sizeof(err)));
+            CHECK(!use_grain || av1_film_grain_init(fg, dut_out, dut_lr, &fgp, false, err, sizeof(err)));
+            Av1PostFilter pf;
+            CHECK(av1_postfilter_init(&pf,
+                                      dut,
+                                      &lf,
+                                      use_cdef ? &cdef : NULL,
+                                      denom ? &sr : NULL,
+                                      use_lr ? &lr : NULL,
+                                      use_grain ? fg : NULL,
+                                      err,
+                                      sizeof(err)));
+            CHECK(pf.rows == rows);
+            CHECK(cdef.line_slots <= AV1_PF_LINE_SLOTS || !use_cdef);
+            CHECK(lr.line_slots <= AV1_PF_LINE_SLOTS || !use_lr);
+            av1_postfilter_run(&pf, iter & 1 ? NULL : &threads, recon_row, &rc);
+            av1_postfilter_free(&pf);
+            av1_cdef_free(&cdef);
+            av1_lr_free(&lr);
+            for (uint32_t r = 0; r < rows; r++) {
+                CHECK(!rc.bad[r]);
+            }
+            CHECK(planes_equal(dut, ref, mi_rows, mi_cols));
+            if (denom) {
+                for (uint32_t p = 0; p < dut_up->num_planes; p++) {
+                    for (uint32_t y = 0; y < dut_up->plane_h[p]; y++) {
+                        CHECK(rows_equal(dut_up, ref_up, p, y, dut_up->plane_w[p]));
+                    }
+                }
+                av1_frame_pool_put(&pool, ref_up);
+                av1_frame_pool_put(&pool, dut_up);
+            }
+            if (use_grain) {
+                for (uint32_t p = 0; p < dut_out->num_planes; p++) {
+                    for (uint32_t y = 0; y < dut_out->plane_h[p]; y++) {
+                        CHECK(rows_equal(dut_out, ref_out, p, y, dut_out->plane_w[p]));
+                    }
+                }
+                av1_frame_pool_put(&pool, ref_out);
+                av1_frame_pool_put(&pool, dut_out);
+            }
+
+            for (uint32_t p = 0; p < 3; p++) {
+                free(units[p]);
+            }
+            free(mi);
+            free(skip);
+            free(idx);
+            av1_frame_pool_put(&pool, src);
+            av1_frame_pool_put(&pool, ref);
+            av1_frame_pool_put(&pool, dut);
+        }
+    }
+
+    // Stages bound to another frame are rejected.
+    Av1FrameBuf *a, *b;
+    CHECK(av1_frame_pool_get(&pool, 64, 64, AV1_LAYOUT_I420, 8, &a, err, sizeof(err)));
+    CHECK(av1_frame_pool_get(&pool, 64, 64, AV1_LAYOUT_I420, 8, &b, err, sizeof(err)));
+    Av1LfMi mi[256];
+    memset(mi, 0, sizeof(mi));
+    Av1LoopFilterParams lfp;
+    av1_lf_params_default(&lfp);
+    Av1LoopFilter lf;
+    CHECK(av1_lf_init(&lf, a, mi, 16, 16, 16, &lfp, err, sizeof(err)));
+    Av1PostFilter pf;
+    CHECK(!av1_postfilter_init(&pf, b, &lf, NULL, NULL, NULL, NULL, err, sizeof(err)));
+    CHECK(av1_postfilter_init(&pf, a, &lf, NULL, NULL, NULL, NULL, err, sizeof(err)));
+    av1_postfilter_free(&pf);
+
+    // Lossless defaults (levels 0, zero CDEF strengths, RESTORE_NONE) drop the in-loop stages;
+    // one nonzero strength or restoring plane keeps them.
+    uint8_t skip[256];
+    memset(skip, 0, sizeof(skip));
+    int8_t idx = 0;
+    Av1CdefParams cp;
+    av1_cdef_params_default(&cp);
+    Av1LrParams lrp;
+    av1_lr_params_default(&lrp);
+    Av1Cdef cdef;
+    Av1Lr lr;
+    CHECK(av1_cdef_init(&cdef, a, skip, 16, &idx, 1, 16, 16, &cp, err, sizeof(err)));
+    CHECK(av1_lr_init(&lr, a, &lrp, (const Av1LrUnit *const[3]){NULL, NULL, NULL}, err, sizeof(err)));
+    CHECK(av1_postfilter_init(&pf, a, &lf, &cdef, NULL, &lr, NULL, err, sizeof(err)));
+    CHECK(pf.lf == NULL && pf.cdef == NULL && pf.lr == NULL && pf.stripes == pf.rows);
+    av1_postfilter_free(&pf);
+    lf.params.level[1] = 1;
+    cdef.params.uv_sec[0] = 1;
+    CHECK(av1_postfilter_init(&pf, a, &lf, &cdef, NULL, &lr, NULL, err, sizeof(err)));
+    CHECK(pf.lf == &lf && pf.cdef == &cdef && pf.lr == NULL);
+    av1_postfilter_free(&pf);
+    av1_cdef_free(&cdef);
+    av1_lr_free(&lr);
+
+    Av1FilmGrainParams fgp;
+    random_grain_params(&fgp, false);
+    CHECK(av1_film_grain_init(fg, a, b, &fgp, false, err, sizeof(err)));
+    CHECK(!av1_postfilter_init(&pf, a, &lf, NULL, NULL, NULL, fg, err, sizeof(err)));
+    free(fg);
+    av1_frame_pool_put(&pool, a);
+    av1_frame_pool_put(&pool, b);
+
+    av1_frame_pool_free(&pool);
+    av1_thread_pool_free(&threads);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_pipeline();
+    if (rc == 0) {
+        printf("postfilter tests: ok\n");
+    }
+    return rc;
+}
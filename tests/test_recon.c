@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_recon.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static int test_dsp_init(void) {
+    Av1ReconDsp dsp;
+    char err[256];
+    CHECK(!av1_recon_dsp_init(&dsp, 9, err, sizeof(err)));
+    CHECK(!av1_recon_dsp_init(&dsp, 16, err, sizeof(err)));
+
+    CHECK(av1_recon_dsp_init(&dsp, 8, err, sizeof(err)));
+    CHECK(!dsp.high_bitdepth && dsp.add_residual && !dsp.add_residual16);
+    CHECK(dsp.ipred.pred[AV1_IPRED_DC] && !dsp.ipred16.pred[AV1_IPRED_DC]);
+    CHECK(av1_recon_pixel_bytes(dsp.bit_depth) == 1);
+
+    CHECK(av1_recon_dsp_init(&dsp, 12, err, sizeof(err)));
+    CHECK(dsp.high_bitdepth && dsp.add_residual16 && !dsp.add_residual);
+    CHECK(dsp.ipred16.bit_depth == 12 && dsp.cfl16.bit_depth == 12);
+    CHECK(av1_recon_pixel_bytes(dsp.bit_depth) == 2);
+    return 0;
+}
+
+static int test_add_residual(void) {
+    const int32_t residual[8] = {-300, -5, 0, 5, 300, 2000, -2000, 1};
+    Av1ReconDsp dsp;
+    char err[256];
+
+    uint8_t p8[2 * 8];
+    memset(p8, 100, sizeof(p8));
+    CHECK(av1_recon_dsp_init(&dsp, 8, err, sizeof(err)));
+    dsp.add_residual(p8, 8, residual, 4, 2);
+    CHECK(p8[0] == 0 && p8[1] == 95 && p8[2] == 100 && p8[3] == 105);
+    CHECK(p8[8] == 255 && p8[9] == 255 && p8[10] == 0 && p8[11] == 101);
+    CHECK(p8[4] == 100); // outside the block
+
+    uint16_t p16[2 * 4];
+    for (int k = 0; k < 8; k++) {
+        p16[k] = 1000;
+    }
+    CHECK(av1_recon_dsp_init(&dsp, 10, err, sizeof(err)));
+    dsp.add_residual16(p16, 4, residual, 4, 2, dsp.bit_depth);
+    CHECK(p16[0] == 700 && p16[3] == 1005 && p16[4] == 1023 && p16[6] == 0);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_dsp_init();
+    rc |= test_add_residual();
+    if (rc == 0) {
+        printf("recon tests: ok\n");
+    }
+    return rc;
+}
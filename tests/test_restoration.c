@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_restoration.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+#define BS AV1_LR_BUF_STRIDE
+
+// Spec 5.11.58 coefficient ranges.
+static const int32_t kWienerMin[3] = {-5, -23, -17};
+static const int32_t kWienerMax[3] = {10, 8, 46};
+static const int32_t kXqdMin[2] = {-96, -32};
+static const int32_t kXqdMax[2] = {31, 95};
+
+static int32_t rand_range(int32_t lo, int32_t hi) {
+    return lo + rand() % (hi - lo + 1);
+}
+
+static void random_unit(Av1LrUnit *u, bool chroma) {
+    memset(u, 0, sizeof(*u));
+    u->type = (uint8_t)(rand() % 3);
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < 3; i++) {
+            u->wiener[pass][i] = (int8_t)(chroma && i == 0 ? 0 : rand_range(kWienerMin[i], kWienerMax[i]));
+        }
+    }
+    u->sgr_set = (uint8_t)(rand() % 16);
+    for (uint32_t i = 0; i < 2; i++) {
+        u->sgr_xqd[i] = (int16_t)rand_range(kXqdMin[i], kXqdMax[i]);
+    }
+}
+
+// A chunk buffer of smooth ramps, noise or extremes (which push the filters into clipping).
+static void fill_buf(uint16_t *buf, uint32_t max) {
+    const int32_t kind = rand() % 3;
+    const int32_t dx = rand() % 7 - 3, dy = rand() % 7 - 3;
+    const int32_t base = rand() % (int32_t)(max + 1u);
+    for (int32_t y = 0; y < AV1_LR_BUF_ROWS; y++) {
+        for (int32_t x = 0; x < BS; x++) {
+            int32_t v;
+            if (kind == 0) {
+                v = base + (x * dx + y * dy) * (int32_t)(max >> 6) + rand() % 5 - 2;
+            } else if (kind == 1) {
+                v = rand() % (int32_t)(max + 1u);
+            } else {
+                v = rand() % 2 ? (int32_t)max - rand() % 3 : rand() % 3;
+            }
+            buf[y * BS + x] = (uint16_t)(v < 0 ? 0 : (v > (int32_t)max ? (int32_t)max : v));
+        }
+    }
+}
+
+static int test_kernels(void) {
+    static uint16_t buf[AV1_LR_BUF_ROWS * BS];
+    static uint8_t ref[64 * 64], out[64 * 64];
+    Av1LrDsp c, best;
+    av1_lr_dsp_init_c(&c);
+    av1_lr_dsp_init(&best);
+    for (int iter = 0; iter < 3000; iter++) {
+        fill_buf(buf, 255);
+        const uint32_t w = iter % 4 == 0 ? 64u : 1u + (uint32_t)(rand() % 64);
+        const uint32_t h = iter % 3 == 0 ? 64u : 1u + (uint32_t)(rand() % 64);
+        const uint16_t *src = buf + AV1_LR_MARGIN * BS + AV1_LR_MARGIN;
+        Av1LrUnit u;
+        random_unit(&u, iter & 1);
+        int16_t filter[2][8];
+        for (uint32_t pass = 0; pass < 2; pass++) {
+            int32_t center = 128;
+            for (uint32_t i = 0; i < 3; i++) {
+                filter[pass][i] = filter[pass][6 - i] = u.wiener[pass][i];
+                center -= 2 * u.wiener[pass][i];
+            }
+            filter[pass][3] = (int16_t)center;
+            filter[pass][7] = 0;
+        }
+        memset(ref, 0, sizeof(ref));
+        memset(out, 0, sizeof(out));
+        c.wiener(ref, 64, src, w, h, (const int16_t (*)[8])filter);
+        best.wiener(out, 64, src, w, h, (const int16_t (*)[8])filter);
+        CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+        memset(ref, 0, sizeof(ref));
+        memset(out, 0, sizeof(out));
+        c.sgr(ref, 64, src, w, h, u.sgr_set, u.sgr_xqd);
+        best.sgr(out, 64, src, w, h, u.sgr_set, u.sgr_xqd);
+        CHECK(memcmp(ref, out, sizeof(ref)) == 0);
+    }
+    return 0;
+}
+
+// ---- Spec 7.17 transcription ----
+
+typedef struct {
+    uint32_t w, h;
+    int32_t *cur;  // UpscaledCurrFrame
+    int32_t *cdef; // UpscaledCdefFrame
+    int32_t *out;  // LrFrame
+    int32_t stripe_start, stripe_end;
+} RefPlane;
+
+static int32_t round2(int64_t x, uint32_t n) {
+    return n ? (int32_t)((x + ((int64_t)1 << (n - 1))) >> n) : (int32_t)x;
+}
+
+static int32_t get_source_sample(const RefPlane *rp, int32_t x, int32_t y) {
+    x = x > (int32_t)rp->w - 1 ? (int32_t)rp->w - 1 : x;
+    x = x < 0 ? 0 : x;
+    y = y > (int32_t)rp->h - 1 ? (int32_t)rp->h - 1 : y;
+    y = y < 0 ? 0 : y;
+    if (y < rp->stripe_start) {
+        y = y > rp->stripe_start - 2 ? y : rp->stripe_start - 2;
+        return rp->cur[y * (int32_t)rp->w + x];
+    }
+    if (y > rp->stripe_end) {
+        y = y < rp->stripe_end + 2 ? y : rp->stripe_end + 2;
+        return rp->cur[y * (int32_t)rp->w + x];
+    }
+    return rp->cdef[y * (int32_t)rp->w + x];
+}
+
+static int32_t clip1(int32_t v, uint32_t bit_depth) {
+    const int32_t max = (1 << bit_depth) - 1;
+    return v < 0 ? 0 : (v > max ? max : v);
+}
+
+static void ref_wiener(RefPlane *rp, const Av1LrUnit *u, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t bit_depth) {
+    const uint32_t round0 = bit_depth == 12 ? 5 : 3;
+    const uint32_t round1 = bit_depth == 12 ? 9 : 11;
+    int32_t f[2][7];
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        f[pass][3] = 128;
+        for (uint32_t i = 0; i < 3; i++) {
+            f[pass][i] = f[pass][6 - i] = u->wiener[pass][i];
+            f[pass][3] -= 2 * u->wiener[pass][i];
+        }
+    }
+    const int32_t offset = 1 << (bit_depth + 7 - round0 - 1);
+    const int32_t limit = (1 << (bit_depth + 1 + 7 - round0)) - 1;
+    int32_t inter[10][4];
+    for (int32_t r = 0; r < h + 6; r++) {
+        for (int32_t c = 0; c < w; c++) {
+            int32_t s = 0;
+            for (int32_t t = 0; t < 7; t++) {
+                s += f[1][t] * get_source_sample(rp, x + c + t - 3, y + r - 3);
+            }
+            const int32_t v = round2(s, round0);
+            inter[r][c] = v < -offset ? -offset : (v > limit - offset ? limit - offset : v);
+        }
+    }
+    for (int32_t r = 0; r < h; r++) {
+        for (int32_t c = 0; c < w; c++) {
+            int32_t s = 0;
+            for (int32_t t = 0; t < 7; t++) {
+                s += f[0][t] * inter[r + t][c];
+            }
+            rp->out[(y + r) * (int32_t)rp->w + x + c] = clip1(round2(s, round1), bit_depth);
+        }
+    }
+}
+
+static bool ref_box(const RefPlane *rp, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t set, uint32_t pass, uint32_t bit_depth, int32_t F[4][4]) {
+    const int32_t r = av1_sgr_params[set][pass * 2];
+    if (r == 0) {
+        return false;
+    }
+    const int64_t eps = av1_sgr_params[set][pass * 2 + 1];
+    const int64_t n = (2 * r + 1) * (2 * r + 1);
+    const int64_t n2e = n * n * eps;
+    const int64_t s = ((1 << 20) + n2e / 2) / n2e;
+    int64_t A[6][6], B[6][6];
+    for (int32_t i = -1; i < h + 1; i++) {
+        for (int32_t j = -1; j < w + 1; j++) {
+            int64_t a = 0, b = 0;
+            for (int32_t dy = -r; dy <= r; dy++) {
+                for (int32_t dx = -r; dx <= r; dx++) {
+                    const int64_t c = get_source_sample(rp, x + j + dx, y + i + dy);
+                    a += c * c;
+                    b += c;
+                }
+            }
+            a = round2(a, 2 * (bit_depth - 8));
+            const int64_t d = round2(b, bit_depth - 8);
+            int64_t p = a * n - d * d;
+            p = p < 0 ? 0 : p;
+            const int64_t z = round2(p * s, 20);
+            int64_t a2;
+            if (z >= 255) {
+                a2 = 256;
+            } else if (z == 0) {
+                a2 = 1;
+            } else {
+                a2 = ((z << 8) + z / 2) / (z + 1);
+            }
+            const int64_t one_over_n = ((1 << 12) + n / 2) / n;
+            const int64_t b2 = (256 - a2) * b * one_over_n;
+            A[i + 1][j + 1] = a2;
+            B[i + 1][j + 1] = round2(b2, 12);
+        }
+    }
+    for (int32_t i = 0; i < h; i++) {
+        const uint32_t shift = pass == 0 && (i & 1) ? 4 : 5;
+        for (int32_t j = 0; j < w; j++) {
+            int64_t a = 0, b = 0;
+            for (int32_t dy = -1; dy <= 1; dy++) {
+                for (int32_t dx = -1; dx <= 1; dx++) {
+                    int64_t weight;
+                    if (pass == 0) {
+                        weight = (i + dy) & 1 ? (dx == 0 ? 6 : 5) : 0;
+                    } else {
+                        weight = dx == 0 || dy == 0 ? 4 : 3;
+                    }
+                    a += weight * A[i + dy + 1][j + dx + 1];
+                    b += weight * B[i + dy + 1][j + dx + 1];
+                }
+            }
+            const int64_t v = a * rp->cdef[(y + i) * (int32_t)rp->w + x + j] + b;
+            F[i][j] = round2(v, 8 + shift - 4);
+        }
+    }
+    return true;
+}
+
+static void ref_sgr(RefPlane *rp, const Av1LrUnit *u, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t bit_depth) {
+    int32_t flt[2][4][4];
+    const bool r0 = ref_box(rp, x, y, w, h, u->sgr_set, 0, bit_depth, flt[0]);
+    const bool r1 = ref_box(rp, x, y, w, h, u->sgr_set, 1, bit_depth, flt[1]);
+    const int32_t w0 = u->sgr_xqd[0], w1 = u->sgr_xqd[1], w2 = 128 - w0 - w1;
+    for (int32_t i = 0; i < h; i++) {
+        for (int32_t j = 0; j < w; j++) {
+            const int32_t uu = rp->cdef[(y + i) * (int32_t)rp->w + x + j] << 4;
+            int32_t v = w1 * uu;
+            v += w0 * (r0 ? flt[0][i][j] : uu);
+            v += w2 * (r1 ? flt[1][i][j] : uu);
+            rp->out[(y + i) * (int32_t)rp->w + x + j] = clip1(round2(v, 11), bit_depth);
+        }
+    }
+}
+
+// Spec 7.17 / 7.17.1 over 4x4 blocks.
+static void reference_lr(RefPlane *planes, uint32_t num_planes, uint32_t frame_w, uint32_t frame_h, uint32_t sx, uint32_t sy,
+                         const Av1LrParams *prm, Av1LrUnit *const units[3], uint32_t bit_depth) {
+    for (uint32_t y = 0; y < frame_h; y += 4) {
+        for (uint32_t x = 0; x < frame_w; x += 4) {
+            for (uint32_t p = 0; p < num_planes; p++) {
+                if (prm->frame_type[p] == AV1_RESTORE_NONE) {
+                    continue;
+                }
+                RefPlane *rp = &planes[p];
+                const uint32_t subx = p ? sx : 0, suby = p ? sy : 0;
+                const int32_t stripe = (int32_t)(y + 8) / 64;
+                rp->stripe_start = (-8 + stripe * 64) >> suby;
+                rp->stripe_end = rp->stripe_start + (64 >> suby) - 1;
+                const uint32_t size = prm->unit_size[p];
+                const uint32_t unit_rows = av1_lr_unit_count(size, rp->h);
+                const uint32_t unit_cols = av1_lr_unit_count(size, rp->w);
+                uint32_t unit_row = ((y + 8) >> suby) / size;
+                uint32_t unit_col = (x >> subx) / size;
+                unit_row = unit_row < unit_rows - 1 ? unit_row : unit_rows - 1;
+                unit_col = unit_col < unit_cols - 1 ? unit_col : unit_cols - 1;
+                const int32_t bx = (int32_t)(x >> subx), by = (int32_t)(y >> suby);
+                const int32_t bw = (int32_t)(4 >> subx) < (int32_t)rp->w - bx ? (int32_t)(4 >> subx) : (int32_t)rp->w - bx;
+                const int32_t bh = (int32_t)(4 >> suby) < (int32_t)rp->h - by ? (int32_t)(4 >> suby) : (int32_t)rp->h - by;
+                const Av1LrUnit *u = &units[p][unit_row * unit_cols + unit_col];
+                if (u->type == AV1_RESTORE_WIENER) {
+                    ref_wiener(rp, u, bx, by, bw, bh, bit_depth);
+                } else if (u->type == AV1_RESTORE_SGRPROJ) {
+                    ref_sgr(rp, u, bx, by, bw, bh, bit_depth);
+                }
+            }
+        }
+    }
+}
+
+static int32_t frame_get(const Av1FrameBuf *fb, uint32_t p, uint32_t x, uint32_t y) {
+    const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+    return fb->bytes_per_sample == 1 ? av1_frame_plane_8(fb, p)[off] : av1_frame_plane_16(fb, p)[off];
+}
+
+static void frame_set(Av1FrameBuf *fb, uint32_t p, uint32_t x, uint32_t y, int32_t v) {
+    const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+    if (fb->bytes_per_sample == 1) {
+        av1_frame_plane_8(fb, p)[off] = (uint8_t)v;
+    } else {
+        av1_frame_plane_16(fb, p)[off] = (uint16_t)v;
+    }
+}
+
+static int test_frame(void) {
+    static const uint32_t kCases[][4] = {
+        // width, height, layout, bit depth
+        {64, 64, AV1_LAYOUT_I420, 8},
+        {150, 140, AV1_LAYOUT_I420, 8},
+        {203, 71, AV1_LAYOUT_I444, 8},
+        {100, 130, AV1_LAYOUT_I422, 8},
+        {90, 75, AV1_LAYOUT_I420, 10},
+        {70, 66, AV1_LAYOUT_I444, 12},
+        {131, 57, AV1_LAYOUT_I420, 12},
+        {66, 129, AV1_LAYOUT_I400, 8},
+        {7, 5, AV1_LAYOUT_I420, 8},
+    };
+    static const uint16_t kSizes[4] = {32, 64, 128, 256};
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    char err[256];
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (int iter = 0; iter < 4; iter++) {
+            srand(3000u + (unsigned)(ci * 16 + (size_t)iter));
+            const uint32_t bit_depth = kCases[ci][3];
+            const uint32_t max = (1u << bit_depth) - 1u;
+            Av1FrameBuf *fb;
+            CHECK(av1_frame_pool_get(&pool, kCases[ci][0], kCases[ci][1], kCases[ci][2], bit_depth, &fb, err, sizeof(err)));
+            const uint32_t sx = fb->layout == AV1_LAYOUT_I420 || fb->layout == AV1_LAYOUT_I422;
+            const uint32_t sy = fb->layout == AV1_LAYOUT_I420;
+
+            Av1LrParams prm;
+            av1_lr_params_default(&prm);
+            Av1LrUnit *units[3] = {NULL, NULL, NULL};
+            RefPlane rp[3];
+            memset(rp, 0, sizeof(rp));
+            for (uint32_t p = 0; p < fb->num_planes; p++) {
+                const uint32_t w = fb->plane_w[p], h = fb->plane_h[p];
+                rp[p].w = w;
+                rp[p].h = h;
+                rp[p].cur = malloc((size_t)w * h * sizeof(int32_t));
+                rp[p].cdef = malloc((size_t)w * h * sizeof(int32_t));
+                rp[p].out = malloc((size_t)w * h * sizeof(int32_t));
+                CHECK(rp[p].cur && rp[p].cdef && rp[p].out);
+                const int32_t dx = rand() % 5 - 2, dy = rand() % 5 - 2;
+                for (uint32_t y = 0; y < h; y++) {
+                    for (uint32_t x = 0; x < w; x++) {
+                        // Ramps plus noise, then a fake "CDEF" that nudges samples.
+                        int32_t v = (int32_t)((x * (uint32_t)(dx + 3) + y * (uint32_t)(dy + 3)) * (max >> 6)) + rand() % (int32_t)(max >> 3);
+                        v = (int32_t)((uint32_t)v % (max + 1u));
+                        if (iter == 3 && rand() % 2) {
+                            v = rand() % 2 ? (int32_t)max : 0;
+                        }
+                        frame_set(fb, p, x, y, v);
+                        rp[p].cur[y * w + x] = v;
+                        const int32_t d = clip1(v + rand() % 9 - 4, bit_depth);
+                        rp[p].cdef[y * w + x] = d;
+                    }
+                }
+                // Chroma unit sizes may be halved (lr_uv_shift) for 4:2:0 only.
+                const uint32_t size_idx = p && !sy ? (uint32_t)(rand() % 3) + 1u : (uint32_t)(rand() % 3) + (p ? 0u : 1u);
+                prm.frame_type[p] = (uint8_t)(iter == 0 && p == 1 ? AV1_RESTORE_NONE : 1 + rand() % 3);
+                prm.unit_size[p] = kSizes[size_idx];
+                const uint32_t n = av1_lr_unit_count(prm.unit_size[p], h) * av1_lr_unit_count(prm.unit_size[p], w);
+                units[p] = malloc(n * sizeof(Av1LrUnit));
+                CHECK(units[p] != NULL);
+                for (uint32_t i = 0; i < n; i++) {
+                    random_unit(&units[p][i], p != 0);
+                    if (prm.frame_type[p] == AV1_RESTORE_WIENER || prm.frame_type[p] == AV1_RESTORE_SGRPROJ) {
+                        units[p][i].type = (uint8_t)(rand() % 4 ? prm.frame_type[p] : AV1_RESTORE_NONE);
+                    }
+                }
+            }
+
+            Av1Lr lr;
+            const Av1LrUnit *const cunits[3] = {units[0], units[1], units[2]};
+            CHECK(av1_lr_init(&lr, fb, &prm, cunits, err, sizeof(err)));
+            for (uint32_t b = 1; b < lr.num_stripes; b++) {
+                av1_lr_save_lines(&lr, b);
+            }
+            for (uint32_t p = 0; p < fb->num_planes; p++) {
+                for (uint32_t y = 0; y < rp[p].h; y++) {
+                    for (uint32_t x = 0; x < rp[p].w; x++) {
+                        frame_set(fb, p, x, y, rp[p].cdef[y * rp[p].w + x]);
+                    }
+                }
+                memcpy(rp[p].out, rp[p].cdef, (size_t)rp[p].w * rp[p].h * sizeof(int32_t));
+            }
+            if (iter & 1) {
+                av1_lr_filter_frame(&lr);
+            } else {
+                // Stripes in reverse order: the line buffers keep them independent.
+                for (uint32_t s = lr.num_stripes; s-- > 0;) {
+                    av1_lr_filter_stripe(&lr, s);
+                }
+            }
+            av1_lr_free(&lr);
+            reference_lr(rp, fb->num_planes, kCases[ci][0], kCases[ci][1], sx, sy, &prm, units, bit_depth);
+            for (uint32_t p = 0; p < fb->num_planes; p++) {
+                for (uint32_t y = 0; y < rp[p].h; y++) {
+                    for (uint32_t x = 0; x < rp[p].w; x++) {
+                        CHECK(frame_get(fb, p, x, y) == rp[p].out[y * rp[p].w + x]);
+                    }
+                }
+                free(rp[p].cur);
+                free(rp[p].cdef);
+                free(rp[p].out);
+                free(units[p]);
+            }
+            av1_frame_pool_put(&pool, fb);
+        }
+    }
+
+    // Bad unit sizes and missing units are rejected.
+    Av1FrameBuf *fb;
+    CHECK(av1_frame_pool_get(&pool, 16, 16, AV1_LAYOUT_I420, 8, &fb, err, sizeof(err)));
+    Av1LrParams prm;
+    av1_lr_params_default(&prm);
+    Av1LrUnit unit;
+    memset(&unit, 0, sizeof(unit));
+    const Av1LrUnit *const none[3] = {NULL, NULL, NULL};
+    const Av1LrUnit *const one[3] = {&unit, NULL, NULL};
+    Av1Lr lr;
+    CHECK(av1_lr_init(&lr, fb, &prm, none, err, sizeof(err)));
+    av1_lr_filter_frame(&lr);
+    av1_lr_free(&lr);
+    prm.frame_type[0] = AV1_RESTORE_WIENER;
+    CHECK(!av1_lr_init(&lr, fb, &prm, none, err, sizeof(err)));
+    prm.unit_size[0] = 48;
+    CHECK(!av1_lr_init(&lr, fb, &prm, one, err, sizeof(err)));
+    prm.unit_size[0] = 64;
+    CHECK(av1_lr_init(&lr, fb, &prm, one, err, sizeof(err)));
+    CHECK(lr.unit_rows[0] == 1 && lr.unit_cols[0] == 1);
+    av1_lr_free(&lr);
+    av1_frame_pool_put(&pool, fb);
+    av1_frame_pool_free(&pool);
+
+    CHECK(av1_lr_unit_count(64, 95) == 1 && av1_lr_unit_count(64, 96) == 2 && av1_lr_unit_count(256, 16) == 1);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_kernels();
+    rc |= test_frame();
+    if (rc == 0) {
+        printf("restoration tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_roi.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static int test_parse_rect(void) {
+    Av1RoiRect r;
+    CHECK(av1_roi_parse_rect("10,20,30,40", &r));
+    CHECK(r.x == 10 && r.y == 20 && r.w == 30 && r.h == 40);
+
+    CHECK(!av1_roi_parse_rect("10,20,30", &r));
+    CHECK(!av1_roi_parse_rect("10,20,0,40", &r));
+    CHECK(!av1_roi_parse_rect("10,20,30,40,", &r));
+    CHECK(!av1_roi_parse_rect("-1,20,30,40", &r));
+    CHECK(!av1_roi_parse_rect("", &r));
+    return 0;
+}
+
+// 512x256 frame, 2x2 tiles of 256x128 luma pixels (64x32 MI).
+static const uint32_t kColStarts[] = {0, 64, 128};
+static const uint32_t kRowStarts[] = {0, 32, 64};
+
+static int test_single_tile(void) {
+    Av1RoiRect r = {32, 32, 64, 32};
+    Av1RoiTileSet s;
+    char err[256] = {0};
+    CHECK(av1_roi_select_tiles(&r, 512, 256, 512, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    CHECK(s.tile_col_start == 0 && s.tile_col_end == 1);
+    CHECK(s.tile_row_start == 0 && s.tile_row_end == 1);
+    CHECK(av1_roi_tile_selected(&s, 0, 0));
+    CHECK(!av1_roi_tile_selected(&s, 0, 1));
+    CHECK(!av1_roi_tile_selected(&s, 1, 0));
+    // 32-24=8 px -> MI 2; 96+24=120 px -> MI 30.
+    CHECK(s.mi_col_start == 2 && s.mi_col_end == 30);
+    return 0;
+}
+
+static int test_margin_crosses_tile_edge(void) {
+    // Rectangle ends 8 px left of the vertical tile edge; the filter margin pulls in the neighbour.
+    Av1RoiRect r = {200, 0, 48, 16};
+    Av1RoiTileSet s;
+    char err[256] = {0};
+    CHECK(av1_roi_select_tiles(&r, 512, 256, 512, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    CHECK(s.tile_col_start == 0 && s.tile_col_end == 2);
+    CHECK(s.tile_row_start == 0 && s.tile_row_end == 1);
+
+    // Without margin it stays in the first tile column.
+    CHECK(av1_roi_select_tiles(&r, 512, 256, 512, 0, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    CHECK(s.tile_col_start == 0 && s.tile_col_end == 1);
+    return 0;
+}
+
+static int test_margin_covers_filter_chain(void) {
+    // A crop whose outermost pixel is 17..24 px from the nearest pixel of the neighbouring tile
+    // still depends on that tile through the deblock -> CDEF -> loop restoration chain.
+    Av1RoiTileSet s;
+    char err[256] = {0};
+    CHECK(AV1_ROI_FILTER_MARGIN_PX >= 24u && AV1_ROI_FILTER_MARGIN_PX % 8u == 0u);
+    for (uint32_t d = 17; d <= 24; d++) {
+        // Last column at x=256-d, left of the vertical tile edge at x=256.
+        Av1RoiRect left = {256 - d - 31, 0, 32, 16};
+        CHECK(av1_roi_select_tiles(&left, 512, 256, 512, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s,
+                                   err, sizeof(err)));
+        CHECK(s.tile_col_start == 0 && s.tile_col_end == 2);
+
+        // First row at y=127+d, below the horizontal tile edge at y=128.
+        Av1RoiRect below = {0, 127 + d, 16, 32};
+        CHECK(av1_roi_select_tiles(&below, 512, 256, 512, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s,
+                                   err, sizeof(err)));
+        CHECK(s.tile_row_start == 0 && s.tile_row_end == 2);
+    }
+    return 0;
+}
+
+static int test_clip_and_reject(void) {
+    Av1RoiRect r = {500, 250, 1000, 1000};
+    Av1RoiTileSet s;
+    char err[256] = {0};
+    CHECK(av1_roi_select_tiles(&r, 512, 256, 512, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    CHECK(s.tile_col_start == 1 && s.tile_col_end == 2);
+    CHECK(s.tile_row_start == 1 && s.tile_row_end == 2);
+    CHECK(s.mi_col_end == 128 && s.mi_row_end == 64);
+
+    Av1RoiRect outside = {512, 0, 16, 16};
+    CHECK(!av1_roi_select_tiles(&outside, 512, 256, 512, 0, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    return 0;
+}
+
+static int test_superres_maps_to_coded_columns(void) {
+    // Upscaled 1024 wide, coded 512 wide: output x=600 maps to coded x=300 (second tile column).
+    Av1RoiRect r = {600, 0, 64, 16};
+    Av1RoiTileSet s;
+    char err[256] = {0};
+    CHECK(av1_roi_select_tiles(&r, 512, 256, 1024, AV1_ROI_FILTER_MARGIN_PX, kColStarts, 2, kRowStarts, 2, &s, err, sizeof(err)));
+    CHECK(s.tile_col_start == 1 && s.tile_col_end == 2);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_parse_rect();
+    rc |= test_single_tile();
+    rc |= test_margin_crosses_tile_edge();
+    rc |= test_margin_covers_filter_chain();
+    rc |= test_clip_and_reject();
+    rc |= test_superres_maps_to_coded_columns();
+    if (rc == 0) {
+        printf("roi tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_segmap.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t rng_state = 0x2468ace1u;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+enum { MAX_ROWS = 80, MAX_COLS = 136 };
+
+// Plain byte-per-MI SegmentIds[][] the packed map is checked against.
+static uint8_t ref_map[MAX_ROWS][MAX_COLS];
+static uint32_t ref_rows, ref_cols;
+
+// Stores a random segment_id for one block, clipped to the frame like the tile decoder does.
+static void code_block(Av1SegMap *m, uint32_t r, uint32_t c, uint32_t w4, uint32_t h4) {
+    if (r >= ref_rows || c >= ref_cols) {
+        return;
+    }
+    const uint32_t seg = rng() % 8u;
+    av1_segmap_set_block(m, r, c, w4, h4, seg);
+    for (uint32_t y = r; y < r + h4 && y < ref_rows; y++) {
+        for (uint32_t x = c; x < c + w4 && x < ref_cols; x++) {
+            ref_map[y][x] = (uint8_t)seg;
+        }
+    }
+}
+
+// A random partition tree: NONE, HORZ, VERT or SPLIT down to 4x4 (1x1 MI).
+static void code_partition(Av1SegMap *m, uint32_t r, uint32_t c, uint32_t n4) {
+    if (r >= ref_rows || c >= ref_cols) {
+        return;
+    }
+    const uint32_t half = n4 >> 1;
+    const uint32_t kind = n4 == 1u ? 0u : rng() % 4u;
+    if (kind == 0u) {
+        code_block(m, r, c, n4, n4);
+    } else if (kind == 1u) {
+        code_block(m, r, c, n4, half);
+        code_block(m, r + half, c, n4, half);
+    } else if (kind == 2u) {
+        code_block(m, r, c, half, n4);
+        code_block(m, r, c + half, half, n4);
+    } else {
+        code_partition(m, r, c, half);
+        code_partition(m, r, c + half, half);
+        code_partition(m, r + half, c, half);
+        code_partition(m, r + half, c + half, half);
+    }
+}
+
+// One frame-wide map written tile by tile in frame MI coordinates, tile columns one to three
+// superblocks wide.
+static int test_frame(void) {
+    static const uint32_t kDims[][2] = {{1, 1}, {16, 16}, {17, 9}, {32, 48}, {80, 136}, {45, 73}, {3, 130}};
+    for (uint32_t t = 0; t < sizeof(kDims) / sizeof(kDims[0]); t++) {
+        for (uint32_t iter = 0; iter < 20u; iter++) {
+            ref_rows = kDims[t][0];
+            ref_cols = kDims[t][1];
+            memset(ref_map, 0, sizeof(ref_map));
+            Av1SegMap m;
+            char err[128];
+            CHECK(av1_segmap_init(&m, ref_rows, ref_cols, err, sizeof(err)));
+            const uint32_t sb4 = (iter & 1u) ? 32u : 16u;
+            const uint32_t tile_sbs = 1u + iter % 3u;
+            for (uint32_t tc = 0; tc < ref_cols; tc += tile_sbs * sb4) {
+                for (uint32_t r = 0; r < ref_rows; r += sb4) {
+                    for (uint32_t c = tc; c < tc + tile_sbs * sb4 && c < ref_cols; c += sb4) {
+                        code_partition(&m, r, c, sb4);
+                    }
+                }
+            }
+            for (uint32_t r = 0; r < ref_rows; r++) {
+                for (uint32_t c = 0; c < ref_cols; c++) {
+                    CHECK(av1_segmap_get(&m, r, c) == ref_map[r][c]);
+                }
+            }
+            av1_segmap_free(&m);
+        }
+    }
+    return 0;
+}
+
+// Packing: neighbors straddling byte boundaries keep their own 3 bits.
+static int test_packing(void) {
+    Av1SegMap m;
+    char err[128];
+    CHECK(av1_segmap_init(&m, 2, 21, err, sizeof(err)));
+    CHECK(m.stride == 9u);
+    for (uint32_t c = 0; c < 21u; c++) {
+        av1_segmap_set_block(&m, 1, c, 1, 1, (c * 5u + 3u) & 7u);
+    }
+    for (uint32_t c = 0; c < 21u; c++) {
+        CHECK(av1_segmap_get(&m, 0, c) == 0u);
+        CHECK(av1_segmap_get(&m, 1, c) == ((c * 5u + 3u) & 7u));
+    }
+    // The aligned whole-byte fill next to single entries.
+    av1_segmap_set_block(&m, 0, 8, 8, 2, 7);
+    CHECK(av1_segmap_get(&m, 1, 7) == ((7u * 5u + 3u) & 7u));
+    CHECK(av1_segmap_get(&m, 1, 16) == ((16u * 5u + 3u) & 7u));
+    for (uint32_t c = 8; c < 16u; c++) {
+        CHECK(av1_segmap_get(&m, 0, c) == 7u && av1_segmap_get(&m, 1, c) == 7u);
+    }
+    // Clipped at the right / bottom edge.
+    av1_segmap_set_block(&m, 1, 16, 16, 16, 5);
+    CHECK(av1_segmap_get(&m, 1, 20) == 5u && av1_segmap_get(&m, 0, 20) == 0u);
+    av1_segmap_free(&m);
+
+    // A tile ending at a superblock column writes none of the next tile's bytes (16 MIs = 6 bytes).
+    CHECK(av1_segmap_init(&m, 1, 32, err, sizeof(err)));
+    memset(m.map, 0xff, m.stride);
+    av1_segmap_set_block(&m, 0, 8, 8, 1, 0);
+    for (uint32_t i = 0; i < m.stride; i++) {
+        CHECK(m.map[i] == (i >= 3u && i < 6u ? 0u : 0xffu));
+    }
+    av1_segmap_free(&m);
+    return 0;
+}
+
+// av1_segmap_store_row(): superblock rows gathered from strided records, with the last superblock
+// cut by the right edge.
+static int test_store_row(void) {
+    static const uint32_t kCols[] = {1, 5, 16, 21, 40, 73};
+    for (uint32_t t = 0; t < sizeof(kCols) / sizeof(kCols[0]); t++) {
+        const uint32_t cols = kCols[t];
+        Av1SegMap m;
+        char err[128];
+        CHECK(av1_segmap_init(&m, 3, cols, err, sizeof(err)));
+        uint8_t records[3][80][12];
+        for (uint32_t r = 0; r < 3u; r++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                for (uint32_t k = 0; k < 12u; k++) {
+                    records[r][c][k] = (uint8_t)(k == 6u ? rng() % 8u : 0xffu);
+                }
+            }
+        }
+        for (uint32_t r = 0; r < 3u; r++) {
+            for (uint32_t c = 0; c < cols; c += 16u) {
+                av1_segmap_store_row(&m, r, c, &records[r][c][6], 12, 16);
+            }
+        }
+        for (uint32_t r = 0; r < 3u; r++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                CHECK(av1_segmap_get(&m, r, c) == records[r][c][6]);
+            }
+        }
+        av1_segmap_free(&m);
+    }
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_packing();
+    rc |= test_frame();
+    rc |= test_store_row();
+    if (rc == 0) {
+        printf("segmap tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_superres.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+// AVX2 and scalar kernels agree on random rows, positions and steps.
+static int test_kernels(void) {
+    Av1SuperresDsp c, best;
+    av1_superres_dsp_init_c(&c);
+    av1_superres_dsp_init(&best);
+    uint8_t src[1200];
+    uint8_t out_c[600], out_b[600];
+    srand(11);
+    for (int iter = 0; iter < 400; iter++) {
+        for (uint32_t i = 0; i < sizeof(src); i++) {
+            src[i] = (uint8_t)(iter % 4 == 0 ? (rand() % 2 ? 255 : 0) : rand() % 256);
+        }
+        const int32_t step = (1 << 13) + rand() % (1 << 13); // denominators 9 .. 16
+        const uint32_t w = (uint32_t)(rand() % 600);
+        const int32_t pos = (8 << 14) + rand() % (1 << 14);
+        memset(out_c, 0xAA, sizeof(out_c));
+        memset(out_b, 0x55, sizeof(out_b));
+        c.upscale(out_c, src, w, pos, step);
+        best.upscale(out_b, src, w, pos, step);
+        CHECK(memcmp(out_c, out_b, w) == 0);
+    }
+    return 0;
+}
+
+static int32_t clip3(int32_t lo, int32_t hi, int32_t x) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+static int32_t frame_get(const Av1FrameBuf *fb, uint32_t p, int32_t x, uint32_t y) {
+    const ptrdiff_t off = (ptrdiff_t)y * fb->stride[p] + x;
+    return fb->bytes_per_sample == 1 ? av1_frame_plane_8(fb, p)[off] : av1_frame_plane_16(fb, p)[off];
+}
+
+// Spec 7.16, transcribed.
+static int32_t reference_sample(const Av1FrameBuf *src, uint32_t plane, uint32_t mi_cols, uint32_t upscaled_width, uint32_t x, uint32_t y) {
+    const uint32_t sub_x = src->layout == AV1_LAYOUT_I420 || src->layout == AV1_LAYOUT_I422;
+    const int32_t subX = plane ? (int32_t)sub_x : 0;
+    const int32_t downscaledPlaneW = ((int32_t)src->width + (1 << subX >> 1)) >> subX;
+    const int32_t upscaledPlaneW = ((int32_t)upscaled_width + (1 << subX >> 1)) >> subX;
+    const int32_t stepX = ((downscaledPlaneW << 14) + (upscaledPlaneW / 2)) / upscaledPlaneW;
+    const int32_t err = upscaledPlaneW * stepX - (downscaledPlaneW << 14);
+    int32_t initialSubpelX = (-((upscaledPlaneW - downscaledPlaneW) << 13) + upscaledPlaneW / 2) / upscaledPlaneW + (1 << 7) - err / 2;
+    initialSubpelX &= (1 << 14) - 1;
+    const int32_t miW = (int32_t)mi_cols >> subX;
+    const int32_t minX = 0;
+    const int32_t maxX = miW * 4 - 1;
+    const int32_t srcX = -(1 << 14) + initialSubpelX + (int32_t)x * stepX;
+    const int32_t srcP = srcX >> 14;
+    const int32_t srcSubpel = (srcX & ((1 << 14) - 1)) >> 8;
+    int32_t sum = 0;
+    for (int32_t k = 0; k < 8; k++) {
+        const int32_t sampleX = clip3(minX, maxX, srcP + (k - 3));
+        sum += frame_get(src, plane, sampleX, y) * av1_superres_filter[srcSubpel][k];
+    }
+    return clip3(0, (1 << src->bit_depth) - 1, (sum + 64) >> 7);
+}
+
+// Whole frames, every layout and bit depth, every denominator, against the spec loop.
+static int test_frame(void) {
+    static const uint32_t kCases[][4] = {
+        // upscaled width, height, layout, bit depth
+        {160, 40, AV1_LAYOUT_I420, 8},
+        {333, 17, AV1_LAYOUT_I420, 8},
+        {97, 30, AV1_LAYOUT_I444, 8},
+        {250, 21, AV1_LAYOUT_I422, 10},
+        {64, 9, AV1_LAYOUT_I400, 12},
+        {17, 8, AV1_LAYOUT_I420, 8},
+        {3, 4, AV1_LAYOUT_I444, 8},
+    };
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    char err[256];
+    for (size_t ci = 0; ci < sizeof(kCases) / sizeof(kCases[0]); ci++) {
+        for (uint32_t denom = AV1_SUPERRES_DENOM_MIN; denom <= 16u; denom++) {
+            srand(500u + (unsigned)(ci * 16 + denom));
+            const uint32_t up_w = kCases[ci][0], h = kCases[ci][1], bit_depth = kCases[ci][3];
+            const uint32_t w = av1_superres_coded_width(up_w, denom);
+            const uint32_t mi_cols = 2u * ((w + 7u) >> 3);
+            Av1FrameBuf *src, *dst;
+            CHECK(av1_frame_pool_get(&pool, w, h, kCases[ci][2], bit_depth, &src, err, sizeof(err)));
+            CHECK(av1_frame_pool_get(&pool, up_w, h, kCases[ci][2], bit_depth, &dst, err, sizeof(err)));
+            const uint32_t sub_x = src->layout == AV1_LAYOUT_I420 || src->layout == AV1_LAYOUT_I422;
+            for (uint32_t p = 0; p < src->num_planes; p++) {
+                // The MI area reaches into the right border.
+                const uint32_t mi_w = (mi_cols >> (p ? sub_x : 0u)) * 4u;
+                for (uint32_t y = 0; y < src->plane_h[p]; y++) {
+                    for (uint32_t x = 0; x < mi_w; x++) {
+                        const uint32_t v = (uint32_t)rand() % (1u << bit_depth);
+                        const ptrdiff_t off = (ptrdiff_t)y * src->stride[p] + x;
+                        if (src->bytes_per_sample == 1) {
+                            av1_frame_plane_8(src, p)[off] = (uint8_t)v;
+                        } else {
+                            av1_frame_plane_16(src, p)[off] = (uint16_t)v;
+                        }
+                    }
+                }
+            }
+            Av1Superres sr;
+            CHECK(av1_superres_init(&sr, dst, src, mi_cols, err, sizeof(err)));
+            if (denom & 1u) {
+                av1_superres_filter_frame(&sr);
+            } else {
+                for (uint32_t r = (h + 63u) / 64u; r-- > 0;) {
+                    av1_superres_filter_row(&sr, r);
+                }
+            }
+            for (uint32_t p = 0; p < dst->num_planes; p++) {
+                for (uint32_t y = 0; y < dst->plane_h[p]; y++) {
+                    for (uint32_t x = 0; x < dst->plane_w[p]; x++) {
+                        CHECK(frame_get(dst, p, (int32_t)x, y) == reference_sample(src, p, mi_cols, up_w, x, y));
+                    }
+                }
+            }
+            CHECK(av1_superres_check_ispe(dst, up_w, h, err, sizeof(err)));
+            CHECK(!av1_superres_check_ispe(dst, w, h, err, sizeof(err)) || w == up_w);
+            av1_frame_pool_put(&pool, src);
+            av1_frame_pool_put(&pool, dst);
+        }
+    }
+
+    // Mismatched frames are rejected.
+    Av1FrameBuf *a, *b;
+    CHECK(av1_frame_pool_get(&pool, 64, 32, AV1_LAYOUT_I420, 8, &a, err, sizeof(err)));
+    CHECK(av1_frame_pool_get(&pool, 80, 30, AV1_LAYOUT_I420, 8, &b, err, sizeof(err)));
+    Av1Superres sr;
+    CHECK(!av1_superres_init(&sr, b, a, 16, err, sizeof(err)));
+    CHECK(!av1_superres_init(&sr, a, a, 16, err, sizeof(err)));
+    av1_frame_pool_put(&pool, a);
+    av1_frame_pool_put(&pool, b);
+    CHECK(av1_superres_coded_width(1920, 16) == 960);
+    CHECK(av1_superres_coded_width(1000, 9) == 889);
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_kernels();
+    rc |= test_frame();
+    if (rc == 0) {
+        printf("superres tests: ok\n");
+    }
+    return rc;
+}
@@ -0,0 +1,324 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/m3b-av1-decode/av1_yuv2rgb.h"
+
+#define CHECK(cond)                            \
+    do {                                       \
+        if (!(cond)) {                         \
+            fprintf(stderr, "FAIL: %s\n", #cond); \
+            return 1;                          \
+        }                                      \
+    } while (0)
+
+static uint32_t rng_state = 0x0badf00du;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static const uint32_t kMatrices[] = {AV1_MC_IDENTITY, AV1_MC_BT_709, AV1_MC_UNSPECIFIED, AV1_MC_FCC,
+                                     AV1_MC_BT_470_B_G, AV1_MC_BT_601, AV1_MC_SMPTE_240, AV1_MC_SMPTE_YCGCO,
+                                     AV1_MC_BT_2020_NCL};
+static const uint32_t kDepths[] = {8, 10, 12};
+
+// Converts one pixel with the scalar full-resolution kernel.
+static void convert_px(const Av1Yuv2Rgb *cv, uint32_t y, uint32_t u, uint32_t v, uint32_t out[4]) {
+    Av1Yuv2RgbDsp c;
+    av1_yuv2rgb_dsp_init_c(&c);
+    const bool in16 = cv->bit_depth > 8u, out16 = cv->rgb_depth == 16u;
+    const uint16_t s16[3] = {(uint16_t)y, (uint16_t)u, (uint16_t)v};
+    const uint8_t s8[3] = {(uint8_t)y, (uint8_t)u, (uint8_t)v};
+    const void *p[3];
+    for (uint32_t i = 0; i < 3u; i++) {
+        p[i] = in16 ? (const void *)&s16[i] : (const void *)&s8[i];
+    }
+    uint16_t d16[4];
+    uint8_t d8[4];
+    c.row[in16][out16][0](out16 ? (void *)d16 : (void *)d8, p[0], p[1], p[1], p[2], p[2], 1, cv);
+    for (uint32_t i = 0; i < 4u; i++) {
+        out[i] = out16 ? d16[i] : d8[i];
+    }
+}
+
+static int test_known_values(void) {
+    Av1Yuv2Rgb cv;
+    char err[128];
+    uint32_t px[4];
+    // Limited range black / white / grey for every BitDepth.
+    for (uint32_t d = 0; d < 3u; d++) {
+        const uint32_t bd = kDepths[d], sh = bd - 8u;
+        CHECK(av1_yuv2rgb_init(&cv, AV1_MC_BT_709, false, bd, 8, err, sizeof(err)));
+        convert_px(&cv, 16u << sh, 128u << sh, 128u << sh, px);
+        CHECK(px[0] == 0u && px[1] == 0u && px[2] == 0u && px[3] == 255u);
+        convert_px(&cv, 235u << sh, 128u << sh, 128u << sh, px);
+        CHECK(px[0] == 255u && px[1] == 255u && px[2] == 255u);
+        CHECK(av1_yuv2rgb_init(&cv, AV1_MC_BT_601, true, bd, 16, err, sizeof(err)));
+        convert_px(&cv, (1u << bd) - 1u, 1u << (bd - 1u), 1u << (bd - 1u), px);
+        CHECK(px[0] == 65535u && px[1] == 65535u && px[2] == 65535u && px[3] == 65535u);
+    }
+    // BT.601 full range 8-bit red: R = Y + 1.402 * ( V - 128 ).
+    CHECK(av1_yuv2rgb_init(&cv, AV1_MC_BT_601, true, 8, 8, err, sizeof(err)));
+    convert_px(&cv, 76, 85, 255, px);
+    CHECK(px[0] == 254u && px[1] == 0u && px[2] == 0u);
+    // Identity (GBR): Y = G, U = B, V = R.
+    CHECK(av1_yuv2rgb_init(&cv, AV1_MC_IDENTITY, true, 8, 8, err, sizeof(err)));
+    convert_px(&cv, 10, 20, 30, px);
+    CHECK(px[0] == 30u && px[1] == 10u && px[2] == 20u);
+    // YCgCo: R = Y - Cg + Co, G = Y + Cg, B = Y - Cg - Co.
+    CHECK(av1_yuv2rgb_init(&cv, AV1_MC_SMPTE_YCGCO, true, 8, 8, err, sizeof(err)));
+    convert_px(&cv, 100, 128 + 20, 128 + 30, px);
+    CHECK(px[0] == 110u && px[1] == 120u && px[2] == 50u);
+
+    CHECK(!av1_yuv2rgb_init(&cv, 10 /* BT.2020 CL */, true, 8, 8, err, sizeof(err)));
+    CHECK(!av1_yuv2rgb_init(&cv, AV1_MC_BT_709, true, 9, 8, err, sizeof(err)));
+    CHECK(!av1_yuv2rgb_init(&cv, AV1_MC_BT_709, true, 8, 10, err, sizeof(err)));
+    return 0;
+}
+
+// Floating-point conversion straight from the matrix definitions.
+static void ref_convert(uint32_t mc,
+                        bool full,
+                        uint32_t bd,
+                        uint32_t rgb_depth,
+                        uint32_t y,
+                        uint32_t u,
+                        uint32_t v,
+                        double out[3]) {
+    const double sh = (double)(1u << (bd - 8u));
+    const double top = (double)((1u << bd) - 1u);
+    const double ymax = (double)((1u << rgb_depth) - 1u);
+    double yn, un, vn;
+    if (mc == AV1_MC_IDENTITY) {
+        const double off = full ? 0.0 : 16.0 * sh, range = full ? top : 219.0 * sh;
+        out[0] = (v - off) / range;
+        out[1] = (y - off) / range;
+        out[2] = (u - off) / range;
+    } else {
+        yn = full ? y / top : (y - 16.0 * sh) / (219.0 * sh);
+        un = ((double)u - (double)(1u << (bd - 1u))) / (full ? top : 224.0 * sh);
+        vn = ((double)v - (double)(1u << (bd - 1u))) / (full ? top : 224.0 * sh);
+        if (mc == AV1_MC_SMPTE_YCGCO) {
+            out[0] = yn - un + vn;
+            out[1] = yn + un;
+            out[2] = yn - un - vn;
+        } else {
+            double kr = 0.299, kb = 0.114;
+            if (mc == AV1_MC_BT_709) {
+                kr = 0.2126;
+                kb = 0.0722;
+            } else if (mc == AV1_MC_FCC) {
+                kr = 0.30;
+                kb = 0.11;
+            } else if (mc == AV1_MC_SMPTE_240) {
+                kr = 0.212;
+                kb = 0.087;
+            } else if (mc == AV1_MC_BT_2020_NCL) {
+                kr = 0.2627;
+                kb = 0.0593;
+            }
+            const double kg = 1.0 - kr - kb;
+            out[0] = yn + (2.0 - 2.0 * kr) * vn;
+            out[2] = yn + (2.0 - 2.0 * kb) * un;
+            out[1] = (yn - kr * out[0] - kb * out[2]) / kg;
+        }
+    }
+    for (uint32_t c = 0; c < 3u; c++) {
+        const double x = out[c] * ymax;
+        out[c] = x < 0.0 ? 0.0 : (x > ymax ? ymax : x);
+    }
+}
+
+// The fixed-point path stays within one output step of the exact conversion for 8-bit RGB and
+// within 1/2048 of full scale for 16-bit RGB.
+static int test_accuracy(void) {
+    for (uint32_t mi = 0; mi < sizeof(kMatrices) / sizeof(kMatrices[0]); mi++) {
+        for (uint32_t d = 0; d < 3u; d++) {
+            for (uint32_t r = 0; r < 4u; r++) {
+                const bool full = r & 1u;
+                const uint32_t rgb_depth = (r & 2u) ? 16u : 8u;
+                const uint32_t bd = kDepths[d];
+                Av1Yuv2Rgb cv;
+                char err[128];
+                CHECK(av1_yuv2rgb_init(&cv, kMatrices[mi], full, bd, rgb_depth, err, sizeof(err)));
+                const double tol = rgb_depth == 8u ? 1.0 : 32.0;
+                for (uint32_t iter = 0; iter < 4000u; iter++) {
+                    const uint32_t mask = (1u << bd) - 1u;
+                    const uint32_t y = rng() & mask, u = rng() & mask, v = rng() & mask;
+                    uint32_t px[4];
+                    double want[3];
+                    convert_px(&cv, y, u, v, px);
+                    ref_convert(kMatrices[mi], full, bd, rgb_depth, y, u, v, want);
+                    for (uint32_t c = 0; c < 3u; c++) {
+                        const double diff = (double)px[c] - want[c];
+                        if (diff > tol || diff < -tol) {
+                            fprintf(stderr,
+                                    "mc=%u full=%d bd=%u rgb=%u yuv=(%u,%u,%u) c=%u got=%u want=%.3f\n",
+                                    kMatrices[mi], full, bd, rgb_depth, y, u, v, c, px[c], want[c]);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Every AVX2 row kernel matches the scalar one at every width, including the scalar tail.
+static int test_dsp_match(void) {
+    Av1Yuv2RgbDsp c, best;
+    av1_yuv2rgb_dsp_init_c(&c);
+    av1_yuv2rgb_dsp_init(&best);
+    enum { MAXW = 200, PAD = 32 };
+    static uint16_t y16[MAXW + PAD], ch16[4][MAXW + 2 * PAD];
+    static uint8_t y8[MAXW + PAD], ch8[4][MAXW + 2 * PAD];
+    static uint16_t a16[4 * MAXW + PAD], b16[4 * MAXW + PAD];
+    static uint8_t a8[4 * MAXW + PAD], b8[4 * MAXW + PAD];
+    for (uint32_t mi = 0; mi < sizeof(kMatrices) / sizeof(kMatrices[0]); mi++) {
+        for (uint32_t d = 0; d < 3u; d++) {
+            for (uint32_t r = 0; r < 4u; r++) {
+                Av1Yuv2Rgb cv;
+                char err[128];
+                const uint32_t bd = kDepths[d];
+                CHECK(av1_yuv2rgb_init(&cv, kMatrices[mi], r & 1u, bd, (r & 2u) ? 16u : 8u, err, sizeof(err)));
+                const bool in16 = bd > 8u, out16 = cv.rgb_depth == 16u;
+                for (uint32_t iter = 0; iter < 40u; iter++) {
+                    const uint32_t mask = (1u << bd) - 1u;
+                    for (uint32_t i = 0; i < MAXW + PAD; i++) {
+                        y16[i] = (uint16_t)(iter < 2u ? (iter ? mask : 0u) : rng() & mask);
+                        y8[i] = (uint8_t)y16[i];
+                    }
+                    for (uint32_t p = 0; p < 4u; p++) {
+                        for (uint32_t i = 0; i < MAXW + 2 * PAD; i++) {
+                            ch16[p][i] = (uint16_t)(iter < 2u ? (iter ? 0u : mask) : rng() & mask);
+                            ch8[p][i] = (uint8_t)ch16[p][i];
+                        }
+                    }
+                    const uint32_t w = 1u + rng() % MAXW;
+                    for (uint32_t half = 0; half < 2u; half++) {
+                        const void *yp = in16 ? (const void *)y16 : (const void *)y8;
+                        const void *cp[4];
+                        for (uint32_t p = 0; p < 4u; p++) {
+                            cp[p] = in16 ? (const void *)(ch16[p] + PAD) : (const void *)(ch8[p] + PAD);
+                        }
+                        memset(a16, 0x5a, sizeof(a16));
+                        memset(b16, 0x5a, sizeof(b16));
+                        memset(a8, 0x5a, sizeof(a8));
+                        memset(b8, 0x5a, sizeof(b8));
+                        void *a = out16 ? (void *)a16 : (void *)a8;
+                        void *b = out16 ? (void *)b16 : (void *)b8;
+                        c.row[in16][out16][half](a, yp, cp[0], cp[1], cp[2], cp[3], w, &cv);
+                        best.row[in16][out16][half](b, yp, cp[0], cp[1], cp[2], cp[3], w, &cv);
+                        CHECK(memcmp(a16, b16, sizeof(a16)) == 0);
+                        CHECK(memcmp(a8, b8, sizeof(a8)) == 0);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static uint32_t frame_sample(const Av1FrameBuf *fb, uint32_t p, int32_t x, int32_t y) {
+    x = x < 0 ? 0 : (x >= (int32_t)fb->plane_w[p] ? (int32_t)fb->plane_w[p] - 1 : x);
+    y = y < 0 ? 0 : (y >= (int32_t)fb->plane_h[p] ? (int32_t)fb->plane_h[p] - 1 : y);
+    const ptrdiff_t i = (ptrdiff_t)y * fb->stride[p] + x;
+    return fb->bytes_per_sample == 2u ? av1_frame_plane_16(fb, p)[i] : av1_frame_plane_8(fb, p)[i];
+}
+
+// Chroma of luma sample ( x, y ): centered 9-3-3-1 / 3-1 bilinear upsampling with replicated edges.
+static uint32_t ref_chroma(const Av1FrameBuf *fb, uint32_t p, uint32_t x, uint32_t y) {
+    if (fb->layout == AV1_LAYOUT_I400) {
+        return 1u << (fb->bit_depth - 1u);
+    }
+    if (fb->layout == AV1_LAYOUT_I444) {
+        return frame_sample(fb, p, (int32_t)x, (int32_t)y);
+    }
+    const int32_t cx = (int32_t)(x >> 1), sx = (x & 1u) ? cx + 1 : cx - 1;
+    int32_t cy = (int32_t)y, sy = (int32_t)y;
+    if (fb->layout == AV1_LAYOUT_I420) {
+        cy = (int32_t)(y >> 1);
+        sy = (y & 1u) ? cy + 1 : cy - 1;
+    }
+    const uint32_t near = 3u * frame_sample(fb, p, cx, cy) + frame_sample(fb, p, sx, cy);
+    const uint32_t far = 3u * frame_sample(fb, p, cx, sy) + frame_sample(fb, p, sx, sy);
+    return (3u * near + far + 8u) >> 4;
+}
+
+static int test_frames(void) {
+    Av1FramePool pool;
+    av1_frame_pool_init(&pool, 16, 0);
+    static const uint32_t kSizes[][2] = {{1, 1}, {2, 3}, {37, 23}, {64, 16}, {129, 9}};
+    for (uint32_t layout = AV1_LAYOUT_I400; layout < AV1_LAYOUTS; layout++) {
+        for (uint32_t d = 0; d < 3u; d++) {
+            for (uint32_t s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); s++) {
+                const uint32_t bd = kDepths[d], w = kSizes[s][0], h = kSizes[s][1];
+                Av1FrameBuf *fb;
+                char err[128];
+                CHECK(av1_frame_pool_get(&pool, w, h, layout, bd, &fb, err, sizeof(err)));
+                for (uint32_t p = 0; p < fb->num_planes; p++) {
+                    for (uint32_t yy = 0; yy < fb->plane_h[p]; yy++) {
+                        for (uint32_t xx = 0; xx < fb->plane_w[p]; xx++) {
+                            const ptrdiff_t i = (ptrdiff_t)yy * fb->stride[p] + xx;
+                            const uint32_t v = rng() & ((1u << bd) - 1u);
+                            if (bd > 8u) {
+                                av1_frame_plane_16(fb, p)[i] = (uint16_t)v;
+                            } else {
+                                av1_frame_plane_8(fb, p)[i] = (uint8_t)v;
+                            }
+                        }
+                    }
+                }
+                for (uint32_t out16 = 0; out16 < 2u; out16++) {
+                    Av1Yuv2Rgb cv;
+                    CHECK(av1_yuv2rgb_init(&cv, AV1_MC_BT_709, s & 1u, bd, out16 ? 16u : 8u, err, sizeof(err)));
+                    const ptrdiff_t stride = (ptrdiff_t)w * 4 * (out16 ? 2 : 1) + 8;
+                    uint8_t *rgba = (uint8_t *)malloc((size_t)stride * h);
+                    CHECK(rgba != NULL);
+                    CHECK(av1_yuv2rgb_frame(&cv, fb, rgba, stride, err, sizeof(err)));
+                    for (uint32_t yy = 0; yy < h; yy++) {
+                        for (uint32_t xx = 0; xx < w; xx++) {
+                            const int32_t yv = (int32_t)frame_sample(fb, 0, (int32_t)xx, (int32_t)yy) - cv.off[0];
+                            const int32_t uv = (int32_t)ref_chroma(fb, 1, xx, yy) - cv.off[1];
+                            const int32_t vv = (int32_t)ref_chroma(fb, 2, xx, yy) - cv.off[2];
+                            for (uint32_t c = 0; c < 4u; c++) {
+                                int32_t want = cv.rgb_max;
+                                if (c < 3u) {
+                                    want = (cv.m[c][0] * yv + cv.m[c][1] * uv + cv.m[c][2] * vv + cv.round) >> cv.shift;
+                                    want = want < 0 ? 0 : (want > cv.rgb_max ? cv.rgb_max : want);
+                                }
+                                const uint8_t *row = rgba + (ptrdiff_t)yy * stride;
+                                const uint16_t *row16 = (const uint16_t *)(const void *)row;
+                                const uint32_t got = out16 ? row16[4u * xx + c] : row[4u * xx + c];
+                                CHECK(got == (uint32_t)want);
+                            }
+                        }
+                    }
+                    free(rgba);
+                }
+                Av1Yuv2Rgb cv;
+                CHECK(av1_yuv2rgb_init(&cv, AV1_MC_BT_709, true, bd == 8u ? 10u : 8u, 8, err, sizeof(err)));
+                uint8_t px[4];
+                CHECK(!av1_yuv2rgb_frame(&cv, fb, px, 4, err, sizeof(err)));
+                av1_frame_pool_put(&pool, fb);
+            }
+        }
+    }
+    av1_frame_pool_free(&pool);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_known_values();
+    rc |= test_accuracy();
+    rc |= test_dsp_match();
+    rc |= test_frames();
+    if (rc == 0) {
+        printf("yuv2rgb tests: ok\n");
+    }
+    return rc;
+}